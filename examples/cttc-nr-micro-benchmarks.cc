@@ -0,0 +1,1412 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * \ingroup examples
+ * \file cttc-nr-micro-benchmarks.cc
+ * \brief Micro-benchmarks of the hot paths of the NR module
+ *
+ * The program measures the wall-clock time of some of the functions that
+ * dominate the run time of large NR simulations:
+ *
+ * - the TB decodification of the EESM error model (ErrorModel),
+ * - the wideband CQI feedback and the TB size of NrAmc (AmcCqi, AmcTbSize),
+ * - the DL scheduling of an OFDMA scheduler, driven through its SAPs, with
+ *   10, 100 and 1000 UEs with full buffer (OfdmaDlScheduling),
+ * - the addition of N interfering signals and the evaluation of the chunks
+ *   of NrInterference and NrSlInterference (Interference, SlInterference),
+ * - the sensing-based exclusion of the sidelink candidate resources of
+ *   NrUeMac (SlSensingExclusion),
+ * - the per-slot storage of the allocations and of the control messages of
+ *   NrPhy, with the slot ring and with the sorted list it replaced
+ *   (PhySlotQueues),
+ * - the update of the RLC buffers of the LCs of a LCG and the assignment of
+ *   the bytes of a TB to them, with 4 and 32 LCs, with the LC index and with
+ *   the unordered map it replaced (LcgAssignment),
+ * - the beam search of CellScanBeamforming (CellScanBeamforming).
+ *
+ * The inputs are generated with a fixed seed, so that every run does the
+ * same work: each benchmark reports a checksum of its results, which must
+ * not change between two runs of the same release. Each benchmark is warmed
+ * up, and then repeated a number of times; the time per operation of each
+ * repetition is reported, together with the minimum, median and mean.
+ *
+ * The results are written in JSON, to compare them across releases:
+ *
+ * \code{.unparsed}
+$ ./ns3 run "cttc-nr-micro-benchmarks --outputFile=nr-benchmarks.json"
+$ ./ns3 run "cttc-nr-micro-benchmarks --filter=Interference --repetitions=10"
+    \endcode
+ *
+ * Please build the module in optimized mode before taking the numbers.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/antenna-module.h"
+#include "ns3/three-gpp-channel-model.h"
+#include "ns3/three-gpp-propagation-loss-model.h"
+#include "ns3/three-gpp-spectrum-propagation-loss-model.h"
+#include "ns3/lte-chunk-processor.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <list>
+#include <memory>
+#include <numeric>
+#include <set>
+#include <unordered_map>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CttcNrMicroBenchmarks");
+
+/**
+ * \brief Runs the benchmarks, and collects their results in a JSON report
+ */
+class BenchmarkReport
+{
+public:
+  /**
+   * \brief A benchmark: it performs the given number of operations, and
+   * returns a checksum of their results
+   */
+  typedef std::function<double (uint32_t iterations)> Benchmark;
+  /**
+   * \brief The parameters of a benchmark, as (name, value) pairs
+   */
+  typedef std::vector<std::pair<std::string, double> > Parameters;
+
+  /**
+   * \brief BenchmarkReport constructor
+   * \param repetitions the number of timed repetitions of each benchmark
+   * \param filter only the benchmarks whose name contains it are run
+   */
+  BenchmarkReport (uint32_t repetitions, const std::string &filter)
+    : m_repetitions (repetitions),
+      m_filter (filter)
+  {
+    NS_ABORT_MSG_IF (repetitions == 0, "At least one repetition is needed");
+  }
+
+  /**
+   * \brief Check if a benchmark has to be run
+   * \param name the name of the benchmark
+   * \return true if the name matches the filter
+   */
+  bool
+  IsEnabled (const std::string &name) const
+  {
+    return name.find (m_filter) != std::string::npos;
+  }
+
+  /**
+   * \brief Warm up and run a benchmark, and record its times
+   * \param name the name of the benchmark
+   * \param params its parameters
+   * \param iterations the number of operations of each repetition
+   * \param benchmark the benchmark
+   */
+  void
+  Run (const std::string &name, const Parameters &params, uint32_t iterations,
+       const Benchmark &benchmark)
+  {
+    NS_ASSERT (iterations > 0);
+    Result result;
+    result.m_name = name;
+    result.m_params = params;
+    result.m_iterations = iterations;
+
+    benchmark (std::max<uint32_t> (1, iterations / 10));
+    for (uint32_t rep = 0; rep < m_repetitions; ++rep)
+      {
+        auto start = std::chrono::steady_clock::now ();
+        double checksum = benchmark (iterations);
+        auto duration = std::chrono::steady_clock::now () - start;
+        if (rep == 0)
+          {
+            result.m_checksum = checksum;
+          }
+        result.m_nsPerOp.push_back (std::chrono::duration<double, std::nano> (duration).count () / iterations);
+      }
+
+    std::vector<double> sorted = result.m_nsPerOp;
+    std::sort (sorted.begin (), sorted.end ());
+    std::clog << std::left << std::setw (22) << name;
+    for (const auto &p : params)
+      {
+        std::clog << " " << p.first << "=" << p.second;
+      }
+    std::clog << ": " << std::fixed << std::setprecision (1) << sorted.at (sorted.size () / 2)
+              << " ns/op (median)" << std::endl;
+
+    m_results.push_back (result);
+  }
+
+  /**
+   * \brief Write the report
+   * \param os the output stream
+   * \param seed the seed of the random inputs
+   */
+  void
+  Write (std::ostream &os, uint32_t seed) const
+  {
+    os << "{\n";
+    os << "  \"module\": \"nr\",\n";
+    os << "  \"buildProfile\": \"" << GetBuildProfile () << "\",\n";
+    os << "  \"seed\": " << seed << ",\n";
+    os << "  \"repetitions\": " << m_repetitions << ",\n";
+    os << "  \"benchmarks\": [";
+    for (uint32_t i = 0; i < m_results.size (); ++i)
+      {
+        const Result &result = m_results.at (i);
+        std::vector<double> sorted = result.m_nsPerOp;
+        std::sort (sorted.begin (), sorted.end ());
+        double mean = 0.0;
+        for (const auto &v : sorted)
+          {
+            mean += v / sorted.size ();
+          }
+
+        os << (i == 0 ? "\n" : ",\n");
+        os << "    {\n";
+        os << "      \"name\": \"" << result.m_name << "\",\n";
+        os << "      \"params\": {";
+        for (uint32_t p = 0; p < result.m_params.size (); ++p)
+          {
+            os << (p == 0 ? "" : ", ") << "\"" << result.m_params.at (p).first << "\": "
+               << std::defaultfloat << std::setprecision (10) << result.m_params.at (p).second;
+          }
+        os << "},\n";
+        os << "      \"iterations\": " << result.m_iterations << ",\n";
+        os << std::fixed << std::setprecision (2);
+        os << "      \"nsPerOpMin\": " << sorted.front () << ",\n";
+        os << "      \"nsPerOpMedian\": " << sorted.at (sorted.size () / 2) << ",\n";
+        os << "      \"nsPerOpMean\": " << mean << ",\n";
+        os << "      \"nsPerOp\": [";
+        for (uint32_t rep = 0; rep < result.m_nsPerOp.size (); ++rep)
+          {
+            os << (rep == 0 ? "" : ", ") << result.m_nsPerOp.at (rep);
+          }
+        os << "],\n";
+        os << "      \"checksum\": " << std::defaultfloat << std::setprecision (15) << result.m_checksum << "\n";
+        os << "    }";
+      }
+    os << "\n  ]\n}" << std::endl;
+  }
+
+private:
+  /**
+   * \brief The results of a benchmark
+   */
+  struct Result
+  {
+    std::string m_name;            //!< Name of the benchmark
+    Parameters m_params;           //!< Parameters of the benchmark
+    uint32_t m_iterations {0};     //!< Operations of each repetition
+    std::vector<double> m_nsPerOp; //!< Time per operation of each repetition
+    double m_checksum {0.0};       //!< Checksum of the first repetition
+  };
+
+  /**
+   * \return the ns-3 build profile
+   */
+  static std::string
+  GetBuildProfile ()
+  {
+#if defined(NS3_BUILD_PROFILE_DEBUG)
+    return "debug";
+#elif defined(NS3_BUILD_PROFILE_RELEASE)
+    return "release";
+#elif defined(NS3_BUILD_PROFILE_OPTIMIZED)
+    return "optimized";
+#else
+    return "unknown";
+#endif
+  }
+
+  uint32_t m_repetitions {0};    //!< Timed repetitions of each benchmark
+  std::string m_filter;          //!< Filter of the benchmark names
+  std::vector<Result> m_results; //!< The results
+};
+
+/**
+ * \brief Create a SINR with random values, uniform in dB
+ * \param sm the spectrum model
+ * \param rng the random variable
+ * \param minDb the minimum SINR, in dB
+ * \param maxDb the maximum SINR, in dB
+ * \return the SINR
+ */
+static SpectrumValue
+CreateRandomSinr (const Ptr<const SpectrumModel> &sm, const Ptr<UniformRandomVariable> &rng,
+                  double minDb, double maxDb)
+{
+  SpectrumValue sinr (sm);
+  for (auto it = sinr.ValuesBegin (); it != sinr.ValuesEnd (); ++it)
+    {
+      *it = std::pow (10.0, rng->GetValue (minDb, maxDb) / 10.0);
+    }
+  return sinr;
+}
+
+/**
+ * \brief Create a NrAmc
+ * \param amcModel the AMC model
+ * \return the AMC, with the EESM IR table 1 error model
+ */
+static Ptr<NrAmc>
+CreateAmc (NrAmc::AmcModel amcModel)
+{
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+  amc->SetAttribute ("AmcModel", EnumValue (amcModel));
+  amc->SetAttribute ("ErrorModelType", TypeIdValue (NrEesmIrT1::GetTypeId ()));
+  return amc;
+}
+
+/**
+ * \brief CSCHED SAP user that ignores all the confirmations
+ */
+class BenchmarkCschedSapUser : public NrMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf ([[maybe_unused]] const struct CschedCellConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeConfigCnf ([[maybe_unused]] const struct CschedUeConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedLcConfigCnf ([[maybe_unused]] const struct CschedLcConfigCnfParameters& params) override
+  {
+  }
+  virtual void CschedLcReleaseCnf ([[maybe_unused]] const struct CschedLcReleaseCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeReleaseCnf ([[maybe_unused]] const struct CschedUeReleaseCnfParameters& params) override
+  {
+  }
+  virtual void CschedUeConfigUpdateInd ([[maybe_unused]] const struct CschedUeConfigUpdateIndParameters& params) override
+  {
+  }
+  virtual void CschedCellConfigUpdateInd ([[maybe_unused]] const struct CschedCellConfigUpdateIndParameters& params) override
+  {
+  }
+};
+
+/**
+ * \brief Drives the DL scheduling of a scheduler through its SAPs, as the
+ * gNB MAC does, with all the UEs in full buffer
+ *
+ * Each operation is a slot: the HARQ processes used in the previous slot are
+ * ACKed, and the scheduler assigns the RBGs of the slot to the UEs.
+ */
+class DlSchedulingBenchmark : public NrMacSchedSapUser
+{
+public:
+  /**
+   * \brief DlSchedulingBenchmark constructor
+   * \param schedulerType the TypeId name of the scheduler
+   * \param numUes the number of UEs
+   * \param numRbs the number of RBs of the bandwidth
+   * \param numerology the numerology
+   */
+  DlSchedulingBenchmark (const std::string &schedulerType, uint16_t numUes,
+                         uint32_t numRbs, uint16_t numerology)
+    : m_numRbs (numRbs),
+      m_numerology (numerology),
+      m_sfnSf (0, 0, 0, static_cast<uint8_t> (numerology))
+  {
+    m_spectrumModel = NrSpectrumValueHelper::GetSpectrumModel (numRbs, 28e9, 15e3 * std::pow (2, numerology));
+
+    ObjectFactory factory;
+    factory.SetTypeId (schedulerType);
+    m_scheduler = DynamicCast<NrMacSchedulerNs3> (factory.Create ());
+    NS_ABORT_MSG_IF (m_scheduler == nullptr, "Can't create a NrMacSchedulerNs3 from type " << schedulerType);
+    m_scheduler->SetAttribute ("StartingMcsDl", UintegerValue (10));
+    m_scheduler->InstallDlAmc (CreateAmc (NrAmc::ErrorModel));
+    m_scheduler->InstallUlAmc (CreateAmc (NrAmc::ErrorModel));
+    m_scheduler->SetMacCschedSapUser (&m_cschedSapUser);
+    m_scheduler->SetMacSchedSapUser (this);
+
+    NrMacCschedSapProvider::CschedCellConfigReqParameters cellParams {};
+    cellParams.m_dlBandwidth = static_cast<uint16_t> (numRbs / GetNumRbPerRbg ());
+    cellParams.m_ulBandwidth = cellParams.m_dlBandwidth;
+    m_scheduler->DoCschedCellConfigReq (cellParams);
+
+    for (uint16_t rnti = 1; rnti <= numUes; ++rnti)
+      {
+        NrMacCschedSapProvider::CschedUeConfigReqParameters ueParams {};
+        ueParams.m_rnti = rnti;
+        ueParams.m_beamConfId = BeamConfId (BeamId (8, 120.0), BeamId::GetEmptyBeamId ());
+        m_scheduler->DoCschedUeConfigReq (ueParams);
+
+        LogicalChannelConfigListElement_s lc {};
+        lc.m_logicalChannelIdentity = 1;
+        lc.m_logicalChannelGroup = 1;
+        lc.m_direction = LogicalChannelConfigListElement_s::DIR_DL;
+        lc.m_qosBearerType = LogicalChannelConfigListElement_s::QBT_NON_GBR;
+        lc.m_qci = 9;
+        NrMacCschedSapProvider::CschedLcConfigReqParameters lcParams {};
+        lcParams.m_rnti = rnti;
+        lcParams.m_reconfigureFlag = false;
+        lcParams.m_logicalChannelConfigList.emplace_back (lc);
+        m_scheduler->DoCschedLcConfigReq (lcParams);
+
+        // Enough data to never empty the buffer, also in long runs
+        NrMacSchedSapProvider::SchedDlRlcBufferReqParameters bufferParams {};
+        bufferParams.m_rnti = rnti;
+        bufferParams.m_logicalChannelIdentity = 1;
+        bufferParams.m_rlcTransmissionQueueSize = 1000000000;
+        m_scheduler->DoSchedDlRlcBufferReq (bufferParams);
+      }
+  }
+
+  /**
+   * \brief Schedule the given number of slots
+   * \param slots the number of slots
+   * \return the number of bytes scheduled
+   */
+  double
+  Schedule (uint32_t slots)
+  {
+    double bytes = 0.0;
+    for (uint32_t i = 0; i < slots; ++i)
+      {
+        NrMacSchedSapProvider::SchedDlTriggerReqParameters params;
+        params.m_snfSf = m_sfnSf;
+        params.m_slotType = LteNrTddSlotType::DL;
+        params.m_dlHarqInfoList.swap (m_feedback);
+        m_feedback.clear ();
+        m_scheduledBytes = 0;
+        m_scheduler->DoSchedDlTriggerReq (params);
+        bytes += m_scheduledBytes;
+        m_sfnSf.Add (1);
+      }
+    return bytes;
+  }
+
+  virtual void
+  SchedConfigInd (const struct SchedConfigIndParameters& params) override
+  {
+    for (const auto &varTti : params.m_slotAllocInfo.m_varTtiAllocInfo)
+      {
+        const auto &dci = varTti.m_dci;
+        if (dci->m_type != DciInfoElementTdma::DATA || dci->m_format != DciInfoElementTdma::DL)
+          {
+            continue;
+          }
+        DlHarqInfo harq;
+        harq.m_rnti = dci->m_rnti;
+        harq.m_harqProcessId = dci->m_harqProcess;
+        harq.m_bwpIndex = 0;
+        for (const auto &tbSize : dci->m_tbSize)
+          {
+            harq.m_harqStatus.push_back (tbSize > 0 ? DlHarqInfo::ACK : DlHarqInfo::NONE);
+            harq.m_numRetx.push_back (0);
+            m_scheduledBytes += tbSize;
+          }
+        m_feedback.push_back (harq);
+      }
+  }
+  virtual Ptr<const SpectrumModel> GetSpectrumModel () const override
+  {
+    return m_spectrumModel;
+  }
+  virtual uint32_t GetNumRbPerRbg () const override
+  {
+    return 4;
+  }
+  virtual uint8_t GetNumHarqProcess () const override
+  {
+    return 16;
+  }
+  virtual uint16_t GetBwpId () const override
+  {
+    return 0;
+  }
+  virtual uint16_t GetCellId () const override
+  {
+    return 1;
+  }
+  virtual uint32_t GetSymbolsPerSlot () const override
+  {
+    return 14;
+  }
+  virtual Time GetSlotPeriod () const override
+  {
+    return MicroSeconds (1000 / (1 << m_numerology));
+  }
+
+private:
+  uint32_t m_numRbs {0};                      //!< RBs of the bandwidth
+  uint16_t m_numerology {0};                  //!< Numerology
+  SfnSf m_sfnSf;                              //!< Current slot
+  Ptr<const SpectrumModel> m_spectrumModel;   //!< Spectrum model of the bandwidth
+  Ptr<NrMacSchedulerNs3> m_scheduler;         //!< The scheduler
+  BenchmarkCschedSapUser m_cschedSapUser;     //!< CSCHED SAP user
+  std::vector<DlHarqInfo> m_feedback;         //!< HARQ feedback for the next slot
+  double m_scheduledBytes {0.0};              //!< Bytes scheduled in the current slot
+};
+
+static double g_chunkChecksum = 0.0; //!< Checksum of the chunks evaluated by the interference benchmarks
+
+/**
+ * \brief Add the average of a SINR chunk to the checksum
+ * \param sinr the SINR
+ */
+static void
+AddChunkToChecksum (const SpectrumValue &sinr)
+{
+  g_chunkChecksum += Sum (sinr) / sinr.GetSpectrumModel ()->GetNumBands ();
+}
+
+/**
+ * \brief Add the average of the sidelink SINR chunks to the checksum
+ * \param sinrs the SINR of each received signal
+ */
+static void
+AddSlChunksToChecksum (std::vector<SpectrumValue> sinrs)
+{
+  for (const auto &sinr : sinrs)
+    {
+      AddChunkToChecksum (sinr);
+    }
+}
+
+/**
+ * \brief The storage of the slot allocations and of the control messages of
+ * NrPhy before NrSlotRing: a sorted list of allocations, searched linearly,
+ * and a vector of lists whose front is erased at every slot
+ */
+class ListSlotQueues
+{
+public:
+  /**
+   * \brief ListSlotQueues constructor
+   * \param l1l2 the L1L2 latency, in slots
+   * \param window unused: the list grows with the allocations
+   */
+  ListSlotQueues (uint32_t l1l2, [[maybe_unused]] uint32_t window)
+    : m_ctrlMsgs (l1l2 + 1)
+  {
+  }
+
+  /**
+   * \brief Store an allocation, merging it with the one of the same slot
+   * \param alloc the allocation
+   */
+  void
+  Push (const SlotAllocInfo &alloc)
+  {
+    for (auto & a : m_allocs)
+      {
+        if (a.m_sfnSf == alloc.m_sfnSf)
+          {
+            a.Merge (alloc);
+            return;
+          }
+      }
+    m_allocs.push_back (alloc);
+    m_allocs.sort ();
+  }
+
+  /**
+   * \brief Get the allocation of a slot
+   * \param sfn the slot
+   * \return the allocation, or nullptr
+   */
+  SlotAllocInfo *
+  Peek (const SfnSf &sfn)
+  {
+    for (auto & a : m_allocs)
+      {
+        if (a.m_sfnSf == sfn)
+          {
+            return &a;
+          }
+      }
+    return nullptr;
+  }
+
+  /**
+   * \brief Remove the allocation of a slot
+   * \param sfn the slot
+   * \param alloc where the allocation is copied
+   * \return true if the slot had an allocation
+   */
+  bool
+  Retrieve (const SfnSf &sfn, SlotAllocInfo &alloc)
+  {
+    for (auto it = m_allocs.begin (); it != m_allocs.end (); ++it)
+      {
+        if (it->m_sfnSf == sfn)
+          {
+            alloc = *it;
+            m_allocs.erase (it);
+            return true;
+          }
+      }
+    return false;
+  }
+
+  /**
+   * \brief Enqueue a message, to be sent after the L1L2 latency
+   * \param msg the message
+   */
+  void
+  Enqueue (const Ptr<NrControlMessage> &msg)
+  {
+    m_ctrlMsgs.back ().push_back (msg);
+  }
+
+  /**
+   * \brief Pop the messages of the current slot
+   * \return the messages
+   */
+  std::list<Ptr<NrControlMessage> >
+  PopCtrlMsgs ()
+  {
+    std::list<Ptr<NrControlMessage> > ret = m_ctrlMsgs.front ();
+    m_ctrlMsgs.erase (m_ctrlMsgs.begin ());
+    m_ctrlMsgs.push_back (std::list<Ptr<NrControlMessage> > ());
+    return ret;
+  }
+
+private:
+  std::list<SlotAllocInfo> m_allocs;                            //!< Allocations
+  std::vector<std::list<Ptr<NrControlMessage> > > m_ctrlMsgs;   //!< Control messages
+};
+
+/**
+ * \brief The storage of the slot allocations and of the control messages of
+ * NrPhy: a NrSlotRing indexed by the normalized slot, and a ring of lists
+ */
+class RingSlotQueues
+{
+public:
+  /**
+   * \brief RingSlotQueues constructor
+   * \param l1l2 the L1L2 latency, in slots
+   * \param window the farthest slot allocated, from the current one
+   */
+  RingSlotQueues (uint32_t l1l2, uint32_t window)
+    : m_ctrlMsgs (l1l2 + 1)
+  {
+    m_allocs.Reserve (window + 1);
+  }
+
+  /**
+   * \brief Store an allocation, merging it with the one of the same slot
+   * \param alloc the allocation
+   */
+  void
+  Push (const SlotAllocInfo &alloc)
+  {
+    uint64_t slot = alloc.m_sfnSf.Normalize ();
+    SlotAllocInfo *a = m_allocs.Find (slot);
+    if (a != nullptr)
+      {
+        a->Merge (alloc);
+      }
+    else
+      {
+        m_allocs.Insert (slot, alloc);
+      }
+  }
+
+  /**
+   * \brief Get the allocation of a slot
+   * \param sfn the slot
+   * \return the allocation, or nullptr
+   */
+  SlotAllocInfo *
+  Peek (const SfnSf &sfn)
+  {
+    return m_allocs.Find (sfn.Normalize ());
+  }
+
+  /**
+   * \brief Remove the allocation of a slot
+   * \param sfn the slot
+   * \param alloc where the allocation is moved
+   * \return true if the slot had an allocation
+   */
+  bool
+  Retrieve (const SfnSf &sfn, SlotAllocInfo &alloc)
+  {
+    return m_allocs.Pop (sfn.Normalize (), alloc);
+  }
+
+  /**
+   * \brief Enqueue a message, to be sent after the L1L2 latency
+   * \param msg the message
+   */
+  void
+  Enqueue (const Ptr<NrControlMessage> &msg)
+  {
+    m_ctrlMsgs.at ((m_head + m_ctrlMsgs.size () - 1) % m_ctrlMsgs.size ()).push_back (msg);
+  }
+
+  /**
+   * \brief Pop the messages of the current slot
+   * \return the messages
+   */
+  std::list<Ptr<NrControlMessage> >
+  PopCtrlMsgs ()
+  {
+    std::list<Ptr<NrControlMessage> > ret;
+    ret.swap (m_ctrlMsgs.at (m_head));
+    m_head = (m_head + 1) % m_ctrlMsgs.size ();
+    return ret;
+  }
+
+private:
+  NrSlotRing<SlotAllocInfo> m_allocs;                           //!< Allocations
+  std::vector<std::list<Ptr<NrControlMessage> > > m_ctrlMsgs;   //!< Control messages
+  uint32_t m_head {0};                                          //!< Head of m_ctrlMsgs
+};
+
+/**
+ * \brief The per-slot work of the gNB PHY on its slot storage: store the
+ * DL and the UL allocation (merged) of the farthest slot of the window, look
+ * up the allocations of two slots to send their DCIs, take the allocation of
+ * the current slot, and enqueue and pop the control messages.
+ *
+ * \param queues the storage
+ * \param start the first slot
+ * \param slots the number of slots
+ * \param window the farthest slot allocated, from the current one
+ * \param dlDci the DCI of the DL allocations
+ * \param ulDci the DCI of the UL allocations
+ * \param msg the control message enqueued in each slot
+ * \return the symbols and the messages of the slots, as checksum
+ */
+template <typename Queues>
+static double
+RunSlotQueues (Queues &queues, SfnSf start, uint32_t slots, uint32_t window,
+               const std::shared_ptr<DciInfoElementTdma> &dlDci,
+               const std::shared_ptr<DciInfoElementTdma> &ulDci,
+               const Ptr<NrControlMessage> &msg)
+{
+  double checksum = 0.0;
+  SfnSf current = start;
+  SlotAllocInfo alloc;
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      SlotAllocInfo dl (current.GetFutureSfnSf (window));
+      dl.m_type = SlotAllocInfo::DL;
+      dl.m_numSymAlloc = dlDci->m_numSym;
+      dl.m_varTtiAllocInfo.emplace_back (dlDci);
+      queues.Push (dl);
+
+      SlotAllocInfo ul (current.GetFutureSfnSf (window));
+      ul.m_type = SlotAllocInfo::UL;
+      ul.m_numSymAlloc = ulDci->m_numSym;
+      ul.m_varTtiAllocInfo.emplace_back (ulDci);
+      queues.Push (ul);
+
+      for (uint32_t k : {window / 2, window})
+        {
+          SlotAllocInfo *target = queues.Peek (current.GetFutureSfnSf (k));
+          checksum += target != nullptr ? target->m_varTtiAllocInfo.size () : 0;
+        }
+
+      if (queues.Retrieve (current, alloc))
+        {
+          checksum += alloc.m_numSymAlloc;
+        }
+
+      queues.Enqueue (msg);
+      checksum += queues.PopCtrlMsgs ().size ();
+      current.Add (1);
+    }
+
+  // Empty the storage, for the next repetition
+  for (uint32_t k = 0; k <= window; ++k)
+    {
+      queues.Retrieve (current.GetFutureSfnSf (k), alloc);
+    }
+  return checksum;
+}
+
+/**
+ * \brief The LCG of the scheduler before the LC index: the LCs in an
+ * unordered map, looked up at each access, with the three RLC buffers in
+ * separate fields, the direction passed as a string, and a sanity check
+ * that visits all the LCs after each assignment
+ */
+class MapLcg
+{
+public:
+  /**
+   * \brief Insert an empty LC
+   * \param lcId the LC ID
+   */
+  void
+  Insert (uint8_t lcId)
+  {
+    m_lcMap.emplace (lcId, std::unique_ptr<Lc> (new Lc ()));
+  }
+
+  /**
+   * \brief Update the RLC buffers of a LC, and the total size
+   * \param params the buffer status
+   */
+  void
+  UpdateInfo (const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters &params)
+  {
+    Lc &lc = *m_lcMap.at (params.m_logicalChannelIdentity);
+    int ret = 0;
+    if (params.m_rlcTransmissionQueueSize > lc.m_tx)
+      {
+        ret += params.m_rlcTransmissionQueueSize - lc.m_tx;
+      }
+    if (params.m_rlcRetransmissionQueueSize > lc.m_retx)
+      {
+        ret += params.m_rlcRetransmissionQueueSize - lc.m_retx;
+      }
+    if (params.m_rlcStatusPduSize - lc.m_status)
+      {
+        ret += params.m_rlcStatusPduSize - lc.m_status;
+      }
+    lc.m_tx = params.m_rlcTransmissionQueueSize;
+    lc.m_retx = params.m_rlcRetransmissionQueueSize;
+    lc.m_status = params.m_rlcStatusPduSize;
+    if (ret < 0)
+      {
+        m_totalSize -= std::abs (ret);
+      }
+    else
+      {
+        m_totalSize += ret;
+      }
+  }
+
+  /**
+   * \return the total size
+   */
+  uint32_t
+  GetTotalSize () const
+  {
+    return m_totalSize;
+  }
+
+  /**
+   * \return the LC IDs
+   */
+  std::vector<uint8_t>
+  GetLCId () const
+  {
+    std::vector<uint8_t> ret;
+    for (const auto & lc : m_lcMap)
+      {
+        ret.emplace_back (lc.first);
+      }
+    return ret;
+  }
+
+  /**
+   * \param lcId the LC ID
+   * \return the sum of the RLC buffers of the LC
+   */
+  uint32_t
+  GetTotalSizeOfLC (uint8_t lcId) const
+  {
+    const Lc &lc = *m_lcMap.at (lcId);
+    return lc.m_tx + lc.m_retx + lc.m_status;
+  }
+
+  /**
+   * \brief Remove the assigned bytes from the RLC buffers of a LC, as
+   * NrMacSchedulerLCG::AssignedData did
+   * \param lcId the LC ID
+   * \param size the bytes assigned
+   * \param type "DL" or "UL"
+   */
+  void
+  AssignedData (uint8_t lcId, uint32_t size, std::string type)
+  {
+    if ((m_lcMap.at (lcId)->m_status > 0) && (size >= m_lcMap.at (lcId)->m_status))
+      {
+        m_totalSize -= m_lcMap.at (lcId)->m_status;
+        m_lcMap.at (lcId)->m_status = 0;
+      }
+    else if ((m_lcMap.at (lcId)->m_retx > 0) && (size >= m_lcMap.at (lcId)->m_retx))
+      {
+        m_totalSize = m_totalSize < m_lcMap.at (lcId)->m_retx ? 0 : m_totalSize - m_lcMap.at (lcId)->m_retx;
+        m_lcMap.at (lcId)->m_retx = 0;
+      }
+    else if (m_lcMap.at (lcId)->m_tx > 0)
+      {
+        uint32_t rlcOverhead = lcId == 1 && type == "DL" ? 4 : 2;
+        if (m_totalSize < m_lcMap.at (lcId)->m_tx)
+          {
+            m_totalSize = 0;
+          }
+        else if (m_lcMap.at (lcId)->m_tx <= size)
+          {
+            m_totalSize -= m_lcMap.at (lcId)->m_tx;
+          }
+        else
+          {
+            m_totalSize -= std::min (m_lcMap.at (lcId)->m_tx, size - rlcOverhead);
+          }
+        if (size - rlcOverhead >= m_lcMap.at (lcId)->m_tx)
+          {
+            m_lcMap.at (lcId)->m_tx = 0;
+          }
+        else
+          {
+            m_lcMap.at (lcId)->m_tx -= size - rlcOverhead;
+          }
+      }
+
+    uint32_t total = 0;
+    for (const auto & lc : m_lcMap)
+      {
+        total += lc.second->m_status + lc.second->m_retx + lc.second->m_tx;
+      }
+    if (total == 0)
+      {
+        m_totalSize = 0;
+      }
+  }
+
+private:
+  /**
+   * \brief The RLC buffers of a LC
+   */
+  struct Lc
+  {
+    uint32_t m_tx {0};      //!< TX buffer
+    uint32_t m_retx {0};    //!< Retransmission buffer
+    uint16_t m_status {0};  //!< STATUS PDU
+  };
+
+  uint32_t m_totalSize {0};                                 //!< Total size
+  std::unordered_map<uint8_t, std::unique_ptr<Lc> > m_lcMap; //!< LCs, by LC ID
+};
+
+/**
+ * \brief The per-slot work of the scheduler on the LCG of a UE: the RLC
+ * buffer status of each LC is updated (new data arrives in each LC, and
+ * some LCs have a retransmission or a STATUS PDU), the bytes of a TB are
+ * split among the active LCs as NrMacSchedulerNs3::AssignBytesToLC did, and
+ * each LC is informed of the bytes assigned.
+ *
+ * The TX buffers only grow between two assignments, so that the total size
+ * does not depend on the order in which the LCs are visited.
+ *
+ * \param lcg the LCG
+ * \param lcs the number of LCs of the LCG, with LC IDs from 1
+ * \param slots the number of slots
+ * \param tbs the bytes of the TB of each slot
+ * \return the total size of the LCG after each slot, as checksum
+ */
+static double
+RunLcgAssignment (MapLcg &lcg, uint8_t lcs, uint32_t slots, uint32_t tbs)
+{
+  double checksum = 0.0;
+  NrMacSchedSapProvider::SchedDlRlcBufferReqParameters params {};
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      for (uint8_t lcId = 1; lcId <= lcs; ++lcId)
+        {
+          params.m_logicalChannelIdentity = lcId;
+          params.m_rlcTransmissionQueueSize = lcg.GetTotalSizeOfLC (lcId) + 20 * lcId;
+          params.m_rlcRetransmissionQueueSize = (i + lcId) % 7 == 0 ? 120 : 0;
+          params.m_rlcStatusPduSize = (i + lcId) % 5 == 0 ? 10 : 0;
+          lcg.UpdateInfo (params);
+        }
+
+      uint32_t activeLc = 0;
+      for (const auto & lcId : lcg.GetLCId ())
+        {
+          activeLc += lcg.GetTotalSizeOfLC (lcId) > 0 ? 1 : 0;
+        }
+      std::vector<uint8_t> assigned;
+      for (const auto & lcId : lcg.GetLCId ())
+        {
+          if (lcg.GetTotalSizeOfLC (lcId) > 0)
+            {
+              assigned.emplace_back (lcId);
+            }
+        }
+      for (const auto & lcId : assigned)
+        {
+          lcg.AssignedData (lcId, tbs / activeLc, "DL");
+        }
+      checksum += lcg.GetTotalSize ();
+    }
+  return checksum;
+}
+
+/**
+ * \brief The per-slot work of the scheduler on the LCG of a UE, as in
+ * RunLcgAssignment (MapLcg&, uint8_t, uint32_t, uint32_t), with the
+ * NrMacSchedulerLCG of the module
+ *
+ * \param lcg the LCG
+ * \param lcs the number of LCs of the LCG, with LC IDs from 1
+ * \param slots the number of slots
+ * \param tbs the bytes of the TB of each slot
+ * \return the total size of the LCG after each slot, as checksum
+ */
+static double
+RunLcgAssignment (NrMacSchedulerLCG &lcg, uint8_t lcs, uint32_t slots, uint32_t tbs)
+{
+  double checksum = 0.0;
+  NrMacSchedSapProvider::SchedDlRlcBufferReqParameters params {};
+  std::vector<uint8_t> assigned;
+  assigned.reserve (lcs);
+  for (uint32_t i = 0; i < slots; ++i)
+    {
+      for (uint8_t lcId = 1; lcId <= lcs; ++lcId)
+        {
+          params.m_logicalChannelIdentity = lcId;
+          params.m_rlcTransmissionQueueSize = lcg.GetTotalSizeOfLC (lcId) + 20 * lcId;
+          params.m_rlcRetransmissionQueueSize = (i + lcId) % 7 == 0 ? 120 : 0;
+          params.m_rlcStatusPduSize = (i + lcId) % 5 == 0 ? 10 : 0;
+          lcg.UpdateInfo (params);
+        }
+
+      assigned.clear ();
+      lcg.ForEachLC ([&assigned] (const NrMacSchedulerLC &lc)
+                     {
+                       if (lc.GetTotalSize () > 0)
+                         {
+                           assigned.emplace_back (static_cast<uint8_t> (lc.m_id));
+                         }
+                     });
+      for (const auto & lcId : assigned)
+        {
+          lcg.AssignedData (lcId, tbs / static_cast<uint32_t> (assigned.size ()), DciInfoElementTdma::DL);
+        }
+      checksum += lcg.GetTotalSize ();
+    }
+  return checksum;
+}
+
+/**
+ * \brief Install one gNB and one UE, and return their spectrum PHYs
+ * \param antennaRows the rows (and the columns) of the gNB antenna array
+ * \return the spectrum PHYs of the gNB and of the UE
+ */
+static std::pair<Ptr<NrSpectrumPhy>, Ptr<NrSpectrumPhy> >
+InstallBeamformingScenario (uint32_t antennaRows)
+{
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  NodeContainer gnbNodes;
+  NodeContainer ueNodes;
+  gnbNodes.Create (1);
+  ueNodes.Create (1);
+
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 10.0));
+  positionAlloc->Add (Vector (10.0, 10.0, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (NodeContainer (gnbNodes, ueNodes));
+
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+  CcBwpCreator::SimpleOperationBandConf bandConf (29e9, 100e6, 1, BandwidthPartInfo::UMa_LoS);
+  CcBwpCreator ccBwpCreator;
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+
+  nrHelper->SetGnbAntennaAttribute ("NumRows", UintegerValue (antennaRows));
+  nrHelper->SetGnbAntennaAttribute ("NumColumns", UintegerValue (antennaRows));
+  nrHelper->SetUeAntennaAttribute ("NumRows", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("NumColumns", UintegerValue (2));
+  nrHelper->SetGnbAntennaAttribute ("AntennaElement", PointerValue (CreateObject<ThreeGppAntennaModel> ()));
+  nrHelper->SetUeAntennaAttribute ("AntennaElement", PointerValue (CreateObject<ThreeGppAntennaModel> ()));
+
+  NetDeviceContainer gnbDevs = nrHelper->InstallGnbDevice (gnbNodes, allBwps);
+  NetDeviceContainer ueDevs = nrHelper->InstallUeDevice (ueNodes, allBwps);
+  DynamicCast<NrGnbNetDevice> (gnbDevs.Get (0))->UpdateConfig ();
+  DynamicCast<NrUeNetDevice> (ueDevs.Get (0))->UpdateConfig ();
+
+  Ptr<NrSpectrumPhy> gnbSpectrumPhy = nrHelper->GetGnbPhy (gnbDevs.Get (0), 0)->GetSpectrumPhy (0);
+  Ptr<SpectrumChannel> spectrumChannel = gnbSpectrumPhy->GetSpectrumChannel ();
+  Ptr<ThreeGppPropagationLossModel> propagationLossModel = DynamicCast<ThreeGppPropagationLossModel> (spectrumChannel->GetPropagationLossModel ());
+  NS_ASSERT (propagationLossModel != nullptr);
+  propagationLossModel->AssignStreams (1);
+  propagationLossModel->GetChannelConditionModel ()->AssignStreams (1);
+  Ptr<ThreeGppSpectrumPropagationLossModel> spectrumLossModel = DynamicCast<ThreeGppSpectrumPropagationLossModel> (spectrumChannel->GetPhasedArraySpectrumPropagationLossModel ());
+  NS_ASSERT (spectrumLossModel != nullptr);
+  DynamicCast<ThreeGppChannelModel> (spectrumLossModel->GetChannelModel ())->AssignStreams (1);
+
+  return std::make_pair (gnbSpectrumPhy, nrHelper->GetUePhy (ueDevs.Get (0), 0)->GetSpectrumPhy (0));
+}
+
+int
+main (int argc, char *argv[])
+{
+  uint32_t seed = 1;
+  uint32_t repetitions = 5;
+  double iterationScale = 1.0;
+  std::string filter = "";
+  std::string schedulerType = "ns3::NrMacSchedulerOfdmaPF";
+  std::string outputFile = "";
+
+  CommandLine cmd;
+  cmd.AddValue ("seed",
+                "Seed of the random inputs",
+                seed);
+  cmd.AddValue ("repetitions",
+                "Number of timed repetitions of each benchmark",
+                repetitions);
+  cmd.AddValue ("iterationScale",
+                "Multiplier of the number of operations of each repetition",
+                iterationScale);
+  cmd.AddValue ("filter",
+                "Run only the benchmarks whose name contains this string",
+                filter);
+  cmd.AddValue ("scheduler",
+                "TypeId name of the OFDMA scheduler of the DL scheduling benchmark",
+                schedulerType);
+  cmd.AddValue ("outputFile",
+                "File of the JSON report. If empty, the report is printed on the standard output",
+                outputFile);
+  cmd.Parse (argc, argv);
+
+  RngSeedManager::SetSeed (seed);
+  RngSeedManager::SetRun (1);
+
+  BenchmarkReport report (repetitions, filter);
+  auto iterations = [iterationScale] (uint32_t base)
+    {
+      return std::max<uint32_t> (1, static_cast<uint32_t> (base * iterationScale));
+    };
+  Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
+  rng->SetStream (1);
+
+  const uint16_t numerology = 1;
+  const double scs = 15e3 * std::pow (2, numerology);
+
+  if (report.IsEnabled ("ErrorModel"))
+    {
+      Ptr<const SpectrumModel> sm = NrSpectrumValueHelper::GetSpectrumModel (100, 28e9, scs);
+      Ptr<NrAmc> amc = CreateAmc (NrAmc::ErrorModel);
+      Ptr<NrEesmIrT1> errorModel = CreateObject<NrEesmIrT1> ();
+      std::vector<int> map (100);
+      std::iota (map.begin (), map.end (), 0);
+      for (uint8_t mcs : {5, 15, 27})
+        {
+          uint32_t tbSize = amc->CalculateTbSize (mcs, 100);
+          for (uint32_t retx : {0, 1})
+            {
+              SpectrumValue sinr = CreateRandomSinr (sm, rng, 0.0, 20.0);
+              NrErrorModel::NrErrorModelHistory history;
+              for (uint32_t i = 0; i < retx; ++i)
+                {
+                  history.push_back (errorModel->GetTbDecodificationStats (CreateRandomSinr (sm, rng, -5.0, 5.0),
+                                                                           map, tbSize, mcs, NrErrorModel::NrErrorModelHistory ()));
+                }
+              report.Run ("ErrorModel", {{"mcs", mcs}, {"rbs", 100}, {"retx", retx}}, iterations (20000),
+                          [&] (uint32_t n)
+                          {
+                            double checksum = 0.0;
+                            for (uint32_t i = 0; i < n; ++i)
+                              {
+                                checksum += errorModel->GetTbDecodificationStats (sinr, map, tbSize, mcs, history)->m_tbler;
+                              }
+                            return checksum;
+                          });
+            }
+        }
+    }
+
+  if (report.IsEnabled ("AmcCqi"))
+    {
+      for (auto amcModel : {NrAmc::ErrorModel, NrAmc::ShannonModel})
+        {
+          Ptr<NrAmc> amc = CreateAmc (amcModel);
+          for (uint32_t rbs : {25, 100, 273})
+            {
+              SpectrumValue sinr = CreateRandomSinr (NrSpectrumValueHelper::GetSpectrumModel (rbs, 28e9, scs), rng, -5.0, 25.0);
+              report.Run ("AmcCqi", {{"errorModel", amcModel == NrAmc::ErrorModel}, {"rbs", rbs}}, iterations (20000),
+                          [&] (uint32_t n)
+                          {
+                            double checksum = 0.0;
+                            for (uint32_t i = 0; i < n; ++i)
+                              {
+                                uint8_t mcs = 0;
+                                checksum += amc->CreateCqiFeedbackWbTdma (sinr, mcs) + mcs;
+                              }
+                            return checksum;
+                          });
+            }
+        }
+    }
+
+  if (report.IsEnabled ("AmcTbSize"))
+    {
+      Ptr<NrAmc> amc = CreateAmc (NrAmc::ErrorModel);
+      report.Run ("AmcTbSize", {{"maxMcs", 27}, {"maxRbs", 273}}, iterations (200000),
+                  [&] (uint32_t n)
+                  {
+                    double checksum = 0.0;
+                    for (uint32_t i = 0; i < n; ++i)
+                      {
+                        checksum += amc->CalculateTbSize (static_cast<uint8_t> (i % 28), 1 + i % 273);
+                      }
+                    return checksum;
+                  });
+    }
+
+  if (report.IsEnabled ("OfdmaDlScheduling"))
+    {
+      for (uint16_t ues : {10, 100, 1000})
+        {
+          DlSchedulingBenchmark scheduling (schedulerType, ues, 272, numerology);
+          report.Run ("OfdmaDlScheduling", {{"ues", ues}, {"rbs", 272}, {"rbsPerRbg", 4}},
+                      iterations (ues >= 1000 ? 200 : 2000),
+                      [&] (uint32_t n) { return scheduling.Schedule (n); });
+        }
+    }
+
+  Ptr<const SpectrumModel> interferenceSm = NrSpectrumValueHelper::GetSpectrumModel (100, 28e9, scs);
+  Ptr<SpectrumValue> noise = Create<SpectrumValue> (interferenceSm);
+  (*noise) = 1e-17;
+  Ptr<const SpectrumValue> rxPsd = Create<SpectrumValue> (CreateRandomSinr (interferenceSm, rng, -130.0, -120.0) * 1e-3);
+  const Time rxDuration = MicroSeconds (500);
+
+  if (report.IsEnabled ("Interference"))
+    {
+      for (uint32_t signals : {1, 10, 100})
+        {
+          std::vector<Ptr<const SpectrumValue> > interferers;
+          for (uint32_t s = 0; s < signals; ++s)
+            {
+              interferers.push_back (Create<SpectrumValue> (CreateRandomSinr (interferenceSm, rng, -140.0, -125.0) * 1e-3));
+            }
+
+          Ptr<NrInterference> interference = CreateObject<NrInterference> ();
+          interference->SetNoisePowerSpectralDensity (noise);
+          Ptr<LteChunkProcessor> sinrProcessor = Create<LteChunkProcessor> ();
+          sinrProcessor->AddCallback (MakeCallback (&AddChunkToChecksum));
+          interference->AddSinrChunkProcessor (sinrProcessor);
+          report.Run ("Interference", {{"signals", signals}, {"rbs", 100}}, iterations (signals >= 100 ? 200 : 2000),
+                      [&] (uint32_t n)
+                      {
+                        g_chunkChecksum = 0.0;
+                        for (uint32_t i = 0; i < n; ++i)
+                          {
+                            interference->StartRx (rxPsd);
+                            interference->AddSignal (rxPsd, rxDuration);
+                            for (uint32_t s = 0; s < signals; ++s)
+                              {
+                                // Interferers that end during the reception split it in chunks
+                                interference->AddSignal (interferers.at (s), NanoSeconds (rxDuration.GetNanoSeconds () * (s + 1) / signals));
+                              }
+                            Simulator::Schedule (rxDuration, &NrInterference::EndRx, interference);
+                            Simulator::Run ();
+                          }
+                        return g_chunkChecksum;
+                      });
+        }
+    }
+
+  if (report.IsEnabled ("SlInterference"))
+    {
+      for (uint32_t signals : {1, 10, 100})
+        {
+          std::vector<Ptr<const SpectrumValue> > interferers;
+          for (uint32_t s = 0; s < signals; ++s)
+            {
+              interferers.push_back (Create<SpectrumValue> (CreateRandomSinr (interferenceSm, rng, -140.0, -125.0) * 1e-3));
+            }
+
+          Ptr<NrSlInterference> interference = CreateObject<NrSlInterference> ();
+          interference->SetNoisePowerSpectralDensity (noise);
+          Ptr<NrSlChunkProcessor> sinrProcessor = Create<NrSlChunkProcessor> ();
+          sinrProcessor->AddCallback (MakeCallback (&AddSlChunksToChecksum));
+          interference->AddSinrChunkProcessor (sinrProcessor);
+          // Two simultaneous sidelink receptions, each evaluated separately
+          report.Run ("SlInterference", {{"signals", signals}, {"rxSignals", 2}, {"rbs", 100}},
+                      iterations (signals >= 100 ? 200 : 2000),
+                      [&] (uint32_t n)
+                      {
+                        g_chunkChecksum = 0.0;
+                        for (uint32_t i = 0; i < n; ++i)
+                          {
+                            interference->StartRx (rxPsd);
+                            interference->StartRx (interferers.at (0));
+                            interference->AddSignal (rxPsd, rxDuration);
+                            for (uint32_t s = 0; s < signals; ++s)
+                              {
+                                interference->AddSignal (interferers.at (s), NanoSeconds (rxDuration.GetNanoSeconds () * (s + 1) / signals));
+                              }
+                            Simulator::Schedule (rxDuration, &NrSlInterference::EndRx, interference);
+                            Simulator::Run ();
+                          }
+                        return g_chunkChecksum;
+                      });
+        }
+    }
+
+  if (report.IsEnabled ("SlSensingExclusion"))
+    {
+      const uint8_t numSubCh = 10;
+      const uint16_t cResel = 10;
+      const uint16_t rsvpSlots = 100;
+      const SfnSf start (0, 0, 0, 0);
+      for (uint32_t numSlots : {100, 1000})
+        {
+          std::vector<NrSlUeMacSchedSapProvider::NrSlSlotInfo> candidates;
+          for (uint32_t slot = 0; slot < numSlots; ++slot)
+            {
+              candidates.emplace_back (1, 0, 1, 1, 12, 10, 1, start.GetFutureSfnSf (slot),
+                                       std::set<uint8_t> ());
+            }
+          // Sensed transmissions over the whole span of the reservations,
+          // one SCI per transmission
+          std::vector<std::list<SlotSensingData> > sensingData;
+          for (uint32_t slot = 0; slot < numSlots + cResel * rsvpSlots; ++slot)
+            {
+              uint32_t numTx = rng->GetInteger (0, 3);
+              for (uint32_t t = 0; t < numTx; ++t)
+                {
+                  uint8_t sbChLength = static_cast<uint8_t> (rng->GetInteger (1, numSubCh));
+                  uint8_t sbChStart = static_cast<uint8_t> (rng->GetInteger (0, numSubCh - sbChLength));
+                  sensingData.push_back ({SlotSensingData (start.GetFutureSfnSf (slot), rsvpSlots, sbChLength,
+                                                           sbChStart, 1, rng->GetValue (-130.0, -60.0))});
+                }
+            }
+          report.Run ("SlSensingExclusion", {{"slots", numSlots}, {"subChannels", numSubCh}, {"cResel", cResel}},
+                      iterations (numSlots >= 1000 ? 200 : 2000),
+                      [&] (uint32_t n)
+                      {
+                        double checksum = 0.0;
+                        for (uint32_t i = 0; i < n; ++i)
+                          {
+                            checksum += NrUeMac::ExcludeSensedCandidates (sensingData, candidates, rsvpSlots,
+                                                                          cResel, numSubCh, -128,
+                                                                          numSlots / 5).size ();
+                          }
+                        return checksum;
+                      });
+        }
+    }
+
+  if (report.IsEnabled ("PhySlotQueues"))
+    {
+      const uint32_t l1l2 = 2;
+      auto dlDci = std::make_shared<DciInfoElementTdma> (1, 6, DciInfoElementTdma::DL, DciInfoElementTdma::DATA,
+                                                         std::vector<uint8_t> (17, 1));
+      auto ulDci = std::make_shared<DciInfoElementTdma> (7, 6, DciInfoElementTdma::UL, DciInfoElementTdma::DATA,
+                                                         std::vector<uint8_t> (17, 1));
+      Ptr<NrControlMessage> msg = Create<NrDlDciMessage> (dlDci);
+      for (uint32_t window : {4, 16})
+        {
+          // Allocations up to the L1L2 latency plus K0/K2 of the window
+          ListSlotQueues listQueues (l1l2, l1l2 + window);
+          RingSlotQueues ringQueues (l1l2, l1l2 + window);
+          for (bool ring : {false, true})
+            {
+              report.Run ("PhySlotQueues", {{"ring", ring}, {"window", l1l2 + window}}, iterations (200000),
+                          [&] (uint32_t n)
+                          {
+                            SfnSf start (0, 0, 0, numerology);
+                            return ring ? RunSlotQueues (ringQueues, start, n, l1l2 + window, dlDci, ulDci, msg)
+                                        : RunSlotQueues (listQueues, start, n, l1l2 + window, dlDci, ulDci, msg);
+                          });
+            }
+        }
+    }
+
+  if (report.IsEnabled ("LcgAssignment"))
+    {
+      // A TB of 1000 bytes per LC with 32 LCs
+      const uint32_t tbs = 32000;
+      for (uint8_t lcs : {4, 32})
+        {
+          for (bool indexed : {false, true})
+            {
+              report.Run ("LcgAssignment", {{"indexed", indexed}, {"lcs", lcs}}, iterations (20000),
+                          [&] (uint32_t n)
+                          {
+                            if (! indexed)
+                              {
+                                MapLcg lcg;
+                                for (uint8_t lcId = 1; lcId <= lcs; ++lcId)
+                                  {
+                                    lcg.Insert (lcId);
+                                  }
+                                return RunLcgAssignment (lcg, lcs, n, tbs);
+                              }
+                            NrMacSchedulerLCG lcg (1);
+                            for (uint8_t lcId = 1; lcId <= lcs; ++lcId)
+                              {
+                                LogicalChannelConfigListElement_s conf {};
+                                conf.m_logicalChannelIdentity = lcId;
+                                conf.m_qci = 9;
+                                lcg.Insert (LCPtr (new NrMacSchedulerLC (conf)));
+                              }
+                            return RunLcgAssignment (lcg, lcs, n, tbs);
+                          });
+            }
+        }
+    }
+
+  // Last, because the installed devices keep the simulator busy
+  if (report.IsEnabled ("CellScanBeamforming"))
+    {
+      for (uint32_t antennaRows : {2, 4, 8})
+        {
+          auto spectrumPhys = InstallBeamformingScenario (antennaRows);
+          Ptr<CellScanBeamforming> beamforming = CreateObject<CellScanBeamforming> ();
+          report.Run ("CellScanBeamforming", {{"gnbAntennaRows", antennaRows}, {"ueAntennaRows", 2}},
+                      iterations (antennaRows >= 8 ? 5 : 20),
+                      [&] (uint32_t n)
+                      {
+                        double checksum = 0.0;
+                        for (uint32_t i = 0; i < n; ++i)
+                          {
+                            BeamformingVectorPair bfPair = beamforming->GetBeamformingVectors (spectrumPhys.first,
+                                                                                               spectrumPhys.second);
+                            checksum += bfPair.first.second.GetSector () + bfPair.first.second.GetElevation () +
+                              bfPair.second.second.GetSector () + bfPair.second.second.GetElevation ();
+                          }
+                        return checksum;
+                      });
+        }
+    }
+
+  if (outputFile.empty ())
+    {
+      report.Write (std::cout, seed);
+    }
+  else
+    {
+      std::ofstream file (outputFile);
+      NS_ABORT_MSG_UNLESS (file.is_open (), "Can't open file " << outputFile);
+      report.Write (file, seed);
+    }
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,216 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * \ingroup examples
+ * \file cttc-nr-startup-time.cc
+ * \brief Measure the startup time of large NR topologies
+ *
+ * The example builds a grid topology with many UEs (10000 by default), and
+ * measures the wall-clock time spent in each phase of the setup: the
+ * creation of the scenario, the initialization of the operation band, the
+ * installation of the gNB and UE devices, and the connection of the traces.
+ *
+ * With the option directTraces, the PHY and MAC traces are connected while
+ * the devices are installed (see NrHelper::EnableTracesAtInstall ()), instead
+ * of through the wildcard config paths of NrHelper::EnableTraces (). Run the
+ * example twice to compare the two ways:
+ *
+ * \code{.unparsed}
+$ ./ns3 run "cttc-nr-startup-time --ueNum=10000 --directTraces=0"
+$ ./ns3 run "cttc-nr-startup-time --ueNum=10000 --directTraces=1"
+    \endcode
+ *
+ * The simulation is then run for a few slots, so that the time to the first
+ * simulated slot is included as well. At the end, the breakdown of the time
+ * spent inside NrHelper (see NrHelper::GetStartupProfile ()) is printed.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/nr-module.h"
+#include "ns3/antenna-module.h"
+#include <chrono>
+#include <iomanip>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("CttcNrStartupTime");
+
+/**
+ * \brief Wall-clock stopwatch, to measure each startup phase
+ */
+class StartupTimer
+{
+public:
+  StartupTimer ()
+    : m_start (std::chrono::steady_clock::now ()),
+      m_last (m_start)
+  {
+  }
+
+  /**
+   * \brief Print the time elapsed since the end of the previous phase
+   * \param phase the name of the phase that just ended
+   */
+  void
+  Lap (const std::string &phase)
+  {
+    auto now = std::chrono::steady_clock::now ();
+    std::cout << std::left << std::setw (24) << phase
+              << std::right << std::setw (12) << std::fixed << std::setprecision (3)
+              << std::chrono::duration<double> (now - m_last).count () << " s" << std::endl;
+    m_last = now;
+  }
+
+  /**
+   * \brief Print the total time elapsed since the creation of the timer
+   */
+  void
+  Total () const
+  {
+    auto now = std::chrono::steady_clock::now ();
+    std::cout << std::left << std::setw (24) << "total"
+              << std::right << std::setw (12) << std::fixed << std::setprecision (3)
+              << std::chrono::duration<double> (now - m_start).count () << " s" << std::endl;
+  }
+
+private:
+  std::chrono::steady_clock::time_point m_start; //!< Creation time
+  std::chrono::steady_clock::time_point m_last;  //!< End of the last phase
+};
+
+int
+main (int argc, char *argv[])
+{
+  uint16_t gNbNum = 100;
+  uint32_t ueNum = 10000;
+  bool directTraces = true;
+  uint16_t numerology = 1;
+  double centralFrequency = 3.5e9;
+  double bandwidth = 20e6;
+  Time simTime = MilliSeconds (5);
+
+  CommandLine cmd;
+  cmd.AddValue ("gNbNum",
+                "The number of gNbs",
+                gNbNum);
+  cmd.AddValue ("ueNum",
+                "The total number of UEs",
+                ueNum);
+  cmd.AddValue ("directTraces",
+                "If true, connect the PHY and MAC traces while installing the devices; "
+                "otherwise, connect them through the config paths after the installation",
+                directTraces);
+  cmd.AddValue ("numerology",
+                "The numerology of the bandwidth part",
+                numerology);
+  cmd.AddValue ("centralFrequency",
+                "The central frequency of the band",
+                centralFrequency);
+  cmd.AddValue ("bandwidth",
+                "The bandwidth of the band",
+                bandwidth);
+  cmd.AddValue ("simTime",
+                "The simulated time after the setup",
+                simTime);
+  cmd.Parse (argc, argv);
+
+  NS_ABORT_MSG_IF (gNbNum == 0 || ueNum == 0, "At least one gNB and one UE are needed");
+
+  StartupTimer timer;
+
+  uint16_t columns = static_cast<uint16_t> (std::ceil (std::sqrt (gNbNum)));
+  GridScenarioHelper gridScenario;
+  gridScenario.SetRows (static_cast<uint16_t> (std::ceil (static_cast<double> (gNbNum) / columns)));
+  gridScenario.SetColumns (columns);
+  gridScenario.SetHorizontalBsDistance (200.0);
+  gridScenario.SetVerticalBsDistance (200.0);
+  gridScenario.SetBsHeight (10.0);
+  gridScenario.SetUtHeight (1.5);
+  gridScenario.SetSectorization (GridScenarioHelper::SINGLE);
+  gridScenario.SetBsNumber (gNbNum);
+  gridScenario.SetUtNumber (ueNum);
+  gridScenario.SetScenarioHeight (200.0 * columns);
+  gridScenario.SetScenarioLength (200.0 * columns);
+  gridScenario.AssignStreams (1);
+  gridScenario.CreateScenario ();
+  timer.Lap ("scenario");
+
+  Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper> ();
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  nrHelper->SetBeamformingHelper (idealBeamformingHelper);
+
+  CcBwpCreator ccBwpCreator;
+  CcBwpCreator::SimpleOperationBandConf bandConf (centralFrequency, bandwidth, 1, BandwidthPartInfo::UMa);
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+
+  Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (MilliSeconds (0)));
+  nrHelper->SetChannelConditionModelAttribute ("UpdatePeriod", TimeValue (MilliSeconds (0)));
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+
+  nrHelper->SetGnbPhyAttribute ("Numerology", UintegerValue (numerology));
+  idealBeamformingHelper->SetAttribute ("BeamformingMethod", TypeIdValue (DirectPathBeamforming::GetTypeId ()));
+  nrHelper->SetUeAntennaAttribute ("NumRows", UintegerValue (1));
+  nrHelper->SetUeAntennaAttribute ("NumColumns", UintegerValue (1));
+  nrHelper->SetGnbAntennaAttribute ("NumRows", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("NumColumns", UintegerValue (4));
+  timer.Lap ("operation band");
+
+  if (directTraces)
+    {
+      nrHelper->EnableTracesAtInstall ();
+    }
+
+  NetDeviceContainer gnbNetDev = nrHelper->InstallGnbDevice (gridScenario.GetBaseStations (), allBwps);
+  timer.Lap ("gNB installation");
+
+  NetDeviceContainer ueNetDev = nrHelper->InstallUeDevice (gridScenario.GetUserTerminals (), allBwps);
+  timer.Lap ("UE installation");
+
+  for (auto it = gnbNetDev.Begin (); it != gnbNetDev.End (); ++it)
+    {
+      DynamicCast<NrGnbNetDevice> (*it)->UpdateConfig ();
+    }
+  for (auto it = ueNetDev.Begin (); it != ueNetDev.End (); ++it)
+    {
+      DynamicCast<NrUeNetDevice> (*it)->UpdateConfig ();
+    }
+  timer.Lap ("configuration update");
+
+  nrHelper->EnableTraces ();
+  timer.Lap ("traces");
+
+  nrHelper->AttachToClosestEnb (ueNetDev, gnbNetDev);
+  timer.Lap ("attachment");
+
+  Simulator::Stop (simTime);
+  Simulator::Run ();
+  timer.Lap ("simulation");
+  timer.Total ();
+
+  std::cout << std::endl << "Breakdown of the NrHelper phases:" << std::endl;
+  nrHelper->PrintStartupProfile (std::cout);
+
+  Simulator::Destroy ();
+  return 0;
+}
@@ -0,0 +1,492 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/**
+ * \ingroup examples
+ * \file lena-lte-comparison-campaign-runner.cc
+ * \brief Run a campaign of lena-lte-comparison-campaign simulations in parallel
+ *
+ * The program takes a grid of parameters of lena-lte-comparison-campaign and
+ * a range of RNG runs, and runs one simulation for each point of the grid
+ * and each run, keeping at most maxProcesses simulations running at the
+ * same time. Each simulation is a separate process, with its own output
+ * directory and log file:
+ *
+ * \code{.unparsed}
+$ ./ns3 run "lena-lte-comparison-campaign-runner --campaignDir=my-campaign
+             --grid=ueNumPergNb=2,5,10;scheduler=PF,RR --numRuns=10
+             --baseArgs='--numRings=1 --appGenerationTime=+1s' --maxProcesses=8"
+    \endcode
+ *
+ * The grid is a list of parameters separated by ';', each with its values
+ * separated by ','. The arguments in baseArgs are passed to all the
+ * simulations. The key of a simulation is made of its grid values and its
+ * RNG run, e.g., "ueNumPergNb=5;scheduler=RR;RngRun=3".
+ *
+ * When a simulation ends, the tables of its database are copied into the
+ * campaign database (campaignDir/campaign.db), with the additional column
+ * RunKey, and the simulation is recorded in the table "campaign" (key,
+ * arguments, RNG run and wall-clock duration). The copy and the record are
+ * done in one transaction: if the campaign is interrupted, running it again
+ * with the same options runs only the simulations that are not in the
+ * campaign database.
+ */
+
+#include <ns3/command-line.h>
+#include <ns3/abort.h>
+#include <ns3/system-path.h>
+#include <ns3/sqlite-output.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+using namespace ns3;
+
+/**
+ * \brief A simulation of the campaign
+ */
+struct CampaignPoint
+{
+  std::string m_key;               //!< Key of the simulation, from its grid values and RNG run
+  std::vector<std::string> m_args; //!< Grid values, as command line arguments
+  uint32_t m_rngRun {0};           //!< RNG run
+  std::string m_outputDir;         //!< Output directory of the simulation
+};
+
+/**
+ * \brief Split a string
+ * \param str the string
+ * \param delimiter the delimiter
+ * \return the non-empty tokens
+ */
+static std::vector<std::string>
+Split (const std::string &str, char delimiter)
+{
+  std::vector<std::string> tokens;
+  std::istringstream stream (str);
+  std::string token;
+  while (std::getline (stream, token, delimiter))
+    {
+      if (! token.empty ())
+        {
+          tokens.push_back (token);
+        }
+    }
+  return tokens;
+}
+
+/**
+ * \brief Create the simulations of a campaign
+ * \param grid the grid, e.g., "ueNumPergNb=2,5;scheduler=PF,RR"
+ * \param firstRun the first RNG run
+ * \param numRuns the number of RNG runs
+ * \param campaignDir the directory of the campaign
+ * \return one simulation for each point of the grid and each run
+ */
+static std::vector<CampaignPoint>
+CreateCampaign (const std::string &grid, uint32_t firstRun, uint32_t numRuns,
+                const std::string &campaignDir)
+{
+  // Cartesian product of the values of the parameters, in the given order
+  std::vector<std::vector<std::pair<std::string, std::string> > > points (1);
+  for (const auto &param : Split (grid, ';'))
+    {
+      auto pos = param.find ('=');
+      NS_ABORT_MSG_IF (pos == std::string::npos || pos == 0, "Malformed grid parameter " << param);
+      std::string name = param.substr (0, pos);
+      std::vector<std::string> values = Split (param.substr (pos + 1), ',');
+      NS_ABORT_MSG_IF (values.empty (), "No values for the grid parameter " << name);
+
+      std::vector<std::vector<std::pair<std::string, std::string> > > product;
+      for (const auto &point : points)
+        {
+          for (const auto &value : values)
+            {
+              product.push_back (point);
+              product.back ().emplace_back (name, value);
+            }
+        }
+      points.swap (product);
+    }
+
+  std::vector<CampaignPoint> campaign;
+  for (const auto &point : points)
+    {
+      for (uint32_t run = firstRun; run < firstRun + numRuns; ++run)
+        {
+          CampaignPoint simulation;
+          simulation.m_rngRun = run;
+          for (const auto &param : point)
+            {
+              simulation.m_key += param.first + "=" + param.second + ";";
+              simulation.m_args.push_back ("--" + param.first + "=" + param.second);
+            }
+          simulation.m_key += "RngRun=" + std::to_string (run);
+
+          std::string dirName = simulation.m_key;
+          for (auto &c : dirName)
+            {
+              if (! std::isalnum (static_cast<unsigned char> (c)) && c != '-' && c != '.')
+                {
+                  c = '_';
+                }
+            }
+          simulation.m_outputDir = campaignDir + "/runs/" + dirName;
+          campaign.push_back (simulation);
+        }
+    }
+  return campaign;
+}
+
+/**
+ * \brief Runs the simulations of a campaign in a bounded pool of processes,
+ * and collects their results in the campaign database
+ */
+class CampaignRunner
+{
+public:
+  /**
+   * \brief CampaignRunner constructor
+   * \param program the path of the simulation program
+   * \param baseArgs the arguments passed to all the simulations
+   * \param dbName the name of the campaign database
+   */
+  CampaignRunner (const std::string &program, const std::vector<std::string> &baseArgs,
+                  const std::string &dbName)
+    : m_program (program),
+      m_baseArgs (baseArgs),
+      m_db (dbName)
+  {
+    bool ret = m_db.SpinExec ("CREATE TABLE IF NOT EXISTS campaign ("
+                              "RunKey TEXT PRIMARY KEY NOT NULL,"
+                              "Arguments TEXT NOT NULL,"
+                              "RngRun INTEGER NOT NULL,"
+                              "Duration DOUBLE NOT NULL);");
+    NS_ABORT_IF (ret == false);
+  }
+
+  /**
+   * \brief Get the keys of the simulations already in the campaign database
+   * \return the keys
+   */
+  std::set<std::string>
+  GetCompletedRuns ()
+  {
+    std::set<std::string> completed;
+    sqlite3_stmt *stmt;
+    bool ret = m_db.SpinPrepare (&stmt, "SELECT RunKey FROM campaign;");
+    NS_ABORT_IF (ret == false);
+    while (SQLiteOutput::SpinStep (stmt) == SQLITE_ROW)
+      {
+        completed.insert (reinterpret_cast<const char*> (sqlite3_column_text (stmt, 0)));
+      }
+    SQLiteOutput::SpinFinalize (stmt);
+    return completed;
+  }
+
+  /**
+   * \brief Run the simulations, and collect their results
+   * \param campaign the simulations
+   * \param maxProcesses the maximum number of simulations running at the same time
+   * \return the number of simulations that failed
+   */
+  uint32_t
+  Run (const std::vector<CampaignPoint> &campaign, uint32_t maxProcesses)
+  {
+    NS_ABORT_MSG_IF (maxProcesses == 0, "At least one process is needed");
+    std::map<pid_t, Process> running;
+    uint32_t next = 0;
+    uint32_t done = 0;
+    uint32_t failed = 0;
+
+    while (next < campaign.size () || ! running.empty ())
+      {
+        while (next < campaign.size () && running.size () < maxProcesses)
+          {
+            Process process;
+            process.m_point = &campaign.at (next++);
+            process.m_start = std::chrono::steady_clock::now ();
+            running.emplace (Launch (*process.m_point), process);
+          }
+
+        int status = 0;
+        pid_t pid = waitpid (-1, &status, 0);
+        NS_ABORT_MSG_IF (pid < 0, "waitpid failed: " << std::strerror (errno));
+        auto it = running.find (pid);
+        if (it == running.end ())
+          {
+            continue;
+          }
+        const CampaignPoint &point = *it->second.m_point;
+        double duration = std::chrono::duration<double> (std::chrono::steady_clock::now () - it->second.m_start).count ();
+        running.erase (it);
+        ++done;
+
+        if (WIFEXITED (status) && WEXITSTATUS (status) == 0)
+          {
+            Collect (point, duration);
+            std::cout << "[" << done << "/" << campaign.size () << "] " << point.m_key
+                      << " done in " << duration << " s" << std::endl;
+          }
+        else
+          {
+            ++failed;
+            std::cout << "[" << done << "/" << campaign.size () << "] " << point.m_key
+                      << " FAILED, see " << point.m_outputDir << "/run.log" << std::endl;
+          }
+      }
+    return failed;
+  }
+
+private:
+  /**
+   * \brief A running simulation
+   */
+  struct Process
+  {
+    const CampaignPoint *m_point {nullptr};              //!< The simulation
+    std::chrono::steady_clock::time_point m_start;       //!< Start of the simulation
+  };
+
+  /**
+   * \brief Get all the arguments of a simulation
+   * \param point the simulation
+   * \return the arguments, without the program
+   */
+  std::vector<std::string>
+  GetArguments (const CampaignPoint &point) const
+  {
+    // The last value of an argument wins, so the grid values override the base ones
+    std::vector<std::string> args = m_baseArgs;
+    args.insert (args.end (), point.m_args.begin (), point.m_args.end ());
+    args.push_back ("--RngRun=" + std::to_string (point.m_rngRun));
+    args.push_back ("--outputDir=" + point.m_outputDir);
+    args.push_back ("--simTag=run");
+    return args;
+  }
+
+  /**
+   * \brief Start a simulation in a new process, with its output redirected
+   * to the log file of its directory
+   * \param point the simulation
+   * \return the pid of the process
+   */
+  pid_t
+  Launch (const CampaignPoint &point) const
+  {
+    SystemPath::MakeDirectories (point.m_outputDir);
+    // Remove the results of an interrupted execution
+    std::remove ((point.m_outputDir + "/run.db").c_str ());
+
+    std::vector<std::string> args = GetArguments (point);
+    std::vector<char*> argv;
+    argv.push_back (const_cast<char*> (m_program.c_str ()));
+    for (auto &arg : args)
+      {
+        argv.push_back (const_cast<char*> (arg.c_str ()));
+      }
+    argv.push_back (nullptr);
+    std::string logFile = point.m_outputDir + "/run.log";
+
+    pid_t pid = fork ();
+    NS_ABORT_MSG_IF (pid < 0, "fork failed: " << std::strerror (errno));
+    if (pid == 0)
+      {
+        int fd = open (logFile.c_str (), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd >= 0)
+          {
+            dup2 (fd, STDOUT_FILENO);
+            dup2 (fd, STDERR_FILENO);
+            close (fd);
+          }
+        execv (m_program.c_str (), argv.data ());
+        std::cerr << "Can't execute " << m_program << ": " << std::strerror (errno) << std::endl;
+        _exit (127);
+      }
+    return pid;
+  }
+
+  /**
+   * \brief Copy the tables of the database of a simulation into the campaign
+   * database, and record the simulation as completed
+   * \param point the simulation
+   * \param duration the wall-clock duration of the simulation, in s
+   */
+  void
+  Collect (const CampaignPoint &point, double duration)
+  {
+    std::string runDb = point.m_outputDir + "/run.db";
+    bool hasDb = (access (runDb.c_str (), F_OK) == 0);
+    bool ret;
+    sqlite3_stmt *stmt;
+
+    std::vector<std::string> tables;
+    if (hasDb)
+      {
+        ret = m_db.SpinPrepare (&stmt, "ATTACH DATABASE ? AS run;");
+        NS_ABORT_IF (ret == false);
+        ret = m_db.Bind (stmt, 1, runDb);
+        NS_ABORT_IF (ret == false);
+        ret = m_db.SpinExec (stmt);
+        NS_ABORT_MSG_IF (ret == false, "Can't open " << runDb);
+
+        ret = m_db.SpinPrepare (&stmt, "SELECT name FROM run.sqlite_master WHERE type = 'table';");
+        NS_ABORT_IF (ret == false);
+        while (SQLiteOutput::SpinStep (stmt) == SQLITE_ROW)
+          {
+            tables.emplace_back (reinterpret_cast<const char*> (sqlite3_column_text (stmt, 0)));
+          }
+        SQLiteOutput::SpinFinalize (stmt);
+      }
+
+    ret = m_db.SpinExec ("BEGIN TRANSACTION;");
+    NS_ABORT_IF (ret == false);
+    for (const auto &table : tables)
+      {
+        ret = m_db.SpinExec ("CREATE TABLE IF NOT EXISTS main.\"" + table + "\" AS "
+                             "SELECT '' AS RunKey, * FROM run.\"" + table + "\" WHERE 0;");
+        NS_ABORT_IF (ret == false);
+        ret = m_db.SpinPrepare (&stmt, "INSERT INTO main.\"" + table + "\" "
+                                "SELECT ?, * FROM run.\"" + table + "\";");
+        NS_ABORT_IF (ret == false);
+        ret = m_db.Bind (stmt, 1, point.m_key);
+        NS_ABORT_IF (ret == false);
+        ret = m_db.SpinExec (stmt);
+        NS_ABORT_MSG_IF (ret == false, "Can't copy the table " << table << " of " << runDb <<
+                         ": are its columns the same of the other simulations?");
+      }
+
+    std::string arguments;
+    for (const auto &arg : GetArguments (point))
+      {
+        arguments += (arguments.empty () ? "" : " ") + arg;
+      }
+    ret = m_db.SpinPrepare (&stmt, "INSERT INTO campaign VALUES (?,?,?,?);");
+    NS_ABORT_IF (ret == false);
+    ret = m_db.Bind (stmt, 1, point.m_key);
+    NS_ABORT_IF (ret == false);
+    ret = m_db.Bind (stmt, 2, arguments);
+    NS_ABORT_IF (ret == false);
+    ret = m_db.Bind (stmt, 3, point.m_rngRun);
+    NS_ABORT_IF (ret == false);
+    ret = m_db.Bind (stmt, 4, duration);
+    NS_ABORT_IF (ret == false);
+    ret = m_db.SpinExec (stmt);
+    NS_ABORT_IF (ret == false);
+
+    ret = m_db.SpinExec ("END TRANSACTION;");
+    NS_ABORT_IF (ret == false);
+
+    if (hasDb)
+      {
+        ret = m_db.SpinExec ("DETACH DATABASE run;");
+        NS_ABORT_IF (ret == false);
+      }
+  }
+
+  std::string m_program;               //!< Path of the simulation program
+  std::vector<std::string> m_baseArgs; //!< Arguments of all the simulations
+  SQLiteOutput m_db;                   //!< Campaign database
+};
+
+int
+main (int argc, char *argv[])
+{
+  std::string program = "";
+  std::string grid = "";
+  std::string baseArgs = "";
+  std::string campaignDir = "./campaign";
+  uint32_t firstRun = 1;
+  uint32_t numRuns = 1;
+  uint32_t maxProcesses = std::max (1u, std::thread::hardware_concurrency ());
+
+  CommandLine cmd;
+  cmd.AddValue ("program",
+                "Path of the simulation program. If empty, the lena-lte-comparison-campaign "
+                "program next to this one is used",
+                program);
+  cmd.AddValue ("grid",
+                "Grid of parameters, e.g., ueNumPergNb=2,5,10;scheduler=PF,RR",
+                grid);
+  cmd.AddValue ("baseArgs",
+                "Arguments, separated by spaces, passed to all the simulations",
+                baseArgs);
+  cmd.AddValue ("campaignDir",
+                "Directory of the campaign database and of the outputs of the simulations",
+                campaignDir);
+  cmd.AddValue ("firstRun",
+                "First RNG run",
+                firstRun);
+  cmd.AddValue ("numRuns",
+                "Number of RNG runs of each point of the grid",
+                numRuns);
+  cmd.AddValue ("maxProcesses",
+                "Maximum number of simulations running at the same time",
+                maxProcesses);
+  cmd.Parse (argc, argv);
+
+  if (program.empty ())
+    {
+      program = argv[0];
+      const std::string self = "lena-lte-comparison-campaign-runner";
+      auto pos = program.rfind (self);
+      NS_ABORT_MSG_IF (pos == std::string::npos, "Can't find the simulation program, please set it with --program");
+      program.replace (pos, self.size (), "lena-lte-comparison-campaign");
+    }
+  NS_ABORT_MSG_IF (access (program.c_str (), X_OK) != 0, "Can't execute " << program);
+
+  SystemPath::MakeDirectories (campaignDir);
+  CampaignRunner runner (program, Split (baseArgs, ' '), campaignDir + "/campaign.db");
+
+  std::vector<CampaignPoint> campaign = CreateCampaign (grid, firstRun, numRuns, campaignDir);
+  std::set<std::string> completed = runner.GetCompletedRuns ();
+  std::vector<CampaignPoint> pending;
+  for (const auto &point : campaign)
+    {
+      if (completed.find (point.m_key) == completed.end ())
+        {
+          pending.push_back (point);
+        }
+    }
+  std::cout << "Campaign of " << campaign.size () << " simulations, " << campaign.size () - pending.size ()
+            << " already completed, running " << pending.size () << " on up to " << maxProcesses
+            << " processes" << std::endl;
+
+  uint32_t failed = runner.Run (pending, maxProcesses);
+  if (failed > 0)
+    {
+      std::cout << failed << " simulations failed; run the campaign again to retry them" << std::endl;
+      return 1;
+    }
+  return 0;
+}
@@ -75,6 +75,7 @@ $ ./ns3 run "nr-v2x-west-to-east-highway --help"
 #include "ue-phy-pssch-rx-output-stats.h"
 #include "ue-to-ue-pkt-txrx-output-stats.h"
 #include "v2x-kpi.h"
+#include "v2x-kpi-streaming.h"
 #include "ue-rlc-rx-output-stats.h"
 #include "ns3/antenna-module.h"
 #include <iomanip>
@@ -168,6 +169,52 @@ UePacketTraceDb (UeToUePktTxRxOutputStats *stats, Ptr<Node> node, const Address
   stats->Save (txRx, localAddrs, nodeId, imsi, pktSize, srcAddrs, dstAddrs, seq);
 }
 
+/**
+ * \brief Method to listen the application level traces of type TxWithAddresses
+ *        and RxWithAddresses, and to account them in the streaming KPIs.
+ * \param kpi Pointer to the V2xKpiStreaming class, which computes the KPIs
+ *        during the simulation.
+ * \param node The pointer to the TX or RX node
+ * \param localAddrs The local IPV4 address of the node
+ * \param txRx The string indicating the type of node, i.e., TX or RX
+ * \param p The packet
+ * \param srcAddrs The source address from the trace
+ * \param dstAddrs The destination address from the trace
+ * \param seqTsSizeHeader The SeqTsSizeHeader
+ */
+void
+UePacketTraceStreamingKpi (V2xKpiStreaming *kpi, Ptr<Node> node, const Address &localAddrs,
+                           std::string txRx, Ptr<const Packet> p, const Address &srcAddrs,
+                           [[maybe_unused]] const Address &dstAddrs, const SeqTsSizeHeader &seqTsSizeHeader)
+{
+  uint64_t imsi = node->GetDevice (0)->GetObject<NrUeNetDevice> ()->GetImsi ();
+  uint32_t pktSize = p->GetSize () + seqTsSizeHeader.GetSerializedSize ();
+
+  kpi->NotifyPacket (txRx, node->GetId (), imsi, localAddrs, srcAddrs, pktSize, seqTsSizeHeader.GetSeq ());
+}
+
+/**
+ * \brief Method to listen the trace SlPsschScheduling of NrUeMac, and to
+ *        account it in the streaming KPIs.
+ * \param kpi Pointer to the V2xKpiStreaming class
+ * \param psschStatsParams Parameters of the trace source.
+ */
+void NotifySlPsschSchedulingStreamingKpi (V2xKpiStreaming *kpi, const SlPsschUeMacStatParameters psschStatsParams)
+{
+  kpi->NotifyPsschTx (psschStatsParams);
+}
+
+/**
+ * \brief Method to listen the trace RxPsschTraceUe of NrSpectrumPhy, and to
+ *        account it in the streaming KPIs.
+ * \param kpi Pointer to the V2xKpiStreaming class
+ * \param psschStatsParams Parameters of the trace source.
+ */
+void NotifySlPsschRxStreamingKpi (V2xKpiStreaming *kpi, const SlRxDataPacketTraceParams psschStatsParams)
+{
+  kpi->NotifyPsschRx (psschStatsParams);
+}
+
 /**
  * \brief Trace sink for RxRlcPduWithTxRnti trace of NrUeMac
  * \param stats Pointer to UeRlcRxOutputStats API responsible to write the
@@ -399,9 +446,11 @@ GetSlBitmapFromString (std::string slBitMapString, std::vector <std::bitset<1> >
 
 /**
  * \brief Save position of the UE as per its IP address
- * \param v2xKpi pointer to the V2xKpi API storing the IP of an UE and its position.
+ * \param v2xKpi pointer to the V2xKpi or V2xKpiStreaming API storing the IP
+ *        of an UE and its position.
  */
-void SavePositionPerIP (V2xKpi *v2xKpi)
+template <typename KPI>
+void SavePositionPerIP (KPI *v2xKpi)
 {
   for (NodeList::Iterator it = NodeList::Begin (); it != NodeList::End (); ++it)
       {
@@ -478,6 +527,10 @@ main (int argc, char *argv[])
   bool generateInitialPosGnuScript = false;
   bool generateGifGnuScript = false;
 
+  // KPIs computed during the simulation, instead of from the database
+  bool streamingKpis = false;
+  bool checkStreamingKpis = false;
+
   // Where we will store the output files.
   std::string simTag = "default";
   std::string outputDir = "./";
@@ -603,7 +656,14 @@ main (int argc, char *argv[])
   cmd.AddValue ("generateGifGnuScript",
                 "generate gnuplot script to generate GIF to show UEs mobility",
                 generateGifGnuScript);
-
+  cmd.AddValue ("streamingKpis",
+                "Compute the V2X KPIs during the simulation, without storing "
+                "the application packets in the database",
+                streamingKpis);
+  cmd.AddValue ("checkStreamingKpis",
+                "Compute the V2X KPIs both during the simulation and from the "
+                "database, and abort if they differ",
+                checkStreamingKpis);
 
   // Parse the command line
   cmd.Parse (argc, argv);
@@ -1143,6 +1203,18 @@ main (int argc, char *argv[])
   Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::NrUeNetDevice/ComponentCarrierMapUe/*/NrUeMac/RxRlcPduWithTxRnti",
                                  MakeBoundCallback (&NotifySlRlcPduRx, &ueRlcRxStats));
 
+  // The application packets are stored only if the KPIs are computed from the database
+  bool storePktRows = !streamingKpis || checkStreamingKpis;
+  bool useStreamingKpis = streamingKpis || checkStreamingKpis;
+  V2xKpiStreaming streamingKpi;
+  if (useStreamingKpis)
+    {
+      Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::NrUeNetDevice/ComponentCarrierMapUe/*/NrUeMac/SlPsschScheduling",
+                                     MakeBoundCallback (&NotifySlPsschSchedulingStreamingKpi, &streamingKpi));
+      Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/$ns3::NrUeNetDevice/ComponentCarrierMapUe/*/NrUePhy/NrSpectrumPhyList/*/RxPsschTraceUe",
+                                     MakeBoundCallback (&NotifySlPsschRxStreamingKpi, &streamingKpi));
+    }
+
 
 
   UeToUePktTxRxOutputStats pktStats;
@@ -1155,7 +1227,14 @@ main (int argc, char *argv[])
         {
           Ipv4Address localAddrs =  clientApps.Get (ac)->GetNode ()->GetObject<Ipv4L3Protocol> ()->GetAddress (1,0).GetLocal ();
           std::cout << "Tx address: " << localAddrs << std::endl;
-          clientApps.Get (ac)->TraceConnect ("TxWithSeqTsSize", "tx", MakeBoundCallback (&UePacketTraceDb, &pktStats, clientApps.Get (ac)->GetNode (), localAddrs));
+          if (storePktRows)
+            {
+              clientApps.Get (ac)->TraceConnect ("TxWithSeqTsSize", "tx", MakeBoundCallback (&UePacketTraceDb, &pktStats, clientApps.Get (ac)->GetNode (), localAddrs));
+            }
+          if (useStreamingKpis)
+            {
+              clientApps.Get (ac)->TraceConnect ("TxWithSeqTsSize", "tx", MakeBoundCallback (&UePacketTraceStreamingKpi, &streamingKpi, clientApps.Get (ac)->GetNode (), localAddrs));
+            }
         }
 
       // Set Rx traces
@@ -1163,7 +1242,14 @@ main (int argc, char *argv[])
         {
           Ipv4Address localAddrs =  serverApps.Get (ac)->GetNode ()->GetObject<Ipv4L3Protocol> ()->GetAddress (1,0).GetLocal ();
           std::cout << "Rx address: " << localAddrs << std::endl;
-          serverApps.Get (ac)->TraceConnect ("RxWithSeqTsSize", "rx", MakeBoundCallback (&UePacketTraceDb, &pktStats, serverApps.Get (ac)->GetNode (), localAddrs));
+          if (storePktRows)
+            {
+              serverApps.Get (ac)->TraceConnect ("RxWithSeqTsSize", "rx", MakeBoundCallback (&UePacketTraceDb, &pktStats, serverApps.Get (ac)->GetNode (), localAddrs));
+            }
+          if (useStreamingKpis)
+            {
+              serverApps.Get (ac)->TraceConnect ("RxWithSeqTsSize", "rx", MakeBoundCallback (&UePacketTraceStreamingKpi, &streamingKpi, serverApps.Get (ac)->GetNode (), localAddrs));
+            }
         }
     }
   else
@@ -1174,7 +1260,14 @@ main (int argc, char *argv[])
           clientApps.Get (ac)->GetNode ()->GetObject<Ipv6L3Protocol> ()->AddMulticastAddress (groupAddress6);
           Ipv6Address localAddrs =  clientApps.Get (ac)->GetNode ()->GetObject<Ipv6L3Protocol> ()->GetAddress (1,1).GetAddress ();
           std::cout << "Tx address: " << localAddrs << std::endl;
-          clientApps.Get (ac)->TraceConnect ("TxWithSeqTsSize", "tx", MakeBoundCallback (&UePacketTraceDb, &pktStats, clientApps.Get (ac)->GetNode (), localAddrs));
+          if (storePktRows)
+            {
+              clientApps.Get (ac)->TraceConnect ("TxWithSeqTsSize", "tx", MakeBoundCallback (&UePacketTraceDb, &pktStats, clientApps.Get (ac)->GetNode (), localAddrs));
+            }
+          if (useStreamingKpis)
+            {
+              clientApps.Get (ac)->TraceConnect ("TxWithSeqTsSize", "tx", MakeBoundCallback (&UePacketTraceStreamingKpi, &streamingKpi, clientApps.Get (ac)->GetNode (), localAddrs));
+            }
         }
 
       // Set Rx traces
@@ -1183,7 +1276,14 @@ main (int argc, char *argv[])
           serverApps.Get (ac)->GetNode ()->GetObject<Ipv6L3Protocol> ()->AddMulticastAddress (groupAddress6);
           Ipv6Address localAddrs =  serverApps.Get (ac)->GetNode ()->GetObject<Ipv6L3Protocol> ()->GetAddress (1,1).GetAddress ();
           std::cout << "Rx address: " << localAddrs << std::endl;
-          serverApps.Get (ac)->TraceConnect ("RxWithSeqTsSize", "rx", MakeBoundCallback (&UePacketTraceDb, &pktStats, serverApps.Get (ac)->GetNode (), localAddrs));
+          if (storePktRows)
+            {
+              serverApps.Get (ac)->TraceConnect ("RxWithSeqTsSize", "rx", MakeBoundCallback (&UePacketTraceDb, &pktStats, serverApps.Get (ac)->GetNode (), localAddrs));
+            }
+          if (useStreamingKpis)
+            {
+              serverApps.Get (ac)->TraceConnect ("RxWithSeqTsSize", "rx", MakeBoundCallback (&UePacketTraceStreamingKpi, &streamingKpi, serverApps.Get (ac)->GetNode (), localAddrs));
+            }
         }
     }
 
@@ -1193,6 +1293,10 @@ main (int argc, char *argv[])
   SavePositionPerIP (&v2xKpi);
   v2xKpi.SetRangeForV2xKpis (200);
 
+  streamingKpi.SetTxAppDuration (txAppDuration);
+  SavePositionPerIP (&streamingKpi);
+  streamingKpi.SetRangeForV2xKpis (200);
+
   if (generateInitialPosGnuScript)
     {
       std::string initPosFileName = "init-pos-ues-" + exampleName + ".txt";
@@ -1223,7 +1327,21 @@ main (int argc, char *argv[])
   pscchPhyStats.EmptyCache ();
   psschPhyStats.EmptyCache ();
   ueRlcRxStats.EmptyCache ();
-  v2xKpi.WriteKpis ();
+  if (storePktRows)
+    {
+      v2xKpi.WriteKpis ();
+    }
+  if (checkStreamingKpis)
+    {
+      streamingKpi.WriteKpis (&db, "Streaming");
+      uint32_t mismatches = V2xKpiStreaming::CompareWithV2xKpi (&db, "Streaming", 1e-6);
+      NS_ABORT_MSG_IF (mismatches > 0, "The streaming KPIs differ from the KPIs of the database in "
+                       << mismatches << " rows");
+    }
+  else if (streamingKpis)
+    {
+      streamingKpi.WriteKpis (&db);
+    }
 
   //GtkConfigStore config;
   // config.ConfigureAttributes ();
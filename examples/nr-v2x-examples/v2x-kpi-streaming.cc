@@ -0,0 +1,788 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "v2x-kpi-streaming.h"
+#include <ns3/internet-module.h>
+#include <ns3/rng-seed-manager.h>
+#include <ns3/abort.h>
+#include <sqlite3.h>
+#include <algorithm>
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("V2xKpiStreaming");
+
+V2xKpiStreaming::V2xKpiStreaming ()
+{}
+
+void
+V2xKpiStreaming::SetTxAppDuration (double duration)
+{
+  m_txAppDuration = duration;
+}
+
+void
+V2xKpiStreaming::ConsiderAllTx (bool allTx)
+{
+  m_considerAllTx = allTx;
+}
+
+void
+V2xKpiStreaming::FillPosPerIpMap (std::string ip, Vector pos)
+{
+  bool insertStatus = m_posPerIp.insert (std::make_pair (ip, pos)).second;
+  NS_ABORT_MSG_IF (insertStatus == false, "Insert Error: Pos of the ip " << ip << " already exist in the map");
+}
+
+void
+V2xKpiStreaming::SetRangeForV2xKpis (uint16_t range)
+{
+  m_range = range;
+}
+
+void
+V2xKpiStreaming::SetDistanceBinWidth (double width)
+{
+  NS_ABORT_MSG_IF (width <= 0.0, "The width of the distance bins must be positive");
+  m_distanceBinWidth = width;
+}
+
+uint32_t
+V2xKpiStreaming::GetIpIndex (const Address &ip)
+{
+  auto it = m_ipIndex.find (ip);
+  if (it != m_ipIndex.end ())
+    {
+      return it->second;
+    }
+
+  std::ostringstream oss;
+  if (Ipv4Address::IsMatchingType (ip))
+    {
+      oss << Ipv4Address::ConvertFrom (ip);
+    }
+  else if (Ipv6Address::IsMatchingType (ip))
+    {
+      oss << Ipv6Address::ConvertFrom (ip);
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown address type!");
+    }
+  uint32_t index = static_cast<uint32_t> (m_ips.size ());
+  m_ips.push_back (oss.str ());
+  m_ipIndex.emplace (ip, index);
+  return index;
+}
+
+double
+V2xKpiStreaming::GetDistance (uint32_t ipIndex1, uint32_t ipIndex2) const
+{
+  auto it1 = m_posPerIp.find (m_ips.at (ipIndex1));
+  auto it2 = m_posPerIp.find (m_ips.at (ipIndex2));
+  if (it1 == m_posPerIp.end () || it2 == m_posPerIp.end ())
+    {
+      return -1.0;
+    }
+  return CalculateDistance (it1->second, it2->second);
+}
+
+V2xKpiStreaming::DistanceBin &
+V2xKpiStreaming::GetDistanceBin (double distance)
+{
+  size_t bin = static_cast<size_t> (distance / m_distanceBinWidth);
+  if (bin >= m_distanceBins.size ())
+    {
+      m_distanceBins.resize (bin + 1);
+    }
+  return m_distanceBins.at (bin);
+}
+
+bool
+V2xKpiStreaming::ReceiveSeq (LinkStats *link, uint32_t seq)
+{
+  // Bit i of the window is set if the sequence number highestSeq - i was received
+  if (link->distinctSeqs == 0)
+    {
+      link->highestSeq = seq;
+      link->window.reset ();
+      link->window.set (0);
+      return true;
+    }
+  if (seq > link->highestSeq)
+    {
+      uint32_t shift = seq - link->highestSeq;
+      if (shift >= SEQ_WINDOW_SIZE)
+        {
+          link->window.reset ();
+        }
+      else
+        {
+          link->window <<= shift;
+        }
+      link->window.set (0);
+      link->highestSeq = seq;
+      return true;
+    }
+  uint32_t offset = link->highestSeq - seq;
+  if (offset >= SEQ_WINDOW_SIZE)
+    {
+      // Too old to know if it is a duplicate
+      return true;
+    }
+  if (link->window.test (offset))
+    {
+      return false;
+    }
+  link->window.set (offset);
+  return true;
+}
+
+void
+V2xKpiStreaming::NotifyPacket (const std::string &txRx, uint32_t nodeId, uint64_t imsi,
+                               const Address &localAddrs, const Address &srcAddrs,
+                               uint32_t pktSize, uint32_t seq)
+{
+  if (txRx == "tx")
+    {
+      auto it = m_txNodes.find (nodeId);
+      if (it == m_txNodes.end ())
+        {
+          TxNodeStats txNode;
+          txNode.imsi = imsi;
+          txNode.ipIndex = GetIpIndex (localAddrs);
+          it = m_txNodes.emplace (nodeId, txNode).first;
+        }
+      it->second.txPkts++;
+      return;
+    }
+
+  NS_ABORT_MSG_UNLESS (txRx == "rx", "Unknown packet trace " << txRx);
+
+  Address srcIp;
+  if (InetSocketAddress::IsMatchingType (srcAddrs))
+    {
+      srcIp = InetSocketAddress::ConvertFrom (srcAddrs).GetIpv4 ();
+    }
+  else if (Inet6SocketAddress::IsMatchingType (srcAddrs))
+    {
+      srcIp = Inet6SocketAddress::ConvertFrom (srcAddrs).GetIpv6 ();
+    }
+  else
+    {
+      NS_FATAL_ERROR ("Unknown address type!");
+    }
+
+  auto it = m_rxNodes.find (nodeId);
+  if (it == m_rxNodes.end ())
+    {
+      RxNodeStats rxNode;
+      rxNode.imsi = imsi;
+      rxNode.ipIndex = GetIpIndex (localAddrs);
+      it = m_rxNodes.emplace (nodeId, rxNode).first;
+    }
+
+  uint32_t txIpIndex = GetIpIndex (srcIp);
+  auto linkIt = it->second.links.find (txIpIndex);
+  if (linkIt == it->second.links.end ())
+    {
+      LinkStats link;
+      link.distance = GetDistance (it->second.ipIndex, txIpIndex);
+      linkIt = it->second.links.emplace (txIpIndex, link).first;
+    }
+
+  LinkStats &link = linkIt->second;
+  int64_t now = Simulator::Now ().GetNanoSeconds ();
+  DistanceBin *bin = link.distance >= 0.0 ? &GetDistanceBin (link.distance) : nullptr;
+  if (link.rxPkts == 0)
+    {
+      link.firstRxNs = now;
+    }
+  else if (bin != nullptr)
+    {
+      bin->pirSumSec += (now - link.lastRxNs) / 1e9;
+      bin->pirCount++;
+    }
+  link.lastRxNs = now;
+  link.rxPkts++;
+  link.rxBytes += pktSize;
+
+  if (ReceiveSeq (&link, seq))
+    {
+      link.distinctSeqs++;
+      if (bin != nullptr)
+        {
+          bin->rxPkts++;
+        }
+    }
+}
+
+void
+V2xKpiStreaming::NotifyPsschTx (const SlPsschUeMacStatParameters &params)
+{
+  uint64_t slot = ((static_cast<uint64_t> (params.frameNum) * 10) + params.subframeNum) * 32 + params.slotNum;
+  FlushPsschSlots (slot);
+  m_totalPsschTx++;
+
+  PsschTx tx {params.symStart, params.symLength, params.rbStart, params.rbLength};
+  PsschSlot &slotTx = m_psschSlots[slot];
+  // Two transmissions can only overlap in the same slot, hence the lists of
+  // a slot are the ones that V2xKpi would build, but restricted to the slot
+  if (m_numNonOverlapping == 0)
+    {
+      slotTx.nonOverlapping.push_back (tx);
+      m_numNonOverlapping++;
+      return;
+    }
+  auto overlaps = [&tx] (const PsschTx &r) { return tx.Overlaps (r); };
+  auto it = std::find_if (slotTx.nonOverlapping.begin (), slotTx.nonOverlapping.end (), overlaps);
+  if (it != slotTx.nonOverlapping.end ())
+    {
+      slotTx.overlapping.push_back (tx);
+      slotTx.overlapping.push_back (*it);
+      slotTx.nonOverlapping.erase (it);
+      m_numNonOverlapping--;
+    }
+  else if (std::any_of (slotTx.overlapping.begin (), slotTx.overlapping.end (), overlaps))
+    {
+      slotTx.overlapping.push_back (tx);
+    }
+  else
+    {
+      slotTx.nonOverlapping.push_back (tx);
+      m_numNonOverlapping++;
+    }
+}
+
+void
+V2xKpiStreaming::NotifyPsschRx (const SlRxDataPacketTraceParams &params)
+{
+  m_totalTbRx++;
+  if (!params.m_corrupt)
+    {
+      ++m_psschSuccessCount;
+    }
+  if (!params.m_sci2Corrupted)
+    {
+      ++m_sci2SuccessCount;
+    }
+}
+
+void
+V2xKpiStreaming::FlushPsschSlots (uint64_t lastSlot)
+{
+  while (!m_psschSlots.empty ()
+         && (lastSlot == UINT64_MAX || m_psschSlots.begin ()->first + PSSCH_SLOT_HORIZON < lastSlot))
+    {
+      m_numOverlappingFlushed += m_psschSlots.begin ()->second.overlapping.size ();
+      m_psschSlots.erase (m_psschSlots.begin ());
+    }
+}
+
+uint32_t
+V2xKpiStreaming::GetTotalTxPkts (uint32_t ipIndex) const
+{
+  for (const auto &it : m_txNodes)
+    {
+      if (it.second.ipIndex == ipIndex)
+        {
+          return it.second.txPkts;
+        }
+    }
+  return 0;
+}
+
+void
+V2xKpiStreaming::DeleteWhere (SQLiteOutput *db, const std::string &tableName)
+{
+  bool ret;
+  sqlite3_stmt *stmt;
+  ret = db->SpinPrepare (&stmt, "DELETE FROM \"" + tableName + "\" WHERE SEED = ? AND RUN = ?;");
+  NS_ABORT_IF (ret == false);
+  ret = db->Bind (stmt, 1, RngSeedManager::GetSeed ());
+  NS_ABORT_IF (ret == false);
+  ret = db->Bind (stmt, 2, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+  NS_ABORT_IF (ret == false);
+
+  ret = db->SpinExec (stmt);
+  NS_ABORT_IF (ret == false);
+}
+
+void
+V2xKpiStreaming::WriteKpis (SQLiteOutput *db, const std::string &suffix)
+{
+  FlushPsschSlots (UINT64_MAX);
+
+  bool ret = db->SpinExec ("BEGIN TRANSACTION;");
+  NS_ABORT_UNLESS (ret);
+  SaveAvrgPir (db, "avrgPir" + suffix);
+  SaveThput (db, "thput" + suffix);
+  SaveSimultPsschTxStats (db, "simulPsschTx" + suffix);
+  SavePsschTbCorruptionStats (db, "PsschTbRx" + suffix);
+  SaveAvrgPrr (db, "avrgPrr" + suffix);
+  SaveKpisPerDistance (db, "v2xKpiPerDistance" + suffix);
+  ret = db->SpinExec ("END TRANSACTION;");
+  NS_ABORT_UNLESS (ret);
+}
+
+void
+V2xKpiStreaming::SaveAvrgPir (SQLiteOutput *db, const std::string &tableName) const
+{
+  bool ret = db->SpinExec ("CREATE TABLE IF NOT EXISTS " + tableName + " ("
+                           "txRx TEXT NOT NULL,"
+                           "nodeId INTEGER NOT NULL,"
+                           "imsi INTEGER NOT NULL,"
+                           "srcIp TEXT NOT NULL,"
+                           "dstIp TEXT NOT NULL,"
+                           "avrgPirSec DOUBLE NOT NULL,"
+                           "TxRxDistance DOUBLE NOT NULL,"
+                           "SEED INTEGER NOT NULL,"
+                           "RUN INTEGER NOT NULL"
+                           ");");
+  NS_ABORT_UNLESS (ret);
+  DeleteWhere (db, tableName);
+
+  for (const auto &rxIt : m_rxNodes)
+    {
+      for (const auto &linkIt : rxIt.second.links)
+        {
+          double distance = 0.0;
+          if (m_range > 0)
+            {
+              distance = linkIt.second.distance;
+              NS_ABORT_MSG_IF (distance < 0.0, "Unable to find the position of RX IP " << m_ips.at (rxIt.second.ipIndex)
+                               << " or TX IP " << m_ips.at (linkIt.first));
+              if (distance > m_range)
+                {
+                  continue;
+                }
+            }
+          if (linkIt.second.rxPkts < 2)
+            {
+              //It may happen that a node would rxed only one pkt from a
+              //particular tx node. In that case, PIR can not be computed.
+              continue;
+            }
+          double avrgPir = (linkIt.second.lastRxNs - linkIt.second.firstRxNs) / 1e9 / (linkIt.second.rxPkts - 1);
+
+          sqlite3_stmt *stmt;
+          ret = db->SpinPrepare (&stmt, "INSERT INTO " + tableName + " VALUES (?,?,?,?,?,?,?,?,?);");
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 1, std::string ("rx"));
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 2, rxIt.first);
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 3, static_cast<uint32_t> (rxIt.second.imsi));
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 4, m_ips.at (linkIt.first));
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 5, m_ips.at (rxIt.second.ipIndex));
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 6, avrgPir);
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 7, distance);
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 8, RngSeedManager::GetSeed ());
+          NS_ABORT_UNLESS (ret);
+          ret = db->Bind (stmt, 9, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+          NS_ABORT_UNLESS (ret);
+          ret = db->SpinExec (stmt);
+          NS_ABORT_UNLESS (ret);
+        }
+    }
+}
+
+void
+V2xKpiStreaming::SaveThput (SQLiteOutput *db, const std::string &tableName) const
+{
+  bool ret = db->SpinExec ("CREATE TABLE IF NOT EXISTS " + tableName + " ("
+                           "txRx TEXT NOT NULL,"
+                           "nodeId INTEGER NOT NULL,"
+                           "imsi INTEGER NOT NULL,"
+                           "srcIp TEXT NOT NULL,"
+                           "totalPktTxed int NOT NULL,"
+                           "dstIp TEXT NOT NULL,"
+                           "totalPktRxed int NOT NULL,"
+                           "thputKbps DOUBLE NOT NULL,"
+                           "SEED INTEGER NOT NULL,"
+                           "RUN INTEGER NOT NULL"
+                           ");");
+  NS_ABORT_UNLESS (ret);
+  DeleteWhere (db, tableName);
+
+  auto insert = [db, &tableName] (uint32_t nodeId, const RxNodeStats &rxNode, const std::string &srcIp,
+                                  uint32_t totalTxPkts, const std::string &dstIp, uint32_t rxPkts, double thput)
+    {
+      sqlite3_stmt *stmt;
+      bool ret = db->SpinPrepare (&stmt, "INSERT INTO " + tableName + " VALUES (?,?,?,?,?,?,?,?,?,?);");
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 1, std::string ("rx"));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 2, nodeId);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 3, static_cast<uint32_t> (rxNode.imsi));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 4, srcIp);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 5, totalTxPkts);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 6, dstIp);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 7, rxPkts);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 8, thput);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 9, RngSeedManager::GetSeed ());
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 10, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+      NS_ABORT_UNLESS (ret);
+      ret = db->SpinExec (stmt);
+      NS_ABORT_UNLESS (ret);
+    };
+
+  for (const auto &rxIt : m_rxNodes)
+    {
+      const RxNodeStats &rxNode = rxIt.second;
+      const std::string &rxIp = m_ips.at (rxNode.ipIndex);
+      for (const auto &linkIt : rxNode.links)
+        {
+          NS_ABORT_MSG_IF (m_txAppDuration == 0.0, "Can not compute throughput with " << m_txAppDuration << " duration");
+          //thput in kpbs
+          double thput = (linkIt.second.rxBytes * 8) / m_txAppDuration / 1000.0;
+          insert (rxIt.first, rxNode, m_ips.at (linkIt.first), GetTotalTxPkts (linkIt.first),
+                  rxIp, linkIt.second.rxPkts, thput);
+        }
+
+      //Now put zero thput for the transmitters nodes from
+      //whom this RX node didn't receive any packet.
+      size_t numTx = m_txNodes.size ();
+      if (m_txNodes.find (rxIt.first) != m_txNodes.end ())
+        {
+          numTx--;
+        }
+      if (m_considerAllTx && rxNode.links.size () < numTx)
+        {
+          for (const auto &txIt : m_txNodes)
+            {
+              uint32_t txIpIndex = txIt.second.ipIndex;
+              if (rxNode.links.find (txIpIndex) == rxNode.links.end () && txIpIndex != rxNode.ipIndex)
+                {
+                  insert (rxIt.first, rxNode, m_ips.at (txIpIndex), GetTotalTxPkts (txIpIndex), rxIp, 0, 0.0);
+                }
+            }
+        }
+    }
+}
+
+void
+V2xKpiStreaming::SaveAvrgPrr (SQLiteOutput *db, const std::string &tableName) const
+{
+  bool ret = db->SpinExec ("CREATE TABLE IF NOT EXISTS " + tableName + " ("
+                           "txRx TEXT NOT NULL,"
+                           "nodeId INTEGER NOT NULL,"
+                           "imsi INTEGER NOT NULL,"
+                           "Ip TEXT NOT NULL,"
+                           "range DOUBLE NOT NULL,"
+                           "numNieb INTEGER NOT NULL,"
+                           "avrgPrr DOUBLE NOT NULL,"
+                           "SEED INTEGER NOT NULL,"
+                           "RUN INTEGER NOT NULL"
+                           ");");
+  NS_ABORT_UNLESS (ret);
+  DeleteWhere (db, tableName);
+
+  for (const auto &txIt : m_txNodes)
+    {
+      uint32_t txIpIndex = txIt.second.ipIndex;
+      uint32_t numNeib = 0;
+      uint64_t pktRxCount = 0;
+      // As V2xKpi, the potential receivers are the nodes that received at
+      // least a packet, from any transmitter
+      for (const auto &rxIt : m_rxNodes)
+        {
+          if (m_range > 0)
+            {
+              double txRxDist = GetDistance (rxIt.second.ipIndex, txIpIndex);
+              NS_ABORT_MSG_IF (txRxDist < 0.0, "Unable to find the position of RX IP " << m_ips.at (rxIt.second.ipIndex)
+                               << " or TX IP " << m_ips.at (txIpIndex));
+              if (txRxDist > m_range)
+                {
+                  continue;
+                }
+            }
+          numNeib++;
+          auto linkIt = rxIt.second.links.find (txIpIndex);
+          if (linkIt != rxIt.second.links.end ())
+            {
+              pktRxCount += linkIt->second.distinctSeqs;
+            }
+        }
+
+      //if none of the rx nodes is in range do not log such PRR
+      if (numNeib == 0)
+        {
+          continue;
+        }
+      double avrgPrr = 0.0;
+      if (pktRxCount > 0)
+        {
+          avrgPrr = static_cast<double> (pktRxCount) / (static_cast<double> (txIt.second.txPkts) * numNeib);
+        }
+
+      sqlite3_stmt *stmt;
+      ret = db->SpinPrepare (&stmt, "INSERT INTO " + tableName + " VALUES (?,?,?,?,?,?,?,?,?);");
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 1, std::string ("tx"));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 2, txIt.first);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 3, static_cast<uint32_t> (txIt.second.imsi));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 4, m_ips.at (txIpIndex));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 5, static_cast<uint32_t> (m_range));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 6, numNeib);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 7, avrgPrr);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 8, RngSeedManager::GetSeed ());
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 9, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+      NS_ABORT_UNLESS (ret);
+      ret = db->SpinExec (stmt);
+      NS_ABORT_UNLESS (ret);
+    }
+}
+
+void
+V2xKpiStreaming::SaveSimultPsschTxStats (SQLiteOutput *db, const std::string &tableName) const
+{
+  bool ret = db->SpinExec ("CREATE TABLE IF NOT EXISTS " + tableName + " ("
+                           "totalTx INTEGER NOT NULL,"
+                           "numNonOverlapping INTEGER NOT NULL,"
+                           "numOverlapping INTEGER NOT NULL,"
+                           "SEED INTEGER NOT NULL,"
+                           "RUN INTEGER NOT NULL"
+                           ");");
+  NS_ABORT_UNLESS (ret);
+  DeleteWhere (db, tableName);
+
+  sqlite3_stmt *stmt;
+  ret = db->SpinPrepare (&stmt, "INSERT INTO " + tableName + " VALUES (?,?,?,?,?);");
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 1, m_totalPsschTx);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 2, m_numNonOverlapping);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 3, m_numOverlappingFlushed);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 4, RngSeedManager::GetSeed ());
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 5, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+  NS_ABORT_UNLESS (ret);
+  ret = db->SpinExec (stmt);
+  NS_ABORT_UNLESS (ret);
+}
+
+void
+V2xKpiStreaming::SavePsschTbCorruptionStats (SQLiteOutput *db, const std::string &tableName) const
+{
+  bool ret = db->SpinExec ("CREATE TABLE IF NOT EXISTS " + tableName + " ("
+                           "totalRx INTEGER NOT NULL,"
+                           "psschSuccessCount INTEGER NOT NULL,"
+                           "psschFailCount INTEGER NOT NULL,"
+                           "sci2SuccessCount INTEGER NOT NULL,"
+                           "sci2FailCount INTEGER NOT NULL,"
+                           "SEED INTEGER NOT NULL,"
+                           "RUN INTEGER NOT NULL"
+                           ");");
+  NS_ABORT_UNLESS (ret);
+  DeleteWhere (db, tableName);
+
+  sqlite3_stmt *stmt;
+  ret = db->SpinPrepare (&stmt, "INSERT INTO " + tableName + " VALUES (?,?,?,?,?,?,?);");
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 1, m_totalTbRx);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 2, m_psschSuccessCount);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 3, m_totalTbRx - m_psschSuccessCount);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 4, m_sci2SuccessCount);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 5, m_totalTbRx - m_sci2SuccessCount);
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 6, RngSeedManager::GetSeed ());
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 7, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+  NS_ABORT_UNLESS (ret);
+  ret = db->SpinExec (stmt);
+  NS_ABORT_UNLESS (ret);
+}
+
+void
+V2xKpiStreaming::SaveKpisPerDistance (SQLiteOutput *db, const std::string &tableName)
+{
+  bool ret = db->SpinExec ("CREATE TABLE IF NOT EXISTS " + tableName + " ("
+                           "binStartMeter DOUBLE NOT NULL,"
+                           "binEndMeter DOUBLE NOT NULL,"
+                           "numLinks INTEGER NOT NULL,"
+                           "rxPkts INTEGER NOT NULL,"
+                           "expectedPkts INTEGER NOT NULL,"
+                           "avrgPrr DOUBLE NOT NULL,"
+                           "avrgPirSec DOUBLE NOT NULL,"
+                           "SEED INTEGER NOT NULL,"
+                           "RUN INTEGER NOT NULL"
+                           ");");
+  NS_ABORT_UNLESS (ret);
+  DeleteWhere (db, tableName);
+
+  // The packets that the RX nodes of a bin could have received are only
+  // known at the end, once all the transmitters and receivers are known
+  for (auto &bin : m_distanceBins)
+    {
+      bin.numLinks = 0;
+      bin.expectedPkts = 0;
+    }
+  for (const auto &txIt : m_txNodes)
+    {
+      for (const auto &rxIt : m_rxNodes)
+        {
+          if (rxIt.first == txIt.first)
+            {
+              continue;
+            }
+          double distance = GetDistance (rxIt.second.ipIndex, txIt.second.ipIndex);
+          if (distance < 0.0)
+            {
+              continue;
+            }
+          DistanceBin &bin = GetDistanceBin (distance);
+          bin.numLinks++;
+          bin.expectedPkts += txIt.second.txPkts;
+        }
+    }
+
+  for (size_t i = 0; i < m_distanceBins.size (); ++i)
+    {
+      const DistanceBin &bin = m_distanceBins.at (i);
+      if (bin.numLinks == 0)
+        {
+          continue;
+        }
+      double avrgPrr = bin.expectedPkts > 0 ? static_cast<double> (bin.rxPkts) / bin.expectedPkts : 0.0;
+      double avrgPir = bin.pirCount > 0 ? bin.pirSumSec / bin.pirCount : -1.0;
+
+      sqlite3_stmt *stmt;
+      ret = db->SpinPrepare (&stmt, "INSERT INTO " + tableName + " VALUES (?,?,?,?,?,?,?,?,?);");
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 1, i * m_distanceBinWidth);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 2, (i + 1) * m_distanceBinWidth);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 3, bin.numLinks);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 4, static_cast<uint32_t> (bin.rxPkts));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 5, static_cast<uint32_t> (bin.expectedPkts));
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 6, avrgPrr);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 7, avrgPir);
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 8, RngSeedManager::GetSeed ());
+      NS_ABORT_UNLESS (ret);
+      ret = db->Bind (stmt, 9, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+      NS_ABORT_UNLESS (ret);
+      ret = db->SpinExec (stmt);
+      NS_ABORT_UNLESS (ret);
+    }
+}
+
+uint32_t
+V2xKpiStreaming::CountUnmatchedRows (SQLiteOutput *db, const std::string &table,
+                                     const std::string &other,
+                                     const std::vector<std::string> &keys,
+                                     const std::vector<std::string> &values,
+                                     double tolerance)
+{
+  std::ostringstream sql;
+  sql << std::setprecision (17)
+      << "SELECT COUNT(*) FROM \"" << table << "\" a WHERE a.SEED = ? AND a.RUN = ? "
+      << "AND NOT EXISTS (SELECT 1 FROM \"" << other << "\" b WHERE b.SEED = a.SEED AND b.RUN = a.RUN";
+  for (const auto &key : keys)
+    {
+      sql << " AND b." << key << " = a." << key;
+    }
+  for (const auto &value : values)
+    {
+      sql << " AND ABS(b." << value << " - a." << value << ") <= " << tolerance;
+    }
+  sql << ");";
+
+  sqlite3_stmt *stmt;
+  bool ret = db->SpinPrepare (&stmt, sql.str ());
+  NS_ABORT_MSG_UNLESS (ret, "Could not compare the table " << table << " with " << other);
+  ret = db->Bind (stmt, 1, RngSeedManager::GetSeed ());
+  NS_ABORT_UNLESS (ret);
+  ret = db->Bind (stmt, 2, static_cast<uint32_t> (RngSeedManager::GetRun ()));
+  NS_ABORT_UNLESS (ret);
+
+  uint32_t unmatched = 0;
+  if (SQLiteOutput::SpinStep (stmt) == SQLITE_ROW)
+    {
+      unmatched = static_cast<uint32_t> (sqlite3_column_int (stmt, 0));
+    }
+  SQLiteOutput::SpinFinalize (stmt);
+
+  NS_LOG_INFO ("Rows of " << table << " without an equal row in " << other << ": " << unmatched);
+  return unmatched;
+}
+
+uint32_t
+V2xKpiStreaming::CompareWithV2xKpi (SQLiteOutput *db, const std::string &suffix, double tolerance)
+{
+  NS_ABORT_MSG_IF (suffix.empty (), "The tables of V2xKpiStreaming need a suffix to be compared");
+
+  struct TableColumns
+  {
+    std::string name;
+    std::vector<std::string> keys;
+    std::vector<std::string> values;
+  };
+  const std::vector<TableColumns> tables = {
+    {"avrgPir", {"nodeId", "imsi", "srcIp", "dstIp"}, {"avrgPirSec", "TxRxDistance"}},
+    {"thput", {"nodeId", "imsi", "srcIp", "totalPktTxed", "dstIp", "totalPktRxed"}, {"thputKbps"}},
+    {"avrgPrr", {"nodeId", "imsi", "Ip", "numNieb"}, {"range", "avrgPrr"}},
+    {"simulPsschTx", {"totalTx", "numNonOverlapping", "numOverlapping"}, {}},
+    {"PsschTbRx", {"totalRx", "psschSuccessCount", "psschFailCount", "sci2SuccessCount", "sci2FailCount"}, {}},
+  };
+
+  uint32_t unmatched = 0;
+  for (const auto &table : tables)
+    {
+      unmatched += CountUnmatchedRows (db, table.name, table.name + suffix, table.keys, table.values, tolerance);
+      unmatched += CountUnmatchedRows (db, table.name + suffix, table.name, table.keys, table.values, tolerance);
+    }
+  return unmatched;
+}
+
+} // namespace ns3
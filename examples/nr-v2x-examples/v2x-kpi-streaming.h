@@ -0,0 +1,347 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef V2X_KPI_STREAMING
+#define V2X_KPI_STREAMING
+
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/sqlite-output.h>
+#include <ns3/nr-sl-phy-mac-common.h>
+#include <bitset>
+#include <map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \brief Class which computes the same V2X KPIs of V2xKpi while the
+ *        simulation runs, by listening the traces that V2xKpi would read
+ *        from the database after the simulation.
+ *
+ * Instead of storing a row per packet, the class keeps, for each pair of
+ * RX node and TX IP, the counters needed by the KPIs: the received packets
+ * and bytes, the time of the first and the last reception, for the PIR,
+ * and the number of distinct sequence numbers received, for the PRR. The
+ * duplicates are detected with a sliding window of the last
+ * SEQ_WINDOW_SIZE sequence numbers; a packet older than the window is
+ * counted as a new one. The PSSCH transmissions are kept only for the
+ * slots that may still receive a transmission, i.e., the last
+ * PSSCH_SLOT_HORIZON slots. Therefore, the memory depends on the number
+ * of nodes, and not on the duration of the simulation.
+ *
+ * Apart from the tables written by V2xKpi, the class writes the PIR and the
+ * PRR accumulated per bins of the distance between the TX and the RX node.
+ *
+ * As V2xKpi, the range based KPIs use the position of the nodes set with
+ * FillPosPerIpMap, and they are only valid for the scenarios with constant
+ * velocity. The RX node is identified by its local address.
+ *
+ * \see V2xKpi
+ * \see NotifyPacket
+ * \see NotifyPsschTx
+ * \see NotifyPsschRx
+ * \see WriteKpis
+ */
+class V2xKpiStreaming
+{
+public:
+  /**
+   * \brief V2xKpiStreaming constructor
+   */
+  V2xKpiStreaming ();
+
+  /**
+   * \brief Set the duration of the transmitting application.
+   *
+   * Note: Without setting this throughput KPI can not be computed.
+   *
+   * \param duration The duration of the transmitting application in seconds.
+   */
+  void SetTxAppDuration (double duration);
+  /**
+   * \brief Consider all TX links while writing the throughput.
+   * \param allTx Flag to consider all the TX nodes for stats
+   * \see V2xKpi::ConsiderAllTx
+   */
+  void ConsiderAllTx (bool allTx);
+  /**
+   * \brief Fill the map to store the IP and the initial position of each node
+   * \param ip The IP of the node
+   * \param pos The position of the node
+   */
+  void FillPosPerIpMap (std::string ip, Vector pos);
+  /**
+   * \brief Set the range to be considered while writing the range based
+   * KPIs, e.g., PIR, PRR.
+   * \param range The inter-node-distance (2D) in meter
+   */
+  void SetRangeForV2xKpis (uint16_t range);
+  /**
+   * \brief Set the width of the distance bins of the PIR and the PRR
+   * \param width The width of a bin in meter
+   */
+  void SetDistanceBinWidth (double width);
+
+  /**
+   * \brief Account a packet transmitted or received by the application of
+   *        a node, i.e., the traces of type TxWithAddresses and RxWithAddresses
+   * \param txRx The string indicating the type of node, i.e., tx or rx
+   * \param nodeId The node id
+   * \param imsi The IMSI of the UE
+   * \param localAddrs The local IP address of the node
+   * \param srcAddrs The source address from the trace
+   * \param pktSize The packet size
+   * \param seq The packet sequence number
+   */
+  void NotifyPacket (const std::string &txRx, uint32_t nodeId, uint64_t imsi,
+                     const Address &localAddrs, const Address &srcAddrs,
+                     uint32_t pktSize, uint32_t seq);
+  /**
+   * \brief Account a PSSCH transmission, i.e., the trace SlPsschScheduling
+   *        of NrUeMac
+   * \param params The parameters of the trace
+   */
+  void NotifyPsschTx (const SlPsschUeMacStatParameters &params);
+  /**
+   * \brief Account a PSSCH reception, i.e., the trace RxPsschTraceUe of
+   *        NrSpectrumPhy
+   * \param params The parameters of the trace
+   */
+  void NotifyPsschRx (const SlRxDataPacketTraceParams &params);
+
+  /**
+   * \brief Write the KPIs in their respective tables in the DB.
+   *
+   * The tables are the ones of V2xKpi, with the same columns, plus the table
+   * "v2xKpiPerDistance". The name of each table is followed by the suffix.
+   *
+   * \param db The database
+   * \param suffix The suffix of the name of the tables
+   */
+  void WriteKpis (SQLiteOutput *db, const std::string &suffix = "");
+
+  /**
+   * \brief Compare the KPIs written by V2xKpi with the ones written by this
+   *        class for the current seed and run.
+   * \param db The database with both the tables
+   * \param suffix The suffix of the tables written by this class
+   * \param tolerance The maximum difference of two values to be equal
+   * \return The number of rows without an equal row in the other table
+   */
+  static uint32_t CompareWithV2xKpi (SQLiteOutput *db, const std::string &suffix, double tolerance);
+
+  static const uint32_t SEQ_WINDOW_SIZE = 256;   //!< Sequence numbers tracked to detect the duplicates
+  static const uint32_t PSSCH_SLOT_HORIZON = 64; //!< Slots kept to detect overlapping PSSCH transmissions
+
+private:
+  /**
+   * \brief The packets received by a node from a TX IP
+   */
+  struct LinkStats
+  {
+    uint32_t rxPkts {0};                  //!< Received packets
+    uint64_t rxBytes {0};                 //!< Received bytes
+    int64_t firstRxNs {0};                //!< Time of the first reception
+    int64_t lastRxNs {0};                 //!< Time of the last reception
+    uint32_t distinctSeqs {0};            //!< Distinct sequence numbers received
+    uint32_t highestSeq {0};              //!< Highest sequence number received
+    std::bitset<SEQ_WINDOW_SIZE> window;  //!< Sequence numbers received below the highest one
+    double distance {-1.0};               //!< Distance between the nodes, negative if unknown
+  };
+  /**
+   * \brief The packets received by a node
+   */
+  struct RxNodeStats
+  {
+    uint64_t imsi {0};                    //!< The IMSI of the node
+    uint32_t ipIndex {0};                 //!< The index of the local IP
+    std::map<uint32_t, LinkStats> links;  //!< Per index of the TX IP
+  };
+  /**
+   * \brief The packets transmitted by a node
+   */
+  struct TxNodeStats
+  {
+    uint64_t imsi {0};                    //!< The IMSI of the node
+    uint32_t ipIndex {0};                 //!< The index of the local IP
+    uint32_t txPkts {0};                  //!< Transmitted packets
+  };
+  /**
+   * \brief The accumulators of the PIR and the PRR of a distance bin
+   */
+  struct DistanceBin
+  {
+    uint32_t numLinks {0};                //!< Pairs of TX node and RX node in the bin
+    uint64_t rxPkts {0};                  //!< Distinct packets received
+    uint64_t expectedPkts {0};            //!< Packets transmitted to the RX nodes of the bin
+    double pirSumSec {0.0};               //!< Sum of the inter-reception times
+    uint64_t pirCount {0};                //!< Number of inter-reception times
+  };
+  /**
+   * \brief A PSSCH transmission
+   */
+  struct PsschTx
+  {
+    uint16_t symStart;  //!< The starting symbol
+    uint16_t symLen;    //!< The number of symbols
+    uint16_t rbStart;   //!< The starting RB
+    uint16_t rbLen;     //!< The number of RBs
+
+    /**
+     * \brief Check if two transmissions of the same slot overlap in time and
+     *        frequency, as V2xKpi
+     * \param r another transmission
+     * \return true if the transmissions overlap
+     */
+    bool Overlaps (const PsschTx &r) const
+    {
+      return ((symStart <= r.symStart + r.symLen - 1) && (r.symStart <= symStart + symLen - 1))
+             && ((rbStart <= r.rbStart + r.rbLen - 1) && (r.rbStart <= rbStart + rbLen - 1));
+    }
+  };
+  /**
+   * \brief The PSSCH transmissions of a slot
+   */
+  struct PsschSlot
+  {
+    std::vector<PsschTx> nonOverlapping;  //!< Transmissions not overlapping, yet
+    std::vector<PsschTx> overlapping;     //!< Overlapping transmissions
+  };
+
+  /**
+   * \brief Get the index of an IP address, creating it the first time
+   * \param ip The IPv4 or IPv6 address
+   * \return The index of the address
+   */
+  uint32_t GetIpIndex (const Address &ip);
+  /**
+   * \brief Get the distance between two IPs
+   * \param ipIndex1 The index of the first IP
+   * \param ipIndex2 The index of the second IP
+   * \return The 3D distance, or a negative value if a position is unknown
+   */
+  double GetDistance (uint32_t ipIndex1, uint32_t ipIndex2) const;
+  /**
+   * \brief Get the distance bin, creating it the first time
+   * \param distance The distance
+   * \return The bin
+   */
+  DistanceBin & GetDistanceBin (double distance);
+  /**
+   * \brief Record that a sequence number was received in a link
+   * \param link The link
+   * \param seq The sequence number
+   * \return true if it is the first time that the sequence number is received
+   */
+  static bool ReceiveSeq (LinkStats *link, uint32_t seq);
+  /**
+   * \brief Add the counts of the slots older than the last slot minus the
+   *        horizon to the totals, and remove them
+   * \param lastSlot The last slot, or UINT64_MAX to flush all the slots
+   */
+  void FlushPsschSlots (uint64_t lastSlot);
+  /**
+   * \brief Get the number of transmitted packets of the first TX node with an IP
+   * \param ipIndex The index of the IP
+   * \return The transmitted packets
+   */
+  uint32_t GetTotalTxPkts (uint32_t ipIndex) const;
+
+  /**
+   * \brief Write the average PIR, as V2xKpi::SaveAvrgPir
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  void SaveAvrgPir (SQLiteOutput *db, const std::string &tableName) const;
+  /**
+   * \brief Write the throughput, as V2xKpi::SaveThput
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  void SaveThput (SQLiteOutput *db, const std::string &tableName) const;
+  /**
+   * \brief Write the average PRR, as V2xKpi::SaveAvrgPrr
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  void SaveAvrgPrr (SQLiteOutput *db, const std::string &tableName) const;
+  /**
+   * \brief Write the simultaneous PSSCH transmissions, as V2xKpi::SaveSimultPsschTxStats
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  void SaveSimultPsschTxStats (SQLiteOutput *db, const std::string &tableName) const;
+  /**
+   * \brief Write the PSSCH TB receptions, as V2xKpi::SavePsschTbCorruptionStats
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  void SavePsschTbCorruptionStats (SQLiteOutput *db, const std::string &tableName) const;
+  /**
+   * \brief Write the PIR and the PRR per distance bin
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  void SaveKpisPerDistance (SQLiteOutput *db, const std::string &tableName);
+  /**
+   * \brief Delete the rows of the table with the current seed and run
+   * \param db The database
+   * \param tableName The name of the table
+   */
+  static void DeleteWhere (SQLiteOutput *db, const std::string &tableName);
+  /**
+   * \brief Count the rows of a table without an equal row in the other table
+   * \param db The database
+   * \param table The table
+   * \param other The other table
+   * \param keys The columns that must be equal
+   * \param values The columns that must be equal within the tolerance
+   * \param tolerance The tolerance
+   * \return The number of rows without an equal row
+   */
+  static uint32_t CountUnmatchedRows (SQLiteOutput *db, const std::string &table,
+                                      const std::string &other,
+                                      const std::vector<std::string> &keys,
+                                      const std::vector<std::string> &values,
+                                      double tolerance);
+
+  std::map<Address, uint32_t> m_ipIndex;        //!< Index of each IP address
+  std::vector<std::string> m_ips;               //!< IP address of each index
+  std::map<std::string, Vector> m_posPerIp;     //!< Position of each IP
+  std::map<uint32_t, RxNodeStats> m_rxNodes;    //!< RX stats per RX node id
+  std::map<uint32_t, TxNodeStats> m_txNodes;    //!< TX stats per TX node id
+  std::vector<DistanceBin> m_distanceBins;      //!< Accumulators per distance bin
+  double m_distanceBinWidth {10.0};             //!< Width of a distance bin in meter
+
+  std::map<uint64_t, PsschSlot> m_psschSlots;   //!< PSSCH transmissions of the last slots
+  uint32_t m_totalPsschTx {0};                  //!< Total PSSCH transmissions
+  uint32_t m_numNonOverlapping {0};             //!< Non-overlapping transmissions, including the open slots
+  uint32_t m_numOverlappingFlushed {0};         //!< Overlapping transmissions of the flushed slots
+  uint32_t m_totalTbRx {0};                     //!< Total PSSCH TBs received
+  uint32_t m_psschSuccessCount {0};             //!< PSSCH TBs successfully decoded
+  uint32_t m_sci2SuccessCount {0};              //!< SCI 2 successfully decoded
+
+  double m_txAppDuration {0.0}; //!< The TX application duration to compute the throughput
+  bool m_considerAllTx {true};  //!< Consider all TX flag for throughput computation
+  uint16_t m_range {0};         //!< Range in meter to be used to compute PIR and PRR
+};
+
+} // namespace ns3
+
+#endif // V2X_KPI_STREAMING
@@ -32,6 +32,7 @@
 #include <ns3/log.h>
 #include <vector>
 #include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -39,6 +40,32 @@ NS_LOG_COMPONENT_DEFINE ("NrBearerStatsCalculator");
 
 NS_OBJECT_ENSURE_REGISTERED ( NrBearerStatsCalculator);
 
+/// log2 of NrBearerStatsCalculator::DELAY_SUB_BUCKETS
+static const uint32_t SUB_BUCKET_BITS = 5;
+static_assert ((1u << SUB_BUCKET_BITS) == NrBearerStatsCalculator::DELAY_SUB_BUCKETS,
+               "SUB_BUCKET_BITS does not match DELAY_SUB_BUCKETS");
+
+/**
+ * \brief Get the number of bits of a value
+ * \param value the value, greater than 0
+ * \return the position of the most significant bit set, plus one
+ */
+static uint32_t
+GetBitLength (uint64_t value)
+{
+#if defined(__GNUC__)
+  return 64 - static_cast<uint32_t> (__builtin_clzll (value));
+#else
+  uint32_t bits = 0;
+  while (value != 0)
+    {
+      value >>= 1;
+      ++bits;
+    }
+  return bits;
+#endif
+}
+
 NrBearerStatsCalculator::NrBearerStatsCalculator ()
   : m_firstWrite (true),
   m_pendingOutput (false),
@@ -138,18 +165,188 @@ NrBearerStatsCalculator::GetEpoch () const
   return m_epochDuration;
 }
 
+NrBearerStatsCalculator::BearerStats &
+NrBearerStatsCalculator::GetBearer (uint64_t imsi, uint8_t lcid)
+{
+  uint64_t key = (imsi << 8) | lcid;
+  if (m_bearerSlots.size () > 0)
+    {
+      for (size_t slot = GetSlot (key); m_bearerSlots.at (slot) != 0; slot = (slot + 1) & (m_bearerSlots.size () - 1))
+        {
+          BearerStats &bearer = m_bearers.at (m_bearerSlots.at (slot) - 1);
+          if (bearer.m_pair.m_imsi == imsi && bearer.m_pair.m_lcId == lcid)
+            {
+              return bearer;
+            }
+        }
+    }
+
+  // Keep the table at most half full, so that the probes stay short
+  if ((m_bearers.size () + 1) * 2 > m_bearerSlots.size ())
+    {
+      GrowTable ();
+    }
+  NS_LOG_DEBUG (this << " Creating stats for IMSI " << imsi << " and LCID " << (uint32_t) lcid);
+  m_bearers.emplace_back ();
+  m_bearers.back ().m_pair = ImsiLcidPair_t (imsi, lcid);
+  size_t slot = GetSlot (key);
+  while (m_bearerSlots.at (slot) != 0)
+    {
+      slot = (slot + 1) & (m_bearerSlots.size () - 1);
+    }
+  m_bearerSlots.at (slot) = static_cast<uint32_t> (m_bearers.size ());
+  return m_bearers.back ();
+}
+
+const NrBearerStatsCalculator::BearerStats *
+NrBearerStatsCalculator::FindBearer (uint64_t imsi, uint8_t lcid) const
+{
+  if (m_bearerSlots.empty ())
+    {
+      return nullptr;
+    }
+  uint64_t key = (imsi << 8) | lcid;
+  for (size_t slot = GetSlot (key); m_bearerSlots.at (slot) != 0; slot = (slot + 1) & (m_bearerSlots.size () - 1))
+    {
+      const BearerStats &bearer = m_bearers.at (m_bearerSlots.at (slot) - 1);
+      if (bearer.m_pair.m_imsi == imsi && bearer.m_pair.m_lcId == lcid)
+        {
+          return &bearer;
+        }
+    }
+  return nullptr;
+}
+
+size_t
+NrBearerStatsCalculator::GetSlot (uint64_t key) const
+{
+  // Fibonacci hashing: the multiplication spreads consecutive IMSIs
+  uint64_t hash = key * 0x9E3779B97F4A7C15ULL;
+  return static_cast<size_t> (hash >> 32) & (m_bearerSlots.size () - 1);
+}
+
+void
+NrBearerStatsCalculator::GrowTable ()
+{
+  size_t numSlots = m_bearerSlots.empty () ? 64 : m_bearerSlots.size () * 2;
+  m_bearerSlots.assign (numSlots, 0);
+  for (size_t i = 0; i < m_bearers.size (); ++i)
+    {
+      const ImsiLcidPair_t &p = m_bearers.at (i).m_pair;
+      size_t slot = GetSlot ((p.m_imsi << 8) | p.m_lcId);
+      while (m_bearerSlots.at (slot) != 0)
+        {
+          slot = (slot + 1) & (numSlots - 1);
+        }
+      m_bearerSlots.at (slot) = static_cast<uint32_t> (i + 1);
+    }
+}
+
+void
+NrBearerStatsCalculator::RunningStats::Update (double v)
+{
+  // Same update of MinMaxAvgTotalCalculator, from "The Art of Computer
+  // Programming, Volume 2", Knuth, equations (15) and (16) on page 216
+  m_count++;
+  if (m_count == 1)
+    {
+      m_min = v;
+      m_max = v;
+      m_mean = v;
+      m_s = 0.0;
+      return;
+    }
+  m_min = std::min (m_min, v);
+  m_max = std::max (m_max, v);
+  double meanPrev = m_mean;
+  m_mean = meanPrev + (v - meanPrev) / m_count;
+  m_s = m_s + (v - meanPrev) * (v - m_mean);
+}
+
+std::vector<double>
+NrBearerStatsCalculator::RunningStats::GetStats () const
+{
+  if (m_count == 0)
+    {
+      return {0.0, 0.0, 0.0, 0.0};
+    }
+  double variance = m_count > 1 ? m_s / (m_count - 1) : 0.0;
+  return {m_mean, std::sqrt (variance), m_min, m_max};
+}
+
+uint32_t
+NrBearerStatsCalculator::GetDelayBucket (uint64_t value)
+{
+  if (value < 2 * DELAY_SUB_BUCKETS)
+    {
+      return static_cast<uint32_t> (value);
+    }
+  // Keep the SUB_BUCKET_BITS + 1 most significant bits of the value
+  uint32_t shift = GetBitLength (value) - (SUB_BUCKET_BITS + 1);
+  return (shift << SUB_BUCKET_BITS) + static_cast<uint32_t> (value >> shift);
+}
+
+double
+NrBearerStatsCalculator::GetDelayPercentile (const DirectionStats &stats, double percentile)
+{
+  NS_ASSERT_MSG (percentile > 0.0 && percentile <= 100.0, "Percentile " << percentile << " out of (0, 100]");
+  if (stats.m_delay.m_count == 0)
+    {
+      return 0.0;
+    }
+
+  uint64_t rank = static_cast<uint64_t> (std::ceil (percentile / 100.0 * stats.m_delay.m_count));
+  rank = std::max<uint64_t> (rank, 1);
+  uint64_t cumulative = 0;
+  for (uint32_t bucket = 0; bucket < stats.m_delayHistogram.size (); ++bucket)
+    {
+      cumulative += stats.m_delayHistogram.at (bucket);
+      if (cumulative >= rank)
+        {
+          double low = bucket;
+          double width = 1.0;
+          if (bucket >= 2 * DELAY_SUB_BUCKETS)
+            {
+              uint32_t shift = (bucket >> SUB_BUCKET_BITS) - 1;
+              low = static_cast<double> (static_cast<uint64_t> (bucket - (shift << SUB_BUCKET_BITS)) << shift);
+              width = static_cast<double> (1ULL << shift);
+            }
+          double center = low + (width - 1.0) / 2.0;
+          return std::min (std::max (center, stats.m_delay.m_min), stats.m_delay.m_max);
+        }
+    }
+  return stats.m_delay.m_max;
+}
+
+void
+NrBearerStatsCalculator::RecordRxPdu (DirectionStats *stats, uint32_t packetSize, uint64_t delay)
+{
+  stats->m_rxPackets++;
+  stats->m_rxData += packetSize;
+  stats->m_delay.Update (delay);
+  stats->m_pduSize.Update (packetSize);
+
+  uint32_t bucket = GetDelayBucket (delay);
+  if (bucket >= stats->m_delayHistogram.size ())
+    {
+      stats->m_delayHistogram.resize (bucket + 1, 0);
+    }
+  stats->m_delayHistogram[bucket]++;
+}
+
 void
 NrBearerStatsCalculator::UlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t rnti, uint8_t lcid, uint32_t packetSize)
 {
   NS_LOG_FUNCTION (this);
 
-  ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_ulCellId[p] = cellId;
-      m_flowId[p] = LteFlowId_t (rnti, lcid);
-      m_ulTxPackets[p]++;
-      m_ulTxData[p] += packetSize;
+      BearerStats &bearer = GetBearer (imsi, lcid);
+      bearer.m_ul.m_cellId = cellId;
+      bearer.m_flowId = LteFlowId_t (rnti, lcid);
+      bearer.m_ul.m_hasTx = true;
+      bearer.m_ul.m_txPackets++;
+      bearer.m_ul.m_txData += packetSize;
     }
   m_pendingOutput = true;
 }
@@ -159,13 +356,14 @@ NrBearerStatsCalculator::DlTxPdu (uint16_t cellId, uint64_t imsi, uint16_t rnti,
 {
   NS_LOG_FUNCTION (this);
 
-  ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_dlCellId[p] = cellId;
-      m_flowId[p] = LteFlowId_t (rnti, lcid);
-      m_dlTxPackets[p]++;
-      m_dlTxData[p] += packetSize;
+      BearerStats &bearer = GetBearer (imsi, lcid);
+      bearer.m_dl.m_cellId = cellId;
+      bearer.m_flowId = LteFlowId_t (rnti, lcid);
+      bearer.m_dl.m_hasTx = true;
+      bearer.m_dl.m_txPackets++;
+      bearer.m_dl.m_txData += packetSize;
     }
   m_pendingOutput = true;
 }
@@ -176,22 +374,11 @@ NrBearerStatsCalculator::UlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t rnti,
 {
   NS_LOG_FUNCTION (this);
 
-  ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_ulCellId[p] = cellId;
-      m_ulRxPackets[p]++;
-      m_ulRxData[p] += packetSize;
-
-      Uint64StatsMap::iterator it = m_ulDelay.find (p);
-      if (it == m_ulDelay.end ())
-        {
-          NS_LOG_DEBUG (this << " Creating UL stats calculators for IMSI " << p.m_imsi << " and LCID " << (uint32_t) p.m_lcId);
-          m_ulDelay[p] = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
-          m_ulPduSize[p] = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
-        }
-      m_ulDelay[p]->Update (delay);
-      m_ulPduSize[p]->Update (packetSize);
+      BearerStats &bearer = GetBearer (imsi, lcid);
+      bearer.m_ul.m_cellId = cellId;
+      RecordRxPdu (&bearer.m_ul, packetSize, delay);
     }
   m_pendingOutput = true;
 }
@@ -201,22 +388,11 @@ NrBearerStatsCalculator::DlRxPdu (uint16_t cellId, uint64_t imsi, uint16_t rnti,
 {
   NS_LOG_FUNCTION (this);
 
-  ImsiLcidPair_t p (imsi, lcid);
   if (Simulator::Now () >= m_startTime)
     {
-      m_dlCellId[p] = cellId;
-      m_dlRxPackets[p]++;
-      m_dlRxData[p] += packetSize;
-
-      Uint64StatsMap::iterator it = m_dlDelay.find (p);
-      if (it == m_dlDelay.end ())
-        {
-          NS_LOG_DEBUG (this << " Creating DL stats calculators for IMSI " << p.m_imsi << " and LCID " << (uint32_t) p.m_lcId);
-          m_dlDelay[p] = CreateObject<MinMaxAvgTotalCalculator<uint64_t> > ();
-          m_dlPduSize[p] = CreateObject<MinMaxAvgTotalCalculator<uint32_t> > ();
-        }
-      m_dlDelay[p]->Update (delay);
-      m_dlPduSize[p]->Update (packetSize);
+      BearerStats &bearer = GetBearer (imsi, lcid);
+      bearer.m_dl.m_cellId = cellId;
+      RecordRxPdu (&bearer.m_dl, packetSize, delay);
     }
   m_pendingOutput = true;
 }
@@ -248,11 +424,13 @@ NrBearerStatsCalculator::ShowResults (void)
       m_firstWrite = false;
       ulOutFile << "% start(s)\tend(s)\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
       ulOutFile << "delay(s)\tstdDev(s)\tmin(s)\tmax(s)\t";
-      ulOutFile << "PduSize\tstdDev\tmin\tmax";
+      ulOutFile << "PduSize\tstdDev\tmin\tmax\t";
+      ulOutFile << "delayP95(s)\tdelayP99(s)";
       ulOutFile << std::endl;
       dlOutFile << "% start(s)\tend(s)\tCellId\tIMSI\tRNTI\tLCID\tnTxPDUs\tTxBytes\tnRxPDUs\tRxBytes\t";
       dlOutFile << "delay(s)\tstdDev(s)\tmin(s)\tmax(s)\t";
-      dlOutFile << "PduSize\tstdDev\tmin\tmax";
+      dlOutFile << "PduSize\tstdDev\tmin\tmax\t";
+      dlOutFile << "delayP95(s)\tdelayP99(s)";
       dlOutFile << std::endl;
     }
   else
@@ -272,97 +450,61 @@ NrBearerStatsCalculator::ShowResults (void)
         }
     }
 
-  WriteUlResults (ulOutFile);
-  WriteDlResults (dlOutFile);
+  WriteResults (ulOutFile, true);
+  WriteResults (dlOutFile, false);
   m_pendingOutput = false;
 
 }
 
-void
-NrBearerStatsCalculator::WriteUlResults (std::ofstream& outFile)
+std::vector<size_t>
+NrBearerStatsCalculator::GetTxBearers (bool ul) const
 {
-  NS_LOG_FUNCTION (this);
-
-  // Get the unique IMSI / LCID list
-
-  std::vector < ImsiLcidPair_t > pairVector;
-  for (Uint32Map::iterator it = m_ulTxPackets.begin (); it != m_ulTxPackets.end (); ++it)
+  std::vector<size_t> bearers;
+  for (size_t i = 0; i < m_bearers.size (); ++i)
     {
-      if (find (pairVector.begin (), pairVector.end (), (*it).first) == pairVector.end ())
+      if ((ul ? m_bearers.at (i).m_ul : m_bearers.at (i).m_dl).m_hasTx)
         {
-          pairVector.push_back ((*it).first);
+          bearers.push_back (i);
         }
     }
-
-  Time endTime = m_startTime + m_epochDuration;
-  for (std::vector<ImsiLcidPair_t>::iterator it = pairVector.begin (); it != pairVector.end (); ++it)
-    {
-      ImsiLcidPair_t p = *it;
-      outFile << m_startTime.GetSeconds () << "\t";
-      outFile << endTime.GetSeconds () << "\t";
-      outFile << GetUlCellId (p.m_imsi, p.m_lcId) << "\t";
-      outFile << p.m_imsi << "\t";
-      outFile << m_flowId[p].m_rnti << "\t";
-      outFile << (uint32_t) m_flowId[p].m_lcId << "\t";
-      outFile << GetUlTxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlTxData (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlRxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetUlRxData (p.m_imsi, p.m_lcId) << "\t";
-      std::vector<double> stats = GetUlDelayStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) * 1e-9 << "\t";
-        }
-      stats = GetUlPduSizeStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
-        {
-          outFile << (*it) << "\t";
-        }
-      outFile << std::endl;
-    }
-
-  outFile.close ();
+  // Same order of the output before the hash table, i.e., by (IMSI, LCID)
+  std::sort (bearers.begin (), bearers.end (), [this] (size_t a, size_t b)
+             {
+               return m_bearers.at (a).m_pair < m_bearers.at (b).m_pair;
+             });
+  return bearers;
 }
 
 void
-NrBearerStatsCalculator::WriteDlResults (std::ofstream& outFile)
+NrBearerStatsCalculator::WriteResults (std::ofstream& outFile, bool ul)
 {
-  NS_LOG_FUNCTION (this);
-
-  // Get the unique IMSI list
-  std::vector < ImsiLcidPair_t > pairVector;
-  for (Uint32Map::iterator it = m_dlTxPackets.begin (); it != m_dlTxPackets.end (); ++it)
-    {
-      if (find (pairVector.begin (), pairVector.end (), (*it).first) == pairVector.end ())
-        {
-          pairVector.push_back ((*it).first);
-        }
-    }
+  NS_LOG_FUNCTION (this << ul);
 
   Time endTime = m_startTime + m_epochDuration;
-  for (std::vector<ImsiLcidPair_t>::iterator pair = pairVector.begin (); pair != pairVector.end (); ++pair)
+  for (size_t i : GetTxBearers (ul))
     {
-      ImsiLcidPair_t p = *pair;
+      const BearerStats &bearer = m_bearers.at (i);
+      const DirectionStats &stats = ul ? bearer.m_ul : bearer.m_dl;
       outFile << m_startTime.GetSeconds () << "\t";
       outFile << endTime.GetSeconds () << "\t";
-      outFile << GetDlCellId (p.m_imsi, p.m_lcId) << "\t";
-      outFile << p.m_imsi << "\t";
-      outFile << m_flowId[p].m_rnti << "\t";
-      outFile << (uint32_t) m_flowId[p].m_lcId << "\t";
-      outFile << GetDlTxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlTxData (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlRxPackets (p.m_imsi, p.m_lcId) << "\t";
-      outFile << GetDlRxData (p.m_imsi, p.m_lcId) << "\t";
-      std::vector<double> stats = GetDlDelayStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
+      outFile << stats.m_cellId << "\t";
+      outFile << bearer.m_pair.m_imsi << "\t";
+      outFile << bearer.m_flowId.m_rnti << "\t";
+      outFile << (uint32_t) bearer.m_flowId.m_lcId << "\t";
+      outFile << stats.m_txPackets << "\t";
+      outFile << stats.m_txData << "\t";
+      outFile << stats.m_rxPackets << "\t";
+      outFile << stats.m_rxData << "\t";
+      for (double v : stats.m_delay.GetStats ())
         {
-          outFile << (*it) * 1e-9 << "\t";
+          outFile << v * 1e-9 << "\t";
         }
-      stats = GetDlPduSizeStats (p.m_imsi, p.m_lcId);
-      for (std::vector<double>::iterator it = stats.begin (); it != stats.end (); ++it)
+      for (double v : stats.m_pduSize.GetStats ())
         {
-          outFile << (*it) << "\t";
+          outFile << v << "\t";
         }
+      outFile << GetDelayPercentile (stats, 95.0) * 1e-9 << "\t";
+      outFile << GetDelayPercentile (stats, 99.0) * 1e-9 << "\t";
       outFile << std::endl;
     }
 
@@ -374,19 +516,22 @@ NrBearerStatsCalculator::ResetResults (void)
 {
   NS_LOG_FUNCTION (this);
 
-  m_ulTxPackets.erase (m_ulTxPackets.begin (), m_ulTxPackets.end ());
-  m_ulRxPackets.erase (m_ulRxPackets.begin (), m_ulRxPackets.end ());
-  m_ulRxData.erase (m_ulRxData.begin (), m_ulRxData.end ());
-  m_ulTxData.erase (m_ulTxData.begin (), m_ulTxData.end ());
-  m_ulDelay.erase (m_ulDelay.begin (), m_ulDelay.end ());
-  m_ulPduSize.erase (m_ulPduSize.begin (), m_ulPduSize.end ());
-
-  m_dlTxPackets.erase (m_dlTxPackets.begin (), m_dlTxPackets.end ());
-  m_dlRxPackets.erase (m_dlRxPackets.begin (), m_dlRxPackets.end ());
-  m_dlRxData.erase (m_dlRxData.begin (), m_dlRxData.end ());
-  m_dlTxData.erase (m_dlTxData.begin (), m_dlTxData.end ());
-  m_dlDelay.erase (m_dlDelay.begin (), m_dlDelay.end ());
-  m_dlPduSize.erase (m_dlPduSize.begin (), m_dlPduSize.end ());
+  // The bearers stay in the table, with their CellId and FlowId, as the
+  // next epoch will most likely see the same bearers
+  for (auto &bearer : m_bearers)
+    {
+      for (DirectionStats *stats : {&bearer.m_ul, &bearer.m_dl})
+        {
+          stats->m_hasTx = false;
+          stats->m_txPackets = 0;
+          stats->m_rxPackets = 0;
+          stats->m_txData = 0;
+          stats->m_rxData = 0;
+          stats->m_delay = RunningStats ();
+          stats->m_pduSize = RunningStats ();
+          std::fill (stats->m_delayHistogram.begin (), stats->m_delayHistogram.end (), 0);
+        }
+    }
 }
 
 void
@@ -412,203 +557,155 @@ uint32_t
 NrBearerStatsCalculator::GetUlTxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulTxPackets[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_txPackets : 0;
 }
 
 uint32_t
 NrBearerStatsCalculator::GetUlRxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulRxPackets[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_rxPackets : 0;
 }
 
 uint64_t
 NrBearerStatsCalculator::GetUlTxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulTxData[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_txData : 0;
 }
 
 uint64_t
 NrBearerStatsCalculator::GetUlRxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulRxData[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_rxData : 0;
 }
 
 double
 NrBearerStatsCalculator::GetUlDelay (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  Uint64StatsMap::iterator it = m_ulDelay.find (p);
-  if (it == m_ulDelay.end ())
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  if (bearer == nullptr || bearer->m_ul.m_delay.m_count == 0)
     {
       NS_LOG_ERROR ("UL delay for " << imsi << " - " << (uint16_t) lcid << " not found");
       return 0;
-
     }
-  return m_ulDelay[p]->getMean ();
+  return bearer->m_ul.m_delay.m_mean;
 }
 
 std::vector<double>
 NrBearerStatsCalculator::GetUlDelayStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint64StatsMap::iterator it = m_ulDelay.find (p);
-  if (it == m_ulDelay.end ())
-    {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
-    }
-  stats.push_back (m_ulDelay[p]->getMean ());
-  stats.push_back (m_ulDelay[p]->getStddev ());
-  stats.push_back (m_ulDelay[p]->getMin ());
-  stats.push_back (m_ulDelay[p]->getMax ());
-  return stats;
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_delay.GetStats () : RunningStats ().GetStats ();
 }
 
 std::vector<double>
 NrBearerStatsCalculator::GetUlPduSizeStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint32StatsMap::iterator it = m_ulPduSize.find (p);
-  if (it == m_ulPduSize.end ())
-    {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_pduSize.GetStats () : RunningStats ().GetStats ();
+}
 
-    }
-  stats.push_back (m_ulPduSize[p]->getMean ());
-  stats.push_back (m_ulPduSize[p]->getStddev ());
-  stats.push_back (m_ulPduSize[p]->getMin ());
-  stats.push_back (m_ulPduSize[p]->getMax ());
-  return stats;
+double
+NrBearerStatsCalculator::GetUlDelayPercentile (uint64_t imsi, uint8_t lcid, double percentile)
+{
+  NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid << percentile);
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? GetDelayPercentile (bearer->m_ul, percentile) : 0.0;
 }
 
 uint32_t
 NrBearerStatsCalculator::GetDlTxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlTxPackets[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_txPackets : 0;
 }
 
 uint32_t
 NrBearerStatsCalculator::GetDlRxPackets (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlRxPackets[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_rxPackets : 0;
 }
 
 uint64_t
 NrBearerStatsCalculator::GetDlTxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlTxData[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_txData : 0;
 }
 
 uint64_t
 NrBearerStatsCalculator::GetDlRxData (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlRxData[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_rxData : 0;
 }
 
 uint32_t
 NrBearerStatsCalculator::GetUlCellId (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_ulCellId[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_ul.m_cellId : 0;
 }
 
 uint32_t
 NrBearerStatsCalculator::GetDlCellId (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  return m_dlCellId[p];
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_cellId : 0;
 }
 
 double
 NrBearerStatsCalculator::GetDlDelay (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  Uint64StatsMap::iterator it = m_dlDelay.find (p);
-  if (it == m_dlDelay.end ())
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  if (bearer == nullptr || bearer->m_dl.m_delay.m_count == 0)
     {
       NS_LOG_ERROR ("DL delay for " << imsi << " not found");
       return 0;
     }
-  return m_dlDelay[p]->getMean ();
+  return bearer->m_dl.m_delay.m_mean;
 }
 
 std::vector<double>
 NrBearerStatsCalculator::GetDlDelayStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint64StatsMap::iterator it = m_dlDelay.find (p);
-  if (it == m_dlDelay.end ())
-    {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
-    }
-  stats.push_back (m_dlDelay[p]->getMean ());
-  stats.push_back (m_dlDelay[p]->getStddev ());
-  stats.push_back (m_dlDelay[p]->getMin ());
-  stats.push_back (m_dlDelay[p]->getMax ());
-  return stats;
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_delay.GetStats () : RunningStats ().GetStats ();
 }
 
 std::vector<double>
 NrBearerStatsCalculator::GetDlPduSizeStats (uint64_t imsi, uint8_t lcid)
 {
   NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid);
-  ImsiLcidPair_t p (imsi, lcid);
-  std::vector<double> stats;
-  Uint32StatsMap::iterator it = m_dlPduSize.find (p);
-  if (it == m_dlPduSize.end ())
-    {
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      stats.push_back (0.0);
-      return stats;
-
-    }
-  stats.push_back (m_dlPduSize[p]->getMean ());
-  stats.push_back (m_dlPduSize[p]->getStddev ());
-  stats.push_back (m_dlPduSize[p]->getMin ());
-  stats.push_back (m_dlPduSize[p]->getMax ());
-  return stats;
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? bearer->m_dl.m_pduSize.GetStats () : RunningStats ().GetStats ();
 }
 
+double
+NrBearerStatsCalculator::GetDlDelayPercentile (uint64_t imsi, uint8_t lcid, double percentile)
+{
+  NS_LOG_FUNCTION (this << imsi << (uint16_t) lcid << percentile);
+  const BearerStats *bearer = FindBearer (imsi, lcid);
+  return bearer != nullptr ? GetDelayPercentile (bearer->m_dl, percentile) : 0.0;
+}
 
 std::string
 NrBearerStatsCalculator::GetUlOutputFilename (void)
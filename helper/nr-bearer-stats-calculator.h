@@ -32,26 +32,12 @@
 #include "ns3/lte-common.h"
 #include "ns3/uinteger.h"
 #include "ns3/object.h"
-#include "ns3/basic-data-calculators.h"
-#include "ns3/lte-common.h"
 #include <string>
-#include <map>
+#include <vector>
 #include <fstream>
 #include "nr-bearer-stats-simple.h"
 
 namespace ns3 {
-/// Container: (IMSI, LCID) pair, uint32_t
-typedef std::map<ImsiLcidPair_t, uint32_t> Uint32Map;
-/// Container: (IMSI, LCID) pair, uint64_t
-typedef std::map<ImsiLcidPair_t, uint64_t> Uint64Map;
-/// Container: (IMSI, LCID) pair, uint32_t calculator
-typedef std::map<ImsiLcidPair_t, Ptr<MinMaxAvgTotalCalculator<uint32_t> > > Uint32StatsMap;
-/// Container: (IMSI, LCID) pair, uint64_t calculator
-typedef std::map<ImsiLcidPair_t, Ptr<MinMaxAvgTotalCalculator<uint64_t> > > Uint64StatsMap;
-/// Container: (IMSI, LCID) pair, double
-typedef std::map<ImsiLcidPair_t, double> DoubleMap;
-/// Container: (IMSI, LCID) pair, LteFlowId_t
-typedef std::map<ImsiLcidPair_t, LteFlowId_t> FlowIdMap;
 
 /**
  * \ingroup utils
@@ -70,7 +56,15 @@ typedef std::map<ImsiLcidPair_t, LteFlowId_t> FlowIdMap;
  *   - Number of received bytes
  *   - Average, min, max and standard deviation of PDU delay (delay is
  *     calculated from the generation of the PDU to its reception)
+ *   - 95th and 99th percentile of the PDU delay
  *   - Average, min, max and standard deviation of PDU size
+ *
+ * The statistics of all the bearers are kept in an open-addressing hash
+ * table, keyed by the (IMSI, LCID) pair packed in an integer, so that each
+ * PDU costs a single lookup. The percentiles of the delay come from a
+ * log-linear histogram per bearer, with DELAY_SUB_BUCKETS buckets for each
+ * power of two, i.e., with a relative error lower than 1 / DELAY_SUB_BUCKETS,
+ * so no per-PDU delay has to be stored.
  */
 
 class NrBearerStatsCalculator : public NrBearerStatsBase
@@ -266,6 +260,22 @@ public:
    * @return PDU size statistics average, min, max and standard deviation in seconds
    */
   std::vector<double> GetDlPduSizeStats (uint64_t imsi, uint8_t lcid);
+  /**
+   * Gets a percentile of the uplink RLC to RLC delay
+   * @param imsi IMSI of the UE
+   * @param lcid LCID
+   * @param percentile the percentile, in (0, 100]
+   * @return the percentile of the delay in nanoseconds, or 0 if no PDU was received
+   */
+  double GetUlDelayPercentile (uint64_t imsi, uint8_t lcid, double percentile);
+  /**
+   * Gets a percentile of the downlink RLC to RLC delay
+   * @param imsi IMSI of the UE
+   * @param lcid LCID
+   * @param percentile the percentile, in (0, 100]
+   * @return the percentile of the delay in nanoseconds, or 0 if no PDU was received
+   */
+  double GetDlDelayPercentile (uint64_t imsi, uint8_t lcid, double percentile);
   /**
    * \return UL output file name
    */
@@ -275,7 +285,117 @@ public:
    */
   std::string GetDlOutputFilename (void);
 
+  static const uint32_t DELAY_SUB_BUCKETS = 32; //!< Buckets of the delay histograms for each power of two
+
 private:
+  /**
+   * \brief Count, average, standard deviation, min and max of a series of
+   * values, with the same formulas of MinMaxAvgTotalCalculator
+   */
+  struct RunningStats
+  {
+    /**
+     * \brief Add a value
+     * \param v the value
+     */
+    void Update (double v);
+    /**
+     * \brief Get average, standard deviation, min and max, or zeros without values
+     * \return the statistics
+     */
+    std::vector<double> GetStats () const;
+
+    uint64_t m_count {0};   //!< Number of values
+    double m_mean {0.0};    //!< Average
+    double m_s {0.0};       //!< Sum of the squared differences from the average
+    double m_min {0.0};     //!< Minimum
+    double m_max {0.0};     //!< Maximum
+  };
+  /**
+   * \brief The statistics of a bearer in a direction, for the on going epoch
+   */
+  struct DirectionStats
+  {
+    uint32_t m_cellId {0};                    //!< CellId of the last PDU, kept across the epochs
+    bool m_hasTx {false};                     //!< At least a PDU was transmitted in the epoch
+    uint32_t m_txPackets {0};                 //!< Number of TX PDUs
+    uint32_t m_rxPackets {0};                 //!< Number of RX PDUs
+    uint64_t m_txData {0};                    //!< Amount of TX data
+    uint64_t m_rxData {0};                    //!< Amount of RX data
+    RunningStats m_delay;                     //!< Delay of the RX PDUs
+    RunningStats m_pduSize;                   //!< Size of the RX PDUs
+    std::vector<uint32_t> m_delayHistogram;   //!< Log-linear histogram of the delay
+  };
+  /**
+   * \brief The statistics of a bearer
+   */
+  struct BearerStats
+  {
+    ImsiLcidPair_t m_pair;      //!< (IMSI, LCID) pair
+    LteFlowId_t m_flowId;       //!< (RNTI, LCID) of the last TX PDU
+    DirectionStats m_ul;        //!< Uplink statistics
+    DirectionStats m_dl;        //!< Downlink statistics
+  };
+
+  /**
+   * \brief Get the statistics of a bearer, creating them the first time
+   * @param imsi IMSI of the UE
+   * @param lcid LCID
+   * @return the statistics of the bearer
+   */
+  BearerStats & GetBearer (uint64_t imsi, uint8_t lcid);
+  /**
+   * \brief Find the statistics of a bearer
+   * @param imsi IMSI of the UE
+   * @param lcid LCID
+   * @return the statistics of the bearer, or nullptr if the bearer is unknown
+   */
+  const BearerStats * FindBearer (uint64_t imsi, uint8_t lcid) const;
+  /**
+   * \brief Get the slot of the hash table of a key
+   * @param key the packed (IMSI, LCID) pair
+   * @return the first slot to probe
+   */
+  size_t GetSlot (uint64_t key) const;
+  /**
+   * \brief Double the slots of the hash table, and insert again all the bearers
+   */
+  void GrowTable ();
+  /**
+   * \brief Account a received PDU
+   * @param stats the statistics of the direction
+   * @param packetSize size of the PDU in bytes
+   * @param delay RLC to RLC delay in nanoseconds
+   */
+  static void RecordRxPdu (DirectionStats *stats, uint32_t packetSize, uint64_t delay);
+  /**
+   * \brief Get the bucket of the delay histogram of a value
+   * @param value the delay
+   * @return the bucket
+   */
+  static uint32_t GetDelayBucket (uint64_t value);
+  /**
+   * \brief Get a percentile from a delay histogram
+   * @param stats the statistics of the direction
+   * @param percentile the percentile, in (0, 100]
+   * @return the center of the bucket of the percentile, limited to the min and
+   * the max delay, or 0 without values
+   */
+  static double GetDelayPercentile (const DirectionStats &stats, double percentile);
+  /**
+   * \brief Get the bearers that transmitted in the epoch in a direction,
+   * ordered by (IMSI, LCID)
+   * @param ul true for the uplink, false for the downlink
+   * @return the indexes of the bearers
+   */
+  std::vector<size_t> GetTxBearers (bool ul) const;
+  /**
+   * Writes the statistics of the bearers that transmitted in the epoch
+   * to an output file, and closes it.
+   * @param outFile ofstream for the statistics
+   * @param ul true for the uplink, false for the downlink
+   */
+  void WriteResults (std::ofstream& outFile, bool ul);
   /**
    * Called after each epoch to write collected
    * statistics to output files. During first call
@@ -283,18 +403,6 @@ private:
    * During next calls it opens output files in append mode.
    */
   void ShowResults (void);
-  /**
-   * Writes collected statistics to UL output file and
-   * closes UL output file.
-   * @param outFile ofstream for UL statistics
-   */
-  void WriteUlResults (std::ofstream& outFile);
-  /**
-   * Writes collected statistics to DL output file and
-   * closes DL output file.
-   * @param outFile ofstream for DL statistics
-   */
-  void WriteDlResults (std::ofstream& outFile);
   /**
    * Erases collected statistics
    */
@@ -312,21 +420,8 @@ private:
   void EndEpoch (void);
 
   EventId m_endEpochEvent; //!< Event id for next end epoch event
-  FlowIdMap m_flowId; //!< List of FlowIds, ie. (RNTI, LCID) by (IMSI, LCID) pair
-  Uint32Map m_dlCellId; //!< List of DL CellIds by (IMSI, LCID) pair
-  Uint32Map m_dlTxPackets; //!< Number of DL TX Packets by (IMSI, LCID) pair
-  Uint32Map m_dlRxPackets; //!< Number of DL RX Packets by (IMSI, LCID) pair
-  Uint64Map m_dlTxData; //!< Amount of DL TX Data by (IMSI, LCID) pair
-  Uint64Map m_dlRxData; //!< Amount of DL RX Data by (IMSI, LCID) pair
-  Uint64StatsMap m_dlDelay; //!< DL delay by (IMSI, LCID) pair
-  Uint32StatsMap m_dlPduSize; //!< DL PDU Size by (IMSI, LCID) pair
-  Uint32Map m_ulCellId; //!< List of UL CellIds by (IMSI, LCID) pair
-  Uint32Map m_ulTxPackets; //!< Number of UL TX Packets by (IMSI, LCID) pair
-  Uint32Map m_ulRxPackets; //!< Number of UL RX Packets by (IMSI, LCID) pair
-  Uint64Map m_ulTxData; //!< Amount of UL TX Data by (IMSI, LCID) pair
-  Uint64Map m_ulRxData; //!< Amount of UL RX Data by (IMSI, LCID) pair
-  Uint64StatsMap m_ulDelay; //!< UL delay by (IMSI, LCID) pair
-  Uint32StatsMap m_ulPduSize; //!< UL PDU Size by (IMSI, LCID) pair
+  std::vector<BearerStats> m_bearers; //!< Statistics of the bearers, in order of creation
+  std::vector<uint32_t> m_bearerSlots; //!< Hash table: index in m_bearers plus one, 0 if empty
   /**
    * Start time of the on going epoch
    */
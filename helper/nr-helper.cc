@@ -22,6 +22,7 @@
 #include <ns3/lte-rrc-protocol-real.h>
 #include <ns3/multi-model-spectrum-channel.h>
 #include <ns3/lte-ue-rrc.h>
+#include <ns3/lte-enb-rrc.h>
 #include <ns3/lte-chunk-processor.h>
 #include <ns3/epc-ue-nas.h>
 #include <ns3/names.h>
@@ -43,6 +44,7 @@
 #include <ns3/nr-phy-rx-trace.h>
 #include <ns3/nr-mac-rx-trace.h>
 #include "nr-bearer-stats-calculator.h"
+#include "nr-spatial-index.h"
 #include <ns3/bandwidth-part-ue.h>
 #include <ns3/beam-manager.h>
 #include <ns3/three-gpp-propagation-loss-model.h>
@@ -54,8 +56,16 @@
 #include <ns3/three-gpp-v2v-propagation-loss-model.h>
 #include <ns3/three-gpp-v2v-channel-condition-model.h>
 #include <ns3/uniform-planar-array.h>
+#include <ns3/node-list.h>
+#include <ns3/mobility-model.h>
+#include <ns3/rng-seed-manager.h>
+#include <ns3/nr-checkpoint.h>
 
 #include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -64,6 +74,17 @@ NS_LOG_COMPONENT_DEFINE ("NrHelper");
 
 NS_OBJECT_ENSURE_REGISTERED (NrHelper);
 
+/**
+ * \brief Get the wall-clock time elapsed since a given instant
+ * \param start the starting instant
+ * \return the elapsed time [s]
+ */
+static double
+SecondsSince (const std::chrono::steady_clock::time_point &start)
+{
+  return std::chrono::duration<double> (std::chrono::steady_clock::now () - start).count ();
+}
+
 NrHelper::NrHelper (void)
 {
   NS_LOG_FUNCTION (this);
@@ -462,6 +483,7 @@ NrHelper::InstallUeDevice (const NodeContainer &c,
 {
   NS_LOG_FUNCTION (this);
   Initialize ();    // Run DoInitialize (), if necessary
+  auto start = std::chrono::steady_clock::now ();
   NetDeviceContainer devices;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
@@ -470,6 +492,8 @@ NrHelper::InstallUeDevice (const NodeContainer &c,
       device->SetAddress (Mac48Address::Allocate ());
       devices.Add (device);
     }
+  m_startupProfile.m_ueNum += c.GetN ();
+  m_startupProfile.m_ueInstall += SecondsSince (start);
   return devices;
 
 }
@@ -481,6 +505,7 @@ NrHelper::InstallGnbDevice (const NodeContainer & c,
 {
   NS_LOG_FUNCTION (this);
   Initialize ();    // Run DoInitialize (), if necessary
+  auto start = std::chrono::steady_clock::now ();
   NetDeviceContainer devices;
   for (NodeContainer::Iterator i = c.Begin (); i != c.End (); ++i)
     {
@@ -489,6 +514,8 @@ NrHelper::InstallGnbDevice (const NodeContainer & c,
       device->SetAddress (Mac48Address::Allocate ());
       devices.Add (device);
     }
+  m_startupProfile.m_gnbNum += c.GetN ();
+  m_startupProfile.m_gnbInstall += SecondsSince (start);
   return devices;
 }
 
@@ -596,11 +623,16 @@ NrHelper::InstallSingleUeDevice (const Ptr<Node> &n,
       cc->SetDlEarfcn (0); // Used for nothing..
       cc->SetUlEarfcn (0); // Used for nothing..
 
+      auto start = std::chrono::steady_clock::now ();
       auto mac = CreateUeMac ();
       cc->SetMac (mac);
+      m_startupProfile.m_ueMac += SecondsSince (start);
 
+      start = std::chrono::steady_clock::now ();
       auto phy = CreateUePhy (n, allBwps[bwpId].get(), dev, std::bind (&NrUeNetDevice::RouteIngoingCtrlMsgs, dev,
                                          std::placeholders::_1, bwpId), numberOfStreams);
+      m_startupProfile.m_uePhy += SecondsSince (start);
+      phy->GetCam ()->SetNrUeMac (mac);
 
       if (m_harqEnabled)
         {
@@ -610,6 +642,11 @@ NrHelper::InstallSingleUeDevice (const Ptr<Node> &n,
       phy->SetBwpId (bwpId);
       cc->SetPhy (phy);
 
+      if (m_tracesAtInstall)
+        {
+          ConnectUeTraces (phy, mac);
+        }
+
       if (bwpId == 0)
         {
           cc->SetAsPrimary (true);
@@ -804,6 +841,56 @@ NrHelper::CreateGnbSched ()
   return sched;
 }
 
+/**
+ * \brief Get the IMSI of a UE attached to a gNB, for the checkpoints
+ * \param rrc the RRC of the gNB
+ * \param rnti the RNTI of the UE
+ * \return the IMSI, or 0 if the RRC does not know the UE
+ */
+static uint64_t
+GetUeImsi (LteEnbRrc *rrc, uint16_t rnti)
+{
+  return rrc->HasUeManager (rnti) ? rrc->GetUeManager (rnti)->GetImsi () : 0;
+}
+
+/**
+ * \brief Get the speed of a UE attached to a gNB, for the SRS algorithm
+ * \param rrc the RRC of the gNB
+ * \param mobility the mobility model of the UEs already found, by IMSI
+ * \param rnti the RNTI of the UE
+ * \return the speed (m/s), or a negative value if the UE has no mobility model
+ */
+static double
+GetUeSpeed (LteEnbRrc *rrc, const std::shared_ptr<std::unordered_map<uint64_t, Ptr<MobilityModel> > > &mobility,
+            uint16_t rnti)
+{
+  if (! rrc->HasUeManager (rnti))
+    {
+      return -1.0;
+    }
+  uint64_t imsi = rrc->GetUeManager (rnti)->GetImsi ();
+
+  auto it = mobility->find (imsi);
+  if (it == mobility->end ())
+    {
+      Ptr<MobilityModel> mm;
+      for (auto node = NodeList::Begin (); node != NodeList::End () && mm == nullptr; ++node)
+        {
+          for (uint32_t i = 0; i < (*node)->GetNDevices (); ++i)
+            {
+              Ptr<NrUeNetDevice> ueDev = DynamicCast<NrUeNetDevice> ((*node)->GetDevice (i));
+              if (ueDev != nullptr && ueDev->GetImsi () == imsi)
+                {
+                  mm = (*node)->GetObject<MobilityModel> ();
+                  break;
+                }
+            }
+        }
+      it = mobility->emplace (imsi, mm).first;
+    }
+  return it->second != nullptr ? it->second->GetVelocity ().GetLength () : -1.0;
+}
+
 Ptr<NetDevice>
 NrHelper::InstallSingleGnbDevice (const Ptr<Node> &n,
                                       const std::vector<std::reference_wrapper<BandwidthPartInfoPtr> > allBwps,
@@ -835,18 +922,22 @@ NrHelper::InstallSingleGnbDevice (const Ptr<Node> &n,
       cc->SetUlEarfcn (0); // Argh... handover not working
       cc->SetCellId (m_cellIdCounter++);
 
+      auto start = std::chrono::steady_clock::now ();
       auto phy = CreateGnbPhy (n, allBwps[bwpId].get(), dev,
                                std::bind (&NrGnbNetDevice::RouteIngoingCtrlMsgs,
                                           dev, std::placeholders::_1, bwpId), numberOfStreams);
       phy->SetBwpId (bwpId);
       cc->SetPhy (phy);
+      m_startupProfile.m_gnbPhy += SecondsSince (start);
 
+      start = std::chrono::steady_clock::now ();
       auto mac = CreateGnbMac ();
       cc->SetMac (mac);
       phy->GetCam ()->SetNrGnbMac (mac);
 
       auto sched = CreateGnbSched ();
       cc->SetNrMacScheduler (sched);
+      m_startupProfile.m_gnbMacSched += SecondsSince (start);
 
       if (bwpId == 0)
         {
@@ -922,6 +1013,7 @@ NrHelper::InstallSingleGnbDevice (const Ptr<Node> &n,
   rrc->SetLteMacSapProvider (ccmEnbManager->GetLteMacSapProvider ());
   rrc->SetForwardUpCallback (MakeCallback (&NrGnbNetDevice::Receive, dev));
 
+  auto ueMobility = std::make_shared<std::unordered_map<uint64_t, Ptr<MobilityModel> > > ();
   for (auto it = ccMap.begin (); it != ccMap.end (); ++it)
     {
       it->second->GetPhy ()->SetEnbCphySapUser (rrc->GetLteEnbCphySapUser (it->first));
@@ -943,11 +1035,35 @@ NrHelper::InstallSingleGnbDevice (const Ptr<Node> &n,
       it->second->GetScheduler ()->SetMacCschedSapUser (it->second->GetMac ()->GetNrMacCschedSapUser ());
       // Scheduler SAP END
 
+      // The SRS algorithm can adapt the periodicity to the speed of the UEs
+      Ptr<NrMacSchedulerNs3> sched = DynamicCast<NrMacSchedulerNs3> (it->second->GetScheduler ());
+      if (sched != nullptr)
+        {
+          sched->InstallGetUeSpeedFn (std::bind (&GetUeSpeed, PeekPointer (rrc), ueMobility,
+                                                 std::placeholders::_1));
+          sched->InstallGetUeImsiFn (std::bind (&GetUeImsi, PeekPointer (rrc), std::placeholders::_1));
+        }
+
       it->second->GetMac ()->SetLteCcmMacSapUser (ccmEnbManager->GetLteCcmMacSapUser ());
       ccmEnbManager->SetCcmMacSapProviders (it->first, it->second->GetMac ()->GetLteCcmMacSapProvider ());
 
       // insert the pointer to the LteMacSapProvider interface of the MAC layer of the specific component carrier
       ccmEnbManager->SetMacSapProvider (it->first, it->second->GetMac ()->GetMacSapProvider ());
+
+      // the BWP manager algorithm can route the flows by the load of the BWPs;
+      // the per-slot trace is connected only if the algorithm uses it
+      Ptr<BwpManagerGnb> bwpManager = DynamicCast<BwpManagerGnb> (ccmEnbManager);
+      if (bwpManager->NeedsSlotUsage ())
+        {
+          it->second->GetPhy ()->TraceConnectWithoutContext ("SlotDataStats",
+                                                             MakeCallback (&BwpManagerGnb::NotifySlotDataStats,
+                                                                           PeekPointer (bwpManager)));
+        }
+
+      if (m_tracesAtInstall)
+        {
+          ConnectGnbTraces (it->second->GetPhy (), it->second->GetMac (), cellId, rrc);
+        }
     }
 
 
@@ -982,11 +1098,35 @@ void
 NrHelper::AttachToClosestEnb (NetDeviceContainer ueDevices, NetDeviceContainer enbDevices)
 {
   NS_LOG_FUNCTION (this);
+  NS_ASSERT_MSG (enbDevices.GetN () > 0, "empty enb device container");
+
+  auto start = std::chrono::steady_clock::now ();
 
-  for (NetDeviceContainer::Iterator i = ueDevices.Begin (); i != ueDevices.End (); i++)
+  // Positions are read here, in the main thread, as the mobility models may
+  // update their state when queried
+  std::vector<Vector> enbPositions;
+  enbPositions.reserve (enbDevices.GetN ());
+  for (NetDeviceContainer::Iterator i = enbDevices.Begin (); i != enbDevices.End (); ++i)
     {
-      AttachToClosestEnb (*i, enbDevices);
+      enbPositions.push_back ((*i)->GetNode ()->GetObject<MobilityModel> ()->GetPosition ());
     }
+  std::vector<Vector> uePositions;
+  uePositions.reserve (ueDevices.GetN ());
+  for (NetDeviceContainer::Iterator i = ueDevices.Begin (); i != ueDevices.End (); ++i)
+    {
+      uePositions.push_back ((*i)->GetNode ()->GetObject<MobilityModel> ()->GetPosition ());
+    }
+
+  NrSpatialIndex enbIndex (enbPositions);
+  std::vector<uint32_t> closestEnb = enbIndex.FindClosest (uePositions);
+  m_startupProfile.m_closestGnbSearch += SecondsSince (start);
+
+  start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < ueDevices.GetN (); ++i)
+    {
+      AttachToEnb (ueDevices.Get (i), enbDevices.Get (closestEnb.at (i)));
+    }
+  m_startupProfile.m_attach += SecondsSince (start);
 }
 
 void
@@ -1495,9 +1635,12 @@ NrHelper::ActivateDataRadioBearer (Ptr<NetDevice> ueDevice, EpsBearer bearer)
 void
 NrHelper::EnableTraces (void)
 {
-  EnableDlDataPhyTraces ();
-  EnableDlCtrlPhyTraces ();
-  EnableUlPhyTraces ();
+  if (! m_tracesAtInstall)
+    {
+      EnableDlDataPhyTraces ();
+      EnableDlCtrlPhyTraces ();
+      EnableUlPhyTraces ();
+    }
   //EnableEnbPacketCountTrace ();
   //EnableUePacketCountTrace ();
   //EnableTransportBlockTrace ();
@@ -1505,15 +1648,312 @@ NrHelper::EnableTraces (void)
   EnableRlcE2eTraces ();
   EnablePdcpSimpleTraces ();
   EnablePdcpE2eTraces ();
-  EnableGnbPhyCtrlMsgsTraces ();
-  EnableUePhyCtrlMsgsTraces ();
-  EnableGnbMacCtrlMsgsTraces ();
-  EnableUeMacCtrlMsgsTraces ();
-  EnableDlMacSchedTraces ();
-  EnableUlMacSchedTraces ();
+  if (! m_tracesAtInstall)
+    {
+      EnableGnbPhyCtrlMsgsTraces ();
+      EnableUePhyCtrlMsgsTraces ();
+      EnableGnbMacCtrlMsgsTraces ();
+      EnableUeMacCtrlMsgsTraces ();
+      EnableDlMacSchedTraces ();
+      EnableUlMacSchedTraces ();
+    }
   EnablePathlossTraces ();
 }
 
+void
+NrHelper::EnableTracesAtInstall (void)
+{
+  NS_LOG_FUNCTION (this);
+  m_tracesAtInstall = true;
+}
+
+const NrHelper::StartupProfile &
+NrHelper::GetStartupProfile () const
+{
+  return m_startupProfile;
+}
+
+void
+NrHelper::PrintStartupProfile (std::ostream &os) const
+{
+  os << "gNB devices: " << m_startupProfile.m_gnbNum
+     << ", UE devices: " << m_startupProfile.m_ueNum << std::endl
+     << "gNB PHY creation [s]:       " << m_startupProfile.m_gnbPhy << std::endl
+     << "gNB MAC/sched creation [s]: " << m_startupProfile.m_gnbMacSched << std::endl
+     << "gNB installation [s]:       " << m_startupProfile.m_gnbInstall << std::endl
+     << "UE PHY creation [s]:        " << m_startupProfile.m_uePhy << std::endl
+     << "UE MAC creation [s]:        " << m_startupProfile.m_ueMac << std::endl
+     << "UE installation [s]:        " << m_startupProfile.m_ueInstall << std::endl
+     << "closest gNB search [s]:     " << m_startupProfile.m_closestGnbSearch << std::endl
+     << "attachment [s]:             " << m_startupProfile.m_attach << std::endl;
+}
+
+/**
+ * \brief Magic number at the beginning of a checkpoint ("NRCK")
+ */
+static const uint32_t CHECKPOINT_MAGIC = 0x4B43524E;
+/**
+ * \brief Version of the checkpoint format
+ */
+static const uint16_t CHECKPOINT_VERSION = 3;
+
+/**
+ * \brief Kind of the sections of a checkpoint
+ */
+enum CheckpointSection : uint8_t
+{
+  CHECKPOINT_SCHEDULER = 0,    //!< UEs of the scheduler of a gNB BWP
+  CHECKPOINT_UE_MAC = 1,       //!< MAC of a UE BWP
+  CHECKPOINT_BEAM_MANAGER = 2  //!< Beam manager of a stream of a gNB or UE BWP
+};
+
+/**
+ * \brief Get the beam managers of a PHY, one per stream
+ * \param phy the PHY
+ * \return the beam managers
+ */
+static std::vector<Ptr<BeamManager> >
+GetBeamManagers (const Ptr<NrPhy> &phy)
+{
+  std::vector<Ptr<BeamManager> > managers;
+  for (uint8_t stream = 0; stream < phy->GetNumberOfStreams (); ++stream)
+    {
+      managers.push_back (phy->GetSpectrumPhy (stream)->GetBeamManager ());
+    }
+  return managers;
+}
+
+void
+NrHelper::SaveCheckpoint (const std::string &fileName,
+                          const NetDeviceContainer &gnbDevices,
+                          const NetDeviceContainer &ueDevices)
+{
+  NS_LOG_FUNCTION (fileName);
+
+  NrCheckpointWriter writer;
+  writer.WriteU32 (CHECKPOINT_MAGIC);
+  writer.WriteU16 (CHECKPOINT_VERSION);
+  writer.WriteU32 (RngSeedManager::GetSeed ());
+  writer.WriteU64 (RngSeedManager::GetRun ());
+  writer.WriteU64 (static_cast<uint64_t> (Simulator::Now ().GetNanoSeconds ()));
+
+  // The number of sections is known only at the end: the sections are in a record
+  size_t sections = writer.BeginRecord ();
+
+  auto writeBeams = [&writer] (uint32_t nodeId, uint8_t bwp, const Ptr<NrPhy> &phy)
+    {
+      auto managers = GetBeamManagers (phy);
+      for (uint8_t stream = 0; stream < managers.size (); ++stream)
+        {
+          writer.WriteU8 (CHECKPOINT_BEAM_MANAGER);
+          writer.WriteU32 (nodeId);
+          writer.WriteU8 (bwp);
+          writer.WriteU8 (stream);
+          size_t record = writer.BeginRecord ();
+          managers.at (stream)->SaveState (writer);
+          writer.EndRecord (record);
+        }
+    };
+
+  for (auto it = gnbDevices.Begin (); it != gnbDevices.End (); ++it)
+    {
+      uint32_t nodeId = (*it)->GetNode ()->GetId ();
+      for (uint32_t bwp = 0; bwp < GetNumberBwp (*it); ++bwp)
+        {
+          auto sched = DynamicCast<NrMacSchedulerNs3> (GetScheduler (*it, bwp));
+          if (sched != nullptr)
+            {
+              writer.WriteU8 (CHECKPOINT_SCHEDULER);
+              writer.WriteU32 (nodeId);
+              writer.WriteU8 (static_cast<uint8_t> (bwp));
+              writer.WriteU8 (0);
+              size_t record = writer.BeginRecord ();
+              sched->SaveState (writer);
+              writer.EndRecord (record);
+            }
+          writeBeams (nodeId, static_cast<uint8_t> (bwp), GetGnbPhy (*it, bwp));
+        }
+    }
+
+  for (auto it = ueDevices.Begin (); it != ueDevices.End (); ++it)
+    {
+      uint32_t nodeId = (*it)->GetNode ()->GetId ();
+      Ptr<NrUeNetDevice> ueDev = DynamicCast<NrUeNetDevice> (*it);
+      NS_ABORT_MSG_IF (ueDev == nullptr, "Device of node " << nodeId << " is not an NR UE");
+      for (uint32_t bwp = 0; bwp < ueDev->GetCcMapSize (); ++bwp)
+        {
+          writer.WriteU8 (CHECKPOINT_UE_MAC);
+          writer.WriteU32 (nodeId);
+          writer.WriteU8 (static_cast<uint8_t> (bwp));
+          writer.WriteU8 (0);
+          size_t record = writer.BeginRecord ();
+          GetUeMac (*it, bwp)->SaveState (writer);
+          writer.EndRecord (record);
+
+          writeBeams (nodeId, static_cast<uint8_t> (bwp), GetUePhy (*it, bwp));
+        }
+    }
+
+  writer.EndRecord (sections);
+
+  std::ofstream file (fileName, std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (! file.is_open (), "Can't open the checkpoint file " << fileName);
+  const auto & buffer = writer.GetBuffer ();
+  file.write (reinterpret_cast<const char *> (buffer.data ()), static_cast<std::streamsize> (buffer.size ()));
+  NS_ABORT_MSG_IF (! file.good (), "Error writing the checkpoint file " << fileName);
+
+  NS_LOG_INFO ("Saved a checkpoint of " << buffer.size () << " bytes in " << fileName);
+}
+
+void
+NrHelper::RestoreCheckpoint (const std::string &fileName,
+                             const NetDeviceContainer &gnbDevices,
+                             const NetDeviceContainer &ueDevices)
+{
+  NS_LOG_FUNCTION (fileName);
+
+  std::ifstream file (fileName, std::ios::binary);
+  NS_ABORT_MSG_IF (! file.is_open (), "Can't open the checkpoint file " << fileName);
+  std::vector<uint8_t> buffer ((std::istreambuf_iterator<char> (file)),
+                               std::istreambuf_iterator<char> ());
+
+  NrCheckpointReader reader (buffer);
+  NS_ABORT_MSG_IF (reader.ReadU32 () != CHECKPOINT_MAGIC, fileName << " is not an NR checkpoint");
+  uint16_t version = reader.ReadU16 ();
+  NS_ABORT_MSG_IF (version != CHECKPOINT_VERSION,
+                   "Unsupported version " << version << " of the NR checkpoint " << fileName);
+  uint32_t seed = reader.ReadU32 ();
+  uint64_t run = reader.ReadU64 ();
+  Time savedAt = NanoSeconds (static_cast<int64_t> (reader.ReadU64 ()));
+  if (seed != RngSeedManager::GetSeed () || run != RngSeedManager::GetRun ())
+    {
+      NS_LOG_WARN ("The checkpoint was saved with seed " << seed << " and run " << run <<
+                   ", the simulation uses seed " << RngSeedManager::GetSeed () <<
+                   " and run " << RngSeedManager::GetRun ());
+    }
+  NS_LOG_INFO ("Restoring the checkpoint saved at " << savedAt.As (Time::S) <<
+               " at " << Simulator::Now ().As (Time::S));
+
+  std::unordered_map<uint32_t, Ptr<NetDevice> > gnbs;
+  for (auto it = gnbDevices.Begin (); it != gnbDevices.End (); ++it)
+    {
+      gnbs.emplace ((*it)->GetNode ()->GetId (), *it);
+    }
+  std::unordered_map<uint32_t, Ptr<NetDevice> > ues;
+  for (auto it = ueDevices.Begin (); it != ueDevices.End (); ++it)
+    {
+      ues.emplace ((*it)->GetNode ()->GetId (), *it);
+    }
+
+  size_t sections = reader.BeginRecord ();
+  while (! reader.IsAtEnd ())
+    {
+      uint8_t kind = reader.ReadU8 ();
+      uint32_t nodeId = reader.ReadU32 ();
+      uint8_t bwp = reader.ReadU8 ();
+      uint8_t stream = reader.ReadU8 ();
+      size_t record = reader.BeginRecord ();
+
+      auto gnb = gnbs.find (nodeId);
+      auto ue = ues.find (nodeId);
+      if (kind == CHECKPOINT_SCHEDULER && gnb != gnbs.end () && bwp < GetNumberBwp (gnb->second))
+        {
+          auto sched = DynamicCast<NrMacSchedulerNs3> (GetScheduler (gnb->second, bwp));
+          if (sched != nullptr)
+            {
+              sched->RestoreState (reader);
+            }
+        }
+      else if (kind == CHECKPOINT_UE_MAC && ue != ues.end ()
+               && bwp < DynamicCast<NrUeNetDevice> (ue->second)->GetCcMapSize ())
+        {
+          GetUeMac (ue->second, bwp)->RestoreState (reader);
+        }
+      else if (kind == CHECKPOINT_BEAM_MANAGER && (gnb != gnbs.end () || ue != ues.end ()))
+        {
+          Ptr<NrPhy> phy;
+          if (gnb != gnbs.end () && bwp < GetNumberBwp (gnb->second))
+            {
+              phy = GetGnbPhy (gnb->second, bwp);
+            }
+          else if (ue != ues.end () && bwp < DynamicCast<NrUeNetDevice> (ue->second)->GetCcMapSize ())
+            {
+              phy = GetUePhy (ue->second, bwp);
+            }
+          if (phy != nullptr && stream < phy->GetNumberOfStreams ())
+            {
+              phy->GetSpectrumPhy (stream)->GetBeamManager ()->RestoreState (reader);
+            }
+        }
+      else
+        {
+          NS_LOG_WARN ("Skipping section " << +kind << " of node " << nodeId << " BWP " << +bwp);
+        }
+
+      reader.EndRecord (record);
+    }
+  reader.EndRecord (sections);
+}
+
+void
+NrHelper::ConnectUeTraces (const Ptr<NrUePhy> &phy, const Ptr<NrUeMac> &mac)
+{
+  NS_LOG_FUNCTION (this);
+
+  phy->TraceConnectWithoutContext ("DlDataSinr",
+                                   MakeBoundCallback (&NrPhyRxTrace::DlDataSinrNoCtxCallback, m_phyStats));
+  phy->TraceConnectWithoutContext ("DlCtrlSinr",
+                                   MakeBoundCallback (&NrPhyRxTrace::DlCtrlSinrNoCtxCallback, m_phyStats));
+  phy->TraceConnectWithoutContext ("UePhyRxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrPhyRxTrace::RxedUePhyCtrlMsgsNoCtxCallback, m_phyStats));
+  phy->TraceConnectWithoutContext ("UePhyTxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrPhyRxTrace::TxedUePhyCtrlMsgsNoCtxCallback, m_phyStats));
+  phy->TraceConnectWithoutContext ("UePhyRxedDlDciTrace",
+                                   MakeBoundCallback (&NrPhyRxTrace::RxedUePhyDlDciNoCtxCallback, m_phyStats));
+  phy->TraceConnectWithoutContext ("UePhyTxedHarqFeedbackTrace",
+                                   MakeBoundCallback (&NrPhyRxTrace::TxedUePhyHarqFeedbackNoCtxCallback, m_phyStats));
+
+  for (uint8_t streamIndex = 0; streamIndex < phy->GetNumberOfStreams (); ++streamIndex)
+    {
+      phy->GetSpectrumPhy (streamIndex)->TraceConnectWithoutContext ("RxPacketTraceUe",
+                                                                      MakeBoundCallback (&NrPhyRxTrace::RxPacketTraceUeNoCtxCallback, m_phyStats));
+    }
+
+  mac->TraceConnectWithoutContext ("UeMacRxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrMacRxTrace::RxedUeMacCtrlMsgsNoCtxCallback, m_macStats));
+  mac->TraceConnectWithoutContext ("UeMacTxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrMacRxTrace::TxedUeMacCtrlMsgsNoCtxCallback, m_macStats));
+}
+
+void
+NrHelper::ConnectGnbTraces (const Ptr<NrGnbPhy> &phy, const Ptr<NrGnbMac> &mac,
+                            uint16_t cellId, const Ptr<LteEnbRrc> &rrc)
+{
+  NS_LOG_FUNCTION (this << cellId);
+
+  phy->TraceConnectWithoutContext ("GnbPhyRxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrPhyRxTrace::RxedGnbPhyCtrlMsgsNoCtxCallback, m_phyStats));
+  phy->TraceConnectWithoutContext ("GnbPhyTxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrPhyRxTrace::TxedGnbPhyCtrlMsgsNoCtxCallback, m_phyStats));
+
+  for (uint8_t streamIndex = 0; streamIndex < phy->GetNumberOfStreams (); ++streamIndex)
+    {
+      phy->GetSpectrumPhy (streamIndex)->TraceConnectWithoutContext ("RxPacketTraceEnb",
+                                                                      MakeBoundCallback (&NrPhyRxTrace::RxPacketTraceEnbNoCtxCallback, m_phyStats));
+    }
+
+  mac->TraceConnectWithoutContext ("GnbMacRxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrMacRxTrace::RxedGnbMacCtrlMsgsNoCtxCallback, m_macStats));
+  mac->TraceConnectWithoutContext ("GnbMacTxedCtrlMsgsTrace",
+                                   MakeBoundCallback (&NrMacRxTrace::TxedGnbMacCtrlMsgsNoCtxCallback, m_macStats));
+  mac->TraceConnectWithoutContext ("DlScheduling",
+                                   MakeBoundCallback (&NrMacSchedulingStats::DlSchedulingNoCtxCallback,
+                                                      m_macSchedStats, cellId, rrc));
+  mac->TraceConnectWithoutContext ("UlScheduling",
+                                   MakeBoundCallback (&NrMacSchedulingStats::UlSchedulingNoCtxCallback,
+                                                      m_macSchedStats, cellId, rrc));
+}
+
 Ptr<NrPhyRxTrace>
 NrHelper::GetPhyRxTrace (void)
 {
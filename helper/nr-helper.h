@@ -54,6 +54,7 @@ class NrUeNetDevice;
 class NrUeMac;
 class BwpManagerGnb;
 class BwpManagerUe;
+class LteEnbRrc;
 
 /**
  * \ingroup helper
@@ -309,6 +310,10 @@ public:
    * \brief Attach the UE specified to the closest GNB
    * \param ueDevices UE devices to attach
    * \param enbDevices GNB devices from which the algorithm has to select the closest
+   *
+   * The GNB positions are stored in a NrSpatialIndex, and the closest GNB of
+   * each UE is searched in parallel over the available cores; the UEs are
+   * then attached one by one, in the order of the container.
    */
   void AttachToClosestEnb (NetDeviceContainer ueDevices, NetDeviceContainer enbDevices);
   /**
@@ -328,6 +333,93 @@ public:
    */
   void EnableTraces ();
 
+  /**
+   * \brief Connect the PHY and MAC trace sinks while the devices are installed
+   *
+   * The Enable*Traces () methods connect the sinks through wildcard config
+   * paths, that have to be resolved over all the nodes, devices and bandwidth
+   * parts of the simulation; moreover, each trace event builds a context
+   * string that the sink has to parse back. With large topologies, this takes
+   * a noticeable part of the simulation startup.
+   *
+   * After calling this method, the PHY, spectrum PHY and MAC trace sources
+   * of each device are instead connected to context-free sinks directly by
+   * InstallUeDevice () and InstallGnbDevice (), when the objects are created.
+   * The method must be called before installing the devices: the devices
+   * installed before are not traced. EnableTraces () will then connect only
+   * the remaining traces (RLC, PDCP, and path loss), that are not available
+   * at installation time.
+   */
+  void EnableTracesAtInstall ();
+
+  /**
+   * \brief Wall-clock time spent by the helper in each phase of the setup
+   *
+   * The times are accumulated over all the calls to InstallGnbDevice (),
+   * InstallUeDevice () and AttachToClosestEnb ().
+   */
+  struct StartupProfile
+  {
+    uint32_t m_gnbNum {0};          //!< Number of installed gNB devices
+    uint32_t m_ueNum {0};           //!< Number of installed UE devices
+    double m_gnbPhy {0.0};          //!< Creation of the gNB PHYs and spectrum PHYs [s]
+    double m_gnbMacSched {0.0};     //!< Creation of the gNB MACs and schedulers [s]
+    double m_gnbInstall {0.0};      //!< Whole gNB installation, RRC and SAP wiring included [s]
+    double m_uePhy {0.0};           //!< Creation of the UE PHYs and spectrum PHYs [s]
+    double m_ueMac {0.0};           //!< Creation of the UE MACs [s]
+    double m_ueInstall {0.0};       //!< Whole UE installation, RRC, NAS and SAP wiring included [s]
+    double m_closestGnbSearch {0.0}; //!< Spatial index build and closest gNB search [s]
+    double m_attach {0.0};          //!< Attachment of the UEs to the gNBs [s]
+  };
+
+  /**
+   * \brief Get the time spent in each phase of the setup
+   * \return the startup profile
+   */
+  const StartupProfile & GetStartupProfile () const;
+
+  /**
+   * \brief Print the startup profile, one phase per line
+   * \param os the output stream
+   */
+  void PrintStartupProfile (std::ostream &os) const;
+
+  /**
+   * \brief Save the state learnt by the NR devices in a binary checkpoint
+   * \param fileName the name of the checkpoint file
+   * \param gnbDevices the gNB devices
+   * \param ueDevices the UE devices
+   *
+   * The checkpoint contains, for each BWP, the state of the UEs in the
+   * scheduler of the gNBs (CQI, MCS, PF averages, see
+   * NrMacSchedulerNs3::SaveState), the sidelink sensing data of the UE MACs
+   * and the beamforming vectors of all the devices. The objects are
+   * identified by node id and BWP, so the checkpoint can be restored only
+   * in the same topology.
+   *
+   * Events in flight (HARQ processes, grants, RRC procedures) and the
+   * position of the random streams are not saved: a warm start reaches the
+   * state of the checkpoint after the UEs are attached, instead of waiting
+   * for the averages and the windows to converge. The seed and run number
+   * are saved, and a mismatch is reported on restore.
+   */
+  static void SaveCheckpoint (const std::string &fileName,
+                              const NetDeviceContainer &gnbDevices,
+                              const NetDeviceContainer &ueDevices);
+
+  /**
+   * \brief Restore a checkpoint written by SaveCheckpoint
+   * \param fileName the name of the checkpoint file
+   * \param gnbDevices the gNB devices
+   * \param ueDevices the UE devices
+   *
+   * It should be called (e.g., scheduled) once the UEs are attached to the
+   * gNBs. The state of devices or UEs that are not found is skipped.
+   */
+  static void RestoreCheckpoint (const std::string &fileName,
+                                 const NetDeviceContainer &gnbDevices,
+                                 const NetDeviceContainer &ueDevices);
+
   /**
    * \brief Activate a Data Radio Bearer on a given UE devices
    *
@@ -893,6 +985,22 @@ private:
                                          uint8_t numberOfPanels);
   void AttachToClosestEnb (Ptr<NetDevice> ueDevice, NetDeviceContainer enbDevices);
 
+  /**
+   * \brief Connect the PHY and MAC trace sinks of a UE bandwidth part
+   * \param phy the UE PHY
+   * \param mac the UE MAC
+   */
+  void ConnectUeTraces (const Ptr<NrUePhy> &phy, const Ptr<NrUeMac> &mac);
+  /**
+   * \brief Connect the PHY, MAC and scheduling trace sinks of a gNB bandwidth part
+   * \param phy the gNB PHY
+   * \param mac the gNB MAC
+   * \param cellId the cell id of the gNB device
+   * \param rrc the RRC of the gNB device, used to find the IMSI of the scheduled UEs
+   */
+  void ConnectGnbTraces (const Ptr<NrGnbPhy> &phy, const Ptr<NrGnbMac> &mac,
+                         uint16_t cellId, const Ptr<LteEnbRrc> &rrc);
+
   std::map<uint8_t, ComponentCarrier> GetBandwidthPartMap ();
 
   ObjectFactory m_gnbNetDeviceFactory;  //!< NetDevice factory for gnb
@@ -927,6 +1035,8 @@ private:
 
   bool m_harqEnabled {false};
   bool m_snrTest {false};
+  bool m_tracesAtInstall {false}; //!< Connect the PHY and MAC traces while installing the devices
+  StartupProfile m_startupProfile; //!< Time spent in each phase of the setup
 
   Ptr<NrPhyRxTrace> m_phyStats; //!< Pointer to the PhyRx stats
   Ptr<NrMacRxTrace> m_macStats; //!< Pointer to the MacRx stats
@@ -77,9 +77,12 @@ NrMacRxTrace::GetTypeId (void)
 }
 
 void
-NrMacRxTrace::RxedGnbMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::string path,
-                                              SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                              uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrMacRxTrace::RxedGnbMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg)
 {
   if (!m_rxedGnbMacCtrlMsgsFile.is_open ())
       {
@@ -132,9 +135,12 @@ NrMacRxTrace::RxedGnbMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::strin
 }
 
 void
-NrMacRxTrace::TxedGnbMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::string path,
-                                              SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                              uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrMacRxTrace::TxedGnbMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg)
 {
   if (!m_txedGnbMacCtrlMsgsFile.is_open ())
       {
@@ -176,9 +182,12 @@ NrMacRxTrace::TxedGnbMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::strin
 }
 
 void
-NrMacRxTrace::RxedUeMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::string path,
-                                             SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                             uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrMacRxTrace::RxedUeMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg)
 {
   if (!m_rxedUeMacCtrlMsgsFile.is_open ())
       {
@@ -223,9 +232,12 @@ NrMacRxTrace::RxedUeMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::string
 }
 
 void
-NrMacRxTrace::TxedUeMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::string path,
-                                             SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                             uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrMacRxTrace::TxedUeMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg)
 {
   if (!m_txedUeMacCtrlMsgsFile.is_open ())
       {
@@ -270,4 +282,52 @@ NrMacRxTrace::TxedUeMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats, std::string
   m_txedUeMacCtrlMsgsFile << std::endl;
 }
 
+void
+NrMacRxTrace::RxedGnbMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats,
+                                          [[maybe_unused]] std::string path,
+                                          SfnSf sfn,
+                                          uint16_t nodeId,
+                                          uint16_t rnti,
+                                          uint8_t bwpId,
+                                          Ptr<const NrControlMessage> msg)
+{
+  RxedGnbMacCtrlMsgsNoCtxCallback (macStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrMacRxTrace::TxedGnbMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats,
+                                          [[maybe_unused]] std::string path,
+                                          SfnSf sfn,
+                                          uint16_t nodeId,
+                                          uint16_t rnti,
+                                          uint8_t bwpId,
+                                          Ptr<const NrControlMessage> msg)
+{
+  TxedGnbMacCtrlMsgsNoCtxCallback (macStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrMacRxTrace::RxedUeMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats,
+                                         [[maybe_unused]] std::string path,
+                                         SfnSf sfn,
+                                         uint16_t nodeId,
+                                         uint16_t rnti,
+                                         uint8_t bwpId,
+                                         Ptr<const NrControlMessage> msg)
+{
+  RxedUeMacCtrlMsgsNoCtxCallback (macStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrMacRxTrace::TxedUeMacCtrlMsgsCallback (Ptr<NrMacRxTrace> macStats,
+                                         [[maybe_unused]] std::string path,
+                                         SfnSf sfn,
+                                         uint16_t nodeId,
+                                         uint16_t rnti,
+                                         uint8_t bwpId,
+                                         Ptr<const NrControlMessage> msg)
+{
+  TxedUeMacCtrlMsgsNoCtxCallback (macStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
 } /* namespace ns3 */
@@ -52,6 +52,17 @@ public:
                                           SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                           uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of RxedGnbMacCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxedGnbMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Enb Mac Transmitted Control Messages.
    *
@@ -68,6 +79,17 @@ public:
                                           SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                           uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of TxedGnbMacCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void TxedGnbMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Ue Mac Received Control Messages.
    *
@@ -84,6 +106,17 @@ public:
                                          SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                          uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of RxedUeMacCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxedUeMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Ue Mac Transmitted Control Messages.
    *
@@ -100,6 +133,17 @@ public:
                                          SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                          uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of TxedUeMacCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void TxedUeMacCtrlMsgsNoCtxCallback (Ptr<NrMacRxTrace> macStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg);
+
 private:
 
   static std::ofstream m_rxedGnbMacCtrlMsgsFile;
@@ -22,6 +22,7 @@
 #include <ns3/simulator.h>
 #include <ns3/log.h>
 #include "nr-mac-scheduling-stats.h"
+#include <ns3/lte-enb-rrc.h>
 
 namespace ns3 {
 
@@ -249,5 +250,37 @@ NrMacSchedulingStats::UlSchedulingCallback (Ptr<NrMacSchedulingStats> macStats,
   macStats->UlScheduling (cellId, imsi, traceInfo);
 }
 
+/**
+ * \brief Get the IMSI of a UE from the gNB RRC
+ * \param rrc the gNB RRC
+ * \param rnti the RNTI of the UE
+ * \return the IMSI, or 0 if the UE is not known by the RRC
+ */
+static uint64_t
+GetImsiFromGnbRrc (const Ptr<LteEnbRrc> &rrc, uint16_t rnti)
+{
+  if (rrc->HasUeManager (rnti))
+    {
+      return rrc->GetUeManager (rnti)->GetImsi ();
+    }
+  return 0;
+}
+
+void
+NrMacSchedulingStats::DlSchedulingNoCtxCallback (Ptr<NrMacSchedulingStats> macStats, uint16_t cellId,
+                                                 Ptr<LteEnbRrc> rrc, NrSchedulingCallbackInfo traceInfo)
+{
+  NS_LOG_FUNCTION (macStats << cellId);
+  macStats->DlScheduling (cellId, GetImsiFromGnbRrc (rrc, traceInfo.m_rnti), traceInfo);
+}
+
+void
+NrMacSchedulingStats::UlSchedulingNoCtxCallback (Ptr<NrMacSchedulingStats> macStats, uint16_t cellId,
+                                                 Ptr<LteEnbRrc> rrc, NrSchedulingCallbackInfo traceInfo)
+{
+  NS_LOG_FUNCTION (macStats << cellId);
+  macStats->UlScheduling (cellId, GetImsiFromGnbRrc (rrc, traceInfo.m_rnti), traceInfo);
+}
+
 
 } // namespace ns3
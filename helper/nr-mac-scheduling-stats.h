@@ -30,6 +30,8 @@
 
 namespace ns3 {
 
+class LteEnbRrc;
+
 /**
  * \ingroup nr
  *
@@ -130,6 +132,31 @@ public:
    */
   static void UlSchedulingCallback (Ptr<NrMacSchedulingStats> macStats, std::string path, NrSchedulingCallbackInfo traceInfo);
 
+  /**
+   * Context-free trace sink for the ns3::NrGnbMac::DlScheduling trace source,
+   * used when the sinks are connected while installing the devices. The IMSI
+   * is retrieved directly from the RRC, instead of parsing the context path.
+   *
+   * \param macStats the pointer to the MAC stats
+   * \param cellId the cell ID of the gNB device
+   * \param rrc the RRC of the gNB device
+   * \param traceInfo - all the traces information in a single structure
+   */
+  static void DlSchedulingNoCtxCallback (Ptr<NrMacSchedulingStats> macStats, uint16_t cellId,
+                                         Ptr<LteEnbRrc> rrc, NrSchedulingCallbackInfo traceInfo);
+
+  /**
+   * Context-free trace sink for the ns3::NrGnbMac::UlScheduling trace source
+   *
+   * \param macStats the pointer to the MAC stats
+   * \param cellId the cell ID of the gNB device
+   * \param rrc the RRC of the gNB device
+   * \param traceInfo - all the traces information in a single structure
+   * \see DlSchedulingNoCtxCallback
+   */
+  static void UlSchedulingNoCtxCallback (Ptr<NrMacSchedulingStats> macStats, uint16_t cellId,
+                                         Ptr<LteEnbRrc> rrc, NrSchedulingCallbackInfo traceInfo);
+
 private:
   /**
    * When writing DL MAC statistics first time to file,
@@ -149,8 +149,12 @@ NrPhyRxTrace::SetSimTag (const std::string &simTag)
 }
 
 void
-NrPhyRxTrace::DlDataSinrCallback ([[maybe_unused]]Ptr<NrPhyRxTrace> phyStats, [[maybe_unused]] std::string path,
-                                  uint16_t cellId, uint16_t rnti, double avgSinr, uint16_t bwpId, uint8_t streamId)
+NrPhyRxTrace::DlDataSinrNoCtxCallback ([[maybe_unused]]Ptr<NrPhyRxTrace> phyStats,
+                                       uint16_t cellId,
+                                       uint16_t rnti,
+                                       double avgSinr,
+                                       uint16_t bwpId,
+                                       uint8_t streamId)
 {
   NS_LOG_INFO ("UE" << rnti << "of " << cellId << " over bwp ID " << bwpId << "->Generate RsrpSinrTrace");
   if (!m_dlDataSinrFile.is_open ())
@@ -176,8 +180,12 @@ NrPhyRxTrace::DlDataSinrCallback ([[maybe_unused]]Ptr<NrPhyRxTrace> phyStats, [[
 
 
 void
-NrPhyRxTrace::DlCtrlSinrCallback ([[maybe_unused]] Ptr<NrPhyRxTrace> phyStats, [[maybe_unused]] std::string path,
-                                  uint16_t cellId, uint16_t rnti, double avgSinr, uint16_t bwpId, uint8_t streamId)
+NrPhyRxTrace::DlCtrlSinrNoCtxCallback ([[maybe_unused]] Ptr<NrPhyRxTrace> phyStats,
+                                       uint16_t cellId,
+                                       uint16_t rnti,
+                                       double avgSinr,
+                                       uint16_t bwpId,
+                                       uint8_t streamId)
 {
   NS_LOG_INFO ("UE" << rnti << "of " << cellId << " over bwp ID " << bwpId << "->Generate RsrpSinrTrace");
 
@@ -228,9 +236,12 @@ NrPhyRxTrace::UlSinrTraceCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
 }
 
 void
-NrPhyRxTrace::RxedGnbPhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
-                                              SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                              uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrPhyRxTrace::RxedGnbPhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg)
 {
   if (!m_rxedGnbPhyCtrlMsgsFile.is_open ())
       {
@@ -290,9 +301,12 @@ NrPhyRxTrace::RxedGnbPhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::strin
 }
 
 void
-NrPhyRxTrace::TxedGnbPhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
-                                              SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                              uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrPhyRxTrace::TxedGnbPhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg)
 {
   if (!m_txedGnbPhyCtrlMsgsFile.is_open ())
       {
@@ -347,9 +361,12 @@ NrPhyRxTrace::TxedGnbPhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::strin
 }
 
 void
-NrPhyRxTrace::RxedUePhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
-                                             SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                             uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrPhyRxTrace::RxedUePhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg)
 {
   if (!m_rxedUePhyCtrlMsgsFile.is_open ())
       {
@@ -404,9 +421,12 @@ NrPhyRxTrace::RxedUePhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::string
 }
 
 void
-NrPhyRxTrace::TxedUePhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
-                                             SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                             uint8_t bwpId, Ptr<const NrControlMessage> msg)
+NrPhyRxTrace::TxedUePhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg)
 {
   if (!m_txedUePhyCtrlMsgsFile.is_open ())
       {
@@ -466,9 +486,13 @@ NrPhyRxTrace::TxedUePhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats, std::string
 }
 
 void
-NrPhyRxTrace::RxedUePhyDlDciCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
-                                          SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                          uint8_t bwpId, uint8_t harqId, uint32_t k1Delay)
+NrPhyRxTrace::RxedUePhyDlDciNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                           SfnSf sfn,
+                                           uint16_t nodeId,
+                                           uint16_t rnti,
+                                           uint8_t bwpId,
+                                           uint8_t harqId,
+                                           uint32_t k1Delay)
 {
   if (!m_rxedUePhyDlDciFile.is_open ())
       {
@@ -499,9 +523,13 @@ NrPhyRxTrace::RxedUePhyDlDciCallback (Ptr<NrPhyRxTrace> phyStats, std::string pa
 }
 
 void
-NrPhyRxTrace::TxedUePhyHarqFeedbackCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
-                                             SfnSf sfn, uint16_t nodeId, uint16_t rnti,
-                                             uint8_t bwpId, uint8_t harqId, uint32_t k1Delay)
+NrPhyRxTrace::TxedUePhyHarqFeedbackNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                                  SfnSf sfn,
+                                                  uint16_t nodeId,
+                                                  uint16_t rnti,
+                                                  uint8_t bwpId,
+                                                  uint8_t harqId,
+                                                  uint32_t k1Delay)
 {
   if (!m_rxedUePhyDlDciFile.is_open ())
       {
@@ -651,7 +679,8 @@ NrPhyRxTrace::ReportDLTbSize (uint64_t imsi, uint64_t tbSize)
 }
 
 void
-NrPhyRxTrace::RxPacketTraceUeCallback (Ptr<NrPhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
+NrPhyRxTrace::RxPacketTraceUeNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                            RxPacketTraceParams params)
 {
   if (!m_rxPacketTraceFile.is_open ())
     {
@@ -713,7 +742,8 @@ NrPhyRxTrace::RxPacketTraceUeCallback (Ptr<NrPhyRxTrace> phyStats, std::string p
     }
 }
 void
-NrPhyRxTrace::RxPacketTraceEnbCallback (Ptr<NrPhyRxTrace> phyStats, std::string path, RxPacketTraceParams params)
+NrPhyRxTrace::RxPacketTraceEnbNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                             RxPacketTraceParams params)
 {
   if (!m_rxPacketTraceFile.is_open ())
     {
@@ -892,4 +922,118 @@ NrPhyRxTrace::WriteUlPathlossTrace (Ptr<NrSpectrumPhy> txNrSpectrumPhy,
                    << lossDb << std::endl;
 }
 
+void
+NrPhyRxTrace::DlDataSinrCallback (Ptr<NrPhyRxTrace> phyStats,
+                                  [[maybe_unused]] std::string path,
+                                  uint16_t cellId,
+                                  uint16_t rnti,
+                                  double avgSinr,
+                                  uint16_t bwpId,
+                                  uint8_t streamId)
+{
+  DlDataSinrNoCtxCallback (phyStats, cellId, rnti, avgSinr, bwpId, streamId);
+}
+
+void
+NrPhyRxTrace::DlCtrlSinrCallback (Ptr<NrPhyRxTrace> phyStats,
+                                  [[maybe_unused]] std::string path,
+                                  uint16_t cellId,
+                                  uint16_t rnti,
+                                  double avgSinr,
+                                  uint16_t bwpId,
+                                  uint8_t streamId)
+{
+  DlCtrlSinrNoCtxCallback (phyStats, cellId, rnti, avgSinr, bwpId, streamId);
+}
+
+void
+NrPhyRxTrace::RxPacketTraceUeCallback (Ptr<NrPhyRxTrace> phyStats,
+                                       [[maybe_unused]] std::string path,
+                                       RxPacketTraceParams params)
+{
+  RxPacketTraceUeNoCtxCallback (phyStats, params);
+}
+
+void
+NrPhyRxTrace::RxPacketTraceEnbCallback (Ptr<NrPhyRxTrace> phyStats,
+                                        [[maybe_unused]] std::string path,
+                                        RxPacketTraceParams params)
+{
+  RxPacketTraceEnbNoCtxCallback (phyStats, params);
+}
+
+void
+NrPhyRxTrace::RxedGnbPhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats,
+                                          [[maybe_unused]] std::string path,
+                                          SfnSf sfn,
+                                          uint16_t nodeId,
+                                          uint16_t rnti,
+                                          uint8_t bwpId,
+                                          Ptr<const NrControlMessage> msg)
+{
+  RxedGnbPhyCtrlMsgsNoCtxCallback (phyStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrPhyRxTrace::TxedGnbPhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats,
+                                          [[maybe_unused]] std::string path,
+                                          SfnSf sfn,
+                                          uint16_t nodeId,
+                                          uint16_t rnti,
+                                          uint8_t bwpId,
+                                          Ptr<const NrControlMessage> msg)
+{
+  TxedGnbPhyCtrlMsgsNoCtxCallback (phyStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrPhyRxTrace::RxedUePhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats,
+                                         [[maybe_unused]] std::string path,
+                                         SfnSf sfn,
+                                         uint16_t nodeId,
+                                         uint16_t rnti,
+                                         uint8_t bwpId,
+                                         Ptr<const NrControlMessage> msg)
+{
+  RxedUePhyCtrlMsgsNoCtxCallback (phyStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrPhyRxTrace::TxedUePhyCtrlMsgsCallback (Ptr<NrPhyRxTrace> phyStats,
+                                         [[maybe_unused]] std::string path,
+                                         SfnSf sfn,
+                                         uint16_t nodeId,
+                                         uint16_t rnti,
+                                         uint8_t bwpId,
+                                         Ptr<const NrControlMessage> msg)
+{
+  TxedUePhyCtrlMsgsNoCtxCallback (phyStats, sfn, nodeId, rnti, bwpId, msg);
+}
+
+void
+NrPhyRxTrace::RxedUePhyDlDciCallback (Ptr<NrPhyRxTrace> phyStats,
+                                      [[maybe_unused]] std::string path,
+                                      SfnSf sfn,
+                                      uint16_t nodeId,
+                                      uint16_t rnti,
+                                      uint8_t bwpId,
+                                      uint8_t harqId,
+                                      uint32_t k1Delay)
+{
+  RxedUePhyDlDciNoCtxCallback (phyStats, sfn, nodeId, rnti, bwpId, harqId, k1Delay);
+}
+
+void
+NrPhyRxTrace::TxedUePhyHarqFeedbackCallback (Ptr<NrPhyRxTrace> phyStats,
+                                             [[maybe_unused]] std::string path,
+                                             SfnSf sfn,
+                                             uint16_t nodeId,
+                                             uint16_t rnti,
+                                             uint8_t bwpId,
+                                             uint8_t harqId,
+                                             uint32_t k1Delay)
+{
+  TxedUePhyHarqFeedbackNoCtxCallback (phyStats, sfn, nodeId, rnti, bwpId, harqId, k1Delay);
+}
+
 } /* namespace ns3 */
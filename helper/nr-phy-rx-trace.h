@@ -67,6 +67,17 @@ public:
   static void DlDataSinrCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
                                   uint16_t cellId, uint16_t rnti, double avgSinr, uint16_t bwpId, uint8_t streamId);
 
+  /**
+   * \brief Context-free version of DlDataSinrCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void DlDataSinrNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                       uint16_t cellId,
+                                       uint16_t rnti,
+                                       double avgSinr,
+                                       uint16_t bwpId,
+                                       uint8_t streamId);
+
   /**
    * \brief Trace sink for DL Average SINR of CTRL (in dB).
    * \param [in] phyStats NrPhyRxTrace object
@@ -80,6 +91,17 @@ public:
   static void DlCtrlSinrCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
                                  uint16_t cellId, uint16_t rnti, double avgSinr, uint16_t bwpId, uint8_t streamId);
 
+  /**
+   * \brief Context-free version of DlCtrlSinrCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void DlCtrlSinrNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                       uint16_t cellId,
+                                       uint16_t rnti,
+                                       double avgSinr,
+                                       uint16_t bwpId,
+                                       uint8_t streamId);
+
   static void UlSinrTraceCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
                                    uint64_t imsi, SpectrumValue& sinr, SpectrumValue& power);
   static void ReportPacketCountUeCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
@@ -89,8 +111,23 @@ public:
   static void ReportDownLinkTBSize (Ptr<NrPhyRxTrace> phyStats, std::string path,
                                     uint64_t imsi, uint64_t tbSize);
   static void RxPacketTraceUeCallback (Ptr<NrPhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
+
+  /**
+   * \brief Context-free version of RxPacketTraceUeCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxPacketTraceUeNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                            RxPacketTraceParams param);
+
   static void RxPacketTraceEnbCallback (Ptr<NrPhyRxTrace> phyStats, std::string path, RxPacketTraceParams param);
 
+  /**
+   * \brief Context-free version of RxPacketTraceEnbCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxPacketTraceEnbNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                             RxPacketTraceParams param);
+
   /**
    *  Trace sink for Enb Phy Received Control Messages.
    *
@@ -106,6 +143,17 @@ public:
                                           SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                           uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of RxedGnbPhyCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxedGnbPhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Enb Phy Transmitted Control Messages.
    *
@@ -121,6 +169,17 @@ public:
                                           SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                           uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of TxedGnbPhyCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void TxedGnbPhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                               SfnSf sfn,
+                                               uint16_t nodeId,
+                                               uint16_t rnti,
+                                               uint8_t bwpId,
+                                               Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Ue Phy Received Control Messages.
    *
@@ -136,6 +195,17 @@ public:
                                          SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                          uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of RxedUePhyCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxedUePhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Ue Phy Transmitted Control Messages.
    *
@@ -151,6 +221,17 @@ public:
                                          SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                          uint8_t bwpId, Ptr<const NrControlMessage> msg);
 
+  /**
+   * \brief Context-free version of TxedUePhyCtrlMsgsCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void TxedUePhyCtrlMsgsNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                              SfnSf sfn,
+                                              uint16_t nodeId,
+                                              uint16_t rnti,
+                                              uint8_t bwpId,
+                                              Ptr<const NrControlMessage> msg);
+
   /**
    *  Trace sink for Ue Phy Received Control Messages.
    *
@@ -166,6 +247,18 @@ public:
   static void RxedUePhyDlDciCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
                                       SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                       uint8_t bwpId, uint8_t harqId, uint32_t k1Delay);
+
+  /**
+   * \brief Context-free version of RxedUePhyDlDciCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void RxedUePhyDlDciNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                           SfnSf sfn,
+                                           uint16_t nodeId,
+                                           uint16_t rnti,
+                                           uint8_t bwpId,
+                                           uint8_t harqId,
+                                           uint32_t k1Delay);
   /**
    *  Trace sink for Ue Phy Received Control Messages.
    *
@@ -181,6 +274,18 @@ public:
   static void TxedUePhyHarqFeedbackCallback (Ptr<NrPhyRxTrace> phyStats, std::string path,
                                              SfnSf sfn, uint16_t nodeId, uint16_t rnti,
                                              uint8_t bwpId, uint8_t harqId, uint32_t k1Delay);
+
+  /**
+   * \brief Context-free version of TxedUePhyHarqFeedbackCallback (), used when the
+   * sinks are connected while installing the devices
+   */
+  static void TxedUePhyHarqFeedbackNoCtxCallback (Ptr<NrPhyRxTrace> phyStats,
+                                                  SfnSf sfn,
+                                                  uint16_t nodeId,
+                                                  uint16_t rnti,
+                                                  uint8_t bwpId,
+                                                  uint8_t harqId,
+                                                  uint32_t k1Delay);
   /**
    * \brief Trace sink for spectrum channel pathloss trace
    *
@@ -221,6 +221,16 @@ NrSlHelper::PrepareSingleUeForSidelink (Ptr<NrUeNetDevice> nrUeDev, const std::s
                                          std::placeholders::_1);
       spectrumPhy->SetNrPhyRxPsschEndOkCallback (psschPhyPduOkCallback);
 
+      std::function<void (const NrSlInfoListElement_s&, uint16_t)> slHarqFeedbackCallback;
+      slHarqFeedbackCallback = std::bind (&NrUePhy::PhySlHarqFeedbackGenerated, nrUeDev->GetPhy (itBwps),
+                                          std::placeholders::_1, std::placeholders::_2);
+      spectrumPhy->SetNrPhySlHarqFeedbackCallback (slHarqFeedbackCallback);
+
+      std::function<void (const NrSlInfoListElement_s&)> psfchCallback;
+      psfchCallback = std::bind (&NrUePhy::PhyPsfchReceived, nrUeDev->GetPhy (itBwps),
+                                 std::placeholders::_1);
+      spectrumPhy->SetNrPhyRxPsfchCallback (psfchCallback);
+
       //Set the SAP of NR UE MAC in SL BWP manager
       bool bwpmTest = slBwpManager->SetNrSlMacSapProviders (itBwps, nrUeDev->GetMac (itBwps)->GetNrSlMacSapProvider ());
 
@@ -259,6 +269,43 @@ NrSlHelper::InstallNrSlPreConfiguration (NetDeviceContainer c, const LteRrcSap::
     }
 }
 
+void
+NrSlHelper::InstallNrSlPsfchConfig (NetDeviceContainer c, const NrSlPsfchConfig &psfchConfig)
+{
+  NS_LOG_FUNCTION (this << psfchConfig.period << psfchConfig.minTimeGap);
+
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<NrUeNetDevice> nrUeDev = (*i)->GetObject <NrUeNetDevice>();
+      NS_ABORT_MSG_IF (nrUeDev == nullptr, "NrSlHelper::InstallNrSlPsfchConfig expects NR UE devices");
+      std::set <uint8_t> bwpIds = nrUeDev->GetRrc ()->GetNrSlBwpIdContainer ();
+      NS_ABORT_MSG_IF (bwpIds.empty (), "UE with IMSI " << nrUeDev->GetImsi () << " is not prepared for SL");
+      for (const auto &itBwps : bwpIds)
+        {
+          nrUeDev->GetMac (itBwps)->SetNrSlPsfchConfig (psfchConfig);
+          nrUeDev->GetPhy (itBwps)->SetNrSlPsfchConfig (psfchConfig);
+        }
+    }
+}
+
+void
+NrSlHelper::SetNrSlNumGroupMembers (NetDeviceContainer c, uint32_t dstL2Id, uint16_t numMembers)
+{
+  NS_LOG_FUNCTION (this << dstL2Id << numMembers);
+
+  for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i)
+    {
+      Ptr<NrUeNetDevice> nrUeDev = (*i)->GetObject <NrUeNetDevice>();
+      NS_ABORT_MSG_IF (nrUeDev == nullptr, "NrSlHelper::SetNrSlNumGroupMembers expects NR UE devices");
+      std::set <uint8_t> bwpIds = nrUeDev->GetRrc ()->GetNrSlBwpIdContainer ();
+      NS_ABORT_MSG_IF (bwpIds.empty (), "UE with IMSI " << nrUeDev->GetImsi () << " is not prepared for SL");
+      for (const auto &itBwps : bwpIds)
+        {
+          nrUeDev->GetMac (itBwps)->SetNrSlNumGroupMembers (dstL2Id, numMembers);
+        }
+    }
+}
+
 bool
 NrSlHelper::ConfigUeParams (const Ptr<NrUeNetDevice> &dev,
                             const LteRrcSap::SlFreqConfigCommonNr &freqCommon,
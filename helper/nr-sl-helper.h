@@ -32,6 +32,7 @@ class NrAmc;
 class NrPointToPointEpcHelper;
 class LteSlTft;
 class NrSlUeMacScheduler;
+struct NrSlPsfchConfig;
 
 
 class NrSlHelper : public Object
@@ -68,6 +69,33 @@ public:
    * \param preConfig The <tt> struct LteRrcSap::SidelinkPreconfigNr </tt>
    */
   void InstallNrSlPreConfiguration (NetDeviceContainer c, const LteRrcSap::SidelinkPreconfigNr preConfig);
+  /**
+   * \brief Install the PSFCH configuration of the sidelink resource pool in
+   *        the UEs expected to use sidelink.
+   *
+   * The PSFCH enables the HARQ feedback based retransmissions of the
+   * unicast and groupcast LCs with HARQ enabled (the attribute
+   * EnableBlindReTx of NrUeMac must be false). It must be called after
+   * PrepareUeForSidelink.
+   *
+   * \param c The \c NetDeviceContainer
+   * \param psfchConfig The PSFCH configuration, e.g., obtained from
+   *        NrSlCommResourcePoolFactory::GetSlPsfchConfig
+   */
+  void InstallNrSlPsfchConfig (NetDeviceContainer c, const NrSlPsfchConfig &psfchConfig);
+  /**
+   * \brief Set the number of members of a group in the UEs that transmit
+   *        to it.
+   *
+   * With the HARQ feedback, a groupcast TB is acknowledged only when all
+   * the members of the group sent an ACK; without this configuration, it
+   * is never acknowledged (see NrUeMac::SetNrSlNumGroupMembers).
+   *
+   * \param c The \c NetDeviceContainer
+   * \param dstL2Id The destination layer 2 id of the group
+   * \param numMembers The number of receivers in the group
+   */
+  void SetNrSlNumGroupMembers (NetDeviceContainer c, uint32_t dstL2Id, uint16_t numMembers);
   /**
    * \brief Set UE sidelink AMC attribute
    *
@@ -0,0 +1,237 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-spatial-index.h"
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <thread>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrSpatialIndex");
+
+/**
+ * Minimum number of queries assigned to a thread; below that, creating the
+ * thread costs more than the queries themselves
+ */
+static const size_t MIN_QUERIES_PER_THREAD = 1024;
+
+NrSpatialIndex::NrSpatialIndex (const std::vector<Vector> &points)
+  : m_points (points)
+{
+  NS_LOG_FUNCTION (this << points.size ());
+  NS_ABORT_MSG_IF (points.empty (), "Cannot build a spatial index without points");
+
+  double maxX = -std::numeric_limits<double>::infinity ();
+  double maxY = -std::numeric_limits<double>::infinity ();
+  m_minX = std::numeric_limits<double>::infinity ();
+  m_minY = std::numeric_limits<double>::infinity ();
+  for (const auto &p : m_points)
+    {
+      m_minX = std::min (m_minX, p.x);
+      m_minY = std::min (m_minY, p.y);
+      maxX = std::max (maxX, p.x);
+      maxY = std::max (maxY, p.y);
+    }
+
+  // About one point per cell, and never more cells than 3 times the points
+  // (also when the points are aligned, or all in the same position)
+  double width = maxX - m_minX;
+  double height = maxY - m_minY;
+  double numPoints = static_cast<double> (m_points.size ());
+  m_cellSize = std::max (std::sqrt (width * height / numPoints),
+                         std::max (width, height) / numPoints);
+  if (m_cellSize <= 0.0)
+    {
+      m_cellSize = 1.0;
+    }
+  m_numCellsX = static_cast<int32_t> (std::floor (width / m_cellSize)) + 1;
+  m_numCellsY = static_cast<int32_t> (std::floor (height / m_cellSize)) + 1;
+
+  // Counting sort of the points by cell; points of the same cell remain
+  // sorted by index
+  std::vector<uint32_t> pointCell (m_points.size ());
+  m_cellStart.assign (static_cast<size_t> (m_numCellsX) * m_numCellsY + 1, 0);
+  for (uint32_t i = 0; i < m_points.size (); ++i)
+    {
+      int32_t cx = GetCell (m_points[i].x, m_minX, m_numCellsX);
+      int32_t cy = GetCell (m_points[i].y, m_minY, m_numCellsY);
+      pointCell[i] = static_cast<uint32_t> (cy * m_numCellsX + cx);
+      ++m_cellStart[pointCell[i] + 1];
+    }
+  for (size_t c = 1; c < m_cellStart.size (); ++c)
+    {
+      m_cellStart[c] += m_cellStart[c - 1];
+    }
+  std::vector<uint32_t> fill (m_cellStart.begin (), m_cellStart.end () - 1);
+  m_cellPoints.resize (m_points.size ());
+  for (uint32_t i = 0; i < m_points.size (); ++i)
+    {
+      m_cellPoints[fill[pointCell[i]]++] = i;
+    }
+
+  NS_LOG_INFO ("Indexed " << m_points.size () << " points in " << m_numCellsX <<
+               "x" << m_numCellsY << " cells of " << m_cellSize << " m");
+}
+
+int32_t
+NrSpatialIndex::GetCell (double value, double min, int32_t numCells) const
+{
+  double cell = std::floor ((value - min) / m_cellSize);
+  if (cell < 0.0)
+    {
+      return 0;
+    }
+  if (cell >= numCells)
+    {
+      return numCells - 1;
+    }
+  return static_cast<int32_t> (cell);
+}
+
+uint32_t
+NrSpatialIndex::FindClosest (const Vector &position) const
+{
+  int32_t cx = GetCell (position.x, m_minX, m_numCellsX);
+  int32_t cy = GetCell (position.y, m_minY, m_numCellsY);
+
+  uint32_t best = std::numeric_limits<uint32_t>::max ();
+  double bestDist2 = std::numeric_limits<double>::infinity ();
+
+  auto visitCell = [&] (int32_t x, int32_t y)
+    {
+      uint32_t cell = static_cast<uint32_t> (y * m_numCellsX + x);
+      for (uint32_t k = m_cellStart[cell]; k < m_cellStart[cell + 1]; ++k)
+        {
+          uint32_t i = m_cellPoints[k];
+          double dx = m_points[i].x - position.x;
+          double dy = m_points[i].y - position.y;
+          double dz = m_points[i].z - position.z;
+          double dist2 = dx * dx + dy * dy + dz * dz;
+          if (dist2 < bestDist2 || (dist2 == bestDist2 && i < best))
+            {
+              bestDist2 = dist2;
+              best = i;
+            }
+        }
+    };
+
+  for (int32_t r = 0; ; ++r)
+    {
+      // Visit the ring of cells at (Chebyshev) distance r
+      for (int32_t y = std::max (cy - r, 0); y <= std::min (cy + r, m_numCellsY - 1); ++y)
+        {
+          if (y == cy - r || y == cy + r)
+            {
+              for (int32_t x = std::max (cx - r, 0); x <= std::min (cx + r, m_numCellsX - 1); ++x)
+                {
+                  visitCell (x, y);
+                }
+            }
+          else
+            {
+              if (cx - r >= 0)
+                {
+                  visitCell (cx - r, y);
+                }
+              if (r > 0 && cx + r < m_numCellsX)
+                {
+                  visitCell (cx + r, y);
+                }
+            }
+        }
+
+      // Lower bound of the distance of the points in the cells not yet visited:
+      // they are beyond one of the sides of the visited square that are not
+      // on the border of the grid
+      double bound = std::numeric_limits<double>::infinity ();
+      if (cx - r > 0)
+        {
+          bound = std::min (bound, std::max (position.x - (m_minX + (cx - r) * m_cellSize), 0.0));
+        }
+      if (cx + r < m_numCellsX - 1)
+        {
+          bound = std::min (bound, std::max (m_minX + (cx + r + 1) * m_cellSize - position.x, 0.0));
+        }
+      if (cy - r > 0)
+        {
+          bound = std::min (bound, std::max (position.y - (m_minY + (cy - r) * m_cellSize), 0.0));
+        }
+      if (cy + r < m_numCellsY - 1)
+        {
+          bound = std::min (bound, std::max (m_minY + (cy + r + 1) * m_cellSize - position.y, 0.0));
+        }
+
+      if (bound == std::numeric_limits<double>::infinity () || bestDist2 < bound * bound)
+        {
+          break;
+        }
+    }
+
+  NS_ASSERT (best < m_points.size ());
+  return best;
+}
+
+std::vector<uint32_t>
+NrSpatialIndex::FindClosest (const std::vector<Vector> &positions, uint32_t numThreads) const
+{
+  NS_LOG_FUNCTION (this << positions.size () << numThreads);
+
+  std::vector<uint32_t> closest (positions.size ());
+
+  if (numThreads == 0)
+    {
+      numThreads = std::max (std::thread::hardware_concurrency (), 1U);
+    }
+  size_t maxThreads = std::max<size_t> (positions.size () / MIN_QUERIES_PER_THREAD, 1);
+  numThreads = static_cast<uint32_t> (std::min<size_t> (numThreads, maxThreads));
+
+  auto findRange = [this, &positions, &closest] (size_t begin, size_t end)
+    {
+      for (size_t i = begin; i < end; ++i)
+        {
+          closest[i] = FindClosest (positions[i]);
+        }
+    };
+
+  if (numThreads == 1)
+    {
+      findRange (0, positions.size ());
+      return closest;
+    }
+
+  size_t chunk = (positions.size () + numThreads - 1) / numThreads;
+  std::vector<std::thread> threads;
+  threads.reserve (numThreads);
+  for (size_t begin = 0; begin < positions.size (); begin += chunk)
+    {
+      threads.emplace_back (findRange, begin, std::min (begin + chunk, positions.size ()));
+    }
+  for (auto &t : threads)
+    {
+      t.join ();
+    }
+
+  return closest;
+}
+
+} // namespace ns3
@@ -0,0 +1,93 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SPATIAL_INDEX_H
+#define NR_SPATIAL_INDEX_H
+
+#include <ns3/vector.h>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup helper
+ * \brief Uniform grid index to find the closest point of a fixed set
+ *
+ * The points (e.g., the gNB positions) are bucketed on the x-y plane in
+ * square cells, sized to hold about one point each. The closest point to a
+ * query position (by 3D distance) is found by visiting the cells in rings of
+ * increasing size around the cell of the query, and stopping as soon as no
+ * unvisited cell can contain a closer point. With evenly spread points, a
+ * query costs O(1) instead of the O(N) of a linear scan.
+ *
+ * Ties are broken in favour of the point with the lowest index, as a linear
+ * scan with a strict comparison would do.
+ *
+ * The index is immutable after construction, so FindClosest () can be
+ * called from several threads at the same time.
+ */
+class NrSpatialIndex
+{
+public:
+  /**
+   * \brief Build the index
+   * \param points the points to index; they must not be empty
+   */
+  NrSpatialIndex (const std::vector<Vector> &points);
+
+  /**
+   * \brief Find the point closest to a position
+   * \param position the query position
+   * \return the index (in the vector passed to the constructor) of the closest point
+   */
+  uint32_t FindClosest (const Vector &position) const;
+
+  /**
+   * \brief Find the closest point for many positions
+   * \param positions the query positions
+   * \param numThreads number of threads to use (0: as many as the hardware supports)
+   * \return for each position, the index of the closest point
+   *
+   * The queries are split in contiguous chunks, one per thread; the
+   * result does not depend on the number of threads.
+   */
+  std::vector<uint32_t> FindClosest (const std::vector<Vector> &positions, uint32_t numThreads = 0) const;
+
+private:
+  /**
+   * \brief Get the cell coordinate of a value along one axis
+   * \param value the coordinate of the position
+   * \param min the minimum coordinate of the grid
+   * \param numCells the number of cells along the axis
+   * \return the cell coordinate, clamped to the grid
+   */
+  int32_t GetCell (double value, double min, int32_t numCells) const;
+
+  std::vector<Vector> m_points;        //!< Indexed points
+  std::vector<uint32_t> m_cellStart;   //!< Start of each cell in m_cellPoints (size: cells + 1)
+  std::vector<uint32_t> m_cellPoints;  //!< Point indexes, sorted by cell and index
+  double m_minX {0.0};                 //!< Minimum x of the grid
+  double m_minY {0.0};                 //!< Minimum y of the grid
+  double m_cellSize {1.0};             //!< Side of the cells
+  int32_t m_numCellsX {1};             //!< Number of cells along x
+  int32_t m_numCellsY {1};             //!< Number of cells along y
+};
+
+} // namespace ns3
+
+#endif // NR_SPATIAL_INDEX_H
@@ -22,6 +22,7 @@
 #include <ns3/log.h>
 #include <ns3/simulator.h>
 #include <ns3/node.h>
+#include <ns3/node-list.h>
 #include <ns3/boolean.h>
 #include "nr-gnb-net-device.h"
 #include "nr-ue-net-device.h"
@@ -244,4 +245,65 @@ BeamManager::SetSectorAz (double azimuth, double zenith) const
   m_antennaArray->SetBeamformingVector(CreateDirectionalBfvAz (m_antennaArray, azimuth, zenith));
 }
 
+void
+BeamManager::SaveState (NrCheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this);
+
+  // The map is ordered by pointer: order by node and device to be deterministic
+  std::map<std::pair<uint32_t, uint32_t>, const BeamformingVector *> beams;
+  for (const auto & it : m_beamformingVectorMap)
+    {
+      beams.emplace (std::make_pair (it.first->GetNode ()->GetId (), it.first->GetIfIndex ()),
+                     &it.second);
+    }
+
+  writer.WriteU32 (static_cast<uint32_t> (beams.size ()));
+  for (const auto & it : beams)
+    {
+      writer.WriteU32 (it.first.first);
+      writer.WriteU32 (it.first.second);
+      writer.WriteU16 (it.second->second.GetSector ());
+      writer.WriteDouble (it.second->second.GetElevation ());
+      writer.WriteU32 (static_cast<uint32_t> (it.second->first.size ()));
+      for (const auto & w : it.second->first)
+        {
+          writer.WriteDouble (w.real ());
+          writer.WriteDouble (w.imag ());
+        }
+    }
+}
+
+void
+BeamManager::RestoreState (NrCheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t numBeams = reader.ReadU32 ();
+  for (uint32_t i = 0; i < numBeams; ++i)
+    {
+      uint32_t nodeId = reader.ReadU32 ();
+      uint32_t ifIndex = reader.ReadU32 ();
+      uint16_t sector = reader.ReadU16 ();
+      double elevation = reader.ReadDouble ();
+      complexVector_t weights (reader.ReadU32 ());
+      for (auto & w : weights)
+        {
+          double re = reader.ReadDouble ();
+          w = std::complex<double> (re, reader.ReadDouble ());
+        }
+
+      if (nodeId >= NodeList::GetNNodes ()
+          || ifIndex >= NodeList::GetNode (nodeId)->GetNDevices ()
+          || weights.size () != m_antennaArray->GetNumberOfElements ())
+        {
+          NS_LOG_WARN ("Skipping the beam towards device " << ifIndex << " of node " << nodeId);
+          continue;
+        }
+
+      SaveBeamformingVector (BeamformingVector (weights, BeamId (sector, elevation)),
+                             NodeList::GetNode (nodeId)->GetDevice (ifIndex));
+    }
+}
+
 } /* namespace ns3 */
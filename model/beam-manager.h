@@ -24,6 +24,7 @@
 #include <ns3/nstime.h>
 #include <ns3/net-device.h>
 #include "beamforming-vector.h"
+#include "nr-checkpoint.h"
 
 
 namespace ns3 {
@@ -161,6 +162,23 @@ public:
    */
   void SetSectorAz (double azimuth, double zenith) const;
 
+  /**
+   * \brief Save the beamforming vectors towards the other devices
+   * \param writer the checkpoint writer
+   *
+   * The devices are identified by node id and device index, in this order.
+   */
+  void SaveState (NrCheckpointWriter &writer) const;
+
+  /**
+   * \brief Restore the beamforming vectors saved by SaveState
+   * \param reader the checkpoint reader
+   *
+   * Vectors towards devices that do not exist, or whose size does not match
+   * the antenna, are skipped.
+   */
+  void RestoreState (NrCheckpointReader &reader);
+
 private:
 
   Ptr<UniformPlanarArray> m_antennaArray;  //!< the antenna array instance for which is responsible this BeamManager
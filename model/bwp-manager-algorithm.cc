@@ -18,6 +18,9 @@
  */
 #include "bwp-manager-algorithm.h"
 #include <ns3/log.h>
+#include <ns3/double.h>
+#include <ns3/simulator.h>
+#include <algorithm>
 
 namespace ns3 {
 
@@ -34,6 +37,48 @@ BwpManagerAlgorithm::GetTypeId ()
   return tid;
 }
 
+uint8_t
+BwpManagerAlgorithm::GetBwpForFlow ([[maybe_unused]] uint16_t rnti, [[maybe_unused]] uint8_t lcid,
+                                    const EpsBearer::Qci &v)
+{
+  return GetBwpForEpsBearer (v);
+}
+
+uint8_t
+BwpManagerAlgorithm::PeekBwpForFlow ([[maybe_unused]] uint16_t rnti, [[maybe_unused]] uint8_t lcid,
+                                     const EpsBearer::Qci &v) const
+{
+  return GetBwpForEpsBearer (v);
+}
+
+void
+BwpManagerAlgorithm::NotifyBufferStatus ([[maybe_unused]] uint8_t bwpId, [[maybe_unused]] uint16_t rnti,
+                                         [[maybe_unused]] uint8_t lcid, [[maybe_unused]] uint32_t bytes)
+{
+}
+
+void
+BwpManagerAlgorithm::NotifySlotUsage ([[maybe_unused]] uint8_t bwpId, [[maybe_unused]] uint32_t usedReg,
+                                      [[maybe_unused]] uint32_t availableReg)
+{
+}
+
+bool
+BwpManagerAlgorithm::NeedsSlotUsage () const
+{
+  return false;
+}
+
+void
+BwpManagerAlgorithm::NotifyFlowReleased ([[maybe_unused]] uint16_t rnti, [[maybe_unused]] uint8_t lcid)
+{
+}
+
+void
+BwpManagerAlgorithm::NotifyUeReleased ([[maybe_unused]] uint16_t rnti)
+{
+}
+
 NS_OBJECT_ENSURE_REGISTERED (BwpManagerAlgorithmStatic);
 
 #define DECLARE_ATTR(NAME,DESC,GETTER,SETTER)                              \
@@ -146,4 +191,221 @@ BwpManagerAlgorithmStatic::GetBwpForEpsBearer (const EpsBearer::Qci &v) const
   return m_qciToBwpMap.at (v);
 }
 
+NS_OBJECT_ENSURE_REGISTERED (BwpManagerAlgorithmDynamic);
+
+TypeId
+BwpManagerAlgorithmDynamic::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::BwpManagerAlgorithmDynamic")
+    .SetParent<BwpManagerAlgorithmStatic> ()
+    .SetGroupName ("nr")
+    .AddConstructor<BwpManagerAlgorithmDynamic> ()
+    .AddAttribute ("Hysteresis",
+                   "Difference between the load of the BWP of a flow and the load "
+                   "of the least loaded BWP needed to move the flow",
+                   DoubleValue (0.2),
+                   MakeDoubleAccessor (&BwpManagerAlgorithmDynamic::m_hysteresis),
+                   MakeDoubleChecker<double> (0.0, 2.0))
+    .AddAttribute ("MinDwellTime",
+                   "Minimum time a flow stays in a BWP before moving again",
+                   TimeValue (MilliSeconds (100)),
+                   MakeTimeAccessor (&BwpManagerAlgorithmDynamic::m_minDwellTime),
+                   MakeTimeChecker ())
+    .AddAttribute ("UtilizationAlpha",
+                   "Weight of the last slot in the average PRB utilization of a BWP",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&BwpManagerAlgorithmDynamic::m_alpha),
+                   MakeDoubleChecker<double> (0.0, 1.0))
+  ;
+  return tid;
+}
+
+void
+BwpManagerAlgorithmDynamic::SetAllowedBwps (EpsBearer::Qci qci, const std::set<uint8_t> &bwps)
+{
+  NS_LOG_FUNCTION (this << qci);
+  if (bwps.empty ())
+    {
+      m_allowedBwps.erase (qci);
+    }
+  else
+    {
+      m_allowedBwps[qci] = bwps;
+    }
+}
+
+std::set<uint8_t>
+BwpManagerAlgorithmDynamic::GetAllowedBwps (const EpsBearer::Qci &v) const
+{
+  auto it = m_allowedBwps.find (v);
+  if (it != m_allowedBwps.end ())
+    {
+      return it->second;
+    }
+
+  std::set<uint8_t> allowed;
+  if (EpsBearer (v).IsGbr ())
+    {
+      allowed.insert (GetBwpForEpsBearer (v));
+      return allowed;
+    }
+
+  for (const auto &bwp : m_bwpLoad)
+    {
+      allowed.insert (bwp.first);
+    }
+  allowed.insert (GetBwpForEpsBearer (v));
+  return allowed;
+}
+
+double
+BwpManagerAlgorithmDynamic::GetBwpUtilization (uint8_t bwpId) const
+{
+  auto it = m_bwpLoad.find (bwpId);
+  return it == m_bwpLoad.end () ? 0.0 : it->second.m_utilization;
+}
+
+double
+BwpManagerAlgorithmDynamic::GetBwpLoad (uint8_t bwpId) const
+{
+  auto it = m_bwpLoad.find (bwpId);
+  if (it == m_bwpLoad.end ())
+    {
+      return 0.0;
+    }
+  double backlog = m_totalBytes > 0 ? static_cast<double> (it->second.m_bytes) / m_totalBytes : 0.0;
+  return it->second.m_utilization + backlog;
+}
+
+uint8_t
+BwpManagerAlgorithmDynamic::PeekBwpForFlow (uint16_t rnti, uint8_t lcid, const EpsBearer::Qci &v) const
+{
+  auto it = m_flows.find (GetFlowKey (rnti, lcid));
+  return it == m_flows.end () ? GetBwpForEpsBearer (v) : it->second.m_bwpId;
+}
+
+uint8_t
+BwpManagerAlgorithmDynamic::GetBwpForFlow (uint16_t rnti, uint8_t lcid, const EpsBearer::Qci &v)
+{
+  NS_LOG_FUNCTION (this << rnti << +lcid << v);
+
+  auto it = m_flows.find (GetFlowKey (rnti, lcid));
+  if (it == m_flows.end ())
+    {
+      FlowInfo flow;
+      flow.m_bwpId = GetBwpForEpsBearer (v);
+      flow.m_lastMove = Simulator::Now () - m_minDwellTime;
+      it = m_flows.emplace (GetFlowKey (rnti, lcid), flow).first;
+    }
+  FlowInfo &flow = it->second;
+
+  std::set<uint8_t> allowed = GetAllowedBwps (v);
+  bool mustMove = allowed.find (flow.m_bwpId) == allowed.end ();
+  if (!mustMove && Simulator::Now () - flow.m_lastMove < m_minDwellTime)
+    {
+      return flow.m_bwpId;
+    }
+
+  uint8_t best = *allowed.begin ();
+  for (const auto &bwp : allowed)
+    {
+      if (GetBwpLoad (bwp) < GetBwpLoad (best))
+        {
+          best = bwp;
+        }
+    }
+
+  double currentLoad = GetBwpLoad (flow.m_bwpId);
+  if (mustMove || (best != flow.m_bwpId && currentLoad - GetBwpLoad (best) > m_hysteresis))
+    {
+      NS_LOG_INFO ("Moving flow of RNTI " << rnti << " LCID " << +lcid << " from BWP " <<
+                   +flow.m_bwpId << " (load " << currentLoad << ") to BWP " << +best <<
+                   " (load " << GetBwpLoad (best) << ")");
+      m_bwpLoad[flow.m_bwpId].m_bytes -= flow.m_bytes;
+      m_bwpLoad[best].m_bytes += flow.m_bytes;
+      flow.m_bwpId = best;
+      flow.m_lastMove = Simulator::Now ();
+    }
+
+  return flow.m_bwpId;
+}
+
+void
+BwpManagerAlgorithmDynamic::NotifyBufferStatus (uint8_t bwpId, uint16_t rnti, uint8_t lcid, uint32_t bytes)
+{
+  NS_LOG_FUNCTION (this << +bwpId << rnti << +lcid << bytes);
+
+  FlowInfo &flow = m_flows[GetFlowKey (rnti, lcid)];
+  NS_ASSERT_MSG (flow.m_bytes == 0 || flow.m_bwpId == bwpId,
+                 "Buffer status routed to a BWP different from the one of the flow");
+  flow.m_bwpId = bwpId;
+
+  BwpLoad &load = m_bwpLoad[bwpId];
+  load.m_bytes = load.m_bytes - flow.m_bytes + bytes;
+  m_totalBytes = m_totalBytes - flow.m_bytes + bytes;
+  flow.m_bytes = bytes;
+}
+
+void
+BwpManagerAlgorithmDynamic::NotifySlotUsage (uint8_t bwpId, uint32_t usedReg, uint32_t availableReg)
+{
+  if (availableReg == 0)
+    {
+      return;
+    }
+  BwpLoad &load = m_bwpLoad[bwpId];
+  double utilization = std::min (1.0, static_cast<double> (usedReg) / availableReg);
+  load.m_utilization = (1.0 - m_alpha) * load.m_utilization + m_alpha * utilization;
+}
+
+bool
+BwpManagerAlgorithmDynamic::NeedsSlotUsage () const
+{
+  return true;
+}
+
+std::unordered_map<uint32_t, BwpManagerAlgorithmDynamic::FlowInfo>::iterator
+BwpManagerAlgorithmDynamic::EraseFlow (std::unordered_map<uint32_t, FlowInfo>::iterator it)
+{
+  BwpLoad &load = m_bwpLoad[it->second.m_bwpId];
+  NS_ASSERT (load.m_bytes >= it->second.m_bytes && m_totalBytes >= it->second.m_bytes);
+  load.m_bytes -= it->second.m_bytes;
+  m_totalBytes -= it->second.m_bytes;
+  return m_flows.erase (it);
+}
+
+void
+BwpManagerAlgorithmDynamic::NotifyFlowReleased (uint16_t rnti, uint8_t lcid)
+{
+  NS_LOG_FUNCTION (this << rnti << +lcid);
+  auto it = m_flows.find (GetFlowKey (rnti, lcid));
+  if (it != m_flows.end ())
+    {
+      EraseFlow (it);
+    }
+}
+
+void
+BwpManagerAlgorithmDynamic::NotifyUeReleased (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  for (auto it = m_flows.begin (); it != m_flows.end (); )
+    {
+      if ((it->first >> 8) == rnti)
+        {
+          it = EraseFlow (it);
+        }
+      else
+        {
+          ++it;
+        }
+    }
+}
+
+size_t
+BwpManagerAlgorithmDynamic::GetNumFlows () const
+{
+  return m_flows.size ();
+}
+
 } // namespace ns3
@@ -21,6 +21,10 @@
 
 #include <ns3/object.h>
 #include <ns3/eps-bearer.h>
+#include <ns3/nstime.h>
+#include <map>
+#include <set>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -29,8 +33,20 @@ namespace ns3 {
  * \brief Interface for a Bwp selection algorithm based on the bearer
  *
  *
- * At the moment, we provide only a static algorithm that has to be configured
- * before the simulation starts (BwpManagerAlgorithmStatic).
+ * We provide a static algorithm that has to be configured before the
+ * simulation starts (BwpManagerAlgorithmStatic), and a dynamic one that
+ * moves the flows towards the least loaded BWP (BwpManagerAlgorithmDynamic).
+ *
+ * The gNB BWP manager asks the BWP of a flow through GetBwpForFlow(), and
+ * reports to the algorithm the buffer status of each flow
+ * (NotifyBufferStatus()) and the resources used in each slot of each BWP
+ * (NotifySlotUsage(), only if NeedsSlotUsage() is true). By default, these
+ * methods fall back to
+ * GetBwpForEpsBearer() and ignore the load, so that an algorithm that only
+ * maps QCIs has to implement GetBwpForEpsBearer() only.
+ * The manager also notifies the release of the bearers and of the UEs
+ * (NotifyFlowReleased(), NotifyUeReleased()), so that the algorithm can
+ * forget the state of their flows.
  *
  *
  * \section bwp_manager_conf Configuration
@@ -69,6 +85,66 @@ public:
    * \return the bwp id that the algorithm selects for the qci specified
    */
   virtual uint8_t GetBwpForEpsBearer (const EpsBearer::Qci &v) const = 0;
+
+  /**
+   * \brief Get the bandwidth part id for a flow
+   *
+   * The algorithm can change the BWP of the flow in the call.
+   *
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the flow
+   * \param v the qci of the flow
+   * \return the bwp id that the algorithm selects for the flow
+   */
+  virtual uint8_t GetBwpForFlow (uint16_t rnti, uint8_t lcid, const EpsBearer::Qci &v);
+
+  /**
+   * \brief Get the bandwidth part id of a flow, without changing it
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the flow
+   * \param v the qci of the flow
+   * \return the bwp id of the flow
+   */
+  virtual uint8_t PeekBwpForFlow (uint16_t rnti, uint8_t lcid, const EpsBearer::Qci &v) const;
+
+  /**
+   * \brief Notify the buffer status of a flow, as routed to a BWP
+   * \param bwpId the BWP to which the buffer status has been routed
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the flow
+   * \param bytes the bytes queued in the RLC of the flow
+   */
+  virtual void NotifyBufferStatus (uint8_t bwpId, uint16_t rnti, uint8_t lcid, uint32_t bytes);
+
+  /**
+   * \brief Notify the resources used in a slot of a BWP
+   * \param bwpId the BWP
+   * \param usedReg the resources (RB x symbols) used for data
+   * \param availableReg the resources (RB x symbols) available for data
+   */
+  virtual void NotifySlotUsage (uint8_t bwpId, uint32_t usedReg, uint32_t availableReg);
+
+  /**
+   * \brief Check if the algorithm uses the resources of the slots
+   * \return true if NotifySlotUsage() should be called in each slot
+   *
+   * The helper connects the per-slot statistics of the gNB PHYs only for
+   * the algorithms that use them. By default, false.
+   */
+  virtual bool NeedsSlotUsage () const;
+
+  /**
+   * \brief Notify that a flow has been released, to forget its state
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the flow
+   */
+  virtual void NotifyFlowReleased (uint16_t rnti, uint8_t lcid);
+
+  /**
+   * \brief Notify that a UE has been removed, to forget the state of its flows
+   * \param rnti the RNTI of the UE
+   */
+  virtual void NotifyUeReleased (uint16_t rnti);
 };
 
 /**
@@ -442,5 +518,143 @@ private:
   std::unordered_map <uint8_t, uint8_t> m_qciToBwpMap;
 };
 
+/**
+ * \ingroup bwp
+ * \brief A BWP manager algorithm that balances the flows among the BWPs
+ *        by their load
+ *
+ * The QCI attributes inherited from BwpManagerAlgorithmStatic give the
+ * home BWP of each QCI, where a new flow starts. The load of a BWP is
+ *
+ *   load = U + B / Btot
+ *
+ * where U is the PRB utilization of the BWP (the exponential average, with
+ * weight UtilizationAlpha, of the ratio of the data resources used in each
+ * slot), B the bytes queued by the flows routed to the BWP, and Btot the
+ * bytes queued by all the flows. The second term tells apart the BWPs that
+ * are all saturated, and it reacts immediately to a move.
+ *
+ * At each buffer status report of a flow, the flow moves to the least loaded
+ * BWP allowed for its QCI if the load of its current BWP is higher by more
+ * than Hysteresis, and the flow has not moved in the last MinDwellTime. The
+ * queued bytes of the flow move with it, so that the next flows see the
+ * updated load and do not all move together.
+ *
+ * The BWPs allowed for a QCI are the ones set through SetAllowedBwps(); by
+ * default, a GBR flow stays in its home BWP (its numerology and latency
+ * budget were chosen for it), while a non-GBR flow can go in any BWP
+ * that reported its usage.
+ *
+ * Only the gNB knows the load, hence the algorithm is meant for the gNB BWP
+ * manager (downlink); installed in the UE, it behaves as the static one.
+ */
+class BwpManagerAlgorithmDynamic : public BwpManagerAlgorithmStatic
+{
+public:
+  /**
+   * \brief GetTypeId
+   * \return The TypeId of the object
+   */
+  static TypeId GetTypeId ();
+
+  /**
+   * \brief constructor
+   */
+  BwpManagerAlgorithmDynamic () = default;
+  /**
+    * \brief deconstructor
+    */
+  virtual ~BwpManagerAlgorithmDynamic () override = default;
+
+  // inherited
+  virtual uint8_t GetBwpForFlow (uint16_t rnti, uint8_t lcid, const EpsBearer::Qci &v) override;
+  virtual uint8_t PeekBwpForFlow (uint16_t rnti, uint8_t lcid, const EpsBearer::Qci &v) const override;
+  virtual void NotifyBufferStatus (uint8_t bwpId, uint16_t rnti, uint8_t lcid, uint32_t bytes) override;
+  virtual void NotifySlotUsage (uint8_t bwpId, uint32_t usedReg, uint32_t availableReg) override;
+  virtual bool NeedsSlotUsage () const override;
+  virtual void NotifyFlowReleased (uint16_t rnti, uint8_t lcid) override;
+  virtual void NotifyUeReleased (uint16_t rnti) override;
+
+  /**
+   * \brief Get the number of flows of which the algorithm keeps the state
+   * \return the number of flows
+   */
+  size_t GetNumFlows () const;
+
+  /**
+   * \brief Restrict the BWPs that the flows of a QCI can use
+   * \param qci the QCI
+   * \param bwps the allowed BWPs; an empty set removes the restriction
+   */
+  void SetAllowedBwps (EpsBearer::Qci qci, const std::set<uint8_t> &bwps);
+
+  /**
+   * \brief Get the load of a BWP
+   * \param bwpId the BWP
+   * \return the load, in [0, 2]
+   */
+  double GetBwpLoad (uint8_t bwpId) const;
+
+  /**
+   * \brief Get the PRB utilization of a BWP
+   * \param bwpId the BWP
+   * \return the average PRB utilization, in [0, 1]
+   */
+  double GetBwpUtilization (uint8_t bwpId) const;
+
+private:
+  /**
+   * \brief The state of a flow
+   */
+  struct FlowInfo
+  {
+    uint8_t m_bwpId {0};        //!< The BWP of the flow
+    uint32_t m_bytes {0};       //!< The bytes queued by the flow
+    Time m_lastMove {Seconds (0)}; //!< The last time the flow moved
+  };
+
+  /**
+   * \brief The load state of a BWP
+   */
+  struct BwpLoad
+  {
+    double m_utilization {0.0}; //!< Average PRB utilization
+    uint64_t m_bytes {0};       //!< Bytes queued by the flows of the BWP
+  };
+
+  /**
+   * \brief Get the BWPs allowed for a QCI
+   * \param v the QCI
+   * \return the allowed BWPs
+   */
+  std::set<uint8_t> GetAllowedBwps (const EpsBearer::Qci &v) const;
+
+  /**
+   * \brief Remove the bytes of a flow from the load, and forget the flow
+   * \param it the flow
+   * \return the iterator to the next flow
+   */
+  std::unordered_map<uint32_t, FlowInfo>::iterator EraseFlow (std::unordered_map<uint32_t, FlowInfo>::iterator it);
+
+  /**
+   * \brief Get the key of a flow in the map
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the flow
+   * \return the key
+   */
+  static uint32_t GetFlowKey (uint16_t rnti, uint8_t lcid)
+  {
+    return (static_cast<uint32_t> (rnti) << 8) | lcid;
+  }
+
+  double m_hysteresis {0.2};            //!< Load difference needed to move a flow
+  Time m_minDwellTime {MilliSeconds (100)}; //!< Minimum time between two moves of a flow
+  double m_alpha {0.1};                 //!< Weight of the last slot in the utilization average
+  uint64_t m_totalBytes {0};            //!< Bytes queued by all the flows
+  std::map<uint8_t, BwpLoad> m_bwpLoad; //!< Load of each BWP
+  std::unordered_map<uint32_t, FlowInfo> m_flows; //!< State of each flow
+  std::unordered_map<uint8_t, std::set<uint8_t>> m_allowedBwps; //!< Allowed BWPs of the QCIs
+};
+
 } // namespace ns3
 #endif // BWPMANAGERALGORITHM_H
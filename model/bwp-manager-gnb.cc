@@ -64,6 +64,13 @@ BwpManagerGnb::SetBwpManagerAlgorithm (const Ptr<BwpManagerAlgorithm> &algorithm
   m_algorithm = algorithm;
 }
 
+bool
+BwpManagerGnb::NeedsSlotUsage () const
+{
+  NS_ASSERT (m_algorithm != nullptr);
+  return m_algorithm->NeedsSlotUsage ();
+}
+
 bool
 BwpManagerGnb::IsGbr (LteMacSapProvider::ReportBufferStatusParameters params)
 {
@@ -81,6 +88,27 @@ BwpManagerGnb::DoSetupDataRadioBearer (EpsBearer bearer, uint8_t bearerId, uint1
   return lcsConfig;
 }
 
+std::vector<uint8_t>
+BwpManagerGnb::DoReleaseDataRadioBearer (uint16_t rnti, uint8_t lcid)
+{
+  NS_LOG_FUNCTION (this << rnti << +lcid);
+  NS_ASSERT (m_algorithm != nullptr);
+  m_flowBwp.erase (std::make_pair (rnti, lcid));
+  m_algorithm->NotifyFlowReleased (rnti, lcid);
+  return RrComponentCarrierManager::DoReleaseDataRadioBearer (rnti, lcid);
+}
+
+void
+BwpManagerGnb::DoRemoveUe (uint16_t rnti)
+{
+  NS_LOG_FUNCTION (this << rnti);
+  NS_ASSERT (m_algorithm != nullptr);
+  m_flowBwp.erase (m_flowBwp.lower_bound (std::make_pair (rnti, static_cast<uint8_t> (0))),
+                   m_flowBwp.upper_bound (std::make_pair (rnti, static_cast<uint8_t> (UINT8_MAX))));
+  m_algorithm->NotifyUeReleased (rnti);
+  RrComponentCarrierManager::DoRemoveUe (rnti);
+}
+
 uint8_t
 BwpManagerGnb::GetBwpIndex (uint16_t rnti, uint8_t lcid)
 {
@@ -93,7 +121,7 @@ BwpManagerGnb::GetBwpIndex (uint16_t rnti, uint8_t lcid)
 
   // Force a conversion between the uint8_t type that comes from the LcInfo
   // struct (yeah, using the EpsBearer::Qci type was too hard ...)
-  return m_algorithm->GetBwpForEpsBearer (static_cast<EpsBearer::Qci> (qci));
+  return m_algorithm->GetBwpForFlow (rnti, lcid, static_cast<EpsBearer::Qci> (qci));
 }
 
 uint8_t
@@ -109,7 +137,7 @@ BwpManagerGnb::PeekBwpIndex (uint16_t rnti, uint8_t lcid) const
 
   // Force a conversion between the uint8_t type that comes from the LcInfo
   // struct (yeah, using the EpsBearer::Qci type was too hard ...)
-  return m_algorithm->GetBwpForEpsBearer (static_cast<EpsBearer::Qci> (qci));
+  return m_algorithm->PeekBwpForFlow (rnti, lcid, static_cast<EpsBearer::Qci> (qci));
 }
 
 uint8_t
@@ -165,6 +193,28 @@ BwpManagerGnb::DoReportBufferStatus (LteMacSapProvider::ReportBufferStatusParame
 
   uint8_t bwpIndex = GetBwpIndex (params.rnti, params.lcid);
 
+  auto flowIt = m_flowBwp.find (std::make_pair (params.rnti, params.lcid));
+  if (flowIt != m_flowBwp.end () && flowIt->second != bwpIndex)
+    {
+      // The flow moved: the scheduler of the old BWP should not serve it
+      // anymore, so tell it that the buffer is empty
+      NS_LOG_INFO ("Flow of RNTI " << params.rnti << " LCID " << +params.lcid <<
+                   " moved from BWP " << +flowIt->second << " to BWP " << +bwpIndex);
+      LteMacSapProvider::ReportBufferStatusParameters emptyParams = params;
+      emptyParams.txQueueSize = 0;
+      emptyParams.txQueueHolDelay = 0;
+      emptyParams.retxQueueSize = 0;
+      emptyParams.retxQueueHolDelay = 0;
+      emptyParams.statusPduSize = 0;
+      auto oldIt = m_macSapProvidersMap.find (flowIt->second);
+      NS_ABORT_MSG_IF (oldIt == m_macSapProvidersMap.end (), "Bwp index " << +flowIt->second << " not valid.");
+      oldIt->second->ReportBufferStatus (emptyParams);
+    }
+  m_flowBwp[std::make_pair (params.rnti, params.lcid)] = bwpIndex;
+
+  m_algorithm->NotifyBufferStatus (bwpIndex, params.rnti, params.lcid,
+                                   params.txQueueSize + params.retxQueueSize + params.statusPduSize);
+
   if (m_macSapProvidersMap.find (bwpIndex) != m_macSapProvidersMap.end ())
     {
       m_macSapProvidersMap.find (bwpIndex)->second->ReportBufferStatus (params);
@@ -175,6 +225,18 @@ BwpManagerGnb::DoReportBufferStatus (LteMacSapProvider::ReportBufferStatusParame
     }
 }
 
+void
+BwpManagerGnb::NotifySlotDataStats ([[maybe_unused]] const SfnSf &sfnSf,
+                                    [[maybe_unused]] uint32_t activeUe,
+                                    uint32_t usedReg, [[maybe_unused]] uint32_t usedSym,
+                                    uint32_t availableRb, uint32_t availableSym,
+                                    uint16_t bwpId, [[maybe_unused]] uint16_t cellId)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (m_algorithm != nullptr);
+  m_algorithm->NotifySlotUsage (static_cast<uint8_t> (bwpId), usedReg, availableRb * availableSym);
+}
+
 
 void
 BwpManagerGnb::DoNotifyTxOpportunity (LteMacSapUser::TxOpportunityParameters txOpParams)
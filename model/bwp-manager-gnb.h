@@ -26,12 +26,14 @@
 #include <ns3/lte-rlc.h>
 #include <ns3/eps-bearer.h>
 #include <unordered_map>
+#include <map>
 
 namespace ns3 {
 class UeManager;
 class LteCcmRrcSapProvider;
 class BwpManagerAlgorithm;
 class NrControlMessage;
+class SfnSf;
 
 /**
  * \ingroup gnb-bwp
@@ -50,6 +52,14 @@ public:
    */
   void SetBwpManagerAlgorithm (const Ptr<BwpManagerAlgorithm> &algorithm);
 
+  /**
+   * \brief Check if the algorithm uses the resources of the slots
+   * \return true if NotifySlotDataStats should be connected to the gNB PHYs
+   *
+   * \see BwpManagerAlgorithm::NeedsSlotUsage
+   */
+  bool NeedsSlotUsage () const;
+
   /**
    * \brief Get the bwp index for the RNTI and LCID
    * \param rnti The RNTI of the user
@@ -105,6 +115,26 @@ public:
    */
   void SetOutputLink (uint32_t sourceBwp, uint32_t outputBwp);
 
+  /**
+   * \brief Receive the data statistics of a slot of a BWP, and pass the
+   *        resource usage to the algorithm
+   *
+   * The signature is the one of the trace source SlotDataStats of NrGnbPhy,
+   * to which the helper connects this method.
+   *
+   * \param sfnSf the slot
+   * \param activeUe the number of active UEs
+   * \param usedReg the resources (RB x symbols) used for data
+   * \param usedSym the symbols used for data
+   * \param availableRb the RBs available
+   * \param availableSym the symbols available for data
+   * \param bwpId the BWP
+   * \param cellId the cell
+   */
+  void NotifySlotDataStats (const SfnSf &sfnSf, uint32_t activeUe, uint32_t usedReg,
+                            uint32_t usedSym, uint32_t availableRb, uint32_t availableSym,
+                            uint16_t bwpId, uint16_t cellId);
+
 protected:
   /*
    * \brief This function contains most of the BwpManager logic.
@@ -137,6 +167,20 @@ protected:
    */
   virtual std::vector<LteCcmRrcSapProvider::LcsConfig> DoSetupDataRadioBearer (EpsBearer bearer, uint8_t bearerId, uint16_t rnti, uint8_t lcid, uint8_t lcGroup, LteMacSapUser* msu) override;
 
+  /**
+   * \brief Forget the BWP of the released bearer, in this class and in the algorithm
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the bearer
+   * \return the LCIDs released in the BWPs
+   */
+  virtual std::vector<uint8_t> DoReleaseDataRadioBearer (uint16_t rnti, uint8_t lcid) override;
+
+  /**
+   * \brief Forget the BWP of the flows of the removed UE, in this class and in the algorithm
+   * \param rnti the RNTI of the UE
+   */
+  virtual void DoRemoveUe (uint16_t rnti) override;
+
 private:
   /**
    * \brief Checks if the flow is is GBR.
@@ -146,6 +190,7 @@ private:
   Ptr<BwpManagerAlgorithm> m_algorithm; //!< The BWP selection algorithm.
 
   std::unordered_map <uint32_t, uint32_t> m_outputLinks; //!< Mapping between BWP.
+  std::map <std::pair<uint16_t, uint8_t>, uint8_t> m_flowBwp; //!< BWP of the last buffer status of each (RNTI, LCID)
 };
 
 } // end of namespace ns3
@@ -28,6 +28,8 @@
 #include "beam-manager.h"
 #include <ns3/nr-spectrum-value-helper.h>
 #include <ns3/uniform-planar-array.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
+#include <cmath>
 #include "nr-ue-phy.h"
 #include "nr-gnb-phy.h"
 #include "nr-gnb-net-device.h"
@@ -528,17 +530,197 @@ OptimalCovMatrixBeamforming::GetTypeId (void)
   static TypeId tid = TypeId ("ns3::OptimalCovMatrixBeamforming")
                       .SetParent<IdealBeamformingAlgorithm> ()
                       .AddConstructor<OptimalCovMatrixBeamforming>()
+                      .AddAttribute ("MaxIterations",
+                                     "Maximum number of iterations of the power method",
+                                     UintegerValue (100),
+                                     MakeUintegerAccessor (&OptimalCovMatrixBeamforming::m_maxIterations),
+                                     MakeUintegerChecker<uint32_t> (1))
+                      .AddAttribute ("Tolerance",
+                                     "Relative change of the eigenvalue that stops the power method",
+                                     DoubleValue (1e-6),
+                                     MakeDoubleAccessor (&OptimalCovMatrixBeamforming::m_tolerance),
+                                     MakeDoubleChecker<double> (0.0))
   ;
 
   return tid;
 }
 
+/**
+ * \brief Get the norm of a complex vector
+ * \param v the vector
+ * \return the norm
+ */
+static double
+GetNorm (const complexVector_t &v)
+{
+  double norm2 = 0.0;
+  for (const auto &c : v)
+    {
+      norm2 += std::norm (c);
+    }
+  return std::sqrt (norm2);
+}
+
+complexVector_t
+OptimalCovMatrixBeamforming::GetPrincipalEigenvector (const ComplexMatrix &matrix,
+                                                      uint32_t maxIterations, double tolerance)
+{
+  size_t n = matrix.size ();
+  NS_ASSERT (n > 0);
+
+  // Start from the column with the highest power: it can be orthogonal to
+  // the principal eigenvector only if the matrix is degenerate
+  size_t start = 0;
+  for (size_t i = 1; i < n; ++i)
+    {
+      if (matrix[i][i].real () > matrix[start][start].real ())
+        {
+          start = i;
+        }
+    }
+  complexVector_t v (n);
+  for (size_t i = 0; i < n; ++i)
+    {
+      v[i] = matrix[i][start];
+    }
+
+  double norm = GetNorm (v);
+  if (norm == 0.0)
+    {
+      return complexVector_t (n, std::complex<double> (1.0 / std::sqrt (n), 0.0));
+    }
+  for (auto &c : v)
+    {
+      c /= norm;
+    }
+
+  double eigenvalue = 0.0;
+  complexVector_t w (n);
+  for (uint32_t iter = 0; iter < maxIterations; ++iter)
+    {
+      for (size_t i = 0; i < n; ++i)
+        {
+          std::complex<double> sum (0.0, 0.0);
+          for (size_t j = 0; j < n; ++j)
+            {
+              sum += matrix[i][j] * v[j];
+            }
+          w[i] = sum;
+        }
+      // v has unit norm, hence |R v| converges to the principal eigenvalue
+      double newEigenvalue = GetNorm (w);
+      if (newEigenvalue == 0.0)
+        {
+          break;
+        }
+      for (size_t i = 0; i < n; ++i)
+        {
+          v[i] = w[i] / newEigenvalue;
+        }
+      if (std::abs (newEigenvalue - eigenvalue) <= tolerance * newEigenvalue)
+        {
+          break;
+        }
+      eigenvalue = newEigenvalue;
+    }
+  return v;
+}
+
 BeamformingVectorPair
-OptimalCovMatrixBeamforming::GetBeamformingVectors ([[maybe_unused]] const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
-                                                    [[maybe_unused]] const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
+OptimalCovMatrixBeamforming::GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
+                                                    const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const
 {
   NS_LOG_FUNCTION (this);
-  return BeamformingVectorPair ();
+  NS_ABORT_MSG_IF (gnbSpectrumPhy == nullptr || ueSpectrumPhy == nullptr, "Something went wrong, gnb or UE PHY layer not set.");
+
+  Ptr<const PhasedArrayModel> gnbArray = gnbSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel> ();
+  Ptr<const PhasedArrayModel> ueArray = ueSpectrumPhy->GetAntenna ()->GetObject <PhasedArrayModel> ();
+
+  Ptr<ThreeGppSpectrumPropagationLossModel> threeGppSplm =
+    DynamicCast<ThreeGppSpectrumPropagationLossModel> (gnbSpectrumPhy->GetSpectrumChannel ()->GetPhasedArraySpectrumPropagationLossModel ());
+  NS_ABORT_MSG_IF (threeGppSplm == nullptr, "OptimalCovMatrixBeamforming needs the 3GPP spectrum propagation loss model");
+
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix =
+    threeGppSplm->GetChannelModel ()->GetChannel (gnbSpectrumPhy->GetMobility (), ueSpectrumPhy->GetMobility (),
+                                                 gnbArray, ueArray);
+
+  auto key = std::make_pair (gnbArray->GetId (), ueArray->GetId ());
+  auto it = m_cache.find (key);
+  if (it != m_cache.end () && it->second.m_generatedTime == channelMatrix->m_generatedTime)
+    {
+      NS_LOG_LOGIC ("Channel not updated since " << channelMatrix->m_generatedTime.As (Time::MS) <<
+                    ", reusing the beamforming vectors");
+      return it->second.m_bfPair;
+    }
+
+  const auto &h = channelMatrix->m_channel;
+  size_t uSize = h.size ();
+  size_t sSize = h[0].size ();
+  size_t numClusters = h[0][0].size ();
+
+  // Covariance of the s end, accumulated over the u elements and the clusters
+  ComplexMatrix sCov (sSize, complexVector_t (sSize, std::complex<double> (0.0, 0.0)));
+  for (size_t c = 0; c < numClusters; ++c)
+    {
+      for (size_t u = 0; u < uSize; ++u)
+        {
+          for (size_t i = 0; i < sSize; ++i)
+            {
+              std::complex<double> hi = std::conj (h[u][i][c]);
+              for (size_t j = i; j < sSize; ++j)
+                {
+                  sCov[i][j] += hi * h[u][j][c];
+                }
+            }
+        }
+    }
+  for (size_t i = 0; i < sSize; ++i)
+    {
+      for (size_t j = 0; j < i; ++j)
+        {
+          sCov[i][j] = std::conj (sCov[j][i]);
+        }
+    }
+  complexVector_t sW = GetPrincipalEigenvector (sCov, m_maxIterations, m_tolerance);
+
+  // The u end reuses the s vector: covariance of the effective channel of
+  // each cluster
+  ComplexMatrix uCov (uSize, complexVector_t (uSize, std::complex<double> (0.0, 0.0)));
+  complexVector_t g (uSize);
+  for (size_t c = 0; c < numClusters; ++c)
+    {
+      for (size_t u = 0; u < uSize; ++u)
+        {
+          std::complex<double> sum (0.0, 0.0);
+          for (size_t s = 0; s < sSize; ++s)
+            {
+              sum += h[u][s][c] * sW[s];
+            }
+          g[u] = sum;
+        }
+      for (size_t i = 0; i < uSize; ++i)
+        {
+          for (size_t j = 0; j < uSize; ++j)
+            {
+              uCov[i][j] += std::conj (g[i]) * g[j];
+            }
+        }
+    }
+  complexVector_t uW = GetPrincipalEigenvector (uCov, m_maxIterations, m_tolerance);
+
+  // check if the channel matrix was generated considering the gNB as the
+  // s-node and the UE as the u-node or viceversa
+  bool reverse = channelMatrix->IsReverse (gnbArray->GetId (), ueArray->GetId ());
+  BeamformingVector gnbBfv = std::make_pair (reverse ? uW : sW, BeamId::GetEmptyBeamId ());
+  BeamformingVector ueBfv = std::make_pair (reverse ? sW : uW, BeamId::GetEmptyBeamId ());
+  BeamformingVectorPair bfPair = std::make_pair (gnbBfv, ueBfv);
+
+  NS_LOG_DEBUG ("Beamforming vectors for gNB with node id: " << gnbSpectrumPhy->GetMobility ()->GetObject<Node> ()->GetId () <<
+                " and UE with node id: " << ueSpectrumPhy->GetMobility ()->GetObject<Node> ()->GetId () <<
+                " computed from the channel generated at " << channelMatrix->m_generatedTime.As (Time::MS));
+
+  m_cache[key] = CacheEntry {channelMatrix->m_generatedTime, bfPair};
+  return bfPair;
 }
 
 } // end of ns3 namespace
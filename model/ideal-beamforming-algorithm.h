@@ -21,8 +21,10 @@
 #define SRC_NR_MODEL_IDEAL_BEAMFORMING_ALGORITHM_H_
 
 #include <ns3/object.h>
+#include <ns3/nstime.h>
 #include "beam-id.h"
 #include "beamforming-vector.h"
+#include <map>
 
 namespace ns3 {
 
@@ -285,10 +287,30 @@ public:
 
 /**
  * \ingroup gnb-phy
- * \brief The OptimalCovMatrixBeamforming class not implemented yet.
- * TODO The idea was to port one of the initial beamforming methods that
- * were implemented in NYU/University of Padova mmwave module.
- * Method is based on a long term covariation matrix.
+ * \brief The OptimalCovMatrixBeamforming class
+ *
+ * It ports the long-term covariance matrix method of the NYU/University of
+ * Padova mmwave module to the ns-3 3GPP channel model. With the channel
+ * matrix H[u][s][c] of the link (u and s the antenna elements of the two
+ * ends, c the cluster) given by ThreeGppChannelModel, it builds the spatial
+ * covariance matrix of the s end,
+ *
+ *   R_s[i][j] = sum_c sum_u conj (H[u][i][c]) H[u][j][c],
+ *
+ * and takes its principal eigenvector, found by power iteration, as the
+ * beamforming vector of the s end. The u end does not need its own
+ * covariance of the full channel: it reuses the s vector to get the
+ * effective channel of each cluster, g_c[u] = sum_s H[u][s][c] w_s[s], and
+ * takes the principal eigenvector of sum_c conj (g_c) g_c^T. The two vectors
+ * maximize the long-term gain sum_c |w_u^T H_c w_s|^2 computed by the 3GPP
+ * spectrum propagation loss model.
+ *
+ * The vectors of a link are cached until the channel model generates a new
+ * channel matrix for it, so that the periodic beamforming updates of the
+ * helper do not repeat the computation for a channel that did not change.
+ * Compared to CellScanBeamforming, which evaluates the received power for
+ * every pair of gNB and UE sectors and elevations, the cost is a few
+ * matrix-vector products per channel update.
  */
 class OptimalCovMatrixBeamforming : public IdealBeamformingAlgorithm
 {
@@ -301,16 +323,65 @@ public:
    */
   static TypeId GetTypeId (void);
 
+  /**
+   * \brief constructor
+   */
+  OptimalCovMatrixBeamforming () = default;
+
+  /**
+   * \brief destructor
+   */
+  virtual ~OptimalCovMatrixBeamforming () override = default;
+
   /**
    * \brief Function that generates the beamforming vectors for a pair of
-   * communicating devices by using the direct-path beamforming vector for gNB
-   * and quasi-omni beamforming vector for UEs
+   * communicating devices by using the principal eigenvectors of the
+   * spatial covariance matrix of the channel
    * \param [in] gnbSpectrumPhy the spectrum phy of the gNB
    * \param [in] ueSpectrumPhy the spectrum phy of the UE
    * \return the beamforming vector pair of the gNB and the UE
    */
   virtual BeamformingVectorPair GetBeamformingVectors (const Ptr<NrSpectrumPhy>& gnbSpectrumPhy,
                                                        const Ptr<NrSpectrumPhy>& ueSpectrumPhy) const override;
+
+  /**
+   * \brief A square complex matrix, stored by rows
+   */
+  typedef std::vector<complexVector_t> ComplexMatrix;
+
+  /**
+   * \brief Find the principal eigenvector of a Hermitian positive
+   * semi-definite matrix through power iteration
+   *
+   * The iteration starts from the column of the matrix with the highest
+   * diagonal element, and stops when the estimate of the eigenvalue changes
+   * by less than tolerance (relative), or after maxIterations.
+   *
+   * \param matrix the matrix
+   * \param maxIterations the maximum number of iterations
+   * \param tolerance the relative tolerance on the eigenvalue
+   * \return the eigenvector, with unit norm; a uniform vector if the
+   *         matrix is null
+   */
+  static complexVector_t GetPrincipalEigenvector (const ComplexMatrix &matrix,
+                                                  uint32_t maxIterations, double tolerance);
+
+private:
+  /**
+   * \brief The beamforming vectors computed for a link
+   */
+  struct CacheEntry
+  {
+    Time m_generatedTime;           //!< Generation time of the channel matrix used
+    BeamformingVectorPair m_bfPair; //!< The beamforming vectors
+  };
+
+  uint32_t m_maxIterations {100}; //!< Maximum number of power iterations
+  double m_tolerance {1e-6};      //!< Relative tolerance of the power iteration
+  /**
+   * Beamforming vectors of each link, by the ids of the gNB and UE antenna arrays
+   */
+  mutable std::map<std::pair<uint32_t, uint32_t>, CacheEntry> m_cache;
 };
 
 
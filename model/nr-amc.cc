@@ -19,6 +19,7 @@
 
 #include "nr-amc.h"
 #include <ns3/log.h>
+#include <ns3/abort.h>
 #include <ns3/double.h>
 #include <ns3/math.h>
 #include <ns3/enum.h>
@@ -27,6 +28,7 @@
 #include "nr-lte-mi-error-model.h"
 #include "lena-error-model.h"
 #include <ns3/nr-spectrum-value-helper.h>
+#include <algorithm>
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NrAmc");
@@ -98,10 +100,10 @@ NrAmc::GetMcsFromCqi (uint8_t cqi) const
   NS_LOG_FUNCTION (cqi);
   NS_ASSERT_MSG (cqi >= 0 && cqi <= 15, "CQI must be in [0..15] = " << cqi);
 
-  double spectralEfficiency = m_errorModel->GetSpectralEfficiencyForCqi (cqi);
+  double spectralEfficiency = GetSpectralEfficiencyForCqi (cqi);
   uint8_t mcs = 0;
 
-  while ((mcs < m_errorModel->GetMaxMcs ()) && (m_errorModel->GetSpectralEfficiencyForMcs (mcs + 1) <= spectralEfficiency))
+  while ((mcs < m_maxMcs) && (GetSpectralEfficiencyForMcs (mcs + 1) <= spectralEfficiency))
     {
       ++mcs;
     }
@@ -129,8 +131,8 @@ NrAmc::CalculateTbSize (uint8_t mcs, uint32_t nprb) const
 {
   NS_LOG_FUNCTION (this << static_cast<uint32_t> (mcs));
 
-  NS_ASSERT_MSG (mcs <= m_errorModel->GetMaxMcs (), "MCS=" << static_cast<uint32_t> (mcs) <<
-                 " while maximum MCS is " << static_cast<uint32_t> (m_errorModel->GetMaxMcs ()));
+  NS_ASSERT_MSG (mcs <= m_maxMcs, "MCS=" << static_cast<uint32_t> (mcs) <<
+                 " while maximum MCS is " << static_cast<uint32_t> (m_maxMcs));
 
   uint32_t payloadSize = GetPayloadSize (mcs, nprb);
   uint32_t tbSize = payloadSize;
@@ -234,7 +236,7 @@ NrAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcs) const
 
       mcs = 0;
       Ptr<NrErrorModelOutput> output;
-      while (mcs <= m_errorModel->GetMaxMcs ())
+      while (mcs <= m_maxMcs)
         {
           output = m_errorModel->GetTbDecodificationStats (sinr, rbMap,
                                                            CalculateTbSize (mcs, rbMap.size ()),
@@ -256,15 +258,15 @@ NrAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcs) const
         {
           cqi = 0;
         }
-      else if (mcs == m_errorModel->GetMaxMcs ())
+      else if (mcs == m_maxMcs)
         {
           cqi = 15;   // all MCSs can guarantee the 10 % of BER
         }
       else
         {
-          double s = m_errorModel->GetSpectralEfficiencyForMcs (mcs);
+          double s = GetSpectralEfficiencyForMcs (mcs);
           cqi = 0;
-          while ((cqi < 15) && (m_errorModel->GetSpectralEfficiencyForCqi (cqi + 1) <= s))
+          while ((cqi < 15) && (GetSpectralEfficiencyForCqi (cqi + 1) <= s))
             {
               ++cqi;
             }
@@ -274,13 +276,46 @@ NrAmc::CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcs) const
   return cqi;
 }
 
+std::vector<uint8_t>
+NrAmc::CreateCqiFeedbackSbTdma (const SpectrumValue& sinr, uint16_t rbPerSb) const
+{
+  NS_LOG_FUNCTION (this << rbPerSb);
+  NS_ABORT_MSG_IF (rbPerSb == 0, "The sub-band must have at least one RB");
+
+  uint32_t numRb = static_cast<uint32_t> (sinr.GetSpectrumModel ()->GetNumBands ());
+  std::vector<uint8_t> sbCqi;
+  sbCqi.reserve ((numRb + rbPerSb - 1) / rbPerSb);
+
+  // The sub-bands without any signal take the wideband value
+  uint8_t mcs;
+  uint8_t wbCqi = CreateCqiFeedbackWbTdma (sinr, mcs);
+
+  // The RBs out of the sub-band are zeroed, so they are not considered
+  // (as the RBs without signal in the wideband CQI)
+  SpectrumValue sbSinr (sinr.GetSpectrumModel ());
+  for (uint32_t first = 0; first < numRb; first += rbPerSb)
+    {
+      uint32_t last = std::min (first + rbPerSb, numRb);
+      bool measured = false;
+      sbSinr = 0.0;
+      for (uint32_t rb = first; rb < last; ++rb)
+        {
+          sbSinr[rb] = sinr[rb];
+          measured |= sinr[rb] != 0.0;
+        }
+      sbCqi.push_back (measured ? CreateCqiFeedbackWbTdma (sbSinr, mcs) : wbCqi);
+    }
+
+  return sbCqi;
+}
+
 uint8_t
 NrAmc::GetCqiFromSpectralEfficiency (double s) const
 {
   NS_LOG_FUNCTION (s);
   NS_ASSERT_MSG (s >= 0.0, "negative spectral efficiency = " << s);
   uint8_t cqi = 0;
-  while ((cqi < 15) && (m_errorModel->GetSpectralEfficiencyForCqi (cqi + 1) < s))
+  while ((cqi < 15) && (GetSpectralEfficiencyForCqi (cqi + 1) < s))
     {
       ++cqi;
     }
@@ -294,7 +329,7 @@ NrAmc::GetMcsFromSpectralEfficiency (double s) const
   NS_LOG_FUNCTION (s);
   NS_ASSERT_MSG (s >= 0.0, "negative spectral efficiency = " << s);
   uint8_t mcs = 0;
-  while ((mcs < m_errorModel->GetMaxMcs ()) && (m_errorModel->GetSpectralEfficiencyForMcs (mcs + 1) < s))
+  while ((mcs < m_maxMcs) && (GetSpectralEfficiencyForMcs (mcs + 1) < s))
     {
       ++mcs;
     }
@@ -306,7 +341,7 @@ uint32_t
 NrAmc::GetMaxMcs() const
 {
   NS_LOG_FUNCTION (this);
-  return m_errorModel->GetMaxMcs ();
+  return m_maxMcs;
 }
 
 void
@@ -333,6 +368,11 @@ NrAmc::SetErrorModelType (const TypeId &type)
   factory.SetTypeId (m_errorModelType);
   m_errorModel = DynamicCast<NrErrorModel> (factory.Create ());
   NS_ASSERT (m_errorModel != nullptr);
+  // The tables do not change during the simulation: get them once here,
+  // the MCS/CQI lookups then read them directly
+  m_mcsTable = m_errorModel->GetMcsTable ();
+  m_maxMcs = m_errorModel->GetMaxMcs ();
+  NS_ASSERT (m_mcsTable == nullptr || m_mcsTable->m_maxMcs == m_maxMcs);
 }
 
 TypeId
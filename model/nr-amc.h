@@ -135,6 +135,20 @@ public:
    */
   uint8_t CreateCqiFeedbackWbTdma (const SpectrumValue& sinr, uint8_t &mcsWb) const;
 
+  /**
+   * \brief Create a sub-band CQI feedback from a SINR values
+   *
+   * The RBs are grouped in sub-bands of rbPerSb consecutive RBs (the last
+   * one can be smaller), and a CQI is computed for each sub-band as in
+   * CreateCqiFeedbackWbTdma, considering only the SINR of its RBs. A
+   * sub-band without signal in any of its RBs takes the wideband CQI.
+   *
+   * \param sinr the sinr values
+   * \param rbPerSb the number of RBs of each sub-band
+   * \return The calculated CQI of each sub-band
+   */
+  std::vector<uint8_t> CreateCqiFeedbackSbTdma (const SpectrumValue& sinr, uint16_t rbPerSb) const;
+
   /**
    * \brief Get CQI from a SpectralEfficiency value
    * \param s spectral efficiency
@@ -203,10 +217,36 @@ private:
    */
   double GetBer () const;
 
+  /**
+   * \brief Get the SE of a MCS, from the table of the error model if it
+   * exposes one
+   * \param mcs the MCS (not higher than m_maxMcs)
+   * \return the spectral efficiency
+   */
+  double GetSpectralEfficiencyForMcs (uint8_t mcs) const
+  {
+    return m_mcsTable != nullptr ? m_mcsTable->m_spectralEfficiencyForMcs[mcs]
+                                 : m_errorModel->GetSpectralEfficiencyForMcs (mcs);
+  }
+
+  /**
+   * \brief Get the SE of a CQI, from the table of the error model if it
+   * exposes one
+   * \param cqi the CQI (0 to 15)
+   * \return the spectral efficiency
+   */
+  double GetSpectralEfficiencyForCqi (uint8_t cqi) const
+  {
+    return m_mcsTable != nullptr ? m_mcsTable->m_spectralEfficiencyForCqi[cqi]
+                                 : m_errorModel->GetSpectralEfficiencyForCqi (cqi);
+  }
+
 private:
   AmcModel m_amcModel;             //!< Type of the CQI feedback model
   Ptr<NrErrorModel> m_errorModel;  //!< Pointer to an instance of ErrorModel
   TypeId m_errorModelType;         //!< Type of the error model
+  const NrMcsTable *m_mcsTable {nullptr}; //!< MCS table of the error model (nullptr if not exposed)
+  uint8_t m_maxMcs {0};            //!< Maximum MCS of the error model
   uint8_t m_numRefScPerRb {1};     //!< number of reference subcarriers per RB
   NrErrorModel::Mode m_emMode {NrErrorModel::DL}; //!< Error model mode
   static const unsigned int m_crcLen = 24 / 8; //!< CRC length (in bytes)
@@ -95,6 +95,20 @@ NrChAccessManager::GetNrGnbMac ()
   return m_mac;
 }
 
+void
+NrChAccessManager::SetNrUeMac (Ptr<NrUeMac> mac)
+{
+  NS_LOG_FUNCTION (this);
+  m_ueMac = mac;
+}
+
+Ptr<NrUeMac>
+NrChAccessManager::GetNrUeMac ()
+{
+  NS_LOG_FUNCTION (this);
+  return m_ueMac;
+}
+
 // -----------------------------------------------------------------
 
 NS_OBJECT_ENSURE_REGISTERED (NrAlwaysOnAccessManager);
@@ -22,6 +22,7 @@
 #include <ns3/event-id.h>
 #include <functional>
 #include "nr-gnb-mac.h"
+#include "nr-ue-mac.h"
 #include "nr-spectrum-phy.h"
 
 #ifndef NR_CH_ACCESS_MANAGER_H_
@@ -143,10 +144,23 @@ public:
    */
   Ptr<NrGnbMac> GetNrGnbMac ();
 
+  /**
+   * \brief Set the UE MAC instance for this channel access manager
+   * \param mac UE mac instance
+   */
+  virtual void SetNrUeMac (Ptr<NrUeMac> mac);
+
+  /**
+   * \brief Getter for the UE MAC instance to which is connected this channel access manager
+   * \return pointer to the UE MAC instance
+   */
+  Ptr<NrUeMac> GetNrUeMac ();
+
 private:
 
   Time m_grantDuration; //!< Duration of the channel access grant
   Ptr<NrGnbMac> m_mac; //!< MAC instance to which is connected this channel access manager
+  Ptr<NrUeMac> m_ueMac; //!< UE MAC instance to which is connected this channel access manager
   Ptr<NrSpectrumPhy> m_spectrumPhy; //!< SpectrumPhy instance to which is connected this channel access manager
 };
 
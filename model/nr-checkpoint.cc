@@ -0,0 +1,230 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-checkpoint.h"
+
+#include <ns3/log.h>
+#include <ns3/assert.h>
+#include <ns3/fatal-error.h>
+
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrCheckpoint");
+
+void
+NrCheckpointWriter::WriteU8 (uint8_t v)
+{
+  m_buffer.push_back (v);
+}
+
+void
+NrCheckpointWriter::WriteU16 (uint16_t v)
+{
+  WriteU8 (static_cast<uint8_t> (v & 0xff));
+  WriteU8 (static_cast<uint8_t> (v >> 8));
+}
+
+void
+NrCheckpointWriter::WriteU32 (uint32_t v)
+{
+  WriteU16 (static_cast<uint16_t> (v & 0xffff));
+  WriteU16 (static_cast<uint16_t> (v >> 16));
+}
+
+void
+NrCheckpointWriter::WriteU64 (uint64_t v)
+{
+  WriteU32 (static_cast<uint32_t> (v & 0xffffffff));
+  WriteU32 (static_cast<uint32_t> (v >> 32));
+}
+
+void
+NrCheckpointWriter::WriteDouble (double v)
+{
+  static_assert (sizeof (double) == sizeof (uint64_t), "Unsupported double size");
+  uint64_t bits;
+  std::memcpy (&bits, &v, sizeof (bits));
+  WriteU64 (bits);
+}
+
+void
+NrCheckpointWriter::WriteU8Vector (const std::vector<uint8_t> &v)
+{
+  WriteU32 (static_cast<uint32_t> (v.size ()));
+  m_buffer.insert (m_buffer.end (), v.begin (), v.end ());
+}
+
+void
+NrCheckpointWriter::WriteDoubleVector (const std::vector<double> &v)
+{
+  WriteU32 (static_cast<uint32_t> (v.size ()));
+  for (const auto & d : v)
+    {
+      WriteDouble (d);
+    }
+}
+
+void
+NrCheckpointWriter::WriteString (const std::string &v)
+{
+  WriteU32 (static_cast<uint32_t> (v.size ()));
+  m_buffer.insert (m_buffer.end (), v.begin (), v.end ());
+}
+
+size_t
+NrCheckpointWriter::BeginRecord ()
+{
+  size_t start = m_buffer.size ();
+  WriteU32 (0);
+  return start;
+}
+
+void
+NrCheckpointWriter::EndRecord (size_t start)
+{
+  NS_ASSERT (start + 4 <= m_buffer.size ());
+  uint32_t length = static_cast<uint32_t> (m_buffer.size () - start - 4);
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      m_buffer[start + i] = static_cast<uint8_t> ((length >> (8 * i)) & 0xff);
+    }
+}
+
+const std::vector<uint8_t> &
+NrCheckpointWriter::GetBuffer () const
+{
+  return m_buffer;
+}
+
+NrCheckpointReader::NrCheckpointReader (const std::vector<uint8_t> &buffer)
+  : m_buffer (buffer)
+{
+}
+
+void
+NrCheckpointReader::Require (size_t n) const
+{
+  size_t end = m_recordEnd.empty () ? m_buffer.size () : m_recordEnd.back ();
+  if (m_pos + n > end)
+    {
+      NS_FATAL_ERROR ("Truncated or corrupted NR checkpoint: reading " << n <<
+                      " bytes at position " << m_pos << ", end at " << end);
+    }
+}
+
+uint8_t
+NrCheckpointReader::ReadU8 ()
+{
+  Require (1);
+  return m_buffer[m_pos++];
+}
+
+uint16_t
+NrCheckpointReader::ReadU16 ()
+{
+  uint16_t lo = ReadU8 ();
+  uint16_t hi = ReadU8 ();
+  return static_cast<uint16_t> (lo | (hi << 8));
+}
+
+uint32_t
+NrCheckpointReader::ReadU32 ()
+{
+  uint32_t lo = ReadU16 ();
+  uint32_t hi = ReadU16 ();
+  return lo | (hi << 16);
+}
+
+uint64_t
+NrCheckpointReader::ReadU64 ()
+{
+  uint64_t lo = ReadU32 ();
+  uint64_t hi = ReadU32 ();
+  return lo | (hi << 32);
+}
+
+double
+NrCheckpointReader::ReadDouble ()
+{
+  uint64_t bits = ReadU64 ();
+  double v;
+  std::memcpy (&v, &bits, sizeof (v));
+  return v;
+}
+
+std::vector<uint8_t>
+NrCheckpointReader::ReadU8Vector ()
+{
+  uint32_t size = ReadU32 ();
+  Require (size);
+  std::vector<uint8_t> v (m_buffer.begin () + m_pos, m_buffer.begin () + m_pos + size);
+  m_pos += size;
+  return v;
+}
+
+std::vector<double>
+NrCheckpointReader::ReadDoubleVector ()
+{
+  uint32_t size = ReadU32 ();
+  Require (static_cast<size_t> (size) * 8);
+  std::vector<double> v;
+  v.reserve (size);
+  for (uint32_t i = 0; i < size; ++i)
+    {
+      v.push_back (ReadDouble ());
+    }
+  return v;
+}
+
+std::string
+NrCheckpointReader::ReadString ()
+{
+  uint32_t size = ReadU32 ();
+  Require (size);
+  std::string v (m_buffer.begin () + m_pos, m_buffer.begin () + m_pos + size);
+  m_pos += size;
+  return v;
+}
+
+size_t
+NrCheckpointReader::BeginRecord ()
+{
+  uint32_t length = ReadU32 ();
+  Require (length);
+  m_recordEnd.push_back (m_pos + length);
+  return m_recordEnd.back ();
+}
+
+void
+NrCheckpointReader::EndRecord (size_t end)
+{
+  NS_ASSERT (! m_recordEnd.empty () && m_recordEnd.back () == end);
+  NS_ASSERT (m_pos <= end);
+  m_recordEnd.pop_back ();
+  m_pos = end;
+}
+
+bool
+NrCheckpointReader::IsAtEnd () const
+{
+  return m_pos == (m_recordEnd.empty () ? m_buffer.size () : m_recordEnd.back ());
+}
+
+} // namespace ns3
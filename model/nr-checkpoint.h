@@ -0,0 +1,196 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_CHECKPOINT_H
+#define NR_CHECKPOINT_H
+
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Writes the state of NR objects in a compact binary checkpoint
+ *
+ * Integers are written in little endian with their exact size, doubles as
+ * their IEEE 754 representation, and vectors and strings as a 32-bit count followed by
+ * the elements. The state of each object is wrapped in a record, that starts
+ * with its length: a reader can then skip the records of objects that do
+ * not exist anymore.
+ *
+ * \see NrCheckpointReader
+ * \see NrHelper::SaveCheckpoint
+ */
+class NrCheckpointWriter
+{
+public:
+  /**
+   * \brief Write an 8-bit value
+   * \param v the value
+   */
+  void WriteU8 (uint8_t v);
+  /**
+   * \brief Write a 16-bit value
+   * \param v the value
+   */
+  void WriteU16 (uint16_t v);
+  /**
+   * \brief Write a 32-bit value
+   * \param v the value
+   */
+  void WriteU32 (uint32_t v);
+  /**
+   * \brief Write a 64-bit value
+   * \param v the value
+   */
+  void WriteU64 (uint64_t v);
+  /**
+   * \brief Write a double
+   * \param v the value
+   */
+  void WriteDouble (double v);
+  /**
+   * \brief Write a vector of 8-bit values
+   * \param v the vector
+   */
+  void WriteU8Vector (const std::vector<uint8_t> &v);
+  /**
+   * \brief Write a vector of doubles
+   * \param v the vector
+   */
+  void WriteDoubleVector (const std::vector<double> &v);
+  /**
+   * \brief Write a string
+   * \param v the string
+   */
+  void WriteString (const std::string &v);
+
+  /**
+   * \brief Start a record, reserving the space for its length
+   * \return the position of the record, to pass to EndRecord
+   */
+  size_t BeginRecord ();
+  /**
+   * \brief Close a record, writing its length
+   * \param start the value returned by BeginRecord
+   */
+  void EndRecord (size_t start);
+
+  /**
+   * \brief Get the checkpoint written so far
+   * \return the bytes of the checkpoint
+   */
+  const std::vector<uint8_t> & GetBuffer () const;
+
+private:
+  std::vector<uint8_t> m_buffer; //!< The checkpoint
+};
+
+/**
+ * \ingroup utils
+ * \brief Reads a checkpoint written by NrCheckpointWriter
+ *
+ * Reading past the end of the checkpoint, or of the current record, is a
+ * fatal error.
+ */
+class NrCheckpointReader
+{
+public:
+  /**
+   * \brief NrCheckpointReader constructor
+   * \param buffer the checkpoint (it is not copied and must outlive the reader)
+   */
+  NrCheckpointReader (const std::vector<uint8_t> &buffer);
+
+  /**
+   * \brief Read an 8-bit value
+   * \return the value
+   */
+  uint8_t ReadU8 ();
+  /**
+   * \brief Read a 16-bit value
+   * \return the value
+   */
+  uint16_t ReadU16 ();
+  /**
+   * \brief Read a 32-bit value
+   * \return the value
+   */
+  uint32_t ReadU32 ();
+  /**
+   * \brief Read a 64-bit value
+   * \return the value
+   */
+  uint64_t ReadU64 ();
+  /**
+   * \brief Read a double
+   * \return the value
+   */
+  double ReadDouble ();
+  /**
+   * \brief Read a vector of 8-bit values
+   * \return the vector
+   */
+  std::vector<uint8_t> ReadU8Vector ();
+  /**
+   * \brief Read a vector of doubles
+   * \return the vector
+   */
+  std::vector<double> ReadDoubleVector ();
+  /**
+   * \brief Read a string
+   * \return the string
+   */
+  std::string ReadString ();
+
+  /**
+   * \brief Enter a record
+   * \return the position of the end of the record, to pass to EndRecord
+   */
+  size_t BeginRecord ();
+  /**
+   * \brief Go to the end of a record, skipping what was not read
+   * \param end the value returned by BeginRecord
+   */
+  void EndRecord (size_t end);
+
+  /**
+   * \brief Check if the current record, or the whole checkpoint outside of
+   * any record, has been read
+   * \return true if there is nothing left to read
+   */
+  bool IsAtEnd () const;
+
+private:
+  /**
+   * \brief Check that n bytes can be read
+   * \param n the number of bytes
+   */
+  void Require (size_t n) const;
+
+  const std::vector<uint8_t> &m_buffer; //!< The checkpoint
+  size_t m_pos {0};                      //!< Position of the next byte to read
+  std::vector<size_t> m_recordEnd;       //!< End of the records being read, innermost last
+};
+
+} // namespace ns3
+
+#endif // NR_CHECKPOINT_H
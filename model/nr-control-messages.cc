@@ -19,6 +19,7 @@
 
 #include <ns3/log.h>
 #include "nr-control-messages.h"
+#include <algorithm>
 
 namespace ns3 {
 
@@ -167,13 +168,68 @@ NrDlCqiMessage::~NrDlCqiMessage (void)
 void
 NrDlCqiMessage::SetDlCqi (DlCqiInfo cqi)
 {
+  m_sbCqiOffsets.clear ();
+  m_numSb.clear ();
+  for (uint32_t stream = 0; stream < cqi.m_sbCqi.size (); ++stream)
+    {
+      NS_ASSERT (stream < cqi.m_wbCqi.size ());
+      m_sbCqiOffsets.push_back (EncodeSbCqi (cqi.m_wbCqi.at (stream), cqi.m_sbCqi.at (stream)));
+      m_numSb.push_back (static_cast<uint16_t> (cqi.m_sbCqi.at (stream).size ()));
+    }
+  cqi.m_sbCqi.clear ();
   m_cqi = cqi;
 }
 
 DlCqiInfo
 NrDlCqiMessage::GetDlCqi ()
 {
-  return m_cqi;
+  DlCqiInfo cqi = m_cqi;
+  for (uint32_t stream = 0; stream < m_sbCqiOffsets.size (); ++stream)
+    {
+      cqi.m_sbCqi.push_back (DecodeSbCqi (cqi.m_wbCqi.at (stream), m_sbCqiOffsets.at (stream),
+                                          m_numSb.at (stream)));
+    }
+  return cqi;
+}
+
+std::vector<uint8_t>
+NrDlCqiMessage::EncodeSbCqi (uint8_t wbCqi, const std::vector<uint8_t> &sbCqi)
+{
+  std::vector<uint8_t> encoded ((sbCqi.size () + 3) / 4, 0);
+  for (uint32_t sb = 0; sb < sbCqi.size (); ++sb)
+    {
+      int offset = static_cast<int> (sbCqi.at (sb)) - wbCqi;
+      uint8_t value;
+      if (offset <= -1)
+        {
+          value = 3;
+        }
+      else if (offset >= 2)
+        {
+          value = 2;
+        }
+      else
+        {
+          value = static_cast<uint8_t> (offset);
+        }
+      encoded.at (sb / 4) |= value << (2 * (sb % 4));
+    }
+  return encoded;
+}
+
+std::vector<uint8_t>
+NrDlCqiMessage::DecodeSbCqi (uint8_t wbCqi, const std::vector<uint8_t> &encoded, uint16_t numSb)
+{
+  NS_ASSERT (encoded.size () * 4 >= numSb);
+  static const int offsets [4] = {0, 1, 2, -1};
+  std::vector<uint8_t> sbCqi (numSb);
+  for (uint32_t sb = 0; sb < numSb; ++sb)
+    {
+      uint8_t value = (encoded.at (sb / 4) >> (2 * (sb % 4))) & 0x3;
+      int cqi = static_cast<int> (wbCqi) + offsets [value];
+      sbCqi.at (sb) = static_cast<uint8_t> (std::min (std::max (cqi, 0), 15));
+    }
+  return sbCqi;
 }
 
 // ----------------------------------------------------------------------------------------------------------
@@ -251,6 +251,11 @@ private:
 /**
  * \brief The message that represents a DL CQI message
  * \ingroup utils
+ *
+ * For a sub-band CQI report, the sub-band CQIs are not carried as they are,
+ * but with the 2-bit differential encoding of TS 38.214 (Table 5.2.2.1-1)
+ * with respect to the wideband CQI of the same stream: offset 0, +1, >= +2,
+ * or <= -1. Therefore, the CQIs returned by GetDlCqi are the quantized ones.
  */
 class NrDlCqiMessage : public NrControlMessage
 {
@@ -275,8 +280,26 @@ public:
    */
   DlCqiInfo GetDlCqi ();
 
+  /**
+   * \brief Encode the sub-band CQIs as 2-bit offsets from the wideband CQI
+   * \param wbCqi the wideband CQI
+   * \param sbCqi the CQI of each sub-band
+   * \return the offsets, packed 4 per byte
+   */
+  static std::vector<uint8_t> EncodeSbCqi (uint8_t wbCqi, const std::vector<uint8_t> &sbCqi);
+  /**
+   * \brief Decode the sub-band CQIs encoded by EncodeSbCqi
+   * \param wbCqi the wideband CQI
+   * \param encoded the packed offsets
+   * \param numSb the number of sub-bands
+   * \return the (quantized) CQI of each sub-band
+   */
+  static std::vector<uint8_t> DecodeSbCqi (uint8_t wbCqi, const std::vector<uint8_t> &encoded, uint16_t numSb);
+
 private:
-  DlCqiInfo m_cqi; //!< The DlCqiInfo struct
+  DlCqiInfo m_cqi; //!< The DlCqiInfo struct, without the sub-band CQIs
+  std::vector<std::vector<uint8_t> > m_sbCqiOffsets; //!< Encoded sub-band CQIs of each stream
+  std::vector<uint16_t> m_numSb; //!< Number of sub-bands of each stream
 };
 
 
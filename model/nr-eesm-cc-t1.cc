@@ -26,7 +26,7 @@ NS_OBJECT_ENSURE_REGISTERED (NrEesmCcT1);
 
 NrEesmCcT1::NrEesmCcT1()
 {
-
+  m_mcsTable = &NrMcsTable::Get (NrMcsTable::TABLE1);
 }
 
 NrEesmCcT1::~NrEesmCcT1()
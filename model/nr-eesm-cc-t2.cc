@@ -26,7 +26,7 @@ NS_OBJECT_ENSURE_REGISTERED (NrEesmCcT2);
 
 NrEesmCcT2::NrEesmCcT2()
 {
-
+  m_mcsTable = &NrMcsTable::Get (NrMcsTable::TABLE2);
 }
 
 NrEesmCcT2::~NrEesmCcT2()
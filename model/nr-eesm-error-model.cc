@@ -20,6 +20,7 @@
 */
 
 #include "nr-eesm-error-model.h"
+#include "nr-profiler.h"
 #include "ns3/log.h"
 #include <cmath>
 #include <algorithm>
@@ -76,7 +77,8 @@ NrEesmErrorModel::SinrEff (const SpectrumValue& sinr, const std::vector<int>& ma
   // for HARQ-CC: b = map.size(), a = 0.0 (SINRs are already combined in sinr input)
 
   double sinrExpSum = SinrExp (sinr, map, mcs);
-  double beta = GetBetaTable ()->at (mcs);
+  NS_ASSERT (mcs <= m_mcsTable->m_maxMcs);
+  double beta = m_mcsTable->m_beta[mcs];
   double SINR = -beta * log ((a + sinrExpSum)/b);
 
   NS_LOG_INFO (" Effective SINR = " << SINR);
@@ -94,7 +96,8 @@ NrEesmErrorModel::SinrExp (const SpectrumValue& sinr, const std::vector<int>& ma
 
   double SINRexp = 0.0;
   double SINRsum = 0.0;
-  double beta = GetBetaTable ()->at (mcs);
+  NS_ASSERT (mcs <= m_mcsTable->m_maxMcs);
+  double beta = m_mcsTable->m_beta[mcs];
   SpectrumValue sinrCopy = sinr;
   for (uint32_t i = 0; i < map.size (); i++)
     {
@@ -175,7 +178,8 @@ NrEesmErrorModel::MappingSinrBler (double sinr, uint8_t mcs, uint32_t cbSizeBit)
 NrEesmErrorModel::GraphType
 NrEesmErrorModel::GetBaseGraphType (uint32_t tbSizeBit, uint8_t mcs) const
 {
-  double ecr = GetMcsEcrTable ()->at (mcs);
+  NS_ASSERT (mcs <= m_mcsTable->m_maxMcs);
+  double ecr = m_mcsTable->m_mcsEcr[mcs];
 
   GraphType bg_type = FIRST;
   if (tbSizeBit <= 292 || ecr <= 0.25 || (tbSizeBit <= 3824 && ecr <= 0.67))
@@ -289,6 +293,7 @@ NrEesmErrorModel::GetTbBitDecodificationStats (const SpectrumValue& sinr,
                                                const NrErrorModelHistory &sinrHistory)
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (ERROR_MODEL);
   NS_ABORT_IF (mcs > GetMaxMcs ());
 
   double tbSinr = SinrEff (sinr, map, mcs, 0, map.size());  // effective SINR for this tx
@@ -340,7 +345,7 @@ NrEesmErrorModel::GetTbBitDecodificationStats (const SpectrumValue& sinr,
     }
 
   NS_LOG_DEBUG ("Calculated Error rate " << errorRate);
-  NS_ASSERT (GetMcsEcrTable () != nullptr);
+  NS_ASSERT (m_mcsTable != nullptr);
 
   Ptr<NrEesmErrorModelOutput> ret = Create<NrEesmErrorModelOutput> (errorRate);
   ret->m_sinrEff = SINR;
@@ -356,7 +361,7 @@ NrEesmErrorModel::GetTbBitDecodificationStats (const SpectrumValue& sinr,
       ret->m_sinrExp = m_sinrExpPrevious + sinrExpSum;  // it sums over previous tx (recursively)
     }
   ret->m_infoBits = sizeBit;
-  ret->m_codeBits = sizeBit / GetMcsEcrTable ()->at (mcs);
+  ret->m_codeBits = sizeBit / m_mcsTable->m_mcsEcr[mcs];
 
   return ret;
 }
@@ -365,30 +370,28 @@ double
 NrEesmErrorModel::GetSpectralEfficiencyForCqi (uint8_t cqi)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (GetSpectralEfficiencyForCqi () != nullptr);
   NS_ABORT_MSG_UNLESS (cqi >= 0 && cqi <= 15, "CQI must be in [0..15] = " << cqi);
 
-  return GetSpectralEfficiencyForCqi ()->at (cqi);
+  return m_mcsTable->m_spectralEfficiencyForCqi[cqi];
 }
 
 double
 NrEesmErrorModel::GetSpectralEfficiencyForMcs (uint8_t mcs) const
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (GetSpectralEfficiencyForMcs () != nullptr);
-  NS_ABORT_IF (mcs > GetMaxMcs ());
+  NS_ABORT_IF (mcs > m_mcsTable->m_maxMcs);
 
-  return GetSpectralEfficiencyForMcs() ->at (mcs);
+  return m_mcsTable->m_spectralEfficiencyForMcs[mcs];
 }
 
 uint32_t
 NrEesmErrorModel::GetPayloadSize (uint32_t usefulSc, uint8_t mcs, uint32_t rbNum, [[maybe_unused]] Mode mode) const
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (GetMcsEcrTable () != nullptr);
+  NS_ASSERT (mcs <= m_mcsTable->m_maxMcs);
   const uint32_t rscElement = usefulSc * rbNum;
-  double Rcode = GetMcsEcrTable ()->at (mcs);
-  uint8_t Qm = GetMcsMTable ()->at (mcs);
+  double Rcode = m_mcsTable->m_mcsEcr[mcs];
+  uint8_t Qm = m_mcsTable->m_mcsM[mcs];
 
   const double spectralEfficiency = rscElement * Qm * Rcode;
 
@@ -411,9 +414,14 @@ uint8_t
 NrEesmErrorModel::GetMaxMcs () const
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (GetMcsEcrTable () != nullptr);
-  NS_LOG_INFO (" Max MCS: " << +(GetMcsEcrTable ()->size () - 1));
-  return static_cast<uint8_t> (GetMcsEcrTable ()->size () - 1);
+  NS_LOG_INFO (" Max MCS: " << +m_mcsTable->m_maxMcs);
+  return m_mcsTable->m_maxMcs;
+}
+
+const NrMcsTable *
+NrEesmErrorModel::GetMcsTable () const
+{
+  return m_mcsTable;
 }
 
 } // namespace ns3
@@ -159,6 +159,10 @@ public:
   * \brief Get the maximum MCS. It depends on NR tables being used
   */
   virtual uint8_t GetMaxMcs () const override;
+  /**
+   * \brief Get the Table1 or Table2 view, set by the subclass
+   */
+  virtual const NrMcsTable * GetMcsTable () const override;
 
   typedef std::vector<double> DoubleVector;
   typedef std::tuple<DoubleVector, DoubleVector> DoubleTuple;
@@ -259,6 +263,13 @@ protected:
    */
   virtual const std::vector<double> * GetSpectralEfficiencyForCqi () const = 0;
 
+  /**
+   * \brief The MCS table (Table1 or Table2) used in the hot paths; the
+   * subclasses must set it in their constructor, as the same table returned
+   * by the Get*Table methods
+   */
+  const NrMcsTable *m_mcsTable {nullptr};
+
 private:
   static std::vector<std::string> m_bgTypeName; //!< Base graph name
 
@@ -26,7 +26,7 @@ NS_OBJECT_ENSURE_REGISTERED (NrEesmIrT1);
 
 NrEesmIrT1::NrEesmIrT1()
 {
-
+  m_mcsTable = &NrMcsTable::Get (NrMcsTable::TABLE1);
 }
 
 NrEesmIrT1::~NrEesmIrT1 ()
@@ -25,7 +25,7 @@ NS_OBJECT_ENSURE_REGISTERED (NrEesmIrT2);
 
 NrEesmIrT2::NrEesmIrT2()
 {
-
+  m_mcsTable = &NrMcsTable::Get (NrMcsTable::TABLE2);
 }
 
 NrEesmIrT2::~NrEesmIrT2 ()
@@ -71,7 +71,8 @@ NrEesmIr::ComputeSINR (const SpectrumValue &sinr, const std::vector<int> &map,
       mapSumSize += sinrHistorytemp->m_map.size();
     }
   mapSumSize += map.size();
-  codeBitsSum += sizeBit / GetMcsEcrTable()->at (mcs);;
+  NS_ASSERT (mcs <= m_mcsTable->m_maxMcs);
+  codeBitsSum += sizeBit / m_mcsTable->m_mcsEcr[mcs];
   const_cast<NrEesmIr*> (this)->m_Reff = infoBits / static_cast<double> (codeBitsSum);
 
   NS_LOG_INFO (" Reff " << m_Reff << " HARQ history (previous) " << sinrHistory.size ());
@@ -90,7 +91,10 @@ NrEesmIr::GetMcsEq (uint8_t mcsTx) const
 
   uint8_t mcs_eq = mcsTx;
 
-  uint8_t ModOrder = GetMcsMTable ()->at (mcsTx);
+  NS_ASSERT (mcsTx <= m_mcsTable->m_maxMcs);
+  const uint8_t *mcsM = m_mcsTable->m_mcsM;
+  const double *mcsEcr = m_mcsTable->m_mcsEcr;
+  uint8_t ModOrder = mcsM[mcsTx];
 
   NS_LOG_INFO (" Modulation order: " << +ModOrder );
   NS_LOG_INFO (" Reff: " << m_Reff );
@@ -98,8 +102,8 @@ NrEesmIr::GetMcsEq (uint8_t mcsTx) const
   for (uint8_t mcsindex = (mcsTx-1); mcsindex != 255; mcsindex--)
     // search from MCS=mcs-1 to MCS=0. end at 255 to account for wrap around of uint
     {
-      if ((GetMcsMTable ()->at (mcsindex) == ModOrder) &&
-          (GetMcsEcrTable ()->at (mcsindex) > m_Reff))
+      if ((mcsM[mcsindex] == ModOrder) &&
+          (mcsEcr[mcsindex] > m_Reff))
         {
           mcs_eq--;
         }
@@ -5,24 +5,14 @@ namespace ns3 {
 /**
  * \brief Table of SE of the standard MCSs: 29 (0 to 28) MCSs as per Table1 in TS38.214
  */
-static const std::vector<double> SpectralEfficiencyForMcs1 = {
-  // QPSK (M=2)
-  0.23, 0.31, 0.38, 0.49, 0.6, 0.74, 0.88, 1.03, 1.18, 1.33, // SEs of MCSs
-  // 16QAM (M=4)
-  1.33, 1.48, 1.70, 1.91, 2.16, 2.41, 2.57, // SEs of MCSs
-  // 64QAM (M=6)
-  2.57, 2.73, 3.03, 3.32, 3.61, 3.90, 4.21, 4.52, 4.82, 5.12, 5.33, 5.55  // SEs of MCSs
-};
+static const std::vector<double> SpectralEfficiencyForMcs1 (NrMcsTable1::SpectralEfficiencyForMcs.begin (),
+                                                            NrMcsTable1::SpectralEfficiencyForMcs.end ());
 
 /**
  * \brief Table of SE of the standard CQIs: 16 CQIs as per Table1 in TS38.214
  */
-static const std::vector<double> SpectralEfficiencyForCqi1 = {
-  0.0,     // out of range
-  0.15, 0.23, 0.38, 0.6, 0.88, 1.18,
-  1.48, 1.91, 2.41,
-  2.73, 3.32, 3.9, 4.52, 5.12, 5.55
-};
+static const std::vector<double> SpectralEfficiencyForCqi1 (NrMcsTable1::SpectralEfficiencyForCqi.begin (),
+                                                            NrMcsTable1::SpectralEfficiencyForCqi.end ());
 
 /**
  * \brief SINR to BLER mapping for MCSs in Table1
@@ -8151,37 +8141,21 @@ static const NrEesmErrorModel::SimulatedBlerFromSINR BlerForSinr1 = {
 /**
  * \brief Table of beta values for each standard MCS in Table1 in TS38.214
  */
-static const std::vector<double> BetaTable1 = {
-  1.6, 1.61, 1.63, 1.65, 1.67, 1.7, 1.73, 1.76, 1.79, 1.82,
-  3.97, 4.27, 4.71, 5.16, 5.66, 6.16, 6.5, 9.95, 10.97,
-  12.92, 14.96, 17.06, 19.33, 21.85, 24.51, 27.14, 29.94,
-  32.05, 34.28
-};
+static const std::vector<double> BetaTable1 (NrMcsTable1::Beta.begin (),
+                                             NrMcsTable1::Beta.end ());
 
 /**
  * \brief Table of ECR of the standard MCSs: 29 MCSs as per Table1 in TS38.214
  */
-static const std::vector<double> McsEcrTable1 = {
-  // QPSK (M=2)
-  0.12, 0.15, 0.19, 0.25, 0.30, 0.37, 0.44, 0.51, 0.59, 0.66, // ECRs of MCSs
-  // 16QAM (M=4)
-  0.33, 0.37, 0.42, 0.48, 0.54, 0.60, 0.64, // ECRs of MCSs
-  // 64QAM (M=6)
-  0.43, 0.46, 0.50, 0.55, 0.60, 0.65, 0.70, 0.75, 0.80, 0.85, 0.89, 0.93 // ECRs of MCSs
-};
+static const std::vector<double> McsEcrTable1 (NrMcsTable1::McsEcr.begin (),
+                                               NrMcsTable1::McsEcr.end ());
 
 /**
  * \brief Table of modulation order of the standard MCSs: 29 MCSs as per Table1
  * in TS38.214
  */
-static const std::vector<uint8_t> McsMTable1 = {
-  // QPSK (M=2)
-  2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
-  // 16QAM (M=4)
-  4, 4, 4, 4, 4, 4, 4,
-  // 64QAM (M=6)
-  6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
-};
+static const std::vector<uint8_t> McsMTable1 (NrMcsTable1::McsM.begin (),
+                                              NrMcsTable1::McsM.end ());
 
 NrEesmT1::NrEesmT1 ()
 {
@@ -21,6 +21,7 @@
 
 #include <vector>
 #include "nr-eesm-error-model.h"
+#include "nr-mcs-tables.h"
 
 namespace ns3 {
 
@@ -48,4 +48,10 @@ NrErrorModel::GetInstanceTypeId() const
   return NrErrorModel::GetTypeId ();
 }
 
+const NrMcsTable *
+NrErrorModel::GetMcsTable () const
+{
+  return nullptr;
+}
+
 } // namespace ns3
@@ -21,6 +21,7 @@
 #include <ns3/object.h>
 #include <vector>
 #include <ns3/spectrum-value.h>
+#include "nr-mcs-tables.h"
 
 namespace ns3 {
 
@@ -186,6 +187,18 @@ public:
    * \return the maximum MCS that is permitted with the error model
    */
   virtual uint8_t GetMaxMcs () const = 0;
+
+  /**
+   * \brief Get the MCS and CQI tables of the error model
+   *
+   * The table is fixed when the error model is created, so the users can
+   * get it once and then index it directly in their loops, instead of
+   * calling GetSpectralEfficiencyForMcs/Cqi for every value.
+   *
+   * \return the view of the tables, or nullptr if the error model does not
+   * expose them (the default)
+   */
+  virtual const NrMcsTable * GetMcsTable () const;
 };
 
 } // namespace ns3
@@ -797,12 +797,12 @@ NrGnbMac::DoReceivePhyPdu (Ptr<Packet> p)
 
   NS_ASSERT_MSG (rntiIt != m_rlcAttached.end (), "could not find RNTI" << rnti);
 
-  // Try to peek whatever header; in the first byte there will be the LC ID.
-  NrMacHeaderFsUl header;
-  p->PeekHeader (header);
+  // Whatever the header, in the first byte there will be the LC ID.
+  uint8_t firstByte = 0;
+  p->CopyData (&firstByte, 1);
 
   // Based on LC ID, we know if it is a CE or simply data.
-  if (header.GetLcId () == NrMacHeaderFsUl::SHORT_BSR)
+  if ((firstByte & 0x3F) == NrMacHeaderFsUl::SHORT_BSR)
     {
       NrMacShortBsrCe bsrHeader;
       p->RemoveHeader (bsrHeader); // Really remove the header this time
@@ -824,14 +824,14 @@ NrGnbMac::DoReceivePhyPdu (Ptr<Packet> p)
 
   // Ok, we know it is data, so let's extract and pass to RLC.
 
-  NrMacHeaderVs macHeader;
-  p->RemoveHeader (macHeader);
+  uint8_t lcId;
+  NrMacHeaderVs::RemoveSubheader (p, lcId);
 
-  auto lcidIt = rntiIt->second.find (macHeader.GetLcId ());
+  auto lcidIt = rntiIt->second.find (lcId);
 
   LteMacSapUser::ReceivePduParameters rxParams;
   rxParams.p = p;
-  rxParams.lcid = macHeader.GetLcId ();
+  rxParams.lcid = lcId;
   rxParams.rnti = rnti;
 
   if (rxParams.p->GetSize ())
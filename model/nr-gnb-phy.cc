@@ -33,6 +33,7 @@
 #include <unordered_set>
 
 #include "nr-gnb-phy.h"
+#include "nr-profiler.h"
 #include "nr-ue-phy.h"
 #include "nr-net-device.h"
 #include "nr-ue-net-device.h"
@@ -457,15 +458,48 @@ NrGnbPhy::SetTddPattern (const std::vector<LteNrTddSlotType> &pattern)
 
   m_generateDl.clear ();
   m_generateUl.clear ();
-  m_toSendDl.clear ();
-  m_toSendUl.clear ();
-  m_dlHarqfbPosition.clear ();
 
-  GenerateStructuresFromPattern (pattern, &m_toSendDl, &m_toSendUl,
+  std::map<uint32_t, std::vector<uint32_t>> toSendDl;
+  std::map<uint32_t, std::vector<uint32_t>> toSendUl;
+  std::map<uint32_t, uint32_t> dlHarqfbPosition;
+
+  GenerateStructuresFromPattern (pattern, &toSendDl, &toSendUl,
                                  &m_generateDl, &m_generateUl,
-                                 &m_dlHarqfbPosition, 0,
+                                 &dlHarqfbPosition, 0,
                                  GetN2Delay (), GetN1Delay (),
                                  GetL1L2CtrlLatency ());
+
+  // The structures read in every slot are indexed by the slot of the pattern
+  m_toSendDl.assign (pattern.size (), std::vector<uint32_t> ());
+  m_toSendUl.assign (pattern.size (), std::vector<uint32_t> ());
+  m_dlHarqfbPosition.assign (pattern.size (), 0);
+  for (auto & v : toSendDl)
+    {
+      m_toSendDl.at (v.first) = std::move (v.second);
+    }
+  for (auto & v : toSendUl)
+    {
+      m_toSendUl.at (v.first) = std::move (v.second);
+    }
+  for (const auto & v : dlHarqfbPosition)
+    {
+      m_dlHarqfbPosition.at (v.first) = v.second;
+    }
+
+  // The MAC is asked to schedule at most the farthest K0 or K2 (plus the
+  // L1L2 latency) after the current slot: size the allocation ring for it
+  uint32_t maxDelay = GetL1L2CtrlLatency ();
+  for (const auto & generate : {&m_generateDl, &m_generateUl})
+    {
+      for (const auto & v : *generate)
+        {
+          for (const auto & k : v.second)
+            {
+              maxDelay = std::max (maxDelay, k);
+            }
+        }
+    }
+  ReserveSlotAllocInfo (maxDelay + 1);
 }
 
 void
@@ -688,6 +722,7 @@ void
 NrGnbPhy::StartSlot (const SfnSf &startSlot)
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (GNB_PHY_START_SLOT);
   NS_ASSERT (m_channelStatus != TO_LOSE);
 
   m_currentSlot = startSlot;
@@ -1120,6 +1155,7 @@ NrGnbPhy::RetrieveMsgsFromDCIs (const SfnSf &currentSlot)
 {
   std::list <Ptr<NrControlMessage> > ctrlMsgs;
   uint64_t currentSlotN = currentSlot.Normalize () % m_tddPattern.size ();
+  NS_ASSERT (currentSlotN < m_toSendDl.size ());
 
   uint32_t k1delay = m_dlHarqfbPosition[currentSlotN];
 
@@ -1278,19 +1314,40 @@ NrGnbPhy::UlData(const std::shared_ptr<DciInfoElementTdma> &dci)
 
   Time varTtiPeriod = GetSymbolPeriod () * dci->m_numSym;
 
-  // We do not support MIMO in UL yet. DCI is prepared for stream 0. So, if there is
-  // only one stream, do we need this for loop?
-  uint8_t streamIndex = 0;
+  // Each stream with a TB is received by the NrSpectrumPhy of the same stream
+  uint8_t expectedStreams = 0;
+  for (uint8_t streamIndex = 0; streamIndex < dci->m_tbSize.size (); streamIndex++)
+    {
+      if (dci->m_tbSize.at (streamIndex) > 0)
+        {
+          NS_ABORT_MSG_IF (streamIndex >= m_spectrumPhys.size (),
+                           "UL DCI with a TB for stream " << +streamIndex <<
+                           ", but the gNB has " << m_spectrumPhys.size () << " streams");
+          m_spectrumPhys.at(streamIndex)->AddExpectedTb (dci->m_rnti, dci->m_ndi.at (streamIndex),
+                                                         dci->m_tbSize.at (streamIndex),
+                                                         dci->m_mcs.at (streamIndex),
+                                                         FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask),
+                                                         dci->m_harqProcess, dci->m_rv.at (streamIndex), false,
+                                                         dci->m_symStart, dci->m_numSym, m_currentSlot);
+          expectedStreams++;
+        }
+    }
 
-  if (dci->m_tbSize.at (streamIndex) > 0)
+  // The HARQ feedback of a multi-stream transmission is forwarded to the
+  // scheduler once all the streams have been decoded. A left-over entry of a
+  // previous transmission of the same process (e.g., a TB never received) is
+  // overwritten.
+  auto harqKey = std::make_pair (dci->m_rnti, dci->m_harqProcess);
+  if (expectedStreams > 1)
     {
-      m_spectrumPhys.at(streamIndex)->AddExpectedTb (dci->m_rnti, dci->m_ndi.at (streamIndex),
-                                                        dci->m_tbSize.at (streamIndex),
-                                                        dci->m_mcs.at (streamIndex),
-                                                        FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask),
-                                                        dci->m_harqProcess, dci->m_rv.at (streamIndex), false,
-                                                        dci->m_symStart, dci->m_numSym, m_currentSlot);
-     }
+      UlHarqMerge merge;
+      merge.m_pendingStreams = expectedStreams;
+      m_ulHarqMerge[harqKey] = merge;
+    }
+  else
+    {
+      m_ulHarqMerge.erase (harqKey);
+    }
 
   bool found = false;
   for (uint8_t i = 0; i < m_deviceMap.size (); i++)
@@ -1573,11 +1630,27 @@ NrGnbPhy::GenerateDataCqiReport (const SpectrumValue& sinr, uint8_t streamId) co
   // not known to the scheduler when m_allocationMap gets populated
   ulcqi.m_sfnSf = m_currentSlot;
   ulcqi.m_symStart = m_currSymStart;
+  ulcqi.m_streamId = streamId;
   SpectrumValue newSinr = sinr;
   m_ulSinrTrace (0, newSinr, newSinr);
   m_phySapUser->UlCqiReport (ulcqi);
 }
 
+void
+NrGnbPhy::GenerateSrsCqiReport (const SpectrumValue& sinr, uint16_t rnti, uint8_t streamId) const
+{
+  NS_LOG_FUNCTION (this << rnti << +streamId);
+
+  NrMacSchedSapProvider::SchedUlCqiInfoReqParameters ulcqi;
+  ulcqi.m_ulCqi.m_type = UlCqiInfo::SRS;
+  ulcqi.m_ulCqi.m_sinr.assign (sinr.ConstValuesBegin (), sinr.ConstValuesEnd ());
+  ulcqi.m_sfnSf = m_currentSlot;
+  ulcqi.m_symStart = m_currSymStart;
+  ulcqi.m_rnti = rnti;
+  ulcqi.m_streamId = streamId;
+  m_phySapUser->UlCqiReport (ulcqi);
+}
+
 
 void
 NrGnbPhy::PhyCtrlMessagesReceived (const Ptr<NrControlMessage> &msg)
@@ -1722,12 +1795,50 @@ void
 NrGnbPhy::ReportUlHarqFeedback (const UlHarqInfo &mes)
 {
   NS_LOG_FUNCTION (this);
+
+  UlHarqInfo feedback = mes;
+  auto it = m_ulHarqMerge.find (std::make_pair (mes.m_rnti, mes.m_harqProcessId));
+  if (it != m_ulHarqMerge.end ())
+    {
+      UlHarqInfo &merged = it->second.m_harqInfo;
+      if (merged.m_receptionStatusPerStream.empty ())
+        {
+          merged = mes;
+          merged.m_receptionStatusPerStream.resize (m_spectrumPhys.size (), UlHarqInfo::NotValid);
+        }
+      else
+        {
+          for (uint8_t stream = 0; stream < mes.m_receptionStatusPerStream.size (); stream++)
+            {
+              if (mes.m_receptionStatusPerStream.at (stream) != UlHarqInfo::NotValid)
+                {
+                  merged.m_receptionStatusPerStream.at (stream) = mes.m_receptionStatusPerStream.at (stream);
+                }
+            }
+          if (mes.m_receptionStatus == UlHarqInfo::NotOk)
+            {
+              merged.m_receptionStatus = UlHarqInfo::NotOk;
+            }
+          merged.m_numRetx = std::max (merged.m_numRetx, mes.m_numRetx);
+        }
+
+      NS_ASSERT (it->second.m_pendingStreams > 0);
+      if (--it->second.m_pendingStreams > 0)
+        {
+          NS_LOG_INFO ("Waiting for the UL HARQ feedback of " << +it->second.m_pendingStreams <<
+                       " more streams of UE " << mes.m_rnti);
+          return;
+        }
+      feedback = merged;
+      m_ulHarqMerge.erase (it);
+    }
+
   // forward to scheduler
-  if (m_ueAttachedRnti.find (mes.m_rnti) != m_ueAttachedRnti.end ())
+  if (m_ueAttachedRnti.find (feedback.m_rnti) != m_ueAttachedRnti.end ())
     {
-      NS_LOG_INFO ("Received UL HARQ feedback " << mes.IsReceivedOk() <<
+      NS_LOG_INFO ("Received UL HARQ feedback " << feedback.IsReceivedOk() <<
                    " and forwarding to the scheduler");
-      m_phySapUser->UlHarqFeedback (mes);
+      m_phySapUser->UlHarqFeedback (feedback);
     }
 }
 
@@ -255,6 +255,16 @@ public:
    */
   void GenerateDataCqiReport (const SpectrumValue& sinr, uint8_t streamId) const;
 
+  /**
+   * \brief Send to the MAC the SINR of a SRS received in one stream
+   * \param sinr the SINR of the SRS
+   * \param rnti the RNTI of the UE that sent the SRS
+   * \param streamId the index of the stream
+   *
+   * The scheduler uses the per-stream SRS SINR to select the UL rank.
+   */
+  void GenerateSrsCqiReport (const SpectrumValue& sinr, uint16_t rnti, uint8_t streamId) const;
+
   /**
    * \brief Receive a list of CTRL messages
    *
@@ -281,7 +291,9 @@ public:
    * \brief Get the HARQ feedback from NrSpectrumPhy
    * and forward it to the scheduler
    *
-   * Connected by the helper to a spectrum phy callback
+   * Connected by the helper to a spectrum phy callback. With UL MIMO, each
+   * NrSpectrumPhy reports the feedback of its own stream: the feedback is
+   * forwarded once all the streams of the HARQ process have been received.
    *
    * \param mes the HARQ feedback
    */
@@ -748,12 +760,22 @@ private:
 
   TracedCallback<const SfnSf &, uint8_t, const std::vector<int>&, uint16_t, uint16_t> m_rbStatistics;
 
-  std::map<uint32_t, std::vector<uint32_t>> m_toSendDl; //!< Map that indicates, for each slot, what DL DCI we have to send
-  std::map<uint32_t, std::vector<uint32_t>> m_toSendUl; //!< Map that indicates, for each slot, what UL DCI we have to send
+  std::vector<std::vector<uint32_t>> m_toSendDl; //!< For each slot of the pattern, what DL DCI we have to send
+  std::vector<std::vector<uint32_t>> m_toSendUl; //!< For each slot of the pattern, what UL DCI we have to send
   std::map<uint32_t, std::vector<uint32_t>> m_generateUl; //!< Map that indicates, for each slot, what UL DCI we have to generate
   std::map<uint32_t, std::vector<uint32_t>> m_generateDl; //!< Map that indicates, for each slot, what DL DCI we have to generate
 
-  std::map<uint32_t, uint32_t> m_dlHarqfbPosition; //!< Map that indicates, for each DL slot, where the UE has to send the Harq Feedback
+  std::vector<uint32_t> m_dlHarqfbPosition; //!< For each slot of the pattern, where the UE has to send the Harq Feedback of a DL slot
+
+  /**
+   * \brief UL HARQ feedback of a multi-stream transmission, merged across streams
+   */
+  struct UlHarqMerge
+  {
+    UlHarqInfo m_harqInfo;          //!< Feedback merged so far
+    uint8_t m_pendingStreams {0};   //!< Number of streams whose feedback is missing
+  };
+  std::map<std::pair<uint16_t, uint8_t>, UlHarqMerge> m_ulHarqMerge; //!< Multi-stream UL HARQ feedback being merged, per RNTI and HARQ process
 
   /**
    * \brief Status of the channel for the PHY
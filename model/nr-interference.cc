@@ -183,15 +183,37 @@ NrInterference::NiChange::operator < (const NrInterference::NiChange& o) const
   return (m_time < o.m_time);
 }
 
+void
+NrInterference::UpdateFirstPower ()
+{
+  Time now = Simulator::Now ();
+  while (!m_niChanges.empty () && m_niChanges.front ().GetTime () <= now)
+    {
+      m_firstPower += m_niChanges.front ().GetDelta ();
+      m_niChanges.pop_front ();
+    }
+  if (m_niChanges.empty () || m_firstPower < 0.0)
+    {
+      // No signal is active: remove the rounding errors of the sums and
+      // differences
+      m_firstPower = 0.0;
+    }
+}
+
+double
+NrInterference::GetEnergyNow ()
+{
+  UpdateFirstPower ();
+  return m_firstPower;
+}
+
 bool
 NrInterference::IsChannelBusyNow (double energyW)
 {
-  double detectedPowerW = Integral (*m_allSignals);
-  double powerDbm = 10 * log10 (detectedPowerW * 1000);
+  double detectedPowerW = GetEnergyNow ();
 
-  NS_LOG_INFO("IsChannelBusyNow detected power is: "<<powerDbm <<
-              "  detectedPowerW: "<< detectedPowerW << " length spectrum: "<< 
-              (*m_allSignals).GetValuesN() <<" thresholdW:"<< energyW);
+  NS_LOG_INFO ("IsChannelBusyNow detected power is: " << 10 * log10 (detectedPowerW * 1000) <<
+               "  detectedPowerW: " << detectedPowerW << " thresholdW:" << energyW);
 
   if (detectedPowerW > energyW)
     {
@@ -205,6 +227,12 @@ NrInterference::IsChannelBusyNow (double energyW)
     }
 }
 
+size_t
+NrInterference::GetNumEnergyChanges () const
+{
+  return m_niChanges.size ();
+}
+
 Time
 NrInterference::GetEnergyDuration (double energyW)
 {
@@ -213,35 +241,30 @@ NrInterference::GetEnergyDuration (double energyW)
       return Seconds (0);
     }
 
+  // All the events in the list are in the future
   Time now = Simulator::Now ();
-  double noiseInterferenceW = 0.0;
+  double noiseInterferenceW = m_firstPower;
   Time end = now;
-  noiseInterferenceW = m_firstPower;
 
-  NS_LOG_INFO("First power: " << m_firstPower);
+  NS_LOG_INFO ("First power: " << m_firstPower);
 
   for (NiChanges::const_iterator i = m_niChanges.begin (); i != m_niChanges.end (); i++)
     {
       noiseInterferenceW += i->GetDelta ();
       end = i->GetTime ();
       NS_LOG_INFO ("Delta: " << i->GetDelta () << "time: " << i->GetTime ());
-      if (end < now)
-        {
-          continue;
-        }
       if (noiseInterferenceW < energyW)
         {
           break;
         }
     }
-    
-  NS_LOG_INFO("Future power dBm:"<<10 * log10 (noiseInterferenceW*1000)<<" W:"<<noiseInterferenceW <<
-  " and energy threshold in W is: "<< energyW);
+
+  NS_LOG_INFO ("Future power dBm:" << 10 * log10 (noiseInterferenceW * 1000) << " W:" << noiseInterferenceW <<
+               " and energy threshold in W is: " << energyW);
 
   if (end > now)
     {
-      NS_LOG_INFO ("Channel BUSY until."<<end);
-
+      NS_LOG_INFO ("Channel BUSY until." << end);
     }
   else
     {
@@ -273,22 +296,14 @@ NrInterference::AddNiChangeEvent (NiChange change)
 void
 NrInterference::AppendEvent (Time startTime, Time endTime, double rxPowerW)
 {
-  Time now = Simulator::Now ();
-  
-  if (!m_receiving)
+  // Move the events that already happened into the total energy, so that
+  // the list only keeps the future ones
+  UpdateFirstPower ();
+
+  if (startTime <= Simulator::Now ())
     {
-      NiChanges::iterator nowIterator = GetPosition (now);
-      // We empty the list until the current moment. To do so we 
-      // first we sum all the energies until the current moment 
-      // and save it in m_firstPower.
-      for (NiChanges::iterator i = m_niChanges.begin (); i != nowIterator; i++)
-        {
-          m_firstPower += i->GetDelta ();
-        }
-      // then we remove all the events up to the current moment
-      m_niChanges.erase (m_niChanges.begin (), nowIterator);
-      // we create an event that represents the new energy
-      m_niChanges.insert (m_niChanges.begin (), NiChange (startTime, rxPowerW));
+      // the energy starts now: add it directly to the total
+      m_firstPower += rxPowerW;
     }
   else
     {
@@ -301,5 +316,3 @@ NrInterference::AppendEvent (Time startTime, Time endTime, double rxPowerW)
 }
 
 } // namespace ns3
-
-
@@ -26,6 +26,7 @@
 #include <ns3/nstime.h>
 #include <ns3/spectrum-value.h>
 #include <string.h>
+#include <deque>
 #include <ns3/trace-source-accessor.h>
 #include <ns3/traced-callback.h>
 #include <ns3/vector.h>
@@ -67,6 +68,10 @@ public:
    * \brief Checks if the sum of the energy, including the energies that start
    * at this moment is greater than provided energy detection threshold.
    * If yes it returns true, otherwise false.
+   *
+   * The total energy is maintained incrementally when the signals start and
+   * end, hence the check does not depend on the number of active signals.
+   *
    * \param energyW energy detection threshold used to evaluate if the channel
    * is busy
    * \return Returns true if the energy is above provided threshold. Otherwise
@@ -74,6 +79,12 @@ public:
    */
   bool IsChannelBusyNow (double energyW);
 
+  /**
+   * \brief Get the total energy received at this moment
+   * \return the sum of the power, in Watts, of the signals active now
+   */
+  double GetEnergyNow ();
+
   /**
    * \brief Returns the duration of the energy that is above the energy
    * provided detection threshold
@@ -84,12 +95,19 @@ public:
    */
   Time GetEnergyDuration (double energyW);
 
+  /**
+   * \brief Get the number of future changes of the energy, i.e., the start
+   * and the end of the signals being tracked
+   * \return the number of energy changes
+   */
+  size_t GetNumEnergyChanges () const;
+
   /**
   * \brief Crates events corresponding to the new energy. One event corresponds
   * to the moment when the energy starts, and another to the moment that energy
   * ends and in that event the energy is negative, or it is being substracted.
-  * This function also updates the list of events, i.e. it removed the events
-  * belonging to the signals that have finished.
+  * This function also updates the list of events, i.e. it moves the events
+  * that already happened into the total energy.
   * \param startTime Energy start time
   * \param endTime Energy end time
   * \param rxPowerW Power of the energy in Watts
@@ -144,9 +162,10 @@ private:
         double m_delta;
     };
    /**
-    * typedef for a vector of NiChanges
+    * typedef for a deque of NiChanges, so that the events that already
+    * happened are removed from the front in constant time
     */
-  typedef std::vector <NiChange> NiChanges;
+  typedef std::deque <NiChange> NiChanges;
 
   /**
    * \brief Find a position in event list that corresponds to a given
@@ -169,6 +188,15 @@ private:
    */
   void AddNiChangeEvent (NiChange change);
 
+  /**
+   * \brief Add to m_firstPower the events that happened until now, and remove
+   * them from the list
+   *
+   * Each event is visited once, when it happens, hence the cost of keeping
+   * the total energy is constant per signal.
+   */
+  void UpdateFirstPower ();
+
 protected:
 
   /**
@@ -180,8 +208,8 @@ protected:
   TracedCallback<double> m_rssiPerProcessedChunk; ///<! Trace for RSSI pre processed chunk.
 
   /// Used for energy duration calculation, inspired by wifi/model/interference-helper implementation
-  NiChanges m_niChanges; //!< List of events in which there is some change in the energy
-  double m_firstPower; //!< This contains the accumulated sum of the energy events until the certain moment it has been calculated
+  NiChanges m_niChanges; //!< List of the future events in which there is some change in the energy
+  double m_firstPower; //!< This contains the accumulated sum of the energy events until the last update, i.e., the energy received now
 
 
 };
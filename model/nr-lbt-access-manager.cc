@@ -0,0 +1,428 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-lbt-access-manager.h"
+#include "nr-spectrum-phy.h"
+#include "nr-gnb-mac.h"
+#include "nr-ue-mac.h"
+#include "nr-phy-mac-common.h"
+#include <ns3/log.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/simulator.h>
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrLbtAccessManager");
+NS_OBJECT_ENSURE_REGISTERED (NrLbtAccessManager);
+
+/**
+ * \brief Parameters of a channel access priority class (TS 37.213)
+ */
+struct LbtPriorityClassParams
+{
+  uint8_t mp;          //!< CCA slots of the defer duration
+  uint32_t cwMin;      //!< Minimum CW
+  uint32_t cwMax;      //!< Maximum CW
+  uint32_t mcotMs;     //!< MCOT, in ms
+};
+
+//! Table 4.1.1-1 of TS 37.213 (gNB), indexed by priority class - 1
+static const LbtPriorityClassParams g_dlPriorityClass[4] = {
+  {1, 3, 7, 2},
+  {1, 7, 15, 3},
+  {3, 15, 63, 8},
+  {7, 15, 1023, 8}
+};
+
+//! Table 4.2.1-1 of TS 37.213 (UE), indexed by priority class - 1
+static const LbtPriorityClassParams g_ulPriorityClass[4] = {
+  {2, 3, 7, 2},
+  {2, 7, 15, 4},
+  {3, 15, 1023, 6},
+  {7, 15, 1023, 6}
+};
+
+//! Ratio of NACK in the feedback of a COT that makes the CW grow (TS 37.213 4.1.4.2)
+static const double NACK_RATIO = 0.8;
+
+TypeId
+NrLbtAccessManager::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrLbtAccessManager")
+    .SetParent<NrChAccessManager> ()
+    .SetGroupName ("nr")
+    .AddConstructor <NrLbtAccessManager> ()
+    .AddAttribute ("PriorityClass",
+                   "The channel access priority class, from 1 (highest priority) to 4",
+                   UintegerValue (3),
+                   MakeUintegerAccessor (&NrLbtAccessManager::SetPriorityClass,
+                                         &NrLbtAccessManager::GetPriorityClass),
+                   MakeUintegerChecker<uint8_t> (1, 4))
+    .AddAttribute ("UplinkTable",
+                   "Use the priority class table of the UE (TS 37.213 Table 4.2.1-1) "
+                   "instead of the gNB one (Table 4.1.1-1)",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrLbtAccessManager::SetUplinkTable,
+                                        &NrLbtAccessManager::GetUplinkTable),
+                   MakeBooleanChecker ())
+    .AddAttribute ("CotSharing",
+                   "Grant immediately, for the rest of the COT, the requests received "
+                   "while the COT of the last grant is running",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NrLbtAccessManager::m_cotSharing),
+                   MakeBooleanChecker ())
+    .AddAttribute ("MaxCwMaxCount",
+                   "Number of times in a row CWmax can be used before resetting the CW to CWmin",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&NrLbtAccessManager::m_maxCwMaxCount),
+                   MakeUintegerChecker<uint32_t> (1))
+    .AddTraceSource ("Cw",
+                     "The contention window",
+                     MakeTraceSourceAccessor (&NrLbtAccessManager::m_cw),
+                     "ns3::TracedValueCallback::Uint32")
+    .AddTraceSource ("ChannelGranted",
+                     "The duration of each channel grant",
+                     MakeTraceSourceAccessor (&NrLbtAccessManager::m_grantTrace),
+                     "ns3::Time::TracedCallback")
+  ;
+  return tid;
+}
+
+NrLbtAccessManager::NrLbtAccessManager () : NrChAccessManager ()
+{
+  NS_LOG_FUNCTION (this);
+  m_backoffRv = CreateObject<UniformRandomVariable> ();
+}
+
+NrLbtAccessManager::~NrLbtAccessManager ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NrLbtAccessManager::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_lbtEvent.Cancel ();
+  m_accessGrantedCb.clear ();
+  m_backoffRv = nullptr;
+  NrChAccessManager::DoDispose ();
+}
+
+void
+NrLbtAccessManager::SetPriorityClass (uint8_t priorityClass)
+{
+  NS_LOG_FUNCTION (this << +priorityClass);
+  NS_ABORT_MSG_IF (priorityClass < 1 || priorityClass > 4,
+                   "Invalid channel access priority class " << +priorityClass);
+  m_priorityClass = priorityClass;
+  UpdatePriorityClassParameters ();
+}
+
+uint8_t
+NrLbtAccessManager::GetPriorityClass () const
+{
+  return m_priorityClass;
+}
+
+void
+NrLbtAccessManager::SetUplinkTable (bool uplinkTable)
+{
+  NS_LOG_FUNCTION (this << uplinkTable);
+  m_uplinkTable = uplinkTable;
+  UpdatePriorityClassParameters ();
+}
+
+bool
+NrLbtAccessManager::GetUplinkTable () const
+{
+  return m_uplinkTable;
+}
+
+void
+NrLbtAccessManager::UpdatePriorityClassParameters ()
+{
+  const LbtPriorityClassParams &params = m_uplinkTable ? g_ulPriorityClass[m_priorityClass - 1]
+                                                       : g_dlPriorityClass[m_priorityClass - 1];
+  m_mp = params.mp;
+  m_cwMin = params.cwMin;
+  m_cwMax = params.cwMax;
+  m_mcot = MilliSeconds (params.mcotMs);
+  m_cw = m_cwMin;
+  m_cwMaxCount = 0;
+  NS_LOG_INFO ("Priority class " << +m_priorityClass << " m_p " << +m_mp << " CWmin " << m_cwMin
+               << " CWmax " << m_cwMax << " MCOT " << m_mcot.As (Time::MS));
+}
+
+uint32_t
+NrLbtAccessManager::GetCw () const
+{
+  return m_cw;
+}
+
+NrLbtAccessManager::LbtState
+NrLbtAccessManager::GetLbtState () const
+{
+  return m_state;
+}
+
+Time
+NrLbtAccessManager::GetDeferDuration () const
+{
+  return MicroSeconds (DEFER_BASE_US + m_mp * CCA_SLOT_US);
+}
+
+int64_t
+NrLbtAccessManager::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  m_backoffRv->SetStream (stream);
+  return 1;
+}
+
+void
+NrLbtAccessManager::RequestAccess ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_state != IDLE)
+    {
+      NS_LOG_INFO ("LBT already in progress, ignoring the request");
+      return;
+    }
+
+  if (m_cotSharing && m_cotEnd > Simulator::Now ())
+    {
+      NS_LOG_INFO ("Request inside the running COT, granting the rest of it");
+      Grant (m_cotEnd - Simulator::Now ());
+      return;
+    }
+
+  UpdateCw ();
+  m_backoff = m_backoffRv->GetInteger (0, m_cw);
+  NS_LOG_INFO ("Starting LBT with CW " << m_cw << " and backoff " << m_backoff);
+  StartDefer ();
+}
+
+void
+NrLbtAccessManager::SetAccessGrantedCallback (const AccessGrantedCallback &cb)
+{
+  NS_LOG_FUNCTION (this);
+  m_accessGrantedCb.push_back (cb);
+}
+
+void
+NrLbtAccessManager::SetAccessDeniedCallback ([[maybe_unused]] const AccessDeniedCallback &cb)
+{
+  NS_LOG_FUNCTION (this);
+  // Don't store it: the procedure goes on until the channel is granted
+}
+
+void
+NrLbtAccessManager::Cancel ()
+{
+  NS_LOG_FUNCTION (this);
+  m_lbtEvent.Cancel ();
+  m_state = IDLE;
+}
+
+void
+NrLbtAccessManager::SetNrGnbMac (Ptr<NrGnbMac> mac)
+{
+  NS_LOG_FUNCTION (this);
+  NrChAccessManager::SetNrGnbMac (mac);
+  mac->TraceConnectWithoutContext ("DlHarqFeedback",
+                                   MakeCallback (&NrLbtAccessManager::DlHarqFeedback, this));
+}
+
+void
+NrLbtAccessManager::SetNrUeMac (Ptr<NrUeMac> mac)
+{
+  NS_LOG_FUNCTION (this);
+  NrChAccessManager::SetNrUeMac (mac);
+  mac->TraceConnectWithoutContext ("UlHarqFeedback",
+                                   MakeCallback (&NrLbtAccessManager::UlHarqFeedback, this));
+}
+
+void
+NrLbtAccessManager::NotifyHarqFeedback (bool nack)
+{
+  NS_LOG_FUNCTION (this << nack);
+  if (nack)
+    {
+      ++m_harqNack;
+    }
+  else
+    {
+      ++m_harqAck;
+    }
+}
+
+void
+NrLbtAccessManager::DlHarqFeedback (const DlHarqInfo &info)
+{
+  NS_LOG_FUNCTION (this);
+  for (const auto &status : info.m_harqStatus)
+    {
+      if (status != DlHarqInfo::NONE)
+        {
+          NotifyHarqFeedback (status == DlHarqInfo::NACK);
+        }
+    }
+}
+
+void
+NrLbtAccessManager::UlHarqFeedback (uint8_t harqId, uint8_t stream, bool nack)
+{
+  NS_LOG_FUNCTION (this << +harqId << +stream << nack);
+  NotifyHarqFeedback (nack);
+}
+
+void
+NrLbtAccessManager::UpdateCw ()
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t total = m_harqAck + m_harqNack;
+  if (total > 0)
+    {
+      if (m_harqNack >= NACK_RATIO * total)
+        {
+          if (m_cw == m_cwMax)
+            {
+              ++m_cwMaxCount;
+              if (m_cwMaxCount >= m_maxCwMaxCount)
+                {
+                  NS_LOG_INFO ("CWmax used " << m_cwMaxCount << " times, resetting the CW");
+                  m_cw = m_cwMin;
+                  m_cwMaxCount = 0;
+                }
+            }
+          else
+            {
+              m_cw = std::min<uint32_t> (2 * (m_cw + 1) - 1, m_cwMax);
+            }
+        }
+      else
+        {
+          m_cw = m_cwMin;
+          m_cwMaxCount = 0;
+        }
+      NS_LOG_INFO ("ACK " << m_harqAck << " NACK " << m_harqNack << ", CW is now " << m_cw);
+    }
+  m_harqAck = 0;
+  m_harqNack = 0;
+}
+
+bool
+NrLbtAccessManager::IsChannelBusy ()
+{
+  NS_ASSERT_MSG (GetNrSpectrumPhy () != nullptr, "The LBT needs a spectrum phy to sense the channel");
+  return GetNrSpectrumPhy ()->IsChannelBusyNow ();
+}
+
+void
+NrLbtAccessManager::StartDefer ()
+{
+  NS_LOG_FUNCTION (this);
+  m_state = DEFER;
+
+  NS_ASSERT_MSG (GetNrSpectrumPhy () != nullptr, "The LBT needs a spectrum phy to sense the channel");
+  Time busy = GetNrSpectrumPhy ()->GetChannelBusyDuration ();
+  if (busy.IsStrictlyPositive ())
+    {
+      // Jump to the end of the busy period instead of sensing each slot
+      NS_LOG_INFO ("Channel busy for " << busy.As (Time::US));
+      m_lbtEvent = Simulator::Schedule (busy, &NrLbtAccessManager::StartDefer, this);
+      return;
+    }
+
+  m_deferSlotsLeft = m_mp;
+  m_lbtEvent = Simulator::Schedule (MicroSeconds (DEFER_BASE_US),
+                                    &NrLbtAccessManager::EndDefer, this);
+}
+
+void
+NrLbtAccessManager::EndDefer ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (IsChannelBusy ())
+    {
+      StartDefer ();
+      return;
+    }
+
+  if (m_deferSlotsLeft > 0)
+    {
+      m_deferSlotsLeft = m_deferSlotsLeft - 1;
+      m_lbtEvent = Simulator::Schedule (MicroSeconds (CCA_SLOT_US),
+                                        &NrLbtAccessManager::EndDefer, this);
+      return;
+    }
+
+  if (m_backoff == 0)
+    {
+      Grant (m_mcot);
+      return;
+    }
+
+  m_state = BACKOFF;
+  m_lbtEvent = Simulator::Schedule (MicroSeconds (CCA_SLOT_US),
+                                    &NrLbtAccessManager::EndBackoffSlot, this);
+}
+
+void
+NrLbtAccessManager::EndBackoffSlot ()
+{
+  NS_LOG_FUNCTION (this << m_backoff);
+
+  if (IsChannelBusy ())
+    {
+      // Back to the defer duration, keeping the counter
+      StartDefer ();
+      return;
+    }
+
+  m_backoff = m_backoff - 1;
+  if (m_backoff == 0)
+    {
+      Grant (m_mcot);
+      return;
+    }
+
+  m_lbtEvent = Simulator::Schedule (MicroSeconds (CCA_SLOT_US),
+                                    &NrLbtAccessManager::EndBackoffSlot, this);
+}
+
+void
+NrLbtAccessManager::Grant (const Time &duration)
+{
+  NS_LOG_FUNCTION (this << duration);
+  m_state = IDLE;
+  m_cotEnd = std::max (m_cotEnd, Simulator::Now () + duration);
+  m_grantTrace (duration);
+  for (const auto & cb : m_accessGrantedCb)
+    {
+      cb (duration);
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,252 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NR_LBT_ACCESS_MANAGER_H_
+#define NR_LBT_ACCESS_MANAGER_H_
+
+#include "nr-ch-access-manager.h"
+#include <ns3/random-variable-stream.h>
+#include <ns3/traced-value.h>
+
+namespace ns3 {
+
+struct DlHarqInfo;
+
+/**
+ * \ingroup nru
+ * \brief A Channel access manager that performs the Type 1 (Cat-4) LBT
+ *        of TS 37.213 Sec. 4.1.1 and 4.2.1.1
+ *
+ * When the PHY requests the channel, the manager draws a backoff counter N
+ * uniformly in [0, CW], and then:
+ *
+ * - it waits for the channel to be idle for a defer duration
+ *   Td = 16 us + m_p * 9 us;
+ * - it decrements N for each CCA slot of 9 us in which the channel is idle;
+ *   a busy slot makes it go back to the defer duration, keeping N;
+ * - when N reaches zero, it grants the channel for the maximum channel
+ *   occupancy time (MCOT) of the priority class.
+ *
+ * The channel is sensed through NrSpectrumPhy::IsChannelBusyNow, which
+ * costs O(1) thanks to the incremental energy of NrInterference. When the
+ * channel is busy, the manager does not poll it at every CCA slot, but it
+ * waits until the energy goes below the CCA threshold.
+ *
+ * The priority class (attribute PriorityClass) gives m_p, CWmin, CWmax and
+ * the MCOT as in TS 37.213 Table 4.1.1-1 (gNB) or, if the attribute
+ * UplinkTable is true, Table 4.2.1-1 (UE).
+ *
+ * \section lbt_cw Contention window adaptation
+ *
+ * The CW is updated before drawing a new backoff counter, with the HARQ
+ * feedback of the transmissions of the last COT: if at least 80 % of them
+ * are NACK, the CW grows to the next allowed value (2 * (CW + 1) - 1, up to
+ * CWmax); otherwise, it goes back to CWmin. After being used
+ * MaxCwMaxCount times in a row, CWmax is reset to CWmin. On the gNB, the
+ * feedback comes from the DlHarqFeedback trace of NrGnbMac; on the UE, from
+ * the UlHarqFeedback trace of NrUeMac, which reports the NDI of the UL DCI
+ * that follows each transmission of a HARQ process.
+ *
+ * \section lbt_cot COT sharing
+ *
+ * If the attribute CotSharing is true, a request received while the COT
+ * acquired by the last grant is still running is granted immediately for
+ * the rest of the COT, as the transmissions in a shared COT only need a
+ * short (Type 2) LBT.
+ *
+ * \section lbt_usage Usage
+ *
+\verbatim
+  nrHelper->SetGnbChannelAccessManagerTypeId (NrLbtAccessManager::GetTypeId());
+  nrHelper->SetUeChannelAccessManagerTypeId (NrLbtAccessManager::GetTypeId());
+  nrHelper->SetGnbChannelAccessManagerAttribute ("PriorityClass", UintegerValue (3));
+\endverbatim
+ *
+ * The spectrum phy should work in unlicensed mode, so that its CCA
+ * threshold is the one of NR-U.
+ */
+class NrLbtAccessManager : public NrChAccessManager
+{
+public:
+  /**
+   * \brief Get the type ID
+   * \return the type id
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief NrLbtAccessManager constructor
+   */
+  NrLbtAccessManager ();
+  /**
+   * \brief destructor
+   */
+  ~NrLbtAccessManager () override;
+
+  /**
+   * \brief State of the LBT procedure
+   */
+  enum LbtState
+  {
+    IDLE = 0,  //!< No request in progress
+    DEFER,     //!< Waiting for the defer duration
+    BACKOFF    //!< Counting down the backoff slots
+  };
+
+  // inherited
+  virtual void RequestAccess () override;
+  virtual void SetAccessGrantedCallback (const AccessGrantedCallback &cb) override;
+  virtual void SetAccessDeniedCallback (const AccessDeniedCallback &cb) override;
+  virtual void Cancel () override;
+  virtual void SetNrGnbMac (Ptr<NrGnbMac> mac) override;
+  virtual void SetNrUeMac (Ptr<NrUeMac> mac) override;
+
+  /**
+   * \brief Notify the HARQ feedback of a transmission done in a COT
+   * \param nack true if the transmission was not decoded
+   */
+  void NotifyHarqFeedback (bool nack);
+
+  /**
+   * \brief Set the channel access priority class
+   * \param priorityClass the class, from 1 (highest priority) to 4
+   */
+  void SetPriorityClass (uint8_t priorityClass);
+  /**
+   * \brief Use the priority class table of the UE instead of the gNB one
+   * \param uplinkTable true for the UE table
+   */
+  void SetUplinkTable (bool uplinkTable);
+  /**
+   * \brief Check if the priority class table of the UE is used
+   * \return true if the UE table is used
+   */
+  bool GetUplinkTable () const;
+  /**
+   * \brief Get the channel access priority class
+   * \return the priority class
+   */
+  uint8_t GetPriorityClass () const;
+
+  /**
+   * \brief Get the current contention window
+   * \return the CW
+   */
+  uint32_t GetCw () const;
+  /**
+   * \brief Get the state of the LBT procedure
+   * \return the state
+   */
+  LbtState GetLbtState () const;
+
+  /**
+   * \brief Get the defer duration of the priority class
+   * \return 16 us + m_p * 9 us
+   */
+  Time GetDeferDuration () const;
+
+  /**
+   * \brief Update the CW with the HARQ feedback collected since the last
+   *        grant, and reset the collected feedback
+   */
+  void UpdateCw ();
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  int64_t AssignStreams (int64_t stream);
+
+  static const uint32_t CCA_SLOT_US = 9;    //!< The duration of a CCA slot, in us
+  static const uint32_t DEFER_BASE_US = 16; //!< The fixed part of the defer duration, in us
+
+protected:
+  virtual void DoDispose () override;
+
+private:
+  /**
+   * \brief Set the parameters of the priority class from the table of
+   *        TS 37.213 of the gNB or the UE
+   */
+  void UpdatePriorityClassParameters ();
+  /**
+   * \brief Start (or restart) the defer duration, once the channel is idle
+   */
+  void StartDefer ();
+  /**
+   * \brief End of the defer duration: if the channel was idle, start the
+   *        backoff, otherwise restart the defer duration
+   */
+  void EndDefer ();
+  /**
+   * \brief End of a backoff CCA slot
+   */
+  void EndBackoffSlot ();
+  /**
+   * \brief Grant the channel to the PHY
+   * \param duration the duration of the grant
+   */
+  void Grant (const Time &duration);
+  /**
+   * \brief Check the channel in a CCA slot
+   * \return true if the channel is busy
+   */
+  bool IsChannelBusy ();
+  /**
+   * \brief Receive the DL HARQ feedback from the gNB MAC
+   * \param info the DL HARQ feedback
+   */
+  void DlHarqFeedback (const DlHarqInfo &info);
+  /**
+   * \brief Receive the outcome of an UL HARQ transmission from the UE MAC
+   * \param harqId the HARQ process ID
+   * \param stream the stream of the TB
+   * \param nack true if the TB has to be retransmitted
+   */
+  void UlHarqFeedback (uint8_t harqId, uint8_t stream, bool nack);
+
+  uint8_t m_priorityClass {3};          //!< Channel access priority class
+  uint8_t m_mp {3};                     //!< Number of CCA slots in the defer duration
+  uint32_t m_cwMin {15};                //!< Minimum CW of the priority class
+  uint32_t m_cwMax {63};                //!< Maximum CW of the priority class
+  Time m_mcot {MilliSeconds (8)};       //!< Maximum channel occupancy time of the priority class
+  bool m_cotSharing {true};             //!< Grant the requests received in a running COT
+  bool m_uplinkTable {false};           //!< Use the UE table of the priority classes
+  uint32_t m_maxCwMaxCount {1};         //!< Times CWmax can be used in a row before the reset
+
+  TracedValue<uint32_t> m_cw {15};      //!< Current contention window
+  uint32_t m_cwMaxCount {0};            //!< Times CWmax has been used in a row
+  uint32_t m_backoff {0};               //!< Backoff counter N
+  uint32_t m_deferSlotsLeft {0};        //!< CCA slots still to sense in the defer duration
+  LbtState m_state {IDLE};              //!< State of the procedure
+  Time m_cotEnd {Seconds (0)};          //!< End of the COT of the last grant
+  uint32_t m_harqAck {0};               //!< ACKs received since the last grant
+  uint32_t m_harqNack {0};              //!< NACKs received since the last grant
+  EventId m_lbtEvent;                   //!< Next event of the procedure
+  Ptr<UniformRandomVariable> m_backoffRv; //!< Random variable for the backoff counter
+  std::vector<AccessGrantedCallback> m_accessGrantedCb; //!< Access granted CB
+  TracedCallback<Time> m_grantTrace;    //!< Trace of the duration of each grant
+};
+
+} // namespace ns3
+
+#endif /* NR_LBT_ACCESS_MANAGER_H_ */
@@ -20,6 +20,7 @@
 #include <algorithm>
 #include <ns3/log.h>
 #include "nr-lte-mi-error-model.h"
+#include "nr-profiler.h"
 
 namespace ns3 {
 
@@ -306,6 +307,16 @@ static const uint8_t ModulationSchemeForMcs[32] = {
   6,      // reserved
 };
 
+// View of the LTE tables, for NrErrorModel::GetMcsTable
+static const NrMcsTable LteMiMcsTable = {
+  NrMcsTable::LTE_MI, 28,
+  SpectralEfficiencyForMcs,
+  SpectralEfficiencyForCqi,
+  McsEcrTable,
+  ModulationSchemeForMcs,
+  nullptr
+};
+
 NrLteMiErrorModel::NrLteMiErrorModel () : NrErrorModel ()
 {
   NS_LOG_FUNCTION (this);
@@ -485,6 +496,7 @@ NrLteMiErrorModel::GetTbBitDecodificationStats (const SpectrumValue& sinr,
                                                 const NrErrorModel::NrErrorModelHistory &history)
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (ERROR_MODEL);
   NS_ABORT_MSG_IF (mcs > GetMaxMcs (),
                    "MiErrorModel only works with MCS <= 28");
 
@@ -691,5 +703,11 @@ NrLteMiErrorModel::GetMaxMcs () const
   return 28;
 }
 
+const NrMcsTable *
+NrLteMiErrorModel::GetMcsTable () const
+{
+  return &LteMiMcsTable;
+}
+
 } // namespace ns3
 
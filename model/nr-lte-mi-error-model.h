@@ -126,6 +126,10 @@ public:
    */
   virtual uint32_t GetMaxCbSize (uint32_t tbSize, uint8_t mcs) const override;
   virtual uint8_t GetMaxMcs () const override;
+  /**
+   * \brief Get the view of the LTE MCS and CQI tables
+   */
+  virtual const NrMcsTable * GetMcsTable () const override;
 
 private:
   /**
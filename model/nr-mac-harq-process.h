@@ -36,7 +36,7 @@ namespace ns3 {
  * as well as the RLC PDU.
  *
  * The HarqProcess will be stored inside the class NrMacHarqVector, which
- * is a unordered map that maps the HARQ ID with the HARQ content (this struct).
+ * is a fixed-size array that maps the HARQ ID with the HARQ content (this struct).
  */
 struct HarqProcess
 {
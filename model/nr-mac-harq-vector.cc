@@ -18,23 +18,20 @@
  */
 #include "nr-mac-harq-vector.h"
 
+#include <bitset>
+
 namespace ns3 {
 
 bool
 NrMacHarqVector::Erase (uint8_t id)
 {
-  at (id).Erase ();
+  NS_ASSERT (Exist (id));
+  NS_ASSERT (m_activeMask & (1u << id));
+  m_processes[id].second.Erase ();
+  m_activeMask &= ~(1u << id);
   --m_usedSize;
 
-  uint32_t count = 0;
-  for (const auto & v : *this)
-    {
-      if (v.second.m_active)
-        {
-          ++count;
-        }
-    }
-  NS_ASSERT (count == m_usedSize);
+  NS_ASSERT (std::bitset<32> (m_activeMask).count () == m_usedSize);
   return true;
 }
 
@@ -54,10 +51,11 @@ NrMacHarqVector::Insert (uint8_t *id, const HarqProcess& element)
       return false;
     }
 
-  NS_ABORT_IF (at (*id).m_active == true);
-  at (*id) = element;
+  NS_ABORT_IF (m_processes[*id].second.m_active == true);
+  m_processes[*id].second = element;
+  m_activeMask |= 1u << *id;
 
-  NS_ABORT_IF (at (*id).m_active == false);
+  NS_ABORT_IF (m_processes[*id].second.m_active == false);
   NS_ABORT_IF (this->FirstAvailableId () == *id);
 
   ++m_usedSize;
@@ -67,10 +65,10 @@ NrMacHarqVector::Insert (uint8_t *id, const HarqProcess& element)
 std::ostream &
 operator<< (std::ostream & os, NrMacHarqVector const & item)
 {
-  for (const auto & p : item)
+  for (auto it = item.CBegin (); it != item.CEnd (); ++it)
     {
-      os << "Process ID " << static_cast<uint32_t> (p.first)
-         << ": " << p.second << std::endl;
+      os << "Process ID " << static_cast<uint32_t> (it->first)
+         << ": " << it->second << std::endl;
     }
   return os;
 }
@@ -18,7 +18,9 @@
  */
 #pragma once
 
-#include <unordered_map>
+#include <array>
+#include <utility>
+#include <ns3/abort.h>
 #include "nr-mac-harq-process.h"
 
 namespace ns3 {
@@ -27,29 +29,40 @@ namespace ns3 {
  * \ingroup scheduler
  * \brief Data structure to save all the HARQ process of an UE
  *
- * The data is stored as an unordered_map between the process ID and the
- * real data, saved in the structure HarqProcess. The vector (yes, it is an
- * improper name) is always full (i.e., it always contains almost 20 HARQ processes)
- * but they can be inactive (i.e., no data is stored there). The duty of finding
- * an empty spot is split between Insert and FirstAvailableId.
+ * The data is stored in a fixed-size array indexed by the process ID, and a
+ * bitmask tells which processes are ACTIVE. The vector is always full (i.e.,
+ * it always contains all the configured HARQ processes) but they can be
+ * inactive (i.e., no data is stored there). The first inactive process is
+ * found with a count-trailing-zeros on the inverted bitmask, and
+ * ForEachActive visits only the active processes.
+ *
+ * The elements are pairs (process ID, process), so the iterators can be
+ * used as the ones of a map.
  *
  * The class does not support going "out of space", or in other words, if all
  * the spots are filled with active processes, the next insert will fail.
  *
  * \see HarqProcess
  */
-class NrMacHarqVector : private std::unordered_map<uint8_t, HarqProcess>
+class NrMacHarqVector
 {
 public:
   friend std::ostream &  operator<< (std::ostream & os, NrMacHarqVector const & item);
+
+  static const uint8_t MAX_PROCESSES = 32; //!< Maximum number of processes
+
   /**
-   * \brief iterator of the map
+   * \brief element of the vector: process ID and process
    */
-  typedef typename std::unordered_map<uint8_t, HarqProcess>::iterator iterator;
+  typedef std::pair<uint8_t, HarqProcess> value_type;
   /**
-   * \brief const_iterator of the map
+   * \brief iterator of the vector
    */
-  typedef typename std::unordered_map<uint8_t, HarqProcess>::const_iterator const_iterator;
+  typedef value_type * iterator;
+  /**
+   * \brief const_iterator of the vector
+   */
+  typedef const value_type * const_iterator;
 
   /**
     * \brief Default constructor
@@ -57,18 +70,22 @@ public:
   NrMacHarqVector () = default;
 
   /**
-   * \brief Set and reserve the size of the vector
-   * \param size the vector size
+   * \brief Set the size of the vector
+   * \param size the vector size (not more than MAX_PROCESSES)
    *
-   * The method will reserve and create the necessary processes.
+   * The method will reset all the processes.
    */
   void SetMaxSize (uint8_t size)
   {
+    NS_ABORT_MSG_IF (size > MAX_PROCESSES, "At most " << +MAX_PROCESSES <<
+                     " HARQ processes are supported, requested " << +size);
     m_maxSize = size;
-    reserve (size);
-    for (auto i = 0; i < size; ++i)
+    m_usedSize = 0;
+    m_activeMask = 0;
+    for (uint8_t i = 0; i < size; ++i)
       {
-        emplace (i, HarqProcess ());
+        m_processes[i].first = i;
+        m_processes[i].second.Erase ();
       }
   }
 
@@ -90,59 +107,58 @@ public:
   /**
    * \brief Find a process
    * \param key ID of the process to find
-   * \return an iterator to the process
+   * \return an iterator to the process, or End () if it does not exist
    */
-  const iterator
+  iterator
   Find (uint8_t key)
   {
-    return this->find (key);
+    return Exist (key) ? &m_processes[key] : End ();
   }
   /**
    * \brief Begin of the vector
    * \return an iterator to the first element
    */
-  const iterator
+  iterator
   Begin ()
   {
-    return this->begin ();
+    return m_processes.data ();
   }
   /**
    * \brief End of the vector
    * \return an iterator to the end() element
    */
-  const iterator
+  iterator
   End ()
   {
-    return this->end ();
+    return m_processes.data () + m_maxSize;
   }
   /**
    * \brief Const begin of the vector
    * \return a const iterator to the first element
    */
   const_iterator
-  CBegin ()
+  CBegin () const
   {
-    return this->cbegin ();
+    return m_processes.data ();
   }
   /**
    * \brief Const end of the vector
    * \return a const iterator to the end() element
    */
   const_iterator
-  CEnd ()
+  CEnd () const
   {
-    return this->cend ();
+    return m_processes.data () + m_maxSize;
   }
   /**
-   * \brief Check if the ID exists in the map
+   * \brief Check if the ID exists in the vector
    * \param id ID to check
    * \return true if the ID exists, false if the ID is outside the maximum number
    * of stored elements
    */
   bool Exist (uint8_t id) const
   {
-    // could be id > max_size?
-    return find (id) != end ();
+    return id < m_maxSize;
   }
   /**
    * \brief Get a reference to a process
@@ -152,7 +168,7 @@ public:
   HarqProcess & Get (uint8_t id)
   {
     NS_ASSERT (Exist (id));
-    return find (id)->second;
+    return m_processes[id].second;
   }
   /**
    * \brief Get a const reference to a process
@@ -162,7 +178,7 @@ public:
   const HarqProcess & Get (uint8_t id) const
   {
     NS_ASSERT (Exist (id));
-    return find (id)->second;
+    return m_processes[id].second;
   }
   /**
    * \brief Find the first (INACTIVE) ID
@@ -170,14 +186,12 @@ public:
    */
   uint8_t FirstAvailableId () const
   {
-    for (const auto & it : *this)
+    uint32_t inactive = ~m_activeMask & GetSizeMask ();
+    if (inactive == 0)
       {
-        if (!it.second.m_active)
-          {
-            return it.first;
-          }
+        return 255;
       }
-    return 255;
+    return CountTrailingZeros (inactive);
   }
   /**
    * \brief Can an ID be inserted?
@@ -195,8 +209,55 @@ public:
   {
     return m_usedSize;
   }
+  /**
+   * \brief Call a function for each ACTIVE process, in order of ID
+   *
+   * The active processes are taken when the method is called: the function
+   * can erase the process it receives.
+   *
+   * \param f function called with the process ID and the process
+   */
+  template<typename F>
+  void ForEachActive (F &&f)
+  {
+    for (uint32_t mask = m_activeMask; mask != 0; mask &= mask - 1)
+      {
+        uint8_t id = CountTrailingZeros (mask);
+        f (id, m_processes[id].second);
+      }
+  }
 
 private:
+  /**
+   * \brief Get the index of the lowest bit set
+   * \param mask a non-zero mask
+   * \return the index of the lowest bit set in mask
+   */
+  static uint8_t CountTrailingZeros (uint32_t mask)
+  {
+#if defined(__GNUC__) || defined(__clang__)
+    return static_cast<uint8_t> (__builtin_ctz (mask));
+#else
+    uint8_t i = 0;
+    while ((mask & 1) == 0)
+      {
+        mask >>= 1;
+        ++i;
+      }
+    return i;
+#endif
+  }
+  /**
+   * \brief Get the mask of the configured processes
+   * \return a mask with the lowest m_maxSize bits set
+   */
+  uint32_t GetSizeMask () const
+  {
+    return m_maxSize >= 32 ? 0xFFFFFFFF : (1u << m_maxSize) - 1;
+  }
+
+  std::array<value_type, MAX_PROCESSES> m_processes; //!< Processes, indexed by ID
+  uint32_t m_activeMask {0}; //!< Bit i is set if process i is ACTIVE
   uint8_t m_maxSize  {0}; //!< Maximum size (or the number of processes stored)
   uint8_t m_usedSize {0}; //!< Number of ACTIVE processes
 };
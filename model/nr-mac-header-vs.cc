@@ -19,6 +19,8 @@
 
 #include "nr-mac-header-vs.h"
 #include <ns3/log.h>
+#include <ns3/abort.h>
+
 #include <algorithm>
 
 namespace ns3 {
@@ -26,11 +28,13 @@ namespace ns3 {
 NS_OBJECT_ENSURE_REGISTERED (NrMacHeaderVs);
 NS_LOG_COMPONENT_DEFINE("NrMacHeaderVs");
 
-// Maybe we can use the name here? Like LC_ID_1
-std::vector<uint8_t>
-NrMacHeaderVs::m_allowedLcId = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13,
-                                 14, 15, 16, 17, 18, 19, 20, 21, 22, 23, 24, 25,
-                                 26, 27, 28, 29, 30, 31, 32 };
+// LC_ID_1 to LC_ID_32
+const std::array<bool, 64>
+NrMacHeaderVs::m_allowedLcId = { false,
+                                 true, true, true, true, true, true, true, true,
+                                 true, true, true, true, true, true, true, true,
+                                 true, true, true, true, true, true, true, true,
+                                 true, true, true, true, true, true, true, true };
 TypeId
 NrMacHeaderVs::GetTypeId ()
 {
@@ -50,74 +54,87 @@ NrMacHeaderVs::NrMacHeaderVs()
   NS_LOG_FUNCTION (this);
 }
 
-void
-NrMacHeaderVs::Serialize (Buffer::Iterator start) const
+uint32_t
+NrMacHeaderVs::Encode (uint8_t lcId, uint16_t size, uint8_t *buffer)
 {
-  NS_LOG_FUNCTION (this);
-
   // 0x3F: 0 0 1 1 1 1 1 1
-  uint8_t firstByte = m_lcid & 0x3F;  // R, F bit set to 0, the rest equal to lcId
+  buffer[0] = lcId & 0x3F;  // R, F bit set to 0, the rest equal to lcId
 
-  if (m_size > 127)
+  if (size > 127)
     {
       // 0x40: 0 1 0 0 0 0 0 0
-      firstByte = firstByte | 0x40; // set the F bit to 1, the rest as before
+      buffer[0] |= 0x40; // set the F bit to 1, the rest as before
+      buffer[1] = static_cast<uint8_t> (size >> 8);
+      buffer[2] = static_cast<uint8_t> (size & 0xFF);
+      return 3;
     }
 
-  start.WriteU8 (firstByte);
-
-  if (m_size > 127)
-    {
-      start.WriteHtonU16 (m_size);
-    }
-  else
-    {
-      start.WriteU8 (static_cast<uint8_t> (m_size));
-    }
+  buffer[1] = static_cast<uint8_t> (size);
+  return 2;
 }
 
 uint32_t
-NrMacHeaderVs::Deserialize (Buffer::Iterator start)
+NrMacHeaderVs::Decode (const uint8_t *buffer, uint32_t length, uint8_t &lcId, uint16_t &size)
 {
-  NS_LOG_FUNCTION (this);
-
-  uint32_t readBytes = 1;
-  uint8_t firstByte = start.ReadU8 ();
+  if (length < 2)
+    {
+      return 0;
+    }
 
   // 0x3F: 0 0 1 1 1 1 1 1
-  m_lcid = firstByte & 0x3F; // Clear the first 2 bits, the rest is the lcId
+  lcId = buffer[0] & 0x3F; // Clear the first 2 bits, the rest is the lcId
 
   // 0xC0: 1 1 0 0 0 0 0 0
-  uint8_t lFieldSize = firstByte & 0xC0;
-
+  uint8_t lFieldSize = buffer[0] & 0xC0;
   if (lFieldSize == 0x40)
     {
-      // the F bit is set to 1
-      m_size = start.ReadNtohU16 ();
-      readBytes += 2;
-    }
-  else if (lFieldSize == 0x00)
-    {
-      // the F bit is set to 0
-      m_size = start.ReadU8 ();
-      readBytes += 1;
-    }
-  else
-    {
-      NS_FATAL_ERROR ("The author of the code, who lies behind a christmas tree, is guilty");
+      if (length < 3)
+        {
+          return 0;
+        }
+      size = static_cast<uint16_t> ((buffer[1] << 8) | buffer[2]);
+      return 3;
     }
 
-  if (m_size > 127)
-    {
-      NS_ASSERT (readBytes == 3);
-    }
-  else
-    {
-      NS_ASSERT (readBytes == 2);
-    }
+  NS_ABORT_MSG_IF (lFieldSize != 0x00, "R bit set in a MAC subheader");
+  size = buffer[1];
+  return 2;
+}
+
+void
+NrMacHeaderVs::Serialize (Buffer::Iterator start) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint8_t buffer[3];
+  start.Write (buffer, Encode (m_lcid, m_size, buffer));
+}
+
+uint32_t
+NrMacHeaderVs::Deserialize (Buffer::Iterator start)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint8_t buffer[3];
+  uint32_t length = std::min<uint32_t> (3, start.GetRemainingSize ());
+  start.Read (buffer, length);
+  uint32_t readBytes = Decode (buffer, length, m_lcid, m_size);
+  NS_ABORT_MSG_IF (readBytes == 0, "Truncated MAC subheader");
   return readBytes;
 }
 
+uint16_t
+NrMacHeaderVs::RemoveSubheader (Ptr<Packet> p, uint8_t &lcId)
+{
+  uint8_t buffer[3];
+  uint32_t length = p->CopyData (buffer, 3);
+  uint16_t size;
+  uint32_t read = Decode (buffer, length, lcId, size);
+  NS_ABORT_MSG_IF (read == 0, "Truncated MAC subheader");
+  p->RemoveAtStart (read);
+  return size;
+}
+
 uint32_t
 NrMacHeaderVs::GetSerializedSize () const
 {
@@ -144,7 +161,7 @@ NrMacHeaderVs::operator == (const NrMacHeaderVs &o) const
 void NrMacHeaderVs::SetLcId (uint8_t lcId)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (std::find (m_allowedLcId.begin(), m_allowedLcId.end(), lcId) != m_allowedLcId.end ());
+  NS_ASSERT (IsAllowedLcId (lcId));
   m_lcid = lcId;
 }
 
@@ -21,6 +21,7 @@
 #define NR_MAC_HEADER_VS_H
 
 #include "ns3/packet.h"
+#include <array>
 
 namespace ns3 {
 
@@ -178,12 +179,62 @@ public:
    */
   uint16_t GetSize () const;
 
+  /**
+   * \brief Check if a LC ID can be used in this header (data SDU)
+   * \param lcId the LC ID
+   * \return true if lcId is one of LC_ID_1 to LC_ID_32
+   */
+  static bool IsAllowedLcId (uint8_t lcId)
+  {
+    return lcId < m_allowedLcId.size () && m_allowedLcId[lcId];
+  }
+
+  /**
+   * \brief Serialized size of a subheader for a given size
+   * \param size the size that follows the subheader (L in the standard)
+   * \return 2 or 3
+   */
+  static uint32_t GetSubheaderSize (uint16_t size)
+  {
+    return size > 127 ? 3 : 2;
+  }
+
+  /**
+   * \brief Write a subheader on a raw buffer, in the same format as Serialize
+   * \param lcId the LC ID
+   * \param size the size that follows the subheader (L in the standard)
+   * \param buffer the buffer, with at least 3 bytes of space
+   * \return the number of bytes written (2 or 3)
+   */
+  static uint32_t Encode (uint8_t lcId, uint16_t size, uint8_t *buffer);
+  /**
+   * \brief Read a subheader from a raw buffer, written by Serialize or Encode
+   * \param buffer the buffer
+   * \param length the number of bytes available in the buffer
+   * \param lcId the LC ID read
+   * \param size the size that follows the subheader (L in the standard)
+   * \return the number of bytes read (2 or 3), or 0 if the buffer is too short
+   */
+  static uint32_t Decode (const uint8_t *buffer, uint32_t length, uint8_t &lcId, uint16_t &size);
+
+  /**
+   * \brief Remove the subheader at the start of a packet that carries one SDU
+   *
+   * It is equivalent to RemoveHeader with a NrMacHeaderVs, but reads the
+   * bytes directly, as NrGnbMac and NrUeMac do for each received packet.
+   *
+   * \param p the packet
+   * \param lcId the LC ID read
+   * \return the size read in the subheader (L in the standard)
+   */
+  static uint16_t RemoveSubheader (Ptr<Packet> p, uint8_t &lcId);
+
 protected:
   uint8_t   m_lcid {0}; //!< LC ID
   uint16_t  m_size {0}; //!< Size (L in the standard)
 
 private:
-  static std::vector<uint8_t> m_allowedLcId; //!< Vector of allowed LCID, to speed up checking
+  static const std::array<bool, 64> m_allowedLcId; //!< Allowed LCIDs, indexed by LCID
 };
 
 } //namespace ns3
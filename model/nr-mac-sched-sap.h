@@ -87,6 +87,8 @@ public:
     SfnSf  m_sfnSf;            //!< SfnSf
     uint8_t m_symStart;        //!< Sym start of the transmission to which this CQI refers to
     struct UlCqiInfo m_ulCqi;  //!< UL CQI
+    uint16_t m_rnti {0};       //!< RNTI of the UE that sent the SRS (only for UlCqiInfo::SRS)
+    uint8_t m_streamId {0};    //!< Index of the stream in which the CQI was measured
   };
 
   /**
@@ -29,17 +29,41 @@
 #include "nr-amc.h"
 
 #include <ns3/log.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerCQIManagement");
 
+static const double SRS_SINR_ALPHA = 0.25; //!< Weight of a new SRS SINR in its moving mean and variance
+
 void
-NrMacSchedulerCQIManagement::DlSBCQIReported ([[maybe_unused]]const DlCqiInfo &info,
-                                              [[maybe_unused]] const std::shared_ptr<NrMacSchedulerUeInfo>&ueInfo) const
+NrMacSchedulerCQIManagement::DlSBCQIReported (const DlCqiInfo &info,
+                                              const std::shared_ptr<NrMacSchedulerUeInfo>&ueInfo,
+                                              uint32_t expirationTime, int8_t maxDlMcs) const
 {
   NS_LOG_INFO (this);
-  // TODO
+  NS_ASSERT (info.m_rbPerSb > 0);
+
+  DlWBCQIReported (info, ueInfo, expirationTime, maxDlMcs);
+
+  ueInfo->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::SB;
+  ueInfo->m_dlCqi.m_rbPerSb = info.m_rbPerSb;
+  ueInfo->m_dlCqi.m_sbCqi.resize (info.m_wbCqi.size ());
+  for (uint8_t stream = 0; stream < info.m_wbCqi.size (); stream++)
+    {
+      // A stream without SB measurement keeps the previous values, as its
+      // wideband CQI
+      if (stream < info.m_sbCqi.size () && ! info.m_sbCqi.at (stream).empty ())
+        {
+          ueInfo->m_dlCqi.m_sbCqi.at (stream) = info.m_sbCqi.at (stream);
+          NS_LOG_INFO ("Updated SB CQI of UE " << ueInfo->m_rnti
+                       << " stream index " << static_cast<uint16_t> (stream)
+                       << " with " << info.m_sbCqi.at (stream).size () << " sub-bands");
+        }
+    }
 }
 
 void
@@ -76,6 +100,8 @@ NrMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime, [[maybe_u
   Values::iterator specIt = specVals.ValuesBegin ();
 
   std::stringstream out;
+  double sinrSum = 0.0;
+  uint32_t sinrCount = 0;
 
   for (uint32_t ichunk = 0; ichunk < model->GetNumBands (); ichunk++)
     {
@@ -84,6 +110,8 @@ NrMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime, [[maybe_u
         {
           *specIt = ueInfo->m_ulCqi.m_sinr.at (ichunk);
           out << ueInfo->m_ulCqi.m_sinr.at (ichunk) << " ";
+          sinrSum += ueInfo->m_ulCqi.m_sinr.at (ichunk);
+          ++sinrCount;
         }
       else
         {
@@ -96,9 +124,102 @@ NrMacSchedulerCQIManagement::UlSBCQIReported (uint32_t expirationTime, [[maybe_u
 
   NS_LOG_INFO ("Values of SINR to pass to the AMC: " << out.str ());
 
+  uint8_t stream = params.m_streamId;
+  if (ueInfo->m_ulMcs.size () <= stream)
+    {
+      ueInfo->m_ulMcs.resize (stream + 1, GetStartMcsUl ());
+      ueInfo->m_ulTbSize.resize (stream + 1, 0);
+    }
+
+  if (stream == 0 && sinrCount > 0 && sinrSum > 0.0)
+    {
+      ueInfo->m_ulPuschSinr = 10.0 * std::log10 (sinrSum / sinrCount);
+    }
+
   // MCS updated inside the function; crappy API... but we can't fix everything
-  ueInfo->m_ulCqi.m_cqi = GetAmcUl ()->CreateCqiFeedbackWbTdma (specVals, ueInfo->m_ulMcs);
-  NS_LOG_DEBUG ("Calculated MCS for RNTI " << ueInfo->m_rnti << " is " << ueInfo->m_ulMcs);
+  ueInfo->m_ulCqi.m_cqi = GetAmcUl ()->CreateCqiFeedbackWbTdma (specVals, ueInfo->m_ulMcs.at (stream));
+  NS_LOG_DEBUG ("Calculated MCS for RNTI " << ueInfo->m_rnti << " stream " << +stream <<
+                " is " << +ueInfo->m_ulMcs.at (stream));
+}
+
+void
+NrMacSchedulerCQIManagement::UlSrsReported (const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
+                                            const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+                                            const Ptr<const SpectrumModel> &model,
+                                            uint8_t maxRank, double rankSinrThreshold) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ASSERT (params.m_ulCqi.m_sinr.size () == model->GetNumBands ());
+
+  uint8_t stream = params.m_streamId;
+  if (ueInfo->m_ulSrsSinr.size () <= stream)
+    {
+      ueInfo->m_ulSrsSinr.resize (stream + 1, -std::numeric_limits<double>::infinity ());
+      ueInfo->m_ulSrsMcs.resize (stream + 1, GetStartMcsUl ());
+    }
+
+  SpectrumValue specVals (model);
+  double sinrSum = 0.0;
+  Values::iterator specIt = specVals.ValuesBegin ();
+  for (const auto &sinr : params.m_ulCqi.m_sinr)
+    {
+      *specIt = sinr;
+      sinrSum += sinr;
+      ++specIt;
+    }
+
+  ueInfo->m_ulSrsSinr.at (stream) = 10 * std::log10 (sinrSum / params.m_ulCqi.m_sinr.size ());
+  GetAmcUl ()->CreateCqiFeedbackWbTdma (specVals, ueInfo->m_ulSrsMcs.at (stream));
+
+  if (stream == 0)
+    {
+      // Exponentially weighted mean and variance of the SINR: the variance
+      // tells how much the channel changes between two SRS (see
+      // NrMacSchedulerSrsAdaptive)
+      double sinr = ueInfo->m_ulSrsSinr.at (0);
+      if (std::isinf (ueInfo->m_srsSinrMean))
+        {
+          ueInfo->m_srsSinrMean = sinr;
+          ueInfo->m_srsSinrVar = 0.0;
+        }
+      else
+        {
+          double diff = sinr - ueInfo->m_srsSinrMean;
+          ueInfo->m_srsSinrMean += SRS_SINR_ALPHA * diff;
+          ueInfo->m_srsSinrVar = (1 - SRS_SINR_ALPHA) * (ueInfo->m_srsSinrVar + SRS_SINR_ALPHA * diff * diff);
+        }
+      ueInfo->m_srsReports++;
+    }
+
+  // Two layers only if the UE has two streams, and all of them are good enough
+  uint8_t rank = 1;
+  if (maxRank >= 2 && ueInfo->m_ulSrsSinr.size () >= 2
+      && std::all_of (ueInfo->m_ulSrsSinr.begin (), ueInfo->m_ulSrsSinr.end (),
+                      [rankSinrThreshold] (double sinr) { return sinr >= rankSinrThreshold; }))
+    {
+      rank = 2;
+    }
+
+  if (rank > ueInfo->m_ulMcs.size ())
+    {
+      // The new streams start with the MCS computed from the SRS
+      for (uint8_t s = static_cast<uint8_t> (ueInfo->m_ulMcs.size ()); s < rank; ++s)
+        {
+          ueInfo->m_ulMcs.push_back (ueInfo->m_ulSrsMcs.at (s));
+        }
+      ueInfo->m_ulTbSize.resize (ueInfo->m_ulMcs.size (), 0);
+    }
+
+  if (rank != ueInfo->m_ulRank)
+    {
+      NS_LOG_INFO ("UL rank of RNTI " << ueInfo->m_rnti << " changed from " <<
+                   +ueInfo->m_ulRank << " to " << +rank);
+    }
+  ueInfo->m_ulRank = rank;
+
+  NS_LOG_DEBUG ("SRS of RNTI " << ueInfo->m_rnti << " stream " << +stream << " SINR " <<
+                ueInfo->m_ulSrsSinr.at (stream) << " dB, MCS " << +ueInfo->m_ulSrsMcs.at (stream) <<
+                ", UL rank " << +ueInfo->m_ulRank);
 }
 
 void
@@ -213,6 +334,7 @@ NrMacSchedulerCQIManagement::RefreshDlCqiMaps (const std::unordered_map<uint16_t
       if (ue->m_dlCqi.m_timer == 0)
         {
           ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::WB;
+          ue->m_dlCqi.m_sbCqi.clear ();
           for (uint8_t stream = 0; stream < ue->m_dlCqi.m_wbCqi.size (); stream++)
             {
               ue->m_dlCqi.m_wbCqi.at (stream) = 1; // lowest value for trying a transmission
@@ -239,7 +361,7 @@ NrMacSchedulerCQIManagement::RefreshUlCqiMaps (const std::unordered_map<uint16_t
         {
           ue->m_ulCqi.m_cqi = 1; // lowest value for trying a transmission
           ue->m_ulCqi.m_cqiType = NrMacSchedulerUeInfo::CqiInfo::WB;
-          ue->m_ulMcs = GetStartMcsUl ();
+          std::fill (ue->m_ulMcs.begin (), ue->m_ulMcs.end (), GetStartMcsUl ());
         }
       else
         {
@@ -31,11 +31,13 @@ class NrAmc;
  * \brief CQI management for schedulers.
  *
  * The scheduler will call either DlWBCQIReported or DlSBCQIReported to calculate
- * a new DL MCS. For UL, only the method UlSBCQIReported is implemented,
- * and it is a bit more complicated. For any detail, check the respective
+ * a new DL MCS (and, for the latter, to store the CQI of each sub-band). For UL, only the method UlSBCQIReported is implemented,
+ * and it is a bit more complicated; the UL rank is selected from the SRS
+ * SINR in UlSrsReported. For any detail, check the respective
  * documentation.
  *
  * \see UlSBCQIReported
+ * \see UlSrsReported
  * \see DlWBCQIReported
  */
 class NrMacSchedulerCQIManagement
@@ -94,10 +96,17 @@ public:
    * \brief SB CQI reported
    * \param info SB CQI
    * \param ueInfo UE
+   * \param expirationTime expiration time of the CQI in number of slot
+   * \param maxDlMcs maximum DL MCS index
    *
-   * NOT IMPLEMENTED
+   * The wideband part of the report is processed as in DlWBCQIReported, so
+   * the DL MCS of each stream is the wideband one. Then, the CQI of each
+   * sub-band is stored inside the m_dlCqi value of the UE, for the schedulers
+   * that assign the RBGs depending on the channel quality of each sub-band
+   * (e.g., NrMacSchedulerOfdmaSbPF).
    */
-  void DlSBCQIReported (const DlCqiInfo &info, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo) const;
+  void DlSBCQIReported (const DlCqiInfo &info, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+                        uint32_t expirationTime, int8_t maxDlMcs) const;
 
   /**
    * \brief An UL SB CQI has been reported for the specified UE
@@ -117,7 +126,7 @@ public:
    * From a vector of SINR (along the entire band) a SpectrumValue is calculated
    * and then passed as input to NrAmc::CreateCqiFeedbackWbTdma. From this
    * function, we have as a result an updated value of CQI, as well as an updated
-   * version of MCS for the UL.
+   * version of the UL MCS of the stream in which the CQI was measured.
    */
   void UlSBCQIReported (uint32_t expirationTime, uint32_t tbs,
                         const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
@@ -125,6 +134,26 @@ public:
                         const std::vector<uint8_t> &rbgMask, uint32_t numRbPerRbg,
                         const Ptr<const SpectrumModel> &model) const;
 
+  /**
+   * \brief The SINR of a SRS, received in one stream, has been reported for the specified UE
+   * \param params parameters of the received CQI (of type UlCqiInfo::SRS)
+   * \param ueInfo UE info
+   * \param model SpectrumModel to calculate the MCS
+   * \param maxRank the maximum UL rank
+   * \param rankSinrThreshold the minimum average SINR (dB) of the SRS of all the
+   * streams to use a rank of 2
+   *
+   * The average SINR and the MCS of the stream are stored in the UE info, and
+   * the UL rank is updated: it is 2 only if the UE has (at least) two streams,
+   * and the SRS SINR of each of them is above the threshold. A stream that
+   * becomes active starts with the MCS computed from its SRS, and is then
+   * updated by the PUSCH CQI (see UlSBCQIReported).
+   */
+  void UlSrsReported (const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params,
+                      const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+                      const Ptr<const SpectrumModel> &model,
+                      uint8_t maxRank, double rankSinrThreshold) const;
+
   /**
    * \brief Refresh the DL CQI for all the UE
    *
@@ -312,18 +312,30 @@ NrMacSchedulerHarqRr::ScheduleUlHarq (NrMacSchedulerNs3::PointInFTPlane *startin
 
           NS_ASSERT (dciInfoReTx->m_format == DciInfoElementTdma::UL);
 
-          NS_ASSERT_MSG (harqProcess.nackStreamIndexes.size () == 1, "MIMO is not supported for UL yet");
-
-          uint8_t rvIndex = dciInfoReTx->m_rv.at (0) + 1;
-          std::vector<uint8_t> rv {rvIndex};
-          std::vector<uint8_t> ndi {0};
+          NS_ASSERT (harqProcess.nackStreamIndexes.size () > 0);
+
+          // As in DL, only the NACKed streams are retransmitted, with the
+          // same TB size and MCS of the first transmission
+          std::vector<uint32_t> tbSize (dciInfoReTx->m_tbSize.size (), 0);
+          std::vector<uint8_t> mcs (dciInfoReTx->m_tbSize.size (), UINT8_MAX);
+          std::vector<uint8_t> rv (dciInfoReTx->m_tbSize.size (), 0);
+          std::vector<uint8_t> ndi (dciInfoReTx->m_tbSize.size (), UINT8_MAX);
+          for (const auto & stream : harqProcess.nackStreamIndexes)
+            {
+              tbSize.at (stream) = dciInfoReTx->m_tbSize.at (stream);
+              mcs.at (stream) = dciInfoReTx->m_mcs.at (stream);
+              rv.at (stream) = dciInfoReTx->m_rv.at (stream) + 1;
+              ndi.at (stream) = 0;
+            }
 
+          // The UE already applied the TPC of the first transmission: a
+          // retransmission does not change the power (1 is 0 dB when accumulating)
           auto dci = std::make_shared<DciInfoElementTdma> (dciInfoReTx->m_rnti, dciInfoReTx->m_format,
                                                            startingPoint->m_sym - dciInfoReTx->m_numSym,
                                                            dciInfoReTx->m_numSym,
-                                                           dciInfoReTx->m_mcs, dciInfoReTx->m_tbSize,
+                                                           mcs, tbSize,
                                                            ndi, rv, DciInfoElementTdma::DATA,
-                                                           dciInfoReTx->m_bwpIndex, dciInfoReTx->m_tpc);
+                                                           dciInfoReTx->m_bwpIndex, 1);
           dci->m_rbgBitmask = harqProcess.m_dciElement->m_rbgBitmask;
           dci->m_harqProcess = harqId;
           harqProcess.m_dciElement = dci;
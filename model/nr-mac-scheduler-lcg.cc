@@ -37,43 +37,47 @@ NrMacSchedulerLC::NrMacSchedulerLC (const LogicalChannelConfigListElement_s &con
 }
 
 void
-NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, std::string type)
+NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, DciInfoElementTdma::DciFormat format)
 {
   NS_LOG_FUNCTION (this);
-  NS_ASSERT (m_lcMap.size () > 0);
+  NS_ASSERT (m_lcs.size () > 0);
+
+  NrMacSchedulerLC &lc = GetLC (lcId);
+  uint32_t &status = lc.m_rlcBufferSize[NrMacSchedulerLC::STATUS];
+  uint32_t &retx = lc.m_rlcBufferSize[NrMacSchedulerLC::RETX];
+  uint32_t &tx = lc.m_rlcBufferSize[NrMacSchedulerLC::TX];
+  m_bufferedBytes -= lc.GetTotalSize ();
 
   // Update queues: RLC tx order Status, ReTx, Tx. To understand this, you have
   // to see RlcAm::NotifyTxOpportunity
   NS_LOG_INFO ("Status of LCID " << static_cast<uint32_t> (lcId) << ": RLCSTATUS=" <<
-               m_lcMap.at (lcId)->m_rlcStatusPduSize << ", RLC Retr=" <<
-               m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize << ", RLC TX=" <<
-               m_lcMap.at (lcId)->m_rlcTransmissionQueueSize);
+               status << ", RLC Retr=" << retx << ", RLC TX=" << tx);
 
-  if ((m_lcMap.at (lcId)->m_rlcStatusPduSize > 0) && (size >= m_lcMap.at (lcId)->m_rlcStatusPduSize))
+  if ((status > 0) && (size >= status))
     {
       // Update status queue
-      m_totalSize -= m_lcMap.at (lcId)->m_rlcStatusPduSize;
-      m_lcMap.at (lcId)->m_rlcStatusPduSize = 0;
+      m_totalSize -= status;
+      status = 0;
     }
-  else if ((m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize > 0) && (size >= m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize))
+  else if ((retx > 0) && (size >= retx))
     {
-      if (m_totalSize < m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize)
+      if (m_totalSize < retx)
         {
           NS_LOG_WARN ("Total ReTx queue size lower than it should be at this point. Reseting it.");
           m_totalSize = 0;
         }
       else
         {
-          m_totalSize -= m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize;
+          m_totalSize -= retx;
         }
-        m_lcMap.at (lcId)->m_rlcRetransmissionQueueSize = 0;
+        retx = 0;
     }
-  else if (m_lcMap.at (lcId)->m_rlcTransmissionQueueSize > 0) // if not enough size for retransmission use if for transmission if there is any data to be transmitted
+  else if (tx > 0) // if not enough size for retransmission use if for transmission if there is any data to be transmitted
     {
       uint32_t rlcOverhead = 0;
       // The following logic of selecting the overhead is
       // inherited from the LTE module scheduler API
-      if (lcId == 1 && type == "DL")
+      if (lcId == 1 && format == DciInfoElementTdma::DL)
         {
           // for SRB1 (using RLC AM) it's better to
           // overestimate RLC overhead rather than
@@ -87,31 +91,31 @@ NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, std::string type)
           rlcOverhead = 2;
         }
 
-      if (m_totalSize < m_lcMap.at (lcId)->m_rlcTransmissionQueueSize)
+      if (m_totalSize < tx)
         {
           NS_LOG_WARN ("Total Tx queue size lower than it should be at this point. Reseting it.");
           m_totalSize = 0;
         }
       else
         {
-          if (m_lcMap.at (lcId)->m_rlcTransmissionQueueSize <= size)
+          if (tx <= size)
             {
-              m_totalSize -= m_lcMap.at (lcId)->m_rlcTransmissionQueueSize;
+              m_totalSize -= tx;
             }
           else
             {
-              m_totalSize -= std::min (m_lcMap.at (lcId)->m_rlcTransmissionQueueSize, size - rlcOverhead);
+              m_totalSize -= std::min (tx, size - rlcOverhead);
             }
         }
-      if (size - rlcOverhead >= m_lcMap.at (lcId)->m_rlcTransmissionQueueSize)
+      if (size - rlcOverhead >= tx)
         {
           // we can transmit everything from the queue, reset it
-          m_lcMap.at (lcId)->m_rlcTransmissionQueueSize = 0;
+          tx = 0;
         }
       else
         {
           // not enough to empty all queue, but send what you can, this is normal situation to happen
-          m_lcMap.at (lcId)->m_rlcTransmissionQueueSize -= size - rlcOverhead;
+          tx -= size - rlcOverhead;
         }
     }
   else
@@ -119,6 +123,7 @@ NrMacSchedulerLCG::AssignedData (uint8_t lcId, uint32_t size, std::string type)
       NS_LOG_WARN (" Not reducing m_totalSize since this opportunity cannot be used, not enough bytes to perform retransmission or not active flows.");
     }
 
+  m_bufferedBytes += lc.GetTotalSize ();
   SanityCheck ();
 }
 
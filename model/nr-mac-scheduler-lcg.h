@@ -18,7 +18,9 @@
  */
 #pragma once
 
+#include <array>
 #include <memory>
+#include <vector>
 #include <ns3/ff-mac-common.h>
 #include <ns3/nstime.h>
 #include "nr-mac-sched-sap.h"
@@ -30,7 +32,8 @@ namespace ns3 {
  * \brief Represent a DL Logical Channel of an UE
  *
  * The scheduler stores here the information that comes from BSR, arriving
- * from the gNB.
+ * from the gNB. The sizes of the three RLC buffers are stored in an array
+ * indexed by RlcBuffer, in the order in which the RLC serves them.
  *
  * Please use the unique ptr defined by the typedef LCPtr.
  *
@@ -55,6 +58,18 @@ public:
    */
   NrMacSchedulerLC (const NrMacSchedulerLC &o) = delete;
 
+  /**
+   * \brief The RLC buffers of a LC, in the order in which the RLC serves
+   * them (see RlcAm::NotifyTxOpportunity)
+   */
+  enum RlcBuffer : uint8_t
+  {
+    STATUS = 0,     //!< Pending STATUS PDU
+    RETX = 1,       //!< Retransmission queue
+    TX = 2,         //!< New transmission queue
+    NUM_BUFFERS = 3 //!< Number of buffers
+  };
+
   /**
    * \brief Overwrite all the parameters with the one contained in the message
    * \param params the message received from the RLC layer, containing the information about the queues
@@ -68,35 +83,35 @@ public:
 
     int ret = 0;
 
-    if (params.m_rlcTransmissionQueueSize > m_rlcTransmissionQueueSize)
+    if (params.m_rlcTransmissionQueueSize > m_rlcBufferSize[TX])
       {
-        ret += params.m_rlcTransmissionQueueSize - m_rlcTransmissionQueueSize;
+        ret += params.m_rlcTransmissionQueueSize - m_rlcBufferSize[TX];
       }
-    if (params.m_rlcRetransmissionQueueSize > m_rlcRetransmissionQueueSize)
+    if (params.m_rlcRetransmissionQueueSize > m_rlcBufferSize[RETX])
       {
-        ret += params.m_rlcRetransmissionQueueSize - m_rlcRetransmissionQueueSize;
+        ret += params.m_rlcRetransmissionQueueSize - m_rlcBufferSize[RETX];
       }
-    if (params.m_rlcStatusPduSize - m_rlcStatusPduSize)
+    if (params.m_rlcStatusPduSize != m_rlcBufferSize[STATUS])
       {
-        ret += params.m_rlcStatusPduSize - m_rlcStatusPduSize;
+        ret += static_cast<int> (params.m_rlcStatusPduSize) - static_cast<int> (m_rlcBufferSize[STATUS]);
       }
 
-    m_rlcTransmissionQueueSize = params.m_rlcTransmissionQueueSize;
+    m_rlcBufferSize[TX] = params.m_rlcTransmissionQueueSize;
     m_rlcTransmissionQueueHolDelay = params.m_rlcTransmissionQueueHolDelay;
-    m_rlcRetransmissionQueueSize = params.m_rlcRetransmissionQueueSize;
+    m_rlcBufferSize[RETX] = params.m_rlcRetransmissionQueueSize;
     m_rlcRetransmissionHolDelay = params.m_rlcRetransmissionHolDelay;
-    m_rlcStatusPduSize = params.m_rlcStatusPduSize;
+    m_rlcBufferSize[STATUS] = params.m_rlcStatusPduSize;
 
     return ret;
   }
 
   /**
-   * \brief Forcefully update m_rlcTransmissionQueueSize
+   * \brief Forcefully update the size of the TX buffer
    * \param size Num. of bytes
    */
   void OverwriteTxQueueSize (uint32_t size)
   {
-    m_rlcTransmissionQueueSize = size;
+    m_rlcBufferSize[TX] = size;
   }
 
   /**
@@ -106,15 +121,13 @@ public:
   uint32_t
   GetTotalSize () const
   {
-    return m_rlcTransmissionQueueSize + m_rlcRetransmissionQueueSize + m_rlcStatusPduSize;
+    return m_rlcBufferSize[STATUS] + m_rlcBufferSize[RETX] + m_rlcBufferSize[TX];
   }
 
   uint32_t m_id                           {0}; //!< ID of the LC
-  uint32_t m_rlcTransmissionQueueSize     {0}; //!< The current size of the new transmission queue in byte.
+  std::array<uint32_t, NUM_BUFFERS> m_rlcBufferSize {}; //!< The current size of each RLC buffer, in byte, indexed by RlcBuffer
   uint16_t m_rlcTransmissionQueueHolDelay {0}; //!< Head of line delay of new transmissions in ms.
   uint16_t m_rlcRetransmissionHolDelay    {0}; //!< Head of line delay of retransmissions in ms.
-  uint32_t m_rlcRetransmissionQueueSize   {0}; //!< The current size of the retransmission queue in byte.
-  uint16_t m_rlcStatusPduSize             {0}; //!< The current size of the pending STATUS message in byte.
 
   Time m_delayBudget    {Time::Min ()}; //!< Delay budget of the flow
   double m_PER          {0.0};         //!< PER of the flow
@@ -132,8 +145,15 @@ typedef std::unique_ptr<NrMacSchedulerLC> LCPtr;
  * \brief Represent an UE LCG (can be DL or UL)
  *
  * A Logical Channel Group has an id (represented by m_id) and can contain
- * logical channels. The LC are stored inside an unordered map, indexed
- * by their ID.
+ * logical channels. The LC are stored in a vector, and a small array indexed
+ * by the LC ID (up to MAX_LC_ID) gives the position of each LC in the vector:
+ * finding a LC is an array access, without hashing. The LCs are visited
+ * from the last inserted, which is the order in which the unordered map
+ * previously used visited the LC IDs of the bearers, so that the bytes are
+ * distributed (and the RLC PDUs are ordered) as before.
+ *
+ * The LCG also keeps the exact sum of the RLC buffers of its LCs, so that
+ * SanityCheck does not visit all the LCs after each assignment.
  *
  * The LCs are inserted through the method Insert, and they can be updated with
  * a call to UpdateInfo. The update is different in DL and UL: in UL only the
@@ -162,6 +182,7 @@ public:
   NrMacSchedulerLCG (uint8_t id) : m_id (id)
   {
     (void) m_id;
+    m_lcIndex.fill (NO_LC);
   }
   /**
    * \brief NrMacSchedulerLCG copy constructor (deleted)
@@ -169,6 +190,8 @@ public:
    */
   NrMacSchedulerLCG (const NrMacSchedulerLCG &other) = delete;
 
+  static constexpr uint8_t MAX_LC_ID = 32; //!< Highest LC ID that can be stored (LCID 32 of TS 38.321)
+
   /**
    * \brief Check if the LCG contains the LC id specified
    * \param lcId LC ID to check for
@@ -177,7 +200,7 @@ public:
   bool
   Contains (uint8_t lcId) const
   {
-    return m_lcMap.find (lcId) != m_lcMap.end ();
+    return lcId <= MAX_LC_ID && m_lcIndex[lcId] != NO_LC;
   }
 
   /**
@@ -187,7 +210,7 @@ public:
   uint32_t
   NumOfLC () const
   {
-    return static_cast<uint32_t> (m_lcMap.size ());
+    return static_cast<uint32_t> (m_lcs.size ());
   }
 
   /**
@@ -198,8 +221,20 @@ public:
   bool
   Insert (LCPtr && lc)
   {
-    NS_ASSERT (!Contains (lc->m_id));
-    return m_lcMap.emplace (std::make_pair (lc->m_id, std::move (lc))).second;
+    NS_ABORT_MSG_IF (lc->m_id > MAX_LC_ID, "LC ID " << lc->m_id << " not supported");
+    NS_ASSERT (!Contains (static_cast<uint8_t> (lc->m_id)));
+    if (Contains (static_cast<uint8_t> (lc->m_id)))
+      {
+        return false;
+      }
+    // The last inserted is visited first; see the class documentation
+    m_bufferedBytes += lc->GetTotalSize ();
+    m_lcs.insert (m_lcs.begin (), std::move (lc));
+    for (uint8_t i = 0; i < m_lcs.size (); ++i)
+      {
+        m_lcIndex[m_lcs[i]->m_id] = i;
+      }
+    return true;
   }
 
   /**
@@ -215,7 +250,10 @@ public:
   UpdateInfo (const NrMacSchedSapProvider::SchedDlRlcBufferReqParameters& params)
   {
     NS_ASSERT (Contains (params.m_logicalChannelIdentity));
-    int ret = m_lcMap.at (params.m_logicalChannelIdentity)->Update (params);
+    NrMacSchedulerLC &lc = GetLC (params.m_logicalChannelIdentity);
+    m_bufferedBytes -= lc.GetTotalSize ();
+    int ret = lc.Update (params);
+    m_bufferedBytes += lc.GetTotalSize ();
     if (ret < 0)
       {
         NS_ASSERT_MSG (m_totalSize >= static_cast<uint32_t> (std::abs (ret)),
@@ -234,13 +272,7 @@ public:
   SanityCheck ()
   {
     //sanity check of m_totalSize
-    uint32_t size = 0;
-    for (const auto & lc : m_lcMap)
-      {
-        size += lc. second->m_rlcStatusPduSize + lc.second -> m_rlcRetransmissionQueueSize + lc.second ->m_rlcTransmissionQueueSize;
-      }
-
-    if (size == 0)
+    if (m_bufferedBytes == 0)
       {
         m_totalSize = 0;
       }
@@ -252,7 +284,7 @@ public:
    * \param lcgQueueSize Sum of the size of all components in B
    *
    * Used in the UL case, in which only the sum of the components are
-   * available. For the LC, only the value m_rlcTransmissionQueueSize is updated.
+   * available. For the LC, only the size of the TX buffer is updated.
    *
    * For UL, only 1 LC per LCG is supported.
    *
@@ -261,11 +293,13 @@ public:
   void
   UpdateInfo (uint32_t lcgQueueSize)
   {
-    NS_ABORT_IF (m_lcMap.size () > 1);
-    uint32_t lcIdPart = lcgQueueSize / m_lcMap.size ();
-    for (auto & lc : m_lcMap)
+    NS_ABORT_IF (m_lcs.size () > 1);
+    uint32_t lcIdPart = lcgQueueSize / m_lcs.size ();
+    m_bufferedBytes = 0;
+    for (auto & lc : m_lcs)
       {
-        lc.second->OverwriteTxQueueSize (lcIdPart);
+        lc->OverwriteTxQueueSize (lcIdPart);
+        m_bufferedBytes += lc->GetTotalSize ();
       }
     m_totalSize = lcgQueueSize;
   }
@@ -288,8 +322,8 @@ public:
   uint32_t
   GetTotalSizeOfLC (uint8_t lcId) const
   {
-    NS_ABORT_IF (m_lcMap.size () == 0);
-    return m_lcMap.at (lcId)->GetTotalSize ();
+    NS_ABORT_IF (m_lcs.size () == 0);
+    return GetLC (lcId).GetTotalSize ();
   }
 
   /**
@@ -300,25 +334,56 @@ public:
   GetLCId () const
   {
     std::vector<uint8_t> ret;
-    for (const auto & lc : m_lcMap)
+    ret.reserve (m_lcs.size ());
+    for (const auto & lc : m_lcs)
       {
-        ret.emplace_back (lc.first);
+        ret.emplace_back (static_cast<uint8_t> (lc->m_id));
       }
     return ret;
   }
 
+  /**
+   * \brief Visit the LCs of the LCG, in the order of GetLCId
+   * \param f function called with each LC
+   */
+  template <typename F>
+  void
+  ForEachLC (F &&f) const
+  {
+    for (const auto & lc : m_lcs)
+      {
+        f (static_cast<const NrMacSchedulerLC &> (*lc));
+      }
+  }
+
   /**
    * \brief Inform the LCG of the assigned data to a LC id
    * \param lcId the LC id to which the data was assigned
    * \param size amount of assigned data
-   * \param type String representing the type of allocation currently in act (DL or UL)
+   * \param format direction of the allocation currently in act (DL or UL)
    */
-  void AssignedData (uint8_t lcId, uint32_t size, std::string type);
+  void AssignedData (uint8_t lcId, uint32_t size, DciInfoElementTdma::DciFormat format);
 
 private:
+  /**
+   * \brief Get a LC of the LCG
+   * \param lcId the LC ID, which must be in the LCG
+   * \return the LC
+   */
+  NrMacSchedulerLC &
+  GetLC (uint8_t lcId) const
+  {
+    NS_ASSERT_MSG (Contains (lcId), "LC " << +lcId << " not in the LCG");
+    return *m_lcs[m_lcIndex[lcId]];
+  }
+
+  static constexpr uint8_t NO_LC = 0xFF; //!< Value of m_lcIndex for the LC IDs not in the LCG
+
   uint32_t m_totalSize {0};                  //!< Total size
   uint8_t m_id {0};                          //!< ID of the LCG
-  std::unordered_map<uint8_t, LCPtr> m_lcMap; //!< Map between LC id and their pointer
+  std::vector<LCPtr> m_lcs;                  //!< LCs of the LCG, from the last inserted
+  std::array<uint8_t, MAX_LC_ID + 1> m_lcIndex; //!< Position in m_lcs of each LC ID, or NO_LC
+  uint64_t m_bufferedBytes {0};              //!< Sum of the RLC buffers of the LCs
 };
 
 /**
@@ -26,6 +26,7 @@
   while (false);
 
 #include "nr-mac-scheduler-ns3.h"
+#include "nr-profiler.h"
 #include "nr-mac-scheduler-harq-rr.h"
 #include "nr-mac-short-bsr-ce.h"
 #include "nr-mac-scheduler-srs-default.h"
@@ -36,14 +37,57 @@
 #include <ns3/eps-bearer.h>
 #include <ns3/pointer.h>
 #include <algorithm>
+#include <limits>
 #include <ns3/integer.h>
+#include <ns3/double.h>
+#include <ns3/object-factory.h>
 #include <unordered_set>
+#include <map>
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerNs3");
 NS_OBJECT_ENSURE_REGISTERED (NrMacSchedulerNs3);
 
+#ifdef NR_PROFILING
+/**
+ * \brief Count the UEs of an active UE map, for the profiler
+ * \param activeUe the active UE map, grouped by beam
+ * \return the number of UEs
+ */
+template <typename ActiveUe>
+static uint64_t
+CountActiveUe (const ActiveUe &activeUe)
+{
+  uint64_t count = 0;
+  for (const auto &beam : activeUe)
+    {
+      count += beam.second.size ();
+    }
+  return count;
+}
+
+/**
+ * \brief Count the RBGs assigned to data in a slot, for the profiler
+ * \param slotAlloc the slot allocation
+ * \param format the format of the DCIs to consider
+ * \return the number of RBGs, summed over the DCIs
+ */
+static uint64_t
+CountDataRbg (const SlotAllocInfo &slotAlloc, DciInfoElementTdma::DciFormat format)
+{
+  uint64_t count = 0;
+  for (const auto &alloc : slotAlloc.m_varTtiAllocInfo)
+    {
+      if (alloc.m_dci->m_type == DciInfoElementTdma::DATA && alloc.m_dci->m_format == format)
+        {
+          count += std::count (alloc.m_dci->m_rbgBitmask.begin (), alloc.m_dci->m_rbgBitmask.end (), 1);
+        }
+    }
+  return count;
+}
+#endif
+
 NrMacSchedulerNs3::NrMacSchedulerNs3 () : NrMacScheduler ()
 {
   NS_LOG_FUNCTION_NOARGS ();
@@ -60,9 +104,6 @@ NrMacSchedulerNs3::NrMacSchedulerNs3 () : NrMacScheduler ()
   m_cqiManagement.InstallGetNrAmcUlFn (std::bind ([this] () { return m_ulAmc; }));
   m_cqiManagement.InstallGetStartMcsDlFn (std::bind ([this] () { return m_startMcsDl; }));
   m_cqiManagement.InstallGetStartMcsUlFn (std::bind ([this] () { return m_startMcsUl; }));
-
-  // If more Srs allocators will be created, then we will add an attribute
-  m_schedulerSrs = CreateObject<NrMacSchedulerSrsDefault> ();
 }
 
 NrMacSchedulerNs3::~NrMacSchedulerNs3 ()
@@ -196,6 +237,40 @@ NrMacSchedulerNs3::GetTypeId (void)
                    MakeBooleanAccessor (&NrMacSchedulerNs3::EnableHarqReTx,
                                         &NrMacSchedulerNs3::IsHarqReTxEnable),
                                         MakeBooleanChecker ())
+    .AddAttribute ("UlMaxRank",
+                   "Maximum number of PUSCH layers (UL rank) that can be assigned to a UE. "
+                   "A rank of 2 requires UEs with two streams, and the same UlMaxRank "
+                   "in their NrUeMac",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&NrMacSchedulerNs3::m_ulMaxRank),
+                   MakeUintegerChecker<uint8_t> (1, 2))
+    .AddAttribute ("UlRankSinrThreshold",
+                   "Minimum average SRS SINR (dB) that all the streams of a UE must have "
+                   "to be scheduled with more than one PUSCH layer",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&NrMacSchedulerNs3::m_ulRankSinrThreshold),
+                   MakeDoubleChecker<double> ())
+    .AddAttribute ("SrsAlgorithmType",
+                   "Type of the algorithm that assigns the SRS periodicity and offset "
+                   "to the UEs (e.g., ns3::NrMacSchedulerSrsDefault or "
+                   "ns3::NrMacSchedulerSrsAdaptive)",
+                   TypeIdValue (NrMacSchedulerSrsDefault::GetTypeId ()),
+                   MakeTypeIdAccessor (&NrMacSchedulerNs3::SetSrsAlgorithmType,
+                                       &NrMacSchedulerNs3::GetSrsAlgorithmType),
+                   MakeTypeIdChecker ())
+    .AddAttribute ("ClosedLoopTpc",
+                   "If true, the TPC command of the UL DCIs is derived from the "
+                   "SINR of the PUSCH of each UE, to reach TpcTargetSinr. If false, "
+                   "the fixed value of GetTpc () is sent. The UE power control "
+                   "should be in accumulation mode.",
+                   BooleanValue (false),
+                   MakeBooleanAccessor (&NrMacSchedulerNs3::m_closedLoopTpc),
+                   MakeBooleanChecker ())
+    .AddAttribute ("TpcTargetSinr",
+                   "Target PUSCH SINR (dB) of the closed loop TPC",
+                   DoubleValue (10.0),
+                   MakeDoubleAccessor (&NrMacSchedulerNs3::m_tpcTargetSinr),
+                   MakeDoubleChecker<double> ())
   ;
 
   return tid;
@@ -369,6 +444,141 @@ NrMacSchedulerNs3::GetUlNotchedRbgMask (void) const
   return m_ulNotchedRbgsMask;
 }
 
+void
+NrMacSchedulerNs3::SetSrsAlgorithmType (const TypeId &type)
+{
+  NS_LOG_FUNCTION (this << type);
+  NS_ABORT_MSG_IF (! m_ueMap.empty (), "The SRS algorithm cannot be changed after the UEs are attached");
+
+  ObjectFactory factory;
+  factory.SetTypeId (type);
+  m_srsAlgorithm = factory.Create<Object> ();
+  m_schedulerSrs = dynamic_cast<NrMacSchedulerSrs *> (PeekPointer (m_srsAlgorithm));
+  NS_ABORT_MSG_IF (m_schedulerSrs == nullptr, type.GetName () << " is not an SRS algorithm");
+}
+
+TypeId
+NrMacSchedulerNs3::GetSrsAlgorithmType () const
+{
+  return m_srsAlgorithm->GetInstanceTypeId ();
+}
+
+uint8_t
+NrMacSchedulerNs3::GetUeTpc (const std::shared_ptr<NrMacSchedulerUeInfo> &ue) const
+{
+  NS_LOG_FUNCTION (this);
+
+  if (! m_closedLoopTpc)
+    {
+      return GetTpc ();
+    }
+
+  // TS 38.213 Table 7.1.1-1, accumulated values
+  uint8_t tpc = 1;
+  double delta = 0.0;
+  if (ue->m_tpcCorrection >= 3.0)
+    {
+      tpc = 3;
+      delta = 3.0;
+    }
+  else if (ue->m_tpcCorrection >= 1.0)
+    {
+      tpc = 2;
+      delta = 1.0;
+    }
+  else if (ue->m_tpcCorrection <= -1.0)
+    {
+      tpc = 0;
+      delta = -1.0;
+    }
+
+  ue->m_tpcCorrection -= delta;
+
+  NS_LOG_DEBUG ("UE " << ue->m_rnti << " PUSCH SINR " << ue->m_ulPuschSinr <<
+                " dB, TPC " << +tpc << " remaining correction " <<
+                ue->m_tpcCorrection << " dB");
+  return tpc;
+}
+
+void
+NrMacSchedulerNs3::InstallGetUeSpeedFn (const std::function<double (uint16_t)> &fn)
+{
+  m_getUeSpeedFn = fn;
+}
+
+void
+NrMacSchedulerNs3::InstallGetUeImsiFn (const std::function<uint64_t (uint16_t)> &fn)
+{
+  m_getUeImsiFn = fn;
+}
+
+void
+NrMacSchedulerNs3::SaveState (NrCheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (! m_getUeImsiFn, "The scheduler needs the IMSI of the UEs to save them");
+
+  // The UEs are sorted by IMSI, so that the checkpoint does not depend on
+  // the order of the attachments
+  std::map<uint64_t, UePtr> ues;
+  for (const auto & ue : m_ueMap)
+    {
+      uint64_t imsi = m_getUeImsiFn (ue.first);
+      if (imsi == 0)
+        {
+          NS_LOG_WARN ("UE " << ue.first << " has no IMSI yet, it is not saved");
+          continue;
+        }
+      ues.emplace (imsi, ue.second);
+    }
+
+  writer.WriteU32 (static_cast<uint32_t> (ues.size ()));
+  for (const auto & ue : ues)
+    {
+      writer.WriteU64 (ue.first);
+      size_t record = writer.BeginRecord ();
+      writer.WriteString (ue.second->GetStateType ());
+      ue.second->SaveState (writer);
+      writer.EndRecord (record);
+    }
+}
+
+void
+NrMacSchedulerNs3::RestoreState (NrCheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_MSG_IF (! m_getUeImsiFn, "The scheduler needs the IMSI of the UEs to restore them");
+
+  std::unordered_map<uint64_t, UePtr> ues;
+  for (const auto & ue : m_ueMap)
+    {
+      ues.emplace (m_getUeImsiFn (ue.first), ue.second);
+    }
+
+  uint32_t numUes = reader.ReadU32 ();
+  for (uint32_t i = 0; i < numUes; ++i)
+    {
+      uint64_t imsi = reader.ReadU64 ();
+      size_t record = reader.BeginRecord ();
+      std::string type = reader.ReadString ();
+      auto itUe = ues.find (imsi);
+      if (itUe == ues.end ())
+        {
+          NS_LOG_WARN ("UE with IMSI " << imsi << " of the checkpoint is not attached, skipping it");
+        }
+      else if (itUe->second->GetStateType () != type)
+        {
+          NS_LOG_WARN ("UE with IMSI " << imsi << " of the checkpoint has a state of type " << type <<
+                       ", the scheduler uses " << itUe->second->GetStateType () << ", skipping it");
+        }
+      else
+        {
+          itUe->second->RestoreState (reader);
+        }
+      reader.EndRecord (record);
+    }
+}
+
 void
 NrMacSchedulerNs3::SetSrsCtrlSyms (uint8_t v)
 {
@@ -511,7 +721,7 @@ NrMacSchedulerNs3::DoCschedUeConfigReq (const NrMacCschedSapProvider::CschedUeCo
       UeInfoOf (*itUe)->m_dlMcs.push_back (m_startMcsDl);
       UeInfoOf (*itUe)->m_startMcsDlUe = m_startMcsDl;
       UeInfoOf (*itUe)->m_dlCqi.m_ri = 1;
-      UeInfoOf (*itUe)->m_ulMcs = m_startMcsUl;
+      UeInfoOf (*itUe)->m_ulMcs.push_back (m_startMcsUl);
 
       NrMacSchedulerSrs::SrsPeriodicityAndOffset srs = m_schedulerSrs->AddUe ();
 
@@ -552,7 +762,7 @@ NrMacSchedulerNs3::DoCschedUeReleaseReq (const NrMacCschedSapProvider::CschedUeR
   auto itUe = m_ueMap.find (params.m_rnti);
   NS_ABORT_IF (itUe == m_ueMap.end ());
 
-  m_schedulerSrs->RemoveUe (itUe->second->m_srsOffset);
+  m_schedulerSrs->RemoveUe (itUe->second->m_srsOffset, itUe->second->m_srsPeriodicity);
   m_ueMap.erase (itUe);
 
   // When it will be the case of reducing the periodicity? Question for the
@@ -826,7 +1036,7 @@ NrMacSchedulerNs3::DoSchedDlCqiInfoReq (const NrMacSchedSapProvider::SchedDlCqiI
         }
       else
         {
-          m_cqiManagement.DlSBCQIReported (cqi, ue);
+          m_cqiManagement.DlSBCQIReported (cqi, ue, expirationTime, m_maxDlMcs);
         }
     }
 }
@@ -842,18 +1052,18 @@ NrMacSchedulerNs3::DoSchedDlCqiInfoReq (const NrMacSchedSapProvider::SchedDlCqiI
  * to be able to calculate CQI and MCS, so a special stack is maintained
  * (m_ulAllocationMap).
  *
- * Only UlCqiInfo::PUSCH is currently supported.
+ * With UL MIMO, the PUSCH CQI is received separately for each stream, and
+ * the allocation is removed once the CQI of all its streams is processed.
+ *
+ * The UlCqiInfo::SRS type carries the SINR of the SRS received in one stream,
+ * and is used to select the UL rank of the UE (see
+ * NrMacSchedulerCQIManagement::UlSrsReported).
  */
 void
 NrMacSchedulerNs3::DoSchedUlCqiInfoReq (const NrMacSchedSapProvider::SchedUlCqiInfoReqParameters& params)
 {
   NS_LOG_FUNCTION (this);
 
-  if (m_fixedMcsUl)
-    {
-      return;
-    }
-
   GetSecond UeInfoOf;
 
   uint32_t expirationTime = static_cast<uint32_t> (m_cqiTimersThreshold.GetNanoSeconds () /
@@ -863,42 +1073,62 @@ NrMacSchedulerNs3::DoSchedUlCqiInfoReq (const NrMacSchedSapProvider::SchedUlCqiI
     {
     case UlCqiInfo::PUSCH:
       {
+        if (m_fixedMcsUl)
+          {
+            return;
+          }
+
         [[maybe_unused]] bool found = false;
         uint8_t symStart = params.m_symStart;
+        uint8_t stream = params.m_streamId;
         SfnSf ulSfnSf = params.m_sfnSf;
 
         NS_LOG_INFO ("CQI for allocation: " << params.m_sfnSf << " started at sym: " <<
                      +symStart <<
                      " modified allocation " << ulSfnSf <<
-                     " sym Start " << static_cast<uint32_t> (symStart));
+                     " sym Start " << static_cast<uint32_t> (symStart) <<
+                     " stream " << +stream);
 
         auto itAlloc = m_ulAllocationMap.find (ulSfnSf.GetEncoding ());
         NS_ASSERT_MSG (itAlloc != m_ulAllocationMap.end (),
                        "Can't find allocation for " << ulSfnSf);
         std::vector<AllocElem> & ulAllocations = itAlloc->second.m_ulAllocations;
 
-        for (auto it = ulAllocations.cbegin (); it != ulAllocations.cend (); /* NO INC */)
+        for (auto it = ulAllocations.begin (); it != ulAllocations.end (); /* NO INC */)
           {
-            const AllocElem & allocation = *(it);
-            if (allocation.m_symStart == symStart)
+            AllocElem & allocation = *(it);
+            if (allocation.m_symStart == symStart && stream < allocation.m_tbs.size ()
+                && allocation.m_tbs.at (stream) > 0)
               {
                 auto itUe = m_ueMap.find (allocation.m_rnti);
                 NS_ASSERT (itUe != m_ueMap.end ());
                 NS_ASSERT (allocation.m_numSym > 0);
-                NS_ASSERT (allocation.m_tbs > 0);
 
-                m_cqiManagement.UlSBCQIReported (expirationTime, allocation.m_tbs,
+                m_cqiManagement.UlSBCQIReported (expirationTime, allocation.m_tbs.at (stream),
                                                  params, UeInfoOf (*itUe),
                                                  allocation.m_rbgMask,
                                                  m_macSchedSapUser->GetNumRbPerRbg (),
                                                  m_macSchedSapUser->GetSpectrumModel ());
+
+                // A PUSCH sent before the last TPC correction does not include
+                // it: wait for a newer one before computing a new correction
+                auto & ue = UeInfoOf (*itUe);
+                if (m_closedLoopTpc && stream == 0 && ulSfnSf.GetEncoding () >= ue->m_tpcSfn
+                    && ue->m_ulPuschSinr > -std::numeric_limits<double>::infinity ())
+                  {
+                    ue->m_tpcCorrection = m_tpcTargetSinr - ue->m_ulPuschSinr;
+                  }
                 found = true;
-                it = ulAllocations.erase (it);
-              }
-            else
-              {
-                ++it;
+                // Mark the stream as processed
+                allocation.m_tbs.at (stream) = 0;
+                if (std::all_of (allocation.m_tbs.begin (), allocation.m_tbs.end (),
+                                 [] (uint32_t tbs) { return tbs == 0; }))
+                  {
+                    it = ulAllocations.erase (it);
+                    continue;
+                  }
               }
+            ++it;
           }
         NS_ASSERT (found);
 
@@ -910,6 +1140,35 @@ NrMacSchedulerNs3::DoSchedUlCqiInfoReq (const NrMacSchedSapProvider::SchedUlCqiI
           }
       }
       break;
+    case UlCqiInfo::SRS:
+      {
+        auto itUe = m_ueMap.find (params.m_rnti);
+        if (itUe == m_ueMap.end ())
+          {
+            NS_LOG_INFO ("Ignoring the SRS of the unknown RNTI " << params.m_rnti);
+            return;
+          }
+        auto & ue = UeInfoOf (*itUe);
+        m_cqiManagement.UlSrsReported (params, ue, m_macSchedSapUser->GetSpectrumModel (),
+                                       m_ulMaxRank, m_ulRankSinrThreshold);
+        if (params.m_streamId == 0)
+          {
+            double speed = m_getUeSpeedFn ? m_getUeSpeedFn (ue->m_rnti) : -1.0;
+            // The SRS periodicity counts only the slots that can carry the
+            // SRS (F and/or UL, depending on the TDD pattern)
+            double srsSlotRatio = 1.0;
+            if (m_srsLastSlot > m_srsFirstSlot)
+              {
+                srsSlotRatio = static_cast<double> (m_srsSlotCounter - 1) / (m_srsLastSlot - m_srsFirstSlot);
+              }
+            m_schedulerSrs->SrsReported (ue, speed, m_macSchedSapUser->GetSlotPeriod (), srsSlotRatio);
+          }
+        if (m_fixedMcsUl)
+          {
+            std::fill (ue->m_ulMcs.begin (), ue->m_ulMcs.end (), m_startMcsUl);
+          }
+      }
+      break;
     default:
       NS_FATAL_ERROR ("Unknown type of UL-CQI");
     }
@@ -1038,17 +1297,15 @@ NrMacSchedulerNs3::ResetExpiredHARQ (uint16_t rnti, NrMacHarqVector *harq)
 {
   NS_LOG_FUNCTION (this << harq);
 
-  for (auto harqIt = harq->Begin (); harqIt != harq->End (); ++harqIt)
+  const uint32_t numHarqProcess = m_macSchedSapUser->GetNumHarqProcess ();
+  harq->ForEachActive ([&] (uint8_t processId, HarqProcess & process)
     {
-      HarqProcess & process = harqIt->second;
-      uint8_t processId = harqIt->first;
-
       if (process.m_status == HarqProcess::INACTIVE)
         {
-          continue;
+          return;
         }
 
-      if (process.m_timer <m_macSchedSapUser->GetNumHarqProcess())
+      if (process.m_timer < numHarqProcess)
         {
           ++process.m_timer;
           NS_LOG_INFO ("Updated process for UE " << rnti << " number " <<
@@ -1061,7 +1318,7 @@ NrMacSchedulerNs3::ResetExpiredHARQ (uint16_t rnti, NrMacHarqVector *harq)
           NS_LOG_INFO ("Erased process for UE " << rnti << " number " <<
                        static_cast<uint32_t> (processId) << " for time limits");
         }
-    }
+    });
 }
 
 /**
@@ -1252,7 +1509,7 @@ NrMacSchedulerNs3::ComputeActiveUe (ActiveUeMap *activeUe,
           totBuffer += lcg->GetTotalSize ();
         }
 
-      auto harqV = GetHarqVector (ue);
+      const auto & harqV = GetHarqVector (ue);
 
       if (totBuffer > 0 && harqV.CanInsert ())
         {
@@ -1302,14 +1559,13 @@ NrMacSchedulerNs3::AssignBytesToLC (const std::unordered_map<uint8_t, LCGPtr> &u
   uint32_t activeLc = 0;
   for (const auto & lcg : ueLCG)
     {
-      std::vector<uint8_t> lcs = GetLCG (lcg)->GetLCId ();
-      for (const auto & lcId : lcs)
-        {
-          if (GetLCG (lcg)->GetTotalSizeOfLC (lcId) > 0)
-            {
-              ++activeLc;
-            }
-        }
+      GetLCG (lcg)->ForEachLC ([&activeLc] (const NrMacSchedulerLC &lc)
+                               {
+                                 if (lc.GetTotalSize () > 0)
+                                   {
+                                     ++activeLc;
+                                   }
+                               });
     }
 
   if (activeLc == 0)
@@ -1320,18 +1576,23 @@ NrMacSchedulerNs3::AssignBytesToLC (const std::unordered_map<uint8_t, LCGPtr> &u
   uint32_t amountPerLC = tbs / activeLc;
   NS_LOG_INFO ("Total LC: " << activeLc << " each one will receive " << amountPerLC << " bytes");
 
+  ret.reserve (activeLc);
   for (const auto & lcg : ueLCG)
     {
-      std::vector<uint8_t> lcs = GetLCG (lcg)->GetLCId ();
-      for (const auto & lcId : lcs)
+      uint8_t lcgId = GetLCGID (lcg);
+      size_t first = ret.size ();
+      GetLCG (lcg)->ForEachLC ([&ret, lcgId, amountPerLC] (const NrMacSchedulerLC &lc)
+                               {
+                                 if (lc.GetTotalSize () > 0)
+                                   {
+                                     ret.emplace_back (Assignation (lcgId, static_cast<uint8_t> (lc.m_id), amountPerLC));
+                                   }
+                               });
+      for (size_t i = first; i < ret.size (); ++i)
         {
-          if (GetLCG (lcg)->GetTotalSizeOfLC (lcId) > 0)
-            {
-              NS_LOG_INFO ("Assigned to LCID " << static_cast<uint32_t> (lcId) <<
-                           " inside LCG " << static_cast<uint32_t> (GetLCGID (lcg)) <<
-                           " an amount of " << amountPerLC << " B");
-              ret.emplace_back (Assignation (GetLCGID (lcg), lcId, amountPerLC));
-            }
+          NS_LOG_INFO ("Assigned to LCID " << static_cast<uint32_t> (ret.at (i).m_lcId) <<
+                       " inside LCG " << static_cast<uint32_t> (lcgId) <<
+                       " an amount of " << amountPerLC << " B");
         }
     }
 
@@ -1512,7 +1773,7 @@ NrMacSchedulerNs3::DoScheduleDlData (PointInFTPlane *spoint, uint32_t symAvail,
                       uint32_t bytes = bytesPerStream.m_bytes - 3; // Consider the subPdu overhead
                       RlcPduInfo newRlcPdu (lcId, bytes);
                       rlcPdusInfoPerStream.push_back (newRlcPdu);
-                      ue.first->m_dlLCG.at (lcgId)->AssignedData (lcId, bytes, "DL");
+                      ue.first->m_dlLCG.at (lcgId)->AssignedData (lcId, bytes, DciInfoElementTdma::DL);
 
                       NS_LOG_DEBUG ("DL LCG " << static_cast<uint32_t> (lcgId) <<
                                     " LCID " << static_cast<uint32_t> (lcId) <<
@@ -1718,7 +1979,7 @@ NrMacSchedulerNs3::DoScheduleUlData (PointInFTPlane *spoint, uint32_t symAvail,
           for (const auto & byteDistribution : distributedBytes)
             {
               assignedToLC = true;
-              ue.first->m_ulLCG.at (byteDistribution.m_lcg)->AssignedData (byteDistribution.m_lcId, byteDistribution.m_bytes, "UL");
+              ue.first->m_ulLCG.at (byteDistribution.m_lcg)->AssignedData (byteDistribution.m_lcId, byteDistribution.m_bytes, DciInfoElementTdma::UL);
               NS_LOG_DEBUG ("UL LCG " << static_cast<uint32_t> (byteDistribution.m_lcg) <<
                             " assigned bytes " << byteDistribution.m_bytes << " to LCID " <<
                             static_cast<uint32_t> (byteDistribution.m_lcId));
@@ -1818,6 +2079,7 @@ NrMacSchedulerNs3::ScheduleDl (const NrMacSchedSapProvider::SchedDlTriggerReqPar
                                    const std::vector <DlHarqInfo> &dlHarqFeedback)
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (MAC_SCHED_DL);
   NS_LOG_INFO ("Scheduling invoked for slot " << params.m_snfSf << " of type " << params.m_slotType);
 
   NrMacSchedSapUser::SchedConfigIndParameters dlSlot (params.m_snfSf);
@@ -1863,9 +2125,11 @@ NrMacSchedulerNs3::ScheduleDl (const NrMacSchedSapProvider::SchedDlTriggerReqPar
   ActiveUeMap activeDlUe;
   ComputeActiveUe (&activeDlUe, &NrMacSchedulerUeInfo::GetDlLCG,
                    &NrMacSchedulerUeInfo::GetDlHarqVector, "DL");
+  NR_PROFILE_COUNT (MAC_SCHED_DL_UES, CountActiveUe (activeDlUe));
 
   DoScheduleDl (dlHarqFeedback, activeDlHarq, &activeDlUe, params.m_snfSf,
                 ulAllocations, &dlSlot.m_slotAllocInfo);
+  NR_PROFILE_COUNT (MAC_SCHED_DL_RBGS, CountDataRbg (dlSlot.m_slotAllocInfo, DciInfoElementTdma::DL));
 
   // if the number of allocated symbols is greater than GetUlCtrlSymbols (), then don't delete
   // the allocation, as it will be removed when the CQI will be processed.
@@ -1924,6 +2188,7 @@ NrMacSchedulerNs3::ScheduleUl (const NrMacSchedSapProvider::SchedUlTriggerReqPar
                                    const std::vector <UlHarqInfo> &ulHarqFeedback)
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (MAC_SCHED_UL);
   NS_LOG_INFO ("Scheduling invoked for slot " << params.m_snfSf);
 
   NrMacSchedSapUser::SchedConfigIndParameters ulSlot (params.m_snfSf);
@@ -1938,6 +2203,7 @@ NrMacSchedulerNs3::ScheduleUl (const NrMacSchedSapProvider::SchedUlTriggerReqPar
 
   // Doing UL for slot ulSlot
   DoScheduleUl (ulHarqFeedback, params.m_snfSf, &ulSlot.m_slotAllocInfo, params.m_slotType);
+  NR_PROFILE_COUNT (MAC_SCHED_UL_RBGS, CountDataRbg (ulSlot.m_slotAllocInfo, DciInfoElementTdma::UL));
 
   NS_LOG_INFO ("Total DCI for UL : " << ulSlot.m_slotAllocInfo.m_varTtiAllocInfo.size () <<
                " including UL CTRL");
@@ -2010,6 +2276,11 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
 
   if ((m_enableSrsInFSlots == true && type == LteNrTddSlotType::F) || (m_enableSrsInUlSlots == true && type == LteNrTddSlotType::UL))
     { // SRS are included in F slots, and in UL slots if m_enableSrsInUlSlots=true
+      if (m_srsSlotCounter == 0)
+        {
+          m_srsFirstSlot = ulSfn.Normalize ();
+        }
+      m_srsLastSlot = ulSfn.Normalize ();
       m_srsSlotCounter++; // It's an uint, don't worry about wrap around
       NS_ASSERT (m_srsCtrlSymbols <= ulSymAvail);
       uint8_t srsSym = DoScheduleSrs (&ulAssignationStartPoint, allocInfo);
@@ -2070,6 +2341,8 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
         }
     }
 
+  NR_PROFILE_COUNT (MAC_SCHED_UL_UES, CountActiveUe (activeUlUe));
+
   if (ulSymAvail > 0 && activeUlUe.size () > 0)
     {
       uint8_t usedUl = DoScheduleUlData (&ulAssignationStartPoint, ulSymAvail,
@@ -2099,12 +2372,17 @@ NrMacSchedulerNs3::DoScheduleUl (const std::vector <UlHarqInfo> &ulHarqFeedback,
 
           if (alloc.m_dci->m_type == DciInfoElementTdma::DATA)
             {
+              if (m_closedLoopTpc && alloc.m_dci->m_tpc != 1)
+                {
+                  // Remember the first PUSCH that includes this correction
+                  m_ueMap.at (alloc.m_dci->m_rnti)->m_tpcSfn = ulSfn.GetEncoding ();
+                }
               NS_LOG_INFO ("Placed the above allocation in the CQI map");
               allocations.emplace_back (AllocElem (alloc.m_dci->m_rnti,
-                                                   alloc.m_dci->m_tbSize.at (0),
+                                                   alloc.m_dci->m_tbSize,
                                                    alloc.m_dci->m_symStart,
                                                    alloc.m_dci->m_numSym,
-                                                   alloc.m_dci->m_mcs.at (0),
+                                                   alloc.m_dci->m_mcs,
                                                    alloc.m_dci->m_rbgBitmask));
             }
         }
@@ -2144,15 +2422,15 @@ NrMacSchedulerNs3::DoScheduleSrs (PointInFTPlane *spoint, SlotAllocInfo *allocIn
     }
 
   // Find the UE for which this is true:
-  // absolute_slot_number % periodicity = offset_UEx
-  // Assuming that all UEs share the same periodicity.
+  // absolute_slot_number % periodicity_UEx = offset_UEx
+  // The SRS algorithm ensures that only one UE can match.
 
-  uint32_t offset_UEx = m_srsSlotCounter % m_ueMap.begin()->second->m_srsPeriodicity;
   uint16_t rnti = 0;
 
   for (const auto & ue : m_ueMap)
     {
-      if (ue.second->m_srsOffset == offset_UEx)
+      if (ue.second->m_srsPeriodicity != 0
+          && m_srsSlotCounter % ue.second->m_srsPeriodicity == ue.second->m_srsOffset)
         {
           rnti = ue.second->m_rnti;
         }
@@ -32,8 +32,9 @@
 namespace ns3 {
 
 class NrSchedGeneralTestCase;
+class NrCheckpointTopologyTestCase;
 class NrMacSchedulerHarqRr;
-class NrMacSchedulerSrsDefault;
+class NrMacSchedulerSrs;
 
 /**
  * \ingroup scheduler
@@ -476,6 +477,60 @@ public:
    */
   std::vector<uint8_t> GetUlNotchedRbgMask (void) const;
 
+  /**
+   * \brief Set the type of the SRS algorithm
+   * \param type the TypeId of an Object that implements NrMacSchedulerSrs
+   *
+   * It must be called before attaching the UEs.
+   */
+  void SetSrsAlgorithmType (const TypeId &type);
+
+  /**
+   * \brief Get the type of the SRS algorithm
+   * \return the TypeId of the SRS algorithm
+   */
+  TypeId GetSrsAlgorithmType () const;
+
+  /**
+   * \brief Install a function that returns the speed of a UE
+   * \param fn a function that, given the RNTI, returns the speed of the UE
+   * in m/s, or a negative value if it is unknown
+   *
+   * The speed is given to the SRS algorithm every time an SRS is received.
+   */
+  void InstallGetUeSpeedFn (const std::function<double (uint16_t)> &fn);
+
+  /**
+   * \brief Install a function that returns the IMSI of a UE
+   * \param fn a function that, given the RNTI, returns the IMSI of the UE,
+   * or 0 if it is unknown
+   *
+   * The UEs are saved in a checkpoint by IMSI, since the RNTIs depend on the
+   * order of the attachments.
+   */
+  void InstallGetUeImsiFn (const std::function<uint64_t (uint16_t)> &fn);
+
+  /**
+   * \brief Save the state of the UEs, for a later warm start
+   * \param writer the checkpoint writer
+   *
+   * The UEs are saved in increasing RNTI order, each one in its own record
+   * that starts with the type of its state (see
+   * NrMacSchedulerUeInfo::SaveState and NrMacSchedulerUeInfo::GetStateType).
+   */
+  void SaveState (NrCheckpointWriter &writer) const;
+
+  /**
+   * \brief Restore the state of the UEs saved by SaveState
+   * \param reader the checkpoint reader
+   *
+   * The UEs are matched by RNTI, so the topology must be the same as the
+   * one of the checkpoint. UEs that are not attached yet, or whose state has
+   * a different type (e.g., a PF checkpoint restored in a RR scheduler), are
+   * skipped.
+   */
+  void RestoreState (NrCheckpointReader &reader);
+
   /**
    * \brief Set the number of UL SRS symbols
    * \param v number of SRS symbols
@@ -554,6 +609,19 @@ protected:
    */
   virtual uint8_t GetTpc () const = 0;
 
+  /**
+   * \brief Returns the TPC command to put in a UL DCI for the UE
+   * \param ue the UE
+   * \return the TPC command
+   *
+   * When ClosedLoopTpc is disabled, the value is GetTpc(). Otherwise, the
+   * command is chosen to reduce the difference between TpcTargetSinr and
+   * the SINR of the last PUSCH of the UE, assuming that the UE accumulates
+   * the commands (TS 38.213 Table 7.1.1-1: 0 is -1 dB, 1 is 0 dB, 2 is +1 dB,
+   * 3 is +3 dB). Differences below 1 dB are not corrected.
+   */
+  uint8_t GetUeTpc (const std::shared_ptr<NrMacSchedulerUeInfo> &ue) const;
+
   /**
    * \brief Giving the input, append to slotAlloc the allocations for the DL HARQ retransmissions
    * \param startingPoint starting point of the first retransmission.
@@ -761,22 +829,22 @@ private:
     /**
      * \brief AllocElem constructor
      * \param rnti RNTI
-     * \param tbs Transport Block Size
+     * \param tbs Transport Block Size per stream
      * \param numSym Number of symbols
-     * \param mcs MCS
+     * \param mcs MCS per stream
      */
-    AllocElem (uint16_t rnti, uint32_t tbs, uint8_t symStart, uint8_t numSym, uint8_t mcs,
-               const std::vector<uint8_t> &rbgMask)
+    AllocElem (uint16_t rnti, const std::vector<uint32_t> &tbs, uint8_t symStart, uint8_t numSym,
+               const std::vector<uint8_t> &mcs, const std::vector<uint8_t> &rbgMask)
       : m_rnti (rnti), m_tbs (tbs), m_symStart (symStart), m_numSym (numSym), m_mcs (mcs),
         m_rbgMask (rbgMask)
     {
     }
 
     uint16_t m_rnti {0};  //!< Allocated RNTI
-    uint32_t m_tbs  {0};  //!< Allocated TBS
+    std::vector<uint32_t> m_tbs;  //!< Allocated TBS per stream (0 once the CQI of the stream is processed)
     uint8_t m_symStart {0}; //!< Sym start
     uint8_t m_numSym {0}; //!< Allocated symbols
-    uint8_t m_mcs   {0};  //!< MCS of the transmission
+    std::vector<uint8_t> m_mcs;  //!< MCS of the transmission per stream
     std::vector<uint8_t> m_rbgMask; //!< RBG Mask
   };
 
@@ -893,6 +961,10 @@ private:
   bool    m_fixedMcsUl {false}; //!< Fixed MCS for *all* UE in UL
   uint8_t m_startMcsDl   {0};   //!< Starting (or fixed) value for DL MCS
   uint8_t m_startMcsUl   {0};   //!< Starting (or fixed) value for UL MCS
+  uint8_t m_ulMaxRank {1};      //!< Maximum UL rank (attribute)
+  double m_ulRankSinrThreshold {10.0}; //!< Minimum SRS SINR (dB) of all the streams for UL rank 2 (attribute)
+  bool m_closedLoopTpc {false};  //!< Derive the TPC of UL DCIs from the PUSCH SINR (attribute)
+  double m_tpcTargetSinr {10.0}; //!< Target PUSCH SINR (dB) of the closed loop TPC (attribute)
   int8_t m_maxDlMcs   {0};    //!< Maximum index for DL MCS
   Time    m_cqiTimersThreshold; //!< The time while a CQI is valid
 
@@ -917,11 +989,17 @@ private:
 
   std::unique_ptr <NrMacSchedulerHarqRr> m_schedHarq; //!< Pointer to the real HARQ scheduler
 
-  Ptr<NrMacSchedulerSrsDefault> m_schedulerSrs; //!< Pointer to the SRS algorithm
+  Ptr<Object> m_srsAlgorithm; //!< The SRS algorithm
+  NrMacSchedulerSrs *m_schedulerSrs {nullptr}; //!< The SRS interface of m_srsAlgorithm
+  std::function<double (uint16_t)> m_getUeSpeedFn; //!< Function that returns the speed of a UE
+  std::function<uint64_t (uint16_t)> m_getUeImsiFn; //!< Function that returns the IMSI of a UE
 
   uint32_t m_srsSlotCounter {0}; //!< Counter for UL slots
+  uint64_t m_srsFirstSlot {0};   //!< Absolute index of the first slot counted by m_srsSlotCounter
+  uint64_t m_srsLastSlot {0};    //!< Absolute index of the last slot counted by m_srsSlotCounter
 
   friend NrSchedGeneralTestCase;
+  friend NrCheckpointTopologyTestCase;
 
   bool m_enableHarqReTx  {true}; //!< Flag to enable or disable HARQ ReTx (attribute)
 };
@@ -0,0 +1,328 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#define NS_LOG_APPEND_CONTEXT                                            \
+  do                                                                     \
+    {                                                                    \
+      std::clog << " [ CellId " << GetCellId() << ", bwpId "             \
+                << GetBwpId () << "] ";                                  \
+    }                                                                    \
+  while (false);
+
+#include "nr-mac-scheduler-ofdma-sb-pf.h"
+#include "nr-mac-scheduler-ue-info-pf.h"
+#include "nr-amc.h"
+#include <ns3/log.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerOfdmaSbPF");
+NS_OBJECT_ENSURE_REGISTERED (NrMacSchedulerOfdmaSbPF);
+
+TypeId
+NrMacSchedulerOfdmaSbPF::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrMacSchedulerOfdmaSbPF")
+    .SetParent<NrMacSchedulerOfdmaPF> ()
+    .AddConstructor<NrMacSchedulerOfdmaSbPF> ()
+  ;
+  return tid;
+}
+
+NrMacSchedulerOfdmaSbPF::NrMacSchedulerOfdmaSbPF () : NrMacSchedulerOfdmaPF ()
+{
+}
+
+uint8_t
+NrMacSchedulerOfdmaSbPF::GetNumStreams (const std::shared_ptr<NrMacSchedulerUeInfo> &ue) const
+{
+  uint8_t ri = std::max<uint8_t> (ue->m_dlCqi.m_ri, 1);
+  return static_cast<uint8_t> (std::min<size_t> (ri, ue->m_dlMcs.size ()));
+}
+
+uint8_t
+NrMacSchedulerOfdmaSbPF::GetSbMcs (const std::shared_ptr<NrMacSchedulerUeInfo> &ue,
+                                   uint8_t stream, uint32_t rbg) const
+{
+  const auto &cqi = ue->m_dlCqi;
+  if (cqi.m_cqiType == NrMacSchedulerUeInfo::DlCqiInfo::SB && cqi.m_rbPerSb > 0
+      && stream < cqi.m_sbCqi.size ())
+    {
+      uint32_t sb = static_cast<uint32_t> (rbg * GetNumRbPerRbg () / cqi.m_rbPerSb);
+      if (sb < cqi.m_sbCqi.at (stream).size ())
+        {
+          return std::min (m_dlAmc->GetMcsFromCqi (cqi.m_sbCqi.at (stream).at (sb)),
+                           static_cast<uint8_t> (GetMaxDlMcs ()));
+        }
+    }
+  return ue->m_dlMcs.at (stream);
+}
+
+void
+NrMacSchedulerOfdmaSbPF::UpdateSbTbSize (const std::shared_ptr<NrMacSchedulerUeInfo> &ue) const
+{
+  const SbAllocation &alloc = m_dlSbAllocation.at (ue->m_rnti);
+  if (ue->m_dlCqi.m_cqiType != NrMacSchedulerUeInfo::DlCqiInfo::SB || alloc.m_numRbg == 0)
+    {
+      return;
+    }
+
+  // Only the streams that got a TB with the wideband MCS (given the RI)
+  for (uint8_t stream = 0; stream < ue->m_dlTbSize.size (); ++stream)
+    {
+      if (ue->m_dlTbSize.at (stream) > 0 && stream < alloc.m_mcsSum.size ())
+        {
+          uint8_t mcs = static_cast<uint8_t> (alloc.m_mcsSum.at (stream) / alloc.m_numRbg);
+          ue->m_dlTbSize.at (stream) = m_dlAmc->CalculateTbSize (mcs, ue->m_dlRBG * GetNumRbPerRbg ());
+        }
+    }
+}
+
+/**
+ * \brief Assign the available DL RBG to the UEs
+ * \param symAvail Available symbols
+ * \param activeDl Map of active UE and their beams
+ * \return a map between beams and the symbol they need
+ *
+ * The symbols of each beam are computed by GetSymPerBeam(). Then, for each
+ * beam, the RBGs are visited in order, and each one is assigned to the UE
+ * with the highest PF metric in that RBG, among the UEs that still need
+ * resources to empty their buffer. The metrics of the UEs are updated after
+ * each assignment as in NrMacSchedulerOfdma::AssignDLRBG.
+ */
+NrMacSchedulerNs3::BeamSymbolMap
+NrMacSchedulerOfdmaSbPF::AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const
+{
+  NS_LOG_FUNCTION (this);
+
+  NS_LOG_DEBUG ("# beams active flows: " << activeDl.size () << ", # sym: " << symAvail);
+
+  GetFirst GetBeamId;
+  GetSecond GetUeVector;
+  GetFirst GetUe;
+  BeamSymbolMap symPerBeam = GetSymPerBeam (symAvail, activeDl);
+
+  std::vector<uint8_t> dlNotchedRBGsMask = GetDlNotchedRbgMask ();
+  if (dlNotchedRBGsMask.size () == 0)
+    {
+      dlNotchedRBGsMask = std::vector<uint8_t> (GetBandwidthInRbg (), 1);
+    }
+  NS_ASSERT (dlNotchedRBGsMask.size () == GetBandwidthInRbg ());
+
+  // The rate of each MCS is proportional to the TBS over the entire bandwidth
+  std::vector<double> mcsRate (m_dlAmc->GetMaxMcs () + 1, -1.0);
+  auto getRate = [&] (uint8_t mcs)
+    {
+      if (mcsRate.at (mcs) < 0.0)
+        {
+          mcsRate.at (mcs) = m_dlAmc->CalculateTbSize (mcs, GetBandwidthInRbg () * GetNumRbPerRbg ());
+        }
+      return mcsRate.at (mcs);
+    };
+
+  m_dlSbAllocation.clear ();
+
+  // Iterate through the different beams
+  for (const auto &el : activeDl)
+    {
+      uint32_t beamSym = symPerBeam.at (GetBeamId (el));
+      uint32_t rbgAssignable = 1 * beamSym;
+      std::vector<UePtrAndBufferReq> ueVector;
+      FTResources assigned (0,0);
+
+      for (const auto &ue : GetUeVector (el))
+        {
+          ueVector.emplace_back (ue);
+        }
+
+      for (auto & ue : ueVector)
+        {
+          BeforeDlSched (ue, FTResources (rbgAssignable * beamSym, beamSym));
+          SbAllocation alloc;
+          alloc.m_rbgMask = std::vector<uint8_t> (GetBandwidthInRbg (), 0);
+          alloc.m_mcsSum = std::vector<uint32_t> (GetUe (ue)->m_dlMcs.size (), 0);
+          m_dlSbAllocation[GetUe (ue)->m_rnti] = alloc;
+        }
+
+      for (uint32_t rbg = 0; rbg < GetBandwidthInRbg (); ++rbg)
+        {
+          if (dlNotchedRBGsMask.at (rbg) == 0)
+            {
+              continue;
+            }
+
+          // Pass over UEs which already has enough resources to transmit
+          auto bestIt = ueVector.end ();
+          double bestMetric = -1.0;
+          for (auto it = ueVector.begin (); it != ueVector.end (); ++it)
+            {
+              uint32_t bufQueueSize = it->second;
+              if (NrMacSchedulerUeInfo::GetDlTBS (GetUe (*it)) >= std::max (bufQueueSize, 7U))
+                {
+                  continue;
+                }
+
+              auto uePtr = std::dynamic_pointer_cast<NrMacSchedulerUeInfoPF> (GetUe (*it));
+              double rate = 0.0;
+              for (uint8_t stream = 0; stream < GetNumStreams (uePtr); ++stream)
+                {
+                  rate += getRate (GetSbMcs (uePtr, stream, rbg));
+                }
+              double metric = std::pow (rate, uePtr->m_alpha) / std::max (1E-9, uePtr->m_avgTputDl);
+              if (metric > bestMetric)
+                {
+                  bestMetric = metric;
+                  bestIt = it;
+                }
+            }
+
+          // In the case that all the UE already have their requirements fullfilled,
+          // then stop the beam processing and pass to the next
+          if (bestIt == ueVector.end ())
+            {
+              break;
+            }
+
+          const auto &bestUe = GetUe (*bestIt);
+          SbAllocation &alloc = m_dlSbAllocation.at (bestUe->m_rnti);
+          alloc.m_rbgMask.at (rbg) = 1;
+          alloc.m_numRbg++;
+          for (uint8_t stream = 0; stream < alloc.m_mcsSum.size (); ++stream)
+            {
+              alloc.m_mcsSum.at (stream) += GetSbMcs (bestUe, stream, rbg);
+            }
+
+          bestUe->m_dlRBG += rbgAssignable;
+          assigned.m_rbg += rbgAssignable;
+
+          bestUe->m_dlSym = beamSym;
+          assigned.m_sym = beamSym;
+
+          NS_LOG_DEBUG ("Assigned RBG " << rbg << ", spanned over " << beamSym <<
+                        " SYM, to UE " << bestUe->m_rnti << " with metric " << bestMetric);
+
+          AssignedDlResources (*bestIt, FTResources (rbgAssignable, beamSym), assigned);
+
+          // Update metrics for the unsuccessfull UEs (who did not get any resource in this iteration)
+          for (auto & ue : ueVector)
+            {
+              if (GetUe (ue)->m_rnti != bestUe->m_rnti)
+                {
+                  NotAssignedDlResources (ue, FTResources (rbgAssignable, beamSym),
+                                          assigned);
+                }
+            }
+
+          // The metric updates compute the TBS with the wideband MCS
+          for (auto & ue : ueVector)
+            {
+              UpdateSbTbSize (GetUe (ue));
+            }
+        }
+
+      // As in NrMacSchedulerOfdma, a stream that is not needed to empty the
+      // buffer (because the previous streams are enough) does not get a TB
+      for (auto & ue : ueVector)
+        {
+          uint32_t copyBufQueueSize = ue.second;
+          for (auto &tbSize : GetUe (ue)->m_dlTbSize)
+            {
+              if (copyBufQueueSize == 0)
+                {
+                  tbSize = 0;
+                }
+              else
+                {
+                  copyBufQueueSize -= std::min (tbSize, copyBufQueueSize);
+                }
+            }
+        }
+    }
+
+  return symPerBeam;
+}
+
+std::shared_ptr<DciInfoElementTdma>
+NrMacSchedulerOfdmaSbPF::CreateDlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
+                                      const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+                                      uint32_t maxSym) const
+{
+  NS_LOG_FUNCTION (this);
+
+  auto allocIt = m_dlSbAllocation.find (ueInfo->m_rnti);
+  NS_ASSERT (allocIt != m_dlSbAllocation.end ());
+  const SbAllocation &alloc = allocIt->second;
+  NS_ASSERT_MSG (alloc.m_numRbg * maxSym == ueInfo->m_dlRBG,
+                 "If you see this message, it means that the AssignRBG and CreateDci method are unaligned");
+
+  std::vector<uint8_t> mcs = ueInfo->m_dlMcs;
+  if (ueInfo->m_dlCqi.m_cqiType == NrMacSchedulerUeInfo::DlCqiInfo::SB)
+    {
+      for (uint8_t stream = 0; stream < mcs.size () && stream < alloc.m_mcsSum.size (); ++stream)
+        {
+          mcs.at (stream) = static_cast<uint8_t> (alloc.m_mcsSum.at (stream) / alloc.m_numRbg);
+        }
+    }
+
+  //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
+  std::vector<uint8_t> ndi (ueInfo->m_dlTbSize.size (), 0);
+  std::vector<uint8_t> rv (ueInfo->m_dlTbSize.size (), 0);
+  uint16_t countLessThan7B = 0;
+
+  for (uint32_t numTb = 0; numTb < ueInfo->m_dlTbSize.size (); numTb++)
+    {
+      if (ueInfo->m_dlTbSize.at (numTb) < 7)
+        {
+          countLessThan7B++;
+          ueInfo->m_dlTbSize.at (numTb) = 0;
+          continue;
+        }
+      ndi.at (numTb) = 1;
+    }
+
+  // If the size of all the TBs is less than 7 bytes (3 mac header, 2 rlc header, 2 data),
+  // then we can't transmit any new data, so don't create dci.
+  if (countLessThan7B == ueInfo->m_dlTbSize.size ())
+    {
+      NS_LOG_DEBUG ("While creating DCI for UE " << ueInfo->m_rnti <<
+                    " assigned " << ueInfo->m_dlRBG << " DL RBG, but TBS < 7");
+      return nullptr;
+    }
+
+  std::ostringstream oss;
+  for (const auto & x: alloc.m_rbgMask)
+    {
+      oss << std::to_string (x) << " ";
+    }
+  NS_LOG_INFO ("UE " << ueInfo->m_rnti << " assigned RBG mask " << oss.str () <<
+               " for " << static_cast<uint32_t> (maxSym) << " SYM.");
+
+  NS_ASSERT (maxSym <= UINT8_MAX);
+  std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
+      (ueInfo->m_rnti, DciInfoElementTdma::DL, spoint->m_sym, maxSym, mcs,
+       ueInfo->m_dlTbSize, ndi, rv, DciInfoElementTdma::DATA, GetBwpId (), GetTpc ());
+
+  dci->m_rbgBitmask = alloc.m_rbgMask;
+
+  return dci;
+}
+
+} // namespace ns3
@@ -0,0 +1,115 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#pragma once
+#include "nr-mac-scheduler-ofdma-pf.h"
+#include <unordered_map>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief Assign each DL RBG to the UE with the best sub-band proportional fair metric
+ *
+ * The symbols of each beam are computed as in NrMacSchedulerOfdma. Then,
+ * instead of assigning to the first UE (in PF order) the next free RBG, the
+ * scheduler visits the RBGs in order and assigns each one to the UE with the
+ * highest PF metric in that RBG:
+ *
+ * \f$ pfMetric_{i,r} = std::pow(rate_{i,r}, alpha) / std::max (1E-9, m_avgTput_{i}) \f$
+ *
+ * where \f$ rate_{i,r} \f$ depends on the MCS corresponding to the sub-band
+ * CQI reported by the UE i for the sub-band of the RBG r (summed over its
+ * streams). The UEs that report only the wideband CQI use their wideband
+ * MCS, so the gain comes from the UEs that report sub-band CQI (see the
+ * NrUePhy attribute SubbandCqiSize).
+ *
+ * The resulting RBG mask of a UE can be non contiguous. The MCS of a UE that
+ * reported sub-band CQI is, for each stream, the average of the MCS of the
+ * sub-bands of its RBGs, and the TBS is computed with it.
+ *
+ * Only the DL is frequency-selective; the UL is scheduled as in
+ * NrMacSchedulerOfdmaPF.
+ */
+class NrMacSchedulerOfdmaSbPF : public NrMacSchedulerOfdmaPF
+{
+public:
+  /**
+   * \brief GetTypeId
+   * \return The TypeId of the class
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief NrMacSchedulerOfdmaSbPF constructor
+   */
+  NrMacSchedulerOfdmaSbPF ();
+
+  /**
+   * \brief ~NrMacSchedulerOfdmaSbPF deconstructor
+   */
+  virtual ~NrMacSchedulerOfdmaSbPF () override
+  {
+  }
+
+protected:
+  virtual BeamSymbolMap
+  AssignDLRBG (uint32_t symAvail, const ActiveUeMap &activeDl) const override;
+
+  virtual std::shared_ptr<DciInfoElementTdma>
+  CreateDlDci (PointInFTPlane *spoint, const std::shared_ptr<NrMacSchedulerUeInfo> &ueInfo,
+               uint32_t maxSym) const override;
+
+private:
+  /**
+   * \brief RBGs assigned to a UE in the current slot
+   */
+  struct SbAllocation
+  {
+    std::vector<uint8_t> m_rbgMask;   //!< Assigned RBGs
+    std::vector<uint32_t> m_mcsSum;   //!< Sum, for each stream, of the sub-band MCS of the assigned RBGs
+    uint32_t m_numRbg {0};            //!< Number of assigned RBGs (in frequency)
+  };
+
+  /**
+   * \brief Get the MCS of a stream of a UE in a RBG
+   * \param ue the UE
+   * \param stream the stream
+   * \param rbg the RBG
+   * \return the MCS of the sub-band of the RBG, or the wideband MCS if the UE
+   * did not report sub-band CQI
+   */
+  uint8_t GetSbMcs (const std::shared_ptr<NrMacSchedulerUeInfo> &ue, uint8_t stream, uint32_t rbg) const;
+
+  /**
+   * \brief Get the number of streams used by the UE
+   * \param ue the UE
+   * \return the number of streams, given the reported RI
+   */
+  uint8_t GetNumStreams (const std::shared_ptr<NrMacSchedulerUeInfo> &ue) const;
+
+  /**
+   * \brief Replace the TBS (computed with the wideband MCS) with the one
+   * computed with the average sub-band MCS of the assigned RBGs
+   * \param ue the UE
+   */
+  void UpdateSbTbSize (const std::shared_ptr<NrMacSchedulerUeInfo> &ue) const;
+
+  mutable std::unordered_map<uint16_t, SbAllocation> m_dlSbAllocation; //!< DL RBGs assigned to each UE in the current slot
+};
+
+} // namespace ns3
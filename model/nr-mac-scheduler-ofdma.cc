@@ -350,8 +350,22 @@ NrMacSchedulerOfdma::AssignULRBG (uint32_t symAvail, const ActiveUeMap &activeUl
           while (schedInfoIt != ueVector.end ())
             {
               uint32_t bufQueueSize = schedInfoIt->second;
-              if (GetUe (*schedInfoIt)->m_ulTbSize >= std::max (bufQueueSize, 7U))
+              if (NrMacSchedulerUeInfo::GetUlTBS (GetUe (*schedInfoIt)) >= std::max (bufQueueSize, 7U))
                 {
+                  // As in DL, with UL MIMO the streams that are not needed
+                  // to empty the buffer do not get a TB
+                  uint32_t copyBufQueueSize = bufQueueSize;
+                  for (auto &tbSize : GetUe (*schedInfoIt)->m_ulTbSize)
+                    {
+                      if (copyBufQueueSize == 0)
+                        {
+                          tbSize = 0;
+                        }
+                      else
+                        {
+                          copyBufQueueSize -= std::min (tbSize, copyBufQueueSize);
+                        }
+                    }
                   schedInfoIt++;
                 }
               else
@@ -526,12 +540,28 @@ NrMacSchedulerOfdma::CreateUlDci (PointInFTPlane *spoint,
 {
   NS_LOG_FUNCTION (this);
 
-  uint32_t tbs = m_ulAmc->CalculateTbSize (ueInfo->m_ulMcs,
-                                           ueInfo->m_ulRBG * GetNumRbPerRbg ());
+  // The TB size of each stream is computed in UpdateUlMetric, and it is 0 for
+  // the streams beyond the UL rank, or not needed to empty the buffer.
+  // If it is less than 7 (3 mac header, 2 rlc header, 2 data), then we can't
+  // transmit any new data in that stream; if no stream can, don't create dci.
+  //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
+  std::vector<uint8_t> ndi (ueInfo->m_ulTbSize.size (), 0);
+  std::vector<uint8_t> rv (ueInfo->m_ulTbSize.size (), 0);
+  std::vector<uint32_t> ulTbs (ueInfo->m_ulTbSize.size (), 0);
+  bool anyTb = false;
+  for (uint8_t stream = 0; stream < ueInfo->m_ulTbSize.size (); ++stream)
+    {
+      if (ueInfo->m_ulTbSize.at (stream) < 7)
+        {
+          ueInfo->m_ulTbSize.at (stream) = 0;
+          continue;
+        }
+      ulTbs.at (stream) = ueInfo->m_ulTbSize.at (stream);
+      ndi.at (stream) = 1;
+      anyTb = true;
+    }
 
-  // If is less than 7 (3 mac header, 2 rlc header, 2 data), then we can't
-  // transmit any new data, so don't create dci.
-  if (tbs < 7)
+  if (! anyTb)
     {
       NS_LOG_DEBUG ("While creating DCI for UE " << ueInfo->m_rnti <<
                     " assigned " << ueInfo->m_ulRBG << " UL RBG, but TBS < 7");
@@ -579,16 +609,10 @@ NrMacSchedulerOfdma::CreateUlDci (PointInFTPlane *spoint,
                static_cast<uint32_t> (spoint->m_rbg + assigned) << " for " <<
                static_cast<uint32_t> (maxSym) << " SYM.");
 
-  //Due to MIMO implementation MCS, TB size, ndi, rv, are vectors
-  std::vector<uint8_t> ulMcs = {ueInfo->m_ulMcs};
-  std::vector<uint32_t> ulTbs = {tbs};
-  std::vector<uint8_t> ndi = {1};
-  std::vector<uint8_t> rv = {0};
-
   NS_ASSERT (spoint->m_sym >= maxSym);
   std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
-      (ueInfo->m_rnti, DciInfoElementTdma::UL, spoint->m_sym - maxSym, maxSym, ulMcs,
-       ulTbs, ndi, rv, DciInfoElementTdma::DATA, GetBwpId (), GetTpc());
+      (ueInfo->m_rnti, DciInfoElementTdma::UL, spoint->m_sym - maxSym, maxSym, ueInfo->m_ulMcs,
+       ulTbs, ndi, rv, DciInfoElementTdma::DATA, GetBwpId (), GetUeTpc (ueInfo));
 
   dci->m_rbgBitmask = std::move (rbgBitmask);
 
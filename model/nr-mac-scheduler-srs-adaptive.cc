@@ -0,0 +1,420 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include "nr-mac-scheduler-srs-adaptive.h"
+
+#include <ns3/uinteger.h>
+#include <ns3/double.h>
+#include <ns3/log.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrMacSchedulerSrsAdaptive");
+NS_OBJECT_ENSURE_REGISTERED (NrMacSchedulerSrsAdaptive);
+
+std::vector<uint32_t>
+NrMacSchedulerSrsAdaptive::StandardPeriodicity = {
+  2, 4, 5, 8, 10, 16, 20, 32, 40, 64, 80, 160, 320, 640, 1280, 2560
+};
+
+NrMacSchedulerSrsAdaptive::NrMacSchedulerSrsAdaptive ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NrMacSchedulerSrsAdaptive::~NrMacSchedulerSrsAdaptive ()
+{
+}
+
+TypeId
+NrMacSchedulerSrsAdaptive::GetTypeId ()
+{
+  static TypeId tid = TypeId ("ns3::NrMacSchedulerSrsAdaptive")
+    .SetParent<Object> ()
+    .AddConstructor<NrMacSchedulerSrsAdaptive> ()
+    .SetGroupName ("nr")
+    .AddAttribute ("MinPeriodicity",
+                   "Shortest periodicity that can be assigned to a UE",
+                   UintegerValue (10),
+                   MakeUintegerAccessor (&NrMacSchedulerSrsAdaptive::m_minPeriodicity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("MaxPeriodicity",
+                   "Longest periodicity that can be assigned to a UE",
+                   UintegerValue (320),
+                   MakeUintegerAccessor (&NrMacSchedulerSrsAdaptive::m_maxPeriodicity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("StartingPeriodicity",
+                   "Periodicity of the UEs when they are added",
+                   UintegerValue (80),
+                   MakeUintegerAccessor (&NrMacSchedulerSrsAdaptive::m_startingPeriodicity),
+                   MakeUintegerChecker<uint32_t> ())
+    .AddAttribute ("SinrStdDevHigh",
+                   "Standard deviation (dB) of the SRS SINR above which the "
+                   "periodicity of a UE is halved",
+                   DoubleValue (3.0),
+                   MakeDoubleAccessor (&NrMacSchedulerSrsAdaptive::m_sinrStdDevHigh),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("SinrStdDevLow",
+                   "Standard deviation (dB) of the SRS SINR below which the "
+                   "periodicity of a UE is doubled",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&NrMacSchedulerSrsAdaptive::m_sinrStdDevLow),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MaxDisplacement",
+                   "Maximum distance (m) that a UE, whose speed is known, can "
+                   "travel between two SRS",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&NrMacSchedulerSrsAdaptive::m_maxDisplacement),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("MinReports",
+                   "Number of SRS to receive with a periodicity before changing it again",
+                   UintegerValue (4),
+                   MakeUintegerAccessor (&NrMacSchedulerSrsAdaptive::m_minReports),
+                   MakeUintegerChecker<uint32_t> (1))
+  ;
+  return tid;
+}
+
+int64_t
+NrMacSchedulerSrsAdaptive::AssignStreams (int64_t stream)
+{
+  NS_LOG_FUNCTION (this << stream);
+  return 0;
+}
+
+void
+NrMacSchedulerSrsAdaptive::Configure ()
+{
+  if (! m_periodicities.empty ())
+    {
+      return;
+    }
+
+  for (uint32_t p : {m_minPeriodicity, m_maxPeriodicity, m_startingPeriodicity})
+    {
+      if (std::find (StandardPeriodicity.begin (), StandardPeriodicity.end (), p) == StandardPeriodicity.end ())
+        {
+          NS_FATAL_ERROR ("You cannot use " << p <<
+                          " as periodicity; please use a standard value like "
+                          "2, 4, 5, 8, 10, 16, 20, 32, 40, 64, 80, 160, 320, 640, 1280, 2560");
+        }
+    }
+  NS_ABORT_MSG_IF (m_minPeriodicity > m_maxPeriodicity, "MinPeriodicity is greater than MaxPeriodicity");
+  NS_ABORT_MSG_IF (m_sinrStdDevLow > m_sinrStdDevHigh, "SinrStdDevLow is greater than SinrStdDevHigh");
+
+  // From the longest periodicity, take each time the longest standard
+  // periodicity that divides the previous one
+  m_periodicities.push_back (m_maxPeriodicity);
+  for (auto it = StandardPeriodicity.rbegin (); it != StandardPeriodicity.rend (); ++it)
+    {
+      if (*it >= m_minPeriodicity && *it < m_periodicities.back () && m_periodicities.back () % *it == 0)
+        {
+          m_periodicities.push_back (*it);
+        }
+    }
+  std::reverse (m_periodicities.begin (), m_periodicities.end ());
+
+  NS_ABORT_MSG_IF (std::find (m_periodicities.begin (), m_periodicities.end (), m_startingPeriodicity) == m_periodicities.end (),
+                   "StartingPeriodicity " << m_startingPeriodicity << " does not divide " << m_maxPeriodicity <<
+                   ", or it is not between " << m_minPeriodicity << " and " << m_maxPeriodicity);
+
+  // At the beginning, all the offsets of the shortest periodicity are free
+  m_freeOffsets.resize (m_periodicities.size ());
+  for (uint32_t i = 0; i < m_periodicities.front (); ++i)
+    {
+      m_freeOffsets.front ().insert (i);
+    }
+}
+
+const std::vector<uint32_t> &
+NrMacSchedulerSrsAdaptive::GetPeriodicities () const
+{
+  return m_periodicities;
+}
+
+size_t
+NrMacSchedulerSrsAdaptive::GetNumFreeOffsets (uint32_t periodicity) const
+{
+  return m_freeOffsets.at (GetLevel (periodicity)).size ();
+}
+
+uint32_t
+NrMacSchedulerSrsAdaptive::GetLevel (uint32_t periodicity) const
+{
+  auto it = std::find (m_periodicities.begin (), m_periodicities.end (), periodicity);
+  NS_ASSERT_MSG (it != m_periodicities.end (), "Periodicity " << periodicity << " not managed by this algorithm");
+  return static_cast<uint32_t> (std::distance (m_periodicities.begin (), it));
+}
+
+NrMacSchedulerSrs::SrsPeriodicityAndOffset
+NrMacSchedulerSrsAdaptive::Allocate (uint32_t level)
+{
+  SrsPeriodicityAndOffset ret;
+
+  // Split the longest periodicity that has a free offset, to keep the
+  // shorter ones available for the UEs that need them
+  int32_t from = static_cast<int32_t> (level);
+  while (from >= 0 && m_freeOffsets.at (from).empty ())
+    {
+      --from;
+    }
+  if (from < 0)
+    {
+      return ret; // ret will be invalid
+    }
+
+  uint32_t offset = *m_freeOffsets.at (from).begin ();
+  m_freeOffsets.at (from).erase (m_freeOffsets.at (from).begin ());
+  for (uint32_t l = static_cast<uint32_t> (from); l < level; ++l)
+    {
+      for (uint32_t sibling = offset + m_periodicities.at (l); sibling < m_periodicities.at (l + 1);
+           sibling += m_periodicities.at (l))
+        {
+          m_freeOffsets.at (l + 1).insert (sibling);
+        }
+    }
+
+  ret.m_isValid = true;
+  ret.m_periodicity = m_periodicities.at (level);
+  ret.m_offset = offset;
+  return ret;
+}
+
+void
+NrMacSchedulerSrsAdaptive::Release (uint32_t offset, uint32_t level)
+{
+  NS_ASSERT (offset < m_periodicities.at (level));
+  m_freeOffsets.at (level).insert (offset);
+
+  while (level > 0)
+    {
+      uint32_t shorter = m_periodicities.at (level - 1);
+      uint32_t parent = offset % shorter;
+      for (uint32_t sibling = parent; sibling < m_periodicities.at (level); sibling += shorter)
+        {
+          if (m_freeOffsets.at (level).count (sibling) == 0)
+            {
+              return;
+            }
+        }
+      for (uint32_t sibling = parent; sibling < m_periodicities.at (level); sibling += shorter)
+        {
+          m_freeOffsets.at (level).erase (sibling);
+        }
+      --level;
+      offset = parent;
+      m_freeOffsets.at (level).insert (offset);
+    }
+}
+
+void
+NrMacSchedulerSrsAdaptive::Reserve (uint32_t offset, uint32_t level)
+{
+  // The free offset that contains it, of the same or of a shorter periodicity
+  int32_t from = static_cast<int32_t> (level);
+  while (from >= 0 && m_freeOffsets.at (from).count (offset % m_periodicities.at (from)) == 0)
+    {
+      --from;
+    }
+  NS_ASSERT_MSG (from >= 0, "Offset " << offset << " of periodicity " << m_periodicities.at (level) <<
+                 " is not free");
+
+  m_freeOffsets.at (from).erase (offset % m_periodicities.at (from));
+  for (uint32_t l = static_cast<uint32_t> (from); l < level; ++l)
+    {
+      uint32_t parent = offset % m_periodicities.at (l);
+      uint32_t child = offset % m_periodicities.at (l + 1);
+      for (uint32_t sibling = parent; sibling < m_periodicities.at (l + 1); sibling += m_periodicities.at (l))
+        {
+          if (sibling != child)
+            {
+              m_freeOffsets.at (l + 1).insert (sibling);
+            }
+        }
+    }
+}
+
+bool
+NrMacSchedulerSrsAdaptive::MoveUe (const std::shared_ptr<NrMacSchedulerUeInfo> &ue, uint32_t level)
+{
+  uint32_t oldLevel = GetLevel (ue->m_srsPeriodicity);
+  if (level == oldLevel)
+    {
+      return false;
+    }
+
+  Release (ue->m_srsOffset, oldLevel);
+  SrsPeriodicityAndOffset srs = Allocate (level);
+  if (! srs.m_isValid)
+    {
+      // Take back the same offset: the UE keeps sending the SRS in its slots
+      Reserve (ue->m_srsOffset, oldLevel);
+      NS_LOG_INFO ("No free offset with periodicity " << m_periodicities.at (level) <<
+                   " for RNTI " << ue->m_rnti);
+      return false;
+    }
+
+  NS_LOG_INFO ("SRS of RNTI " << ue->m_rnti << " moved from periodicity " << ue->m_srsPeriodicity <<
+               " offset " << ue->m_srsOffset << " to periodicity " << srs.m_periodicity <<
+               " offset " << srs.m_offset);
+  ue->m_srsPeriodicity = srs.m_periodicity;
+  ue->m_srsOffset = srs.m_offset;
+  ue->m_srsReports = 0;
+  return true;
+}
+
+NrMacSchedulerSrs::SrsPeriodicityAndOffset
+NrMacSchedulerSrsAdaptive::AddUe ()
+{
+  NS_LOG_FUNCTION (this);
+  Configure ();
+
+  // If the starting periodicity is full, try with a longer one
+  for (uint32_t level = GetLevel (m_startingPeriodicity); level < m_periodicities.size (); ++level)
+    {
+      SrsPeriodicityAndOffset ret = Allocate (level);
+      if (ret.m_isValid)
+        {
+          return ret;
+        }
+    }
+  return SrsPeriodicityAndOffset (); // invalid
+}
+
+void
+NrMacSchedulerSrsAdaptive::RemoveUe (uint32_t offset, uint32_t periodicity)
+{
+  NS_LOG_FUNCTION (this << offset << periodicity);
+  if (periodicity == 0)
+    {
+      return; // The UE never got an offset
+    }
+  Release (offset, GetLevel (periodicity));
+}
+
+bool
+NrMacSchedulerSrsAdaptive::IncreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap)
+{
+  NS_LOG_FUNCTION (this);
+  Configure ();
+
+  while (true)
+    {
+      // Give an offset to the UEs that do not have one
+      bool allAssigned = true;
+      for (auto & ue : *ueMap)
+        {
+          if (ue.second->m_srsPeriodicity != 0)
+            {
+              continue;
+            }
+          SrsPeriodicityAndOffset srs = AddUe ();
+          if (! srs.m_isValid)
+            {
+              allAssigned = false;
+              break;
+            }
+          ue.second->m_srsPeriodicity = srs.m_periodicity;
+          ue.second->m_srsOffset = srs.m_offset;
+        }
+      if (allAssigned)
+        {
+          return true;
+        }
+
+      // Make room by doubling the periodicity of the UE that sends the SRS
+      // more often (the lowest RNTI, for ties)
+      std::shared_ptr<NrMacSchedulerUeInfo> shortest;
+      for (const auto & ue : *ueMap)
+        {
+          uint32_t periodicity = ue.second->m_srsPeriodicity;
+          if (periodicity != 0 && periodicity < m_periodicities.back ()
+              && (shortest == nullptr || periodicity < shortest->m_srsPeriodicity
+                  || (periodicity == shortest->m_srsPeriodicity && ue.first < shortest->m_rnti)))
+            {
+              shortest = ue.second;
+            }
+        }
+      if (shortest == nullptr || ! MoveUe (shortest, GetLevel (shortest->m_srsPeriodicity) + 1))
+        {
+          return false;
+        }
+    }
+}
+
+bool
+NrMacSchedulerSrsAdaptive::DecreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap)
+{
+  NS_LOG_FUNCTION (this);
+  Configure ();
+
+  bool ret = false;
+  for (auto & ue : *ueMap)
+    {
+      uint32_t periodicity = ue.second->m_srsPeriodicity;
+      if (periodicity != 0 && periodicity > m_periodicities.front ())
+        {
+          ret |= MoveUe (ue.second, GetLevel (periodicity) - 1);
+        }
+    }
+  return ret;
+}
+
+bool
+NrMacSchedulerSrsAdaptive::SrsReported (const std::shared_ptr<NrMacSchedulerUeInfo> &ue, double speed,
+                                        const Time &slotPeriod, double srsSlotRatio)
+{
+  NS_LOG_FUNCTION (this << ue->m_rnti << speed << srsSlotRatio);
+  NS_ASSERT (srsSlotRatio > 0.0 && srsSlotRatio <= 1.0);
+
+  if (ue->m_srsPeriodicity == 0 || ue->m_srsReports < m_minReports)
+    {
+      return false;
+    }
+
+  uint32_t level = GetLevel (ue->m_srsPeriodicity);
+  double stdDev = std::sqrt (ue->m_srsSinrVar);
+  if (stdDev > m_sinrStdDevHigh && level > 0)
+    {
+      --level;
+    }
+  else if (stdDev < m_sinrStdDevLow && level + 1 < m_periodicities.size ())
+    {
+      ++level;
+    }
+
+  if (speed > 0.0)
+    {
+      // Longest periodicity for which the UE moves at most m_maxDisplacement;
+      // a period of the SRS lasts 1 / srsSlotRatio slots on average
+      double maxSlots = m_maxDisplacement * srsSlotRatio / (speed * slotPeriod.GetSeconds ());
+      while (level > 0 && m_periodicities.at (level) > maxSlots)
+        {
+          --level;
+        }
+    }
+
+  NS_LOG_DEBUG ("RNTI " << ue->m_rnti << " SRS SINR std dev " << stdDev << " dB, speed " << speed <<
+                " m/s, periodicity " << ue->m_srsPeriodicity << " -> " << m_periodicities.at (level));
+  return MoveUe (ue, level);
+}
+
+} // namespace ns3
@@ -0,0 +1,158 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_MAC_SCHEDULER_SRS_ADAPTIVE_H
+#define NR_MAC_SCHEDULER_SRS_ADAPTIVE_H
+
+#include <ns3/object.h>
+
+#include "nr-mac-scheduler-srs.h"
+
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ * \brief SRS algorithm that adapts the periodicity of each UE to its channel
+ *
+ * Each UE has its own periodicity, taken from a chain of standard
+ * periodicities in which each value divides the next one (e.g., 10, 20, 40,
+ * 80, 160, 320). The chain is built backward from MaxPeriodicity, and stops
+ * at MinPeriodicity.
+ *
+ * Thanks to the divisibility, the offsets are managed like a buddy
+ * allocator, with a free list for each periodicity. An offset `o` of
+ * periodicity `P` is split in the offsets `o + i * P` of the next
+ * periodicity when needed, and merged back when all of them are free. Adding,
+ * removing or moving a UE therefore touches only that UE, and two UEs never
+ * send the SRS in the same slot.
+ *
+ * Every time the SRS of a UE is received, after at least MinReports SRS with
+ * the current periodicity:
+ *
+ * - the periodicity is halved if the standard deviation of the SRS SINR
+ *   (see NrMacSchedulerCQIManagement::UlSrsReported) is above
+ *   SinrStdDevHigh, and doubled if it is below SinrStdDevLow;
+ * - if the speed of the UE is known, the periodicity is capped so that the
+ *   UE does not move more than MaxDisplacement between two SRS. As the
+ *   periodicity counts only the slots that can carry the SRS, the time
+ *   between two SRS is the periodicity times the slot period, divided by the
+ *   fraction of such slots in the TDD pattern.
+ *
+ * Static UEs therefore move towards long periodicities, freeing UL symbols,
+ * while fast UEs sound the channel more often.
+ */
+class NrMacSchedulerSrsAdaptive : public NrMacSchedulerSrs, public Object
+{
+public:
+  /**
+   * \brief NrMacSchedulerSrsAdaptive constructor
+   */
+  NrMacSchedulerSrsAdaptive ();
+  /**
+   * \brief ~NrMacSchedulerSrsAdaptive
+   */
+  virtual ~NrMacSchedulerSrsAdaptive () override;
+
+  /**
+   * \brief GetTypeId
+   * \return the object type id
+   */
+  static TypeId GetTypeId ();
+
+  // inherited from NrMacSchedulerSrs
+  virtual SrsPeriodicityAndOffset AddUe (void) override;
+  virtual void RemoveUe (uint32_t offset, uint32_t periodicity) override;
+  virtual bool IncreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap) override;
+  virtual bool DecreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap) override;
+  virtual bool SrsReported (const std::shared_ptr<NrMacSchedulerUeInfo> &ue, double speed,
+                            const Time &slotPeriod, double srsSlotRatio) override;
+  virtual int64_t AssignStreams (int64_t stream) override;
+
+  /**
+   * \brief Get the periodicities that can be assigned to a UE
+   * \return the periodicities, in increasing order
+   */
+  const std::vector<uint32_t> & GetPeriodicities () const;
+
+  /**
+   * \brief Get the number of free offsets of a periodicity
+   * \param periodicity the periodicity
+   * \return the number of offsets in the free list of the periodicity
+   */
+  size_t GetNumFreeOffsets (uint32_t periodicity) const;
+
+private:
+  /**
+   * \brief Build the chain of periodicities and the free lists, if not done yet
+   */
+  void Configure ();
+  /**
+   * \brief Get the index of a periodicity in the chain
+   * \param periodicity the periodicity
+   * \return the index
+   */
+  uint32_t GetLevel (uint32_t periodicity) const;
+  /**
+   * \brief Take a free offset of a periodicity, splitting the offset of a
+   * shorter periodicity if needed
+   * \param level index of the periodicity
+   * \return the periodicity and the offset, invalid if there are none free
+   */
+  SrsPeriodicityAndOffset Allocate (uint32_t level);
+  /**
+   * \brief Give back an offset, merging it with its free siblings
+   * \param offset the offset
+   * \param level index of its periodicity
+   */
+  void Release (uint32_t offset, uint32_t level);
+  /**
+   * \brief Take a given offset of a periodicity, splitting the free offset
+   * of a shorter periodicity that contains it if needed
+   * \param offset the offset, which must be free
+   * \param level index of its periodicity
+   */
+  void Reserve (uint32_t offset, uint32_t level);
+  /**
+   * \brief Move a UE to another periodicity
+   * \param ue the UE
+   * \param level index of the new periodicity
+   * \return true if the UE was moved, false if it keeps its periodicity and
+   *         its offset
+   */
+  bool MoveUe (const std::shared_ptr<NrMacSchedulerUeInfo> &ue, uint32_t level);
+
+  static std::vector<uint32_t> StandardPeriodicity; //!< Standard periodicity of SRS
+
+  uint32_t m_minPeriodicity {10};      //!< Shortest periodicity (attribute)
+  uint32_t m_maxPeriodicity {320};     //!< Longest periodicity (attribute)
+  uint32_t m_startingPeriodicity {80}; //!< Periodicity of new UEs (attribute)
+  double m_sinrStdDevHigh {3.0};       //!< SINR standard deviation (dB) that halves the periodicity (attribute)
+  double m_sinrStdDevLow {1.0};        //!< SINR standard deviation (dB) that doubles the periodicity (attribute)
+  double m_maxDisplacement {1.0};      //!< Maximum distance (m) a UE can travel between two SRS (attribute)
+  uint32_t m_minReports {4};           //!< SRS to receive before changing periodicity again (attribute)
+
+  std::vector<uint32_t> m_periodicities;          //!< Periodicities, each one divides the next one
+  std::vector<std::set<uint32_t> > m_freeOffsets; //!< Free offsets of each periodicity
+};
+
+} // namespace ns3
+
+#endif // NR_MAC_SCHEDULER_SRS_ADAPTIVE_H
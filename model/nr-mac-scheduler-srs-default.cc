@@ -88,7 +88,7 @@ NrMacSchedulerSrsDefault::AddUe ()
 }
 
 void
-NrMacSchedulerSrsDefault::RemoveUe (uint32_t offset)
+NrMacSchedulerSrsDefault::RemoveUe (uint32_t offset, [[maybe_unused]] uint32_t periodicity)
 {
   NS_LOG_FUNCTION (this);
   m_availableOffsetValues.push_back (offset); // Offset will be reused as soon as possible
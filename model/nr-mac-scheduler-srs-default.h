@@ -55,9 +55,10 @@ public:
 
   // inherited from NrMacSchedulerSrs
   virtual SrsPeriodicityAndOffset AddUe (void) override;
-  void RemoveUe (uint32_t offset) override;
+  void RemoveUe (uint32_t offset, uint32_t periodicity) override;
   virtual bool IncreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap) override;
   virtual bool DecreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap) override;
+  int64_t AssignStreams (int64_t stream) override;
 
   /**
    * \brief Set the Periodicity for all the UEs
@@ -71,17 +72,6 @@ public:
    */
   uint32_t GetStartingPeriodicity () const;
 
-
-  /**
-   * Assign a fixed random variable stream number to the random variables
-   * used by this model.  Return the number of streams (possibly zero) that
-   * have been assigned.
-   *
-   * \param stream first stream index to use
-   * \return the number of stream indices assigned by this model
-   */
-  int64_t AssignStreams (int64_t stream);
-
 private:
   /**
    * \brief Reassign offset/periodicity to all the UEs
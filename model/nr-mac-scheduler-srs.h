@@ -21,6 +21,7 @@
 
 #include <stdint.h>
 #include "nr-mac-scheduler-ue-info.h"
+#include <ns3/nstime.h>
 
 namespace ns3 {
 
@@ -61,8 +62,9 @@ namespace ns3 {
  * for a UE, and various implementation can be written to simulate different
  * algorithms.
  *
- * Note: This interface assumes that all the UEs will share the same periodicity.
- * If that's not the case, the API would have to be updated.
+ * The UEs may have different periodicities, as long as two UEs never send
+ * the SRS in the same slot. An algorithm can also adapt the periodicity of a
+ * UE when its SRS is received (see SrsReported).
  *
  */
 class NrMacSchedulerSrs
@@ -100,11 +102,9 @@ public:
    * \brief Function called when the scheduler has to release a previousy owned periodicity
    * and offset.
    * \param offset The offset used by the UE
-   *
-   * Note: This interface assumes that all the UEs will share the same periodicity.
-   * If that's not the case, the API would have to be updated.
+   * \param periodicity The periodicity used by the UE
    */
-  virtual void RemoveUe (uint32_t offset) = 0;
+  virtual void RemoveUe (uint32_t offset, uint32_t periodicity) = 0;
 
   /**
    * \brief Increase the periodicity and assign to all UEs a different offset
@@ -126,6 +126,35 @@ public:
    */
   virtual bool DecreasePeriodicity (std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > *ueMap) = 0;
 
+  /**
+   * \brief Function called when the SRS of a UE has been received
+   * \param ue the UE, whose periodicity and offset can be changed
+   * \param speed the speed of the UE (m/s), or a negative value if unknown
+   * \param slotPeriod the slot period
+   * \param srsSlotRatio the fraction of the slots that count for the
+   *        periodicity, i.e., that can carry the SRS with the TDD pattern
+   * \return true if the periodicity or the offset of the UE changed
+   *
+   * The default implementation keeps the periodicity and the offset.
+   */
+  virtual bool SrsReported ([[maybe_unused]] const std::shared_ptr<NrMacSchedulerUeInfo> &ue,
+                            [[maybe_unused]] double speed,
+                            [[maybe_unused]] const Time &slotPeriod,
+                            [[maybe_unused]] double srsSlotRatio)
+  {
+    return false;
+  }
+
+  /**
+   * Assign a fixed random variable stream number to the random variables
+   * used by this model.  Return the number of streams (possibly zero) that
+   * have been assigned.
+   *
+   * \param stream first stream index to use
+   * \return the number of stream indices assigned by this model
+   */
+  virtual int64_t AssignStreams (int64_t stream) = 0;
+
 };
 } // namespace ns3
 
@@ -162,57 +162,45 @@ NrMacSchedulerTdma::AssignRBGTDMA (uint32_t symAvail, const ActiveUeMap &activeU
 
           if (GetTBSFn (GetUe (*schedInfoIt)) >= std::max (bufQueueSize, 7U))
             {
-              if (GetUe (*schedInfoIt)->m_dlTbSize.size () > 1 && type == "DL")
+              std::vector<uint32_t> &tbSizes = type == "DL" ? GetUe (*schedInfoIt)->m_dlTbSize
+                                                            : GetUe (*schedInfoIt)->m_ulTbSize;
+              if (tbSizes.size () > 1)
                 {
-                  // This "if" is purely for DL MIMO. In MIMO, for example, if the
+                  // This "if" is purely for MIMO. In MIMO, for example, if the
                   // first TB size is big enough to empty the buffer then we
                   // should not allocate anything to the second stream. In this
                   // case, if we allocate bytes to the second stream, the UE
                   // would expect the TB but the gNB would not be able to transmit
-                  // it. This would break HARQ TX state machine at UE PHY.
-
-                  // I am not generalizing the code here because MIMO is implemented
-                  // only for DL; therefore, m_dlTbSize is a vector. On the other
-                  // hand, in uplink m_ulTbSize is an integer. When UL MIMO is implemented
-                  // we can do the following two things to generalize this code.
-                  // 1. GetUe (*schedInfoIt)->m_dlTbSize.size () > 1
-                  // above is used to check if the UE have more than one stream.
-                  // When the UL MIMO is implemented maybe we can implement
-                  // a method in UeInfo for DL and UL to return the number of
-                  // streams. Here we can call those specific methods
-                  // by looking at the type.
-                  // 2. Initialize the m_dlTbSize.begin and m_dlTbSize.end iterators before
-                  // "if (GetTBSFn (GetUe (*schedInfoIt)) >= std::max (bufQueueSize, 7U))"
-                  // by checking the "type".
-
+                  // it (or, in UL, the gNB would expect a TB that the UE cannot
+                  // fill). This would break the HARQ TX state machine.
                   uint8_t streamCounter = 0;
                   uint32_t copyBufQueueSize = bufQueueSize;
-                  auto dlTbSizeIt = GetUe (*schedInfoIt)->m_dlTbSize.begin ();
-                  while (dlTbSizeIt != GetUe (*schedInfoIt)->m_dlTbSize.end ())
+                  auto tbSizeIt = tbSizes.begin ();
+                  while (tbSizeIt != tbSizes.end ())
                     {
                       if (copyBufQueueSize != 0)
                         {
-                          NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " needed to TX MIMO TB");
-                          if (*dlTbSizeIt >= copyBufQueueSize)
+                          NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *tbSizeIt << " needed to TX MIMO TB");
+                          if (*tbSizeIt >= copyBufQueueSize)
                             {
                               copyBufQueueSize = 0;
                             }
                           else
                             {
-                              copyBufQueueSize = copyBufQueueSize - *dlTbSizeIt;
+                              copyBufQueueSize = copyBufQueueSize - *tbSizeIt;
                             }
                           streamCounter++;
-                          dlTbSizeIt++;
+                          tbSizeIt++;
                         }
                       else
                         {
                           // if we are here, that means previously iterated
                           // streams were enough to empty the buffer. We do
                           // not need this stream. Make its TB size zero.
-                          NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *dlTbSizeIt << " not needed to TX MIMO TB");
-                          *dlTbSizeIt = 0;
+                          NS_LOG_DEBUG ("Stream " << +streamCounter << " with TB size " << *tbSizeIt << " not needed to TX MIMO TB");
+                          *tbSizeIt = 0;
                           streamCounter++;
-                          dlTbSizeIt++;
+                          tbSizeIt++;
                         }
                     }
                 }
@@ -430,12 +418,28 @@ NrMacSchedulerTdma::CreateUlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
                                      uint32_t maxSym) const
 {
   NS_LOG_FUNCTION (this);
-  uint32_t tbs = m_ulAmc->CalculateTbSize (ueInfo->m_ulMcs,
-                                           ueInfo->m_ulRBG * GetNumRbPerRbg ());
 
-  // If is less than 7 (3 mac header, 2 rlc header, 2 data), then we can't
-  // transmit any new data, so don't create dci.
-  if (tbs < 7)
+  // The TB size of each stream is computed in UpdateUlMetric, and it is 0 for
+  // the streams beyond the UL rank, or not needed to empty the buffer.
+  // If it is less than 7 (3 mac header, 2 rlc header, 2 data), then we can't
+  // transmit any new data in that stream; if no stream can, don't create dci.
+  std::vector<uint8_t> ndi (ueInfo->m_ulTbSize.size (), 0);
+  std::vector<uint8_t> rv (ueInfo->m_ulTbSize.size (), 0);
+  std::vector<uint32_t> ulTbs (ueInfo->m_ulTbSize.size (), 0);
+  bool anyTb = false;
+  for (uint8_t stream = 0; stream < ueInfo->m_ulTbSize.size (); ++stream)
+    {
+      if (ueInfo->m_ulTbSize.at (stream) < 7)
+        {
+          ueInfo->m_ulTbSize.at (stream) = 0;
+          continue;
+        }
+      ulTbs.at (stream) = ueInfo->m_ulTbSize.at (stream);
+      ndi.at (stream) = 1;
+      anyTb = true;
+    }
+
+  if (! anyTb)
     {
       NS_LOG_DEBUG ("While creating DCI for UE " << ueInfo->m_rnti <<
                     " assigned " << ueInfo->m_ulRBG << " UL RBG, but TBS < 7");
@@ -454,13 +458,7 @@ NrMacSchedulerTdma::CreateUlDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
   // The starting point must go backward to accomodate the needed sym
   spoint->m_sym -= numSym;
 
-  //Due to MIMO implementation MCS and TB size are vectors
-  std::vector<uint8_t> ulMcs = {ueInfo->m_ulMcs};
-  std::vector<uint32_t> ulTbs = {tbs};
-  std::vector<uint8_t> ndi = {1};
-  std::vector<uint8_t> rv = {0};
-
-  auto dci = CreateDci (spoint, ueInfo, ulTbs, DciInfoElementTdma::UL, ulMcs,
+  auto dci = CreateDci (spoint, ueInfo, ulTbs, DciInfoElementTdma::UL, ueInfo->m_ulMcs,
                         ndi, rv, numSym);
 
   // Reset the RBG (we are TDMA)
@@ -507,7 +505,7 @@ NrMacSchedulerTdma::CreateDci (NrMacSchedulerNs3::PointInFTPlane *spoint,
 
   std::shared_ptr<DciInfoElementTdma> dci = std::make_shared<DciInfoElementTdma>
       (ueInfo->m_rnti, fmt, spoint->m_sym, numSym, mcs, tbs, ndi, rv, DciInfoElementTdma::DATA,
-       GetBwpId (), GetTpc());
+       GetBwpId (), fmt == DciInfoElementTdma::UL ? GetUeTpc (ueInfo) : GetTpc ());
 
   std::vector<uint8_t> rbgAssigned = fmt == DciInfoElementTdma::DL ? GetDlNotchedRbgMask () :
                                                                      GetUlNotchedRbgMask ();
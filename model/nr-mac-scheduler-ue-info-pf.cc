@@ -58,11 +58,16 @@ NrMacSchedulerUeInfoPF::UpdateUlPFMetric (const NrMacSchedulerNs3::FTResources &
 
   NrMacSchedulerUeInfo::UpdateUlMetric (amc);
 
-  m_currTputUl = static_cast<double> (m_ulTbSize) / (totAssigned.m_sym);
+  uint32_t ulTbSize = 0;
+  for (const auto &it:m_ulTbSize)
+    {
+      ulTbSize += it;
+    }
+  m_currTputUl = static_cast<double> (ulTbSize) / (totAssigned.m_sym);
   m_avgTputUl = ((1.0 - (1.0 / static_cast<double> (timeWindow))) * m_lastAvgTputUl) +
     ((1.0 / timeWindow) * m_currTputUl);
 
-  NS_LOG_DEBUG ("Update UL PF Metric for UE " << m_rnti << " UL TBS: " << m_ulTbSize <<
+  NS_LOG_DEBUG ("Update UL PF Metric for UE " << m_rnti << " UL TBS: " << ulTbSize <<
                 " Updated currTputUl " << m_currTputUl << " avgTputUl " << m_avgTputUl <<
                 " over n. of syms: " << +totAssigned.m_sym <<
                 ", last Avg TH Ul " << m_lastAvgTputUl <<
@@ -112,7 +117,12 @@ NrMacSchedulerUeInfoPF::CalculatePotentialTPutUl (const NrMacSchedulerNs3::FTRes
   NS_LOG_FUNCTION (this);
 
   uint32_t rbsAssignable = assignableInIteration.m_rbg * GetNumRbPerRbg ();
-  m_potentialTputUl =  amc->CalculateTbSize (m_ulMcs, rbsAssignable);
+  // With more than one layer, the potential throughput is the sum of the TBs
+  m_potentialTputUl = 0.0;
+  for (uint8_t stream = 0; stream < std::min<size_t> (m_ulRank, m_ulMcs.size ()); ++stream)
+    {
+      m_potentialTputUl += amc->CalculateTbSize (m_ulMcs.at (stream), rbsAssignable);
+    }
   m_potentialTputUl /= assignableInIteration.m_sym;
 
   NS_LOG_INFO ("UE " << m_rnti << " potentialTputUl " << m_potentialTputUl <<
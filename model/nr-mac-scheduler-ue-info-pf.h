@@ -100,6 +100,41 @@ public:
     m_avgTputUl = m_lastAvgTputUl;
   }
 
+  /**
+   * \brief Save the state, including the average throughputs
+   * \param writer the checkpoint writer
+   */
+  virtual void SaveState (NrCheckpointWriter &writer) const override
+  {
+    NrMacSchedulerUeInfo::SaveState (writer);
+    writer.WriteDouble (m_avgTputDl);
+    writer.WriteDouble (m_lastAvgTputDl);
+    writer.WriteDouble (m_avgTputUl);
+    writer.WriteDouble (m_lastAvgTputUl);
+  }
+
+  /**
+   * \brief Restore the state saved by SaveState
+   * \param reader the checkpoint reader
+   */
+  virtual void RestoreState (NrCheckpointReader &reader) override
+  {
+    NrMacSchedulerUeInfo::RestoreState (reader);
+    m_avgTputDl = reader.ReadDouble ();
+    m_lastAvgTputDl = reader.ReadDouble ();
+    m_avgTputUl = reader.ReadDouble ();
+    m_lastAvgTputUl = reader.ReadDouble ();
+  }
+
+  /**
+   * \brief Get the type of the state saved by SaveState
+   * \return the name of the type
+   */
+  virtual std::string GetStateType () const override
+  {
+    return "ns3::NrMacSchedulerUeInfoPF";
+  }
+
   /**
    * \brief Update the PF metric for downlink
    * \param totAssigned the resources assigned
@@ -67,9 +67,9 @@ NrMacSchedulerUeInfo::GetDlMcs (const UePtr &ue, uint8_t stream)
 }
 
 uint8_t &
-NrMacSchedulerUeInfo::GetUlMcs (const UePtr &ue)
+NrMacSchedulerUeInfo::GetUlMcs (const UePtr &ue, uint8_t stream)
 {
-  return ue->m_ulMcs;
+  return ue->m_ulMcs.at (stream);
 }
 
 uint32_t &
@@ -96,7 +96,13 @@ NrMacSchedulerUeInfo::GetDlTBS (const UePtr &ue)
 uint32_t
 NrMacSchedulerUeInfo::GetUlTBS (const UePtr &ue)
 {
-  return ue->m_ulTbSize;
+  // As in DL, the TB sizes of all the streams are added
+  uint32_t tbSize = 0;
+  for (const auto &it:ue->m_ulTbSize)
+    {
+      tbSize += it;
+    }
+  return tbSize;
 }
 
 std::unordered_map<uint8_t, LCGPtr> &
@@ -141,7 +147,10 @@ NrMacSchedulerUeInfo::ResetUlSchedInfo ()
   m_ulMRBRetx = 0;
   m_ulRBG = 0;
   m_ulSym = 0;
-  m_ulTbSize = 0;
+  for (auto &it:m_ulTbSize)
+    {
+      it = 0;
+    }
 }
 
 
@@ -232,20 +241,118 @@ NrMacSchedulerUeInfo::ResetDlMetric ()
 void
 NrMacSchedulerUeInfo::UpdateUlMetric (const Ptr<const NrAmc> &amc)
 {
-  if (m_ulRBG == 0)
+  NS_ASSERT (m_ulTbSize.size () == m_ulMcs.size ());
+  for (uint8_t stream = 0; stream < m_ulTbSize.size (); ++stream)
     {
-      m_ulTbSize = 0;
+      if (m_ulRBG == 0 || stream >= m_ulRank)
+        {
+          m_ulTbSize.at (stream) = 0;
+        }
+      else
+        {
+          NS_ABORT_MSG_IF (m_ulMcs.at (stream) == UINT8_MAX, "UL MCS of stream " << +stream << " is invalid");
+          m_ulTbSize.at (stream) = amc->CalculateTbSize (m_ulMcs.at (stream), m_ulRBG * GetNumRbPerRbg ());
+        }
     }
-  else
+}
+
+void
+NrMacSchedulerUeInfo::ResetUlMetric ()
+{
+  for (auto &it:m_ulTbSize)
     {
-      m_ulTbSize = amc->CalculateTbSize (m_ulMcs, m_ulRBG * GetNumRbPerRbg ());
+      it = 0;
     }
 }
 
 void
-NrMacSchedulerUeInfo::ResetUlMetric ()
+NrMacSchedulerUeInfo::SaveState (NrCheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this);
+
+  writer.WriteU8Vector (m_dlMcs);
+  writer.WriteU8Vector (m_ulMcs);
+  writer.WriteU8 (m_ulRank);
+  writer.WriteDoubleVector (m_ulSrsSinr);
+  writer.WriteU8Vector (m_ulSrsMcs);
+
+  writer.WriteU8 (static_cast<uint8_t> (m_dlCqi.m_cqiType));
+  writer.WriteU8 (m_dlCqi.m_ri);
+  writer.WriteDoubleVector (m_dlCqi.m_sinr);
+  writer.WriteU8Vector (m_dlCqi.m_wbCqi);
+  writer.WriteU32 (static_cast<uint32_t> (m_dlCqi.m_sbCqi.size ()));
+  for (const auto & sbCqi : m_dlCqi.m_sbCqi)
+    {
+      writer.WriteU8Vector (sbCqi);
+    }
+  writer.WriteU16 (m_dlCqi.m_rbPerSb);
+  writer.WriteU32 (m_dlCqi.m_timer);
+
+  writer.WriteU8 (static_cast<uint8_t> (m_ulCqi.m_cqiType));
+  writer.WriteDoubleVector (m_ulCqi.m_sinr);
+  writer.WriteU32 (static_cast<uint32_t> (m_ulCqi.m_rbCqi.size ()));
+  for (const auto & rbCqi : m_ulCqi.m_rbCqi)
+    {
+      writer.WriteU16 (static_cast<uint16_t> (rbCqi));
+    }
+  writer.WriteU8 (m_ulCqi.m_cqi);
+  writer.WriteU32 (m_ulCqi.m_timer);
+
+  writer.WriteDouble (m_srsSinrMean);
+  writer.WriteDouble (m_srsSinrVar);
+  writer.WriteU32 (m_srsReports);
+  writer.WriteDouble (m_ulPuschSinr);
+  writer.WriteDouble (m_tpcCorrection);
+}
+
+void
+NrMacSchedulerUeInfo::RestoreState (NrCheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this);
+
+  m_dlMcs = reader.ReadU8Vector ();
+  m_ulMcs = reader.ReadU8Vector ();
+  m_ulRank = reader.ReadU8 ();
+  m_ulSrsSinr = reader.ReadDoubleVector ();
+  m_ulSrsMcs = reader.ReadU8Vector ();
+  // The TB sizes are recomputed in each slot, but must have one entry per stream
+  m_dlTbSize.assign (m_dlMcs.size (), 0);
+  m_ulTbSize.assign (m_ulMcs.size (), 0);
+
+  m_dlCqi.m_cqiType = static_cast<DlCqiInfo::CqiType> (reader.ReadU8 ());
+  m_dlCqi.m_ri = reader.ReadU8 ();
+  m_dlCqi.m_sinr = reader.ReadDoubleVector ();
+  m_dlCqi.m_wbCqi = reader.ReadU8Vector ();
+  m_dlCqi.m_sbCqi.resize (reader.ReadU32 ());
+  for (auto & sbCqi : m_dlCqi.m_sbCqi)
+    {
+      sbCqi = reader.ReadU8Vector ();
+    }
+  m_dlCqi.m_rbPerSb = reader.ReadU16 ();
+  m_dlCqi.m_timer = reader.ReadU32 ();
+
+  m_ulCqi.m_cqiType = static_cast<CqiInfo::CqiType> (reader.ReadU8 ());
+  m_ulCqi.m_sinr = reader.ReadDoubleVector ();
+  m_ulCqi.m_rbCqi.resize (reader.ReadU32 ());
+  for (auto & rbCqi : m_ulCqi.m_rbCqi)
+    {
+      rbCqi = static_cast<int16_t> (reader.ReadU16 ());
+    }
+  m_ulCqi.m_cqi = reader.ReadU8 ();
+  m_ulCqi.m_timer = reader.ReadU32 ();
+
+  m_srsSinrMean = reader.ReadDouble ();
+  m_srsSinrVar = reader.ReadDouble ();
+  m_srsReports = reader.ReadU32 ();
+  m_ulPuschSinr = reader.ReadDouble ();
+  m_tpcCorrection = reader.ReadDouble ();
+  m_tpcSfn = 0;
+}
+
+std::string
+NrMacSchedulerUeInfo::GetStateType () const
 {
-  m_ulTbSize = 0;
+  return "ns3::NrMacSchedulerUeInfo";
 }
 
 uint32_t
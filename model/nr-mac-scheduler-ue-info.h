@@ -25,7 +25,9 @@
 #include <unordered_map>
 #include <functional>
 #include "beam-conf-id.h"
+#include "nr-checkpoint.h"
 #include <algorithm>
+#include <limits>
 
 namespace ns3 {
 
@@ -114,9 +116,10 @@ public:
   /**
    * \brief GetUlMcs
    * \param ue UE pointer from which obtain the value
-   * \return
+   * \param stream The stream id
+   * \return The UL MCS of the stream
    */
-  static uint8_t & GetUlMcs (const UePtr &ue);
+  static uint8_t & GetUlMcs (const UePtr &ue, uint8_t stream);
   /**
    * \brief GetDlTBSPerStream
    * \param ue UE pointer from which obtain the value
@@ -212,6 +215,32 @@ public:
    */
   virtual void ResetUlMetric ();
 
+  /**
+   * \brief Save the state learnt from the UE (CQI, MCS, UL rank, SRS and
+   * PUSCH SINR statistics)
+   * \param writer the checkpoint writer
+   *
+   * Subclasses with additional metrics (e.g., average throughput) should
+   * call this method before saving them. HARQ processes, LCGs and the SRS
+   * periodicity are not saved: they are re-created when the UE attaches.
+   */
+  virtual void SaveState (NrCheckpointWriter &writer) const;
+
+  /**
+   * \brief Restore the state saved by SaveState
+   * \param reader the checkpoint reader
+   */
+  virtual void RestoreState (NrCheckpointReader &reader);
+
+  /**
+   * \brief Get the type of the state saved by SaveState
+   * \return the name of the type
+   *
+   * The state of a UE is restored only in a UE with the same type. Subclasses
+   * that save additional metrics must override it.
+   */
+  virtual std::string GetStateType () const;
+
   /**
    * \brief Received CQI information
    */
@@ -249,6 +278,8 @@ public:
     uint8_t m_ri    {0}; //!< The rank indicator, by default UE would have only one stream
     std::vector<double> m_sinr;   //!< Vector of SINR for the entire band
     std::vector<uint8_t> m_wbCqi; //!< CQI for each stream
+    std::vector<std::vector<uint8_t> > m_sbCqi; //!< CQI of each sub-band for each stream (only for SB type)
+    uint16_t m_rbPerSb {0}; //!< Number of RBs of each sub-band (only for SB type)
     uint32_t m_timer {0};  //!< Timer (in slot number). When the timer is 0, the value is discarded
   };
 
@@ -266,10 +297,13 @@ public:
   uint8_t         m_ulSym     {0};  //!< Number of (new data) symbols assigned in this slot.
 
   std::vector<uint8_t> m_dlMcs;  //!< DL MCS per stream, it is initialized with a starting MCS upon UE addition to gNB and the scheduler
-  uint8_t m_ulMcs     {0};  //!< UL MCS
+  std::vector<uint8_t> m_ulMcs;  //!< UL MCS per stream, it is initialized with a starting MCS upon UE addition to gNB and the scheduler
 
   std::vector<uint32_t> m_dlTbSize {0};  //!< DL Transport Block Size per stream, depends on MCS and RBG, updated in UpdateDlMetric()
-  uint32_t m_ulTbSize         {0};  //!< UL Transport Block Size, depends on MCS and RBG, updated in UpdateDlMetric()
+  std::vector<uint32_t> m_ulTbSize {0};  //!< UL Transport Block Size per stream, depends on MCS, RBG and UL rank, updated in UpdateUlMetric()
+  uint8_t m_ulRank {1};                  //!< UL rank (number of PUSCH layers), selected from the SINR of the SRS of each stream
+  std::vector<double> m_ulSrsSinr;       //!< Average SINR (dB) of the last SRS received on each stream
+  std::vector<uint8_t> m_ulSrsMcs;       //!< MCS of each stream, computed from the last SRS
 
   DlCqiInfo m_dlCqi;                  //!< DL CQI information
   CqiInfo m_ulCqi;                  //!< UL CQI information
@@ -279,6 +313,12 @@ public:
 
   uint32_t m_srsPeriodicity {0}; //!< SRS periodicity
   uint32_t m_srsOffset {0};      //!< SRS offset
+  double m_srsSinrMean {-std::numeric_limits<double>::infinity ()}; //!< Moving average of the SRS SINR (dB) of the first stream
+  double m_srsSinrVar {0.0};     //!< Moving variance of the SRS SINR (dB^2) of the first stream
+  uint32_t m_srsReports {0};     //!< SRS received since the last change of SRS periodicity
+  double m_ulPuschSinr {-std::numeric_limits<double>::infinity ()}; //!< Average SINR (dB) of the last PUSCH of the first stream
+  double m_tpcCorrection {0.0};  //!< Power correction (dB) still to be sent to the UE with TPC commands
+  uint64_t m_tpcSfn {0};         //!< Encoding of the UL slot whose DCI carried the last TPC correction
   uint8_t m_startMcsDlUe {0}; //!< Starting DL MCS to be used
 
 protected:
@@ -0,0 +1,220 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_MCS_TABLES_H
+#define NR_MCS_TABLES_H
+
+#include <array>
+#include <cstdint>
+
+namespace ns3 {
+
+/**
+ * \ingroup error-models
+ * \brief MCS and CQI values of the Table1 of TS 38.214
+ *
+ * Tables 5.1.3.1-1 and 5.2.2.1-2 in TS 38.214. The beta values are obtained
+ * from link-to-system mapping techniques for the EESM.
+ *
+ * \see NrEesmT1
+ */
+struct NrMcsTable1
+{
+  static constexpr uint8_t NumMcs = 29; //!< Number of MCSs (0 to 28)
+
+  /// SE of the standard MCSs
+  static constexpr std::array<double, NumMcs> SpectralEfficiencyForMcs = {
+    // QPSK (M=2)
+    0.23, 0.31, 0.38, 0.49, 0.6, 0.74, 0.88, 1.03, 1.18, 1.33,
+    // 16QAM (M=4)
+    1.33, 1.48, 1.70, 1.91, 2.16, 2.41, 2.57,
+    // 64QAM (M=6)
+    2.57, 2.73, 3.03, 3.32, 3.61, 3.90, 4.21, 4.52, 4.82, 5.12, 5.33, 5.55
+  };
+
+  /// SE of the standard CQIs
+  static constexpr std::array<double, 16> SpectralEfficiencyForCqi = {
+    0.0,     // out of range
+    0.15, 0.23, 0.38, 0.6, 0.88, 1.18,
+    1.48, 1.91, 2.41,
+    2.73, 3.32, 3.9, 4.52, 5.12, 5.55
+  };
+
+  /// Beta values for the EESM
+  static constexpr std::array<double, NumMcs> Beta = {
+    1.6, 1.61, 1.63, 1.65, 1.67, 1.7, 1.73, 1.76, 1.79, 1.82,
+    3.97, 4.27, 4.71, 5.16, 5.66, 6.16, 6.5, 9.95, 10.97,
+    12.92, 14.96, 17.06, 19.33, 21.85, 24.51, 27.14, 29.94,
+    32.05, 34.28
+  };
+
+  /// ECR of the standard MCSs
+  static constexpr std::array<double, NumMcs> McsEcr = {
+    // QPSK (M=2)
+    0.12, 0.15, 0.19, 0.25, 0.30, 0.37, 0.44, 0.51, 0.59, 0.66,
+    // 16QAM (M=4)
+    0.33, 0.37, 0.42, 0.48, 0.54, 0.60, 0.64,
+    // 64QAM (M=6)
+    0.43, 0.46, 0.50, 0.55, 0.60, 0.65, 0.70, 0.75, 0.80, 0.85, 0.89, 0.93
+  };
+
+  /// Modulation order of the standard MCSs
+  static constexpr std::array<uint8_t, NumMcs> McsM = {
+    // QPSK (M=2)
+    2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    // 16QAM (M=4)
+    4, 4, 4, 4, 4, 4, 4,
+    // 64QAM (M=6)
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6
+  };
+};
+
+/**
+ * \ingroup error-models
+ * \brief MCS and CQI values of the Table2 of TS 38.214
+ *
+ * Tables 5.1.3.1-2 and 5.2.2.1-3 in TS 38.214 (up to 256QAM).
+ *
+ * \see NrEesmT2
+ */
+struct NrMcsTable2
+{
+  static constexpr uint8_t NumMcs = 28; //!< Number of MCSs (0 to 27)
+
+  /// SE of the standard MCSs
+  static constexpr std::array<double, NumMcs> SpectralEfficiencyForMcs = {
+    // QPSK (M=2)
+    0.23, 0.38, 0.60, 0.88, 1.18,
+    // 16QAM (M=4)
+    1.48, 1.70, 1.91, 2.16, 2.41, 2.57,
+    // 64QAM (M=6)
+    2.73, 3.03, 3.32, 3.61, 3.90, 4.21, 4.52, 4.82, 5.12,
+    // 256QAM (M=8)
+    5.33, 5.55, 5.89, 6.23, 6.57, 6.91, 7.16, 7.41
+  };
+
+  /// SE of the standard CQIs
+  static constexpr std::array<double, 16> SpectralEfficiencyForCqi = {
+    0.0,     // out of range
+    0.15, 0.38, 0.88,
+    1.48, 1.91, 2.41,
+    2.73, 3.32, 3.90, 4.52, 5.12,
+    5.55, 6.23, 6.91, 7.41
+  };
+
+  /// Beta values for the EESM
+  static constexpr std::array<double, NumMcs> Beta = {
+    1.6, 1.63, 1.67, 1.73, 1.79, 4.27, 4.71, 5.16, 5.66, 6.16,
+    6.5, 10.97, 12.92, 14.96, 17.06, 19.33, 21.85, 24.51, 27.14,
+    29.94, 56.48, 65.0, 78.58, 92.48, 106.27, 118.74, 126.36,
+    132.54
+  };
+
+  /// ECR of the standard MCSs
+  static constexpr std::array<double, NumMcs> McsEcr = {
+    // QPSK (M=2)
+    0.12, 0.19, 0.30, 0.44, 0.59,
+    // 16QAM (M=4)
+    0.37, 0.42, 0.48, 0.54, 0.60, 0.64,
+    // 64QAM (M=6)
+    0.46, 0.50, 0.55, 0.60, 0.65, 0.70, 0.75, 0.80, 0.85,
+    // 256QAM (M=8)
+    0.67, 0.69, 0.74, 0.77, 0.82, 0.86, 0.90, 0.93
+  };
+
+  /// Modulation order of the standard MCSs
+  static constexpr std::array<uint8_t, NumMcs> McsM = {
+    // QPSK (M=2)
+    2, 2, 2, 2, 2,
+    // 16QAM (M=4)
+    4, 4, 4, 4, 4, 4,
+    // 64QAM (M=6)
+    6, 6, 6, 6, 6, 6, 6, 6, 6,
+    // 256QAM (M=8)
+    8, 8, 8, 8, 8, 8, 8, 8
+  };
+};
+
+/**
+ * \ingroup error-models
+ * \brief A read-only view of the MCS and CQI tables used by an error model
+ *
+ * The error model selects its table once, at construction; the users (the
+ * error model itself, and NrAmc) then index the arrays directly, without a
+ * virtual call or a bounds check per lookup. Indexes must be checked by
+ * the caller against m_maxMcs (MCS) or 15 (CQI).
+ *
+ * \see NrErrorModel::GetMcsTable
+ */
+struct NrMcsTable
+{
+  /**
+   * \brief Identifier of the table
+   */
+  enum TableId : uint8_t
+  {
+    TABLE1,   //!< Table1 of TS 38.214 (up to 64QAM)
+    TABLE2,   //!< Table2 of TS 38.214 (up to 256QAM)
+    LTE_MI,   //!< MCS table of the LTE MI error model
+  };
+
+  TableId m_tableId;                               //!< Table identifier
+  uint8_t m_maxMcs;                                //!< Highest valid MCS
+  const double *m_spectralEfficiencyForMcs;        //!< SE for each MCS (m_maxMcs + 1 values)
+  const double *m_spectralEfficiencyForCqi;        //!< SE for each CQI (16 values)
+  const double *m_mcsEcr;                          //!< ECR for each MCS (m_maxMcs + 1 values)
+  const uint8_t *m_mcsM;                           //!< Modulation order for each MCS (m_maxMcs + 1 values)
+  const double *m_beta;                            //!< EESM beta for each MCS, or nullptr
+
+  /**
+   * \brief Get the view of one of the tables of TS 38.214
+   * \param id TABLE1 or TABLE2
+   * \return the view of the table
+   */
+  static constexpr const NrMcsTable & Get (TableId id);
+};
+
+/// View of the Table1 of TS 38.214
+inline constexpr NrMcsTable NrMcsTableView1 = {
+  NrMcsTable::TABLE1, NrMcsTable1::NumMcs - 1,
+  NrMcsTable1::SpectralEfficiencyForMcs.data (),
+  NrMcsTable1::SpectralEfficiencyForCqi.data (),
+  NrMcsTable1::McsEcr.data (),
+  NrMcsTable1::McsM.data (),
+  NrMcsTable1::Beta.data ()
+};
+
+/// View of the Table2 of TS 38.214
+inline constexpr NrMcsTable NrMcsTableView2 = {
+  NrMcsTable::TABLE2, NrMcsTable2::NumMcs - 1,
+  NrMcsTable2::SpectralEfficiencyForMcs.data (),
+  NrMcsTable2::SpectralEfficiencyForCqi.data (),
+  NrMcsTable2::McsEcr.data (),
+  NrMcsTable2::McsM.data (),
+  NrMcsTable2::Beta.data ()
+};
+
+constexpr const NrMcsTable &
+NrMcsTable::Get (TableId id)
+{
+  return id == TABLE2 ? NrMcsTableView2 : NrMcsTableView1;
+}
+
+} // namespace ns3
+
+#endif // NR_MCS_TABLES_H
@@ -156,6 +156,14 @@ std::ostream &operator<< (std::ostream &os, const UlHarqInfo &item)
     }
   os << "for ProcessID: " << static_cast<uint32_t> (item.m_harqProcessId) << " of UE "
      << static_cast<uint32_t> (item.m_rnti) << " Num Retx: " << static_cast<uint32_t> (item.m_numRetx);
+  for (uint8_t stream = 0; stream < item.m_receptionStatusPerStream.size (); stream++)
+    {
+      if (item.m_receptionStatusPerStream.at (stream) != UlHarqInfo::NotValid)
+        {
+          os << " stream " << static_cast<uint32_t> (stream) << ": " <<
+            (item.m_receptionStatusPerStream.at (stream) == UlHarqInfo::Ok ? "ACK" : "NACK");
+        }
+    }
 
   return os;
 }
@@ -305,6 +305,11 @@ struct VarTtiAllocInfo
  */
 struct SlotAllocInfo
 {
+  /**
+   * \brief Default constructor, for the containers that reuse their elements
+   */
+  SlotAllocInfo () = default;
+
   SlotAllocInfo (SfnSf sfn)
     : m_sfnSf (sfn)
   {
@@ -374,6 +379,8 @@ struct DlCqiInfo
   } m_cqiType {WB}; //!< The type of the CQI
   std::vector<uint8_t> m_wbCqi;   //!< WB CQI for each MIMO stream
   uint8_t m_wbPmi {0}; //!< The reported wideband pre-coding matrix index
+  std::vector<std::vector<uint8_t> > m_sbCqi; //!< SB CQI for each MIMO stream, one value per sub-band (only for SB type; empty for a stream not measured)
+  uint16_t m_rbPerSb {0}; //!< Number of RBs of each sub-band (only for SB type)
 };
 
 /**
@@ -590,6 +597,13 @@ struct UlHarqInfo : public HarqInfo
     Ok, NotOk, NotValid
   } m_receptionStatus;
 
+  /**
+   * Reception status of each stream; NotValid for the streams that did not
+   * carry a TB. If empty, the feedback refers to the stream 0 only, and its
+   * status is m_receptionStatus
+   */
+  std::vector<enum ReceptionStatus> m_receptionStatusPerStream;
+
   uint8_t m_tpc {UINT8_MAX};       //!< Transmit Power Control
   uint8_t m_numRetx {UINT8_MAX};   //!< Num of Retx
 
@@ -598,12 +612,32 @@ struct UlHarqInfo : public HarqInfo
     return m_receptionStatus == Ok;
   }
 
+  bool IsReceivedOk (uint8_t stream) const
+  {
+    if (m_receptionStatusPerStream.empty ())
+      {
+        return stream == 0 && m_receptionStatus == Ok;
+      }
+    return m_receptionStatusPerStream.at (stream) == Ok;
+  }
+
   std::vector<uint8_t> GetNackStreamIndexes ()
   {
     std::vector<uint8_t> indexes;
-    if (m_receptionStatus == NotOk)
+    if (m_receptionStatusPerStream.empty ())
       {
-        indexes.push_back (0);
+        if (m_receptionStatus == NotOk)
+          {
+            indexes.push_back (0);
+          }
+        return indexes;
+      }
+    for (uint8_t i = 0; i < m_receptionStatusPerStream.size (); i++)
+      {
+        if (m_receptionStatusPerStream.at (i) == NotOk)
+          {
+            indexes.push_back (i);
+          }
       }
     return indexes;
   }
@@ -207,8 +207,9 @@ void
 NrPhy::DoDispose ()
 {
   NS_LOG_FUNCTION (this);
-  m_slotAllocInfo.clear ();
+  m_slotAllocInfo = NrSlotRing<SlotAllocInfo> ();
   m_controlMessageQueue.clear ();
+  m_ctrlMsgHead = 0;
   m_packetBurstMap.clear();
   m_ctrlMsgs.clear ();
   m_tddPattern.clear ();
@@ -453,7 +454,8 @@ NrPhy::EnqueueCtrlMessage (const Ptr<NrControlMessage> &m)
 {
   NS_LOG_FUNCTION (this);
 
-  m_controlMessageQueue.at (m_controlMessageQueue.size () - 1).push_back (m);
+  const uint32_t size = static_cast<uint32_t> (m_controlMessageQueue.size ());
+  m_controlMessageQueue.at ((m_ctrlMsgHead + size - 1) % size).push_back (m);
 }
 
 void
@@ -461,16 +463,14 @@ NrPhy::EnqueueCtrlMsgNow (const Ptr<NrControlMessage> &msg)
 {
   NS_LOG_FUNCTION (this);
 
-  m_controlMessageQueue.at (0).push_back (msg);
+  m_controlMessageQueue.at (m_ctrlMsgHead).push_back (msg);
 }
 
 void
 NrPhy::EnqueueCtrlMsgNow (const std::list<Ptr<NrControlMessage> > &listOfMsgs)
 {
-  for (const auto & msg : listOfMsgs)
-    {
-      m_controlMessageQueue.at (0).push_back (msg);
-    }
+  auto & now = m_controlMessageQueue.at (m_ctrlMsgHead);
+  now.insert (now.end (), listOfMsgs.begin (), listOfMsgs.end ());
 }
 
 void
@@ -609,11 +609,12 @@ NrPhy::InitializeMessageList ()
 {
   NS_LOG_FUNCTION (this);
   m_controlMessageQueue.clear ();
+  m_controlMessageQueue.resize (GetL1L2CtrlLatency () + 1);
+  m_ctrlMsgHead = 0;
 
-  for (unsigned i = 0; i <= GetL1L2CtrlLatency (); i++)
-    {
-      m_controlMessageQueue.push_back (std::list<Ptr<NrControlMessage> > ());
-    }
+  // Without a pattern-based reservation (done by the gNB), make room for
+  // allocations up to one pattern after the L1L2 latency
+  ReserveSlotAllocInfo (GetL1L2CtrlLatency () + static_cast<uint32_t> (m_tddPattern.size ()) + 1);
 }
 
 
@@ -627,22 +628,12 @@ NrPhy::PopCurrentSlotCtrlMsgs (void)
       return (emptylist);
     }
 
-  if (m_controlMessageQueue.at (0).size () > 0)
-    {
-      std::list<Ptr<NrControlMessage> > ret = m_controlMessageQueue.front ();
-      m_controlMessageQueue.erase (m_controlMessageQueue.begin ());
-      std::list<Ptr<NrControlMessage> > newlist;
-      m_controlMessageQueue.push_back (newlist);
-      return (ret);
-    }
-  else
-    {
-      m_controlMessageQueue.erase (m_controlMessageQueue.begin ());
-      std::list<Ptr<NrControlMessage> > newlist;
-      m_controlMessageQueue.push_back (newlist);
-      std::list<Ptr<NrControlMessage> > emptylist;
-      return (emptylist);
-    }
+  // The head list is taken (leaving it empty), and becomes the tail of
+  // the ring: the other lists are not moved
+  std::list<Ptr<NrControlMessage> > ret;
+  ret.swap (m_controlMessageQueue.at (m_ctrlMsgHead));
+  m_ctrlMsgHead = (m_ctrlMsgHead + 1) % m_controlMessageQueue.size ();
+  return ret;
 }
 
 void
@@ -703,33 +694,30 @@ NrPhy::PushBackSlotAllocInfo (const SlotAllocInfo &slotAllocInfo)
   NS_LOG_FUNCTION (this);
 
   NS_LOG_DEBUG ("setting info for slot " << slotAllocInfo.m_sfnSf);
+  NS_ASSERT (slotAllocInfo.m_sfnSf.GetNumerology () == GetNumerology ());
 
-  // That's not so complex, as the list would typically be of 2 or 3 elements.
-  bool updated = false;
-  for (auto & alloc : m_slotAllocInfo)
+  uint64_t slot = slotAllocInfo.m_sfnSf.Normalize ();
+  SlotAllocInfo *alloc = m_slotAllocInfo.Find (slot);
+  if (alloc != nullptr)
     {
-      if (alloc.m_sfnSf == slotAllocInfo.m_sfnSf)
-        {
-          NS_LOG_INFO ("Merging inside existing allocation");
-          alloc.Merge (slotAllocInfo);
-          updated = true;
-          break;
-        }
+      NS_LOG_INFO ("Merging inside existing allocation");
+      alloc->Merge (slotAllocInfo);
     }
-  if (! updated)
+  else
     {
-      m_slotAllocInfo.push_back (slotAllocInfo);
-      m_slotAllocInfo.sort ();
-      NS_LOG_INFO ("Pushing allocation at the end of the list");
+      m_slotAllocInfo.Insert (slot, slotAllocInfo);
+      NS_LOG_INFO ("Storing allocation in the slot ring");
     }
 
-  std::stringstream output;
-
-  for (const auto & alloc : m_slotAllocInfo)
+  if (g_log.IsEnabled (LOG_INFO))
     {
-      output << alloc;
+      std::stringstream output;
+      m_slotAllocInfo.ForEachInOrder ([&output] (uint64_t, const SlotAllocInfo & a)
+                                      {
+                                        output << a;
+                                      });
+      NS_LOG_INFO (output.str ());
     }
-  NS_LOG_INFO (output.str ());
 }
 
 void
@@ -737,7 +725,17 @@ NrPhy::PushFrontSlotAllocInfo (const SfnSf &newSfnSf, const SlotAllocInfo &slotA
 {
   NS_LOG_FUNCTION (this);
 
-  m_slotAllocInfo.push_front (slotAllocInfo);
+  // Rare path (the channel was not granted): all the allocations are moved
+  // out of the ring in order, renumbered, and stored back
+  std::vector<SlotAllocInfo> allocations;
+  allocations.reserve (m_slotAllocInfo.GetSize () + 1);
+  allocations.push_back (slotAllocInfo);
+  m_slotAllocInfo.ForEachInOrder ([&allocations] (uint64_t, SlotAllocInfo & a)
+                                  {
+                                    allocations.push_back (std::move (a));
+                                  });
+  m_slotAllocInfo.Clear ();
+
   SfnSf currentSfn = newSfnSf;
   std::unordered_map<uint64_t, Ptr<PacketBurst>> newBursts; // map between new sfn and the packet burst
   std::unordered_map<uint64_t, uint64_t> sfnMap; // map between new and old sfn, for debugging
@@ -745,7 +743,7 @@ NrPhy::PushFrontSlotAllocInfo (const SfnSf &newSfnSf, const SlotAllocInfo &slotA
   // all the slot allocations  (and their packet burst) have to be "adjusted":
   // directly modify the sfn for the allocation, and temporarly store the
   // burst (along with the new sfn) into newBursts.
-  for (auto it = m_slotAllocInfo.begin (); it != m_slotAllocInfo.end (); ++it)
+  for (auto it = allocations.begin (); it != allocations.end (); ++it)
     {
       auto slotSfn = it->m_sfnSf;
       for (const auto &alloc : it->m_varTtiAllocInfo)
@@ -772,6 +770,7 @@ NrPhy::PushFrontSlotAllocInfo (const SfnSf &newSfnSf, const SlotAllocInfo &slotA
 
       NS_LOG_INFO ("Set slot allocation for " << it->m_sfnSf << " to " << currentSfn);
       it->m_sfnSf = currentSfn;
+      m_slotAllocInfo.Insert (currentSfn.Normalize (), *it);
       currentSfn.Add (1);
     }
 
@@ -792,22 +791,15 @@ NrPhy::SlotAllocInfoExists (const SfnSf &retVal) const
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (retVal.GetNumerology () == GetNumerology ());
-  for (const auto & alloc : m_slotAllocInfo)
-    {
-      if (alloc.m_sfnSf == retVal)
-        {
-          return true;
-        }
-    }
-  return false;
+  return m_slotAllocInfo.Find (retVal.Normalize ()) != nullptr;
 }
 
 SlotAllocInfo
 NrPhy::RetrieveSlotAllocInfo ()
 {
   NS_LOG_FUNCTION (this);
-  SlotAllocInfo ret = *m_slotAllocInfo.begin ();
-  m_slotAllocInfo.erase (m_slotAllocInfo.begin ());
+  SlotAllocInfo ret;
+  m_slotAllocInfo.Pop (m_slotAllocInfo.GetFirstSlot (), ret);
   return ret;
 }
 
@@ -818,18 +810,12 @@ NrPhy::RetrieveSlotAllocInfo (const SfnSf &sfnsf)
   NS_LOG_FUNCTION (" slot " << sfnsf);
   NS_ASSERT (sfnsf.GetNumerology () == GetNumerology ());
 
-  for (auto allocIt = m_slotAllocInfo.begin(); allocIt != m_slotAllocInfo.end (); ++allocIt)
+  SlotAllocInfo ret (sfnsf);
+  if (! m_slotAllocInfo.Pop (sfnsf.Normalize (), ret))
     {
-      if (allocIt->m_sfnSf == sfnsf)
-        {
-          SlotAllocInfo ret = *allocIt;
-          m_slotAllocInfo.erase (allocIt);
-          return ret;
-        }
+      NS_FATAL_ERROR ("Didn't found the slot");
     }
-
-  NS_FATAL_ERROR("Didn't found the slot");
-  return SlotAllocInfo (sfnsf);
+  return ret;
 }
 
 SlotAllocInfo &
@@ -837,29 +823,30 @@ NrPhy::PeekSlotAllocInfo (const SfnSf &sfnsf)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (sfnsf.GetNumerology () == GetNumerology ());
-  for (auto & alloc : m_slotAllocInfo)
-    {
-      if (alloc.m_sfnSf == sfnsf)
-        {
-          return alloc;
-        }
-    }
-
-  NS_FATAL_ERROR ("Didn't found the slot");
+  SlotAllocInfo *alloc = m_slotAllocInfo.Find (sfnsf.Normalize ());
+  NS_ABORT_MSG_IF (alloc == nullptr, "Didn't found the slot");
+  return *alloc;
 }
 
 size_t
 NrPhy::SlotAllocInfoSize() const
 {
   NS_LOG_FUNCTION (this);
-  return m_slotAllocInfo.size ();
+  return m_slotAllocInfo.GetSize ();
+}
+
+void
+NrPhy::ReserveSlotAllocInfo (uint32_t slots)
+{
+  NS_LOG_FUNCTION (this << slots);
+  m_slotAllocInfo.Reserve (slots);
 }
 
 bool
 NrPhy::IsCtrlMsgListEmpty() const
 {
   NS_LOG_FUNCTION (this);
-  return m_controlMessageQueue.empty () || m_controlMessageQueue.at (0).empty();
+  return m_controlMessageQueue.empty () || m_controlMessageQueue.at (m_ctrlMsgHead).empty ();
 }
 
 Ptr<const SpectrumModel>
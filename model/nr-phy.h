@@ -25,6 +25,7 @@
 #include <ns3/nr-spectrum-value-helper.h>
 #include "nr-sl-ue-phy-sap.h"
 #include "nr-sl-phy-mac-common.h"
+#include "nr-slot-ring.h"
 
 namespace ns3 {
 
@@ -46,23 +47,26 @@ class BeamConfId;
  *
  * \section phy_management_ctrl Management of the control message list
  *
- * The control message list is maintained as a list that has, always, a number
- * of element equals to the latency between PHY and MAC, plus one. The list
- * is initialized by a call to InitializeMessageList(). The messages
- * are enqueued by MAC at the end of the list through the method EnqueueCtrlMessage().
+ * The control message list is maintained as a ring of lists that has, always,
+ * a number of element equals to the latency between PHY and MAC, plus one. The
+ * ring is initialized by a call to InitializeMessageList(). The messages
+ * are enqueued by MAC at the end of the ring through the method EnqueueCtrlMessage().
  * If the PHY has the necessity of adding a message, then it can use the
  * no-latency version of it, namely EnqueueCtrlMsgNow(). The messages for the
- * current slot (i.e., the messages at the front of the list) can be retrieved
- * with PopCurrentSlotCtrlMsgs(). To know if there are messages for the current
- * slot, use IsCtrlMsgListEmpty(). The list is stored in the variable
- * m_controlMessageQueue.
+ * current slot (i.e., the messages at the head of the ring) can be retrieved
+ * with PopCurrentSlotCtrlMsgs(), which empties the head list and advances the
+ * head, without moving the other lists. To know if there are messages for the current
+ * slot, use IsCtrlMsgListEmpty(). The ring is stored in the variable
+ * m_controlMessageQueue, and its head in m_ctrlMsgHead.
  *
  * \section phy_slot Management of the slot allocation list
  *
  * At the gNb, After the MAC does the slot allocation, it is saved in the PHY with the method
  * PushBackSlotAllocInfo(), and if an allocation for the same slot is already
  * present, the two will be merged together. The slot allocation is stored
- * inside the variable m_slotAllocInfo.
+ * inside the variable m_slotAllocInfo, a NrSlotRing indexed by the
+ * normalized slot number (SfnSf::Normalize), so that the lookups done in
+ * every slot do not depend on the number of allocations queued.
  *
  * \section phy_mac_pdu Management of the MAC PDU that waits to be transmitted
  *
@@ -539,6 +543,17 @@ protected:
    */
   size_t SlotAllocInfoSize () const;
 
+  /**
+   * \brief Size the storage of the slot allocations
+   * \param slots number of slots, starting from the current one, for which
+   * an allocation can be queued
+   *
+   * The gNB calls it with the farthest slot the MAC can be asked to schedule
+   * (L1L2 latency plus K0 or K2). Allocations farther than that are still
+   * stored, at the cost of a reallocation.
+   */
+  void ReserveSlotAllocInfo (uint32_t slots);
+
   /**
    * \brief Check if there are no control messages queued for this slot
    * \return true if there are no control messages queued for this slot
@@ -587,8 +602,9 @@ protected:
   std::vector<LteNrTddSlotType> m_tddPattern = { F, F, F, F, F, F, F, F, F, F}; //!< Pattern
 
 private:
-  std::list<SlotAllocInfo> m_slotAllocInfo; //!< slot allocation info list
-  std::vector<std::list<Ptr<NrControlMessage>>> m_controlMessageQueue; //!< CTRL message queue
+  NrSlotRing<SlotAllocInfo> m_slotAllocInfo; //!< slot allocation info, indexed by the normalized slot
+  std::vector<std::list<Ptr<NrControlMessage>>> m_controlMessageQueue; //!< CTRL message queue, used as a ring
+  uint32_t m_ctrlMsgHead {0}; //!< Position in m_controlMessageQueue of the messages of the current slot
 
   Time m_tbDecodeLatencyUs {MicroSeconds(100)}; //!< transport block decode latency
   double m_centralFrequency {-1.0};             //!< Channel central frequency -- set by the helper
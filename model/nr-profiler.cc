@@ -0,0 +1,265 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-profiler.h"
+#include <ns3/log.h>
+#include <ns3/boolean.h>
+#include <ns3/string.h>
+#include <ns3/simulator.h>
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrProfiler");
+NS_OBJECT_ENSURE_REGISTERED (NrProfiler);
+
+NrProfiler::Scope::Scope (Probe probe)
+  : m_probe (probe),
+    m_start (std::chrono::steady_clock::now ())
+{
+}
+
+NrProfiler::Scope::~Scope ()
+{
+  auto duration = std::chrono::steady_clock::now () - m_start;
+  NrProfiler::Get ()->AddSample (m_probe, static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count ()));
+}
+
+TypeId
+NrProfiler::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrProfiler")
+    .SetParent<Object> ()
+    .SetGroupName ("nr")
+    .AddConstructor<NrProfiler> ()
+    .AddAttribute ("PrintSummary",
+                   "Print the summary of the probes when the simulator is destroyed",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NrProfiler::m_printSummary),
+                   MakeBooleanChecker ())
+    .AddAttribute ("SummaryFileName",
+                   "Name of the file of the summary. If empty, the summary "
+                   "is printed on the standard output",
+                   StringValue (""),
+                   MakeStringAccessor (&NrProfiler::m_summaryFileName),
+                   MakeStringChecker ())
+    .AddTraceSource ("Sample",
+                     "A sample of a probe: the probe and its value (in ns for the timers)",
+                     MakeTraceSourceAccessor (&NrProfiler::m_sampleTrace),
+                     "ns3::NrProfiler::SampleTracedCallback")
+    ;
+  return tid;
+}
+
+NrProfiler::NrProfiler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NrProfiler::~NrProfiler ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+Ptr<NrProfiler>
+NrProfiler::Get ()
+{
+  static Ptr<NrProfiler> profiler = CreateObject<NrProfiler> ();
+  if (!profiler->m_endScheduled)
+    {
+      profiler->m_endScheduled = true;
+      Simulator::ScheduleDestroy (&NrProfiler::EndOfSimulation, profiler);
+    }
+  return profiler;
+}
+
+uint32_t
+NrProfiler::GetBin (uint64_t value)
+{
+  if (value == 0)
+    {
+      return 0;
+    }
+#if defined(__GNUC__)
+  return 64 - static_cast<uint32_t> (__builtin_clzll (value));
+#else
+  uint32_t bits = 0;
+  while (value != 0)
+    {
+      value >>= 1;
+      ++bits;
+    }
+  return bits;
+#endif
+}
+
+void
+NrProfiler::Record (ProbeStats *stats, uint64_t value)
+{
+  stats->m_samples++;
+  stats->m_total += value;
+  stats->m_max = std::max (stats->m_max, value);
+  stats->m_histogram[GetBin (value)]++;
+}
+
+void
+NrProfiler::AddSample (Probe probe, uint64_t value)
+{
+  NS_ASSERT (probe < NUM_PROBES);
+  Record (&m_stats[probe], value);
+  m_sampleTrace (probe, value);
+}
+
+uint64_t
+NrProfiler::GetNumSamples (Probe probe) const
+{
+  return m_stats.at (probe).m_samples;
+}
+
+uint64_t
+NrProfiler::GetTotal (Probe probe) const
+{
+  return m_stats.at (probe).m_total;
+}
+
+uint64_t
+NrProfiler::GetBinCount (Probe probe, uint32_t bin) const
+{
+  return m_stats.at (probe).m_histogram.at (bin);
+}
+
+std::string
+NrProfiler::GetProbeName (Probe probe)
+{
+  switch (probe)
+    {
+    case GNB_PHY_START_SLOT:
+      return "GnbPhyStartSlot";
+    case MAC_SCHED_DL:
+      return "MacSchedDl";
+    case MAC_SCHED_UL:
+      return "MacSchedUl";
+    case SPECTRUM_START_RX:
+      return "SpectrumStartRx";
+    case SPECTRUM_END_RX_DATA:
+      return "SpectrumEndRxData";
+    case ERROR_MODEL:
+      return "ErrorModel";
+    case UE_MAC_SL_SENSING:
+      return "UeMacSlSensing";
+    case MAC_SCHED_DL_UES:
+      return "MacSchedDlUes";
+    case MAC_SCHED_DL_RBGS:
+      return "MacSchedDlRbgs";
+    case MAC_SCHED_UL_UES:
+      return "MacSchedUlUes";
+    case MAC_SCHED_UL_RBGS:
+      return "MacSchedUlRbgs";
+    case SPECTRUM_RX_SIGNALS:
+      return "SpectrumRxSignals";
+    case SPECTRUM_RX_DATA_TBS:
+      return "SpectrumRxDataTbs";
+    case UE_MAC_SL_CANDIDATES:
+      return "UeMacSlCandidates";
+    default:
+      NS_FATAL_ERROR ("Unknown probe " << +probe);
+    }
+  return "";
+}
+
+double
+NrProfiler::MeasureOverhead (uint32_t iterations)
+{
+  NS_ASSERT (iterations > 0);
+  ProbeStats stats;
+  auto start = std::chrono::steady_clock::now ();
+  for (uint32_t i = 0; i < iterations; ++i)
+    {
+      auto sampleStart = std::chrono::steady_clock::now ();
+      auto duration = std::chrono::steady_clock::now () - sampleStart;
+      Record (&stats, static_cast<uint64_t> (std::chrono::duration_cast<std::chrono::nanoseconds> (duration).count ()));
+    }
+  auto total = std::chrono::steady_clock::now () - start;
+  return static_cast<double> (std::chrono::duration_cast<std::chrono::nanoseconds> (total).count ()) / iterations;
+}
+
+void
+NrProfiler::PrintSummary (std::ostream &os) const
+{
+  uint64_t totalSamples = 0;
+  os << "Probe\tSamples\tTotal\tMean\tMax\tHistogram (bin:count, bin i holds [2^(i-1), 2^i))" << std::endl;
+  for (uint8_t probe = 0; probe < NUM_PROBES; ++probe)
+    {
+      const ProbeStats &stats = m_stats[probe];
+      if (stats.m_samples == 0)
+        {
+          continue;
+        }
+      totalSamples += stats.m_samples;
+      os << GetProbeName (static_cast<Probe> (probe)) << "\t" << stats.m_samples << "\t" << stats.m_total <<
+        "\t" << std::fixed << std::setprecision (1) << static_cast<double> (stats.m_total) / stats.m_samples <<
+        "\t" << stats.m_max << "\t";
+      for (uint32_t bin = 0; bin < NUM_BINS; ++bin)
+        {
+          if (stats.m_histogram[bin] > 0)
+            {
+              os << bin << ":" << stats.m_histogram[bin] << " ";
+            }
+        }
+      os << std::endl;
+    }
+
+  double overhead = MeasureOverhead (100000);
+  os << "Profiling overhead: " << std::fixed << std::setprecision (1) << overhead <<
+    " ns per sample, " << overhead * totalSamples / 1e6 << " ms in total" << std::endl;
+}
+
+void
+NrProfiler::Reset ()
+{
+  NS_LOG_FUNCTION (this);
+  m_stats = std::array<ProbeStats, NUM_PROBES> ();
+}
+
+void
+NrProfiler::EndOfSimulation ()
+{
+  NS_LOG_FUNCTION (this);
+  bool hasSamples = std::any_of (m_stats.begin (), m_stats.end (),
+                                 [] (const ProbeStats &stats) { return stats.m_samples > 0; });
+  if (m_printSummary && hasSamples)
+    {
+      if (m_summaryFileName.empty ())
+        {
+          PrintSummary (std::cout);
+        }
+      else
+        {
+          std::ofstream file (m_summaryFileName, std::ios_base::app);
+          NS_ABORT_MSG_UNLESS (file.is_open (), "Can't open file " << m_summaryFileName);
+          PrintSummary (file);
+        }
+    }
+  Reset ();
+  m_endScheduled = false;
+}
+
+} // namespace ns3
@@ -0,0 +1,247 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NR_PROFILER_H
+#define NR_PROFILER_H
+
+#include <ns3/object.h>
+#include <ns3/traced-callback.h>
+#include <array>
+#include <chrono>
+#include <ostream>
+
+namespace ns3 {
+
+/**
+ * \ingroup utils
+ * \brief Collects the wall-clock time spent in the hot paths of the module,
+ * and some counters of the work done in them
+ *
+ * Each probe is either a timer, that measures in ns the wall-clock time of a
+ * scope (e.g., NrGnbPhy::StartSlot), or a counter, that records a quantity
+ * (e.g., the UEs considered by the scheduler in a slot). For each probe, the
+ * profiler keeps the number of samples, their sum and maximum, and a
+ * histogram with power-of-two bins: the bin i holds the samples in
+ * [2^(i-1), 2^i), and the bin 0 the samples equal to 0.
+ *
+ * The probes are placed in the code with the macros NR_PROFILE_SCOPE and
+ * NR_PROFILE_COUNT, which expand to nothing unless the module is built
+ * with the definition NR_PROFILING (CMake option NR_PROFILING). When
+ * enabled, every sample is also fired through the trace source "Sample",
+ * and a summary is printed when the simulator is destroyed, together with
+ * the overhead of a sample measured on the running machine.
+ *
+ * There is only one profiler, obtained with NrProfiler::Get ():
+ *
+\verbatim
+  NrProfiler::Get ()->TraceConnectWithoutContext ("Sample", MakeCallback (&MySampleSink));
+\endverbatim
+ */
+class NrProfiler : public Object
+{
+public:
+  /**
+   * \brief The probes of the module
+   */
+  enum Probe : uint8_t
+  {
+    // timers, in ns
+    GNB_PHY_START_SLOT = 0,   //!< NrGnbPhy::StartSlot
+    MAC_SCHED_DL,             //!< NrMacSchedulerNs3::ScheduleDl
+    MAC_SCHED_UL,             //!< NrMacSchedulerNs3::ScheduleUl
+    SPECTRUM_START_RX,        //!< NrSpectrumPhy::StartRx
+    SPECTRUM_END_RX_DATA,     //!< NrSpectrumPhy::EndRxData
+    ERROR_MODEL,              //!< Decodification stats of the error models
+    UE_MAC_SL_SENSING,        //!< NrUeMac::GetNrSlTxOpportunities
+    // counters
+    MAC_SCHED_DL_UES,         //!< UEs with DL data considered by the scheduler
+    MAC_SCHED_DL_RBGS,        //!< RBGs assigned to DL data
+    MAC_SCHED_UL_UES,         //!< UEs with UL data considered by the scheduler
+    MAC_SCHED_UL_RBGS,        //!< RBGs assigned to UL data
+    SPECTRUM_RX_SIGNALS,      //!< Energy changes tracked by the interference at the start of a reception
+    SPECTRUM_RX_DATA_TBS,     //!< TBs evaluated at the end of a data reception
+    UE_MAC_SL_CANDIDATES,     //!< Candidate slots left by the sidelink sensing
+    NUM_PROBES                //!< Number of probes, not a probe
+  };
+
+  /**
+   * \brief Measures the wall-clock time of a scope, and records it in the
+   * profiler when destroyed
+   */
+  class Scope
+  {
+  public:
+    /**
+     * \brief Start measuring
+     * \param probe the timer probe
+     */
+    Scope (Probe probe);
+    /**
+     * \brief Stop measuring, and record the duration
+     */
+    ~Scope ();
+    Scope (const Scope &) = delete;
+    Scope& operator= (const Scope &) = delete;
+
+  private:
+    Probe m_probe; //!< The probe
+    std::chrono::steady_clock::time_point m_start; //!< The start of the scope
+  };
+
+  /**
+   * \brief Get the type ID
+   * \return the type id
+   */
+  static TypeId GetTypeId (void);
+  /**
+   * \brief NrProfiler constructor
+   */
+  NrProfiler ();
+  /**
+   * \brief destructor
+   */
+  ~NrProfiler () override;
+
+  /**
+   * \brief Get the profiler of the module
+   *
+   * The first call in a simulation schedules the summary for when the
+   * simulator is destroyed.
+   * \return the profiler
+   */
+  static Ptr<NrProfiler> Get ();
+
+  /**
+   * \brief Record a sample
+   * \param probe the probe
+   * \param value the value, in ns for the timers
+   */
+  void AddSample (Probe probe, uint64_t value);
+
+  /**
+   * \brief Get the number of samples of a probe
+   * \param probe the probe
+   * \return the number of samples
+   */
+  uint64_t GetNumSamples (Probe probe) const;
+  /**
+   * \brief Get the sum of the samples of a probe
+   * \param probe the probe
+   * \return the sum of the samples
+   */
+  uint64_t GetTotal (Probe probe) const;
+  /**
+   * \brief Get a bin of the histogram of a probe
+   * \param probe the probe
+   * \param bin the bin, lower than NUM_BINS
+   * \return the number of samples in the bin
+   */
+  uint64_t GetBinCount (Probe probe, uint32_t bin) const;
+  /**
+   * \brief Get the histogram bin of a value
+   * \param value the value
+   * \return 0 for 0, otherwise the number of bits of the value
+   */
+  static uint32_t GetBin (uint64_t value);
+  /**
+   * \brief Get the name of a probe
+   * \param probe the probe
+   * \return the name
+   */
+  static std::string GetProbeName (Probe probe);
+
+  /**
+   * \brief Measure the average wall-clock cost of a timer sample, i.e., of
+   * reading the clock twice and recording the duration
+   * \param iterations the number of samples to measure
+   * \return the cost of a sample, in ns
+   */
+  static double MeasureOverhead (uint32_t iterations);
+
+  /**
+   * \brief Print the summary of all the probes with at least one sample
+   * \param os the output stream
+   */
+  void PrintSummary (std::ostream &os) const;
+  /**
+   * \brief Remove all the samples
+   */
+  void Reset ();
+
+  /**
+   * \brief TracedCallback signature for the samples
+   * \param [in] probe the probe
+   * \param [in] value the value of the sample
+   */
+  typedef void (* SampleTracedCallback)(uint8_t probe, uint64_t value);
+
+  static const uint32_t NUM_BINS = 65; //!< Number of bins of the histograms
+
+private:
+  /**
+   * \brief The samples of a probe
+   */
+  struct ProbeStats
+  {
+    uint64_t m_samples {0};                         //!< Number of samples
+    uint64_t m_total {0};                           //!< Sum of the samples
+    uint64_t m_max {0};                             //!< Maximum sample
+    std::array<uint64_t, NUM_BINS> m_histogram {};  //!< Power-of-two histogram
+  };
+
+  /**
+   * \brief Record a value in the stats of a probe
+   * \param stats the stats
+   * \param value the value
+   */
+  static void Record (ProbeStats *stats, uint64_t value);
+  /**
+   * \brief Print the summary, if enabled and if there is any sample, and
+   * reset the samples
+   */
+  void EndOfSimulation ();
+
+  std::array<ProbeStats, NUM_PROBES> m_stats; //!< The samples of each probe
+  TracedCallback<uint8_t, uint64_t> m_sampleTrace; //!< Trace of each sample
+  bool m_printSummary {true};       //!< Print the summary at the end of the simulation
+  std::string m_summaryFileName;    //!< File of the summary, empty for the standard output
+  bool m_endScheduled {false};      //!< The summary is scheduled for the end of the simulation
+};
+
+} // namespace ns3
+
+#ifdef NR_PROFILING
+/**
+ * \brief Measure the wall-clock time of the current scope with a timer probe
+ * of NrProfiler, e.g., NR_PROFILE_SCOPE (MAC_SCHED_DL)
+ */
+#define NR_PROFILE_SCOPE(probe) \
+  ns3::NrProfiler::Scope nrProfilerScope (ns3::NrProfiler::probe)
+/**
+ * \brief Record a value with a counter probe of NrProfiler. The value is
+ * not evaluated when the profiling is disabled.
+ */
+#define NR_PROFILE_COUNT(probe, value) \
+  ns3::NrProfiler::Get ()->AddSample (ns3::NrProfiler::probe, value)
+#else
+#define NR_PROFILE_SCOPE(probe)
+#define NR_PROFILE_COUNT(probe, value)
+#endif
+
+#endif /* NR_PROFILER_H */
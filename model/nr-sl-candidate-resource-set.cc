@@ -0,0 +1,195 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-sl-candidate-resource-set.h"
+
+#include <ns3/log.h>
+#include <ns3/abort.h>
+#include <bitset>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrSlCandidateResourceSet");
+
+/**
+ * \brief Count the bits set in a word
+ * \param word the word
+ * \return the number of bits set
+ */
+static uint32_t
+PopCount (uint64_t word)
+{
+  return static_cast<uint32_t> (std::bitset<64> (word).count ());
+}
+
+NrSlCandidateResourceSet::NrSlCandidateResourceSet (uint32_t numSlots, uint8_t numSubCh)
+  : m_numSlots (numSlots),
+    m_allSubChMask (GetSubChMask (0, numSubCh)),
+    m_candidates ((numSlots + WORD_BITS - 1) / WORD_BITS, 0),
+    m_occupied (numSlots, 0)
+{
+  NS_LOG_FUNCTION (this << numSlots << +numSubCh);
+  NS_ABORT_MSG_IF (numSubCh > WORD_BITS, "At most " << WORD_BITS << " sub-channels are supported");
+  SetAllCandidates ();
+}
+
+uint32_t
+NrSlCandidateResourceSet::GetNumSlots () const
+{
+  return m_numSlots;
+}
+
+uint64_t
+NrSlCandidateResourceSet::GetSubChMask (uint8_t sbChStart, uint8_t sbChLength)
+{
+  if (sbChStart >= WORD_BITS || sbChLength == 0)
+    {
+      return 0;
+    }
+  uint64_t mask = sbChLength >= WORD_BITS ? ~static_cast<uint64_t> (0)
+                                          : (static_cast<uint64_t> (1) << sbChLength) - 1;
+  return mask << sbChStart;
+}
+
+void
+NrSlCandidateResourceSet::SetAllCandidates ()
+{
+  for (auto &word : m_candidates)
+    {
+      word = ~static_cast<uint64_t> (0);
+    }
+  //clear the bits after the last slot, so that they are never counted
+  uint32_t lastBits = m_numSlots % WORD_BITS;
+  if (lastBits != 0)
+    {
+      m_candidates.back () = (static_cast<uint64_t> (1) << lastBits) - 1;
+    }
+}
+
+void
+NrSlCandidateResourceSet::Exclude (uint32_t slot)
+{
+  NS_ASSERT (slot < m_numSlots);
+  m_candidates.at (slot / WORD_BITS) &= ~(static_cast<uint64_t> (1) << (slot % WORD_BITS));
+}
+
+void
+NrSlCandidateResourceSet::ExcludeRange (uint32_t first, uint32_t last)
+{
+  NS_ASSERT (first <= last && last < m_numSlots);
+  uint32_t firstWord = first / WORD_BITS;
+  uint32_t lastWord = last / WORD_BITS;
+  for (uint32_t w = firstWord; w <= lastWord; ++w)
+    {
+      uint8_t start = w == firstWord ? first % WORD_BITS : 0;
+      uint8_t end = w == lastWord ? last % WORD_BITS : WORD_BITS - 1;
+      m_candidates.at (w) &= ~GetSubChMask (start, end - start + 1);
+    }
+}
+
+bool
+NrSlCandidateResourceSet::IsCandidate (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_numSlots);
+  return (m_candidates.at (slot / WORD_BITS) >> (slot % WORD_BITS)) & 1;
+}
+
+uint32_t
+NrSlCandidateResourceSet::GetNumCandidates () const
+{
+  uint32_t count = 0;
+  for (const auto &word : m_candidates)
+    {
+      count += PopCount (word);
+    }
+  return count;
+}
+
+uint32_t
+NrSlCandidateResourceSet::Select (uint32_t rank) const
+{
+  for (uint32_t w = 0; w < m_candidates.size (); ++w)
+    {
+      uint64_t word = m_candidates.at (w);
+      uint32_t count = PopCount (word);
+      if (rank >= count)
+        {
+          rank -= count;
+          continue;
+        }
+      //clear the lowest set bits until the wanted one is the lowest
+      for (; rank > 0; --rank)
+        {
+          word &= word - 1;
+        }
+      //the number of trailing zeros is the index of the lowest set bit
+      return w * WORD_BITS + PopCount ((word & (~word + 1)) - 1);
+    }
+  NS_ABORT_MSG ("Rank exceeds the number of candidates " << GetNumCandidates ());
+  return m_numSlots;
+}
+
+std::vector<uint32_t>
+NrSlCandidateResourceSet::GetCandidates () const
+{
+  std::vector<uint32_t> candidates;
+  candidates.reserve (GetNumCandidates ());
+  for (uint32_t w = 0; w < m_candidates.size (); ++w)
+    {
+      uint64_t word = m_candidates.at (w);
+      while (word != 0)
+        {
+          uint64_t lowest = word & (~word + 1);
+          candidates.push_back (w * WORD_BITS + PopCount (lowest - 1));
+          word &= word - 1;
+        }
+    }
+  return candidates;
+}
+
+void
+NrSlCandidateResourceSet::Occupy (uint32_t slot, uint8_t sbChStart, uint8_t sbChLength)
+{
+  NS_ASSERT (slot < m_numSlots);
+  m_occupied.at (slot) |= GetSubChMask (sbChStart, sbChLength);
+}
+
+bool
+NrSlCandidateResourceSet::IsFullyOccupied (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_numSlots);
+  return (m_occupied.at (slot) & m_allSubChMask) == m_allSubChMask;
+}
+
+std::set<uint8_t>
+NrSlCandidateResourceSet::GetOccupiedSubCh (uint32_t slot) const
+{
+  NS_ASSERT (slot < m_numSlots);
+  std::set<uint8_t> occupied;
+  uint64_t word = m_occupied.at (slot);
+  while (word != 0)
+    {
+      uint64_t lowest = word & (~word + 1);
+      occupied.insert (static_cast<uint8_t> (PopCount (lowest - 1)));
+      word &= word - 1;
+    }
+  return occupied;
+}
+
+} // namespace ns3
@@ -0,0 +1,147 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NR_SL_CANDIDATE_RESOURCE_SET_H
+#define NR_SL_CANDIDATE_RESOURCE_SET_H
+
+#include <cstdint>
+#include <set>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ue-mac
+ * \brief The candidate single-slot resources of a NR SL selection window,
+ *        stored as bitmaps
+ *
+ * The slots of the window are identified by their index in the window.
+ * The set keeps:
+ *
+ * - one bit per slot telling whether the slot is still a candidate. The
+ *   bits are packed in 64-bit words, so that counting the candidates is a
+ *   popcount of each word, and finding the n-th candidate (select) skips
+ *   whole words;
+ * - one 64-bit word per slot with the occupied sub-channels, so that
+ *   marking the sub-channels of a sensed transmission, or checking if all
+ *   of them are occupied, is a single mask operation.
+ *
+ * It replaces the lists of slots and the per-slot sets of sub-channels in
+ * the sensing-based resource selection of NrUeMac, and in the random slot
+ * selection of the SL schedulers.
+ */
+class NrSlCandidateResourceSet
+{
+public:
+  /**
+   * \brief NrSlCandidateResourceSet constructor
+   *
+   * All the slots are candidates, and all the sub-channels are free.
+   *
+   * \param numSlots The number of slots of the selection window
+   * \param numSubCh The number of sub-channels of a slot (at most 64)
+   */
+  NrSlCandidateResourceSet (uint32_t numSlots, uint8_t numSubCh);
+
+  /**
+   * \brief Get the number of slots of the selection window
+   * \return the number of slots
+   */
+  uint32_t GetNumSlots () const;
+
+  /**
+   * \brief Mark all the slots as candidates
+   */
+  void SetAllCandidates ();
+  /**
+   * \brief Exclude a slot
+   * \param slot The index of the slot in the window
+   */
+  void Exclude (uint32_t slot);
+  /**
+   * \brief Exclude all the slots in [first, last]
+   * \param first The index of the first slot to exclude
+   * \param last The index of the last slot to exclude
+   */
+  void ExcludeRange (uint32_t first, uint32_t last);
+  /**
+   * \brief Check if a slot is a candidate
+   * \param slot The index of the slot in the window
+   * \return true if the slot is still a candidate
+   */
+  bool IsCandidate (uint32_t slot) const;
+  /**
+   * \brief Count the candidate slots
+   * \return the number of candidate slots
+   */
+  uint32_t GetNumCandidates () const;
+  /**
+   * \brief Find the candidate slot of a given rank
+   * \param rank The rank, starting from 0, of the candidate among the
+   *        candidates in increasing slot order
+   * \return the index of the slot in the window
+   */
+  uint32_t Select (uint32_t rank) const;
+  /**
+   * \brief Get the indexes of the candidate slots
+   * \return the indexes, in increasing order
+   */
+  std::vector<uint32_t> GetCandidates () const;
+
+  /**
+   * \brief Mark as occupied the sub-channels [sbChStart, sbChStart + sbChLength)
+   *        of a slot
+   * \param slot The index of the slot in the window
+   * \param sbChStart The first occupied sub-channel
+   * \param sbChLength The number of occupied sub-channels
+   */
+  void Occupy (uint32_t slot, uint8_t sbChStart, uint8_t sbChLength);
+  /**
+   * \brief Check if all the sub-channels of a slot are occupied
+   * \param slot The index of the slot in the window
+   * \return true if no sub-channel of the slot is free
+   */
+  bool IsFullyOccupied (uint32_t slot) const;
+  /**
+   * \brief Get the occupied sub-channels of a slot
+   * \param slot The index of the slot in the window
+   * \return the indexes of the occupied sub-channels
+   */
+  std::set<uint8_t> GetOccupiedSubCh (uint32_t slot) const;
+
+  /**
+   * \brief Get the mask of the sub-channels [sbChStart, sbChStart + sbChLength)
+   * \param sbChStart The first sub-channel
+   * \param sbChLength The number of sub-channels
+   * \return the mask, with the bit i set for the sub-channel i
+   */
+  static uint64_t GetSubChMask (uint8_t sbChStart, uint8_t sbChLength);
+
+private:
+  static const uint32_t WORD_BITS = 64; //!< The number of bits of a bitmap word
+
+  uint32_t m_numSlots {0};             //!< The number of slots of the window
+  uint64_t m_allSubChMask {0};         //!< The mask with all the sub-channels set
+  std::vector<uint64_t> m_candidates;  //!< One bit per slot, set if the slot is a candidate
+  std::vector<uint64_t> m_occupied;    //!< One word per slot, with the occupied sub-channels
+};
+
+} // namespace ns3
+
+#endif /* NR_SL_CANDIDATE_RESOURCE_SET_H */
@@ -36,6 +36,8 @@ NrSlCommResourcePoolFactory::NrSlCommResourcePoolFactory ()
   m_slResourceReservePeriodList = {0, 10, 20, 50, 100, 150, 200, 250, 300, 350, 400, 500, 550, 600, 750, 1000};
   m_slTimeResource = {1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 1, 1, 1};
   m_slMaxNumPerReserve = 2;
+  m_slPsfchPeriod = 0;
+  m_slMinTimeGapPsfch = 2;
 }
 
 NrSlCommResourcePoolFactory::~NrSlCommResourcePoolFactory ()
@@ -443,6 +445,60 @@ NrSlCommResourcePoolFactory::SetSlMaxNumPerReserve (uint16_t maxNumPerReserve)
   m_slMaxNumPerReserve = maxNumPerReserve;
 }
 
+uint16_t
+NrSlCommResourcePoolFactory::GetSlPsfchPeriod () const
+{
+  return m_slPsfchPeriod;
+}
+
+void
+NrSlCommResourcePoolFactory::SetSlPsfchPeriod (uint16_t psfchPeriod)
+{
+  m_slPsfchPeriod = psfchPeriod;
+}
+
+uint16_t
+NrSlCommResourcePoolFactory::GetSlMinTimeGapPsfch () const
+{
+  return m_slMinTimeGapPsfch;
+}
+
+void
+NrSlCommResourcePoolFactory::SetSlMinTimeGapPsfch (uint16_t minTimeGap)
+{
+  m_slMinTimeGapPsfch = minTimeGap;
+}
+
+NrSlPsfchConfig
+NrSlCommResourcePoolFactory::GetSlPsfchConfig () const
+{
+  NrSlPsfchConfig psfchConfig;
+
+  switch (m_slPsfchPeriod)
+    {
+    case 0:
+    case 1:
+    case 2:
+    case 4:
+      psfchConfig.period = m_slPsfchPeriod;
+      break;
+    default:
+      NS_FATAL_ERROR ("Invalid PSFCH period : " << m_slPsfchPeriod << " slots");
+    }
+
+  switch (m_slMinTimeGapPsfch)
+    {
+    case 2:
+    case 3:
+      psfchConfig.minTimeGap = m_slMinTimeGapPsfch;
+      break;
+    default:
+      NS_FATAL_ERROR ("Invalid PSFCH minimum time gap : " << m_slMinTimeGapPsfch << " slots");
+    }
+
+  return psfchConfig;
+}
+
 
 } // namespace ns3
 
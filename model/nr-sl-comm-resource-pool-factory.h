@@ -22,6 +22,7 @@
 
 #include <ns3/simple-ref-count.h>
 #include <ns3/lte-rrc-sap.h>
+#include "nr-sl-phy-mac-common.h"
 #include <bitset>
 
 namespace ns3 {
@@ -141,6 +142,41 @@ public:
    *        resources that can be indicated by an SCI.
    */
   void SetSlMaxNumPerReserve (uint16_t maxNumPerReserve);
+  /**
+   * \brief Get the PSFCH period
+   *
+   * \return The period of the PSFCH resources in slots (0, 1, 2 or 4)
+   */
+  uint16_t GetSlPsfchPeriod () const;
+  /**
+   * \brief Set the PSFCH period
+   *
+   * The SL-PSFCH-Config IE is not part of LteRrcSap::SlResourcePoolNr, hence
+   * it is not included in the pool returned by CreatePool. It is retrieved
+   * with GetSlPsfchConfig, and installed with NrSlHelper::InstallNrSlPsfchConfig.
+   *
+   * \param psfchPeriod The period of the PSFCH resources in slots (0, 1, 2 or 4).
+   *        0 disables the PSFCH, and hence the HARQ feedback.
+   */
+  void SetSlPsfchPeriod (uint16_t psfchPeriod);
+  /**
+   * \brief Get the minimum time gap between a PSSCH and its PSFCH
+   *
+   * \return The minimum time gap in slots (2 or 3)
+   */
+  uint16_t GetSlMinTimeGapPsfch () const;
+  /**
+   * \brief Set the minimum time gap between a PSSCH and its PSFCH
+   *
+   * \param minTimeGap The minimum time gap in slots (2 or 3)
+   */
+  void SetSlMinTimeGapPsfch (uint16_t minTimeGap);
+  /**
+   * \brief Create the PSFCH configuration of the pool
+   *
+   * \return The PSFCH configuration
+   */
+  NrSlPsfchConfig GetSlPsfchConfig () const;
 
 private:
   LteRrcSap::SlResourcePoolNr m_pool; //!< Sidelink communication pool
@@ -162,6 +198,10 @@ protected:
   std::vector <std::bitset<1> > m_slTimeResource; //!< The sidelink time resource bitmap
   uint16_t m_slMaxNumPerReserve; //!< The maximum number of reserved PSCCH/PSSCH resources that can be indicated by an SCI.
 
+  //SlPsfchConfig
+  uint16_t m_slPsfchPeriod; //!< The period of the PSFCH resources in slots. 0 means no PSFCH
+  uint16_t m_slMinTimeGapPsfch; //!< The minimum time gap in slots between a PSSCH and the PSFCH carrying its HARQ feedback
+
 
 };
 
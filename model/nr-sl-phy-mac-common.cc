@@ -34,6 +34,33 @@ NrSlVarTtiAllocInfo::operator < (const NrSlVarTtiAllocInfo &rhs) const
   return (symStart < rhs.symStart);
 }
 
+bool
+NrSlPsfchConfig::IsEnabled () const
+{
+  return period != 0;
+}
+
+bool
+NrSlPsfchConfig::IsPsfchSlot (uint64_t absSlotIndex) const
+{
+  return IsEnabled () && absSlotIndex % period == 0;
+}
+
+uint16_t
+NrSlPsfchConfig::GetMinReTxGap () const
+{
+  //the feedback of slot n is in a slot in [n + minTimeGap, n + minTimeGap + period - 1],
+  //and it can be used from the slot after
+  return IsEnabled () ? minTimeGap + period : 0;
+}
+
+uint16_t
+NrSlPsfchConfig::GetPsfchSymStart (uint16_t symbolsPerSlot)
+{
+  //AGC and PSFCH symbols, followed by the guard symbol at the end of the slot
+  return symbolsPerSlot - PSFCH_OVERHEAD_SYMBOLS;
+}
+
 std::ostream &operator<< (std::ostream &os, const NrSlSlotAlloc& p)
 {
   os << "SfnSf: " << p.sfn
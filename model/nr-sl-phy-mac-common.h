@@ -46,6 +46,59 @@ struct NrSlInfoListElement_s
   {
     ACK, NACK, INVALID
   } m_harqStatus {INVALID}; //!< HARQ status
+  uint16_t txRnti {std::numeric_limits <uint16_t>::max ()}; //!< RNTI of the UE that transmitted the PSSCH
+  uint16_t rxRnti {std::numeric_limits <uint16_t>::max ()}; //!< RNTI of the UE that sends the feedback
+  SfnSf psschSfn {}; //!< The slot of the PSSCH the feedback refers to
+};
+
+/**
+ * \ingroup utils
+ * \brief PSFCH configuration of a sidelink resource pool
+ *
+ * It holds the parameters sl-PSFCH-Period and sl-MinTimeGapPSFCH of the
+ * SL-PSFCH-Config IE (TS 38.331), and implements the slot mapping of
+ * TS 38.213 Sec. 16.3: the HARQ feedback of a PSSCH received in slot n is
+ * transmitted in the first slot with PSFCH resources that is at least
+ * minTimeGap slots after n. In a slot with PSFCH resources, the PSFCH
+ * occupies the symbols GetPsfchSymStart () and the next one (the first being
+ * the AGC repetition), and the PSSCH loses PSFCH_OVERHEAD_SYMBOLS symbols
+ * (the two PSFCH symbols and the guard symbol before them).
+ *
+ * For simplicity, the period and the gap are counted in physical slots,
+ * which is the same as the logical slots of the pool only if every slot
+ * belongs to the pool. A PSFCH slot is anyway always a sidelink slot.
+ */
+struct NrSlPsfchConfig
+{
+  static const uint16_t PSFCH_OVERHEAD_SYMBOLS = 3; //!< PSSCH symbols lost in a slot with PSFCH resources
+
+  uint16_t period {0}; //!< sl-PSFCH-Period in slots (0, 1, 2 or 4). 0 means that the pool has no PSFCH resources
+  uint16_t minTimeGap {2}; //!< sl-MinTimeGapPSFCH in slots (2 or 3)
+
+  /**
+   * \brief Does the pool have PSFCH resources?
+   * \return true if the PSFCH period is not zero
+   */
+  bool IsEnabled () const;
+  /**
+   * \brief Does the slot have PSFCH resources?
+   * \param absSlotIndex The absolute slot index (see SfnSf::Normalize)
+   * \return true if the PSFCH is configured and the slot is a multiple of its period
+   */
+  bool IsPsfchSlot (uint64_t absSlotIndex) const;
+  /**
+   * \brief Get the minimum gap between two transmissions of a TB which
+   *        allows the feedback of the first one to reach the transmitter
+   *        before the second one
+   * \return The gap in slots, 0 if the PSFCH is not configured
+   */
+  uint16_t GetMinReTxGap () const;
+  /**
+   * \brief Get the first symbol of the PSFCH (its AGC repetition)
+   * \param symbolsPerSlot The number of symbols per slot
+   * \return The index of the first PSFCH symbol
+   */
+  static uint16_t GetPsfchSymStart (uint16_t symbolsPerSlot);
 };
 
 /**
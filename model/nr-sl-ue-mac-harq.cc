@@ -82,6 +82,8 @@ NrSlUeMacHarq::AssignNrSlHarqProcessId (uint8_t harqId, uint32_t dstL2Id)
   //set the given destination in m_nrSlHarqPktBuffer at the index equal to
   //harqId, to reserve it
   m_nrSlHarqPktBuffer.at (harqId).dstL2Id = dstL2Id;
+  m_nrSlHarqPktBuffer.at (harqId).ackedRxRntis.clear ();
+  m_nrSlHarqPktBuffer.at (harqId).harqStatus = NrSlInfoListElement_s::INVALID;
   return harqId;
 }
 
@@ -145,6 +147,87 @@ NrSlUeMacHarq::RecvNrSlHarqFeedback (uint32_t dstL2Id, uint8_t harqId)
   m_nrSlHarqPktBuffer.at (harqId).pktBurst = pb;
   m_nrSlHarqPktBuffer.at (harqId).lcidList.clear ();
   m_nrSlHarqPktBuffer.at (harqId).dstL2Id = std::numeric_limits <uint32_t>::max ();
+  m_nrSlHarqPktBuffer.at (harqId).psfchSlot = std::numeric_limits <uint64_t>::max ();
+  m_nrSlHarqPktBuffer.at (harqId).ackedRxRntis.clear ();
+  m_nrSlHarqPktBuffer.at (harqId).harqStatus = NrSlInfoListElement_s::INVALID;
+}
+
+void
+NrSlUeMacHarq::RecordNrSlTx (uint32_t dstL2Id, uint8_t harqId, const SfnSf &sfn,
+                             uint16_t numReceivers, uint64_t psfchSlot)
+{
+  NS_LOG_FUNCTION (this << dstL2Id << +harqId << sfn << numReceivers << psfchSlot);
+  NS_ABORT_MSG_IF (m_nrSlHarqPktBuffer.at (harqId).dstL2Id != dstL2Id, "the HARQ id " << +harqId << " does not belongs to the destination " << dstL2Id);
+  NrSlProcessInfo &process = m_nrSlHarqPktBuffer.at (harqId);
+  process.lastTxSfn = sfn;
+  process.psfchSlot = psfchSlot;
+  process.numReceivers = numReceivers;
+  process.ackedRxRntis.clear ();
+  process.harqStatus = NrSlInfoListElement_s::INVALID;
+}
+
+void
+NrSlUeMacHarq::StoreNrSlHarqFeedback (const NrSlInfoListElement_s &feedback)
+{
+  NS_LOG_FUNCTION (this << feedback.dstL2Id << +feedback.harqProcessId);
+  if (feedback.harqProcessId >= m_nrSlHarqPktBuffer.size ())
+    {
+      NS_LOG_DEBUG ("Ignoring the feedback for the unknown HARQ id " << +feedback.harqProcessId);
+      return;
+    }
+  NrSlProcessInfo &process = m_nrSlHarqPktBuffer.at (feedback.harqProcessId);
+  if (process.dstL2Id != feedback.dstL2Id || !(process.lastTxSfn == feedback.psschSfn))
+    {
+      //the process has been released, or it has been retransmitted (or
+      //reused) before the feedback arrived
+      NS_LOG_DEBUG ("Ignoring the outdated feedback for HARQ id " << +feedback.harqProcessId
+                    << " of the PSSCH in " << feedback.psschSfn);
+      return;
+    }
+  if (feedback.m_harqStatus == NrSlInfoListElement_s::NACK)
+    {
+      process.harqStatus = NrSlInfoListElement_s::NACK;
+    }
+  else if (feedback.m_harqStatus == NrSlInfoListElement_s::ACK
+           && process.harqStatus != NrSlInfoListElement_s::NACK)
+    {
+      //for groupcast, the TB is acknowledged only when all the members
+      //acknowledged it. With an unknown group size, it never is.
+      process.ackedRxRntis.insert (feedback.rxRnti);
+      if (process.numReceivers > 0 && process.ackedRxRntis.size () >= process.numReceivers)
+        {
+          process.harqStatus = NrSlInfoListElement_s::ACK;
+        }
+    }
+  NS_LOG_INFO ("HARQ id " << +feedback.harqProcessId << " dst " << feedback.dstL2Id
+               << " feedback from RNTI " << feedback.rxRnti << ", "
+               << process.ackedRxRntis.size () << " ACK(s) out of " << process.numReceivers
+               << (process.harqStatus == NrSlInfoListElement_s::NACK ? ", NACK" : ""));
+}
+
+bool
+NrSlUeMacHarq::IsNrSlTbAcked (uint32_t dstL2Id, uint8_t harqId) const
+{
+  NS_ABORT_MSG_IF (m_nrSlHarqPktBuffer.at (harqId).dstL2Id != dstL2Id, "the HARQ id " << +harqId << " does not belongs to the destination " << dstL2Id);
+  return m_nrSlHarqPktBuffer.at (harqId).harqStatus == NrSlInfoListElement_s::ACK;
+}
+
+NrSlInfoListElement_s::HarqStatus_e
+NrSlUeMacHarq::GetNrSlHarqStatus (uint32_t dstL2Id, uint8_t harqId, uint64_t currentSlot) const
+{
+  NS_ABORT_MSG_IF (m_nrSlHarqPktBuffer.at (harqId).dstL2Id != dstL2Id, "the HARQ id " << +harqId << " does not belongs to the destination " << dstL2Id);
+  const NrSlProcessInfo &process = m_nrSlHarqPktBuffer.at (harqId);
+  if (process.harqStatus != NrSlInfoListElement_s::INVALID)
+    {
+      return process.harqStatus;
+    }
+  //the feedback of the PSFCH occasion is received at the end of its slot:
+  //after that, a missing feedback (DTX) is a NACK
+  if (process.psfchSlot != std::numeric_limits <uint64_t>::max () && currentSlot > process.psfchSlot)
+    {
+      return NrSlInfoListElement_s::NACK;
+    }
+  return NrSlInfoListElement_s::INVALID;
 }
 
 Ptr<PacketBurst>
@@ -22,6 +22,7 @@
 
 
 #include <ns3/object.h>
+#include "nr-sl-phy-mac-common.h"
 
 #include <map>
 #include <unordered_set>
@@ -134,6 +135,65 @@ public:
    */
   void RecvNrSlHarqFeedback (uint32_t dstL2Id, uint8_t harqId);
 
+  /**
+   * \brief Record a (re)transmission of the TB of a Sidelink process
+   *
+   * The HARQ feedback received so far for the process is discarded, and
+   * only the feedback for the PSSCH transmitted in \p sfn is accepted from
+   * now on (see StoreNrSlHarqFeedback).
+   *
+   * \param dstL2Id The destination Layer 2 id
+   * \param harqId The HARQ process id
+   * \param sfn The slot of the transmission
+   * \param numReceivers The number of receivers expected to send feedback:
+   *        1 for unicast, the number of members of the group (transmitter
+   *        excluded) for groupcast, 0 if unknown
+   * \param psfchSlot The absolute slot of the PSFCH occasion that carries
+   *        the feedback of this transmission
+   */
+  void RecordNrSlTx (uint32_t dstL2Id, uint8_t harqId, const SfnSf &sfn,
+                     uint16_t numReceivers = 1,
+                     uint64_t psfchSlot = std::numeric_limits<uint64_t>::max ());
+
+  /**
+   * \brief Store the HARQ feedback received over the PSFCH
+   *
+   * The feedback is ignored if the process does not belong to the destination
+   * anymore, or if it refers to a transmission other than the last one. For
+   * groupcast, each member sends its own feedback (identified by
+   * NrSlInfoListElement_s::rxRnti): a single NACK is enough to make the TB
+   * not acknowledged, and the TB is acknowledged only once all the expected
+   * receivers (see RecordNrSlTx) sent an ACK.
+   *
+   * \param feedback The HARQ feedback
+   */
+  void StoreNrSlHarqFeedback (const NrSlInfoListElement_s &feedback);
+
+  /**
+   * \brief Has the last transmission of the TB been acknowledged?
+   * \param dstL2Id The destination Layer 2 id
+   * \param harqId The HARQ process id
+   * \return true if all the expected receivers sent an ACK, and no NACK has
+   *         been received, for the last transmission of the TB
+   */
+  bool IsNrSlTbAcked (uint32_t dstL2Id, uint8_t harqId) const;
+
+  /**
+   * \brief Get the HARQ status of the last transmission of the TB
+   *
+   * Once the PSFCH occasion of the last transmission has passed, the
+   * receivers that did not send any feedback (DTX) are considered as NACK.
+   *
+   * \param dstL2Id The destination Layer 2 id
+   * \param harqId The HARQ process id
+   * \param currentSlot The current absolute slot
+   * \return ACK if the TB has been acknowledged, NACK if a receiver sent a
+   *         NACK or did not send its feedback in the PSFCH occasion, INVALID
+   *         if the feedback of some receivers may still arrive
+   */
+  NrSlInfoListElement_s::HarqStatus_e GetNrSlHarqStatus (uint32_t dstL2Id, uint8_t harqId,
+                                                         uint64_t currentSlot) const;
+
 
 protected:
   /**
@@ -152,6 +212,11 @@ private:
     // used to signal HARQ failure to RLC handlers
     std::unordered_set<uint8_t> lcidList; //!< LC id container
     uint32_t dstL2Id {std::numeric_limits <uint32_t>::max ()};//!< Destination L2 id
+    SfnSf lastTxSfn {}; //!< The slot of the last transmission of the TB
+    uint64_t psfchSlot {std::numeric_limits <uint64_t>::max ()}; //!< The absolute slot of the PSFCH occasion of the last transmission
+    uint16_t numReceivers {1}; //!< The receivers expected to send feedback for the last transmission, 0 if unknown
+    std::unordered_set<uint16_t> ackedRxRntis; //!< The receivers that sent an ACK for the last transmission
+    NrSlInfoListElement_s::HarqStatus_e harqStatus {NrSlInfoListElement_s::INVALID}; //!< The feedback for the last transmission, INVALID if none
   };
 
   std::vector <NrSlProcessInfo> m_nrSlHarqPktBuffer; //!< NR SL HARQ packet buffer
@@ -166,6 +166,13 @@ public:
    * \param isSidelinkSlot Whether the slot is a sidelink slot
    */
   virtual void SlotIndication (SfnSf sfn, bool isSidelinkSlot) = 0;
+  /**
+   * \brief Send the NR Sidelink HARQ feedback received over the PSFCH from
+   *        UE MAC to the UE scheduler
+   *
+   * \param feedback The HARQ feedback of a PSSCH transmission of this UE
+   */
+  virtual void SchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback) = 0;
 };
 
 /**
@@ -225,6 +232,19 @@ public:
    */
   virtual uint8_t GetSlMaxTxTransNumPssch () const = 0;
 
+  /**
+   * \brief Method to get the minimum gap between two transmissions of a TB
+   *
+   * When the retransmissions of a LC are driven by the HARQ feedback, the
+   * transmissions of a TB must be spaced so that the feedback of each one
+   * reaches the UE before the next one.
+   *
+   * \param dstL2Id The destination layer 2 id
+   * \param lcId The logical channel id
+   * \return The minimum gap in slots, 0 if the retransmissions are blind
+   */
+  virtual uint16_t GetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const = 0;
+
 };
 
 /**
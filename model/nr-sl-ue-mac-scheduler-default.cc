@@ -18,11 +18,13 @@
  */
 
 #include "nr-sl-ue-mac-scheduler-default.h"
+#include "nr-sl-candidate-resource-set.h"
 
 #include <ns3/log.h>
 #include <ns3/boolean.h>
 #include <ns3/uinteger.h>
 #include <ns3/pointer.h>
+#include <algorithm>
 
 
 namespace ns3 {
@@ -232,18 +234,24 @@ NrSlUeMacSchedulerDefault::DoSchedUeNrSlTriggerReq (const SfnSf& sfn, uint32_t d
 
   const auto & lcgMap = itDstInfo->second->GetNrSlLCG (); //Map of unique_ptr should not copy
 
-  NS_ASSERT_MSG (lcgMap.size () == 1, "NrSlUeMacSchedulerDefault can handle only one LCG");
-
-  std::vector<uint8_t> lcVector = lcgMap.begin ()->second->GetLCId ();
-  NS_ASSERT_MSG (lcVector.size () == 1, "NrSlUeMacSchedulerDefault can handle only one LC");
-
-  uint32_t bufferSize = lcgMap.begin ()->second->GetTotalSizeOfLC (lcVector.at (0));
+  //The buffer of all the LCs of the destination. It is up to DoNrSlAllocation
+  //to decide which of them are served
+  uint32_t bufferSize = 0;
+  for (const auto &itLcg : lcgMap)
+    {
+      bufferSize += itLcg.second->GetTotalSize ();
+    }
 
   // Determine if any grants need to be created or refreshed
   const auto itGrantInfo = m_grantInfo.find (dstL2Id);
   bool foundDest = itGrantInfo != m_grantInfo.end () ? true : false;
 
-  if (!foundDest && bufferSize && !ids.empty ())
+  //The HARQ process id of a grant is assigned by the MAC only when the grant
+  //is published, so the ids of the grants of the other destinations, which
+  //are not published yet, are still in the list of the available ids
+  std::deque<uint8_t> freeIds = FilterReservedHarqIds (ids);
+
+  if (!foundDest && bufferSize && !freeIds.empty ())
     {
       auto filteredReso = FilterTxOpportunities (availableReso);
       if (!filteredReso.empty ())
@@ -252,7 +260,7 @@ NrSlUeMacSchedulerDefault::DoSchedUeNrSlTriggerReq (const SfnSf& sfn, uint32_t d
           NS_LOG_INFO ("Scheduling the destination " << dstL2Id);
           m_reselCounter = GetRandomReselectionCounter ();
           m_cResel = m_reselCounter * 10;
-          AttemptGrantAllocation (dstL2Id, filteredReso, ids);
+          AttemptGrantAllocation (dstL2Id, filteredReso, freeIds);
           m_reselCounter = 0;
           m_cResel = 0;
         }
@@ -335,6 +343,26 @@ NrSlUeMacSchedulerDefault::DoSchedUeNrSlTriggerReq (const SfnSf& sfn, uint32_t d
   CheckForGrantsToPublish (sfn);
 }
 
+std::deque<uint8_t>
+NrSlUeMacSchedulerDefault::FilterReservedHarqIds (const std::deque<uint8_t>& ids) const
+{
+  NS_LOG_FUNCTION (this);
+  std::deque<uint8_t> freeIds;
+  for (const auto &itId : ids)
+    {
+      bool reserved = std::any_of (m_grantInfo.begin (), m_grantInfo.end (),
+                                   [itId] (const std::pair<const uint32_t, NrSlUeMacSchedSapUser::NrSlGrantInfo> &grantInfo)
+                                   {
+                                     return grantInfo.second.nrSlHarqId == itId;
+                                   });
+      if (!reserved)
+        {
+          freeIds.push_back (itId);
+        }
+    }
+  return freeIds;
+}
+
 void
 NrSlUeMacSchedulerDefault::AttemptGrantAllocation (uint32_t dstL2Id, const std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>& params, const std::deque<uint8_t>& ids)
 {
@@ -510,6 +538,13 @@ NrSlUeMacSchedulerDefault::FilterTxOpportunities (std::list <NrSlUeMacSchedSapPr
   return txOppr;
 }
 
+void
+NrSlUeMacSchedulerDefault::DoSchedUeNrSlHarqFeedbackInd ([[maybe_unused]] const NrSlInfoListElement_s& feedback)
+{
+  NS_LOG_FUNCTION (this << feedback.dstL2Id << +feedback.harqProcessId);
+  //The MCS of this scheduler does not depend on the feedback
+}
+
 // XXX the below is a candidate for removal
 void
 NrSlUeMacSchedulerDefault::DoSlotIndication (SfnSf sfn, bool isSidelinkSlot)
@@ -533,6 +568,12 @@ NrSlUeMacSchedulerDefault::GetSlMaxTxTransNumPssch () const
   return m_nrSlUeMacSchedSapUser->GetSlMaxTxTransNumPssch ();
 }
 
+uint16_t
+NrSlUeMacSchedulerDefault::GetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const
+{
+  return m_nrSlUeMacSchedSapUser->GetSlMinReTxGap (dstL2Id, lcId);
+}
+
 
 void
 NrSlUeMacSchedulerDefault::InstallNrSlAmc (const Ptr<NrAmc> &nrSlAmc)
@@ -642,11 +683,19 @@ NrSlUeMacSchedulerDefault::DoNrSlAllocation (const std::list <NrSlUeMacSchedSapP
 
 
   std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> selectedTxOpps;
-  selectedTxOpps = RandomlySelectSlots (txOpps);
+  selectedTxOpps = RandomlySelectSlots (txOpps, GetSlMinReTxGap (dstInfo->GetDstL2Id (), lcVector.at (0)));
   NS_ASSERT_MSG (selectedTxOpps.size () > 0, "Scheduler should select at least 1 slot from txOpps");
   uint32_t tbs = 0;
   uint8_t assignedSbCh = 0;
-  uint16_t availableSymbols = selectedTxOpps.begin ()->slPsschSymLength;
+  //All the transmissions of the TB use the same number of symbols, hence
+  //we take the minimum among the selected slots, e.g., a slot with
+  //PSFCH resources has less symbols for PSSCH
+  uint16_t availableSymbols = std::min_element (selectedTxOpps.begin (), selectedTxOpps.end (),
+                                                [] (const NrSlUeMacSchedSapProvider::NrSlSlotInfo &a,
+                                                    const NrSlUeMacSchedSapProvider::NrSlSlotInfo &b)
+                                                {
+                                                  return a.slPsschSymLength < b.slPsschSymLength;
+                                                })->slPsschSymLength;
   uint16_t sbChSize = selectedTxOpps.begin ()->slSubchannelSize;
   NS_LOG_DEBUG ("Total available symbols for PSSCH = " << availableSymbols);
   //find the minimum available number of contiguous sub-channels in the
@@ -670,6 +719,29 @@ NrSlUeMacSchedulerDefault::DoNrSlAllocation (const std::list <NrSlUeMacSchedSapP
 
   allocated = true;
 
+  NrSlSlotAlloc tbAlloc;
+  tbAlloc.dstL2Id = dstInfo->GetDstL2Id ();
+  tbAlloc.lcId = lcVector.at (0);
+  tbAlloc.priority = lcgMap.begin ()->second->GetLcPriority (lcVector.at (0));
+  tbAlloc.slRlcPduInfo.push_back (SlRlcPduInfo (lcVector.at (0), tbs));
+  tbAlloc.mcs = dstInfo->GetDstMcs ();
+  CreateSlotAllocations (tbAlloc, selectedTxOpps, startSubChIndexPerSlot,
+                         assignedSbCh, availableSymbols, slotAllocList);
+
+  lcgMap.begin ()->second->AssignedData (lcVector.at (0), tbs);
+  return allocated;
+}
+
+
+void
+NrSlUeMacSchedulerDefault::CreateSlotAllocations (const NrSlSlotAlloc &tbAlloc,
+                                                  const std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>& selectedTxOpps,
+                                                  const std::vector <uint8_t> &startSubChIndexPerSlot,
+                                                  uint8_t assignedSbCh, uint16_t availableSymbols,
+                                                  std::set<NrSlSlotAlloc> &slotAllocList) const
+{
+  NS_LOG_FUNCTION (this << tbAlloc.dstL2Id << +assignedSbCh << availableSymbols);
+
   auto itsbChIndexPerSlot = startSubChIndexPerSlot.cbegin ();
   auto itTxOpps = selectedTxOpps.cbegin ();
 
@@ -677,12 +749,11 @@ NrSlUeMacSchedulerDefault::DoNrSlAllocation (const std::list <NrSlUeMacSchedSapP
     {
       NrSlSlotAlloc slotAlloc;
       slotAlloc.sfn = itTxOpps->sfn;
-      slotAlloc.dstL2Id = dstInfo->GetDstL2Id ();
-      slotAlloc.lcId = lcVector.at (0);
-      slotAlloc.priority = lcgMap.begin ()->second->GetLcPriority (lcVector.at (0));
-      SlRlcPduInfo slRlcPduInfo (lcVector.at (0), tbs);
-      slotAlloc.slRlcPduInfo.push_back (slRlcPduInfo);
-      slotAlloc.mcs = dstInfo->GetDstMcs ();
+      slotAlloc.dstL2Id = tbAlloc.dstL2Id;
+      slotAlloc.lcId = tbAlloc.lcId;
+      slotAlloc.priority = tbAlloc.priority;
+      slotAlloc.slRlcPduInfo = tbAlloc.slRlcPduInfo;
+      slotAlloc.mcs = tbAlloc.mcs;
       //PSCCH
       slotAlloc.numSlPscchRbs = itTxOpps->numSlPscchRbs;
       slotAlloc.slPscchSymStart = itTxOpps->slPscchSymStart;
@@ -716,36 +787,58 @@ NrSlUeMacSchedulerDefault::DoNrSlAllocation (const std::list <NrSlUeMacSchedSapP
 
       slotAllocList.emplace (slotAlloc);
     }
-
-  lcgMap.begin ()->second->AssignedData (lcVector.at (0), tbs);
-  return allocated;
 }
 
-
 std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>
-NrSlUeMacSchedulerDefault::RandomlySelectSlots (std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> txOpps)
+NrSlUeMacSchedulerDefault::RandomlySelectSlots (std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> txOpps, uint16_t minGap)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << minGap);
 
   uint8_t totalTx = GetSlMaxTxTransNumPssch ();
   std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> newTxOpps;
 
-  if (txOpps.size () > totalTx)
+  if (minGap == 0 && txOpps.size () <= totalTx)
     {
-      while (newTxOpps.size () != totalTx)
-        {
-          auto txOppsIt = txOpps.begin ();
-          // Walk through list until the random element is reached
-          std::advance (txOppsIt, m_uniformVariable->GetInteger (0, txOpps.size () - 1));
-          //copy the randomly selected slot info into the new list
-          newTxOpps.emplace_back (*txOppsIt);
-          //erase the selected one from the list
-          txOppsIt = txOpps.erase (txOppsIt);
-        }
+      newTxOpps = txOpps;
     }
   else
     {
-      newTxOpps = txOpps;
+      //The slots still available are the candidates of a bitmap, so that the
+      //n-th one is found without walking the list, and the ones too close to
+      //a selected slot are excluded with a range of bits
+      txOpps.sort ();
+      std::vector <NrSlUeMacSchedSapProvider::NrSlSlotInfo> slots (txOpps.begin (), txOpps.end ());
+      std::vector<uint64_t> absSlots;
+      absSlots.reserve (slots.size ());
+      for (const auto &it : slots)
+        {
+          absSlots.push_back (it.sfn.Normalize ());
+        }
+      NrSlCandidateResourceSet available (slots.size (), GetTotalSubCh ());
+      uint32_t numAvailable = slots.size ();
+      while (newTxOpps.size () != totalTx && numAvailable > 0)
+        {
+          uint32_t selected = available.Select (m_uniformVariable->GetInteger (0, numAvailable - 1));
+          //copy the randomly selected slot info into the new list
+          newTxOpps.emplace_back (slots.at (selected));
+          if (minGap > 0)
+            {
+              //erase the selected one and the ones too close to it to leave
+              //the time to receive the feedback
+              uint64_t first = absSlots.at (selected) >= minGap ? absSlots.at (selected) - minGap + 1 : 0;
+              uint64_t last = absSlots.at (selected) + minGap - 1;
+              uint32_t firstIndex = std::lower_bound (absSlots.begin (), absSlots.end (), first) - absSlots.begin ();
+              uint32_t lastIndex = std::upper_bound (absSlots.begin (), absSlots.end (), last) - absSlots.begin () - 1;
+              available.ExcludeRange (firstIndex, lastIndex);
+              numAvailable = available.GetNumCandidates ();
+            }
+          else
+            {
+              //erase the selected one from the bitmap
+              available.Exclude (selected);
+              numAvailable--;
+            }
+        }
     }
   //sort the list by SfnSf before returning
   newTxOpps.sort ();
@@ -145,6 +145,15 @@ public:
    */
   void DoSlotIndication (SfnSf sfn, bool isSidelinkSlot);
 
+  /**
+   * \brief Receive the HARQ feedback of a PSSCH transmission from UE MAC
+   *
+   * This scheduler uses a fixed MCS, hence it ignores the feedback.
+   *
+   * \param feedback The HARQ feedback received over the PSFCH
+   */
+  virtual void DoSchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback) override;
+
   /**
    * \brief Install the AMC for the NR Sidelink
    *
@@ -263,49 +272,19 @@ protected:
    */
   uint8_t GetSlMaxTxTransNumPssch () const;
 
-  Ptr<UniformRandomVariable> m_uniformVariable; //!< Uniform random variable
-
-private:
   /**
-   * \brief Create destination info
+   * \brief Method to get the minimum gap, in slots, between two
+   *        transmissions of the same TB of a LC.
    *
-   * If the scheduler does not have the destination info then it creates it,
-   * and then save its pointer in the m_dstMap map.
+   * It is non-zero only when the retransmissions are triggered by the PSFCH
+   * feedback, so that the feedback of a transmission can be received before
+   * the next one.
    *
-   * If the scheduler already have the destination info, it does noting. This
-   * could happen when we are trying add more than one logical channels
-   * for a destination.
-   *
-   * \param params params of the UE
-   * \return A std::shared_ptr to newly created NrSlUeMacSchedulerDstInfo
-   */
-  std::shared_ptr<NrSlUeMacSchedulerDstInfo>
-  CreateDstInfo (const NrSlUeMacCschedSapProvider::SidelinkLogicalChannelInfo& params);
-
-  /**
-   * \brief Create a NR Sidelink logical channel group
-   *
-   * A subclass can return its own representation of a logical channel by
-   * implementing a proper subclass of NrSlUeMacSchedulerLCG and returning a
-   * pointer to a newly created instance.
-   *
-   * \param lcGroup The logical channel group id
-   * \return a pointer to the representation of a logical channel group
-   */
-  NrSlLCGPtr CreateLCG (uint8_t lcGroup) const;
-
-  /**
-   * \brief Create a NR Sidelink logical channel
-   *
-   * A subclass can return its own representation of a logical channel by
-   * implementing a proper subclass of NrSlUeMacSchedulerLC and returning a
-   * pointer to a newly created instance.
-   *
-   * \param params configuration of the logical channel
-   * \return a pointer to the representation of a logical channel
+   * \param dstL2Id The destination layer 2 id
+   * \param lcId The logical channel id
+   * \return The minimum gap in slots
    */
-
-  NrSlLCPtr CreateLC (const NrSlUeMacCschedSapProvider::SidelinkLogicalChannelInfo& params) const;
+  uint16_t GetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const;
 
   /**
    * \ingroup scheduler
@@ -316,14 +295,6 @@ private:
     uint8_t numSubCh {0}; //!< The minimum number of contiguous subchannels that could be used for each slot.
     std::vector <std::vector<uint8_t>> availSbChIndPerSlot; //!< The vector containing the available subchannel index for each slot
   };
-  /**
-   * \brief Select the slots randomly from the available slots
-   *
-   * \param txOpps The list of the available TX opportunities
-   * \return the set containing the indices of the randomly chosen slots in the
-   *         txOpps list
-   */
-  std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>
   /**
    * \brief Randomly select the number of slots from the slots given by UE MAC
    *
@@ -334,10 +305,15 @@ private:
    * otherwise;
    * N_Selected = K
    *
+   * If minGap is not zero, two selected slots are at least minGap slots apart,
+   * hence N_Selected can be lower than both N_PSSCH_maxTx and K.
+   *
    * \param txOpps The list of the available slots
+   * \param minGap The minimum gap, in slots, between two selected slots
    * \return The list of randomly selected slots
    */
-  RandomlySelectSlots (std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> txOpps);
+  std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>
+  RandomlySelectSlots (std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> txOpps, uint16_t minGap = 0);
   /**
    * \brief Get available subchannel information
    *
@@ -364,6 +340,79 @@ private:
    */
   std::vector <uint8_t> RandSelSbChStart (SbChInfo sbChInfo, uint8_t assignedSbCh);
 
+  /**
+   * \brief Create the slot allocations of a TB
+   *
+   * Each selected slot gets the TB fields of tbAlloc (destination, LC,
+   * priority, RLC PDU info and MCS), its PSCCH/PSSCH resources, and the NDI,
+   * RV and SCI 1-A fields given its transmission index.
+   *
+   * \param tbAlloc The slot allocation carrying the TB fields
+   * \param selectedTxOpps The selected slots
+   * \param startSubChIndexPerSlot The starting subchannel index of each slot
+   * \param assignedSbCh The number of assigned subchannels
+   * \param availableSymbols The number of PSSCH symbols
+   * \param slotAllocList The slot allocation list to be updated
+   */
+  void CreateSlotAllocations (const NrSlSlotAlloc &tbAlloc,
+                              const std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>& selectedTxOpps,
+                              const std::vector <uint8_t> &startSubChIndexPerSlot,
+                              uint8_t assignedSbCh, uint16_t availableSymbols,
+                              std::set<NrSlSlotAlloc> &slotAllocList) const;
+
+  Ptr<UniformRandomVariable> m_uniformVariable; //!< Uniform random variable
+
+private:
+  /**
+   * \brief Create destination info
+   *
+   * If the scheduler does not have the destination info then it creates it,
+   * and then save its pointer in the m_dstMap map.
+   *
+   * If the scheduler already have the destination info, it does noting. This
+   * could happen when we are trying add more than one logical channels
+   * for a destination.
+   *
+   * \param params params of the UE
+   * \return A std::shared_ptr to newly created NrSlUeMacSchedulerDstInfo
+   */
+  std::shared_ptr<NrSlUeMacSchedulerDstInfo>
+  CreateDstInfo (const NrSlUeMacCschedSapProvider::SidelinkLogicalChannelInfo& params);
+
+  /**
+   * \brief Create a NR Sidelink logical channel group
+   *
+   * A subclass can return its own representation of a logical channel by
+   * implementing a proper subclass of NrSlUeMacSchedulerLCG and returning a
+   * pointer to a newly created instance.
+   *
+   * \param lcGroup The logical channel group id
+   * \return a pointer to the representation of a logical channel group
+   */
+  NrSlLCGPtr CreateLCG (uint8_t lcGroup) const;
+
+  /**
+   * \brief Create a NR Sidelink logical channel
+   *
+   * A subclass can return its own representation of a logical channel by
+   * implementing a proper subclass of NrSlUeMacSchedulerLC and returning a
+   * pointer to a newly created instance.
+   *
+   * \param params configuration of the logical channel
+   * \return a pointer to the representation of a logical channel
+   */
+
+  NrSlLCPtr CreateLC (const NrSlUeMacCschedSapProvider::SidelinkLogicalChannelInfo& params) const;
+
+  /**
+   * \brief Remove the HARQ process ids reserved by the grants of the other
+   *        destinations from the list of available ids
+   *
+   * \param ids The HARQ process ids available at the MAC
+   * \return The ids that are not used by any grant of this scheduler
+   */
+  std::deque<uint8_t> FilterReservedHarqIds (const std::deque<uint8_t>& ids) const;
+
   /**
    * \brief Get the random selection counter
    * \return The randomly selected reselection counter
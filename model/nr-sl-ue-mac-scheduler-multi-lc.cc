@@ -0,0 +1,274 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-sl-ue-mac-scheduler-multi-lc.h"
+
+#include <ns3/log.h>
+#include <ns3/double.h>
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrSlUeMacSchedulerMultiLc");
+NS_OBJECT_ENSURE_REGISTERED (NrSlUeMacSchedulerMultiLc);
+
+/**
+ * \brief Order the LCs as in the logical channel prioritization
+ * \param a the first LC
+ * \param b the second LC
+ * \return true if a has to be served before b
+ */
+static bool
+CompareLcBytes (const NrSlUeMacSchedulerMultiLc::LcBytes &a,
+                const NrSlUeMacSchedulerMultiLc::LcBytes &b)
+{
+  if (a.priority != b.priority)
+    {
+      return a.priority < b.priority;
+    }
+  if (a.pqi != b.pqi)
+    {
+      return a.pqi < b.pqi;
+    }
+  return a.lcId < b.lcId;
+}
+
+TypeId
+NrSlUeMacSchedulerMultiLc::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrSlUeMacSchedulerMultiLc")
+    .SetParent<NrSlUeMacSchedulerDefault> ()
+    .AddConstructor<NrSlUeMacSchedulerMultiLc> ()
+    .SetGroupName ("nr")
+    .AddAttribute ("McsStepDown",
+                   "The MCS decrease of a destination after a NACK",
+                   DoubleValue (1.0),
+                   MakeDoubleAccessor (&NrSlUeMacSchedulerMultiLc::m_mcsStepDown),
+                   MakeDoubleChecker<double> (0.0))
+    .AddAttribute ("TargetBler",
+                   "The BLER targeted by the MCS adaptation",
+                   DoubleValue (0.1),
+                   MakeDoubleAccessor (&NrSlUeMacSchedulerMultiLc::m_targetBler),
+                   MakeDoubleChecker<double> (0.0, 0.5))
+  ;
+  return tid;
+}
+
+NrSlUeMacSchedulerMultiLc::NrSlUeMacSchedulerMultiLc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NrSlUeMacSchedulerMultiLc::~NrSlUeMacSchedulerMultiLc ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+void
+NrSlUeMacSchedulerMultiLc::DistributeTbBytes (uint32_t tbSize, std::vector<LcBytes> &lcs)
+{
+  std::sort (lcs.begin (), lcs.end (), CompareLcBytes);
+
+  uint32_t remaining = tbSize;
+  auto itGroup = lcs.begin ();
+  while (itGroup != lcs.end () && remaining > 0)
+    {
+      uint8_t priority = itGroup->priority;
+      auto itGroupEnd = std::find_if (itGroup, lcs.end (),
+                                      [priority] (const LcBytes &lc)
+                                      {
+                                        return lc.priority != priority;
+                                      });
+      //Share the bytes equally among the LCs of the same priority. A LC
+      //needing less than the share leaves its bytes to the others in the
+      //next round
+      while (remaining > 0)
+        {
+          uint32_t unserved = std::count_if (itGroup, itGroupEnd,
+                                             [] (const LcBytes &lc)
+                                             {
+                                               return lc.assignedBytes < lc.bufferSize;
+                                             });
+          if (unserved == 0)
+            {
+              break;
+            }
+          uint32_t share = std::max<uint32_t> (remaining / unserved, 1);
+          for (auto itLc = itGroup; itLc != itGroupEnd && remaining > 0; ++itLc)
+            {
+              uint32_t bytes = std::min ({share, itLc->bufferSize - itLc->assignedBytes, remaining});
+              itLc->assignedBytes += bytes;
+              remaining -= bytes;
+            }
+        }
+      itGroup = itGroupEnd;
+    }
+
+  //As the default scheduler does with its only LC, the bytes exceeding the
+  //buffers go to the highest priority LC
+  if (remaining > 0 && !lcs.empty ())
+    {
+      lcs.front ().assignedBytes += remaining;
+    }
+}
+
+void
+NrSlUeMacSchedulerMultiLc::DoSchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback)
+{
+  NS_LOG_FUNCTION (this << feedback.dstL2Id << +feedback.harqProcessId);
+
+  if (feedback.m_harqStatus == NrSlInfoListElement_s::INVALID)
+    {
+      return;
+    }
+
+  auto it = m_mcsEstimate.find (feedback.dstL2Id);
+  if (it == m_mcsEstimate.end ())
+    {
+      it = m_mcsEstimate.emplace (feedback.dstL2Id, GetInitialNrSlMcs ()).first;
+    }
+
+  if (feedback.m_harqStatus == NrSlInfoListElement_s::ACK)
+    {
+      it->second += m_mcsStepDown * m_targetBler / (1.0 - m_targetBler);
+    }
+  else
+    {
+      it->second -= m_mcsStepDown;
+    }
+  it->second = std::max (0.0, std::min (it->second, static_cast<double> (GetNrSlAmc ()->GetMaxMcs ())));
+  NS_LOG_DEBUG ("MCS estimate of destination " << feedback.dstL2Id << " = " << it->second);
+}
+
+uint8_t
+NrSlUeMacSchedulerMultiLc::GetDstMcs (uint32_t dstL2Id) const
+{
+  const auto it = m_mcsEstimate.find (dstL2Id);
+  if (IsNrSlMcsFixed () || it == m_mcsEstimate.end ())
+    {
+      return GetInitialNrSlMcs ();
+    }
+  return static_cast<uint8_t> (std::floor (it->second));
+}
+
+bool
+NrSlUeMacSchedulerMultiLc::DoNrSlAllocation (const std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>& txOpps,
+                                             const std::shared_ptr<NrSlUeMacSchedulerDstInfo> &dstInfo,
+                                             std::set<NrSlSlotAlloc> &slotAllocList)
+{
+  NS_LOG_FUNCTION (this << dstInfo->GetDstL2Id ());
+  NS_ASSERT_MSG (txOpps.size () > 0, "Scheduler received an empty txOpps list from UE MAC");
+  const auto & lcgMap = dstInfo->GetNrSlLCG (); //Map of unique_ptr should not copy
+
+  std::vector<LcBytes> lcs;
+  uint32_t bufferSize = 0;
+  for (const auto &itLcg : lcgMap)
+    {
+      for (const auto &lcId : itLcg.second->GetLCId ())
+        {
+          LcBytes lc;
+          lc.lcId = lcId;
+          lc.bufferSize = itLcg.second->GetTotalSizeOfLC (lcId);
+          if (lc.bufferSize == 0)
+            {
+              continue;
+            }
+          lc.priority = itLcg.second->GetLcPriority (lcId);
+          lc.pqi = itLcg.second->GetLcPqi (lcId);
+          bufferSize += lc.bufferSize;
+          lcs.push_back (lc);
+        }
+    }
+
+  if (lcs.empty ())
+    {
+      return false;
+    }
+  std::sort (lcs.begin (), lcs.end (), CompareLcBytes);
+
+  uint8_t mcs = GetDstMcs (dstInfo->GetDstL2Id ());
+  dstInfo->SetDstMcs (mcs);
+
+  //The gap between the transmissions follows the highest priority LC, which
+  //also decides the HARQ feedback mode of the TB in UE MAC
+  std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> selectedTxOpps;
+  selectedTxOpps = RandomlySelectSlots (txOpps, GetSlMinReTxGap (dstInfo->GetDstL2Id (), lcs.front ().lcId));
+  NS_ASSERT_MSG (selectedTxOpps.size () > 0, "Scheduler should select at least 1 slot from txOpps");
+  uint16_t availableSymbols = std::min_element (selectedTxOpps.begin (), selectedTxOpps.end (),
+                                                [] (const NrSlUeMacSchedSapProvider::NrSlSlotInfo &a,
+                                                    const NrSlUeMacSchedSapProvider::NrSlSlotInfo &b)
+                                                {
+                                                  return a.slPsschSymLength < b.slPsschSymLength;
+                                                })->slPsschSymLength;
+  uint16_t sbChSize = selectedTxOpps.begin ()->slSubchannelSize;
+  auto sbChInfo = GetAvailSbChInfo (selectedTxOpps);
+  NS_ABORT_MSG_IF (sbChInfo.availSbChIndPerSlot.size () != selectedTxOpps.size (), "subChInfo vector does not have info for all the selected slots");
+
+  uint32_t tbs = 0;
+  uint8_t assignedSbCh = 0;
+  do
+    {
+      assignedSbCh++;
+      tbs = GetNrSlAmc ()->CalculateTbSize (mcs, sbChSize * assignedSbCh * availableSymbols);
+    }
+  while (tbs < bufferSize + 5 /*(5 bytes overhead of SCI format 2A)*/ && (sbChInfo.numSubCh - assignedSbCh) > 0);
+
+  if (tbs <= 5)
+    {
+      NS_LOG_DEBUG ("TB of " << tbs << " bytes with MCS " << +mcs << " cannot carry the SCI format 2A");
+      return false;
+    }
+  tbs = tbs - 5 /*(5 bytes overhead of SCI stage 2)*/;
+
+  DistributeTbBytes (tbs, lcs);
+
+  NrSlSlotAlloc tbAlloc;
+  tbAlloc.dstL2Id = dstInfo->GetDstL2Id ();
+  tbAlloc.lcId = lcs.front ().lcId;
+  tbAlloc.priority = lcs.front ().priority;
+  tbAlloc.mcs = mcs;
+  for (const auto &lc : lcs)
+    {
+      if (lc.assignedBytes > 0)
+        {
+          NS_LOG_DEBUG ("LC " << +lc.lcId << " priority " << +lc.priority << " buffer " << lc.bufferSize
+                        << " assigned " << lc.assignedBytes << " bytes");
+          tbAlloc.slRlcPduInfo.push_back (SlRlcPduInfo (lc.lcId, lc.assignedBytes));
+        }
+    }
+
+  std::vector <uint8_t> startSubChIndexPerSlot = RandSelSbChStart (sbChInfo, assignedSbCh);
+  CreateSlotAllocations (tbAlloc, selectedTxOpps, startSubChIndexPerSlot,
+                         assignedSbCh, availableSymbols, slotAllocList);
+
+  for (const auto &itLcg : lcgMap)
+    {
+      for (const auto &lc : lcs)
+        {
+          if (lc.assignedBytes > 0 && itLcg.second->Contains (lc.lcId))
+            {
+              itLcg.second->AssignedData (lc.lcId, lc.assignedBytes);
+            }
+        }
+    }
+  return true;
+}
+
+} // namespace ns3
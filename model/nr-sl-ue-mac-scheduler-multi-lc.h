@@ -0,0 +1,134 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#ifndef NR_SL_UE_MAC_SCHEDULER_MULTI_LC_H
+#define NR_SL_UE_MAC_SCHEDULER_MULTI_LC_H
+
+#include "nr-sl-ue-mac-scheduler-default.h"
+#include <unordered_map>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup scheduler
+ *
+ * \brief A NR SL UE scheduler that multiplexes the LCs of a destination
+ *        in one TB, and adapts the MCS of each destination
+ *
+ * The destinations are served in the order given by UE MAC, i.e., by the
+ * priority of their highest priority LC. For each destination, the TB is
+ * sized for the buffer of all its LCs, and its bytes are distributed among
+ * the LCs following the logical channel prioritization of TS 38.321
+ * 5.22.1.4: in increasing order of priority value (ties broken by PQI),
+ * sharing the bytes equally among the LCs with the same priority.
+ *
+ * Unless the attribute FixNrSlMcs is true, the MCS of a destination is
+ * chosen with an outer loop driven by the HARQ feedback received over the
+ * PSFCH: every NACK decreases the MCS estimate by McsStepDown, and every ACK
+ * increases it by McsStepDown * TargetBler / (1 - TargetBler), so that the
+ * estimate converges to the MCS giving TargetBler. Without PSFCH feedback
+ * (e.g., blind retransmissions) the MCS stays at InitialNrSlMcs.
+ */
+class NrSlUeMacSchedulerMultiLc : public NrSlUeMacSchedulerDefault
+{
+public:
+  /**
+   * \brief GetTypeId
+   *
+   * \return The TypeId of the class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief NrSlUeMacSchedulerMultiLc default constructor
+   */
+  NrSlUeMacSchedulerMultiLc ();
+
+  /**
+   * \brief NrSlUeMacSchedulerMultiLc destructor
+   */
+  virtual ~NrSlUeMacSchedulerMultiLc ();
+
+  /**
+   * \brief The buffer of a LC and the bytes assigned to it in a TB
+   */
+  struct LcBytes
+  {
+    uint8_t lcId {0};           //!< The LC id
+    uint8_t priority {0};       //!< The LC priority, lower value means higher priority
+    uint8_t pqi {0};            //!< The PQI of the LC
+    uint32_t bufferSize {0};    //!< The buffered bytes of the LC
+    uint32_t assignedBytes {0}; //!< The bytes of the TB assigned to the LC
+  };
+
+  /**
+   * \brief Distribute the bytes of a TB among the LCs
+   *
+   * The LCs are sorted by priority and PQI, and served in that order. The
+   * bytes left for a group of LCs with the same priority are shared equally
+   * among them, without giving to a LC more than its buffer.
+   *
+   * \param tbSize The bytes of the TB available for the LCs
+   * \param lcs The LCs, sorted and updated with the assigned bytes
+   */
+  static void DistributeTbBytes (uint32_t tbSize, std::vector<LcBytes> &lcs);
+
+  /**
+   * \brief Receive the HARQ feedback of a PSSCH transmission from UE MAC
+   *
+   * It updates the MCS estimate of the destination of the feedback.
+   *
+   * \param feedback The HARQ feedback received over the PSFCH
+   */
+  virtual void DoSchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback) override;
+
+protected:
+  /**
+   * \brief Do the NR Sidelink allocation of all the LCs of a destination
+   *
+   * \param params The list of the txOpps from the UE MAC
+   * \param dstInfo The pointer to the NrSlUeMacSchedulerDstInfo of the destination
+   *        for which UE MAC asked the scheduler to allocate the resourses
+   * \param slotAllocList The slot allocation list to be updated by the scheduler
+   * \return The status of the allocation, true if the destination has been
+   *         allocated some resources; false otherwise.
+   */
+  virtual bool
+  DoNrSlAllocation (const std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>& params,
+                    const std::shared_ptr<NrSlUeMacSchedulerDstInfo> &dstInfo,
+                    std::set<NrSlSlotAlloc> &slotAllocList) override;
+
+private:
+  /**
+   * \brief Get the MCS of a destination
+   * \param dstL2Id The destination layer 2 id
+   * \return the MCS given by the outer loop, or the initial MCS if the MCS
+   *         is fixed or no feedback has been received for the destination
+   */
+  uint8_t GetDstMcs (uint32_t dstL2Id) const;
+
+  double m_mcsStepDown {1.0};  //!< The MCS decrease after a NACK
+  double m_targetBler {0.1};   //!< The target BLER of the outer loop
+  std::unordered_map<uint32_t, double> m_mcsEstimate; //!< The MCS estimate of each destination
+};
+
+} // namespace ns3
+
+#endif /* NR_SL_UE_MAC_SCHEDULER_MULTI_LC_H */
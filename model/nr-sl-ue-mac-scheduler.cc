@@ -115,6 +115,11 @@ NrSlUeMacGeneralSchedSapProvider::SlotIndication (SfnSf sfn, bool isSidelinkSlot
 {
   m_scheduler->DoSlotIndication (sfn, isSidelinkSlot);
 }
+void
+NrSlUeMacGeneralSchedSapProvider::SchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback)
+{
+  m_scheduler->DoSchedUeNrSlHarqFeedbackInd (feedback);
+}
 
 } // namespace ns3
 
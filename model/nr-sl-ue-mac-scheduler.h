@@ -112,6 +112,13 @@ public:
    * \param isSidelinkSlot Whether the slot is a sidelink slot
    */
   virtual void DoSlotIndication (SfnSf sfn, bool isSidelinkSlot) = 0;
+  /**
+   * \brief Send the NR Sidelink HARQ feedback received over the PSFCH from
+   *        UE MAC to the UE scheduler
+   *
+   * \param feedback The HARQ feedback of a PSSCH transmission of this UE
+   */
+  virtual void DoSchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback) = 0;
 
   /**
    * Assign a fixed random variable stream number to the random variables
@@ -170,6 +177,7 @@ public:
   virtual void SchedUeNrSlRlcBufferReq (const struct NrSlUeMacSchedSapProvider::SchedUeNrSlReportBufferStatusParams& params) override;
   virtual void SchedUeNrSlTriggerReq (const SfnSf& sfn, uint32_t dstL2Id, const std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>& params, const std::deque<uint8_t>& ids) override;
   virtual void SlotIndication (SfnSf sfn, bool isSidelinkSlot) override;
+  virtual void SchedUeNrSlHarqFeedbackInd (const NrSlInfoListElement_s& feedback) override;
 
 private:
   NrSlUeMacScheduler* m_scheduler {nullptr}; //!< pointer to the scheduler API using this SAP
@@ -124,6 +124,12 @@ public:
    * \param sensingData The sensing data
    */
   virtual void ReceiveSensingData (SensingData sensingData) = 0;
+  /**
+   * \brief Receive the HARQ feedback transmitted over the PSFCH by a receiver
+   *        of a PSSCH transmitted by this UE
+   * \param feedback The HARQ feedback
+   */
+  virtual void ReceivePsfch (const NrSlInfoListElement_s &feedback) = 0;
 };
 
 
@@ -231,6 +237,7 @@ public:
   virtual std::unordered_set <uint32_t> GetSlRxDestinations () override;
   virtual void ReceivePsschPhyPdu (Ptr<PacketBurst> pdu) override;
   virtual void ReceiveSensingData (SensingData sensingData) override;
+  virtual void ReceivePsfch (const NrSlInfoListElement_s &feedback) override;
 
 private:
   C* m_owner; ///< the owner class
@@ -277,6 +284,13 @@ MemberNrSlUePhySapUser<C>::ReceiveSensingData (SensingData sensingData)
   m_owner->DoReceiveSensingData (sensingData);
 }
 
+template <class C>
+void
+MemberNrSlUePhySapUser<C>::ReceivePsfch (const NrSlInfoListElement_s &feedback)
+{
+  m_owner->DoReceivePsfch (feedback);
+}
+
 
 
 } // namespace ns3
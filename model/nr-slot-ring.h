@@ -0,0 +1,299 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_SLOT_RING_H
+#define NR_SLOT_RING_H
+
+#include <ns3/assert.h>
+#include <algorithm>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace ns3 {
+
+/**
+ * \ingroup ue-phy
+ * \ingroup gnb-phy
+ * \brief Values indexed by an absolute slot number, stored in a ring
+ *
+ * The PHY keeps an element for each of the next few slots: the ones
+ * between the current slot and the farthest slot that can be scheduled,
+ * which is given by the L1-L2 latency and by the K0, K1, K2 delays. A ring
+ * with more entries than that window stores each slot at the position
+ * (slot number modulo capacity), so that insert, lookup and removal are
+ * O(1), and, once reserved, the ring does not allocate memory.
+ *
+ * The capacity is always a power of two. If two slots stored at the same
+ * time fall in the same position, the capacity is doubled; the lookups are
+ * then still correct, because each entry remembers its slot number.
+ *
+ * The values removed are moved out, and the entry is reused by the next
+ * slot that falls in the same position: T must be default-constructible
+ * and assignable.
+ *
+ * \see NrPhy
+ */
+template <typename T>
+class NrSlotRing
+{
+public:
+  /**
+   * \brief Make sure the ring can store a window of slots without growing
+   * \param slots the number of consecutive slots to store
+   */
+  void
+  Reserve (uint32_t slots)
+  {
+    size_t capacity = 1;
+    while (capacity < slots)
+      {
+        capacity <<= 1;
+      }
+    if (capacity > m_entries.size ())
+      {
+        Resize (capacity);
+      }
+  }
+
+  /**
+   * \return the number of entries of the ring
+   */
+  size_t
+  GetCapacity () const
+  {
+    return m_entries.size ();
+  }
+
+  /**
+   * \return the number of slots stored
+   */
+  size_t
+  GetSize () const
+  {
+    return m_size;
+  }
+
+  /**
+   * \return true if no slot is stored
+   */
+  bool
+  IsEmpty () const
+  {
+    return m_size == 0;
+  }
+
+  /**
+   * \brief Get the value of a slot
+   * \param slot the absolute slot number
+   * \return a pointer to the value, or nullptr if the slot is not stored
+   */
+  T *
+  Find (uint64_t slot)
+  {
+    if (m_entries.empty ())
+      {
+        return nullptr;
+      }
+    Entry &entry = m_entries[slot & m_mask];
+    return entry.m_used && entry.m_slot == slot ? &entry.m_value : nullptr;
+  }
+
+  /**
+   * \brief Get the value of a slot
+   * \param slot the absolute slot number
+   * \return a pointer to the value, or nullptr if the slot is not stored
+   */
+  const T *
+  Find (uint64_t slot) const
+  {
+    if (m_entries.empty ())
+      {
+        return nullptr;
+      }
+    const Entry &entry = m_entries[slot & m_mask];
+    return entry.m_used && entry.m_slot == slot ? &entry.m_value : nullptr;
+  }
+
+  /**
+   * \brief Store the value of a slot that is not stored yet
+   * \param slot the absolute slot number
+   * \param value the value
+   * \return a reference to the value stored
+   */
+  T &
+  Insert (uint64_t slot, const T &value)
+  {
+    NS_ASSERT_MSG (Find (slot) == nullptr, "Slot " << slot << " already stored");
+    while (m_entries.empty () || m_entries[slot & m_mask].m_used)
+      {
+        Resize (std::max<size_t> (MIN_CAPACITY, m_entries.size () * 2));
+      }
+    Entry &entry = m_entries[slot & m_mask];
+    entry.m_slot = slot;
+    entry.m_used = true;
+    entry.m_value = value;
+    ++m_size;
+    return entry.m_value;
+  }
+
+  /**
+   * \brief Remove the value of a slot
+   * \param slot the absolute slot number
+   * \param value where the value is moved, if the slot is stored
+   * \return true if the slot was stored
+   */
+  bool
+  Pop (uint64_t slot, T &value)
+  {
+    if (m_entries.empty ())
+      {
+        return false;
+      }
+    Entry &entry = m_entries[slot & m_mask];
+    if (! entry.m_used || entry.m_slot != slot)
+      {
+        return false;
+      }
+    value = std::move (entry.m_value);
+    entry.m_used = false;
+    --m_size;
+    return true;
+  }
+
+  /**
+   * \brief Get the lowest slot number stored
+   * \return the lowest slot number
+   *
+   * It visits all the entries; the ring must not be empty.
+   */
+  uint64_t
+  GetFirstSlot () const
+  {
+    NS_ASSERT (m_size > 0);
+    bool found = false;
+    uint64_t first = 0;
+    for (const auto & entry : m_entries)
+      {
+        if (entry.m_used && (! found || entry.m_slot < first))
+          {
+            first = entry.m_slot;
+            found = true;
+          }
+      }
+    return first;
+  }
+
+  /**
+   * \brief Visit the stored values, in order of slot number
+   * \param f function called with the slot number and the value
+   *
+   * It sorts the stored slots, and it is meant for logging and for the rare
+   * operations that move all the slots.
+   */
+  template <typename F>
+  void
+  ForEachInOrder (F &&f)
+  {
+    std::vector<Entry *> used;
+    used.reserve (m_size);
+    for (auto & entry : m_entries)
+      {
+        if (entry.m_used)
+          {
+            used.push_back (&entry);
+          }
+      }
+    std::sort (used.begin (), used.end (),
+               [] (const Entry *a, const Entry *b) { return a->m_slot < b->m_slot; });
+    for (auto entry : used)
+      {
+        f (entry->m_slot, entry->m_value);
+      }
+  }
+
+  /**
+   * \brief Remove all the values, keeping the capacity
+   */
+  void
+  Clear ()
+  {
+    for (auto & entry : m_entries)
+      {
+        entry.m_used = false;
+      }
+    m_size = 0;
+  }
+
+private:
+  static constexpr size_t MIN_CAPACITY = 8; //!< Capacity of a ring that was not reserved
+
+  /**
+   * \brief An entry of the ring
+   */
+  struct Entry
+  {
+    uint64_t m_slot {0};   //!< Slot number of the value
+    bool m_used {false};   //!< True if a slot is stored in the entry
+    T m_value {};          //!< The value
+  };
+
+  /**
+   * \brief Change the capacity, and move the stored values in their new
+   * position (doubling the capacity again if two of them collide)
+   * \param capacity the new capacity, a power of two
+   */
+  void
+  Resize (size_t capacity)
+  {
+    std::vector<Entry> old;
+    old.swap (m_entries);
+    bool collision = true;
+    while (collision)
+      {
+        collision = false;
+        m_entries.assign (capacity, Entry ());
+        m_mask = capacity - 1;
+        for (auto & entry : old)
+          {
+            if (! entry.m_used)
+              {
+                continue;
+              }
+            Entry &dst = m_entries[entry.m_slot & m_mask];
+            if (dst.m_used)
+              {
+                collision = true;
+                capacity *= 2;
+                break;
+              }
+            dst.m_slot = entry.m_slot;
+            dst.m_used = true;
+            dst.m_value = entry.m_value;
+          }
+      }
+  }
+
+  std::vector<Entry> m_entries; //!< The entries; the size is a power of two
+  uint64_t m_mask {0};          //!< Capacity minus one
+  size_t m_size {0};            //!< Number of slots stored
+};
+
+} // namespace ns3
+
+#endif // NR_SLOT_RING_H
@@ -18,6 +18,7 @@
  */
 
 #include "nr-spectrum-phy.h"
+#include "nr-profiler.h"
 #include <ns3/boolean.h>
 #include <ns3/double.h>
 #include <ns3/lte-radio-bearer-tag.h>
@@ -130,6 +131,8 @@ NrSpectrumPhy::DoDispose ()
   m_nrPhyRxPscchEndOkCallback = nullptr;
   m_nrPhyRxPsschEndOkCallback = nullptr;
   m_nrPhyRxPsschEndErrorCallback = nullptr;
+  m_nrPhySlHarqFeedbackCallback = nullptr;
+  m_nrPhyRxPsfchCallback = nullptr;
 
   SpectrumPhy::DoDispose ();
 }
@@ -343,6 +346,18 @@ NrSpectrumPhy::GetCcaMode1Threshold (void) const
   return 10.0 * std::log10 (m_ccaMode1ThresholdW * 1000.0);
 }
 
+bool
+NrSpectrumPhy::IsChannelBusyNow () const
+{
+  return m_interferenceData->IsChannelBusyNow (m_ccaMode1ThresholdW);
+}
+
+Time
+NrSpectrumPhy::GetChannelBusyDuration () const
+{
+  return m_interferenceData->GetEnergyDuration (m_ccaMode1ThresholdW);
+}
+
 void
 NrSpectrumPhy::SetUnlicensedMode (bool unlicensedMode)
 {
@@ -391,6 +406,8 @@ void
 NrSpectrumPhy::StartRx (Ptr<SpectrumSignalParameters> params)
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (SPECTRUM_START_RX);
+  NR_PROFILE_COUNT (SPECTRUM_RX_SIGNALS, m_interferenceData->GetNumEnergyChanges ());
   Ptr <const SpectrumValue> rxPsd = params->psd;
   Time duration = params->duration;
   NS_LOG_INFO ("Start receiving signal: " << rxPsd <<" duration= " << duration);
@@ -736,6 +753,13 @@ NrSpectrumPhy::UpdateSrsSinrPerceived (const SpectrumValue& srsSinr)
     {
       srsCallback (GetCellId(), m_currentSrsRnti, Sum (srsSinr) / (srsSinr.GetSpectrumModel ()->GetNumBands ()));
     }
+
+  // The per-stream SRS SINR is also used by the scheduler to select the UL rank
+  Ptr<const NrGnbPhy> phy = DynamicCast<const NrGnbPhy> (m_phy);
+  if (phy != nullptr)
+    {
+      phy->GenerateSrsCqiReport (srsSinr, m_currentSrsRnti, m_streamId);
+    }
 }
 
 void
@@ -1183,6 +1207,8 @@ void
 NrSpectrumPhy::EndRxData ()
 {
   NS_LOG_FUNCTION (this);
+  NR_PROFILE_SCOPE (SPECTRUM_END_RX_DATA);
+  NR_PROFILE_COUNT (SPECTRUM_RX_DATA_TBS, m_transportBlocks.size ());
   m_interferenceData->EndRx ();
 
   Ptr<NrGnbNetDevice> enbRx = DynamicCast<NrGnbNetDevice> (GetDevice ());
@@ -1361,6 +1387,9 @@ NrSpectrumPhy::EndRxData ()
                     {
                       harqUlInfo.m_receptionStatus = UlHarqInfo::Ok;
                     }
+                  // The feedback of the other streams (if any) is merged by the gNB PHY
+                  harqUlInfo.m_receptionStatusPerStream.resize (m_streamId + 1, UlHarqInfo::NotValid);
+                  harqUlInfo.m_receptionStatusPerStream.at (m_streamId) = harqUlInfo.m_receptionStatus;
 
                   // Send the feedback
                   if (!m_phyUlHarqFeedbackCallback.IsNull ())
@@ -1743,6 +1772,60 @@ NrSpectrumPhy::StartTxSlDataFrames (const Ptr<PacketBurst>& pb, Time duration)
   }
 }
 
+void
+NrSpectrumPhy::StartTxSlFeedbackFrames (const std::vector<NrSlInfoListElement_s>& feedbackList, Time duration)
+{
+  NS_LOG_FUNCTION (this << " state: " << m_state);
+
+  switch (m_state)
+  {
+    case RX_DATA:
+      /* no break */
+    case RX_DL_CTRL:
+      /* no break */
+    case RX_UL_CTRL:
+      /* no break */
+    case TX:
+      //The UEs transmit the PSFCH in the same symbols, hence, due to the
+      //propagation delay, a UE may already be receiving the PSFCH of another
+      //UE. Being SL half duplex, the feedback is lost.
+      NS_LOG_DEBUG ("Dropping " << feedbackList.size () << " NR SL HARQ feedback, state: " << m_state);
+      break;
+    case CCA_BUSY:
+      NS_LOG_WARN ("Start transmitting NR SL PSFCH while in CCA_BUSY state.");
+      /* no break */
+    case IDLE:
+      {
+        NS_ASSERT (m_txPsd);
+
+        ChangeState (TX, duration);
+
+        Ptr<NrSpectrumSignalParametersSlFeedback> txParams = Create<NrSpectrumSignalParametersSlFeedback> ();
+        txParams->duration = duration;
+        txParams->txPhy = this->GetObject<SpectrumPhy> ();
+        txParams->psd = m_txPsd;
+        txParams->nodeId = GetDevice ()->GetNode ()->GetId ();
+        txParams->feedbackList = feedbackList;
+
+        m_txCtrlTrace (duration);
+
+        if (m_channel)
+          {
+            m_channel->StartTx (txParams);
+          }
+        else
+          {
+            NS_LOG_WARN ("Working without channel (i.e., under test)");
+          }
+
+        Simulator::Schedule (duration, &NrSpectrumPhy::EndTx, this);
+      }
+      break;
+    default:
+      NS_FATAL_ERROR ("Unknown state " << m_state << " Code should not reach this point");
+  }
+}
+
 void
 NrSpectrumPhy::StartRxSlFrame (Ptr<NrSpectrumSignalParametersSlFrame> params)
 {
@@ -1826,6 +1909,7 @@ NrSpectrumPhy::EndRxSlFrame ()
   //Extract the various types of NR Sidelink messages received
   std::vector <uint32_t> pscchIndexes;
   std::vector <uint32_t> psschIndexes;
+  std::vector <uint32_t> psfchIndexes;
 
 
   for (uint16_t i = 0; i < m_slRxSigParamInfo.size (); i++)
@@ -1833,6 +1917,7 @@ NrSpectrumPhy::EndRxSlFrame ()
       Ptr<NrSpectrumSignalParametersSlFrame> params = m_slRxSigParamInfo.at (i).params;
       Ptr<NrSpectrumSignalParametersSlCtrlFrame> nrSlCtrlRxParams = DynamicCast<NrSpectrumSignalParametersSlCtrlFrame> (params);
       Ptr<NrSpectrumSignalParametersSlDataFrame> nrSlDataRxParams = DynamicCast<NrSpectrumSignalParametersSlDataFrame> (params);
+      Ptr<NrSpectrumSignalParametersSlFeedback> nrSlFeedbackRxParams = DynamicCast<NrSpectrumSignalParametersSlFeedback> (params);
 
       if (nrSlCtrlRxParams != 0)
         {
@@ -1842,6 +1927,10 @@ NrSpectrumPhy::EndRxSlFrame ()
         {
           psschIndexes.push_back (i);
         }
+      else if (nrSlFeedbackRxParams != 0)
+        {
+          psfchIndexes.push_back (i);
+        }
       else
         {
           NS_FATAL_ERROR ("Invalid NR Sidelink signal parameter type");
@@ -1856,6 +1945,10 @@ NrSpectrumPhy::EndRxSlFrame ()
     {
       RxSlPssch (psschIndexes);
     }
+  if (psfchIndexes.size () > 0)
+    {
+      RxSlPsfch (psfchIndexes);
+    }
 
   //clear received packets
   ChangeState (IDLE, Seconds (0));
@@ -2086,7 +2179,7 @@ NrSpectrumPhy::RxSlPssch (std::vector<uint32_t> paramIndexes)
 
   //Compute error on PSSCH
   //Create a mapping between the packet tag and the index of the packet bursts.
-  for (uint32_t i = 0; i < m_slRxSigParamInfo.size (); i++)
+  for (uint32_t i = 0; i < paramIndexes.size (); i++)
     {
       uint32_t pktIndex = paramIndexes [i];
 
@@ -2160,7 +2253,13 @@ NrSpectrumPhy::RxSlPssch (std::vector<uint32_t> paramIndexes)
   //Compute the error and check for collision for each expected TB
   for (auto &tbIt : m_slTransportBlocks)
     {
-      NS_ABORT_MSG_IF (tbIt.second.sinrUpdated == false, "SINR not updated for the expected TB from RNTI " << tbIt.first);
+      if (tbIt.second.sinrUpdated == false)
+        {
+          //A retransmission reserved by a SCI stage 1 is not transmitted
+          //if the TX UE received a positive HARQ feedback
+          NS_LOG_DEBUG ("SINR not updated for the expected TB from RNTI " << tbIt.first << ", the TB was not transmitted");
+          continue;
+        }
       Ptr<Packet> sci2Pkt = RetrieveSci2FromPktBurst (tbIt.second.pktIndex);
       NrSlSciF2aHeader sciF2a;
       sci2Pkt->PeekHeader (sciF2a);
@@ -2173,6 +2272,8 @@ NrSpectrumPhy::RxSlPssch (std::vector<uint32_t> paramIndexes)
       bool isPrevDecoded = m_harqPhyModule->IsPrevDecoded (tbIt.first, sciF2a.GetHarqId ());
       if ((!m_slDataErrorModelEnabled || isPrevDecoded) && (!m_dropTbOnRbCollisionEnabled || isPrevDecoded))
         {
+          //The TB is (or was) decoded, hence the feedback is an ACK
+          GenerateSlHarqFeedback (tbIt.first, tbIt.second, sciF2a);
           continue;
         }
 
@@ -2358,6 +2459,8 @@ NrSpectrumPhy::RxSlPssch (std::vector<uint32_t> paramIndexes)
       traceParams.m_srcL2Id = sciF2a.GetSrcId ();
       m_rxPsschTraceUe (traceParams);
 
+      GenerateSlHarqFeedback (tbIt.first, tbIt.second, sciF2a);
+
       // Now dispatch the non corrupted TBs to UE PHY
       if (!tbIt.second.isDataCorrupted)
         {
@@ -2369,6 +2472,65 @@ NrSpectrumPhy::RxSlPssch (std::vector<uint32_t> paramIndexes)
   m_slTransportBlocks.clear ();
 }
 
+void
+NrSpectrumPhy::GenerateSlHarqFeedback (uint16_t txRnti, const SlTransportBlockInfo &tbInfo,
+                                       const NrSlSciF2aHeader &sciF2a)
+{
+  NS_LOG_FUNCTION (this << txRnti);
+
+  if (!m_nrPhySlHarqFeedbackCallback || sciF2a.GetHarqFbIndicator () == 0
+      || sciF2a.GetCastType () == NrSlSciF2aHeader::Broadcast)
+    {
+      return;
+    }
+  if (tbInfo.isSci2Corrupted)
+    {
+      //Without the SCI stage 2 the UE does not know the source and the HARQ
+      //process, hence it can not send any feedback
+      NS_LOG_DEBUG ("SCI stage 2 corrupted, no HARQ feedback for the TB from RNTI " << txRnti);
+      return;
+    }
+  if (!tbInfo.isDataCorrupted && sciF2a.GetCastType () == NrSlSciF2aHeader::GroupcastOnlyNack)
+    {
+      return;
+    }
+
+  NrSlInfoListElement_s feedback;
+  feedback.srcl2Id = sciF2a.GetSrcId ();
+  feedback.dstL2Id = sciF2a.GetDstId ();
+  feedback.harqProcessId = sciF2a.GetHarqId ();
+  feedback.m_harqStatus = tbInfo.isDataCorrupted ? NrSlInfoListElement_s::NACK : NrSlInfoListElement_s::ACK;
+  feedback.txRnti = txRnti;
+  feedback.psschSfn = tbInfo.expectedTb.sfn;
+
+  NS_LOG_DEBUG ("Generated HARQ " << (tbInfo.isDataCorrupted ? "NACK" : "ACK")
+                << " for the TB of HARQ process " << +feedback.harqProcessId
+                << " from RNTI " << txRnti << " received in " << feedback.psschSfn);
+
+  m_nrPhySlHarqFeedbackCallback (feedback, static_cast<uint16_t> (tbInfo.expectedTb.rbBitmap.at (0)));
+}
+
+void
+NrSpectrumPhy::RxSlPsfch (std::vector<uint32_t> paramIndexes)
+{
+  NS_LOG_FUNCTION (this << "Number of PSFCH signals:" << paramIndexes.size ());
+
+  NS_ASSERT (m_state == RX_DATA);
+
+  for (const auto &index : paramIndexes)
+    {
+      Ptr<NrSpectrumSignalParametersSlFeedback> params = DynamicCast<NrSpectrumSignalParametersSlFeedback> (m_slRxSigParamInfo.at (index).params);
+      NS_ASSERT (params != nullptr);
+      for (const auto &feedback : params->feedbackList)
+        {
+          if (m_nrPhyRxPsfchCallback)
+            {
+              m_nrPhyRxPsfchCallback (feedback);
+            }
+        }
+    }
+}
+
 Ptr<Packet>
 NrSpectrumPhy::RetrieveSci2FromPktBurst (uint32_t pktIndex)
 {
@@ -2442,6 +2604,20 @@ NrSpectrumPhy::SetNrPhyRxPsschEndErrorCallback (NrPhyRxPsschEndErrorCallback c)
   m_nrPhyRxPsschEndErrorCallback = c;
 }
 
+void
+NrSpectrumPhy::SetNrPhySlHarqFeedbackCallback (NrPhySlHarqFeedbackCallback c)
+{
+  NS_LOG_FUNCTION (this);
+  m_nrPhySlHarqFeedbackCallback = c;
+}
+
+void
+NrSpectrumPhy::SetNrPhyRxPsfchCallback (NrPhyRxPsfchCallback c)
+{
+  NS_LOG_FUNCTION (this);
+  m_nrPhyRxPsfchCallback = c;
+}
+
 void
 NrSpectrumPhy::AddSlExpectedTb (uint16_t rnti, uint32_t dstId, uint32_t tbSize, uint8_t mcs, const std::vector<int> &rbMap,
                                 uint8_t symStart, uint8_t numSym, const SfnSf &sfn)
@@ -2451,8 +2627,10 @@ NrSpectrumPhy::AddSlExpectedTb (uint16_t rnti, uint32_t dstId, uint32_t tbSize,
 
   if (it != m_slTransportBlocks.end ())
     {
-      NS_ABORT_MSG_IF (it->second.expectedTb.sfn == sfn, "I did not expect two TBs from a same RNTI in the same slot");
-      // might be a TB of an unreceived packet (due to high propagation losses)
+      // might be a TB of an unreceived packet (due to high propagation losses),
+      // or, if in the same slot, a retransmission reserved by a previous SCI
+      // stage 1 and cancelled by a positive HARQ feedback, replaced by a new TB
+      NS_LOG_DEBUG ("Replacing the expected TB from rnti " << rnti << " in " << it->second.expectedTb.sfn);
       m_slTransportBlocks.erase (it);
     }
 
@@ -39,6 +39,7 @@
 namespace ns3 {
 
   class UniformPlanarArray;
+  class NrSlSciF2aHeader;
 
 /**
  * \ingroup ue-phy
@@ -193,6 +194,23 @@ public:
    * \return CCA threshold in dBms
    */
   double GetCcaMode1Threshold (void) const;
+  /**
+   * \brief Check if the energy received now is above the CCA threshold
+   *
+   * Used by the channel access managers that perform LBT at each CCA slot.
+   *
+   * \return true if the channel is busy
+   */
+  bool IsChannelBusyNow () const;
+  /**
+   * \brief Get for how long the energy stays above the CCA threshold
+   *
+   * It considers the signals received until now, hence a new signal can
+   * make the channel busy for longer.
+   *
+   * \return the time until the channel is idle, zero if it is idle now
+   */
+  Time GetChannelBusyDuration () const;
   /**
    * \brief Sets whether to perform in unlicensed mode in which the channel monitoring is enabled
    * \param unlicensedMode if true the unlicensed mode is enabled
@@ -765,6 +783,17 @@ public:
    *        PSSCH reception.
    */
   typedef std::function<void (const Ptr<PacketBurst>&)> NrPhyRxPsschEndErrorCallback;
+  /**
+   * \brief This callback method type is used to notify about the HARQ
+   *        feedback generated for a received PSSCH TB, together with the
+   *        index of the first RB of the TB (used to map the PSFCH resource).
+   */
+  typedef std::function<void (const NrSlInfoListElement_s&, uint16_t)> NrPhySlHarqFeedbackCallback;
+  /**
+   * \brief This callback method type is used to notify about a HARQ
+   *        feedback received over the PSFCH.
+   */
+  typedef std::function<void (const NrSlInfoListElement_s&)> NrPhyRxPsfchCallback;
   /**
    * \brief Sets the NR sidelink error model type
    *
@@ -804,6 +833,17 @@ public:
    * \param duration the duration of transmission
    */
   void StartTxSlCtrlFrames (const Ptr<PacketBurst>& pb, Time duration);
+  /**
+   * \brief Starts transmission of NR SL HARQ feedback (PSFCH) on connected spectrum channel object
+   *
+   * Being the HARQ feedback of a UE transmitted at the same time of the
+   * feedback of other UEs, the transmission is dropped (and not aborted) if
+   * this SpectrumPhy is already receiving.
+   *
+   * \param feedbackList the HARQ feedback to be transmitted
+   * \param duration the duration of transmission
+   */
+  void StartTxSlFeedbackFrames (const std::vector<NrSlInfoListElement_s>& feedbackList, Time duration);
   /**
    * \brief Adds the NR SL chunk processor that passes the SINR of received
    *        signal (s) to this SpectrumPhy once its reception ends.
@@ -861,6 +901,17 @@ public:
    * \param c The callback
    */
   void SetNrPhyRxPsschEndErrorCallback (NrPhyRxPsschEndErrorCallback c);
+  /**
+   * \brief Set the callback for the HARQ feedback generated at the end of a
+   *        PSSCH RX.
+   * \param c The callback
+   */
+  void SetNrPhySlHarqFeedbackCallback (NrPhySlHarqFeedbackCallback c);
+  /**
+   * \brief Set the callback for the end of a PSFCH RX.
+   * \param c The callback
+   */
+  void SetNrPhyRxPsfchCallback (NrPhyRxPsfchCallback c);
   /**
    * \brief Add sidelink expected Transport Block (TB)
    * \param rnti The RNTI of the UE from whom to expect the TB
@@ -907,6 +958,27 @@ private:
    * \param paramIndexes Indexes of received PSSCH signals/messages parameters
    */
   void RxSlPssch (std::vector<uint32_t> paramIndexes);
+  /**
+   * \brief Function to process received PSFCH signals
+   *
+   * The PSFCH is assumed to be always decoded successfully.
+   *
+   * \param paramIndexes Indexes of received PSFCH signals parameters
+   */
+  void RxSlPsfch (std::vector<uint32_t> paramIndexes);
+  /**
+   * \brief Generate the HARQ feedback of a received PSSCH TB
+   *
+   * The feedback is generated only if requested by the SCI stage 2, and not
+   * for broadcast. In case of groupcast with NACK only feedback, the ACK
+   * is not sent.
+   *
+   * \param txRnti The RNTI of the UE that transmitted the TB
+   * \param tbInfo The info of the received TB
+   * \param sciF2a The SCI stage 2 of the TB
+   */
+  void GenerateSlHarqFeedback (uint16_t txRnti, const SlTransportBlockInfo &tbInfo,
+                               const NrSlSciF2aHeader &sciF2a);
   /**
    * \brief Get SINR stats function
    *
@@ -936,6 +1008,8 @@ private:
   NrPhyRxPscchEndOkCallback m_nrPhyRxPscchEndOkCallback; //!< the callback for the NR SL PHY PSCCH successful reception
   NrPhyRxPsschEndOkCallback m_nrPhyRxPsschEndOkCallback; //!< The callback for the NR SL PHY PSSCH successful reception
   NrPhyRxPsschEndErrorCallback m_nrPhyRxPsschEndErrorCallback; //!< The callback for the NR SL PHY PSSCH unsuccessful reception
+  NrPhySlHarqFeedbackCallback m_nrPhySlHarqFeedbackCallback; //!< The callback for the NR SL HARQ feedback generated at the end of a PSSCH reception
+  NrPhyRxPsfchCallback m_nrPhyRxPsfchCallback; //!< The callback for the NR SL PHY PSFCH reception
   /**
    * \brief typedef for NR SL transport block map per RNTI of TBs which are
    *        expected to be received after successful decoding of SCI stage-1.
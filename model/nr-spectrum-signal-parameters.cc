@@ -214,5 +214,26 @@ NrSpectrumSignalParametersSlDataFrame::Copy ()
   return lssp;
 }
 
+NrSpectrumSignalParametersSlFeedback::NrSpectrumSignalParametersSlFeedback ()
+{
+  NS_LOG_FUNCTION (this);
+}
+
+NrSpectrumSignalParametersSlFeedback::NrSpectrumSignalParametersSlFeedback (const NrSpectrumSignalParametersSlFeedback& p)
+  : NrSpectrumSignalParametersSlFrame (p)
+{
+  NS_LOG_FUNCTION (this << &p);
+  nodeId = p.nodeId;
+  feedbackList = p.feedbackList;
+}
+
+Ptr<SpectrumSignalParameters>
+NrSpectrumSignalParametersSlFeedback::Copy ()
+{
+  NS_LOG_FUNCTION (this);
+  Ptr<NrSpectrumSignalParametersSlFeedback> lssp (new NrSpectrumSignalParametersSlFeedback (*this), false);
+  return lssp;
+}
+
 
 }
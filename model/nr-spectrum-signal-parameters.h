@@ -21,7 +21,9 @@
 #ifndef NR_SPECTRUM_SIGNAL_PARAMETERS_H
 #define NR_SPECTRUM_SIGNAL_PARAMETERS_H
 
+#include "nr-sl-phy-mac-common.h"
 #include <list>
+#include <vector>
 #include <ns3/spectrum-signal-parameters.h>
 
 namespace ns3 {
@@ -204,6 +206,34 @@ struct NrSpectrumSignalParametersSlDataFrame : public NrSpectrumSignalParameters
   NrSpectrumSignalParametersSlDataFrame (const NrSpectrumSignalParametersSlDataFrame& p);
 };
 
+/**
+ * \ingroup ue-phy
+ *
+ * Signal parameters for NR SL HARQ feedback (PSFCH)
+ *
+ * The PSFCH does not carry a packet burst: the HARQ feedback is carried by
+ * the signal itself, one entry for each TB being acknowledged.
+ */
+struct NrSpectrumSignalParametersSlFeedback : public NrSpectrumSignalParametersSlFrame
+{
+
+  // inherited from SpectrumSignalParameters
+  virtual Ptr<SpectrumSignalParameters> Copy ();
+
+  /**
+   * \brief NrSpectrumSignalParametersSlFeedback default constructor
+   */
+  NrSpectrumSignalParametersSlFeedback ();
+
+  /**
+   * \brief NrSpectrumSignalParametersSlFeedback copy constructor
+   * \param p The NrSpectrumSignalParametersSlFeedback
+   */
+  NrSpectrumSignalParametersSlFeedback (const NrSpectrumSignalParametersSlFeedback& p);
+
+  std::vector<NrSlInfoListElement_s> feedbackList; //!< The HARQ feedback carried by this signal
+};
+
 }  // namespace ns3
 
 
@@ -0,0 +1,580 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "nr-trace-channel-model.h"
+#include <ns3/log.h>
+#include <ns3/string.h>
+#include <ns3/boolean.h>
+#include <ns3/simulator.h>
+#include <ns3/node.h>
+#include <ns3/mobility-model.h>
+#include <ns3/phased-array-model.h>
+#include <ns3/angles.h>
+#include <fstream>
+#include <sstream>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("NrTraceChannelModel");
+NS_OBJECT_ENSURE_REGISTERED (NrTraceChannelModel);
+
+static const char NR_TRACE_MAGIC[8] = {'N', 'R', 'T', 'R', 'A', 'C', 'E', '\0'};
+static const uint32_t NR_TRACE_VERSION = 1;
+static const uint32_t NR_TRACE_FIELDS = 7; //!< delay, power, phase, 4 angles
+
+/**
+ * \brief Read the comma-separated numbers of a text trace, one at a time
+ */
+class NrTraceTokenizer
+{
+public:
+  NrTraceTokenizer (const std::string &fileName)
+    : m_file (fileName)
+  {
+    NS_ABORT_MSG_IF (! m_file.is_open (), "Can't open the trace file " << fileName);
+  }
+
+  /**
+   * \brief Read the next number
+   * \param value where to store the number
+   * \return false at the end of the file
+   */
+  bool Next (double *value)
+  {
+    std::string token;
+    while (true)
+      {
+        if (std::getline (m_line, token, ','))
+          {
+            if (token.find_first_not_of (" \t\r") == std::string::npos)
+              {
+                continue;
+              }
+            *value = std::stod (token);
+            return true;
+          }
+
+        std::string line;
+        if (! std::getline (m_file, line))
+          {
+            return false;
+          }
+        m_line.clear ();
+        m_line.str (line);
+      }
+  }
+
+private:
+  std::ifstream m_file;      //!< The text trace
+  std::istringstream m_line; //!< The line being tokenized
+};
+
+TypeId
+NrTraceChannelModel::GetTypeId (void)
+{
+  static TypeId tid = TypeId ("ns3::NrTraceChannelModel")
+    .SetParent<MatrixBasedChannelModel> ()
+    .SetGroupName ("nr")
+    .AddConstructor<NrTraceChannelModel> ()
+    .AddAttribute ("TraceFile",
+                   "The text trace with the ray-traced paths",
+                   StringValue (""),
+                   MakeStringAccessor (&NrTraceChannelModel::SetTraceFile,
+                                       &NrTraceChannelModel::GetTraceFile),
+                   MakeStringChecker ())
+    .AddAttribute ("BinaryFile",
+                   "The binary version of the trace. If empty, the name of "
+                   "the text trace with the .bin suffix is used",
+                   StringValue (""),
+                   MakeStringAccessor (&NrTraceChannelModel::m_binaryFile),
+                   MakeStringChecker ())
+    .AddAttribute ("SnapshotPeriod",
+                   "Time between two consecutive snapshots of the trace",
+                   TimeValue (MilliSeconds (1)),
+                   MakeTimeAccessor (&NrTraceChannelModel::m_snapshotPeriod),
+                   MakeTimeChecker (TimeStep (1)))
+    .AddAttribute ("UpdatePeriod",
+                   "Period of the channel update when interpolating. "
+                   "If zero, the channel is updated at every time instant",
+                   TimeValue (MicroSeconds (125)),
+                   MakeTimeAccessor (&NrTraceChannelModel::m_updatePeriod),
+                   MakeTimeChecker ())
+    .AddAttribute ("Interpolate",
+                   "Interpolate the paths between two consecutive snapshots",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NrTraceChannelModel::m_interpolate),
+                   MakeBooleanChecker ())
+    .AddAttribute ("NormalizePower",
+                   "Normalize the total power of the channel to one, leaving "
+                   "the path loss to the propagation loss model",
+                   BooleanValue (true),
+                   MakeBooleanAccessor (&NrTraceChannelModel::m_normalizePower),
+                   MakeBooleanChecker ())
+    ;
+  return tid;
+}
+
+NrTraceChannelModel::NrTraceChannelModel ()
+{
+  NS_LOG_FUNCTION (this);
+  memset (&m_header, 0, sizeof (m_header));
+}
+
+NrTraceChannelModel::~NrTraceChannelModel ()
+{
+  NS_LOG_FUNCTION (this);
+  UnloadTrace ();
+}
+
+void
+NrTraceChannelModel::DoDispose ()
+{
+  NS_LOG_FUNCTION (this);
+  m_channelMap.clear ();
+  UnloadTrace ();
+  MatrixBasedChannelModel::DoDispose ();
+}
+
+void
+NrTraceChannelModel::SetTraceFile (const std::string &traceFile)
+{
+  NS_LOG_FUNCTION (this << traceFile);
+  UnloadTrace ();
+  m_channelMap.clear ();
+  m_traceFile = traceFile;
+}
+
+std::string
+NrTraceChannelModel::GetTraceFile () const
+{
+  return m_traceFile;
+}
+
+uint32_t
+NrTraceChannelModel::ConvertTrace (const std::string &traceFile, const std::string &binaryFile)
+{
+  NS_LOG_FUNCTION (traceFile << binaryFile);
+
+  // First pass: count the snapshots and the maximum number of paths, so that
+  // the records can have a fixed size without keeping the trace in memory
+  uint32_t numSnapshots = 0;
+  uint32_t maxPaths = 0;
+  {
+    NrTraceTokenizer tokenizer (traceFile);
+    double value;
+    while (tokenizer.Next (&value))
+      {
+        NS_ABORT_MSG_IF (value < 0, "Invalid number of paths in " << traceFile);
+        uint32_t numPaths = static_cast<uint32_t> (value);
+        maxPaths = std::max (maxPaths, numPaths);
+        for (uint32_t i = 0; i < numPaths * NR_TRACE_FIELDS; ++i)
+          {
+            NS_ABORT_MSG_UNLESS (tokenizer.Next (&value),
+                                 "Truncated snapshot " << numSnapshots << " in " << traceFile);
+          }
+        ++numSnapshots;
+      }
+  }
+
+  NS_ABORT_MSG_IF (numSnapshots == 0, "No snapshots in the trace " << traceFile);
+
+  BinaryHeader header;
+  memset (&header, 0, sizeof (header));
+  memcpy (header.m_magic, NR_TRACE_MAGIC, sizeof (header.m_magic));
+  header.m_version = NR_TRACE_VERSION;
+  header.m_numSnapshots = numSnapshots;
+  header.m_maxPaths = maxPaths;
+  header.m_recordSize = sizeof (uint32_t) + maxPaths * NR_TRACE_FIELDS * sizeof (float);
+
+  // The binary file may be mapped by other simulations that share the trace:
+  // write a new file in the same directory, and rename it over the binary
+  // file only when it is complete, so that nobody maps a partial file and
+  // the mapped files are never truncated
+  std::vector<char> tmpName (binaryFile.begin (), binaryFile.end ());
+  const std::string suffix = ".XXXXXX";
+  tmpName.insert (tmpName.end (), suffix.begin (), suffix.end ());
+  tmpName.push_back ('\0');
+  int fd = mkstemp (tmpName.data ());
+  NS_ABORT_MSG_IF (fd < 0, "Can't create a temporary file for the binary trace " << binaryFile);
+  fchmod (fd, S_IRUSR | S_IWUSR | S_IRGRP | S_IROTH);
+  close (fd);
+  std::string tmpFile (tmpName.data ());
+
+  std::ofstream out (tmpFile, std::ios::binary | std::ios::trunc);
+  NS_ABORT_MSG_IF (! out.is_open (), "Can't write the binary trace " << tmpFile);
+  out.write (reinterpret_cast<const char*> (&header), sizeof (header));
+
+  // Second pass: write one record per snapshot. Each record stores the
+  // number of paths, followed by the fields, field by field.
+  NrTraceTokenizer tokenizer (traceFile);
+  std::vector<float> record (maxPaths * NR_TRACE_FIELDS);
+  double value;
+  while (tokenizer.Next (&value))
+    {
+      uint32_t numPaths = static_cast<uint32_t> (value);
+      std::fill (record.begin (), record.end (), 0.0f);
+      for (uint32_t field = 0; field < NR_TRACE_FIELDS; ++field)
+        {
+          for (uint32_t p = 0; p < numPaths; ++p)
+            {
+              tokenizer.Next (&value);
+              record[field * maxPaths + p] = static_cast<float> (value);
+            }
+        }
+      out.write (reinterpret_cast<const char*> (&numPaths), sizeof (numPaths));
+      out.write (reinterpret_cast<const char*> (record.data ()), record.size () * sizeof (float));
+    }
+
+  out.close ();
+  if (out.fail ())
+    {
+      unlink (tmpFile.c_str ());
+      NS_FATAL_ERROR ("Error writing the binary trace " << tmpFile);
+    }
+  if (rename (tmpFile.c_str (), binaryFile.c_str ()) != 0)
+    {
+      unlink (tmpFile.c_str ());
+      NS_FATAL_ERROR ("Can't rename " << tmpFile << " to " << binaryFile);
+    }
+  NS_LOG_INFO ("Converted " << numSnapshots << " snapshots with at most " << maxPaths <<
+               " paths from " << traceFile << " to " << binaryFile);
+  return numSnapshots;
+}
+
+void
+NrTraceChannelModel::LoadTrace ()
+{
+  NS_LOG_FUNCTION (this);
+
+  if (m_mappedData != nullptr)
+    {
+      return;
+    }
+
+  NS_ABORT_MSG_IF (m_traceFile.empty (), "The attribute TraceFile of NrTraceChannelModel is not set");
+  std::string binaryFile = m_binaryFile.empty () ? m_traceFile + ".bin" : m_binaryFile;
+
+  struct stat traceStat;
+  struct stat binaryStat;
+  NS_ABORT_MSG_IF (stat (m_traceFile.c_str (), &traceStat) != 0, "Can't open the trace file " << m_traceFile);
+
+  bool convert = stat (binaryFile.c_str (), &binaryStat) != 0
+    || binaryStat.st_mtime < traceStat.st_mtime
+    || static_cast<size_t> (binaryStat.st_size) < sizeof (BinaryHeader);
+
+  for (uint32_t attempt = 0; attempt < 2; ++attempt)
+    {
+      if (convert)
+        {
+          ConvertTrace (m_traceFile, binaryFile);
+        }
+
+      int fd = open (binaryFile.c_str (), O_RDONLY);
+      NS_ABORT_MSG_IF (fd < 0, "Can't open the binary trace " << binaryFile);
+      NS_ABORT_MSG_IF (fstat (fd, &binaryStat) != 0, "Can't stat the binary trace " << binaryFile);
+      m_mappedSize = static_cast<size_t> (binaryStat.st_size);
+      void *data = mmap (nullptr, m_mappedSize, PROT_READ, MAP_SHARED, fd, 0);
+      close (fd);
+      NS_ABORT_MSG_IF (data == MAP_FAILED, "Can't map the binary trace " << binaryFile);
+      m_mappedData = static_cast<const uint8_t*> (data);
+
+      memcpy (&m_header, m_mappedData, sizeof (m_header));
+      bool valid = memcmp (m_header.m_magic, NR_TRACE_MAGIC, sizeof (NR_TRACE_MAGIC)) == 0
+        && m_header.m_version == NR_TRACE_VERSION
+        && m_header.m_numSnapshots > 0
+        && m_header.m_recordSize == sizeof (uint32_t) + m_header.m_maxPaths * NR_TRACE_FIELDS * sizeof (float)
+        && m_mappedSize >= sizeof (BinaryHeader) + static_cast<size_t> (m_header.m_numSnapshots) * m_header.m_recordSize;
+
+      if (valid)
+        {
+          // Snapshots are mostly read in time order
+          madvise (const_cast<uint8_t*> (m_mappedData), m_mappedSize, MADV_SEQUENTIAL);
+          NS_LOG_INFO ("Mapped " << m_header.m_numSnapshots << " snapshots from " << binaryFile);
+          return;
+        }
+
+      NS_LOG_WARN ("The binary trace " << binaryFile << " is not valid, converting it again");
+      UnloadTrace ();
+      convert = true;
+    }
+
+  NS_FATAL_ERROR ("Can't load the binary trace " << binaryFile);
+}
+
+void
+NrTraceChannelModel::UnloadTrace ()
+{
+  if (m_mappedData != nullptr)
+    {
+      munmap (const_cast<uint8_t*> (m_mappedData), m_mappedSize);
+      m_mappedData = nullptr;
+      m_mappedSize = 0;
+    }
+}
+
+uint32_t
+NrTraceChannelModel::GetNumSnapshots ()
+{
+  LoadTrace ();
+  return m_header.m_numSnapshots;
+}
+
+std::vector<NrTraceChannelModel::TracePath>
+NrTraceChannelModel::GetSnapshot (uint32_t index)
+{
+  LoadTrace ();
+  index = index % m_header.m_numSnapshots;
+
+  const uint8_t *record = m_mappedData + sizeof (BinaryHeader)
+    + static_cast<size_t> (index) * m_header.m_recordSize;
+  uint32_t numPaths;
+  memcpy (&numPaths, record, sizeof (numPaths));
+  NS_ASSERT (numPaths <= m_header.m_maxPaths);
+
+  std::vector<float> fields (m_header.m_maxPaths * NR_TRACE_FIELDS);
+  memcpy (fields.data (), record + sizeof (uint32_t), fields.size () * sizeof (float));
+  auto field = [&] (uint32_t f, uint32_t p) -> double
+    {
+      return static_cast<double> (fields[f * m_header.m_maxPaths + p]);
+    };
+
+  std::vector<TracePath> paths (numPaths);
+  for (uint32_t p = 0; p < numPaths; ++p)
+    {
+      paths[p].m_delay = field (0, p) * 1e-9;
+      paths[p].m_powerLinear = std::pow (10.0, field (1, p) / 10.0);
+      paths[p].m_phase = field (2, p);
+      paths[p].m_aodElevation = field (3, p);
+      paths[p].m_aodAzimuth = field (4, p);
+      paths[p].m_aoaElevation = field (5, p);
+      paths[p].m_aoaAzimuth = field (6, p);
+    }
+  return paths;
+}
+
+/**
+ * \brief Interpolate two azimuths along the shortest arc
+ * \param a first azimuth [deg]
+ * \param b second azimuth [deg]
+ * \param w weight of the second azimuth
+ * \return the interpolated azimuth, in [-180, 180) [deg]
+ */
+static double
+InterpolateAzimuth (double a, double b, double w)
+{
+  double diff = std::fmod (b - a + 540.0, 360.0) - 180.0;
+  double res = std::fmod (a + w * diff + 540.0, 360.0) - 180.0;
+  return res;
+}
+
+/**
+ * \brief Interpolate two phases along the shortest arc
+ * \param a first phase [rad]
+ * \param b second phase [rad]
+ * \param w weight of the second phase
+ * \return the interpolated phase [rad], not wrapped
+ */
+static double
+InterpolatePhase (double a, double b, double w)
+{
+  return a + w * std::remainder (b - a, 2 * M_PI);
+}
+
+std::vector<NrTraceChannelModel::TracePath>
+NrTraceChannelModel::GetPathsAt (const Time &t)
+{
+  NS_LOG_FUNCTION (this << t);
+  int64_t period = m_snapshotPeriod.GetTimeStep ();
+  uint32_t index = static_cast<uint32_t> ((t.GetTimeStep () / period) % GetNumSnapshots ());
+
+  std::vector<TracePath> first = GetSnapshot (index);
+  double w = static_cast<double> (t.GetTimeStep () % period) / static_cast<double> (period);
+
+  if (! m_interpolate || w == 0.0)
+    {
+      return first;
+    }
+
+  std::vector<TracePath> second = GetSnapshot (index + 1);
+  size_t common = std::min (first.size (), second.size ());
+  std::vector<TracePath> paths;
+  paths.reserve (first.size () + second.size () - common);
+
+  for (size_t p = 0; p < common; ++p)
+    {
+      TracePath path;
+      const TracePath &a = first[p];
+      const TracePath &b = second[p];
+      path.m_delay = (1 - w) * a.m_delay + w * b.m_delay;
+      path.m_powerLinear = (1 - w) * a.m_powerLinear + w * b.m_powerLinear;
+      path.m_phase = InterpolatePhase (a.m_phase, b.m_phase, w);
+      path.m_aodElevation = (1 - w) * a.m_aodElevation + w * b.m_aodElevation;
+      path.m_aodAzimuth = InterpolateAzimuth (a.m_aodAzimuth, b.m_aodAzimuth, w);
+      path.m_aoaElevation = (1 - w) * a.m_aoaElevation + w * b.m_aoaElevation;
+      path.m_aoaAzimuth = InterpolateAzimuth (a.m_aoaAzimuth, b.m_aoaAzimuth, w);
+      paths.push_back (path);
+    }
+  // Paths that disappear are faded out, paths that appear are faded in
+  for (size_t p = common; p < first.size (); ++p)
+    {
+      paths.push_back (first[p]);
+      paths.back ().m_powerLinear *= (1 - w);
+    }
+  for (size_t p = common; p < second.size (); ++p)
+    {
+      paths.push_back (second[p]);
+      paths.back ().m_powerLinear *= w;
+    }
+  return paths;
+}
+
+Ptr<MatrixBasedChannelModel::ChannelMatrix>
+NrTraceChannelModel::ComputeChannel (const std::vector<TracePath> &paths,
+                                     Ptr<const PhasedArrayModel> sAntenna,
+                                     Ptr<const PhasedArrayModel> uAntenna) const
+{
+  NS_LOG_FUNCTION (this);
+  uint64_t sSize = sAntenna->GetNumberOfElements ();
+  uint64_t uSize = uAntenna->GetNumberOfElements ();
+  size_t numPaths = paths.size ();
+
+  double totalPower = 0.0;
+  for (const auto & path : paths)
+    {
+      totalPower += path.m_powerLinear;
+    }
+  double norm = (m_normalizePower && totalPower > 0) ? 1.0 / totalPower : 1.0;
+
+  Ptr<ChannelMatrix> channel = Create<ChannelMatrix> ();
+  channel->m_channel.resize (uSize, Complex2DVector (sSize, PhasedArrayModel::ComplexVector (numPaths)));
+  channel->m_delay.resize (numPaths);
+  channel->m_angle.resize (4, DoubleVector (numPaths));
+
+  // The array response is separable: compute the s and u responses once per
+  // path, and then fill the matrix with their outer product
+  PhasedArrayModel::ComplexVector sResponse (sSize);
+  PhasedArrayModel::ComplexVector uResponse (uSize);
+
+  for (size_t n = 0; n < numPaths; ++n)
+    {
+      const TracePath &path = paths[n];
+      double zod = (90.0 - path.m_aodElevation) * M_PI / 180.0;
+      double aod = path.m_aodAzimuth * M_PI / 180.0;
+      double zoa = (90.0 - path.m_aoaElevation) * M_PI / 180.0;
+      double aoa = path.m_aoaAzimuth * M_PI / 180.0;
+
+      channel->m_delay[n] = path.m_delay;
+      channel->m_angle[AOA_INDEX][n] = path.m_aoaAzimuth;
+      channel->m_angle[ZOA_INDEX][n] = 90.0 - path.m_aoaElevation;
+      channel->m_angle[AOD_INDEX][n] = path.m_aodAzimuth;
+      channel->m_angle[ZOD_INDEX][n] = 90.0 - path.m_aodElevation;
+
+      auto arrayResponse = [] (Ptr<const PhasedArrayModel> antenna, double azimuth, double zenith,
+                               PhasedArrayModel::ComplexVector *response)
+        {
+          auto field = antenna->GetElementFieldPattern (Angles (azimuth, zenith));
+          double gain = std::sqrt (field.first * field.first + field.second * field.second);
+          double x = std::sin (zenith) * std::cos (azimuth);
+          double y = std::sin (zenith) * std::sin (azimuth);
+          double z = std::cos (zenith);
+          for (uint64_t i = 0; i < response->size (); ++i)
+            {
+              Vector loc = antenna->GetElementLocation (i);
+              double phase = 2 * M_PI * (x * loc.x + y * loc.y + z * loc.z);
+              (*response)[i] = gain * std::complex<double> (std::cos (phase), std::sin (phase));
+            }
+        };
+
+      arrayResponse (sAntenna, aod, zod, &sResponse);
+      arrayResponse (uAntenna, aoa, zoa, &uResponse);
+
+      std::complex<double> pathGain = std::sqrt (path.m_powerLinear * norm)
+        * std::complex<double> (std::cos (path.m_phase), std::sin (path.m_phase));
+
+      for (uint64_t u = 0; u < uSize; ++u)
+        {
+          std::complex<double> uTerm = pathGain * uResponse[u];
+          for (uint64_t s = 0; s < sSize; ++s)
+            {
+              channel->m_channel[u][s][n] = uTerm * sResponse[s];
+            }
+        }
+    }
+
+  return channel;
+}
+
+Ptr<const MatrixBasedChannelModel::ChannelMatrix>
+NrTraceChannelModel::GetChannel (Ptr<const MobilityModel> aMob,
+                                 Ptr<const MobilityModel> bMob,
+                                 Ptr<const PhasedArrayModel> aAntenna,
+                                 Ptr<const PhasedArrayModel> bAntenna)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint32_t aId = aMob->GetObject<Node> ()->GetId ();
+  uint32_t bId = bMob->GetObject<Node> ()->GetId ();
+  uint64_t key = GetKey (aId, bId);
+
+  Time now = Simulator::Now ();
+  int64_t snapshotKey;
+  if (m_interpolate && m_updatePeriod.IsStrictlyPositive ())
+    {
+      snapshotKey = now.GetTimeStep () / m_updatePeriod.GetTimeStep ();
+    }
+  else if (m_interpolate)
+    {
+      snapshotKey = now.GetTimeStep ();
+    }
+  else
+    {
+      snapshotKey = now.GetTimeStep () / m_snapshotPeriod.GetTimeStep ();
+    }
+
+  auto it = m_channelMap.find (key);
+  if (it != m_channelMap.end () && it->second.m_snapshotKey == snapshotKey)
+    {
+      // The channel is shared by both directions of the link; the user of the
+      // matrix checks IsReverse () to know which node was the s-node
+      return it->second.m_channel;
+    }
+
+  Time t = (m_interpolate && m_updatePeriod.IsStrictlyPositive ()) ?
+    TimeStep (snapshotKey * m_updatePeriod.GetTimeStep ()) : now;
+
+  Ptr<ChannelMatrix> channel = ComputeChannel (GetPathsAt (t), aAntenna, bAntenna);
+  channel->m_generatedTime = now;
+  channel->m_antennaPair = std::make_pair (aAntenna->GetId (), bAntenna->GetId ());
+  channel->m_nodeIds = std::make_pair (aId, bId);
+
+  CachedChannel &cached = m_channelMap[key];
+  cached.m_channel = channel;
+  cached.m_snapshotKey = snapshotKey;
+  return channel;
+}
+
+} // namespace ns3
@@ -0,0 +1,235 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#ifndef NR_TRACE_CHANNEL_MODEL_H
+#define NR_TRACE_CHANNEL_MODEL_H
+
+#include <ns3/matrix-based-channel-model.h>
+#include <ns3/nstime.h>
+#include <unordered_map>
+
+namespace ns3 {
+
+class MobilityModel;
+
+/**
+ * \ingroup spectrum
+ * \brief Trace-driven channel model for ray-traced (Quadriga-like) data
+ *
+ * The model replays the multipath information stored in text traces such as
+ * `model/Raytracing/Quadriga.txt`. Each snapshot of the text trace is
+ * composed of eight comma-separated rows:
+ *
+ * 1. number of paths N;
+ * 2. N path delays [ns];
+ * 3. N path powers (path loss included) [dB];
+ * 4. N initial path phases [rad];
+ * 5. N elevation angles of departure [deg];
+ * 6. N azimuth angles of departure [deg];
+ * 7. N elevation angles of arrival [deg];
+ * 8. N azimuth angles of arrival [deg].
+ *
+ * \section nr_trace_channel_binary Binary trace format
+ *
+ * Parsing text for every link would be too slow, and loading a long trace in
+ * memory would be too costly. Therefore, the first time a text trace is used,
+ * it is converted into a binary file (see ConvertTrace()) with a fixed size
+ * record per snapshot. The binary file is then memory-mapped, so that the
+ * snapshot for a given time index is reached in O(1), and only the pages
+ * that are really accessed are loaded by the operating system. The
+ * conversion is done again only if the text trace is newer than the binary
+ * file, or if the binary file is not valid. The conversion writes a new file
+ * and renames it over the binary file, so that the simulations that share
+ * the trace and have already mapped it are not affected.
+ *
+ * \section nr_trace_channel_time Time and interpolation
+ *
+ * The snapshot index is obtained by dividing the simulation time by the
+ * attribute SnapshotPeriod; when the end of the trace is reached, the
+ * trace restarts from the beginning. If the attribute Interpolate is true,
+ * the paths of two consecutive snapshots are linearly interpolated (power in
+ * the linear domain, azimuths and phases along the shortest arc). Paths that exist only
+ * in one of the two snapshots are faded in or out.
+ *
+ * The channel matrix is computed once per link and snapshot (or per
+ * UpdatePeriod, when interpolating) and then reused, independently of the
+ * direction of the transmission.
+ *
+ * \section nr_trace_channel_usage Usage
+ *
+ * The model can be used in place of the ThreeGppChannelModel, after the
+ * operation band has been initialized:
+ *
+\verbatim
+  Ptr<NrTraceChannelModel> traceModel = CreateObject<NrTraceChannelModel> ();
+  traceModel->SetAttribute ("TraceFile", StringValue ("contrib/nr/model/Raytracing/Quadriga1.txt"));
+  DynamicCast<ThreeGppSpectrumPropagationLossModel> (bwp->m_3gppChannel)->SetChannelModel (traceModel);
+\endverbatim
+ *
+ * By default (NormalizePower true) the channel matrix has unitary total
+ * power, and the path loss is left to the propagation loss model, as in
+ * the 3GPP case. If NormalizePower is false, the powers of the trace are
+ * used as they are, and the propagation loss model of the channel should
+ * not add any loss.
+ */
+class NrTraceChannelModel : public MatrixBasedChannelModel
+{
+public:
+  /**
+   * \brief Get the type id
+   * \return the type id of the class
+   */
+  static TypeId GetTypeId (void);
+
+  /**
+   * \brief NrTraceChannelModel constructor
+   */
+  NrTraceChannelModel ();
+
+  /**
+   * \brief ~NrTraceChannelModel
+   */
+  ~NrTraceChannelModel () override;
+
+  /**
+   * \brief A path of a snapshot, with the angles in degrees
+   */
+  struct TracePath
+  {
+    double m_delay {0.0};        //!< Delay [s]
+    double m_powerLinear {0.0};  //!< Power, linear units
+    double m_phase {0.0};        //!< Initial phase [rad]
+    double m_aodElevation {0.0}; //!< Elevation angle of departure [deg]
+    double m_aodAzimuth {0.0};   //!< Azimuth angle of departure [deg]
+    double m_aoaElevation {0.0}; //!< Elevation angle of arrival [deg]
+    double m_aoaAzimuth {0.0};   //!< Azimuth angle of arrival [deg]
+  };
+
+  /**
+   * \brief Convert a text trace into the binary format used by the model
+   * \param traceFile the text trace
+   * \param binaryFile the binary file to (over)write
+   * \return the number of snapshots converted
+   *
+   * The binary file is replaced atomically, once completely written. The
+   * method aborts the simulation if the text trace cannot be parsed.
+   */
+  static uint32_t ConvertTrace (const std::string &traceFile, const std::string &binaryFile);
+
+  /**
+   * \brief Get the number of snapshots of the trace
+   * \return the number of snapshots (loading the trace, if needed)
+   */
+  uint32_t GetNumSnapshots ();
+
+  /**
+   * \brief Get the paths of a snapshot, as stored in the trace
+   * \param index the snapshot index (wrapped around the trace length)
+   * \return the paths of the snapshot
+   */
+  std::vector<TracePath> GetSnapshot (uint32_t index);
+
+  /**
+   * \brief Get the paths at a given time, interpolated if the attribute
+   * Interpolate is true
+   * \param t the time since the beginning of the trace
+   * \return the paths at time t
+   */
+  std::vector<TracePath> GetPathsAt (const Time &t);
+
+  // inherited from MatrixBasedChannelModel
+  Ptr<const ChannelMatrix> GetChannel (Ptr<const MobilityModel> aMob,
+                                       Ptr<const MobilityModel> bMob,
+                                       Ptr<const PhasedArrayModel> aAntenna,
+                                       Ptr<const PhasedArrayModel> bAntenna) override;
+
+protected:
+  void DoDispose () override;
+
+private:
+  /**
+   * \brief Header of the binary trace file
+   */
+  struct BinaryHeader
+  {
+    char m_magic[8];          //!< Magic string, "NRTRACE"
+    uint32_t m_version;       //!< Format version
+    uint32_t m_numSnapshots;  //!< Number of snapshots
+    uint32_t m_maxPaths;      //!< Maximum number of paths in a snapshot
+    uint32_t m_recordSize;    //!< Size of each snapshot record [bytes]
+  };
+
+  /**
+   * \brief Map the binary trace in memory, converting the text trace first
+   * if needed
+   */
+  void LoadTrace ();
+
+  /**
+   * \brief Release the memory-mapped binary trace
+   */
+  void UnloadTrace ();
+
+  /**
+   * \brief Compute the channel matrix from the trace paths
+   * \param paths the paths of the (interpolated) snapshot
+   * \param sAntenna the antenna of the transmitting (s) node
+   * \param uAntenna the antenna of the receiving (u) node
+   * \return the channel matrix
+   */
+  Ptr<ChannelMatrix> ComputeChannel (const std::vector<TracePath> &paths,
+                                     Ptr<const PhasedArrayModel> sAntenna,
+                                     Ptr<const PhasedArrayModel> uAntenna) const;
+
+  /**
+   * \brief Set the text trace to use
+   * \param traceFile the text trace
+   */
+  void SetTraceFile (const std::string &traceFile);
+
+  /**
+   * \brief Get the text trace in use
+   * \return the text trace
+   */
+  std::string GetTraceFile () const;
+
+  std::string m_traceFile;             //!< Text trace
+  std::string m_binaryFile;            //!< Binary trace (empty: m_traceFile + ".bin")
+  Time m_snapshotPeriod;               //!< Time between two snapshots
+  Time m_updatePeriod;                 //!< Channel update period when interpolating
+  bool m_interpolate {true};           //!< Interpolate between snapshots
+  bool m_normalizePower {true};        //!< Normalize the total channel power to one
+
+  const uint8_t *m_mappedData {nullptr}; //!< Memory-mapped binary trace
+  size_t m_mappedSize {0};               //!< Size of the mapping [bytes]
+  BinaryHeader m_header;                 //!< Header of the binary trace
+
+  /**
+   * \brief Cached channel of a link
+   */
+  struct CachedChannel
+  {
+    Ptr<const ChannelMatrix> m_channel; //!< The channel matrix
+    int64_t m_snapshotKey {-1};         //!< Snapshot (or update period) index of m_channel
+  };
+  std::unordered_map<uint64_t, CachedChannel> m_channelMap; //!< Channel of each link
+};
+
+} // namespace ns3
+
+#endif // NR_TRACE_CHANNEL_MODEL_H
@@ -26,6 +26,7 @@
   while (false);
 
 #include "nr-ue-mac.h"
+#include "nr-profiler.h"
 #include <ns3/log.h>
 #include <ns3/boolean.h>
 #include <ns3/lte-radio-bearer-tag.h>
@@ -41,9 +42,12 @@
 #include "nr-sl-sci-f1a-header.h"
 #include "nr-sl-sci-f2a-header.h"
 #include "nr-sl-mac-pdu-tag.h"
+#include "nr-sl-candidate-resource-set.h"
 #include "ns3/lte-rlc-tag.h"
 #include <algorithm>
 #include <bitset>
+#include <numeric>
+#include <unordered_map>
 
 namespace ns3 {
 
@@ -235,6 +239,7 @@ public:
   virtual void SchedUeNrSlConfigInd (uint32_t dstL2Id, uint8_t lcId, const NrSlGrant& grant);
   virtual uint8_t GetTotalSubCh () const;
   virtual uint8_t GetSlMaxTxTransNumPssch () const;
+  virtual uint16_t GetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const;
 
 private:
   NrUeMac* m_mac; //!< The pointer to the NrUeMac using this SAP
@@ -263,6 +268,12 @@ MemberNrSlUeMacSchedSapUser::GetSlMaxTxTransNumPssch () const
   return m_mac->DoGetSlMaxTxTransNumPssch ();
 }
 
+uint16_t
+MemberNrSlUeMacSchedSapUser::GetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const
+{
+  return m_mac->DoGetSlMinReTxGap (dstL2Id, lcId);
+}
+
 class MemberNrSlUeMacCschedSapUser : public NrSlUeMacCschedSapUser
 {
 
@@ -300,6 +311,13 @@ NrUeMac::GetTypeId (void)
                     MakeUintegerAccessor (&NrUeMac::SetNumHarqProcess,
                                           &NrUeMac::GetNumHarqProcess),
                     MakeUintegerChecker<uint8_t> ())
+    .AddAttribute ("UlMaxRank",
+                   "Maximum number of PUSCH layers (UL rank) of the UE. It must be "
+                   "the UlMaxRank of the scheduler of the gNB",
+                   UintegerValue (1),
+                   MakeUintegerAccessor (&NrUeMac::SetUlMaxRank,
+                                         &NrUeMac::GetUlMaxRank),
+                   MakeUintegerChecker<uint8_t> (1, 2))
     .AddTraceSource ("UeMacRxedCtrlMsgsTrace",
                      "Ue MAC Control Messages Traces.",
                      MakeTraceSourceAccessor (&NrUeMac::m_macRxedCtrlMsgsTrace),
@@ -308,6 +326,10 @@ NrUeMac::GetTypeId (void)
                      "Ue MAC Control Messages Traces.",
                      MakeTraceSourceAccessor (&NrUeMac::m_macTxedCtrlMsgsTrace),
                      "ns3::NrMacRxTrace::TxedUeMacCtrlMsgsTracedCallback")
+    .AddTraceSource ("UlHarqFeedback",
+                     "Outcome of the UL HARQ transmissions, given by the NDI of the next UL DCI of the process",
+                     MakeTraceSourceAccessor (&NrUeMac::m_ulHarqFeedbackTrace),
+                     "ns3::NrUeMac::UlHarqFeedbackTracedCallback")
     .AddAttribute ("EnableSensing",
                    "Flag to enable NR Sidelink resource selection based on sensing; otherwise, use random selection",
                    BooleanValue (false),
@@ -499,10 +521,15 @@ NrUeMac::SetNumHarqProcess (uint8_t numHarqProcess)
   m_miUlHarqProcessesPacket.resize (GetNumHarqProcess ());
   for (uint8_t i = 0; i < m_miUlHarqProcessesPacket.size (); i++)
     {
-      if (m_miUlHarqProcessesPacket.at (i).m_pktBurst == nullptr)
+      //for each of the HARQ process we have the info of one stream per UL layer
+      m_miUlHarqProcessesPacket.at (i).m_infoPerStream.resize (m_ulMaxRank);
+      for (auto &info : m_miUlHarqProcessesPacket.at (i).m_infoPerStream)
         {
-          Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-          m_miUlHarqProcessesPacket.at (i).m_pktBurst = pb;
+          if (info.m_pktBurst == nullptr)
+            {
+              Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
+              info.m_pktBurst = pb;
+            }
         }
     }
   m_miUlHarqProcessesPacketTimer.resize (GetNumHarqProcess (), 0);
@@ -517,14 +544,31 @@ NrUeMac::GetNumHarqProcess () const
   return m_numHarqProcess;
 }
 
+void
+NrUeMac::SetUlMaxRank (uint8_t ulMaxRank)
+{
+  NS_LOG_FUNCTION (this << +ulMaxRank);
+  m_ulMaxRank = ulMaxRank;
+  // Resize the streams of the HARQ processes
+  SetNumHarqProcess (m_numHarqProcess);
+}
+
+uint8_t
+NrUeMac::GetUlMaxRank () const
+{
+  return m_ulMaxRank;
+}
+
 // forwarded from MAC SAP
 void
 NrUeMac::DoTransmitPdu (LteMacSapProvider::TransmitPduParameters params)
 {
   NS_LOG_FUNCTION (this);
   NS_ASSERT (m_ulDci->m_harqProcess == params.harqProcessId);
+  NS_ASSERT (m_ulDciStream == params.layer);
 
-  m_miUlHarqProcessesPacket.at (params.harqProcessId).m_lcidList.push_back (params.lcid);
+  UlHarqProcessInfoSingleStream & harqInfo = m_miUlHarqProcessesPacket.at (params.harqProcessId).m_infoPerStream.at (params.layer);
+  harqInfo.m_lcidList.push_back (params.lcid);
 
   NrMacHeaderVs header;
   header.SetLcId (params.lcid);
@@ -535,12 +579,16 @@ NrUeMac::DoTransmitPdu (LteMacSapProvider::TransmitPduParameters params)
   LteRadioBearerTag bearerTag (params.rnti, params.lcid, params.layer);
   params.pdu->AddPacketTag (bearerTag);
 
-  m_miUlHarqProcessesPacket.at (params.harqProcessId).m_pktBurst->AddPacket (params.pdu);
+  if (harqInfo.m_pktBurst == nullptr)
+    {
+      harqInfo.m_pktBurst = CreateObject <PacketBurst> ();
+    }
+  harqInfo.m_pktBurst->AddPacket (params.pdu);
   m_miUlHarqProcessesPacketTimer.at (params.harqProcessId) = GetNumHarqProcess();
 
   m_ulDciTotalUsed += params.pdu->GetSize ();
 
-  NS_ASSERT_MSG (m_ulDciTotalUsed <= m_ulDci->m_tbSize.at (0), "We used more data than the DCI allowed us.");
+  NS_ASSERT_MSG (m_ulDciTotalUsed <= m_ulDci->m_tbSize.at (m_ulDciStream), "We used more data than the DCI allowed us.");
 
   m_phySapProvider->SendMacPdu (params.pdu, m_ulDciSfnsf, m_ulDci->m_symStart, params.layer);
 }
@@ -642,14 +690,9 @@ NrUeMac::SendReportBufferStatus (const SfnSf &dataSfn, uint8_t symStart)
   p->AddPacketTag (bearerTag);
 
   m_ulDciTotalUsed += p->GetSize ();
-  NS_ASSERT_MSG (m_ulDciTotalUsed <= m_ulDci->m_tbSize.at (0), "We used more data than the DCI allowed us.");
-
-  //MIMO is not supported for UL yet.
-  //Therefore, there will be only
-  //one stream with stream Id 0.
-  uint8_t streamId = 0;
+  NS_ASSERT_MSG (m_ulDciTotalUsed <= m_ulDci->m_tbSize.at (m_ulDciStream), "We used more data than the DCI allowed us.");
 
-  m_phySapProvider->SendMacPdu (p, dataSfn, symStart, streamId);
+  m_phySapProvider->SendMacPdu (p, dataSfn, symStart, m_ulDciStream);
 }
 
 void
@@ -671,15 +714,18 @@ NrUeMac::RefreshHarqProcessesPacketBuffer (void)
 
   for (uint16_t i = 0; i < m_miUlHarqProcessesPacketTimer.size (); i++)
     {
-      if (m_miUlHarqProcessesPacketTimer.at (i) == 0 && m_miUlHarqProcessesPacket.at (i).m_pktBurst)
+      if (m_miUlHarqProcessesPacketTimer.at (i) == 0)
         {
-          if (m_miUlHarqProcessesPacket.at (i).m_pktBurst->GetSize () > 0)
+          for (auto &info : m_miUlHarqProcessesPacket.at (i).m_infoPerStream)
             {
-              // timer expired: drop packets in buffer for this process
-              NS_LOG_INFO ("HARQ Proc Id " << i << " packets buffer expired");
-              Ptr<PacketBurst> emptyPb = CreateObject <PacketBurst> ();
-              m_miUlHarqProcessesPacket.at (i).m_pktBurst = emptyPb;
-              m_miUlHarqProcessesPacket.at (i).m_lcidList.clear ();
+              if (info.m_pktBurst && info.m_pktBurst->GetSize () > 0)
+                {
+                  // timer expired: drop packets in buffer for this process
+                  NS_LOG_INFO ("HARQ Proc Id " << i << " packets buffer expired");
+                  Ptr<PacketBurst> emptyPb = CreateObject <PacketBurst> ();
+                  info.m_pktBurst = emptyPb;
+                  info.m_lcidList.clear ();
+                }
             }
         }
       else
@@ -762,15 +808,15 @@ NrUeMac::DoReceivePhyPdu (Ptr<Packet> p)
       return;
     }
 
-  NrMacHeaderVs header;
-  p->RemoveHeader (header);
+  uint8_t lcId;
+  NrMacHeaderVs::RemoveSubheader (p, lcId);
 
   LteMacSapUser::ReceivePduParameters rxParams;
   rxParams.p = p;
   rxParams.rnti = m_rnti;
-  rxParams.lcid = header.GetLcId ();
+  rxParams.lcid = lcId;
 
-  auto it = m_lcInfoMap.find (header.GetLcId());
+  auto it = m_lcInfoMap.find (lcId);
 
   // p can be empty. Well, right now no, but when someone will add CE in downlink,
   // then p can be empty.
@@ -805,55 +851,108 @@ NrUeMac::ProcessUlDci (const Ptr<NrUlDciMessage> &dciMsg)
 
   m_macRxedCtrlMsgsTrace (m_currentSlot, GetCellId (), m_rnti, GetBwpId (), dciMsg);
 
+  uint32_t totalTbSize = std::accumulate (m_ulDci->m_tbSize.begin (), m_ulDci->m_tbSize.end (), 0U);
+
   NS_LOG_INFO ("UL DCI received, transmit data in slot " << dataSfn <<
                " Harq Process " << +m_ulDci->m_harqProcess <<
-               " TBS " << m_ulDci->m_tbSize.at (0) << " total queue " << GetTotalBufSize ());
-
-  if (m_ulDci->m_ndi.at (0) == 0)
+               " TBS " << totalTbSize << " total queue " << GetTotalBufSize ());
+
+  // The BSR goes in the first stream with a TB; the TB of each stream is
+  // filled separately, and we keep track of the bytes used in each of them.
+  uint8_t bsrStream = UINT8_MAX;
+  std::vector<uint32_t> totalUsed (m_ulDci->m_tbSize.size (), 0);
+  bool newData = false;
+  for (uint8_t stream = 0; stream < m_ulDci->m_tbSize.size (); stream++)
     {
-      // This method will retransmit the data saved in the harq buffer
-      TransmitRetx ();
+      if (m_ulDci->m_tbSize.at (stream) == 0)
+        {
+          continue;
+        }
+      NS_ABORT_MSG_IF (stream >= m_ulMaxRank,
+                       "UL DCI with a TB for stream " << +stream << ", but the UlMaxRank of the UE is " <<
+                       +m_ulMaxRank << ": please set it as the UlMaxRank of the scheduler");
+      if (bsrStream == UINT8_MAX)
+        {
+          bsrStream = stream;
+        }
 
-      // This method will transmit a new BSR.
-      SendReportBufferStatus (dataSfn, m_ulDci->m_symStart);
-    }
-  else if (m_ulDci->m_ndi.at (0) == 1)
-    {
-      SendNewData ();
+      m_ulDciStream = stream;
+      m_ulDciTotalUsed = 0;
+
+      // The NDI of the process tells the outcome of its last TB: a
+      // retransmission means that the gNB did not decode it
+      UlHarqProcessInfoSingleStream &harqInfo = m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_infoPerStream.at (stream);
+      if (harqInfo.m_waitingFeedback)
+        {
+          m_ulHarqFeedbackTrace (m_ulDci->m_harqProcess, stream, m_ulDci->m_ndi.at (stream) == 0);
+        }
+      harqInfo.m_waitingFeedback = true;
+
+      if (m_ulDci->m_ndi.at (stream) == 0)
+        {
+          // This method will retransmit the data saved in the harq buffer
+          TransmitRetx ();
+        }
+      else if (m_ulDci->m_ndi.at (stream) == 1)
+        {
+          // Leave space for the BSR, that we send after the data
+          SendNewData (stream == bsrStream ? 5 : 0);
+          newData = true;
 
-      NS_LOG_INFO ("After sending NewData, bufSize " << GetTotalBufSize ());
+          NS_LOG_INFO ("After sending NewData in stream " << +stream <<
+                       ", bufSize " << GetTotalBufSize ());
+        }
+      totalUsed.at (stream) = m_ulDciTotalUsed;
+    }
+  NS_ABORT_MSG_IF (bsrStream == UINT8_MAX, "UL DCI without any TB");
 
-      // Send a new BSR. SendNewData() already took into account the size of
-      // the BSR.
-      SendReportBufferStatus (dataSfn, m_ulDci->m_symStart);
+  // This method will transmit a new BSR. SendNewData() already took into
+  // account the size of the BSR.
+  m_ulDciStream = bsrStream;
+  m_ulDciTotalUsed = totalUsed.at (bsrStream);
+  SendReportBufferStatus (dataSfn, m_ulDci->m_symStart);
+  totalUsed.at (bsrStream) = m_ulDciTotalUsed;
 
-      NS_LOG_INFO ("UL DCI processing done, sent to PHY a total of " << m_ulDciTotalUsed <<
-                   " B out of " << m_ulDci->m_tbSize.at (0) << " allocated bytes ");
+  if (newData)
+    {
+      NS_LOG_INFO ("UL DCI processing done, sent to PHY a total of " <<
+                   std::accumulate (totalUsed.begin (), totalUsed.end (), 0U) <<
+                   " B out of " << totalTbSize << " allocated bytes ");
 
       if (GetTotalBufSize () == 0)
         {
           m_srState = INACTIVE;
           NS_LOG_INFO ("ACTIVE -> INACTIVE, bufSize " << GetTotalBufSize ());
+        }
 
-          // the UE may have been scheduled, but we didn't use a single byte
-          // of the allocation. So send an empty PDU. This happens because the
-          // byte reporting in the BSR is not accurate, due to RLC and/or
-          // BSR quantization.
-          if (m_ulDciTotalUsed == 0)
+      // the UE may have been scheduled, but we didn't use a single byte
+      // of the allocation in a stream. So send an empty PDU. This happens because the
+      // byte reporting in the BSR is not accurate, due to RLC and/or
+      // BSR quantization, or because the data fitted in the TB of the first stream.
+      for (uint8_t stream = 0; stream < m_ulDci->m_tbSize.size (); stream++)
+        {
+          if (m_ulDci->m_tbSize.at (stream) == 0 || m_ulDci->m_ndi.at (stream) != 1
+              || totalUsed.at (stream) > 0)
             {
-              NS_LOG_WARN ("No byte used for this UL-DCI, sending empty PDU");
+              continue;
+            }
 
-              LteMacSapProvider::TransmitPduParameters txParams;
+          NS_LOG_WARN ("No byte used for this UL-DCI in stream " << +stream <<
+                       ", sending empty PDU");
 
-              txParams.pdu = Create<Packet> ();
-              txParams.lcid = 3;
-              txParams.rnti = m_rnti;
-              txParams.layer = 0;
-              txParams.harqProcessId = m_ulDci->m_harqProcess;
-              txParams.componentCarrierId = GetBwpId ();
+          m_ulDciStream = stream;
+          m_ulDciTotalUsed = 0;
 
-              DoTransmitPdu (txParams);
-            }
+          LteMacSapProvider::TransmitPduParameters txParams;
+
+          txParams.pdu = Create<Packet> ();
+          txParams.lcid = 3;
+          txParams.rnti = m_rnti;
+          txParams.layer = stream;
+          txParams.harqProcessId = m_ulDci->m_harqProcess;
+          txParams.componentCarrierId = GetBwpId ();
+
+          DoTransmitPdu (txParams);
         }
     }
 }
@@ -863,7 +962,7 @@ NrUeMac::TransmitRetx ()
 {
   NS_LOG_FUNCTION (this);
 
-  Ptr<PacketBurst> pb = m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_pktBurst;
+  Ptr<PacketBurst> pb = m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_infoPerStream.at (m_ulDciStream).m_pktBurst;
 
   if (pb == nullptr)
     {
@@ -874,7 +973,7 @@ NrUeMac::TransmitRetx ()
       return;
     }
 
-  NS_LOG_DEBUG ("UE MAC RETX HARQ " << + m_ulDci->m_harqProcess);
+  NS_LOG_DEBUG ("UE MAC RETX HARQ " << + m_ulDci->m_harqProcess << " stream " << +m_ulDciStream);
 
   NS_ASSERT (pb->GetNPackets() > 0);
 
@@ -886,11 +985,7 @@ NrUeMac::TransmitRetx ()
         {
           NS_FATAL_ERROR ("No radio bearer tag");
         }
-      //MIMO is not supported for UL yet.
-      //Therefore, there will be only
-      //one stream with stream Id 0.
-      uint8_t streamId = 0;
-      m_phySapProvider->SendMacPdu (pkt, m_ulDciSfnsf, m_ulDci->m_symStart, streamId);
+      m_phySapProvider->SendMacPdu (pkt, m_ulDciSfnsf, m_ulDci->m_symStart, m_ulDciStream);
     }
 
   m_miUlHarqProcessesPacketTimer.at (m_ulDci->m_harqProcess) = GetNumHarqProcess();
@@ -918,7 +1013,7 @@ NrUeMac::SendRetxData (uint32_t usefulTbs, uint32_t activeLcsRetx)
           txParams.lcid = bsr.lcid;
           txParams.rnti = m_rnti;
           txParams.bytes = bytesPerLcId;
-          txParams.layer = 0;
+          txParams.layer = m_ulDciStream;
           txParams.harqId = m_ulDci->m_harqProcess;
           txParams.componentCarrierId = GetBwpId ();
 
@@ -939,7 +1034,7 @@ NrUeMac::SendRetxData (uint32_t usefulTbs, uint32_t activeLcsRetx)
         {
           NS_LOG_DEBUG ("Something wrong with the calculation of overhead."
                         "Active LCS Retx: " << activeLcsRetx << " assigned to this: " <<
-                        bytesPerLcId << ", with TBS of " << m_ulDci->m_tbSize.at (0) <<
+                        bytesPerLcId << ", with TBS of " << m_ulDci->m_tbSize.at (m_ulDciStream) <<
                         " usefulTbs " << usefulTbs << " and total used " << m_ulDciTotalUsed);
         }
     }
@@ -967,7 +1062,7 @@ NrUeMac::SendTxData(uint32_t usefulTbs, uint32_t activeTx)
           txParams.lcid = bsr.lcid;
           txParams.rnti = m_rnti;
           txParams.bytes = bytesPerLcId;
-          txParams.layer = 0;
+          txParams.layer = m_ulDciStream;
           txParams.harqId = m_ulDci->m_harqProcess;
           txParams.componentCarrierId = GetBwpId ();
 
@@ -988,21 +1083,22 @@ NrUeMac::SendTxData(uint32_t usefulTbs, uint32_t activeTx)
         {
           NS_LOG_DEBUG ("Something wrong with the calculation of overhead."
                         "Active LCS Retx: " << activeTx << " assigned to this: " <<
-                        bytesPerLcId << ", with TBS of " << m_ulDci->m_tbSize.at (0) <<
+                        bytesPerLcId << ", with TBS of " << m_ulDci->m_tbSize.at (m_ulDciStream) <<
                         " usefulTbs " << usefulTbs << " and total used " << m_ulDciTotalUsed);
         }
     }
 }
 
 void
-NrUeMac::SendNewData ()
+NrUeMac::SendNewData (uint32_t bsrSize)
 {
-  NS_LOG_FUNCTION (this);
+  NS_LOG_FUNCTION (this << bsrSize);
   // New transmission -> empty pkt buffer queue (for deleting eventual pkts not acked )
+  UlHarqProcessInfoSingleStream & harqInfo = m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_infoPerStream.at (m_ulDciStream);
   Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
-  m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_pktBurst = pb;
-  m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_lcidList.clear ();
-  NS_LOG_INFO ("Reset HARQP " << +m_ulDci->m_harqProcess);
+  harqInfo.m_pktBurst = pb;
+  harqInfo.m_lcidList.clear ();
+  NS_LOG_INFO ("Reset HARQP " << +m_ulDci->m_harqProcess << " stream " << +m_ulDciStream);
 
   // Sending the status data has no boundary: let's try to send the ACK as
   // soon as possible, filling the TBS, if necessary.
@@ -1026,10 +1122,10 @@ NrUeMac::SendNewData ()
   // Of the TBS we received in the DCI, one part is gone for the status pdu,
   // where we didn't check much as it is the most important data, that has to go
   // out. For the rest that we have left, we can use only a part of it because of
-  // the overhead of the SHORT_BSR, which is 5 bytes.
-  NS_ASSERT_MSG (m_ulDciTotalUsed + 5 <= m_ulDci->m_tbSize.at (0),
+  // the overhead of the SHORT_BSR, which is 5 bytes (if the BSR goes in this stream).
+  NS_ASSERT_MSG (m_ulDciTotalUsed + bsrSize <= m_ulDci->m_tbSize.at (m_ulDciStream),
                  "The StatusPDU used " << m_ulDciTotalUsed << " B, we don't have any for the SHORT_BSR.");
-  uint32_t usefulTbs = m_ulDci->m_tbSize.at (0) - m_ulDciTotalUsed - 5;
+  uint32_t usefulTbs = m_ulDci->m_tbSize.at (m_ulDciStream) - m_ulDciTotalUsed - bsrSize;
 
   // Now, we have 3 bytes of overhead for each subPDU. Let's try to serve all
   // the queues with some RETX data.
@@ -1047,9 +1143,9 @@ NrUeMac::SendNewData ()
   // Now we have to update our useful TBS for the next transmission.
   // Remember that m_ulDciTotalUsed keep count of data and overhead that we
   // used till now.
-  NS_ASSERT_MSG (m_ulDciTotalUsed + 5 <= m_ulDci->m_tbSize.at (0),
+  NS_ASSERT_MSG (m_ulDciTotalUsed + bsrSize <= m_ulDci->m_tbSize.at (m_ulDciStream),
                  "The StatusPDU sending required all space, we don't have any for the SHORT_BSR.");
-  usefulTbs = m_ulDci->m_tbSize.at (0) - m_ulDciTotalUsed - 5; // Update the usefulTbs.
+  usefulTbs = m_ulDci->m_tbSize.at (m_ulDciStream) - m_ulDciTotalUsed - bsrSize; // Update the usefulTbs.
 
   // The last part is for the queues with some non-RETX data. If there is no space left,
   // then nothing.
@@ -1068,8 +1164,8 @@ NrUeMac::SendNewData ()
   // retx, if any.
   if (m_ulDciTotalUsed == 0)
     {
-      m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_pktBurst = nullptr;
-      m_miUlHarqProcessesPacket.at (m_ulDci->m_harqProcess).m_lcidList.clear ();
+      harqInfo.m_pktBurst = nullptr;
+      harqInfo.m_lcidList.clear ();
     }
 }
 
@@ -1091,13 +1187,13 @@ NrUeMac::SendNewStatusData()
           hasStatusPdu = true;
 
           // Check if we have room to transmit the statusPdu
-          if (m_ulDciTotalUsed + bsr.statusPduSize <= m_ulDci->m_tbSize.at (0))
+          if (m_ulDciTotalUsed + bsr.statusPduSize <= m_ulDci->m_tbSize.at (m_ulDciStream))
             {
               LteMacSapUser::TxOpportunityParameters txParams;
               txParams.lcid = bsr.lcid;
               txParams.rnti = m_rnti;
               txParams.bytes = bsr.statusPduSize;
-              txParams.layer = 0;
+              txParams.layer = m_ulDciStream;
               txParams.harqId = m_ulDci->m_harqProcess;
               txParams.componentCarrierId = GetBwpId ();
 
@@ -1120,7 +1216,7 @@ NrUeMac::SendNewStatusData()
     }
 
   NS_ABORT_MSG_IF (hasStatusPdu && !sentOneStatusPdu,
-                   "The TBS of size " << m_ulDci->m_tbSize.at (0) << " doesn't allow us "
+                   "The TBS of size " << m_ulDci->m_tbSize.at (m_ulDciStream) << " doesn't allow us "
                    "to send one status PDU...");
 }
 
@@ -1257,12 +1353,203 @@ NrUeMac::AssignStreams (int64_t stream)
   m_raPreambleUniformVariable ->SetStream (stream);
   return 1;
 }
+
+void
+NrUeMac::SaveState (NrCheckpointWriter &writer) const
+{
+  NS_LOG_FUNCTION (this);
+
+  uint64_t now = m_currentSlot.Normalize ();
+  writer.WriteU32 (static_cast<uint32_t> (m_sensingData.size ()));
+  for (const auto & data : m_sensingData)
+    {
+      writer.WriteU32 (static_cast<uint32_t> (now - data.sfn.Normalize ()));
+      writer.WriteU16 (data.rsvp);
+      writer.WriteU8 (data.sbChLength);
+      writer.WriteU8 (data.sbChStart);
+      writer.WriteU8 (data.prio);
+      writer.WriteDouble (data.slRsrp);
+      writer.WriteU8 (data.gapReTx1);
+      writer.WriteU8 (data.sbChStartReTx1);
+      writer.WriteU8 (data.gapReTx2);
+      writer.WriteU8 (data.sbChStartReTx2);
+    }
+}
+
+void
+NrUeMac::RestoreState (NrCheckpointReader &reader)
+{
+  NS_LOG_FUNCTION (this);
+
+  uint64_t now = m_currentSlot.Normalize ();
+  m_sensingData.clear ();
+
+  uint32_t numEntries = reader.ReadU32 ();
+  for (uint32_t i = 0; i < numEntries; ++i)
+    {
+      uint32_t age = reader.ReadU32 ();
+      uint16_t rsvp = reader.ReadU16 ();
+      uint8_t sbChLength = reader.ReadU8 ();
+      uint8_t sbChStart = reader.ReadU8 ();
+      uint8_t prio = reader.ReadU8 ();
+      double slRsrp = reader.ReadDouble ();
+      uint8_t gapReTx1 = reader.ReadU8 ();
+      uint8_t sbChStartReTx1 = reader.ReadU8 ();
+      uint8_t gapReTx2 = reader.ReadU8 ();
+      uint8_t sbChStartReTx2 = reader.ReadU8 ();
+
+      if (age > now)
+        {
+          continue; // older than the beginning of this simulation
+        }
+
+      SfnSf sfn (0, 0, 0, m_currentSlot.GetNumerology ());
+      sfn.Add (static_cast<uint32_t> (now - age));
+      // The list is ordered from the oldest entry, as in the checkpoint
+      m_sensingData.emplace_back (sfn, rsvp, sbChLength, sbChStart, prio, slRsrp,
+                                  gapReTx1, sbChStartReTx1, gapReTx2, sbChStartReTx2);
+    }
+}
 //NR SL
 
+std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>
+NrUeMac::ExcludeSensedCandidates (const std::vector<std::list<SlotSensingData>> &sensingData,
+                                  const std::vector<NrSlUeMacSchedSapProvider::NrSlSlotInfo> &candidates,
+                                  uint16_t pPrimeRsvpTx, uint16_t cResel, uint8_t totalSubCh,
+                                  int rsrpThreshold, double minCandidates)
+{
+  NS_LOG_FUNCTION (sensingData.size () << candidates.size () << pPrimeRsvpTx << cResel << +totalSubCh << rsrpThreshold);
+
+  std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> selected;
+
+  //Index the sensed transmissions by their absolute slot, keeping the
+  //index of their SCI and their position in the list of the SCI
+  struct SensedTx
+  {
+    uint32_t sciIndex {0};    //!< The index of the SCI in sensingData
+    uint16_t candTxIndex {0}; //!< The index of the future transmission of the candidate
+    uint32_t txIndex {0};     //!< The index of the transmission in the list of the SCI
+    uint8_t sbChStart {0};    //!< The starting sub-channel
+    uint8_t sbChLength {0};   //!< The number of sub-channels
+    double slRsrp {0.0};      //!< The RSRP of the SCI
+  };
+  std::unordered_map<uint64_t, std::vector<SensedTx>> sensedTxPerSlot;
+  for (uint32_t sciIndex = 0; sciIndex < sensingData.size (); ++sciIndex)
+    {
+      uint32_t txIndex = 0;
+      for (const auto &itFutureSensTx : sensingData.at (sciIndex))
+        {
+          SensedTx sensedTx;
+          sensedTx.sciIndex = sciIndex;
+          sensedTx.txIndex = txIndex++;
+          sensedTx.sbChStart = itFutureSensTx.sbChStart;
+          sensedTx.sbChLength = itFutureSensTx.sbChLength;
+          sensedTx.slRsrp = itFutureSensTx.slRsrp;
+          sensedTxPerSlot[itFutureSensTx.sfn.Normalize ()].push_back (sensedTx);
+        }
+    }
+
+  //The sub-channels occupied in each candidate slot do not depend on the
+  //RSRP threshold, hence they are computed once. A candidate is excluded
+  //if all its sub-channels are occupied and a sensed transmission, from
+  //the one that filled the last free sub-channel on, has an RSRP above
+  //the threshold; exclusionRsrp is the highest of these RSRPs.
+  NrSlCandidateResourceSet candSet (candidates.size (), totalSubCh);
+  std::vector<double> exclusionRsrp (candidates.size (), std::numeric_limits<double>::lowest ());
+  std::vector<SensedTx> overlapping;
+  for (uint32_t cand = 0; cand < candidates.size (); ++cand)
+    {
+      // all proposed transmissions of current candidate resource
+      overlapping.clear ();
+      for (uint16_t i = 0; i < cResel; i++)
+        {
+          SfnSf futureCand = candidates.at (cand).sfn;
+          futureCand.Add (i * pPrimeRsvpTx);
+          auto itSensedTx = sensedTxPerSlot.find (futureCand.Normalize ());
+          if (itSensedTx == sensedTxPerSlot.end ())
+            {
+              continue;
+            }
+          for (auto sensedTx : itSensedTx->second)
+            {
+              sensedTx.candTxIndex = i;
+              overlapping.push_back (sensedTx);
+            }
+        }
+      //visit them in the order of the sensed SCIs
+      std::sort (overlapping.begin (), overlapping.end (),
+                 [] (const SensedTx &a, const SensedTx &b)
+                 {
+                   if (a.sciIndex != b.sciIndex)
+                     {
+                       return a.sciIndex < b.sciIndex;
+                     }
+                   if (a.candTxIndex != b.candTxIndex)
+                     {
+                       return a.candTxIndex < b.candTxIndex;
+                     }
+                   return a.txIndex < b.txIndex;
+                 });
+      for (const auto &sensedTx : overlapping)
+        {
+          NS_LOG_DEBUG ("Overlapped Slot " << candidates.at (cand).sfn.Normalize () << " occupied " << +sensedTx.sbChLength << " subchannels index " << +sensedTx.sbChStart);
+          candSet.Occupy (cand, sensedTx.sbChStart, sensedTx.sbChLength);
+          if (candSet.IsFullyOccupied (cand))
+            {
+              exclusionRsrp.at (cand) = std::max (exclusionRsrp.at (cand), sensedTx.slRsrp);
+            }
+        }
+    }
+
+  //step 6
+  uint32_t numCandidates = 0;
+  do
+    {
+      //following reset is needed since we might have to perform
+      //multiple do-while over the same candidates by increasing the rsrpThreshold
+      candSet.SetAllCandidates ();
+      for (uint32_t cand = 0; cand < candidates.size (); ++cand)
+        {
+          if (exclusionRsrp.at (cand) > rsrpThreshold)
+            {
+              NS_LOG_DEBUG ("Absolute slot number " << candidates.at (cand).sfn.Normalize () << " erased. Its rsrp : " << exclusionRsrp.at (cand) << " Threshold : " << rsrpThreshold);
+              candSet.Exclude (cand);
+            }
+        }
+      numCandidates = candSet.GetNumCandidates ();
+      //step 7. If the following while will not break, start over do-while
+      //loop with rsrpThreshold increased by 3dB
+      rsrpThreshold += 3;
+      if (rsrpThreshold > 0)
+        {
+          //0 dBm is the maximum RSRP threshold level so if we reach
+          //it, that means all the available slots are overlapping
+          //in time and frequency with the sensed slots, and the
+          //RSRP of the sensed slots is very high.
+          NS_LOG_DEBUG ("Reached maximum RSRP threshold, unable to select resources");
+          if (candidates.size () > 0)
+            {
+              candSet.ExcludeRange (0, candidates.size () - 1);
+            }
+          break; //break do while
+        }
+    }
+  while (numCandidates < minCandidates);
+
+  for (const auto &cand : candSet.GetCandidates ())
+    {
+      NrSlUeMacSchedSapProvider::NrSlSlotInfo info = candidates.at (cand);
+      info.occupiedSbCh = candSet.GetOccupiedSubCh (cand);
+      selected.emplace_back (info);
+    }
+  return selected;
+}
+
 std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>
 NrUeMac::GetNrSlTxOpportunities (const SfnSf& sfn)
 {
   NS_LOG_FUNCTION (this << sfn.GetFrame() << +sfn.GetSubframe() << sfn.GetSlot ());
+  NR_PROFILE_SCOPE (UE_MAC_SL_SENSING);
 
   //NR module supported candSsResoA list
   std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> nrCandSsResoA;
@@ -1342,89 +1629,16 @@ NrUeMac::GetNrSlTxOpportunities (const SfnSf& sfn)
       //step 5 point 1: We don't need to implement it since we only sense those
       //slots at which this UE does not transmit. This is due to the half
       //duplex nature of the PHY.
-      //step 6
-      do
-        {
-          //following assignment is needed since we might have to perform
-          //multiple do-while over the same list by increasing the rsrpThrehold
-          candSsResoA = allTxOpps;
-          nrCandSsResoA = GetNrSupportedList (sfn, candSsResoA);
-          auto itCandSsResoA = nrCandSsResoA.begin ();
-          while (itCandSsResoA != nrCandSsResoA.end ())
-            {
-              bool erased = false;
-              // calculate all proposed transmissions of current candidate resource
-              std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> listFutureCands;
-              uint16_t pPrimeRsvpTx = m_slTxPool->GetResvPeriodInSlots (GetBwpId (),
-                                                                        m_poolId,
-                                                                        m_pRsvpTx,
-                                                                        m_nrSlUePhySapProvider->GetSlotPeriod ());
-              for (uint16_t i = 0; i < m_cResel; i++)
-                {
-                  auto slAlloc = *itCandSsResoA;
-                  slAlloc.sfn.Add (i * pPrimeRsvpTx);
-                  listFutureCands.emplace_back (slAlloc);
-                }
-              // Traverse over all the possible transmissions of each sensed SCI
-              for (const auto &itSensedData:allSensingData)
-                {
-                  // for all proposed transmissions of current candidate resource
-                  for (auto &itFutureCand:listFutureCands)
-                    {
-                      for (const auto &itFutureSensTx:itSensedData)
-                        {
-                          if (itFutureCand.sfn.Normalize () == itFutureSensTx.sfn.Normalize ())
-                            {
-                              uint16_t lastSbChInPlusOne = itFutureSensTx.sbChStart + itFutureSensTx.sbChLength;
-                              for (uint8_t i = itFutureSensTx.sbChStart; i < lastSbChInPlusOne; i++)
-                                {
-                                  NS_LOG_DEBUG (this << " Overlapped Slot " << itCandSsResoA->sfn.Normalize () << " occupied " << +itFutureSensTx.sbChLength << " subchannels index " << +itFutureSensTx.sbChStart);
-                                  itCandSsResoA->occupiedSbCh.insert (i);
-                                }
-                              if (itCandSsResoA->occupiedSbCh.size () == GetTotalSubCh (m_poolId))
-                                {
-                                  if(itFutureSensTx.slRsrp > rsrpThrehold)
-                                    {
-                                      itCandSsResoA = nrCandSsResoA.erase (itCandSsResoA);
-                                      erased = true;
-                                      NS_LOG_DEBUG ("Absolute slot number " << itFutureCand.sfn.Normalize () << " erased. Its rsrp : " << itFutureSensTx.slRsrp << " Threshold : " << rsrpThrehold);
-                                      //stop traversing over sensing data as we have
-                                      //already found the slot to exclude.
-                                      break; // break for (const auto &itFutureSensTx:listFutureSensTx)
-                                    }
-                                }
-                            }
-                        }
-                      if (erased)
-                        {
-                          break; // break for (const auto &itFutureCand:listFutureCands)
-                        }
-                    }
-                  if (erased)
-                    {
-                      break; // break for (const auto &itSensedSlot:allSensingData)
-                    }
-                }
-              if (!erased)
-                {
-                  itCandSsResoA++;
-                }
-            }
-          //step 7. If the following while will not break, start over do-while
-          //loop with rsrpThreshold increased by 3dB
-          rsrpThrehold += 3;
-          if (rsrpThrehold > 0)
-            {
-              //0 dBm is the maximum RSRP threshold level so if we reach
-              //it, that means all the available slots are overlapping
-              //in time and frequency with the sensed slots, and the
-              //RSRP of the sensed slots is very high.
-              NS_LOG_DEBUG ("Reached maximum RSRP threshold, unable to select resources");
-              nrCandSsResoA.erase (nrCandSsResoA.begin (), nrCandSsResoA.end ());
-              break; //break do while
-            }
-        }
-      while (nrCandSsResoA.size () < (GetResourcePercentage () / 100.0) * mTotal);
+
+      std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> nrSupportedList = GetNrSupportedList (sfn, allTxOpps);
+      std::vector <NrSlUeMacSchedSapProvider::NrSlSlotInfo> candidates (nrSupportedList.begin (), nrSupportedList.end ());
+      uint16_t pPrimeRsvpTx = m_slTxPool->GetResvPeriodInSlots (GetBwpId (),
+                                                                m_poolId,
+                                                                m_pRsvpTx,
+                                                                m_nrSlUePhySapProvider->GetSlotPeriod ());
+      nrCandSsResoA = ExcludeSensedCandidates (allSensingData, candidates, pPrimeRsvpTx, m_cResel,
+                                               GetTotalSubCh (m_poolId), rsrpThrehold,
+                                               (GetResourcePercentage () / 100.0) * mTotal);
 
       NS_LOG_DEBUG (nrCandSsResoA.size () << " slots selected after sensing resource selection from " << mTotal << " slots");
     }
@@ -1435,6 +1649,7 @@ NrUeMac::GetNrSlTxOpportunities (const SfnSf& sfn)
       NS_LOG_DEBUG ("No sensing: Total slots selected " << nrCandSsResoA.size ());
     }
 
+  NR_PROFILE_COUNT (UE_MAC_SL_CANDIDATES, nrCandSsResoA.size ());
   return nrCandSsResoA;
 }
 
@@ -1503,11 +1718,18 @@ NrUeMac::GetNrSupportedList (const SfnSf& sfn, std::list <NrSlCommResourcePool::
   for (const auto& it:slotInfo)
     {
       std::set <uint8_t> emptySet;
+      SfnSf slotSfn = sfn.GetFutureSfnSf (it.slotOffset);
+      uint16_t psschSymLength = it.slPsschSymLength;
+      if (m_slPsfchConfig.IsPsfchSlot (slotSfn.Normalize ()))
+        {
+          //the end of the slot is used by the PSFCH
+          psschSymLength -= NrSlPsfchConfig::PSFCH_OVERHEAD_SYMBOLS;
+        }
       NrSlUeMacSchedSapProvider::NrSlSlotInfo info (it.numSlPscchRbs, it.slPscchSymStart,
                                                     it.slPscchSymLength, it.slPsschSymStart,
-                                                    it.slPsschSymLength, it.slSubchannelSize,
+                                                    psschSymLength, it.slSubchannelSize,
                                                     it.slMaxNumPerReserve,
-                                                    sfn.GetFutureSfnSf (it.slotOffset),
+                                                    slotSfn,
                                                     emptySet);
       nrSupportedList.emplace_back (info);
     }
@@ -1527,6 +1749,20 @@ NrUeMac::DoReceiveSensingData (SensingData sensingData)
     }
 }
 
+void
+NrUeMac::DoReceivePsfch (const NrSlInfoListElement_s &feedback)
+{
+  NS_LOG_FUNCTION (this << feedback.dstL2Id << +feedback.harqProcessId);
+
+  if (feedback.srcl2Id != m_srcL2Id)
+    {
+      NS_LOG_DEBUG ("Ignoring the HARQ feedback for the source " << feedback.srcl2Id);
+      return;
+    }
+  m_nrSlHarq->StoreNrSlHarqFeedback (feedback);
+  m_nrSlUeMacSchedSapProvider->SchedUeNrSlHarqFeedbackInd (feedback);
+}
+
 void
 NrUeMac::UpdateSensingWindow (const SfnSf& sfn)
 {
@@ -1662,6 +1898,7 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
           NS_LOG_INFO ("Grant at : Frame = " << currentSlot.sfn.GetFrame ()
                        << " SF = " << +currentSlot.sfn.GetSubframe ()
                        << " slot = " << currentSlot.sfn.GetSlot ());
+          bool harqFeedback = IsNrSlHarqFeedbackEnabled (currentSlot.dstL2Id, itGrant.first.second);
           if (currentSlot.ndi)
             {
               Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
@@ -1674,8 +1911,22 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
                     {
                       m_nrSlUePhySapProvider->SendPsschMacPdu (itPkt);
                     }
+                  if (harqFeedback)
+                    {
+                      m_nrSlHarq->RecordNrSlTx (currentSlot.dstL2Id, currentGrant.nrSlHarqId, sfn,
+                                                GetNrSlNumFeedbackReceivers (currentSlot.dstL2Id, itGrant.first.second),
+                                                GetNrSlPsfchSlot (sfn));
+                    }
                 }
               itGrant.second.front ().tbTxCounter++;
+              if (currentGrant.tbTxCounter == currentGrant.nSelected)
+                {
+                  //the grant has no slot for retransmissions, release the
+                  //HARQ process, as for the last retransmission below
+                  NS_LOG_INFO ("No retransmission for HARQ id " << +currentGrant.nrSlHarqId);
+                  m_nrSlHarq->RecvNrSlHarqFeedback (currentSlot.dstL2Id, currentGrant.nrSlHarqId);
+                  itGrant.second.pop ();
+                }
             }
           else
             {
@@ -1687,8 +1938,29 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
               itGrant.second.front ().tbTxCounter++;
               Ptr<PacketBurst> pb = CreateObject <PacketBurst> ();
               pb = m_nrSlHarq->GetPacketBurst (currentSlot.dstL2Id, currentGrant.nrSlHarqId);
-              if (m_enableBlindReTx)
+              NrSlInfoListElement_s::HarqStatus_e harqStatus = NrSlInfoListElement_s::INVALID;
+              if (harqFeedback)
                 {
+                  harqStatus = m_nrSlHarq->GetNrSlHarqStatus (currentSlot.dstL2Id, currentGrant.nrSlHarqId,
+                                                              sfn.Normalize ());
+                }
+              if (harqStatus == NrSlInfoListElement_s::ACK)
+                {
+                  //the receivers decoded the TB, so we release the HARQ process
+                  //and the remaining retransmission slots of this grant
+                  NS_LOG_INFO ("HARQ id " << +currentGrant.nrSlHarqId << " acknowledged, dropping the remaining "
+                               << itGrant.second.front ().slotAllocations.size () + 1 << " retransmission slot(s)");
+                  m_nrSlHarq->RecvNrSlHarqFeedback (currentSlot.dstL2Id, currentGrant.nrSlHarqId);
+                  itGrant.second.pop ();
+                  continue;
+                }
+              if (m_enableBlindReTx || harqFeedback)
+                {
+                  //blind retransmission, or no ACK (a NACK, a feedback
+                  //missing after the PSFCH occasion, or a feedback which
+                  //may still arrive) for the previous transmission
+                  NS_LOG_INFO ("Retransmitting HARQ id " << +currentGrant.nrSlHarqId
+                               << (harqStatus == NrSlInfoListElement_s::NACK ? " after a NACK" : ""));
                   if (pb->GetNPackets () > 0)
                     {
                       m_nrSlMacPduTxed = true;
@@ -1697,6 +1969,12 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
                         {
                           m_nrSlUePhySapProvider->SendPsschMacPdu (itPkt);
                         }
+                      if (harqFeedback)
+                        {
+                          m_nrSlHarq->RecordNrSlTx (currentSlot.dstL2Id, currentGrant.nrSlHarqId, sfn,
+                                                    GetNrSlNumFeedbackReceivers (currentSlot.dstL2Id, itGrant.first.second),
+                                                    GetNrSlPsfchSlot (sfn));
+                        }
                     }
                   else
                     {
@@ -1708,6 +1986,8 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
                       //HARQ buffer, which make the HARQ id available again
                       //since we assign the HARQ id even in the end
                       //RLC buffer is empty. See the for loop above to trigger RLC.
+                      //With the HARQ feedback, the feedback of the last
+                      //transmission would not change anything.
                       NS_LOG_INFO ("sending fake HARQ feedback for HARQ id " << +currentGrant.nrSlHarqId);
                       m_nrSlHarq->RecvNrSlHarqFeedback (currentSlot.dstL2Id, currentGrant.nrSlHarqId);
                       // Remove this grant from the queue
@@ -1718,7 +1998,8 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
                 {
                   //we need to have a feedback to do the retx when blind retx
                   //are not enabled.
-                  NS_FATAL_ERROR ("Feedback based retransmissions are not supported");
+                  NS_FATAL_ERROR ("Feedback based retransmissions require a pool with PSFCH resources"
+                                  " and a unicast or groupcast LC with HARQ enabled");
                 }
             }
 
@@ -1736,10 +2017,10 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
           sciF2a.SetRv (currentSlot.rv);
           sciF2a.SetSrcId (m_srcL2Id);
           sciF2a.SetDstId (currentSlot.dstL2Id);
+          sciF2a.SetHarqFbIndicator (harqFeedback ? 1 : 0);
+          sciF2a.SetCastType (GetSciCastType (currentSlot.dstL2Id, itGrant.first.second));
           //fields which are not used yet that is why we set them to 0
           sciF2a.SetCsiReq (0);
-          sciF2a.SetHarqFbIndicator (0);
-          sciF2a.SetCastType (NrSlSciF2aHeader::Broadcast);
           Ptr<Packet> pktSciF02 = Create<Packet> ();
           pktSciF02->AddHeader (sciF2a);
           //put SCI stage 2 in PSSCH queue
@@ -1751,6 +2032,10 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
           dataVarTtiInfo.symStart = currentSlot.slPsschSymStart;
           dataVarTtiInfo.symLength = currentSlot.slPsschSymLength;
           dataVarTtiInfo.symLength = 12;
+          if (m_slPsfchConfig.IsPsfchSlot (sfn.Normalize ()))
+            {
+              dataVarTtiInfo.symLength -= NrSlPsfchConfig::PSFCH_OVERHEAD_SYMBOLS;
+            }
           dataVarTtiInfo.rbStart = currentSlot.slPsschSubChStart * m_slTxPool->GetNrSlSubChSize (GetBwpId (), m_poolId);
           dataVarTtiInfo.rbLength = currentSlot.slPsschSubChLength * m_slTxPool->GetNrSlSubChSize (GetBwpId (), m_poolId);
           m_nrSlUePhySapProvider->SetNrSlVarTtiAllocInfo (sfn, dataVarTtiInfo);
@@ -1864,6 +2149,70 @@ NrUeMac::DoNrSlSlotIndication (const SfnSf& sfn)
     }
 }
 
+bool
+NrUeMac::IsNrSlHarqFeedbackEnabled (uint32_t dstL2Id, uint8_t lcId) const
+{
+  if (m_enableBlindReTx || !m_slPsfchConfig.IsEnabled ())
+    {
+      return false;
+    }
+  SidelinkLcIdentifier slLcId;
+  slLcId.lcId = lcId;
+  slLcId.srcL2Id = m_srcL2Id;
+  slLcId.dstL2Id = dstL2Id;
+  const auto itLc = m_nrSlLcInfoMap.find (slLcId);
+  NS_ASSERT_MSG (itLc != m_nrSlLcInfoMap.end (), "No LC with id " << +lcId << " found for destination " << dstL2Id);
+  const auto &lcInfo = itLc->second.lcInfo;
+  return lcInfo.harqEnabled && (lcInfo.castType == SidelinkInfo::CastType::Unicast
+                                || lcInfo.castType == SidelinkInfo::CastType::Groupcast);
+}
+
+uint8_t
+NrUeMac::GetSciCastType (uint32_t dstL2Id, uint8_t lcId) const
+{
+  SidelinkLcIdentifier slLcId;
+  slLcId.lcId = lcId;
+  slLcId.srcL2Id = m_srcL2Id;
+  slLcId.dstL2Id = dstL2Id;
+  const auto itLc = m_nrSlLcInfoMap.find (slLcId);
+  NS_ASSERT_MSG (itLc != m_nrSlLcInfoMap.end (), "No LC with id " << +lcId << " found for destination " << dstL2Id);
+  switch (itLc->second.lcInfo.castType)
+    {
+    case SidelinkInfo::CastType::Unicast:
+      return NrSlSciF2aHeader::Unicast;
+    case SidelinkInfo::CastType::Groupcast:
+      return NrSlSciF2aHeader::Groupcast;
+    default:
+      return NrSlSciF2aHeader::Broadcast;
+    }
+}
+
+uint16_t
+NrUeMac::GetNrSlNumFeedbackReceivers (uint32_t dstL2Id, uint8_t lcId) const
+{
+  if (GetSciCastType (dstL2Id, lcId) == NrSlSciF2aHeader::Unicast)
+    {
+      return 1;
+    }
+  const auto it = m_nrSlNumGroupMembers.find (dstL2Id);
+  return it == m_nrSlNumGroupMembers.end () ? 0 : it->second;
+}
+
+uint64_t
+NrUeMac::GetNrSlPsfchSlot (const SfnSf &sfn) const
+{
+  uint64_t psfchSlot = sfn.Normalize () + m_slPsfchConfig.minTimeGap;
+  //search within one SFN cycle (1024 frames of 10 subframes)
+  const uint64_t lastSlot = psfchSlot + 10240 * static_cast<uint64_t> (1 << sfn.GetNumerology ());
+  while (!(m_slPsfchConfig.IsPsfchSlot (psfchSlot)
+           && m_slTxPool->IsSidelinkSlot (GetBwpId (), m_poolId, psfchSlot)))
+    {
+      ++psfchSlot;
+      NS_ABORT_MSG_IF (psfchSlot > lastSlot, "Unable to find a PSFCH slot after " << sfn);
+    }
+  return psfchSlot;
+}
+
 std::vector<uint8_t>
 NrUeMac::ComputeGaps (const SfnSf& sfn,
                       std::set <NrSlSlotAlloc>::const_iterator it, uint8_t slotNumInd)
@@ -2239,6 +2588,14 @@ NrUeMac::DoGetSlMaxTxTransNumPssch () const
   NS_LOG_FUNCTION (this);
   return m_slMaxTxTransNumPssch;
 }
+
+uint16_t
+NrUeMac::DoGetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const
+{
+  NS_LOG_FUNCTION (this << dstL2Id << +lcId);
+  return IsNrSlHarqFeedbackEnabled (dstL2Id, lcId) ? m_slPsfchConfig.GetMinReTxGap () : 0;
+}
+
 void
 NrUeMac::DoCschedUeNrSlLcConfigCnf (uint8_t lcg, uint8_t lcId)
 {
@@ -2254,6 +2611,26 @@ NrUeMac::EnableSensing (bool enableSensing)
   m_enableSensing = enableSensing;
 }
 
+void
+NrUeMac::SetNrSlPsfchConfig (const NrSlPsfchConfig &psfchConfig)
+{
+  NS_LOG_FUNCTION (this << psfchConfig.period << psfchConfig.minTimeGap);
+  m_slPsfchConfig = psfchConfig;
+}
+
+const NrSlPsfchConfig &
+NrUeMac::GetNrSlPsfchConfig () const
+{
+  return m_slPsfchConfig;
+}
+
+void
+NrUeMac::SetNrSlNumGroupMembers (uint32_t dstL2Id, uint16_t numMembers)
+{
+  NS_LOG_FUNCTION (this << dstL2Id << numMembers);
+  m_nrSlNumGroupMembers[dstL2Id] = numMembers;
+}
+
 void
 NrUeMac::EnableBlindReTx (bool enableBlindReTx)
 {
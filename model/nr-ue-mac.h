@@ -22,6 +22,7 @@
 
 #include "nr-phy-mac-common.h"
 #include "nr-mac-pdu-info.h"
+#include "nr-checkpoint.h"
 
 #include <ns3/lte-ue-cmac-sap.h>
 #include <ns3/lte-ccm-mac-sap.h>
@@ -214,6 +215,14 @@ public:
   typedef void (* TxedUeMacCtrlMsgsTracedCallback)
     (const SfnSf sfnSf, const uint16_t nodeId, const uint16_t rnti,
      const uint8_t bwpId, Ptr<NrControlMessage> ctrlMessage);
+  /**
+   *  TracedCallback signature for the outcome of the UL HARQ transmissions.
+   * \param [in] harqId the HARQ process ID
+   * \param [in] stream the stream of the TB
+   * \param [in] nack true if the gNB asked for a retransmission of the TB
+   */
+  typedef void (* UlHarqFeedbackTracedCallback)
+    (uint8_t harqId, uint8_t stream, bool nack);
 
   /**
    * \brief Sets the number of HARQ processes.
@@ -230,6 +239,21 @@ public:
    */
   uint8_t GetNumHarqProcess () const;
 
+  /**
+   * \brief Set the maximum number of PUSCH layers (UL rank)
+   *
+   * Each UL HARQ process keeps the packets of this number of streams. It
+   * must be the UlMaxRank of the scheduler of the gNB.
+   *
+   * \param ulMaxRank the maximum UL rank (1 or 2)
+   */
+  void SetUlMaxRank (uint8_t ulMaxRank);
+
+  /**
+   * \return the maximum number of PUSCH layers (UL rank)
+   */
+  uint8_t GetUlMaxRank () const;
+
   /**
    * \brief Assign a fixed random variable stream number to the random variables
    * used by this model. Returns the number of streams (possibly zero) that
@@ -240,6 +264,45 @@ public:
    */
   int64_t AssignStreams (int64_t stream);
 
+  /**
+   * \brief Save the sidelink sensing data, for a later warm start
+   * \param writer the checkpoint writer
+   *
+   * The slot of each sensing entry is saved as its age, in slots, with
+   * respect to the current slot. The sidelink grants are not saved: they
+   * are tied to HARQ processes and buffers that are not part of the
+   * checkpoint, and are selected again when needed.
+   */
+  void SaveState (NrCheckpointWriter &writer) const;
+
+  /**
+   * \brief Restore the sensing data saved by SaveState, relative to the
+   * current slot
+   * \param reader the checkpoint reader
+   */
+  void RestoreState (NrCheckpointReader &reader);
+
+  /**
+   * \brief Exclude the candidate resources overlapping with the sensed
+   *        transmissions (steps 5 to 7 of the sensing-based selection)
+   * \param sensingData for each sensed SCI, the list of its future transmissions
+   * \param candidates the candidate single-slot resources
+   * \param pPrimeRsvpTx the resource reservation period of this UE, in slots
+   * \param cResel the number of reservations of this UE
+   * \param totalSubCh the number of sub-channels of the pool
+   * \param rsrpThreshold the initial RSRP threshold, in dBm
+   * \param minCandidates the minimum number of candidates to keep
+   * \return the remaining candidates, with their occupied sub-channels
+   *
+   * The RSRP threshold is raised by 3 dB until at least minCandidates
+   * candidates remain; if it goes above 0 dBm, no candidate is returned.
+   */
+  static std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo>
+  ExcludeSensedCandidates (const std::vector<std::list<SlotSensingData>> &sensingData,
+                           const std::vector<NrSlUeMacSchedSapProvider::NrSlSlotInfo> &candidates,
+                           uint16_t pPrimeRsvpTx, uint16_t cResel, uint8_t totalSubCh,
+                           int rsrpThreshold, double minCandidates);
+
 protected:
   /**
    * \brief DoDispose method inherited from Object
@@ -347,6 +410,8 @@ private:
    * header overhead. After sending new data, the method is allowed to enqueue
    * a BSR if there are still bytes in the queue.
    *
+   * With UL MIMO, the DCI carries one TB per stream: the TBs are filled one
+   * after the other, starting from the first stream, that also carries the BSR.
    */
   void ProcessUlDci (const Ptr<NrUlDciMessage> &dciMsg);
 
@@ -354,8 +419,8 @@ private:
    * \brief Transmit a retransmission (good joke, eh?)
    *
    * The method uses the DCI stored in m_ulDci to take the HARQ process id,
-   * preparing the subPDUs that are waiting in such HARQ process,
-   * and sending them again.
+   * preparing the subPDUs that are waiting in such HARQ process for the
+   * stream m_ulDciStream, and sending them again.
    */
   void TransmitRetx ();
 
@@ -366,11 +431,13 @@ private:
    * and with a very rough estimation, tries to allocate data to all the active
    * LCID.
    *
+   * \param bsrSize the space to leave in the TB for the BSR
+   *
    * \see SendNewStatusData()
    * \see SendRetxData()
    * \see SendTxData()
    */
-  void SendNewData ();
+  void SendNewData (uint32_t bsrSize);
 
   /**
    * \brief Send STATUS PDUs
@@ -416,10 +483,12 @@ private:
 
   SfnSf m_currentSlot;  //!< The current slot
   uint8_t m_numHarqProcess {20}; //!< number of HARQ processes
+  uint8_t m_ulMaxRank {1};       //!< Maximum UL rank, i.e., streams per UL HARQ process
 
   std::shared_ptr<DciInfoElementTdma> m_ulDci; //!< Received a DCI. While we process it, store it here.
   SfnSf m_ulDciSfnsf;             //!< Received a DCI for transmitting data in this slot.
-  uint32_t m_ulDciTotalUsed {0};      //!< Received a DCI, put the total count of bytes we sent.
+  uint32_t m_ulDciTotalUsed {0};      //!< Received a DCI, put the total count of bytes we sent in the stream m_ulDciStream.
+  uint8_t m_ulDciStream {0};          //!< Received a DCI, the stream whose TB we are filling.
 
   std::unordered_map <uint8_t, LteMacSapProvider::ReportBufferStatusParameters> m_ulBsrReceived; //!< BSR received from RLC (the last one)
 
@@ -455,12 +524,19 @@ private:
   uint64_t m_imsi {0};        ///< IMSI
 
   // The HARQ part has to be reviewed
-  struct UlHarqProcessInfo
+  struct UlHarqProcessInfoSingleStream
   {
     Ptr<PacketBurst> m_pktBurst;
     // maintain list of LCs contained in this TB
     // used to signal HARQ failure to RLC handlers
     std::vector<uint8_t> m_lcidList;
+    // a TB was sent, and the next UL DCI of the process tells its outcome
+    bool m_waitingFeedback {false};
+  };
+
+  struct UlHarqProcessInfo
+  {
+    std::vector<UlHarqProcessInfoSingleStream> m_infoPerStream;
   };
 
   //uint8_t m_harqProcessId;
@@ -493,6 +569,12 @@ private:
    */
   TracedCallback<SfnSf, uint16_t, uint16_t, uint8_t, Ptr<const NrControlMessage>> m_macTxedCtrlMsgsTrace;
 
+  /**
+   * Trace of the outcome of the UL HARQ transmissions, given by the NDI of
+   * the next UL DCI of the same HARQ process: HARQ process ID, stream, NACK
+   */
+  TracedCallback<uint8_t, uint8_t, bool> m_ulHarqFeedbackTrace;
+
   //NR SL
 public:
   /**
@@ -662,6 +744,38 @@ public:
    */
   uint16_t GetSlActivePoolId () const;
 
+  /**
+   * \brief Set the PSFCH configuration of the active pool
+   *
+   * When the pool has PSFCH resources and blind retransmissions are
+   * disabled, the TBs of the unicast and groupcast LCs with HARQ enabled
+   * request the HARQ feedback of the receivers, and they are retransmitted
+   * only until they are acknowledged.
+   *
+   * \param psfchConfig The PSFCH configuration
+   */
+  void SetNrSlPsfchConfig (const NrSlPsfchConfig &psfchConfig);
+
+  /**
+   * \brief Get the PSFCH configuration of the active pool
+   * \return the PSFCH configuration
+   */
+  const NrSlPsfchConfig & GetNrSlPsfchConfig () const;
+
+  /**
+   * \brief Set the number of members of a group
+   *
+   * With the HARQ feedback, each member of a group sends its own ACK/NACK,
+   * and a groupcast TB is acknowledged only once all the members sent an
+   * ACK. Without this configuration, the size of the group is unknown and a
+   * groupcast TB is never acknowledged, i.e., it is retransmitted until
+   * the grant has no more slots.
+   *
+   * \param dstL2Id The destination layer 2 id of the group
+   * \param numMembers The number of receivers in the group (this UE excluded)
+   */
+  void SetNrSlNumGroupMembers (uint32_t dstL2Id, uint16_t numMembers);
+
   /**
    * \brief Set Reservation Period for NR Sidelink
    *
@@ -846,6 +960,11 @@ protected:
    * \param sensingData The sensing data
    */
   void DoReceiveSensingData (SensingData sensingData);
+  /**
+   * \brief Receive the HARQ feedback transmitted over the PSFCH
+   * \param feedback The HARQ feedback
+   */
+  void DoReceivePsfch (const NrSlInfoListElement_s &feedback);
 
   // forwarded from MemberNrSlUeMacSchedSapUser
   /**
@@ -870,6 +989,14 @@ protected:
    * \return The max number of PSSCH transmissions
    */
   uint8_t DoGetSlMaxTxTransNumPssch () const;
+  /**
+   * \brief Method through which the NR SL scheduler gets the minimum gap
+   *        between two transmissions of a TB of a LC
+   * \param dstL2Id The destination layer 2 id
+   * \param lcId The logical channel id
+   * \return The minimum gap in slots, 0 if the retransmissions are blind
+   */
+  uint16_t DoGetSlMinReTxGap (uint32_t dstL2Id, uint8_t lcId) const;
 
   // forwarded from MemberNrSlUeMacCschedSapUser
   /**
@@ -961,6 +1088,42 @@ private:
    * \return The list of NR compatible slot info
    */
   std::list <NrSlUeMacSchedSapProvider::NrSlSlotInfo> GetNrSupportedList (const SfnSf& sfn, std::list <NrSlCommResourcePool::SlotInfo> slotInfo);
+  /**
+   * \brief Are the retransmissions of a LC driven by the HARQ feedback?
+   *
+   * It requires blind retransmissions to be disabled, a pool with PSFCH
+   * resources, and a unicast or groupcast LC with HARQ enabled.
+   *
+   * \param dstL2Id The destination layer 2 id
+   * \param lcId The logical channel id
+   * \return true if the TBs of the LC request the HARQ feedback
+   */
+  bool IsNrSlHarqFeedbackEnabled (uint32_t dstL2Id, uint8_t lcId) const;
+  /**
+   * \brief Get the cast type indicator of the SCI stage 2 for a LC
+   * \param dstL2Id The destination layer 2 id
+   * \param lcId The logical channel id
+   * \return The NrSlSciF2aHeader::CastTypeIndicator_t corresponding to the cast type of the LC
+   */
+  uint8_t GetSciCastType (uint32_t dstL2Id, uint8_t lcId) const;
+  /**
+   * \brief Get the number of receivers expected to send the HARQ feedback
+   * \param dstL2Id The destination layer 2 id
+   * \param lcId The logical channel id
+   * \return 1 for unicast, the number of members of the group for
+   *         groupcast, 0 if the size of the group is unknown
+   */
+  uint16_t GetNrSlNumFeedbackReceivers (uint32_t dstL2Id, uint8_t lcId) const;
+  /**
+   * \brief Get the PSFCH occasion of a PSSCH transmission
+   *
+   * As in NrUePhy, it is the first slot with PSFCH resources of the pool
+   * that is at least sl-MinTimeGapPSFCH slots after the PSSCH.
+   *
+   * \param sfn The slot of the PSSCH
+   * \return The absolute slot of the PSFCH occasion
+   */
+  uint64_t GetNrSlPsfchSlot (const SfnSf &sfn) const;
   /**
    * \brief Get the total number of subchannels based on the system UL bandwidth
    * \param poolId The pool id of the active pool to retrieve the sub-channel size in RBs
@@ -1010,6 +1173,8 @@ private:
   std::unordered_set <uint32_t> m_sidelinkRxDestinations; //!< vector holding Sidelink communication destinations for reception
   bool m_enableSensing {false}; //!< Flag to enable NR Sidelink resource selection based on sensing; otherwise, use random selection
   bool m_enableBlindReTx {false}; //!< Flag to enable blind retransmissions for NR Sidelink
+  NrSlPsfchConfig m_slPsfchConfig; //!< PSFCH configuration of the active pool
+  std::unordered_map <uint32_t, uint16_t> m_nrSlNumGroupMembers; //!< Number of receivers of each group, per destination layer 2 id
   uint8_t m_tproc0 {0}; //!< t_proc0 in slots
   uint8_t m_t1 {0}; //!< The offset in number of slots between the slot in which the resource selection is triggered and the start of the selection window
   uint16_t m_t2 {0}; //!< The offset in number of slots between T1 and the end of the selection window
@@ -37,6 +37,7 @@
 #include <algorithm>
 #include <cfloat>
 #include <ns3/boolean.h>
+#include <ns3/uinteger.h>
 #include <ns3/pointer.h>
 #include "beam-manager.h"
 #include "nr-ue-net-device.h"
@@ -164,6 +165,12 @@ NrUePhy::GetTypeId (void)
                    MakeDoubleAccessor (&NrUePhy::SetRiSinrThreshold2,
                                        &NrUePhy::GetRiSinrThreshold2),
                    MakeDoubleChecker<double> ())
+    .AddAttribute ("SubbandCqiSize",
+                   "The number of RBs of each sub-band for the sub-band CQI report. "
+                   "If 0, only the wideband CQI is reported.",
+                   UintegerValue (0),
+                   MakeUintegerAccessor (&NrUePhy::m_rbPerSbCqi),
+                   MakeUintegerChecker<uint16_t> ())
     .AddTraceSource ("DlDataSinr",
                      "DL DATA SINR statistics.",
                      MakeTraceSourceAccessor (&NrUePhy::m_dlDataSinrTrace),
@@ -283,7 +290,7 @@ NrUePhy::SetDlAmc(const Ptr<const NrAmc> &amc)
 void
 NrUePhy::SetSubChannelsForTransmission (const std::vector <int> &mask, uint32_t numSym, uint8_t activeStreams)
 {
-  // in uplink we currently support maximum 1 stream for DATA and CTRL, only SRS will be sent using more than 1 stream
+  // in uplink, DATA and SRS can be sent over more than 1 stream, CTRL only over the first one
   Ptr<SpectrumValue> txPsd = GetTxPowerSpectralDensity (mask, activeStreams);
   NS_ASSERT (txPsd);
 
@@ -508,9 +515,10 @@ NrUePhy::PhyCtrlMessagesReceived (const Ptr<NrControlMessage> &msg)
 
       m_phySapUser->ReceiveControlMessage (msg);
 
+      // The TPC of a DL DCI is for PUCCH (TS 38.213 7.2.1), the one of an UL
+      // DCI for PUSCH (TS 38.213 7.1.1)
       if (m_enableUplinkPowerControl)
         {
-          m_powerControl->ReportTpcPusch (dciInfoElem->m_tpc);
           m_powerControl->ReportTpcPucch (dciInfoElem->m_tpc);
         }
     }
@@ -534,6 +542,11 @@ NrUePhy::PhyCtrlMessagesReceived (const Ptr<NrControlMessage> &msg)
         {
           ProcessDataDci (ulSfnSf, dciInfoElem);
           m_phySapUser->ReceiveControlMessage (msg);
+
+          if (m_enableUplinkPowerControl)
+            {
+              m_powerControl->ReportTpcPusch (dciInfoElem->m_tpc);
+            }
         }
       else if (dciInfoElem->m_type == DciInfoElementTdma::SRS)
         {
@@ -748,6 +761,14 @@ NrUePhy::StartSlot (const SfnSf &s)
 
   SendSlExpectedTbInfo (s);
 
+  auto itPsfch = m_slPsfchTxQueue.find (s.Normalize ());
+  if (itPsfch != m_slPsfchTxQueue.end ())
+    {
+      Simulator::Schedule (GetSymbolPeriod () * NrSlPsfchConfig::GetPsfchSymStart (GetSymbolsPerSlot ()),
+                           &NrUePhy::SendNrSlFeedbackChannels, this, itPsfch->second);
+      m_slPsfchTxQueue.erase (itPsfch);
+    }
+
   if (slAllocExists)
     {
       NS_ASSERT_MSG (!nrAllocExists, "Can not start SL slot when there is UL allocation");
@@ -998,41 +1019,59 @@ NrUePhy::UlData(const std::shared_ptr<DciInfoElementTdma> &dci)
     {
       m_txPower = m_powerControl->GetPuschTxPower ((FromRBGBitmaskToRBAssignment(dci->m_rbgBitmask)).size());
     }
-  // Currently uplink DATA is transmitted over only 1 stream
-  SetSubChannelsForTransmission (FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask), dci->m_numSym, 1);
-  Time varTtiPeriod = GetSymbolPeriod () * dci->m_numSym;
-  std::list<Ptr<NrControlMessage> > ctrlMsg;
-  //MIMO is not supported for UL yet.
-  //Therefore, there will be only
-  //one stream with stream Id 0.
-  uint8_t streamId = 0;
-  Ptr<PacketBurst> pktBurst = GetPacketBurst (m_currentSlot, dci->m_symStart, streamId);
-  if (pktBurst && pktBurst->GetNPackets () > 0)
+  // The TX power is shared among the streams that carry a TB
+  uint8_t activeStreams = 0;
+  for (const auto &tbSize : dci->m_tbSize)
     {
-      std::list< Ptr<Packet> > pkts = pktBurst->GetPackets ();
-      LteRadioBearerTag bearerTag;
-      if (!pkts.front ()->PeekPacketTag (bearerTag))
+      if (tbSize > 0)
         {
-          NS_FATAL_ERROR ("No radio bearer tag");
+          activeStreams++;
         }
     }
-  else
+  SetSubChannelsForTransmission (FromRBGBitmaskToRBAssignment (dci->m_rbgBitmask), dci->m_numSym, activeStreams);
+  Time varTtiPeriod = GetSymbolPeriod () * dci->m_numSym;
+  std::list<Ptr<NrControlMessage> > ctrlMsg;
+
+  for (uint8_t streamId = 0; streamId < dci->m_tbSize.size (); streamId++)
     {
-      // put an error, as something is wrong. The UE should not be scheduled
-      // if there is no data for him...
-      NS_FATAL_ERROR ("The UE " << dci->m_rnti << " has been scheduled without data");
-    }
-  m_reportUlTbSize (m_netDevice->GetObject <NrUeNetDevice> ()->GetImsi (), dci->m_tbSize.at (0));
+      if (dci->m_tbSize.at (streamId) == 0)
+        {
+          continue;
+        }
 
-  NS_LOG_DEBUG ("UE" << m_rnti <<
-                " TXing UL DATA frame for" <<
-                " symbols "  << +dci->m_symStart <<
-                "-" << +(dci->m_symStart + dci->m_numSym - 1)
-                     << "\t start " << Simulator::Now () <<
-                " end " << (Simulator::Now () + varTtiPeriod));
+      NS_ABORT_MSG_IF (streamId >= m_spectrumPhys.size (),
+                       "UL DCI with a TB for stream " << +streamId <<
+                       ", but the UE has " << m_spectrumPhys.size () << " streams");
+      Ptr<PacketBurst> pktBurst = GetPacketBurst (m_currentSlot, dci->m_symStart, streamId);
+      if (pktBurst && pktBurst->GetNPackets () > 0)
+        {
+          std::list< Ptr<Packet> > pkts = pktBurst->GetPackets ();
+          LteRadioBearerTag bearerTag;
+          if (!pkts.front ()->PeekPacketTag (bearerTag))
+            {
+              NS_FATAL_ERROR ("No radio bearer tag");
+            }
+        }
+      else
+        {
+          // put an error, as something is wrong. The UE should not be scheduled
+          // if there is no data for him...
+          NS_FATAL_ERROR ("The UE " << dci->m_rnti << " has been scheduled without data" <<
+                          " in stream " << +streamId);
+        }
+      m_reportUlTbSize (m_netDevice->GetObject <NrUeNetDevice> ()->GetImsi (), dci->m_tbSize.at (streamId));
+
+      NS_LOG_DEBUG ("UE" << m_rnti <<
+                    " TXing UL DATA frame for" <<
+                    " symbols "  << +dci->m_symStart <<
+                    "-" << +(dci->m_symStart + dci->m_numSym - 1) <<
+                    " stream " << +streamId <<
+                    "\t start " << Simulator::Now () <<
+                    " end " << (Simulator::Now () + varTtiPeriod));
 
-  Simulator::Schedule (NanoSeconds (1.0), &NrUePhy::SendDataChannels, this,
-                       pktBurst, ctrlMsg, varTtiPeriod - NanoSeconds (2.0));
+      Simulator::Schedule (NanoSeconds (1.0), &NrUePhy::SendDataChannels, this,
+                           pktBurst, ctrlMsg, varTtiPeriod - NanoSeconds (2.0), streamId);
+    }
   return varTtiPeriod;
 }
 
@@ -1124,7 +1163,7 @@ NrUePhy::PhyDataPacketReceived (const Ptr<Packet> &p)
 void
 NrUePhy::SendDataChannels (const Ptr<PacketBurst> &pb,
                            const std::list<Ptr<NrControlMessage> > &ctrlMsg,
-                           const Time &duration)
+                           const Time &duration, uint8_t streamId)
 {
   if (pb->GetNPackets () > 0)
     {
@@ -1135,8 +1174,7 @@ NrUePhy::SendDataChannels (const Ptr<PacketBurst> &pb,
         }
     }
 
-  // Uplink data is sent only through a single stream, the first is assumed
-  m_spectrumPhys.at (0)->StartTxDataFrames (pb, ctrlMsg, duration);
+  m_spectrumPhys.at (streamId)->StartTxDataFrames (pb, ctrlMsg, duration);
 }
 
 void
@@ -1177,6 +1215,7 @@ NrUePhy::GenerateDlCqiReport (const SpectrumValue& sinr, uint8_t streamId)
           // Remember, scheduler uses MCS 0 for CQI 0.
           // See, NrMacSchedulerCQIManagement::DlWBCQIReported
           m_prevDlWbCqi = std::vector <uint8_t> (m_spectrumPhys.size (), 0);
+          m_prevDlSbCqi = std::vector <std::vector<uint8_t> > (m_spectrumPhys.size ());
           m_reportedRi2 = false; // already initialized to false in the header, added here for readability
         }
 
@@ -1190,6 +1229,10 @@ NrUePhy::GenerateDlCqiReport (const SpectrumValue& sinr, uint8_t streamId)
       double avrgSinrdB = 10 * log10 (ComputeAvgSinr (sinr));
       avrgSinr [streamId] = avrgSinrdB;
       NS_LOG_DEBUG ("Stream " << +streamId << " WB CQI " << +wbCqi << " avrg MCS " << +mcs << " avrg SINR (dB) " << avrgSinrdB);
+      if (m_rbPerSbCqi > 0)
+        {
+          m_prevDlSbCqi [streamId] = m_amc->CreateCqiFeedbackSbTdma (sinr, m_rbPerSbCqi);
+        }
       m_dlCqiFeedbackCounter++;
 
       // if we received SINR from all the active streams,
@@ -1218,6 +1261,12 @@ NrUePhy::GenerateDlCqiReport (const SpectrumValue& sinr, uint8_t streamId)
           //if UE reports RI = 2 and one of the stream's CQI is 0, scheduler will
           //use MCS 0 to compute its TB size.
           dlcqi.m_wbCqi = m_prevDlWbCqi; // set DL CQI feedbacks
+          if (m_rbPerSbCqi > 0)
+            {
+              dlcqi.m_cqiType = DlCqiInfo::SB;
+              dlcqi.m_sbCqi = m_prevDlSbCqi;
+              dlcqi.m_rbPerSb = m_rbPerSbCqi;
+            }
 
           NS_ASSERT_MSG (dlcqi.m_ri <= dlcqi.m_wbCqi.size (), "Mismatch between the RI and the number of CQIs in a CQI report");
 
@@ -1318,6 +1367,13 @@ NrUePhy::SetCam(const Ptr<NrChAccessManager> &cam)
   m_cam->SetAccessDeniedCallback (std::bind (&NrUePhy::ChannelAccessDenied, this));
 }
 
+Ptr<NrChAccessManager>
+NrUePhy::GetCam () const
+{
+  NS_LOG_FUNCTION (this);
+  return m_cam;
+}
+
 const SfnSf &
 NrUePhy::GetCurrentSfnSf () const
 {
@@ -2064,6 +2120,78 @@ NrUePhy::PhyPsschPduReceived (const Ptr<PacketBurst> &pb)
                                   m_nrSlUePhySapUser, pb);
 }
 
+void
+NrUePhy::SetNrSlPsfchConfig (const NrSlPsfchConfig &psfchConfig)
+{
+  NS_LOG_FUNCTION (this << psfchConfig.period << psfchConfig.minTimeGap);
+  m_slPsfchConfig = psfchConfig;
+}
+
+void
+NrUePhy::PhySlHarqFeedbackGenerated (const NrSlInfoListElement_s &feedback, uint16_t rb)
+{
+  NS_LOG_FUNCTION (this << feedback.txRnti << +feedback.harqProcessId << rb);
+
+  if (!m_slPsfchConfig.IsEnabled () || m_slRxPool == nullptr)
+    {
+      NS_LOG_DEBUG ("No PSFCH resources in the pool, dropping the HARQ feedback");
+      return;
+    }
+
+  //The feedback is sent in the first slot with PSFCH resources, which is
+  //at least minTimeGap slots after the PSSCH slot (TS 38.213 Sec. 16.3)
+  uint64_t psfchSlot = feedback.psschSfn.Normalize () + m_slPsfchConfig.minTimeGap;
+  //search within one SFN cycle (1024 frames of 10 subframes)
+  const uint64_t lastSlot = psfchSlot + 10240 * static_cast<uint64_t> (1 << GetNumerology ());
+  uint8_t poolId = m_nrSlUePhySapUser->GetSlActiveTxPoolId ();
+  while (!(m_slPsfchConfig.IsPsfchSlot (psfchSlot)
+           && m_slRxPool->IsSidelinkSlot (GetBwpId (), poolId, psfchSlot)))
+    {
+      ++psfchSlot;
+      if (psfchSlot > lastSlot)
+        {
+          NS_LOG_DEBUG ("Unable to find a PSFCH slot, dropping the HARQ feedback");
+          return;
+        }
+    }
+
+  NS_LOG_DEBUG ("HARQ feedback for the PSSCH in " << feedback.psschSfn
+                << " will be sent in the absolute slot " << psfchSlot);
+  SlPsfchTxInfo &psfchTxInfo = m_slPsfchTxQueue[psfchSlot];
+  psfchTxInfo.feedbackList.push_back (feedback);
+  //the members of a group are told apart by the transmitter through the
+  //RNTI of the UE that sends the feedback
+  psfchTxInfo.feedbackList.back ().rxRnti = GetRnti ();
+  psfchTxInfo.rbs.insert (static_cast<int> (rb));
+}
+
+void
+NrUePhy::SendNrSlFeedbackChannels (const SlPsfchTxInfo &psfchTxInfo)
+{
+  NS_LOG_FUNCTION (this);
+
+  std::vector<int> channelRbs (psfchTxInfo.rbs.begin (), psfchTxInfo.rbs.end ());
+  //the PSFCH symbol and its AGC repetition
+  const uint32_t psfchSymbols = 2;
+  SetSubChannelsForTransmission (channelRbs, psfchSymbols, 1);
+  NS_LOG_DEBUG ("Sending PSFCH with " << psfchTxInfo.feedbackList.size ()
+                << " HARQ feedback on SfnSf " << m_currentSlot);
+  // Assume Sl feedback channel is sent through the first stream
+  m_spectrumPhys.at (0)->StartTxSlFeedbackFrames (psfchTxInfo.feedbackList,
+                                                  GetSymbolPeriod () * psfchSymbols - NanoSeconds (1.0));
+}
+
+void
+NrUePhy::PhyPsfchReceived (const NrSlInfoListElement_s &feedback)
+{
+  NS_LOG_FUNCTION (this << feedback.txRnti << +feedback.harqProcessId);
+  if (feedback.txRnti != GetRnti ())
+    {
+      return;
+    }
+  m_nrSlUePhySapUser->ReceivePsfch (feedback);
+}
+
 double
 NrUePhy::GetSidelinkRsrp (SpectrumValue psd)
 {
@@ -31,6 +31,8 @@
 
 #include "nr-sl-sci-f1a-header.h"
 #include "nr-sl-mac-pdu-tag.h"
+#include <map>
+#include <set>
 
 namespace ns3 {
 
@@ -432,6 +434,12 @@ public:
    */
   void SetCam (const Ptr<NrChAccessManager> &cam);
 
+  /**
+   * \brief Get the channel access manager for the PHY
+   * \return the CAM of the PHY
+   */
+  Ptr<NrChAccessManager> GetCam () const;
+
   const SfnSf & GetCurrentSfnSf () const override;
 
   // From nr phy. Not used in the UE
@@ -675,10 +683,11 @@ private:
    * \param pb Data to transmit
    * \param duration period of transmission
    * \param ctrlMsg Control messages
+   * \param streamId the stream through which the data is transmitted
    */
   void SendDataChannels (const Ptr<PacketBurst> &pb,
                          const std::list<Ptr<NrControlMessage> > &ctrlMsg,
-                         const Time &duration);
+                         const Time &duration, uint8_t streamId);
   /**
    * \brief Transmit the control channel
    *
@@ -894,6 +903,8 @@ private:
   uint8_t m_activeDlDataStreams {0}; //!< The value is updated each time DlData function is called, first it is reset to 0, and then it is incremented each time is called AddExpectedTb
 
   std::vector <uint8_t> m_prevDlWbCqi; //!< Vector to cache the CQI values reported by this UE PHY
+  std::vector <std::vector<uint8_t> > m_prevDlSbCqi; //!< Vector to cache the sub-band CQI values of each stream reported by this UE PHY
+  uint16_t m_rbPerSbCqi {0}; //!< Number of RBs of each sub-band for the sub-band CQI (attribute); 0 for wideband CQI only
   uint8_t m_dlCqiFeedbackCounter {0}; /**< Counter to count the number of DL CQI
                                            report(s) this UE PHY prepares upon
                                            receiving SINR from underlying one or
@@ -950,6 +961,24 @@ public:
    * \param pb The packet burst received
    */
   void PhyPsschPduReceived (const Ptr<PacketBurst> &pb);
+  /**
+   * \brief Set the PSFCH configuration of the sidelink resource pool
+   * \param psfchConfig The PSFCH configuration
+   */
+  void SetNrSlPsfchConfig (const NrSlPsfchConfig &psfchConfig);
+  /**
+   * \brief Receive the HARQ feedback generated by SpectrumPhy for a received
+   *        PSSCH TB, and queue it for the transmission in the PSFCH slot
+   *        associated to the PSSCH slot
+   * \param feedback The HARQ feedback
+   * \param rb The first RB of the PSSCH TB
+   */
+  void PhySlHarqFeedbackGenerated (const NrSlInfoListElement_s &feedback, uint16_t rb);
+  /**
+   * \brief Receive a HARQ feedback from SpectrumPhy over the PSFCH
+   * \param feedback The HARQ feedback
+   */
+  void PhyPsfchReceived (const NrSlInfoListElement_s &feedback);
 
 protected:
   /**
@@ -1098,12 +1127,27 @@ private:
    * slot without SCI 1-A, and send this info to NrSpectrumPhy.
    */
   void SendSlExpectedTbInfo (const SfnSf &s);
+  /**
+   * \brief HARQ feedback to be transmitted in a PSFCH slot
+   */
+  struct SlPsfchTxInfo
+  {
+    std::vector<NrSlInfoListElement_s> feedbackList; //!< The HARQ feedback
+    std::set<int> rbs;                               //!< The RBs of the PSFCH transmissions
+  };
+  /**
+   * \brief Transmit to the spectrum phy the HARQ feedback over the PSFCH
+   * \param psfchTxInfo The HARQ feedback to transmit and its RBs
+   */
+  void SendNrSlFeedbackChannels (const SlPsfchTxInfo &psfchTxInfo);
   NrSlUeCphySapProvider* m_nrSlUeCphySapProvider; //!< Control SAP interface to receive calls from the UE RRC instance
   NrSlUeCphySapUser* m_nrSlUeCphySapUser {nullptr}; //!< Control SAP interface to call the methods of UE RRC instance
   NrSlUePhySapUser* m_nrSlUePhySapUser {nullptr}; //!< SAP interface to call the methods of UE MAC instance
   Ptr<const NrSlCommResourcePool> m_slTxPool; //!< Sidelink communication transmission pools
   Ptr<const NrSlCommResourcePool> m_slRxPool; //!< Sidelink communication reception pools
   std::deque <SlRxGrantInfo> m_slRxGrants; //!< Sidelink RX grants indicated by SCI 1-A
+  NrSlPsfchConfig m_slPsfchConfig; //!< PSFCH configuration of the sidelink resource pool
+  std::map <uint64_t, SlPsfchTxInfo> m_slPsfchTxQueue; //!< HARQ feedback to be transmitted, indexed by the absolute PSFCH slot
 };
 
 }
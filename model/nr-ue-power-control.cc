@@ -116,7 +116,7 @@ NrUePowerControl::GetTypeId (void)
     .AddAttribute ("PsrsOffset",
                    "P_SRS_OFFSET   INT(0...15), Default value 7",
                    IntegerValue (7),
-                   MakeIntegerAccessor (&NrUePowerControl::m_PsrsOffset),
+                   MakeIntegerAccessor (&NrUePowerControl::SetPsrsOffset),
                    MakeIntegerChecker<int16_t> (0, 15))
     .AddAttribute ("TSpec",
                    "Technical specification TS 36.213 or TS 38.213,"
@@ -208,6 +208,7 @@ NrUePowerControl::SetAlpha (double value)
     }
 
   m_alpha = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -225,6 +226,7 @@ NrUePowerControl::SetRsrp (double value)
   double alphaRsrp = std::pow (0.5, m_pcRsrpFilterCoefficient / 4.0);
   m_rsrp = (1 - alphaRsrp) * m_rsrp + alphaRsrp * value;
   m_pathLoss = m_referenceSignalPower - m_rsrp;
+  UpdateOpenLoop ();
   NS_LOG_INFO ("Pathloss updated to: " << m_pathLoss <<
                " , rsrp updated to:" << m_rsrp << 
                " for cellId/rnti: " << m_cellId << "," << m_rnti);
@@ -249,6 +251,7 @@ NrUePowerControl::SetTechnicalSpec (NrUePowerControl::TechnicalSpec value)
 {
   NS_LOG_FUNCTION (this);
   m_technicalSpec = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -263,6 +266,7 @@ NrUePowerControl::SetP0Srs (double value)
 {
   NS_LOG_FUNCTION (this);
   m_P_0_SRS = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -270,6 +274,7 @@ NrUePowerControl::SetDeltaTF (double value)
 {
   NS_LOG_FUNCTION (this);
   m_deltaTF = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -277,6 +282,7 @@ NrUePowerControl::SetDeltaTFControl (double value)
 {
   NS_LOG_FUNCTION (this);
   m_deltaTF_control = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -284,6 +290,7 @@ NrUePowerControl::SetDeltaFPucch (double value)
 {
   NS_LOG_FUNCTION (this);
   m_delta_F_Pucch = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -291,6 +298,7 @@ NrUePowerControl::SetPoNominalPucch (int16_t value)
 {
   NS_LOG_FUNCTION (this);
   m_PoNominalPucch = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -298,6 +306,7 @@ NrUePowerControl::SetPoUePucch (int16_t value)
 {
   NS_LOG_FUNCTION (this);
   m_PoUePucch = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -319,12 +328,23 @@ NrUePowerControl::SetPoNominalPusch (int16_t value)
 {
   NS_LOG_FUNCTION (this);
   m_PoNominalPusch = value;
+  UpdateOpenLoop ();
 }
+
 void
 NrUePowerControl::SetPoUePusch (int16_t value)
 {
   NS_LOG_FUNCTION (this);
   m_PoUePusch = value;
+  UpdateOpenLoop ();
+}
+
+void
+NrUePowerControl::SetPsrsOffset (int16_t value)
+{
+  NS_LOG_FUNCTION (this);
+  m_PsrsOffset = value;
+  UpdateOpenLoop ();
 }
 
 void
@@ -587,6 +607,47 @@ NrUePowerControl::UpdateGc ()
   m_deltaPucch.clear (); // we have used these values, no need to save them any more
 }
 
+void
+NrUePowerControl::UpdateOpenLoop ()
+{
+  // The terms that change only with the configuration or the path loss,
+  // i.e., with a new RSRP, and not at every transmission
+  double pathLossComponent = m_alpha * m_pathLoss;
+  m_puschOpenLoop = m_PoNominalPusch + m_PoUePusch + pathLossComponent + m_deltaTF;
+  m_pucchOpenLoop = m_PoNominalPucch + m_PoUePucch + pathLossComponent + m_delta_F_Pucch + m_deltaTF_control;
+  if (m_technicalSpec == TS_36_213)
+    {
+      double pSrsOffsetValue = -10.5 + m_PsrsOffset * 1.5;
+      m_srsOpenLoop = pSrsOffsetValue + m_PoNominalPusch + m_PoUePusch + pathLossComponent;
+    }
+  else
+    {
+      m_srsOpenLoop = m_P_0_SRS + pathLossComponent;
+    }
+}
+
+double
+NrUePowerControl::GetBandwidthComponent (std::size_t rbNum)
+{
+  uint16_t numerology = m_nrUePhy->GetNumerology ();
+  if (numerology != m_cachedNumerology)
+    {
+      m_cachedNumerology = numerology;
+      m_bandwidthComponent.clear ();
+    }
+
+  if (rbNum >= m_bandwidthComponent.size ())
+    {
+      std::size_t first = m_bandwidthComponent.size ();
+      m_bandwidthComponent.resize (rbNum + 1);
+      for (std::size_t i = first; i <= rbNum; ++i)
+        {
+          m_bandwidthComponent[i] = 10 * log10 (std::pow (2, numerology) * i);
+        }
+    }
+  return m_bandwidthComponent[rbNum];
+}
+
 //TS 38.213 Table 7.1.1-1 and Table 7.2.1-1,  Mapping of TPC Command Field in DCI to accumulated and absolute value
 
 //Implements from from ts_138213 7.1.1
@@ -600,10 +661,9 @@ NrUePowerControl::CalculatePuschTxPowerNr (std::size_t rbNum)
     {
       return m_Pcmax;
     }
-  int32_t PoPusch = m_PoNominalPusch + m_PoUePusch;
 
   NS_LOG_INFO ("RBs: " << rbNum <<
-               " m_PoPusch: " << PoPusch <<
+               " m_PoPusch: " << m_PoNominalPusch + m_PoUePusch <<
                " Alpha: " << m_alpha <<
                " PathLoss: " << m_pathLoss <<
                " deltaTF: " << m_deltaTF <<
@@ -614,7 +674,7 @@ NrUePowerControl::CalculatePuschTxPowerNr (std::size_t rbNum)
 
   if (rbNum > 0)
     {
-      puschComponent = 10 * log10 ( std::pow (2, m_nrUePhy->GetNumerology ()) * rbNum);
+      puschComponent = GetBandwidthComponent (rbNum);
     }
   else
     {
@@ -647,7 +707,7 @@ NrUePowerControl::CalculatePuschTxPowerNr (std::size_t rbNum)
       UpdateFc ();
     }
 
-  double txPower = PoPusch + puschComponent + m_alpha * m_pathLoss + m_deltaTF + m_fc;
+  double txPower = m_puschOpenLoop + puschComponent + m_fc;
 
   NS_LOG_INFO ("Calculated PUSCH power:" << txPower << " MinPower: " << m_Pcmin << " MaxPower:" << m_Pcmax);
 
@@ -670,11 +730,10 @@ NrUePowerControl::CalculatePucchTxPowerNr (std::size_t rbNum)
       return m_Pcmax;
     }
 
-  int32_t PoPucch = m_PoNominalPucch + m_PoUePucch;
   double pucchComponent = 0;
   if (rbNum > 0)
     {
-      pucchComponent = 10 * log10 ( std::pow (2, m_nrUePhy->GetNumerology ()) * rbNum);
+      pucchComponent = GetBandwidthComponent (rbNum);
     }
   else
     {
@@ -711,14 +770,14 @@ NrUePowerControl::CalculatePucchTxPowerNr (std::size_t rbNum)
     }
 
   NS_LOG_INFO ("RBs: " << rbNum <<
-               " m_PoPucch: " << PoPucch <<
+               " m_PoPucch: " << m_PoNominalPucch + m_PoUePucch <<
                " Alpha: " << m_alpha <<
                " PathLoss: " << m_pathLoss <<
                " deltaTF: " << m_deltaTF_control <<
                " gc: " << m_gc <<
                " numerology: " << m_nrUePhy->GetNumerology ());
 
-  double txPower = PoPucch + pucchComponent + m_alpha * m_pathLoss + m_delta_F_Pucch + m_deltaTF_control +  m_gc;
+  double txPower = m_pucchOpenLoop + pucchComponent + m_gc;
 
   NS_LOG_INFO ("Calculated PUCCH power: " << txPower << " MinPower: " << m_Pcmin << " MaxPower:" << m_Pcmax);
 
@@ -733,10 +792,8 @@ double
 NrUePowerControl::CalculateSrsTxPowerNr (std::size_t rbNum)
 {
   NS_LOG_FUNCTION (this);
-  int32_t PoPusch = m_PoNominalPusch + m_PoUePusch;
-
   NS_LOG_INFO ("RBs: " << rbNum <<
-               " m_PoPusch: " << PoPusch <<
+               " m_PoPusch: " << m_PoNominalPusch + m_PoUePusch <<
                " Alpha: " << m_alpha <<
                " PathLoss: " << m_pathLoss <<
                " deltaTF: " << m_deltaTF <<
@@ -757,23 +814,17 @@ NrUePowerControl::CalculateSrsTxPowerNr (std::size_t rbNum)
 
   if (rbNum > 0)
     {
-      component = 10 * log10 (std::pow (2, m_nrUePhy->GetNumerology ()) * rbNum);
+      component = GetBandwidthComponent (rbNum);
     }
   else
     {
       NS_ABORT_MSG ("Should not be called CalculateSrsTxPowerNr if no RBs are assigned.");
     }
 
-  if (m_technicalSpec == TS_36_213)
-    {
-      double pSrsOffsetValue = -10.5 + m_PsrsOffset * 1.5;
-      txPower = pSrsOffsetValue + component + PoPusch + m_alpha * m_pathLoss + m_hc;
-    }
-  else if (m_technicalSpec == TS_38_213)
-    {
-      txPower = m_P_0_SRS + component +  m_alpha * m_pathLoss + m_hc;  // this formula also can apply for TS_36_213,
-                                                                       //See 5.1.3 Sounding Reference Symbol (SRS) 5.1.3.1 UE behavior
-    }
+  // For TS_36_213, m_srsOpenLoop includes P_SRS_OFFSET and PoPusch, while for
+  // TS_38_213 it includes P_0_SRS (this formula also can apply for TS_36_213,
+  // See 5.1.3 Sounding Reference Symbol (SRS) 5.1.3.1 UE behavior)
+  txPower = m_srsOpenLoop + component + m_hc;
 
   NS_LOG_INFO ("CalcPower: " << txPower << " MinPower: " << m_Pcmin << " MaxPower:" << m_Pcmax);
 
@@ -50,7 +50,14 @@ namespace ns3 {
  * referenceSignalPower is configurable by attribute system.
  * NrUePowerControl uses latter values to calculate path loss.
  * When closed loop power control is being used NrUePhy should also
- * pass TPC values to NrUePowerControl.
+ * pass TPC values to NrUePowerControl: the ones of the UL DCIs for PUSCH
+ * (and SRS), and the ones of the DL DCIs for PUCCH.
+ *
+ * Since these functions are called for every UL transmission, the terms
+ * that do not depend on the transmission (P0, alpha * path loss, delta
+ * terms) are computed only when the configuration or the RSRP change, and
+ * the bandwidth term 10 * log10 (2^mu * M_RB) is cached for each number
+ * of RBs of the current numerology.
  *
  * Specification that are used to implement uplink power control feature are
  * the latest available specifications for LTE and NR:
@@ -199,6 +206,11 @@ public:
    * \param value the Po Ue Pusch
    */
   void SetPoUePusch (int16_t value);
+  /**
+   * \brief Sets P_SRS_OFFSET, used for SRS power control with TS 36.213
+   * \param value P_SRS_OFFSET value to be set
+   */
+  void SetPsrsOffset (int16_t value);
   /**
    * \brief Set transmit power function
    * \param value the transmit power value
@@ -323,11 +335,22 @@ private:
     * \param rbNum number of RBs
     */
   double CalculateSrsTxPowerNr (std::size_t rbNum);
+   /**
+    * \brief Update the open loop components of PUSCH, PUCCH and SRS, after a
+    * change of the configuration or of the path loss
+    */
+  void UpdateOpenLoop ();
+   /**
+    * \brief Get 10 * log10 (2^mu * rbNum), from the cache of the current numerology
+    * \param rbNum number of RBs
+    * \return the bandwidth component of the transmit power, in dB
+    */
+  double GetBandwidthComponent (std::size_t rbNum);
 
   // general attributes
   bool m_closedLoop {true};                     //!< is closed loop
   bool m_accumulationEnabled {true};            //!< accumulation enabled
-  TechnicalSpec m_technicalSpec;                //!< Technical specification to be used for transmit power calculations
+  TechnicalSpec m_technicalSpec {TS_36_213};    //!< Technical specification to be used for transmit power calculations
   double m_Pcmax {0};                           //!< PC maximum
   double m_Pcmin {0};                           //!< PC minimum
   double m_referenceSignalPower {30};           //!< reference signal power in dBm
@@ -358,13 +381,18 @@ private:
   double m_curSrsTxPower {10};                 //!< current SRS transmit power
   bool m_rsrpSet {false};                       //!< is RSRP set?
   double m_rsrp {-40};                         //!< RSRP value in dBm
-  int16_t m_PsrsOffset;                         //!< PSRS offset
+  int16_t m_PsrsOffset {7};                     //!< PSRS offset
   double m_pathLoss {100};                      //!< path loss value in dB
   std::vector <int8_t> m_deltaPucch;           //!< vector that saves TPC command accumulated values for PUCCH transmit power calculation
   std::vector <int8_t> m_deltaPusch;            //!< vector that saves TPC command accumulated values for PUSCH transmit power calculation
   double m_fc {0.0};                            //!< FC
   double m_gc {0.0};                            //!< Is the current PUCCH power control adjustment state. This variable is used for calculation of PUCCH transmit power.
   double m_hc {0.0};                            //!< Is the current SRS power control adjustment state. This variable is used for calculation of SRS transmit power.
+  double m_puschOpenLoop {0.0};                 //!< PoPusch + alpha * pathLoss + deltaTF, updated by UpdateOpenLoop
+  double m_pucchOpenLoop {0.0};                 //!< PoPucch + alpha * pathLoss + delta_F_Pucch + deltaTF_control, updated by UpdateOpenLoop
+  double m_srsOpenLoop {0.0};                   //!< Open loop component of the SRS transmit power, updated by UpdateOpenLoop
+  uint16_t m_cachedNumerology {UINT16_MAX};     //!< Numerology of m_bandwidthComponent
+  std::vector<double> m_bandwidthComponent;     //!< 10 * log10 (2^mu * rbNum), indexed by rbNum
 
   //another attributes needed for function calls
   Ptr<NrUePhy> m_nrUePhy;                       //!< NrUePhy instance owner
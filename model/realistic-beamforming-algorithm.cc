@@ -123,6 +123,9 @@ void
 RealisticBeamformingAlgorithm::SetBeamSearchAngleStep (double beamSearchAngleStep)
 {
   m_beamSearchAngleStep = beamSearchAngleStep;
+  // the codebooks are created again with the new step at the next update
+  m_gnbCodebook = Codebook ();
+  m_ueCodebook = Codebook ();
 }
 
 double
@@ -269,6 +272,64 @@ RealisticBeamformingAlgorithm::GetChannelMatrix () const
   return channelMatrixCopy;
 }
 
+RealisticBeamformingAlgorithm::Codebook
+RealisticBeamformingAlgorithm::CreateCodebook (const Ptr<NrSpectrumPhy>& spectrumPhy, const std::vector<double> &thetas)
+{
+  UintegerValue uintValue;
+  spectrumPhy->GetAntenna ()->GetAttribute ("NumRows", uintValue);
+  uint32_t numRows = static_cast<uint32_t> (uintValue.Get ());
+
+  Codebook codebook;
+  for (double theta : thetas)
+    {
+      for (uint16_t sector = 0; sector <= numRows; sector++)
+        {
+          NS_ASSERT (sector < UINT16_MAX);
+          spectrumPhy->GetBeamManager ()->SetSector (sector, theta);
+          complexVector_t w = spectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
+          NS_ABORT_MSG_IF (w.size () == 0, "Beamforming vectors must be initialized in order to calculate the long term matrix.");
+          codebook.m_beamIds.emplace_back (BeamId (sector, theta));
+          codebook.m_weights.emplace_back (std::move (w));
+        }
+    }
+  return codebook;
+}
+
+void
+RealisticBeamformingAlgorithm::UpdateCodebooks ()
+{
+  NS_LOG_FUNCTION (this);
+  uint32_t gnbElements = m_gnbSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel> ()->GetNumberOfElements ();
+  uint32_t ueElements = m_ueSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel> ()->GetNumberOfElements ();
+
+  if (!m_gnbCodebook.m_weights.empty () && m_gnbCodebook.m_weights.front ().size () == gnbElements
+      && !m_ueCodebook.m_weights.empty () && m_ueCodebook.m_weights.front ().size () == ueElements)
+    {
+      return;
+    }
+
+  std::vector<double> gnbThetas, ueThetas;
+  for (double gnbTheta = 60; gnbTheta < 121; gnbTheta = gnbTheta + m_beamSearchAngleStep)
+    {
+      gnbThetas.push_back (gnbTheta);
+    }
+  for (double ueTheta = 60; ueTheta < 121; ueTheta = static_cast<uint16_t> (ueTheta + m_beamSearchAngleStep))
+    {
+      ueThetas.push_back (ueTheta);
+    }
+
+  m_gnbCodebook = CreateCodebook (m_gnbSpectrumPhy, gnbThetas);
+  m_ueCodebook = CreateCodebook (m_ueSpectrumPhy, ueThetas);
+  NS_LOG_DEBUG ("Codebooks of " << m_gnbCodebook.m_weights.size () << " gNB beams and " <<
+                m_ueCodebook.m_weights.size () << " UE beams");
+
+  // the metrics in the cache refer to the old codebooks
+  for (auto &it : m_estimatedChannelCache)
+    {
+      it.second.m_metric.clear ();
+    }
+}
+
 BeamformingVectorPair
 RealisticBeamformingAlgorithm::GetBeamformingVectors ()
 {
@@ -276,16 +337,6 @@ RealisticBeamformingAlgorithm::GetBeamformingVectors ()
   double distance = m_gnbSpectrumPhy->GetMobility ()->GetDistanceFrom (m_ueSpectrumPhy->GetMobility());
   NS_ABORT_MSG_IF (distance == 0, "Beamforming method cannot be performed between two devices that are placed in the same position.");
 
-  double max = 0, maxTxTheta = 0, maxRxTheta = 0;
-  uint16_t maxTxSector = 0, maxRxSector = 0;
-  complexVector_t maxTxW, maxRxW;
-
-  UintegerValue uintValue;
-  m_gnbSpectrumPhy->GetAntenna ()->GetAttribute ("NumRows", uintValue);
-  uint32_t gnbNumRows = static_cast<uint32_t> (uintValue.Get ());
-  m_ueSpectrumPhy->GetAntenna ()->GetAttribute ("NumRows", uintValue);
-  uint32_t ueNumRows = static_cast<uint32_t> (uintValue.Get ());
-
   TriggerEventConf conf = GetTriggerEventConf ();
   double srsSinr = 0;
   Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix = nullptr;
@@ -304,139 +355,177 @@ RealisticBeamformingAlgorithm::GetBeamformingVectors ()
       channelMatrix = GetChannelMatrix ();
     }
 
-  for (double gnbTheta = 60; gnbTheta < 121; gnbTheta = gnbTheta + m_beamSearchAngleStep)
+  UpdateCodebooks ();
+  const EstimatedChannelInfo &info = GetEstimatedChannelInfo (channelMatrix, srsSinr);
+
+  // same search order as a loop over the gNB beams and then over the UE
+  // beams, so that ties are resolved in favour of the first pair
+  double max = 0;
+  size_t maxGnbBeam = 0, maxUeBeam = 0;
+  size_t numUeBeams = m_ueCodebook.m_weights.size ();
+  for (size_t gnbBeam = 0; gnbBeam < m_gnbCodebook.m_weights.size (); ++gnbBeam)
     {
-      for (uint16_t gnbSector = 0; gnbSector <= gnbNumRows; gnbSector++)
+      for (size_t ueBeam = 0; ueBeam < numUeBeams; ++ueBeam)
         {
-          NS_ASSERT(gnbSector < UINT16_MAX);
-          m_gnbSpectrumPhy->GetBeamManager()->SetSector (gnbSector, gnbTheta);
-          complexVector_t gnbW = m_gnbSpectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
-
-          for (double ueTheta = 60; ueTheta < 121; ueTheta = static_cast<uint16_t> (ueTheta + m_beamSearchAngleStep))
+          double estimatedLongTermMetric = info.m_metric[gnbBeam * numUeBeams + ueBeam];
+          NS_LOG_LOGIC (" Estimated long term metric value: " << estimatedLongTermMetric <<
+                        " gnb beam " << m_gnbCodebook.m_beamIds[gnbBeam] <<
+                        " ue beam " << m_ueCodebook.m_beamIds[ueBeam]);
+          if (max < estimatedLongTermMetric)
             {
-              for (uint16_t ueSector = 0; ueSector <= ueNumRows; ueSector++)
-                {
-                  NS_ASSERT(ueSector < UINT16_MAX);
-                  m_ueSpectrumPhy->GetBeamManager ()->SetSector (ueSector, ueTheta);
-                  complexVector_t ueW = m_ueSpectrumPhy->GetBeamManager ()->GetCurrentBeamformingVector ();
-
-                  NS_ABORT_MSG_IF (gnbW.size()==0 || ueW.size()==0,
-                                   "Beamforming vectors must be initialized in order to calculate the long term matrix.");
-
-                  const UniformPlanarArray::ComplexVector estimatedLongTermComponent = GetEstimatedLongTermComponent (channelMatrix, gnbW, ueW,
-                                                                                                                      m_gnbSpectrumPhy->GetObject<MobilityModel>(),
-                                                                                                                      m_ueSpectrumPhy->GetObject<MobilityModel>(),
-                                                                                                                      srsSinr,
-                                                                                                                      m_gnbSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel>(),
-                                                                                                                      m_ueSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel>()
-                                                                                                                      );
-
-                  double estimatedLongTermMetric = CalculateTheEstimatedLongTermMetric (estimatedLongTermComponent);
-
-                  NS_LOG_LOGIC (" Estimated long term metric value: "<< estimatedLongTermMetric <<
-                                " gnb theta " << gnbTheta <<
-                                " ue theta " << ueTheta <<
-                                " gnb sector " << (M_PI *  static_cast<double> (gnbSector) / static_cast<double> (gnbNumRows) - 0.5 * M_PI) / (M_PI) * 180 <<
-                                " ue sector " << (M_PI * static_cast<double> (ueSector) / static_cast<double> (ueNumRows) - 0.5 * M_PI) / (M_PI) * 180);
-
-                  if (max < estimatedLongTermMetric)
-                    {
-                      max = estimatedLongTermMetric;
-                      maxTxSector = gnbSector;
-                      maxRxSector = ueSector;
-                      maxTxTheta = gnbTheta;
-                      maxRxTheta = ueTheta;
-                      maxTxW = gnbW;
-                      maxRxW = ueW;
-                    }
-                }
+              max = estimatedLongTermMetric;
+              maxGnbBeam = gnbBeam;
+              maxUeBeam = ueBeam;
             }
         }
     }
 
-  BeamformingVectorPair bfPair = std::make_pair (BeamformingVector (std::make_pair(maxTxW, BeamId (maxTxSector, maxTxTheta))),
-                                                 BeamformingVector (std::make_pair (maxRxW, BeamId (maxRxSector, maxRxTheta))));
+  BeamformingVectorPair bfPair = std::make_pair (BeamformingVector (std::make_pair (m_gnbCodebook.m_weights[maxGnbBeam], m_gnbCodebook.m_beamIds[maxGnbBeam])),
+                                                 BeamformingVector (std::make_pair (m_ueCodebook.m_weights[maxUeBeam], m_ueCodebook.m_beamIds[maxUeBeam])));
   NS_LOG_DEBUG ("Beamforming vectors for gNB with node id: "<< m_gnbSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
                 " and UE with node id: " << m_ueSpectrumPhy->GetMobility()->GetObject<Node>()->GetId () <<
-                " txTheta " << maxTxTheta <<
-                " rxTheta " << maxRxTheta <<
-                " tx sector " << (M_PI * static_cast<double> (maxTxSector) / static_cast<double> (gnbNumRows) - 0.5 * M_PI) / (M_PI) * 180 <<
-                " rx sector " << (M_PI * static_cast<double> (maxRxSector) / static_cast<double> (ueNumRows) - 0.5 * M_PI) / (M_PI) * 180);
+                " gnb beam " << m_gnbCodebook.m_beamIds[maxGnbBeam] <<
+                " ue beam " << m_ueCodebook.m_beamIds[maxUeBeam]);
 
  return bfPair;
 }
 
-double
-RealisticBeamformingAlgorithm::CalculateTheEstimatedLongTermMetric (const UniformPlanarArray::ComplexVector& longTermComponent) const
+const RealisticBeamformingAlgorithm::EstimatedChannelInfo&
+RealisticBeamformingAlgorithm::GetEstimatedChannelInfo (const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
+                                                        double srsSinr)
 {
   NS_LOG_FUNCTION (this);
+  uint32_t gnbArrayId = m_gnbSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel> ()->GetId ();
+  uint32_t ueArrayId = m_ueSpectrumPhy->GetAntenna ()->GetObject<PhasedArrayModel> ()->GetId ();
+  EstimatedChannelKey key = std::make_pair (std::make_pair (gnbArrayId, ueArrayId), channelMatrix->m_generatedTime);
 
-  double totalSum = 0;
-  for (std::complex<double> c:longTermComponent)
-    {
-      totalSum += c.imag () * c.imag () + c.real () * c.real ();
-    }
-  return totalSum;
-}
+  // the channel matrices generated before this one will not be used anymore:
+  // the delayed updates use them in order of generation
+  m_estimatedChannelCache.erase (m_estimatedChannelCache.begin (), m_estimatedChannelCache.lower_bound (key));
 
-
-UniformPlanarArray::ComplexVector
-RealisticBeamformingAlgorithm::GetEstimatedLongTermComponent (const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
-                                                              const UniformPlanarArray::ComplexVector &aW,
-                                                              const UniformPlanarArray::ComplexVector &bW,
-                                                              Ptr<const MobilityModel> a,
-                                                              Ptr<const MobilityModel> b,
-                                                              double srsSinr,
-                                                              Ptr<const PhasedArrayModel> aArray,
-                                                              Ptr<const PhasedArrayModel> bArray
-) const
-{
-  NS_LOG_FUNCTION (this);
-
-  // check if the channel matrix was generated considering a as the s-node and
-  // b as the u-node or viceversa
-  UniformPlanarArray::ComplexVector sW, uW;
-  if (!channelMatrix->IsReverse (aArray->GetId (), bArray->GetId ()))
+  auto it = m_estimatedChannelCache.find (key);
+  if (it == m_estimatedChannelCache.end () || it->second.m_srsSinr != srsSinr)
     {
-      sW = aW;
-      uW = bW;
+      NS_LOG_LOGIC ("Estimating the channel generated at " << channelMatrix->m_generatedTime.As (Time::MS) <<
+                    " with SRS report " << srsSinr);
+      EstimatedChannelInfo info;
+      info.m_srsSinr = srsSinr;
+      info.m_reverse = channelMatrix->IsReverse (gnbArrayId, ueArrayId);
+      info.m_estimate = GetEstimatedChannel (channelMatrix, srsSinr);
+      it = m_estimatedChannelCache.insert_or_assign (key, std::move (info)).first;
     }
-  else
+
+  EstimatedChannelInfo &info = it->second;
+  if (info.m_metric.empty ())
     {
-      sW = bW;
-      uW = aW;
+      size_t numGnbBeams = m_gnbCodebook.m_weights.size ();
+      size_t numUeBeams = m_ueCodebook.m_weights.size ();
+      info.m_metric.resize (numGnbBeams * numUeBeams);
+      if (!info.m_reverse)
+        {
+          // the gNB is the s-node: the metrics are by UE beam (row) and
+          // gNB beam (column), transpose them
+          std::vector<double> metric = GetLongTermMetrics (info.m_estimate, m_ueCodebook.m_weights, m_gnbCodebook.m_weights);
+          for (size_t gnbBeam = 0; gnbBeam < numGnbBeams; ++gnbBeam)
+            {
+              for (size_t ueBeam = 0; ueBeam < numUeBeams; ++ueBeam)
+                {
+                  info.m_metric[gnbBeam * numUeBeams + ueBeam] = metric[ueBeam * numGnbBeams + gnbBeam];
+                }
+            }
+        }
+      else
+        {
+          info.m_metric = GetLongTermMetrics (info.m_estimate, m_gnbCodebook.m_weights, m_ueCodebook.m_weights);
+        }
     }
+  return info;
+}
 
-  uint16_t sAntenna = static_cast<uint16_t> (sW.size ());
-  uint16_t uAntenna = static_cast<uint16_t> (uW.size ());
+RealisticBeamformingAlgorithm::ComplexMatrixPerCluster
+RealisticBeamformingAlgorithm::GetEstimatedChannel (const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
+                                                    double srsSinr) const
+{
+  NS_LOG_FUNCTION (this);
+  NS_ABORT_IF (srsSinr == 0);
 
-  NS_LOG_DEBUG ("Calculate the estimation of the long term component with sAntenna: " << sAntenna << " uAntenna: " << uAntenna);
-  UniformPlanarArray::ComplexVector estimatedlongTerm;
+  size_t uAntenna = channelMatrix->m_channel.size ();
+  size_t sAntenna = channelMatrix->m_channel[0].size ();
+  size_t numCluster = channelMatrix->m_channel[0][0].size ();
 
-  NS_ABORT_IF (srsSinr == 0);
+  NS_LOG_DEBUG ("Calculate the estimation of the channel with sAntenna: " << sAntenna << " uAntenna: " << uAntenna);
 
   double varError = 1 / (srsSinr); // SINR the SINR from UL SRS reception
-  uint8_t numCluster = static_cast<uint8_t> (channelMatrix->m_channel[0][0].size ());
+  ComplexMatrixPerCluster estimate (numCluster, complexVector_t (uAntenna * sAntenna));
 
-  for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+  for (size_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
-      std::complex<double> txSum (0,0);
-      for (uint16_t sIndex = 0; sIndex < sAntenna; sIndex++)
+      for (size_t sIndex = 0; sIndex < sAntenna; sIndex++)
         {
-          std::complex<double> rxSum (0,0);
-          for (uint16_t uIndex = 0; uIndex < uAntenna; uIndex++)
+          for (size_t uIndex = 0; uIndex < uAntenna; uIndex++)
             {
               //error is generated from the normal random variable with mean 0 and  variance varError*sqrt(1/2) for real/imaginary parts
               std::complex<double> error = std::complex <double> (m_normalRandomVariable->GetValue (0, sqrt (0.5) * varError),
                                                                   m_normalRandomVariable->GetValue (0, sqrt (0.5) * varError)) ;
-              std::complex<double> hEstimate = channelMatrix->m_channel [uIndex][sIndex][cIndex] + error;
-              rxSum += uW[uIndex] * (hEstimate);
+              estimate[cIndex][uIndex * sAntenna + sIndex] = channelMatrix->m_channel [uIndex][sIndex][cIndex] + error;
+            }
+        }
+    }
+  return estimate;
+}
+
+std::vector<double>
+RealisticBeamformingAlgorithm::GetLongTermMetrics (const ComplexMatrixPerCluster &channel,
+                                                   const std::vector<complexVector_t> &uW,
+                                                   const std::vector<complexVector_t> &sW)
+{
+  size_t numUBeams = uW.size ();
+  size_t numSBeams = sW.size ();
+  std::vector<double> metric (numUBeams * numSBeams, 0.0);
+  if (numUBeams == 0 || numSBeams == 0)
+    {
+      return metric;
+    }
+
+  size_t uAntenna = uW.front ().size ();
+  size_t sAntenna = sW.front ().size ();
+
+  // T = H_c S, stored by rows (u antenna) with a column per s beam
+  complexVector_t t (uAntenna * numSBeams);
+
+  for (const auto &h : channel)
+    {
+      NS_ASSERT_MSG (h.size () == uAntenna * sAntenna, "The beamforming vectors do not match the channel matrix");
+      std::fill (t.begin (), t.end (), std::complex<double> (0, 0));
+      for (size_t uIndex = 0; uIndex < uAntenna; uIndex++)
+        {
+          std::complex<double> *tRow = &t[uIndex * numSBeams];
+          for (size_t sIndex = 0; sIndex < sAntenna; sIndex++)
+            {
+              const std::complex<double> hElem = h[uIndex * sAntenna + sIndex];
+              for (size_t j = 0; j < numSBeams; j++)
+                {
+                  tRow[j] += hElem * sW[j][sIndex];
+                }
+            }
+        }
+
+      // U^T T, accumulating the squared magnitude over the clusters
+      for (size_t i = 0; i < numUBeams; i++)
+        {
+          double *metricRow = &metric[i * numSBeams];
+          for (size_t j = 0; j < numSBeams; j++)
+            {
+              std::complex<double> sum (0, 0);
+              for (size_t uIndex = 0; uIndex < uAntenna; uIndex++)
+                {
+                  sum += uW[i][uIndex] * t[uIndex * numSBeams + j];
+                }
+              metricRow[j] += std::norm (sum);
             }
-          txSum = txSum + sW[sIndex] * rxSum;
         }
-      estimatedlongTerm.push_back (txSum);
     }
-  return estimatedlongTerm;
+  return metric;
 }
 
 } // end of namespace ns-3
@@ -28,6 +28,7 @@
 #include "nr-ue-net-device.h"
 #include "nr-gnb-net-device.h"
 #include <queue>
+#include <map>
 
 namespace ns3 {
 
@@ -182,6 +183,30 @@ public:
    */
   bool UseSnrSrs () const;
 
+  /**
+   * \brief A complex matrix per cluster, stored by rows: the element (u, s)
+   * of the matrix of the cluster c is the element [c][u * numS + s]
+   */
+  typedef std::vector<complexVector_t> ComplexMatrixPerCluster;
+
+  /**
+   * \brief Calculates the long term metric of all the pairs of u and s
+   * beams with one matrix product per cluster
+   *
+   * The metric of the pair (i, j) is sum_c |uW_i^T H_c sW_j|^2. It is
+   * obtained as the squared magnitude of the elements of U^T (H_c S), where
+   * the columns of U and S are the beamforming vectors of the u and s
+   * devices, summed over the clusters.
+   *
+   * \param channel the channel matrix of each cluster, of size numU x numS
+   * \param uW the beamforming vectors of the u device
+   * \param sW the beamforming vectors of the s device
+   * \return the metric of each pair, the pair (i, j) at i * sW.size () + j
+   */
+  static std::vector<double> GetLongTermMetrics (const ComplexMatrixPerCluster &channel,
+                                                 const std::vector<complexVector_t> &uW,
+                                                 const std::vector<complexVector_t> &sW);
+
 private:
 
   /**
@@ -230,31 +255,66 @@ private:
    */
   Ptr<const MatrixBasedChannelModel::ChannelMatrix> GetChannelMatrix () const;
   /**
-   * \brief Calculates an estimation of the long term component based on the channel measurements
-   * \param channelMatrix the channel matrix H
-   * \param aW the beamforming vector of the first device
-   * \param bW the beamforming vector of the second device
-   * \param a the first node mobility model
-   * \param b the second node mobility model
-   * \param srsSinr the SRS report to be used to estimate the long term component metric
-   * \param aArray the antenna array of the first device
-   * \param bArray the antenna array of the second device
-   * \return the estimated long term component
-   */
-  UniformPlanarArray::ComplexVector GetEstimatedLongTermComponent (const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
-                                                                          const UniformPlanarArray::ComplexVector &aW,
-                                                                          const UniformPlanarArray::ComplexVector &bW,
-                                                                          Ptr<const MobilityModel> a,
-                                                                          Ptr<const MobilityModel> b,
-                                                                          double srsSinr,
-                                                                          Ptr<const PhasedArrayModel> aArray,
-                                                                          Ptr<const PhasedArrayModel> bArray) const;
+   * \brief The beams among which the algorithm searches the best pair, and
+   * their beamforming vectors
+   */
+  struct Codebook
+  {
+    std::vector<BeamId> m_beamIds;          //!< the id of each beam
+    std::vector<complexVector_t> m_weights; //!< the beamforming vector of each beam
+  };
 
-  /*
-   * \brief Calculates the total metric based on the each element of the long term component
-   * \param longTermComponent the vector of complex numbers representing the long term component per cluster
+  /**
+   * \brief The estimation of the channel obtained from an SRS report, and
+   * the estimated long term metric of each pair of beams of the codebooks
+   */
+  struct EstimatedChannelInfo
+  {
+    double m_srsSinr {0};                    //!< the SRS SINR/SNR used for the estimation
+    bool m_reverse {false};                  //!< true if the gNB is the u-node of the channel matrix
+    ComplexMatrixPerCluster m_estimate;      //!< the estimated channel matrix
+    std::vector<double> m_metric;            //!< the metric of each gNB beam (row) and UE beam (column), empty if not computed yet
+  };
+
+  /**
+   * \brief Key of the cache of the estimated channels: the ids of the gNB
+   * and UE antenna arrays, and the generation time of the channel matrix
+   */
+  typedef std::pair<std::pair<uint32_t, uint32_t>, Time> EstimatedChannelKey;
+
+  /**
+   * \brief Create the codebook of a device, by setting each sector and
+   * elevation in its beam manager
+   * \param spectrumPhy the spectrum phy of the device
+   * \param thetas the elevation angles of the beams
+   * \return the codebook
+   */
+  static Codebook CreateCodebook (const Ptr<NrSpectrumPhy>& spectrumPhy, const std::vector<double> &thetas);
+  /**
+   * \brief Create the codebooks of the gNB and the UE, if they do not exist
+   * or if the antenna arrays have changed
+   */
+  void UpdateCodebooks ();
+  /**
+   * \brief Estimates the channel matrix based on the channel measurements,
+   * by adding to each element of the channel matrix an error whose variance
+   * depends on the SRS report
+   * \param channelMatrix the channel matrix H
+   * \param srsSinr the SRS report to be used to estimate the channel
+   * \return the estimated channel matrix
+   */
+  ComplexMatrixPerCluster GetEstimatedChannel (const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
+                                               double srsSinr) const;
+  /**
+   * \brief Get the estimation of the channel and the long term metric of
+   * each pair of beams from the cache, or compute them if the channel matrix
+   * or the SRS report have changed since the last call
+   * \param channelMatrix the channel matrix H
+   * \param srsSinr the SRS report to be used to estimate the channel
+   * \return the estimated channel information
    */
-  double CalculateTheEstimatedLongTermMetric (const UniformPlanarArray::ComplexVector& longTermComponent) const;
+  const EstimatedChannelInfo& GetEstimatedChannelInfo (const Ptr<const MatrixBasedChannelModel::ChannelMatrix>& channelMatrix,
+                                                       double srsSinr);
 
   /**
    * \brief Removes the "oldest" delayed update info - from the beggining of the queue
@@ -272,6 +332,9 @@ private:
                                         //   m_srsSymbolsPerSlotCounter reaches the number of symbols per SRS transmission, i.e., when SRS transmissions in the
                                         //   current slot have finished*/
   Ptr<NormalRandomVariable> m_normalRandomVariable; //!< The random variable used for the estimation of the error
+  Codebook m_gnbCodebook; //!< The beams of the gNB among which the best one is searched
+  Codebook m_ueCodebook;  //!< The beams of the UE among which the best one is searched
+  std::map<EstimatedChannelKey, EstimatedChannelInfo> m_estimatedChannelCache; //!< The estimated channels, by link and generation of the channel matrix
   RealisticBfHelperCallback m_helperCallback; //!< When it is necessary to update the beamforming vectors for this pair of devices,
                                               //the helper will be notified through this callback
   /*
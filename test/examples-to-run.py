@@ -56,6 +56,7 @@ cpp_examples = [
     ("cttc-nr-mimo-demo --crossPolarizedGnb=0 --crossPolarizedUe=0", "True", "True"),
     ("nr-v2x-west-to-east-highway --enableSensing=1 --simTag=testpy-sensing", "True", "True"),
     ("nr-v2x-west-to-east-highway --enableSensing=0 --simTag=testpy-nosensing", "True", "True"),
+    ("nr-v2x-west-to-east-highway --enableSensing=1 --numVehiclesPerLane=3 --numLanes=2 --simTime=2 --checkStreamingKpis=1 --simTag=testpy-streaming-kpis", "True", "False"),
     ("cttc-nr-v2x-demo-simple --simTag=testpy", "True", "True"),
     ]
 
@@ -71,6 +71,21 @@ private:
   enum TestDuration m_duration {TestCase::QUICK}; //!< the test execution mode type
 };
 
+/**
+ * \brief Check that the long term metrics of all the beam pairs, computed
+ * with one matrix product per cluster, are equal to the ones computed one
+ * pair at a time
+ */
+class NrRealisticBeamformingMetricsTestCase : public TestCase
+{
+public:
+  NrRealisticBeamformingMetricsTestCase () : TestCase ("RealisticBeamforming batched long term metrics")
+  {}
+
+private:
+  virtual void DoRun (void);
+};
+
 
 /**
  * TestSuite
@@ -86,6 +101,7 @@ NrRealisticBeamformingTestSuite::NrRealisticBeamformingTestSuite ()
 
   AddTestCase (new NrRealisticBeamformingTestCase ("RealisticBeamforming basic test case", durationQuick), durationQuick);
   AddTestCase (new NrRealisticBeamformingTestCase ("RealisticBeamforming basic test case", durationExtensive), durationExtensive);
+  AddTestCase (new NrRealisticBeamformingMetricsTestCase, durationQuick);
 
 
 }
@@ -276,6 +292,60 @@ NrRealisticBeamformingTestCase::DoRun (void)
   Simulator::Destroy ();
 }
 
+void
+NrRealisticBeamformingMetricsTestCase::DoRun (void)
+{
+  const size_t uAntenna = 4, sAntenna = 6, numCluster = 3, numUBeams = 5, numSBeams = 7;
+
+  Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable> ();
+  rv->SetStream (1);
+  auto randomComplex = [rv] () { return std::complex<double> (rv->GetValue (-1, 1), rv->GetValue (-1, 1)); };
+
+  RealisticBeamformingAlgorithm::ComplexMatrixPerCluster channel (numCluster, complexVector_t (uAntenna * sAntenna));
+  for (auto &h : channel)
+    {
+      for (auto &elem : h)
+        {
+          elem = randomComplex ();
+        }
+    }
+  std::vector<complexVector_t> uW (numUBeams, complexVector_t (uAntenna));
+  std::vector<complexVector_t> sW (numSBeams, complexVector_t (sAntenna));
+  for (auto &w : uW)
+    {
+      std::generate (w.begin (), w.end (), randomComplex);
+    }
+  for (auto &w : sW)
+    {
+      std::generate (w.begin (), w.end (), randomComplex);
+    }
+
+  std::vector<double> metric = RealisticBeamformingAlgorithm::GetLongTermMetrics (channel, uW, sW);
+  NS_TEST_ASSERT_MSG_EQ (metric.size (), numUBeams * numSBeams, "Wrong number of metrics");
+
+  for (size_t i = 0; i < numUBeams; ++i)
+    {
+      for (size_t j = 0; j < numSBeams; ++j)
+        {
+          double expected = 0;
+          for (const auto &h : channel)
+            {
+              std::complex<double> sum (0, 0);
+              for (size_t s = 0; s < sAntenna; ++s)
+                {
+                  for (size_t u = 0; u < uAntenna; ++u)
+                    {
+                      sum += uW[i][u] * h[u * sAntenna + s] * sW[j][s];
+                    }
+                }
+              expected += std::norm (sum);
+            }
+          NS_TEST_ASSERT_MSG_EQ_TOL (metric[i * numSBeams + j], expected, 1e-9 * expected,
+                                     "Wrong metric of the pair " << i << ", " << j);
+        }
+    }
+}
+
 // Do not forget to allocate an instance of this TestSuite
 static NrRealisticBeamformingTestSuite nrTestSuite;
 
@@ -0,0 +1,130 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/nr-bearer-stats-calculator.h>
+#include <fstream>
+
+/**
+ * \file nr-test-bearer-stats.cc
+ * \ingroup test
+ *
+ * \brief Check the counters, the delay statistics and the delay percentiles
+ * of NrBearerStatsCalculator, with enough bearers to grow its hash table.
+ */
+namespace ns3 {
+
+class NrBearerStatsTestCase : public TestCase
+{
+public:
+  NrBearerStatsTestCase () : TestCase ("Counters and delay percentiles of NrBearerStatsCalculator")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrBearerStatsTestCase::DoRun ()
+{
+  const uint32_t numBearers = 200;
+  const uint32_t numPdus = 1000;
+  std::string dlFilename = CreateTempDirFilename ("NrDlRlcStats.txt");
+  std::string ulFilename = CreateTempDirFilename ("NrUlRlcStats.txt");
+
+  Ptr<NrBearerStatsCalculator> stats = CreateObject<NrBearerStatsCalculator> ("RLC");
+  stats->SetAttribute ("DlRlcOutputFilename", StringValue (dlFilename));
+  stats->SetAttribute ("UlRlcOutputFilename", StringValue (ulFilename));
+
+  // One PDU for each bearer, with two LCIDs per IMSI
+  for (uint32_t i = 0; i < numBearers; ++i)
+    {
+      uint64_t imsi = 1 + i / 2;
+      uint8_t lcid = 3 + i % 2;
+      stats->DlTxPdu (1, imsi, static_cast<uint16_t> (imsi), lcid, 100);
+      stats->DlRxPdu (1, imsi, static_cast<uint16_t> (imsi), lcid, 100, 1000 * (i + 1));
+    }
+  // Delays from 1 us to 1 ms on the first bearer
+  for (uint32_t i = 1; i < numPdus; ++i)
+    {
+      stats->DlTxPdu (1, 1, 1, 3, 50);
+      stats->DlRxPdu (1, 1, 1, 3, 50, 1000 * (i + 1));
+    }
+
+  for (uint32_t i = 0; i < numBearers; ++i)
+    {
+      uint64_t imsi = 1 + i / 2;
+      uint8_t lcid = 3 + i % 2;
+      uint32_t expected = i == 0 ? numPdus : 1;
+      NS_TEST_ASSERT_MSG_EQ (stats->GetDlTxPackets (imsi, lcid), expected, "Wrong TX PDUs of bearer " << i);
+      NS_TEST_ASSERT_MSG_EQ (stats->GetDlRxPackets (imsi, lcid), expected, "Wrong RX PDUs of bearer " << i);
+      NS_TEST_ASSERT_MSG_EQ (stats->GetDlCellId (imsi, lcid), 1, "Wrong cell of bearer " << i);
+    }
+  NS_TEST_ASSERT_MSG_EQ (stats->GetDlTxData (1, 3), 100 + 50 * (numPdus - 1), "Wrong TX bytes");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetDlTxPackets (1000, 3), 0, "Unknown bearers should have no PDUs");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetUlTxPackets (1, 3), 0, "The UL should have no PDUs");
+
+  std::vector<double> delay = stats->GetDlDelayStats (1, 3);
+  NS_TEST_ASSERT_MSG_EQ_TOL (delay.at (0), 500500.0, 1e-6, "Wrong average delay");
+  NS_TEST_ASSERT_MSG_EQ_TOL (delay.at (2), 1000.0, 1e-6, "Wrong minimum delay");
+  NS_TEST_ASSERT_MSG_EQ_TOL (delay.at (3), 1000000.0, 1e-6, "Wrong maximum delay");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetDlDelay (1, 3), 500500.0, 1e-6, "Wrong average delay");
+
+  // The histogram keeps the delay within 1 / DELAY_SUB_BUCKETS of its value
+  const double relTol = 1.0 / NrBearerStatsCalculator::DELAY_SUB_BUCKETS;
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetDlDelayPercentile (1, 3, 95.0), 950000.0, 950000.0 * relTol, "Wrong P95");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetDlDelayPercentile (1, 3, 99.0), 990000.0, 990000.0 * relTol, "Wrong P99");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetDlDelayPercentile (1, 3, 100.0), 1000000.0, 1e-6, "Wrong P100");
+  NS_TEST_ASSERT_MSG_EQ_TOL (stats->GetDlDelayPercentile (1, 4, 99.0), 2000.0, 1e-6,
+                             "A single delay should be its own percentile");
+  NS_TEST_ASSERT_MSG_EQ (stats->GetUlDelayPercentile (1, 3, 99.0), 0.0, "The UL should have no delay");
+
+  // The results are written at the end, one line per bearer after the header
+  stats->Dispose ();
+  std::ifstream dlFile (dlFilename);
+  NS_TEST_ASSERT_MSG_EQ (dlFile.is_open (), true, "Can't open " << dlFilename);
+  std::string line;
+  std::getline (dlFile, line);
+  NS_TEST_ASSERT_MSG_NE (line.find ("delayP95(s)\tdelayP99(s)"), std::string::npos,
+                         "The header should have the percentiles");
+  std::getline (dlFile, line);
+  NS_TEST_ASSERT_MSG_EQ (line.find ("0\t0.25\t1\t1\t1\t3\t1000\t"), 0, "The first bearer should come first");
+  uint32_t numLines = 1;
+  while (std::getline (dlFile, line))
+    {
+      numLines++;
+    }
+  NS_TEST_ASSERT_MSG_EQ (numLines, numBearers, "There should be one line per bearer");
+
+  Simulator::Destroy ();
+}
+
+class NrBearerStatsTestSuite : public TestSuite
+{
+public:
+  NrBearerStatsTestSuite () : TestSuite ("nr-test-bearer-stats", UNIT)
+  {
+    AddTestCase (new NrBearerStatsTestCase, TestCase::QUICK);
+  }
+};
+
+static NrBearerStatsTestSuite nrBearerStatsTestSuite; //!< NR bearer stats test suite
+
+} // namespace ns3
@@ -0,0 +1,536 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/object-factory.h>
+#include <ns3/bwp-manager-algorithm.h>
+#include <ns3/bwp-manager-gnb.h>
+#include <ns3/lte-mac-sap.h>
+#include <ns3/nstime.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/nr-module.h>
+#include <ns3/eps-bearer-tag.h>
+#include <algorithm>
+
+/**
+ * \file nr-test-bwp-manager-dynamic.cc
+ * \ingroup test
+ *
+ * \brief Check that BwpManagerAlgorithmDynamic balances the throughput of
+ * two BWPs when all the flows are configured in the first one, and that it
+ * respects the per-QCI constraints.
+ *
+ * The BWPs are modelled as fluid servers of a fixed capacity per slot,
+ * shared among the flows routed to them in proportion to their backlog.
+ * They report to the algorithm their utilization, and the flows their
+ * backlog, as BwpManagerGnb does with the PHY and RLC reports. With the
+ * static algorithm, the first BWP saturates while the second one idles;
+ * with the dynamic one, the offered traffic is carried by both BWPs.
+ *
+ * The same comparison is then made in a NR scenario: a gNB with two BWPs,
+ * one in each component carrier, serves a downlink flow that saturates one
+ * BWP. The bytes received by the UE PHY in each BWP show that the dynamic
+ * algorithm routes the flow through both BWPs, while the static one keeps
+ * it in the first one.
+ *
+ * Through BwpManagerGnb, the test also checks that a flow that moves leaves
+ * an empty buffer status in its old BWP, and that the state of the flows is
+ * forgotten when their bearer or their UE is released.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Serve skewed traffic with two BWPs and check the throughput of each
+ */
+class BwpLoadBalancingTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param algorithm the TypeId of the BWP manager algorithm
+   * \param balanced true if the algorithm should balance the load
+   */
+  BwpLoadBalancingTestCase (const TypeId &algorithm, bool balanced)
+    : TestCase ("Throughput of two BWPs under skewed load with " + algorithm.GetName ()),
+      m_algorithmType (algorithm),
+      m_balanced (balanced)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Serve one slot: the flows receive new bytes, report their
+   *        backlog, and the BWPs serve them
+   */
+  void Step ();
+
+  static const uint32_t NUM_FLOWS = 8;       //!< Number of flows
+  static const uint32_t NUM_BWPS = 2;        //!< Number of BWPs
+  const double m_capacity {10000.0};         //!< Bytes served by a BWP in a slot
+  const double m_rate {1875.0};              //!< Bytes offered by a flow in a slot (8 flows = 1.5 BWPs)
+  const Time m_slot {MilliSeconds (1)};      //!< Duration of a slot
+  const Time m_warmup {MilliSeconds (500)};  //!< Time before measuring the throughput
+  const Time m_duration {MilliSeconds (2000)}; //!< Duration of the test
+
+  TypeId m_algorithmType;                    //!< Type of the algorithm under test
+  bool m_balanced;                           //!< Expected balancing
+  Ptr<BwpManagerAlgorithm> m_algorithm;      //!< The algorithm under test
+  std::vector<double> m_backlog;             //!< Backlog of each flow
+  std::vector<double> m_served;              //!< Bytes served by each BWP after the warmup
+};
+
+void
+BwpLoadBalancingTestCase::Step ()
+{
+  std::vector<double> demand (NUM_BWPS, 0.0);
+  std::vector<uint8_t> flowBwp (NUM_FLOWS, 0);
+
+  for (uint32_t i = 0; i < NUM_FLOWS; ++i)
+    {
+      m_backlog.at (i) += m_rate;
+      uint16_t rnti = i + 1;
+      flowBwp.at (i) = m_algorithm->GetBwpForFlow (rnti, 3, EpsBearer::NGBR_VIDEO_TCP_DEFAULT);
+      NS_TEST_ASSERT_MSG_LT (flowBwp.at (i), NUM_BWPS, "Invalid BWP");
+      m_algorithm->NotifyBufferStatus (flowBwp.at (i), rnti, 3, static_cast<uint32_t> (m_backlog.at (i)));
+      demand.at (flowBwp.at (i)) += m_backlog.at (i);
+    }
+
+  std::vector<double> served (NUM_BWPS, 0.0);
+  for (uint32_t b = 0; b < NUM_BWPS; ++b)
+    {
+      served.at (b) = std::min (m_capacity, demand.at (b));
+      m_algorithm->NotifySlotUsage (b, static_cast<uint32_t> (served.at (b) / m_capacity * 1000), 1000);
+      if (Simulator::Now () >= m_warmup)
+        {
+          m_served.at (b) += served.at (b);
+        }
+    }
+
+  for (uint32_t i = 0; i < NUM_FLOWS; ++i)
+    {
+      uint8_t b = flowBwp.at (i);
+      if (demand.at (b) > 0.0)
+        {
+          m_backlog.at (i) -= m_backlog.at (i) * served.at (b) / demand.at (b);
+        }
+    }
+
+  if (Simulator::Now () + m_slot < m_duration)
+    {
+      Simulator::Schedule (m_slot, &BwpLoadBalancingTestCase::Step, this);
+    }
+}
+
+void
+BwpLoadBalancingTestCase::DoRun ()
+{
+  // All the QCIs go in BWP 0 by default
+  ObjectFactory factory;
+  factory.SetTypeId (m_algorithmType);
+  m_algorithm = factory.Create<BwpManagerAlgorithm> ();
+  m_backlog.assign (NUM_FLOWS, 0.0);
+  m_served.assign (NUM_BWPS, 0.0);
+
+  Simulator::Schedule (Seconds (0), &BwpLoadBalancingTestCase::Step, this);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  double slots = (m_duration - m_warmup).GetSeconds () / m_slot.GetSeconds ();
+  double offered = NUM_FLOWS * m_rate * slots;
+  double total = m_served.at (0) + m_served.at (1);
+
+  if (m_balanced)
+    {
+      NS_TEST_ASSERT_MSG_GT (total, 0.95 * offered, "The two BWPs should carry all the offered traffic");
+      NS_TEST_ASSERT_MSG_GT (m_served.at (1) / total, 0.35, "BWP 1 should carry about half of the traffic");
+      NS_TEST_ASSERT_MSG_LT (m_served.at (1) / total, 0.65, "BWP 1 should carry about half of the traffic");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_served.at (1), 0.0, "The static algorithm should not use BWP 1");
+      NS_TEST_ASSERT_MSG_LT (total, 0.7 * offered, "BWP 0 alone cannot carry the offered traffic");
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief Serve a saturating downlink flow in a NR scenario with two BWPs,
+ * and check the bytes received in each BWP
+ */
+class BwpLoadBalancingSystemTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Constructor
+   * \param algorithm the TypeId of the BWP manager algorithm of the gNB
+   * \param balanced true if the algorithm should balance the load
+   */
+  BwpLoadBalancingSystemTestCase (const TypeId &algorithm, bool balanced)
+    : TestCase ("Bytes received in two NR BWPs with " + algorithm.GetName ()),
+      m_algorithmType (algorithm),
+      m_balanced (balanced)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Send a packet of the flow to the gNB, and schedule the next one
+   * \param gnbDev the gNB device
+   * \param ueDev the UE device
+   */
+  void SendPacket (Ptr<NetDevice> gnbDev, Ptr<NetDevice> ueDev);
+  /**
+   * \brief Count the bytes of a TB received by the UE
+   * \param params the parameters of the reception
+   */
+  void RxPacket (RxPacketTraceParams params);
+
+  const uint32_t m_packetSize {1000};               //!< Size of the packets of the flow
+  const Time m_interval {MicroSeconds (40)};        //!< Interval between the packets (200 Mbps)
+  const Time m_trafficStart {MilliSeconds (300)};   //!< Start of the flow, after the attachment
+  const Time m_measureStart {MilliSeconds (500)};   //!< Start of the measurement
+  const Time m_duration {MilliSeconds (1500)};      //!< Duration of the simulation
+
+  TypeId m_algorithmType;                           //!< Type of the algorithm under test
+  bool m_balanced;                                  //!< Expected balancing
+  std::vector<uint64_t> m_rxBytes {0, 0};           //!< Bytes received in each BWP after m_measureStart
+};
+
+void
+BwpLoadBalancingSystemTestCase::SendPacket (Ptr<NetDevice> gnbDev, Ptr<NetDevice> ueDev)
+{
+  // As in the other system tests without applications: the UE drops the
+  // packet at the IP layer, after the PHY has received it
+  Ptr<Packet> pkt = Create<Packet> (m_packetSize);
+  Ipv4Header ipHeader;
+  pkt->AddHeader (ipHeader);
+  uint16_t rnti = DynamicCast<NrUeNetDevice> (ueDev)->GetRrc ()->GetRnti ();
+  EpsBearerTag tag (rnti, 1);
+  pkt->AddPacketTag (tag);
+  gnbDev->Send (pkt, ueDev->GetAddress (), Ipv4L3Protocol::PROT_NUMBER);
+
+  if (Simulator::Now () + m_interval < m_duration)
+    {
+      Simulator::Schedule (m_interval, &BwpLoadBalancingSystemTestCase::SendPacket, this, gnbDev, ueDev);
+    }
+}
+
+void
+BwpLoadBalancingSystemTestCase::RxPacket (RxPacketTraceParams params)
+{
+  if (! params.m_corrupt && Simulator::Now () >= m_measureStart)
+    {
+      NS_TEST_ASSERT_MSG_LT (params.m_bwpId, m_rxBytes.size (), "Invalid BWP");
+      m_rxBytes.at (params.m_bwpId) += params.m_tbSize;
+    }
+}
+
+void
+BwpLoadBalancingSystemTestCase::DoRun ()
+{
+  Ptr<Node> gnbNode = CreateObject<Node> ();
+  Ptr<Node> ueNode = CreateObject<Node> ();
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (gnbNode);
+  mobility.Install (ueNode);
+  gnbNode->GetObject<MobilityModel> ()->SetPosition (Vector (0.0, 0.0, 10.0));
+  ueNode->GetObject<MobilityModel> ()->SetPosition (Vector (0.0, 20.0, 1.5));
+
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper> ();
+  Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper> ();
+  idealBeamformingHelper->SetAttribute ("BeamformingMethod", TypeIdValue (DirectPathBeamforming::GetTypeId ()));
+  nrHelper->SetBeamformingHelper (idealBeamformingHelper);
+  nrHelper->SetEpcHelper (epcHelper);
+
+  // The flow (default bearer) is configured in BWP 0
+  nrHelper->SetGnbBwpManagerAlgorithmTypeId (m_algorithmType);
+  nrHelper->SetGnbPhyAttribute ("TxPower", DoubleValue (30.0));
+
+  // Two component carriers of 10 MHz, with one BWP each
+  CcBwpCreator ccBwpCreator;
+  CcBwpCreator::SimpleOperationBandConf bandConf (28e9, 20e6, 2, BandwidthPartInfo::UMi_StreetCanyon);
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+  nrHelper->SetChannelConditionModelAttribute ("UpdatePeriod", TimeValue (MilliSeconds (0)));
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+  NS_TEST_ASSERT_MSG_EQ (allBwps.size (), 2, "The scenario should have two BWPs");
+
+  NetDeviceContainer gnbDevs = nrHelper->InstallGnbDevice (gnbNode, allBwps);
+  NetDeviceContainer ueDevs = nrHelper->InstallUeDevice (ueNode, allBwps);
+  DynamicCast<NrGnbNetDevice> (gnbDevs.Get (0))->UpdateConfig ();
+  DynamicCast<NrUeNetDevice> (ueDevs.Get (0))->UpdateConfig ();
+
+  InternetStackHelper internet;
+  internet.Install (ueNode);
+  epcHelper->AssignUeIpv4Address (ueDevs);
+  nrHelper->AttachToClosestEnb (ueDevs, gnbDevs);
+
+  for (uint32_t bwp = 0; bwp < allBwps.size (); ++bwp)
+    {
+      NrHelper::GetUePhy (ueDevs.Get (0), bwp)->GetSpectrumPhy ()->TraceConnectWithoutContext (
+        "RxPacketTraceUe", MakeCallback (&BwpLoadBalancingSystemTestCase::RxPacket, this));
+    }
+
+  Simulator::Schedule (m_trafficStart, &BwpLoadBalancingSystemTestCase::SendPacket, this,
+                       gnbDevs.Get (0), ueDevs.Get (0));
+  Simulator::Stop (m_duration);
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  double total = static_cast<double> (m_rxBytes.at (0) + m_rxBytes.at (1));
+  NS_TEST_ASSERT_MSG_GT (total, 0.0, "The UE should receive the flow");
+  if (m_balanced)
+    {
+      NS_TEST_ASSERT_MSG_GT (m_rxBytes.at (0) / total, 0.2, "BWP 0 should carry part of the flow");
+      NS_TEST_ASSERT_MSG_GT (m_rxBytes.at (1) / total, 0.2, "BWP 1 should carry part of the flow");
+    }
+  else
+    {
+      NS_TEST_ASSERT_MSG_EQ (m_rxBytes.at (1), 0, "The static algorithm should not use BWP 1");
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief Check that the GBR flows and the flows of a restricted QCI do not
+ * leave their BWPs, while the other flows move to the idle BWP
+ */
+class BwpQciConstraintsTestCase : public TestCase
+{
+public:
+  BwpQciConstraintsTestCase () : TestCase ("Per-QCI constraints of the dynamic BWP manager algorithm")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+BwpQciConstraintsTestCase::DoRun ()
+{
+  Ptr<BwpManagerAlgorithmDynamic> algorithm = CreateObject<BwpManagerAlgorithmDynamic> ();
+  algorithm->SetAllowedBwps (EpsBearer::NGBR_IMS, {0});
+
+  // BWP 0 saturated, BWP 1 idle
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      algorithm->NotifySlotUsage (0, 1000, 1000);
+      algorithm->NotifySlotUsage (1, 0, 1000);
+    }
+  NS_TEST_ASSERT_MSG_GT (algorithm->GetBwpUtilization (0), 0.99, "BWP 0 should be saturated");
+
+  NS_TEST_ASSERT_MSG_EQ (+algorithm->GetBwpForFlow (1, 3, EpsBearer::GBR_CONV_VOICE), 0,
+                         "A GBR flow should stay in its BWP");
+  NS_TEST_ASSERT_MSG_EQ (+algorithm->GetBwpForFlow (2, 3, EpsBearer::NGBR_IMS), 0,
+                         "A flow should stay in the BWPs allowed for its QCI");
+  NS_TEST_ASSERT_MSG_EQ (+algorithm->GetBwpForFlow (3, 3, EpsBearer::NGBR_VIDEO_TCP_DEFAULT), 1,
+                         "A non-GBR flow should move to the idle BWP");
+  NS_TEST_ASSERT_MSG_EQ (+algorithm->PeekBwpForFlow (3, 3, EpsBearer::NGBR_VIDEO_TCP_DEFAULT), 1,
+                         "Peek should return the BWP of the flow");
+
+  // Within the dwell time, the flow does not go back even if BWP 1 saturates
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      algorithm->NotifySlotUsage (0, 0, 1000);
+      algorithm->NotifySlotUsage (1, 1000, 1000);
+    }
+  NS_TEST_ASSERT_MSG_EQ (+algorithm->GetBwpForFlow (3, 3, EpsBearer::NGBR_VIDEO_TCP_DEFAULT), 1,
+                         "A flow should not move again within the dwell time");
+
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief A MAC SAP provider that records the buffer status reports
+ */
+class BwpTestMacSapProvider : public LteMacSapProvider
+{
+public:
+  virtual void TransmitPdu ([[maybe_unused]] TransmitPduParameters params) override
+  {}
+  virtual void ReportBufferStatus (ReportBufferStatusParameters params) override
+  {
+    m_bsr.push_back (params);
+  }
+
+  std::vector<ReportBufferStatusParameters> m_bsr; //!< The BSRs received
+};
+
+/**
+ * \ingroup test
+ * \brief A BwpManagerGnb that exposes the methods called by the RRC and the RLC
+ */
+class NrTestBwpManagerGnb : public BwpManagerGnb
+{
+public:
+  using BwpManagerGnb::DoAddUe;
+  using BwpManagerGnb::DoSetupDataRadioBearer;
+  using BwpManagerGnb::DoReleaseDataRadioBearer;
+  using BwpManagerGnb::DoRemoveUe;
+  using BwpManagerGnb::DoReportBufferStatus;
+};
+
+/**
+ * \ingroup test
+ * \brief Move a flow through BwpManagerGnb, and release its bearer and its UE
+ */
+class BwpManagerGnbFlowTestCase : public TestCase
+{
+public:
+  BwpManagerGnbFlowTestCase () : TestCase ("Flow move and release through BwpManagerGnb")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Send a BSR to the manager
+   * \param rnti the RNTI of the UE
+   * \param lcid the LCID of the flow
+   * \param bytes the bytes in the RLC transmission queue
+   */
+  void ReportBufferStatus (uint16_t rnti, uint8_t lcid, uint32_t bytes);
+  /**
+   * \brief Report the usage of the two BWPs for some slots
+   * \param usedBwp0 the resources used in BWP 0, out of 1000
+   * \param usedBwp1 the resources used in BWP 1, out of 1000
+   */
+  void ReportUsage (uint32_t usedBwp0, uint32_t usedBwp1);
+
+  Ptr<NrTestBwpManagerGnb> m_manager;           //!< The manager under test
+  Ptr<BwpManagerAlgorithmDynamic> m_algorithm;  //!< The algorithm of the manager
+};
+
+void
+BwpManagerGnbFlowTestCase::ReportBufferStatus (uint16_t rnti, uint8_t lcid, uint32_t bytes)
+{
+  LteMacSapProvider::ReportBufferStatusParameters params {};
+  params.rnti = rnti;
+  params.lcid = lcid;
+  params.txQueueSize = bytes;
+  m_manager->DoReportBufferStatus (params);
+}
+
+void
+BwpManagerGnbFlowTestCase::ReportUsage (uint32_t usedBwp0, uint32_t usedBwp1)
+{
+  for (uint32_t i = 0; i < 100; ++i)
+    {
+      m_algorithm->NotifySlotUsage (0, usedBwp0, 1000);
+      m_algorithm->NotifySlotUsage (1, usedBwp1, 1000);
+    }
+}
+
+void
+BwpManagerGnbFlowTestCase::DoRun ()
+{
+  m_algorithm = CreateObject<BwpManagerAlgorithmDynamic> ();
+  m_algorithm->SetAttribute ("MinDwellTime", TimeValue (Seconds (0)));
+
+  BwpTestMacSapProvider bwp0;
+  BwpTestMacSapProvider bwp1;
+  m_manager = CreateObject<NrTestBwpManagerGnb> ();
+  m_manager->SetNumberOfComponentCarriers (2);
+  m_manager->SetMacSapProvider (0, &bwp0);
+  m_manager->SetMacSapProvider (1, &bwp1);
+  m_manager->SetBwpManagerAlgorithm (m_algorithm);
+
+  const uint16_t rnti = 1;
+  const uint8_t lcid = 3;
+  const EpsBearer bearer (EpsBearer::NGBR_VIDEO_TCP_DEFAULT);
+  m_manager->DoAddUe (rnti, 0);
+  m_manager->DoSetupDataRadioBearer (bearer, 1, rnti, lcid, 1, nullptr);
+
+  // Both BWPs idle: the flow goes in the BWP of its QCI
+  ReportBufferStatus (rnti, lcid, 1000);
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.size (), 1, "The first BSR should go to BWP 0");
+  NS_TEST_ASSERT_MSG_EQ (bwp1.m_bsr.size (), 0, "BWP 1 should not receive the first BSR");
+
+  // BWP 0 saturated: the flow moves to BWP 1, and BWP 0 receives an empty
+  // BSR so that its scheduler stops serving the flow
+  ReportUsage (1000, 0);
+  ReportBufferStatus (rnti, lcid, 800);
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.size (), 2, "BWP 0 should receive the empty BSR");
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.back ().txQueueSize, 0, "The BSR of the old BWP should be empty");
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.back ().retxQueueSize, 0, "The BSR of the old BWP should be empty");
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.back ().statusPduSize, 0, "The BSR of the old BWP should be empty");
+  NS_TEST_ASSERT_MSG_EQ (bwp1.m_bsr.size (), 1, "The BSR should follow the flow in BWP 1");
+  NS_TEST_ASSERT_MSG_EQ (bwp1.m_bsr.back ().txQueueSize, 800, "Wrong BSR in the new BWP");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_algorithm->GetBwpLoad (1), 1.0, 1e-9, "BWP 1 should queue all the bytes");
+
+  // Release the bearer: the algorithm forgets the flow and its bytes
+  ReportUsage (0, 0);
+  m_manager->DoReleaseDataRadioBearer (rnti, lcid);
+  NS_TEST_ASSERT_MSG_EQ (m_algorithm->GetNumFlows (), 0, "The released flow should be forgotten");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_algorithm->GetBwpLoad (1), m_algorithm->GetBwpUtilization (1), 1e-9,
+                             "The bytes of the released flow should not count in the load");
+
+  // A new bearer with the same LCID starts in the BWP of its QCI, without
+  // an empty BSR to the BWP of the released one
+  m_manager->DoSetupDataRadioBearer (bearer, 1, rnti, lcid, 1, nullptr);
+  ReportBufferStatus (rnti, lcid, 500);
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.size (), 3, "The BSR of the new bearer should go to BWP 0");
+  NS_TEST_ASSERT_MSG_EQ (bwp0.m_bsr.back ().txQueueSize, 500, "Wrong BSR of the new bearer");
+  NS_TEST_ASSERT_MSG_EQ (bwp1.m_bsr.size (), 1, "BWP 1 should not receive a BSR of the new bearer");
+
+  // Remove the UE: all its flows are forgotten
+  m_manager->DoSetupDataRadioBearer (bearer, 2, rnti, lcid + 1, 1, nullptr);
+  ReportBufferStatus (rnti, lcid + 1, 100);
+  NS_TEST_ASSERT_MSG_EQ (m_algorithm->GetNumFlows (), 2, "The UE should have two flows");
+  m_manager->DoRemoveUe (rnti);
+  NS_TEST_ASSERT_MSG_EQ (m_algorithm->GetNumFlows (), 0, "The flows of the removed UE should be forgotten");
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_algorithm->GetBwpLoad (0), m_algorithm->GetBwpUtilization (0), 1e-9,
+                             "The bytes of the removed UE should not count in the load");
+
+  m_manager->Dispose ();
+  m_manager = nullptr;
+  m_algorithm = nullptr;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief The test suite of the dynamic BWP manager algorithm
+ */
+class BwpManagerDynamicTestSuite : public TestSuite
+{
+public:
+  BwpManagerDynamicTestSuite () : TestSuite ("nr-test-bwp-manager-dynamic", UNIT)
+  {
+    AddTestCase (new BwpLoadBalancingTestCase (BwpManagerAlgorithmStatic::GetTypeId (), false), TestCase::QUICK);
+    AddTestCase (new BwpLoadBalancingTestCase (BwpManagerAlgorithmDynamic::GetTypeId (), true), TestCase::QUICK);
+    AddTestCase (new BwpLoadBalancingSystemTestCase (BwpManagerAlgorithmStatic::GetTypeId (), false),
+                 TestCase::QUICK);
+    AddTestCase (new BwpLoadBalancingSystemTestCase (BwpManagerAlgorithmDynamic::GetTypeId (), true),
+                 TestCase::QUICK);
+    AddTestCase (new BwpQciConstraintsTestCase, TestCase::QUICK);
+    AddTestCase (new BwpManagerGnbFlowTestCase, TestCase::QUICK);
+  }
+};
+
+static BwpManagerDynamicTestSuite bwpManagerDynamicTestSuite; //!< Dynamic BWP manager test suite
+
+} // namespace ns3
@@ -0,0 +1,629 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/core-module.h>
+#include <ns3/network-module.h>
+#include <ns3/mobility-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/nr-module.h>
+#include <ns3/nr-checkpoint.h>
+#include <ns3/nr-mac-scheduler-ue-info-pf.h>
+#include <ns3/eps-bearer-tag.h>
+
+#include <cmath>
+#include <fstream>
+#include <iterator>
+#include <limits>
+#include <map>
+
+/**
+ * \file nr-test-checkpoint.cc
+ * \ingroup test
+ *
+ * \brief Check the binary format of the NR checkpoints, and that saving a
+ * restored scheduler UE gives back the same bytes (so that a warm start is
+ * deterministic). A checkpoint of a gNB with two UEs is then restored in
+ * the same topology, built again from scratch, and in one with a different
+ * scheduler. Finally, the same scenario is run twice from a checkpoint saved
+ * after a warm up with traffic, and must give the same RLC and PHY
+ * statistics.
+ */
+namespace ns3 {
+
+class NrCheckpointFormatTestCase : public TestCase
+{
+public:
+  NrCheckpointFormatTestCase () : TestCase ("Values and records of the NR checkpoint")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrCheckpointFormatTestCase::DoRun ()
+{
+  NrCheckpointWriter writer;
+  writer.WriteU8 (0xab);
+  writer.WriteU16 (0x1234);
+  size_t outer = writer.BeginRecord ();
+  writer.WriteU32 (0xdeadbeef);
+  size_t inner = writer.BeginRecord ();
+  writer.WriteU64 (0x0123456789abcdefULL);
+  writer.WriteDouble (-std::numeric_limits<double>::infinity ());
+  writer.EndRecord (inner);
+  writer.WriteDoubleVector ({1.5, -2.25});
+  writer.EndRecord (outer);
+  writer.WriteU8Vector ({1, 2, 3});
+
+  const auto & buffer = writer.GetBuffer ();
+  // 1 + 2 + (4 + 4 + (4 + 8 + 8) + 4 + 16) + 4 + 3
+  NS_TEST_ASSERT_MSG_EQ (buffer.size (), 58, "Unexpected size of the checkpoint");
+  NS_TEST_ASSERT_MSG_EQ (+buffer.at (1), 0x34, "Values should be little endian");
+  NS_TEST_ASSERT_MSG_EQ (+buffer.at (3), 44, "Wrong length of the outer record");
+
+  NrCheckpointReader reader (buffer);
+  NS_TEST_ASSERT_MSG_EQ (+reader.ReadU8 (), 0xab, "Wrong 8-bit value");
+  NS_TEST_ASSERT_MSG_EQ (reader.ReadU16 (), 0x1234, "Wrong 16-bit value");
+  size_t outerEnd = reader.BeginRecord ();
+  NS_TEST_ASSERT_MSG_EQ (reader.ReadU32 (), 0xdeadbeef, "Wrong 32-bit value");
+  size_t innerEnd = reader.BeginRecord ();
+  NS_TEST_ASSERT_MSG_EQ (reader.ReadU64 (), 0x0123456789abcdefULL, "Wrong 64-bit value");
+  NS_TEST_ASSERT_MSG_EQ (std::isinf (reader.ReadDouble ()), true, "Wrong double");
+  NS_TEST_ASSERT_MSG_EQ (reader.IsAtEnd (), true, "The inner record should be read");
+  reader.EndRecord (innerEnd);
+  auto doubles = reader.ReadDoubleVector ();
+  NS_TEST_ASSERT_MSG_EQ (doubles.size (), 2, "Wrong size of the vector of doubles");
+  NS_TEST_ASSERT_MSG_EQ (doubles.at (1), -2.25, "Wrong vector of doubles");
+  reader.EndRecord (outerEnd);
+  NS_TEST_ASSERT_MSG_EQ (reader.ReadU8Vector ().size (), 3, "Wrong vector of bytes");
+  NS_TEST_ASSERT_MSG_EQ (reader.IsAtEnd (), true, "The checkpoint should be read");
+
+  // A record that is not read is skipped
+  NrCheckpointReader skipper (buffer);
+  skipper.ReadU8 ();
+  skipper.ReadU16 ();
+  skipper.EndRecord (skipper.BeginRecord ());
+  NS_TEST_ASSERT_MSG_EQ (+skipper.ReadU8Vector ().at (2), 3, "The record should be skipped");
+}
+
+class NrCheckpointUeStateTestCase : public TestCase
+{
+public:
+  NrCheckpointUeStateTestCase () : TestCase ("Save and restore of the scheduler UE state")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrCheckpointUeStateTestCase::DoRun ()
+{
+  auto numRbPerRbg = [] () { return 1; };
+  auto ue = std::make_shared<NrMacSchedulerUeInfoPF> (1.0, 7, BeamConfId (), numRbPerRbg);
+  ue->m_dlMcs = {12, 9};
+  ue->m_ulMcs = {5};
+  ue->m_ulRank = 1;
+  ue->m_ulSrsSinr = {12.5, 3.0};
+  ue->m_ulSrsMcs = {10, 2};
+  ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::SB;
+  ue->m_dlCqi.m_ri = 2;
+  ue->m_dlCqi.m_sinr = {20.0, 21.0};
+  ue->m_dlCqi.m_wbCqi = {11, 8};
+  ue->m_dlCqi.m_sbCqi = {{10, 11, 12}, {7, 8, 9}};
+  ue->m_dlCqi.m_rbPerSb = 4;
+  ue->m_dlCqi.m_timer = 99;
+  ue->m_ulCqi.m_sinr = {1.0, 2.0, 3.0};
+  ue->m_ulCqi.m_rbCqi = {-1, 4, 5};
+  ue->m_ulCqi.m_cqi = 6;
+  ue->m_ulCqi.m_timer = 42;
+  ue->m_srsSinrMean = 11.25;
+  ue->m_srsSinrVar = 0.5;
+  ue->m_srsReports = 3;
+  ue->m_ulPuschSinr = 9.5;
+  ue->m_tpcCorrection = 0.5;
+  ue->m_lastAvgTputDl = 1234.5;
+  ue->m_lastAvgTputUl = 678.25;
+
+  NrCheckpointWriter first;
+  ue->SaveState (first);
+
+  auto restored = std::make_shared<NrMacSchedulerUeInfoPF> (1.0, 7, BeamConfId (), numRbPerRbg);
+  NrCheckpointReader reader (first.GetBuffer ());
+  restored->RestoreState (reader);
+  NS_TEST_ASSERT_MSG_EQ (reader.IsAtEnd (), true, "The whole state should be read");
+
+  NS_TEST_ASSERT_MSG_EQ (restored->m_dlMcs.size (), 2, "Wrong number of DL streams");
+  NS_TEST_ASSERT_MSG_EQ (+restored->m_dlMcs.at (1), 9, "Wrong DL MCS");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_dlTbSize.size (), 2, "There should be a DL TB size per stream");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_dlCqi.m_cqiType, NrMacSchedulerUeInfo::DlCqiInfo::SB, "Wrong CQI type");
+  NS_TEST_ASSERT_MSG_EQ (+restored->m_dlCqi.m_sbCqi.at (1).at (2), 9, "Wrong sub-band CQI");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_ulCqi.m_rbCqi.at (0), -1, "Wrong RB CQI");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_ulCqi.m_timer, 42, "Wrong UL CQI timer");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_srsSinrMean, 11.25, "Wrong SRS SINR average");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_lastAvgTputDl, 1234.5, "Wrong PF DL average");
+  NS_TEST_ASSERT_MSG_EQ (restored->m_lastAvgTputUl, 678.25, "Wrong PF UL average");
+
+  // Determinism: the restored UE is saved exactly as the original one
+  NrCheckpointWriter second;
+  restored->SaveState (second);
+  NS_TEST_ASSERT_MSG_EQ ((first.GetBuffer () == second.GetBuffer ()), true,
+                         "Saving a restored UE should give the same checkpoint");
+}
+
+/**
+ * \brief Create a gNB and two UEs, and attach the UEs
+ * \param scheduler the type of the scheduler of the gNB
+ * \param gnbDevs the gNB device (output)
+ * \param ueDevs the UE devices (output)
+ * \return the NR helper
+ */
+static Ptr<NrHelper>
+BuildTopology (const std::string &scheduler, NetDeviceContainer *gnbDevs, NetDeviceContainer *ueDevs)
+{
+  NodeContainer gnbNodes;
+  NodeContainer ueNodes;
+  gnbNodes.Create (1);
+  ueNodes.Create (2);
+
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.Install (gnbNodes);
+  mobility.Install (ueNodes);
+  gnbNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (0.0, 0.0, 10.0));
+  ueNodes.Get (0)->GetObject<MobilityModel> ()->SetPosition (Vector (0.0, 20.0, 1.5));
+  ueNodes.Get (1)->GetObject<MobilityModel> ()->SetPosition (Vector (30.0, -10.0, 1.5));
+
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper> ();
+  Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper> ();
+  idealBeamformingHelper->SetAttribute ("BeamformingMethod", TypeIdValue (DirectPathBeamforming::GetTypeId ()));
+  nrHelper->SetBeamformingHelper (idealBeamformingHelper);
+  nrHelper->SetEpcHelper (epcHelper);
+  nrHelper->SetSchedulerTypeId (TypeId::LookupByName (scheduler));
+
+  CcBwpCreator ccBwpCreator;
+  CcBwpCreator::SimpleOperationBandConf bandConf (28e9, 50e6, 1, BandwidthPartInfo::UMi_StreetCanyon);
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+  nrHelper->SetChannelConditionModelAttribute ("UpdatePeriod", TimeValue (MilliSeconds (0)));
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+
+  *gnbDevs = nrHelper->InstallGnbDevice (gnbNodes, allBwps);
+  *ueDevs = nrHelper->InstallUeDevice (ueNodes, allBwps);
+  for (auto it = gnbDevs->Begin (); it != gnbDevs->End (); ++it)
+    {
+      DynamicCast<NrGnbNetDevice> (*it)->UpdateConfig ();
+    }
+  for (auto it = ueDevs->Begin (); it != ueDevs->End (); ++it)
+    {
+      DynamicCast<NrUeNetDevice> (*it)->UpdateConfig ();
+    }
+
+  InternetStackHelper internet;
+  internet.Install (ueNodes);
+  epcHelper->AssignUeIpv4Address (*ueDevs);
+  nrHelper->AttachToClosestEnb (*ueDevs, *gnbDevs);
+
+  return nrHelper;
+}
+
+class NrCheckpointTopologyTestCase : public TestCase
+{
+public:
+  NrCheckpointTopologyTestCase () : TestCase ("Save and restore of a gNB with two UEs")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Give a state to the scheduler, the beam manager of the gNB and
+   * the MAC of the first UE, then save the checkpoint
+   * \param gnbDevs the gNB device
+   * \param ueDevs the UE devices
+   */
+  void SaveFirst (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs);
+  /**
+   * \brief Restore the checkpoint in the same topology, and save it again
+   * \param gnbDevs the gNB device
+   * \param ueDevs the UE devices
+   */
+  void RestoreAndSave (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs);
+  /**
+   * \brief Restore the checkpoint later, in a topology with a RR scheduler
+   * \param gnbDevs the gNB device
+   * \param ueDevs the UE devices
+   */
+  void RestoreLater (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs);
+  /**
+   * \brief Write a sidelink sensing entry, as NrUeMac::SaveState does
+   * \param writer the checkpoint writer
+   * \param age the age of the entry, in slots
+   * \param rsrp the RSRP of the entry
+   */
+  static void WriteSensingEntry (NrCheckpointWriter &writer, uint32_t age, double rsrp);
+  /**
+   * \brief Read a file
+   * \param fileName the name of the file
+   * \return the content of the file
+   */
+  static std::vector<uint8_t> ReadFile (const std::string &fileName);
+
+  const Time m_saveTime {MilliSeconds (200)}; //!< Time of the first checkpoint
+  std::string m_fileName;                     //!< First checkpoint
+  std::string m_secondFileName;               //!< Checkpoint saved after the restore
+  complexVector_t m_beam;                     //!< Beam of the gNB towards the first UE
+  std::vector<uint8_t> m_ueMacState;          //!< Saved state of the MAC of the first UE
+};
+
+void
+NrCheckpointTopologyTestCase::WriteSensingEntry (NrCheckpointWriter &writer, uint32_t age, double rsrp)
+{
+  writer.WriteU32 (age);
+  writer.WriteU16 (100); // reservation period
+  writer.WriteU8 (2);    // subchannels
+  writer.WriteU8 (1);    // first subchannel
+  writer.WriteU8 (3);    // priority
+  writer.WriteDouble (rsrp);
+  writer.WriteU8 (0);    // no retransmissions
+  writer.WriteU8 (0);
+  writer.WriteU8 (0);
+  writer.WriteU8 (0);
+}
+
+std::vector<uint8_t>
+NrCheckpointTopologyTestCase::ReadFile (const std::string &fileName)
+{
+  std::ifstream file (fileName, std::ios::binary);
+  return std::vector<uint8_t> ((std::istreambuf_iterator<char> (file)), std::istreambuf_iterator<char> ());
+}
+
+void
+NrCheckpointTopologyTestCase::SaveFirst (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs)
+{
+  // Scheduler: values that the PF scheduler would learn with traffic
+  auto sched = DynamicCast<NrMacSchedulerNs3> (NrHelper::GetScheduler (gnbDevs.Get (0), 0));
+  NS_TEST_ASSERT_MSG_EQ (sched->m_ueMap.size (), 2, "Both the UEs should be attached");
+  for (const auto & ue : sched->m_ueMap)
+    {
+      auto pf = std::dynamic_pointer_cast<NrMacSchedulerUeInfoPF> (ue.second);
+      NS_TEST_ASSERT_MSG_NE (pf, nullptr, "The UEs of a PF scheduler should have a PF state");
+      pf->m_dlMcs = {17};
+      pf->m_avgTputDl = 1000.0 + ue.first;
+      pf->m_lastAvgTputDl = 1000.0 + ue.first;
+    }
+
+  // Beam manager: a beam that the ideal beamforming would not choose
+  auto beamManager = NrHelper::GetGnbPhy (gnbDevs.Get (0), 0)->GetSpectrumPhy ()->GetBeamManager ();
+  size_t numElements = beamManager->GetAntenna ()->GetNumberOfElements ();
+  m_beam.assign (numElements, std::complex<double> (0.0, 1.0 / std::sqrt (numElements)));
+  beamManager->SaveBeamformingVector (BeamformingVector (m_beam, BeamId (3, 60.0)), ueDevs.Get (0));
+
+  // UE MAC: the entries are restored relative to the current slot, and an
+  // entry older than the simulation is dropped
+  auto mac = NrHelper::GetUeMac (ueDevs.Get (0), 0);
+  NrCheckpointWriter sensing;
+  sensing.WriteU32 (4);
+  WriteSensingEntry (sensing, std::numeric_limits<uint32_t>::max (), -90.0);
+  WriteSensingEntry (sensing, 40, -85.0);
+  WriteSensingEntry (sensing, 3, -80.0);
+  WriteSensingEntry (sensing, 0, -75.0);
+  NrCheckpointReader reader (sensing.GetBuffer ());
+  mac->RestoreState (reader);
+
+  NrCheckpointWriter expected;
+  expected.WriteU32 (3);
+  WriteSensingEntry (expected, 40, -85.0);
+  WriteSensingEntry (expected, 3, -80.0);
+  WriteSensingEntry (expected, 0, -75.0);
+  NrCheckpointWriter saved;
+  mac->SaveState (saved);
+  NS_TEST_ASSERT_MSG_EQ ((saved.GetBuffer () == expected.GetBuffer ()), true,
+                         "The sensing data should be saved with the age it was restored with");
+  m_ueMacState = saved.GetBuffer ();
+
+  NrHelper::SaveCheckpoint (m_fileName, gnbDevs, ueDevs);
+}
+
+void
+NrCheckpointTopologyTestCase::RestoreAndSave (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs)
+{
+  NrHelper::RestoreCheckpoint (m_fileName, gnbDevs, ueDevs);
+
+  auto sched = DynamicCast<NrMacSchedulerNs3> (NrHelper::GetScheduler (gnbDevs.Get (0), 0));
+  NS_TEST_ASSERT_MSG_EQ (sched->m_ueMap.size (), 2, "Both the UEs should be attached");
+  for (const auto & ue : sched->m_ueMap)
+    {
+      auto pf = std::dynamic_pointer_cast<NrMacSchedulerUeInfoPF> (ue.second);
+      NS_TEST_ASSERT_MSG_EQ ((pf->m_dlMcs == std::vector<uint8_t> {17}), true, "Wrong DL MCS of RNTI " << ue.first);
+      NS_TEST_ASSERT_MSG_EQ (pf->m_lastAvgTputDl, 1000.0 + ue.first, "Wrong PF DL average of RNTI " << ue.first);
+    }
+
+  auto beamManager = NrHelper::GetGnbPhy (gnbDevs.Get (0), 0)->GetSpectrumPhy ()->GetBeamManager ();
+  NS_TEST_ASSERT_MSG_EQ ((beamManager->GetBeamformingVector (ueDevs.Get (0)) == m_beam), true,
+                         "The beam towards the first UE should be restored");
+
+  NrHelper::SaveCheckpoint (m_secondFileName, gnbDevs, ueDevs);
+}
+
+void
+NrCheckpointTopologyTestCase::RestoreLater (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs)
+{
+  NrHelper::RestoreCheckpoint (m_fileName, gnbDevs, ueDevs);
+
+  // The PF state does not fit the RR UEs, and is skipped
+  auto sched = DynamicCast<NrMacSchedulerNs3> (NrHelper::GetScheduler (gnbDevs.Get (0), 0));
+  NS_TEST_ASSERT_MSG_EQ (sched->m_ueMap.size (), 2, "Both the UEs should be attached");
+  for (const auto & ue : sched->m_ueMap)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((ue.second->m_dlMcs == std::vector<uint8_t> {17}), false,
+                             "The PF state should not be restored in RNTI " << ue.first);
+    }
+
+  // The rest of the checkpoint is restored anyway
+  auto beamManager = NrHelper::GetGnbPhy (gnbDevs.Get (0), 0)->GetSpectrumPhy ()->GetBeamManager ();
+  NS_TEST_ASSERT_MSG_EQ ((beamManager->GetBeamformingVector (ueDevs.Get (0)) == m_beam), true,
+                         "The beam towards the first UE should be restored");
+
+  // The sensing data keeps its age, relative to the slot of the restore
+  NrCheckpointWriter saved;
+  NrHelper::GetUeMac (ueDevs.Get (0), 0)->SaveState (saved);
+  NS_TEST_ASSERT_MSG_EQ ((saved.GetBuffer () == m_ueMacState), true,
+                         "The sensing data should be rebased on the slot of the restore");
+}
+
+void
+NrCheckpointTopologyTestCase::DoRun ()
+{
+  m_fileName = CreateTempDirFilename ("nr-checkpoint.bin");
+  m_secondFileName = CreateTempDirFilename ("nr-checkpoint-restored.bin");
+
+  NetDeviceContainer gnbDevs;
+  NetDeviceContainer ueDevs;
+  Ptr<NrHelper> nrHelper = BuildTopology ("ns3::NrMacSchedulerTdmaPF", &gnbDevs, &ueDevs);
+  Simulator::Schedule (m_saveTime, &NrCheckpointTopologyTestCase::SaveFirst, this, gnbDevs, ueDevs);
+  Simulator::Stop (m_saveTime + MilliSeconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // The same topology, from scratch: the restored state is saved back identical
+  nrHelper = BuildTopology ("ns3::NrMacSchedulerTdmaPF", &gnbDevs, &ueDevs);
+  Simulator::Schedule (m_saveTime, &NrCheckpointTopologyTestCase::RestoreAndSave, this, gnbDevs, ueDevs);
+  Simulator::Stop (m_saveTime + MilliSeconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  std::vector<uint8_t> first = ReadFile (m_fileName);
+  NS_TEST_ASSERT_MSG_GT (first.size (), 0, "The checkpoint should be saved");
+  NS_TEST_ASSERT_MSG_EQ ((ReadFile (m_secondFileName) == first), true,
+                         "Saving a restored topology should give the same checkpoint");
+
+  // Another scheduler, and a later restore
+  nrHelper = BuildTopology ("ns3::NrMacSchedulerTdmaRR", &gnbDevs, &ueDevs);
+  Simulator::Schedule (m_saveTime + MilliSeconds (10), &NrCheckpointTopologyTestCase::RestoreLater,
+                       this, gnbDevs, ueDevs);
+  Simulator::Stop (m_saveTime + MilliSeconds (11));
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief Warm up a gNB with two UEs and save a checkpoint, then run the same
+ * scenario twice from it, and check that the two runs give the same RLC and
+ * PHY statistics
+ */
+class NrCheckpointDeterminismTestCase : public TestCase
+{
+public:
+  NrCheckpointDeterminismTestCase () : TestCase ("Two runs from the same NR checkpoint")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief The statistics of a UE in a run
+   */
+  struct UeStats
+  {
+    uint64_t m_phyTbs {0};      //!< TBs received by the PHY
+    uint64_t m_phyBytes {0};    //!< Bytes of the TBs received by the PHY
+    uint64_t m_phyCorrupt {0};  //!< Corrupted TBs
+    uint64_t m_rlcPdus {0};     //!< PDUs received by the RLC
+    uint64_t m_rlcBytes {0};    //!< Bytes of the PDUs received by the RLC
+    uint64_t m_rlcDelay {0};    //!< Sum of the delays of the RLC PDUs, in ns
+
+    /**
+     * \brief Compare the statistics
+     * \param other the other statistics
+     * \return true if all the statistics are equal
+     */
+    bool operator== (const UeStats &other) const
+    {
+      return m_phyTbs == other.m_phyTbs && m_phyBytes == other.m_phyBytes
+             && m_phyCorrupt == other.m_phyCorrupt && m_rlcPdus == other.m_rlcPdus
+             && m_rlcBytes == other.m_rlcBytes && m_rlcDelay == other.m_rlcDelay;
+    }
+  };
+
+  /**
+   * \brief Send a downlink packet to each UE, and schedule the next ones
+   * \param gnbDevs the gNB device
+   * \param ueDevs the UE devices
+   */
+  void SendPackets (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs);
+  /**
+   * \brief Save the checkpoint at the end of the warm up
+   * \param gnbDevs the gNB device
+   * \param ueDevs the UE devices
+   */
+  void Save (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs);
+  /**
+   * \brief Restore the checkpoint, connect the statistics and start the traffic
+   * \param gnbDevs the gNB device
+   * \param ueDevs the UE devices
+   */
+  void RestoreAndRun (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs);
+  /**
+   * \brief Count a TB received by a UE PHY
+   * \param params the parameters of the reception
+   */
+  void RxPhy (RxPacketTraceParams params);
+  /**
+   * \brief Count a PDU received by a UE RLC
+   * \param rnti the RNTI of the UE
+   * \param lcid the logical channel
+   * \param bytes the size of the PDU
+   * \param delay the delay of the PDU, in ns
+   */
+  void RxRlc (uint16_t rnti, uint8_t lcid, uint32_t bytes, uint64_t delay);
+
+  const uint32_t m_packetSize {1000};            //!< Size of the packets
+  const Time m_interval {MicroSeconds (500)};    //!< Interval between the packets of a UE
+  const Time m_warmUpStart {MilliSeconds (100)}; //!< Start of the traffic of the warm up
+  const Time m_saveTime {MilliSeconds (200)};    //!< Time of the checkpoint
+  const Time m_runDuration {MilliSeconds (200)}; //!< Duration of the runs after the restore
+
+  std::string m_fileName;                        //!< The checkpoint
+  Time m_trafficEnd;                             //!< End of the traffic of the current run
+  std::map<uint16_t, UeStats> m_stats;           //!< Statistics of the current run, by RNTI
+};
+
+void
+NrCheckpointDeterminismTestCase::SendPackets (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs)
+{
+  // As in the other system tests without applications: the UE drops the
+  // packet at the IP layer, after the PHY and the RLC have received it
+  for (auto it = ueDevs.Begin (); it != ueDevs.End (); ++it)
+    {
+      Ptr<Packet> pkt = Create<Packet> (m_packetSize);
+      Ipv4Header ipHeader;
+      pkt->AddHeader (ipHeader);
+      EpsBearerTag tag (DynamicCast<NrUeNetDevice> (*it)->GetRrc ()->GetRnti (), 1);
+      pkt->AddPacketTag (tag);
+      gnbDevs.Get (0)->Send (pkt, (*it)->GetAddress (), Ipv4L3Protocol::PROT_NUMBER);
+    }
+
+  if (Simulator::Now () + m_interval < m_trafficEnd)
+    {
+      Simulator::Schedule (m_interval, &NrCheckpointDeterminismTestCase::SendPackets, this, gnbDevs, ueDevs);
+    }
+}
+
+void
+NrCheckpointDeterminismTestCase::Save (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs)
+{
+  NrHelper::SaveCheckpoint (m_fileName, gnbDevs, ueDevs);
+}
+
+void
+NrCheckpointDeterminismTestCase::RestoreAndRun (NetDeviceContainer gnbDevs, NetDeviceContainer ueDevs)
+{
+  NrHelper::RestoreCheckpoint (m_fileName, gnbDevs, ueDevs);
+
+  for (auto it = ueDevs.Begin (); it != ueDevs.End (); ++it)
+    {
+      NrHelper::GetUePhy (*it, 0)->GetSpectrumPhy ()->TraceConnectWithoutContext (
+        "RxPacketTraceUe", MakeCallback (&NrCheckpointDeterminismTestCase::RxPhy, this));
+    }
+  Config::ConnectWithoutContext ("/NodeList/*/DeviceList/*/LteUeRrc/DataRadioBearerMap/*/LteRlc/RxPDU",
+                                 MakeCallback (&NrCheckpointDeterminismTestCase::RxRlc, this));
+
+  m_trafficEnd = Simulator::Now () + m_runDuration;
+  SendPackets (gnbDevs, ueDevs);
+}
+
+void
+NrCheckpointDeterminismTestCase::RxPhy (RxPacketTraceParams params)
+{
+  UeStats &stats = m_stats[params.m_rnti];
+  ++stats.m_phyTbs;
+  stats.m_phyBytes += params.m_tbSize;
+  stats.m_phyCorrupt += params.m_corrupt ? 1 : 0;
+}
+
+void
+NrCheckpointDeterminismTestCase::RxRlc (uint16_t rnti, uint8_t lcid, uint32_t bytes, uint64_t delay)
+{
+  UeStats &stats = m_stats[rnti];
+  ++stats.m_rlcPdus;
+  stats.m_rlcBytes += bytes;
+  stats.m_rlcDelay += delay;
+}
+
+void
+NrCheckpointDeterminismTestCase::DoRun ()
+{
+  m_fileName = CreateTempDirFilename ("nr-checkpoint-determinism.bin");
+
+  // Warm up: the traffic fills the CQI, the MCS and the PF averages
+  NetDeviceContainer gnbDevs;
+  NetDeviceContainer ueDevs;
+  Ptr<NrHelper> nrHelper = BuildTopology ("ns3::NrMacSchedulerTdmaPF", &gnbDevs, &ueDevs);
+  m_trafficEnd = m_saveTime;
+  Simulator::Schedule (m_warmUpStart, &NrCheckpointDeterminismTestCase::SendPackets, this, gnbDevs, ueDevs);
+  Simulator::Schedule (m_saveTime, &NrCheckpointDeterminismTestCase::Save, this, gnbDevs, ueDevs);
+  Simulator::Stop (m_saveTime + MilliSeconds (1));
+  Simulator::Run ();
+  Simulator::Destroy ();
+
+  // Two runs from the checkpoint. The random streams not assigned by the
+  // helpers are numbered again from the start, as in a fresh process.
+  std::vector<std::map<uint16_t, UeStats> > runs;
+  for (uint32_t run = 0; run < 2; ++run)
+    {
+      RngSeedManager::ResetNextStreamIndex ();
+      m_stats.clear ();
+      nrHelper = BuildTopology ("ns3::NrMacSchedulerTdmaPF", &gnbDevs, &ueDevs);
+      Simulator::Schedule (m_saveTime, &NrCheckpointDeterminismTestCase::RestoreAndRun, this, gnbDevs, ueDevs);
+      Simulator::Stop (m_saveTime + m_runDuration + MilliSeconds (10));
+      Simulator::Run ();
+      Simulator::Destroy ();
+      runs.push_back (m_stats);
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (runs.at (0).size (), 2, "Both the UEs should receive traffic");
+  for (const auto & ue : runs.at (0))
+    {
+      NS_TEST_ASSERT_MSG_GT (ue.second.m_phyBytes, 0, "The PHY of RNTI " << ue.first << " should receive TBs");
+      NS_TEST_ASSERT_MSG_GT (ue.second.m_rlcBytes, 0, "The RLC of RNTI " << ue.first << " should receive PDUs");
+    }
+  NS_TEST_ASSERT_MSG_EQ ((runs.at (0) == runs.at (1)), true,
+                         "Two runs from the same checkpoint should give the same RLC and PHY statistics");
+}
+
+class NrCheckpointTestSuite : public TestSuite
+{
+public:
+  NrCheckpointTestSuite () : TestSuite ("nr-test-checkpoint", UNIT)
+  {
+    AddTestCase (new NrCheckpointFormatTestCase, TestCase::QUICK);
+    AddTestCase (new NrCheckpointUeStateTestCase, TestCase::QUICK);
+    AddTestCase (new NrCheckpointTopologyTestCase, TestCase::QUICK);
+    AddTestCase (new NrCheckpointDeterminismTestCase, TestCase::QUICK);
+  }
+};
+
+static NrCheckpointTestSuite nrCheckpointTestSuite; //!< NR checkpoint test suite
+
+} // namespace ns3
@@ -0,0 +1,414 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/boolean.h>
+#include <ns3/nr-interference.h>
+#include <ns3/nr-spectrum-phy.h>
+#include <ns3/nr-lbt-access-manager.h>
+
+#include <functional>
+#include <vector>
+
+/**
+ * \file nr-test-lbt-access-manager.cc
+ * \ingroup test
+ *
+ * \brief Check the incremental energy detection of NrInterference, used by
+ * the CCA of the LBT, the contention window adaptation of
+ * NrLbtAccessManager, and its state machine with an idle or busy channel.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Check the energy and the busy duration seen by the CCA while two
+ * overlapping signals start and end
+ */
+class NrInterferenceEnergyTestCase : public TestCase
+{
+public:
+  NrInterferenceEnergyTestCase () : TestCase ("Incremental energy detection of NrInterference")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Check the channel at the current time
+   * \param expectedEnergy the expected energy, in W
+   * \param expectedBusy the expected duration of the energy above the threshold
+   */
+  void Check (double expectedEnergy, Time expectedBusy);
+
+  Ptr<NrInterference> m_interference;  //!< The interference under test
+  const double m_threshold {1.5e-9};   //!< CCA threshold, in W
+};
+
+void
+NrInterferenceEnergyTestCase::Check (double expectedEnergy, Time expectedBusy)
+{
+  NS_TEST_ASSERT_MSG_EQ_TOL (m_interference->GetEnergyNow (), expectedEnergy, 1e-15,
+                             "Wrong energy at " << Simulator::Now ().As (Time::US));
+  NS_TEST_ASSERT_MSG_EQ (m_interference->IsChannelBusyNow (m_threshold), expectedBusy.IsStrictlyPositive (),
+                         "Wrong channel status at " << Simulator::Now ().As (Time::US));
+  NS_TEST_ASSERT_MSG_EQ (m_interference->GetEnergyDuration (m_threshold), expectedBusy,
+                         "Wrong busy duration at " << Simulator::Now ().As (Time::US));
+}
+
+void
+NrInterferenceEnergyTestCase::DoRun ()
+{
+  m_interference = CreateObject<NrInterference> ();
+
+  // Signal A in [0, 10] us, signal B in [5, 20] us, both of 1 nW
+  m_interference->AppendEvent (MicroSeconds (0), MicroSeconds (10), 1e-9);
+  m_interference->AppendEvent (MicroSeconds (5), MicroSeconds (20), 1e-9);
+
+  Simulator::Schedule (MicroSeconds (2), &NrInterferenceEnergyTestCase::Check, this,
+                       1e-9, Seconds (0));
+  Simulator::Schedule (MicroSeconds (7), &NrInterferenceEnergyTestCase::Check, this,
+                       2e-9, MicroSeconds (3));
+  Simulator::Schedule (MicroSeconds (15), &NrInterferenceEnergyTestCase::Check, this,
+                       1e-9, Seconds (0));
+  Simulator::Schedule (MicroSeconds (25), &NrInterferenceEnergyTestCase::Check, this,
+                       0.0, Seconds (0));
+  // Signal C in [30, 40] us, above the threshold alone
+  Simulator::Schedule (MicroSeconds (30), &NrInterference::AppendEvent, m_interference,
+                       MicroSeconds (30), MicroSeconds (40), 2e-9);
+  Simulator::Schedule (MicroSeconds (32), &NrInterferenceEnergyTestCase::Check, this,
+                       2e-9, MicroSeconds (8));
+
+  Simulator::Run ();
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief Check the CW adaptation of NrLbtAccessManager with the HARQ
+ * feedback
+ */
+class NrLbtCwTestCase : public TestCase
+{
+public:
+  NrLbtCwTestCase () : TestCase ("Contention window adaptation of NrLbtAccessManager")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrLbtCwTestCase::DoRun ()
+{
+  Ptr<NrLbtAccessManager> cam = CreateObject<NrLbtAccessManager> ();
+  cam->SetAttribute ("PriorityClass", UintegerValue (3));
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 15, "The CW should start at CWmin");
+  NS_TEST_ASSERT_MSG_EQ (cam->GetDeferDuration (), MicroSeconds (43), "Wrong defer duration");
+
+  // No feedback: the CW does not change
+  cam->UpdateCw ();
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 15, "The CW should not change without feedback");
+
+  // 80 % of NACK: the CW grows
+  for (uint32_t i = 0; i < 4; ++i)
+    {
+      cam->NotifyHarqFeedback (true);
+    }
+  cam->NotifyHarqFeedback (false);
+  cam->UpdateCw ();
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 31, "The CW should grow with 80 % of NACK");
+
+  cam->NotifyHarqFeedback (true);
+  cam->UpdateCw ();
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 63, "The CW should grow up to CWmax");
+
+  // CWmax used once (MaxCwMaxCount = 1): back to CWmin
+  cam->NotifyHarqFeedback (true);
+  cam->UpdateCw ();
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 15, "The CW should be reset after using CWmax");
+
+  // Less than 80 % of NACK: back to CWmin
+  cam->NotifyHarqFeedback (true);
+  cam->UpdateCw ();
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 31, "The CW should grow with only NACK");
+  cam->NotifyHarqFeedback (true);
+  cam->NotifyHarqFeedback (false);
+  cam->UpdateCw ();
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 15, "The CW should be reset with 50 % of NACK");
+
+  // The UE table gives a different CWmax for the same class
+  cam->SetAttribute ("UplinkTable", BooleanValue (true));
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      cam->NotifyHarqFeedback (true);
+      cam->UpdateCw ();
+    }
+  NS_TEST_ASSERT_MSG_EQ (cam->GetCw (), 1023, "The UE CWmax of class 3 should be 1023");
+
+  cam->Dispose ();
+}
+
+/**
+ * \ingroup test
+ * \brief Check the state machine of NrLbtAccessManager (defer, backoff,
+ * grant, COT sharing) with busy periods on the channel sensed by the
+ * spectrum phy
+ *
+ * With the priority class 3 of the gNB, the defer duration is 43 us and the
+ * MCOT is 8 ms. The backoff counter N is random: the test first finds, with
+ * an idle channel, a stream that draws N >= 2, and then uses the same stream
+ * (and so the same N) with the busy periods.
+ */
+class NrLbtStateMachineTestCase : public TestCase
+{
+public:
+  NrLbtStateMachineTestCase () : TestCase ("State machine of NrLbtAccessManager")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Create the manager and its spectrum phy, and clear the grants
+   * \param stream the stream of the backoff random variable
+   * \param cotSharing the value of the attribute CotSharing
+   * \return the manager
+   */
+  Ptr<NrLbtAccessManager> CreateCam (int64_t stream, bool cotSharing);
+  /**
+   * \brief Dispose the manager and its spectrum phy, and destroy the simulator
+   * \param cam the manager
+   */
+  void DestroyCam (Ptr<NrLbtAccessManager> cam);
+  /**
+   * \brief Add a busy period on the channel
+   * \param start start of the period
+   * \param end end of the period
+   */
+  void AddBusyPeriod (Time start, Time end);
+  /**
+   * \brief The access granted callback
+   * \param duration the duration of the grant
+   */
+  void Granted (const Time &duration);
+  /**
+   * \brief Check the state of the procedure, and the number of grants so far
+   * \param cam the manager
+   * \param state the expected state
+   * \param grants the expected number of grants
+   */
+  void CheckState (Ptr<NrLbtAccessManager> cam, NrLbtAccessManager::LbtState state, size_t grants);
+  /**
+   * \brief Check a grant
+   * \param index index of the grant
+   * \param time expected time of the grant
+   * \param duration expected duration of the grant
+   */
+  void CheckGrant (size_t index, Time time, Time duration);
+
+  Ptr<NrSpectrumPhy> m_phy;                     //!< The spectrum phy that senses the channel
+  std::vector<std::pair<Time, Time>> m_grants;  //!< Time and duration of each grant
+  const Time m_defer {MicroSeconds (43)};       //!< Defer duration of the class 3
+  const Time m_slot {MicroSeconds (NrLbtAccessManager::CCA_SLOT_US)}; //!< CCA slot
+  const Time m_mcot {MilliSeconds (8)};         //!< MCOT of the class 3
+};
+
+Ptr<NrLbtAccessManager>
+NrLbtStateMachineTestCase::CreateCam (int64_t stream, bool cotSharing)
+{
+  m_phy = CreateObject<NrSpectrumPhy> ();
+  m_phy->SetCcaMode1Threshold (-62.0);
+  m_grants.clear ();
+
+  Ptr<NrLbtAccessManager> cam = CreateObject<NrLbtAccessManager> ();
+  cam->SetAttribute ("PriorityClass", UintegerValue (3));
+  cam->SetAttribute ("CotSharing", BooleanValue (cotSharing));
+  cam->AssignStreams (stream);
+  cam->SetNrSpectrumPhy (m_phy);
+  cam->SetAccessGrantedCallback (std::bind (&NrLbtStateMachineTestCase::Granted, this,
+                                            std::placeholders::_1));
+  return cam;
+}
+
+void
+NrLbtStateMachineTestCase::DestroyCam (Ptr<NrLbtAccessManager> cam)
+{
+  Simulator::Destroy ();
+  cam->Dispose ();
+  m_phy->Dispose ();
+  m_phy = nullptr;
+}
+
+void
+NrLbtStateMachineTestCase::AddBusyPeriod (Time start, Time end)
+{
+  // 1 nW (-60 dBm) is above the CCA threshold of -62 dBm
+  m_phy->GetNrInterference ()->AppendEvent (start, end, 1e-9);
+}
+
+void
+NrLbtStateMachineTestCase::Granted (const Time &duration)
+{
+  m_grants.emplace_back (Simulator::Now (), duration);
+}
+
+void
+NrLbtStateMachineTestCase::CheckState (Ptr<NrLbtAccessManager> cam,
+                                       NrLbtAccessManager::LbtState state, size_t grants)
+{
+  NS_TEST_ASSERT_MSG_EQ (cam->GetLbtState (), state,
+                         "Wrong LBT state at " << Simulator::Now ().As (Time::US));
+  NS_TEST_ASSERT_MSG_EQ (m_grants.size (), grants,
+                         "Wrong number of grants at " << Simulator::Now ().As (Time::US));
+}
+
+void
+NrLbtStateMachineTestCase::CheckGrant (size_t index, Time time, Time duration)
+{
+  NS_TEST_ASSERT_MSG_GT (m_grants.size (), index, "Grant " << index << " missing");
+  NS_TEST_ASSERT_MSG_EQ (m_grants.at (index).first, time, "Wrong time of grant " << index);
+  NS_TEST_ASSERT_MSG_EQ (m_grants.at (index).second, duration, "Wrong duration of grant " << index);
+}
+
+void
+NrLbtStateMachineTestCase::DoRun ()
+{
+  // Idle channel: the grant comes after the defer duration and N slots.
+  // Look for a stream that draws N >= 2.
+  int64_t stream = 0;
+  int64_t backoff = -1;
+  for (int64_t s = 1; s < 64 && backoff < 2; ++s)
+    {
+      Ptr<NrLbtAccessManager> cam = CreateCam (s, true);
+      cam->RequestAccess ();
+      CheckState (cam, NrLbtAccessManager::DEFER, 0);
+      Simulator::Run ();
+
+      NS_TEST_ASSERT_MSG_EQ (m_grants.size (), 1, "The idle channel should be granted once");
+      NS_TEST_ASSERT_MSG_EQ (m_grants.front ().second, m_mcot, "The grant should last the MCOT");
+      NS_TEST_ASSERT_MSG_EQ (cam->GetLbtState (), NrLbtAccessManager::IDLE, "The LBT should be over");
+      Time backoffTime = m_grants.front ().first - m_defer;
+      NS_TEST_ASSERT_MSG_EQ (backoffTime.GetMicroSeconds () % NrLbtAccessManager::CCA_SLOT_US, 0,
+                             "The backoff should last a whole number of CCA slots");
+      backoff = backoffTime.GetMicroSeconds () / NrLbtAccessManager::CCA_SLOT_US;
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (backoff, static_cast<int64_t> (cam->GetCw ()), "The backoff counter should be in [0, CW]");
+      stream = s;
+      DestroyCam (cam);
+    }
+  NS_TEST_ASSERT_MSG_GT_OR_EQ (backoff, static_cast<int64_t> (2), "No stream gave a backoff counter of at least 2");
+  const Time backoffTime = MicroSeconds (NrLbtAccessManager::CCA_SLOT_US * backoff);
+
+  // Channel busy in [0, 100] us: the manager jumps to the end of the busy
+  // period, and then senses the defer duration. A second request during the
+  // procedure is ignored.
+  {
+    Ptr<NrLbtAccessManager> cam = CreateCam (stream, true);
+    AddBusyPeriod (Seconds (0), MicroSeconds (100));
+    cam->RequestAccess ();
+    Simulator::Schedule (MicroSeconds (10), &NrLbtAccessManager::RequestAccess, cam);
+    Simulator::Schedule (MicroSeconds (50), &NrLbtStateMachineTestCase::CheckState, this, cam,
+                         NrLbtAccessManager::DEFER, 0);
+    Simulator::Run ();
+    NS_TEST_ASSERT_MSG_EQ (m_grants.size (), 1, "The busy channel should be granted once");
+    CheckGrant (0, MicroSeconds (100) + m_defer + backoffTime, m_mcot);
+    DestroyCam (cam);
+  }
+
+  // Channel busy in [20, 30] us, during the defer duration: the CCA slot
+  // ending at 25 us is busy, and the defer duration restarts at 30 us
+  {
+    Ptr<NrLbtAccessManager> cam = CreateCam (stream, true);
+    AddBusyPeriod (MicroSeconds (20), MicroSeconds (30));
+    cam->RequestAccess ();
+    Simulator::Schedule (MicroSeconds (40), &NrLbtStateMachineTestCase::CheckState, this, cam,
+                         NrLbtAccessManager::DEFER, 0);
+    Simulator::Run ();
+    CheckGrant (0, MicroSeconds (30) + m_defer + backoffTime, m_mcot);
+    DestroyCam (cam);
+  }
+
+  // Channel busy in [58, 70] us, during the backoff: the first backoff slot
+  // ends idle at 52 us, the second one is busy at 61 us. The manager goes
+  // back to the defer duration at 70 us, keeping the counter N - 1.
+  {
+    Ptr<NrLbtAccessManager> cam = CreateCam (stream, true);
+    AddBusyPeriod (MicroSeconds (58), MicroSeconds (70));
+    cam->RequestAccess ();
+    Simulator::Schedule (MicroSeconds (56), &NrLbtStateMachineTestCase::CheckState, this, cam,
+                         NrLbtAccessManager::BACKOFF, 0);
+    Simulator::Schedule (MicroSeconds (65), &NrLbtStateMachineTestCase::CheckState, this, cam,
+                         NrLbtAccessManager::DEFER, 0);
+    Simulator::Run ();
+    CheckGrant (0, MicroSeconds (70) + m_defer + backoffTime - m_slot, m_mcot);
+    DestroyCam (cam);
+  }
+
+  // COT sharing: a request 1 ms after the grant gets the rest of the COT
+  // immediately; a request after the end of the COT does a full LBT
+  const Time firstGrant = m_defer + backoffTime;
+  {
+    Ptr<NrLbtAccessManager> cam = CreateCam (stream, true);
+    cam->RequestAccess ();
+    Simulator::Schedule (firstGrant + MilliSeconds (1), &NrLbtAccessManager::RequestAccess, cam);
+    Simulator::Schedule (firstGrant + MilliSeconds (9), &NrLbtAccessManager::RequestAccess, cam);
+    Simulator::Run ();
+    NS_TEST_ASSERT_MSG_EQ (m_grants.size (), 3, "Wrong number of grants with COT sharing");
+    CheckGrant (0, firstGrant, m_mcot);
+    CheckGrant (1, firstGrant + MilliSeconds (1), m_mcot - MilliSeconds (1));
+    Time lbtTime = m_grants.at (2).first - firstGrant - MilliSeconds (9) - m_defer;
+    NS_TEST_ASSERT_MSG_EQ (lbtTime.IsPositive (), true, "The request after the COT needs the LBT");
+    NS_TEST_ASSERT_MSG_EQ (lbtTime.GetMicroSeconds () % NrLbtAccessManager::CCA_SLOT_US, 0,
+                           "The request after the COT should count down a new backoff");
+    NS_TEST_ASSERT_MSG_EQ (m_grants.at (2).second, m_mcot, "A new COT should last the MCOT");
+    DestroyCam (cam);
+  }
+
+  // Without COT sharing, the request in the COT does a full LBT
+  {
+    Ptr<NrLbtAccessManager> cam = CreateCam (stream, false);
+    cam->RequestAccess ();
+    Simulator::Schedule (firstGrant + MilliSeconds (1), &NrLbtAccessManager::RequestAccess, cam);
+    Simulator::Run ();
+    NS_TEST_ASSERT_MSG_EQ (m_grants.size (), 2, "Wrong number of grants without COT sharing");
+    CheckGrant (0, firstGrant, m_mcot);
+    NS_TEST_ASSERT_MSG_GT_OR_EQ (m_grants.at (1).first, firstGrant + MilliSeconds (1) + m_defer,
+                                 "Without COT sharing, the request needs the LBT");
+    NS_TEST_ASSERT_MSG_EQ (m_grants.at (1).second, m_mcot, "The grant should last the MCOT");
+    DestroyCam (cam);
+  }
+}
+
+/**
+ * \ingroup test
+ * \brief The test suite of the LBT channel access manager
+ */
+class NrLbtAccessManagerTestSuite : public TestSuite
+{
+public:
+  NrLbtAccessManagerTestSuite () : TestSuite ("nr-test-lbt-access-manager", UNIT)
+  {
+    AddTestCase (new NrInterferenceEnergyTestCase, TestCase::QUICK);
+    AddTestCase (new NrLbtCwTestCase, TestCase::QUICK);
+    AddTestCase (new NrLbtStateMachineTestCase, TestCase::QUICK);
+  }
+};
+
+static NrLbtAccessManagerTestSuite nrLbtAccessManagerTestSuite; //!< LBT access manager test suite
+
+} // namespace ns3
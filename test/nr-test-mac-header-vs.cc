@@ -0,0 +1,110 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-mac-header-vs.h>
+
+#include <vector>
+
+/**
+ * \file nr-test-mac-header-vs.cc
+ * \ingroup test
+ *
+ * \brief Check the LCID table of NrMacHeaderVs, and that the subheaders
+ * written by Serialize are read back by Deserialize and by RemoveSubheader,
+ * for subheaders of 2 and 3 bytes.
+ */
+namespace ns3 {
+
+class NrMacHeaderVsTestCase : public TestCase
+{
+public:
+  NrMacHeaderVsTestCase () : TestCase ("MAC variable-size subheader")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrMacHeaderVsTestCase::DoRun ()
+{
+  // Sizes around the 1-byte L field limit, and the largest one
+  const std::vector<uint32_t> sizes = {0, 1, 127, 128, 1500, 65535};
+
+  NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::IsAllowedLcId (0), false, "LCID 0 is not a data LC");
+  NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::IsAllowedLcId (NrMacHeaderVs::LC_ID_1), true, "LCID 1 is a data LC");
+  NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::IsAllowedLcId (NrMacHeaderVs::LC_ID_32), true, "LCID 32 is a data LC");
+  NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::IsAllowedLcId (33), false, "LCID 33 is not a data LC");
+  NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::IsAllowedLcId (255), false, "LCID 255 is not a data LC");
+
+  uint8_t lcId = NrMacHeaderVs::LC_ID_1;
+  for (auto size : sizes)
+    {
+      NrMacHeaderVs header;
+      header.SetLcId (lcId);
+      header.SetSize (static_cast<uint16_t> (size));
+      NS_TEST_ASSERT_MSG_EQ (header.GetSerializedSize (), NrMacHeaderVs::GetSubheaderSize (header.GetSize ()),
+                             "Wrong size of the subheader for L " << size);
+
+      // Serialize and Encode write the same bytes
+      Ptr<Packet> p = Create<Packet> (size);
+      p->AddHeader (header);
+      std::vector<uint8_t> serialized (header.GetSerializedSize ());
+      p->CopyData (serialized.data (), serialized.size ());
+      uint8_t encoded[3];
+      NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::Encode (lcId, static_cast<uint16_t> (size), encoded),
+                             serialized.size (), "Wrong number of bytes encoded for L " << size);
+      NS_TEST_ASSERT_MSG_EQ ((std::vector<uint8_t> (encoded, encoded + serialized.size ()) == serialized), true,
+                             "Encode and Serialize should write the same bytes for L " << size);
+
+      // Deserialize, on a copy
+      NrMacHeaderVs read;
+      p->Copy ()->RemoveHeader (read);
+      NS_TEST_ASSERT_MSG_EQ ((read == header), true, "Wrong subheader deserialized for L " << size);
+
+      // RemoveSubheader is the same as RemoveHeader
+      uint8_t readLcId = 0;
+      uint16_t readSize = NrMacHeaderVs::RemoveSubheader (p, readLcId);
+      NS_TEST_ASSERT_MSG_EQ (+readLcId, +lcId, "Wrong LCID for L " << size);
+      NS_TEST_ASSERT_MSG_EQ (readSize, size, "Wrong L field");
+      NS_TEST_ASSERT_MSG_EQ (p->GetSize (), size, "The subheader should be removed");
+
+      lcId += 5;
+    }
+
+  // A truncated subheader is detected
+  uint8_t lcIdRead;
+  uint16_t sizeRead;
+  const uint8_t longSubheader[] = {0x44, 0x05};
+  NS_TEST_ASSERT_MSG_EQ (NrMacHeaderVs::Decode (longSubheader, 2, lcIdRead, sizeRead), 0,
+                         "A 3-byte subheader cannot be read from 2 bytes");
+}
+
+class NrMacHeaderVsTestSuite : public TestSuite
+{
+public:
+  NrMacHeaderVsTestSuite () : TestSuite ("nr-test-mac-header-vs", UNIT)
+  {
+    AddTestCase (new NrMacHeaderVsTestCase, TestCase::QUICK);
+  }
+};
+
+static NrMacHeaderVsTestSuite nrMacHeaderVsTestSuite; //!< MAC variable-size subheader test suite
+
+} // namespace ns3
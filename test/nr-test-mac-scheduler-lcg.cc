@@ -0,0 +1,115 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-mac-scheduler-lcg.h>
+
+#include <vector>
+
+/**
+ * \file nr-test-mac-scheduler-lcg.cc
+ * \ingroup test
+ *
+ * \brief Check the LC index of NrMacSchedulerLCG: the LCs are found by LC
+ * ID, up to LCID 32, they are visited from the last inserted, and the sizes
+ * of the RLC buffers are accounted as the RLC serves them (STATUS PDU,
+ * retransmissions, new transmissions).
+ */
+namespace ns3 {
+
+class NrMacSchedulerLcgTestCase : public TestCase
+{
+public:
+  NrMacSchedulerLcgTestCase () : TestCase ("LC index and RLC buffers of a LCG")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrMacSchedulerLcgTestCase::DoRun ()
+{
+  NrMacSchedulerLCG lcg (1);
+  for (uint8_t lcId : std::vector<uint8_t> {1, 4, NrMacSchedulerLCG::MAX_LC_ID})
+    {
+      LogicalChannelConfigListElement_s conf {};
+      conf.m_logicalChannelIdentity = lcId;
+      conf.m_qci = 9;
+      NS_TEST_ASSERT_MSG_EQ (lcg.Insert (LCPtr (new NrMacSchedulerLC (conf))), true, "LC " << +lcId << " not inserted");
+    }
+
+  NS_TEST_ASSERT_MSG_EQ (lcg.NumOfLC (), 3, "Wrong number of LCs");
+  NS_TEST_ASSERT_MSG_EQ (lcg.Contains (4), true, "LC 4 should be in the LCG");
+  NS_TEST_ASSERT_MSG_EQ (lcg.Contains (3), false, "LC 3 is not in the LCG");
+  NS_TEST_ASSERT_MSG_EQ (lcg.Contains (200), false, "LC 200 is not in the LCG");
+  NS_TEST_ASSERT_MSG_EQ ((lcg.GetLCId () == std::vector<uint8_t> {32, 4, 1}), true,
+                         "The LCs should be visited from the last inserted");
+
+  std::vector<uint8_t> visited;
+  lcg.ForEachLC ([&visited] (const NrMacSchedulerLC &lc) { visited.push_back (static_cast<uint8_t> (lc.m_id)); });
+  NS_TEST_ASSERT_MSG_EQ ((visited == lcg.GetLCId ()), true, "ForEachLC should follow the order of GetLCId");
+
+  NrMacSchedSapProvider::SchedDlRlcBufferReqParameters params {};
+  params.m_logicalChannelIdentity = 4;
+  params.m_rlcTransmissionQueueSize = 1000;
+  params.m_rlcRetransmissionQueueSize = 200;
+  params.m_rlcStatusPduSize = 10;
+  lcg.UpdateInfo (params);
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSize (), 1210, "Wrong total size after the BSR");
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSizeOfLC (4), 1210, "Wrong size of LC 4 after the BSR");
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSizeOfLC (1), 0, "LC 1 has no data");
+
+  // The STATUS PDU first, then the retransmissions
+  lcg.AssignedData (4, 50, DciInfoElementTdma::DL);
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSizeOfLC (4), 1200, "The STATUS PDU should be served");
+  lcg.AssignedData (4, 300, DciInfoElementTdma::DL);
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSizeOfLC (4), 1000, "The retransmissions should be served");
+
+  // Then the new transmissions, minus the RLC overhead (2 bytes for LC 4)
+  lcg.AssignedData (4, 502, DciInfoElementTdma::DL);
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSizeOfLC (4), 500, "Wrong TX buffer after a partial assignment");
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSize (), 500, "Wrong total size after a partial assignment");
+
+  // A smaller STATUS PDU reported lowers the total size
+  params.m_rlcTransmissionQueueSize = 500;
+  params.m_rlcRetransmissionQueueSize = 0;
+  params.m_rlcStatusPduSize = 20;
+  lcg.UpdateInfo (params);
+  params.m_rlcStatusPduSize = 5;
+  lcg.UpdateInfo (params);
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSize (), 505, "Wrong total size after a smaller STATUS PDU");
+
+  lcg.AssignedData (4, 5, DciInfoElementTdma::DL);
+  lcg.AssignedData (4, 1000, DciInfoElementTdma::DL);
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSizeOfLC (4), 0, "LC 4 should be empty");
+  NS_TEST_ASSERT_MSG_EQ (lcg.GetTotalSize (), 0, "The LCG should be empty");
+}
+
+class NrMacSchedulerLcgTestSuite : public TestSuite
+{
+public:
+  NrMacSchedulerLcgTestSuite () : TestSuite ("nr-test-mac-scheduler-lcg", UNIT)
+  {
+    AddTestCase (new NrMacSchedulerLcgTestCase, TestCase::QUICK);
+  }
+};
+
+static NrMacSchedulerLcgTestSuite nrMacSchedulerLcgTestSuite; //!< LCG test suite
+
+} // namespace ns3
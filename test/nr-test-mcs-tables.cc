@@ -0,0 +1,243 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-mcs-tables.h>
+#include <ns3/nr-eesm-cc-t1.h>
+#include <ns3/nr-eesm-cc-t2.h>
+#include <ns3/nr-eesm-ir-t1.h>
+#include <ns3/nr-eesm-ir-t2.h>
+#include <ns3/nr-lte-mi-error-model.h>
+
+#include <cmath>
+#include <vector>
+
+/**
+ * \file nr-test-mcs-tables.cc
+ * \ingroup test
+ *
+ * \brief Check the compile-time MCS and CQI tables against the values of
+ * TS 38.214 used so far, and that the error models and NrAmc give the same
+ * results when they read the tables directly.
+ */
+namespace ns3 {
+
+/**
+ * \brief Reference values of an MCS table
+ */
+struct NrMcsTableReference
+{
+  std::vector<double> m_seMcs;    //!< SE for each MCS
+  std::vector<double> m_seCqi;    //!< SE for each CQI
+  std::vector<double> m_ecr;      //!< ECR for each MCS
+  std::vector<uint8_t> m_m;       //!< Modulation order for each MCS
+  std::vector<double> m_beta;     //!< EESM beta for each MCS
+};
+
+static const NrMcsTableReference Reference1 = {
+  { 0.23, 0.31, 0.38, 0.49, 0.6, 0.74, 0.88, 1.03, 1.18, 1.33,
+    1.33, 1.48, 1.70, 1.91, 2.16, 2.41, 2.57,
+    2.57, 2.73, 3.03, 3.32, 3.61, 3.90, 4.21, 4.52, 4.82, 5.12, 5.33, 5.55 },
+  { 0.0, 0.15, 0.23, 0.38, 0.6, 0.88, 1.18, 1.48, 1.91, 2.41,
+    2.73, 3.32, 3.9, 4.52, 5.12, 5.55 },
+  { 0.12, 0.15, 0.19, 0.25, 0.30, 0.37, 0.44, 0.51, 0.59, 0.66,
+    0.33, 0.37, 0.42, 0.48, 0.54, 0.60, 0.64,
+    0.43, 0.46, 0.50, 0.55, 0.60, 0.65, 0.70, 0.75, 0.80, 0.85, 0.89, 0.93 },
+  { 2, 2, 2, 2, 2, 2, 2, 2, 2, 2,
+    4, 4, 4, 4, 4, 4, 4,
+    6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6, 6 },
+  { 1.6, 1.61, 1.63, 1.65, 1.67, 1.7, 1.73, 1.76, 1.79, 1.82,
+    3.97, 4.27, 4.71, 5.16, 5.66, 6.16, 6.5, 9.95, 10.97,
+    12.92, 14.96, 17.06, 19.33, 21.85, 24.51, 27.14, 29.94, 32.05, 34.28 }
+};
+
+static const NrMcsTableReference Reference2 = {
+  { 0.23, 0.38, 0.60, 0.88, 1.18,
+    1.48, 1.70, 1.91, 2.16, 2.41, 2.57,
+    2.73, 3.03, 3.32, 3.61, 3.90, 4.21, 4.52, 4.82, 5.12,
+    5.33, 5.55, 5.89, 6.23, 6.57, 6.91, 7.16, 7.41 },
+  { 0.0, 0.15, 0.38, 0.88, 1.48, 1.91, 2.41, 2.73, 3.32, 3.90,
+    4.52, 5.12, 5.55, 6.23, 6.91, 7.41 },
+  { 0.12, 0.19, 0.30, 0.44, 0.59,
+    0.37, 0.42, 0.48, 0.54, 0.60, 0.64,
+    0.46, 0.50, 0.55, 0.60, 0.65, 0.70, 0.75, 0.80, 0.85,
+    0.67, 0.69, 0.74, 0.77, 0.82, 0.86, 0.90, 0.93 },
+  { 2, 2, 2, 2, 2,
+    4, 4, 4, 4, 4, 4,
+    6, 6, 6, 6, 6, 6, 6, 6, 6,
+    8, 8, 8, 8, 8, 8, 8, 8 },
+  { 1.6, 1.63, 1.67, 1.73, 1.79, 4.27, 4.71, 5.16, 5.66, 6.16,
+    6.5, 10.97, 12.92, 14.96, 17.06, 19.33, 21.85, 24.51, 27.14,
+    29.94, 56.48, 65.0, 78.58, 92.48, 106.27, 118.74, 126.36, 132.54 }
+};
+
+/**
+ * \brief Check the tables of an EESM error model, and of a NrAmc using it
+ */
+class NrMcsTablesTestCase : public TestCase
+{
+public:
+  /**
+   * \brief NrMcsTablesTestCase constructor
+   * \param errorModel the error model type
+   * \param id the table it should use
+   */
+  NrMcsTablesTestCase (const TypeId &errorModel, NrMcsTable::TableId id)
+    : TestCase ("MCS and CQI tables of " + errorModel.GetName ()),
+      m_errorModel (errorModel),
+      m_tableId (id)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  TypeId m_errorModel;           //!< The error model type
+  NrMcsTable::TableId m_tableId; //!< The expected table
+};
+
+void
+NrMcsTablesTestCase::DoRun ()
+{
+  const NrMcsTableReference &ref = m_tableId == NrMcsTable::TABLE1 ? Reference1 : Reference2;
+
+  ObjectFactory factory;
+  factory.SetTypeId (m_errorModel);
+  Ptr<NrErrorModel> em = DynamicCast<NrErrorModel> (factory.Create ());
+  const NrMcsTable *table = em->GetMcsTable ();
+
+  NS_TEST_ASSERT_MSG_EQ ((table != nullptr), true, "The EESM error models expose their table");
+  NS_TEST_ASSERT_MSG_EQ (table->m_tableId, m_tableId, "Wrong table");
+  NS_TEST_ASSERT_MSG_EQ (static_cast<size_t> (table->m_maxMcs), ref.m_seMcs.size () - 1, "Wrong maximum MCS");
+  NS_TEST_ASSERT_MSG_EQ (+em->GetMaxMcs (), +table->m_maxMcs, "Wrong maximum MCS");
+
+  for (uint8_t mcs = 0; mcs <= table->m_maxMcs; ++mcs)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table->m_spectralEfficiencyForMcs[mcs], ref.m_seMcs.at (mcs), "SE of MCS " << +mcs);
+      NS_TEST_ASSERT_MSG_EQ (em->GetSpectralEfficiencyForMcs (mcs), ref.m_seMcs.at (mcs), "SE of MCS " << +mcs);
+      NS_TEST_ASSERT_MSG_EQ (table->m_mcsEcr[mcs], ref.m_ecr.at (mcs), "ECR of MCS " << +mcs);
+      NS_TEST_ASSERT_MSG_EQ (+table->m_mcsM[mcs], +ref.m_m.at (mcs), "Modulation order of MCS " << +mcs);
+      NS_TEST_ASSERT_MSG_EQ (table->m_beta[mcs], ref.m_beta.at (mcs), "Beta of MCS " << +mcs);
+
+      // TBS (up to step 2) computed with the same values as before
+      uint32_t expected = static_cast<uint32_t> (std::floor (11 * 52 * ref.m_m.at (mcs) * ref.m_ecr.at (mcs) / 8));
+      NS_TEST_ASSERT_MSG_EQ (em->GetPayloadSize (11, mcs, 52, NrErrorModel::DL), expected,
+                             "Payload size of MCS " << +mcs);
+    }
+
+  for (uint8_t cqi = 0; cqi <= 15; ++cqi)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table->m_spectralEfficiencyForCqi[cqi], ref.m_seCqi.at (cqi), "SE of CQI " << +cqi);
+      NS_TEST_ASSERT_MSG_EQ (em->GetSpectralEfficiencyForCqi (cqi), ref.m_seCqi.at (cqi), "SE of CQI " << +cqi);
+    }
+
+  // NrAmc reads the table directly: check it against the loops on the
+  // reference values
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+  amc->SetAttribute ("ErrorModelType", TypeIdValue (m_errorModel));
+  NS_TEST_ASSERT_MSG_EQ (static_cast<size_t> (amc->GetMaxMcs ()), ref.m_seMcs.size () - 1, "Wrong maximum MCS in AMC");
+
+  for (uint8_t cqi = 0; cqi <= 15; ++cqi)
+    {
+      uint8_t mcs = 0;
+      while (mcs + 1u < ref.m_seMcs.size () && ref.m_seMcs.at (mcs + 1) <= ref.m_seCqi.at (cqi))
+        {
+          ++mcs;
+        }
+      NS_TEST_ASSERT_MSG_EQ (+amc->GetMcsFromCqi (cqi), +mcs, "MCS of CQI " << +cqi);
+    }
+
+  for (double s = 0.0; s < 8.0; s += 0.05)
+    {
+      uint8_t cqi = 0;
+      while (cqi < 15 && ref.m_seCqi.at (cqi + 1) < s)
+        {
+          ++cqi;
+        }
+      uint8_t mcs = 0;
+      while (mcs + 1u < ref.m_seMcs.size () && ref.m_seMcs.at (mcs + 1) < s)
+        {
+          ++mcs;
+        }
+      NS_TEST_ASSERT_MSG_EQ (+amc->GetCqiFromSpectralEfficiency (s), +cqi, "CQI of SE " << s);
+      NS_TEST_ASSERT_MSG_EQ (+amc->GetMcsFromSpectralEfficiency (s), +mcs, "MCS of SE " << s);
+    }
+}
+
+/**
+ * \brief Check the view of the tables of the LTE MI error model
+ */
+class NrMcsTablesLteTestCase : public TestCase
+{
+public:
+  NrMcsTablesLteTestCase () : TestCase ("MCS and CQI tables of the LTE MI error model")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrMcsTablesLteTestCase::DoRun ()
+{
+  Ptr<NrLteMiErrorModel> em = CreateObject<NrLteMiErrorModel> ();
+  const NrMcsTable *table = em->GetMcsTable ();
+
+  NS_TEST_ASSERT_MSG_EQ ((table != nullptr), true, "The LTE MI error model exposes its table");
+  NS_TEST_ASSERT_MSG_EQ (table->m_tableId, NrMcsTable::LTE_MI, "Wrong table");
+  NS_TEST_ASSERT_MSG_EQ (+table->m_maxMcs, +em->GetMaxMcs (), "Wrong maximum MCS");
+  NS_TEST_ASSERT_MSG_EQ ((table->m_beta == nullptr), true, "No beta in the LTE MI error model");
+
+  for (uint8_t mcs = 0; mcs <= table->m_maxMcs; ++mcs)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table->m_spectralEfficiencyForMcs[mcs], em->GetSpectralEfficiencyForMcs (mcs),
+                             "SE of MCS " << +mcs);
+      uint32_t expected = static_cast<uint32_t> (11 * 52 * table->m_mcsM[mcs] * table->m_mcsEcr[mcs] / 8);
+      NS_TEST_ASSERT_MSG_EQ (em->GetPayloadSize (11, mcs, 52, NrErrorModel::DL), expected,
+                             "Payload size of MCS " << +mcs);
+    }
+  for (uint8_t cqi = 0; cqi <= 15; ++cqi)
+    {
+      NS_TEST_ASSERT_MSG_EQ (table->m_spectralEfficiencyForCqi[cqi], em->GetSpectralEfficiencyForCqi (cqi),
+                             "SE of CQI " << +cqi);
+    }
+}
+
+/**
+ * \brief Test suite for the MCS and CQI tables
+ */
+class NrMcsTablesTestSuite : public TestSuite
+{
+public:
+  NrMcsTablesTestSuite () : TestSuite ("nr-test-mcs-tables", UNIT)
+  {
+    static_assert (NrMcsTable::Get (NrMcsTable::TABLE1).m_maxMcs == 28, "Table1 has 29 MCSs");
+    static_assert (NrMcsTable::Get (NrMcsTable::TABLE2).m_maxMcs == 27, "Table2 has 28 MCSs");
+    static_assert (NrMcsTable2::McsM.back () == 8, "Table2 goes up to 256QAM");
+
+    AddTestCase (new NrMcsTablesTestCase (NrEesmIrT1::GetTypeId (), NrMcsTable::TABLE1), TestCase::QUICK);
+    AddTestCase (new NrMcsTablesTestCase (NrEesmCcT1::GetTypeId (), NrMcsTable::TABLE1), TestCase::QUICK);
+    AddTestCase (new NrMcsTablesTestCase (NrEesmIrT2::GetTypeId (), NrMcsTable::TABLE2), TestCase::QUICK);
+    AddTestCase (new NrMcsTablesTestCase (NrEesmCcT2::GetTypeId (), NrMcsTable::TABLE2), TestCase::QUICK);
+    AddTestCase (new NrMcsTablesLteTestCase, TestCase::QUICK);
+  }
+};
+
+static NrMcsTablesTestSuite nrMcsTablesTestSuite; //!< MCS tables test suite
+
+} // namespace ns3
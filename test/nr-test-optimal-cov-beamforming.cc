@@ -0,0 +1,390 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/uinteger.h>
+#include <ns3/node.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/uniform-planar-array.h>
+#include <ns3/multi-model-spectrum-channel.h>
+#include <ns3/three-gpp-spectrum-propagation-loss-model.h>
+#include <ns3/nr-spectrum-phy.h>
+#include <ns3/ideal-beamforming-algorithm.h>
+#include <cmath>
+
+/**
+ * \file nr-test-optimal-cov-beamforming.cc
+ * \ingroup test
+ *
+ * \brief Check the power iteration used by OptimalCovMatrixBeamforming to
+ * find the principal eigenvector of a covariance matrix.
+ *
+ * The covariance matrix is built as R = a a^H + b b^H + sigma I, with a and
+ * b orthogonal and |a| > |b|: its principal eigenvector is a / |a|, up to a
+ * phase. The test checks |<v, a>| / |a| = 1, and that a null matrix gives a
+ * unit norm vector.
+ *
+ * Then, the test checks that the vectors returned by GetBeamformingVectors
+ * maximize the gain |w_u^T H w_s| of a single-cluster channel between a gNB
+ * with 3 elements and a UE with 2 elements, against an exhaustive search,
+ * with the gNB as the s-node or as the u-node of the channel matrix, and
+ * that the cached vectors are refreshed when the channel changes.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Check the principal eigenvector of a covariance matrix with two
+ * orthogonal directions
+ */
+class NrOptimalCovBeamformingTestCase : public TestCase
+{
+public:
+  NrOptimalCovBeamformingTestCase () : TestCase ("Principal eigenvector of a covariance matrix")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrOptimalCovBeamformingTestCase::DoRun ()
+{
+  const size_t n = 16;
+  complexVector_t a (n), b (n);
+  for (size_t i = 0; i < n; ++i)
+    {
+      // two steering vectors towards different directions, orthogonal
+      // because their phase slopes differ by 2 pi / n
+      a[i] = std::polar (2.0, M_PI * 0.3 * i);
+      b[i] = std::polar (1.0, M_PI * 0.3 * i + 2 * M_PI * i / n);
+    }
+
+  OptimalCovMatrixBeamforming::ComplexMatrix r (n, complexVector_t (n));
+  for (size_t i = 0; i < n; ++i)
+    {
+      for (size_t j = 0; j < n; ++j)
+        {
+          r[i][j] = a[i] * std::conj (a[j]) + b[i] * std::conj (b[j]) + (i == j ? 0.1 : 0.0);
+        }
+    }
+
+  complexVector_t v = OptimalCovMatrixBeamforming::GetPrincipalEigenvector (r, 100, 1e-9);
+  NS_TEST_ASSERT_MSG_EQ (v.size (), n, "Wrong size of the eigenvector");
+
+  double normV = 0.0, normA = 0.0;
+  std::complex<double> product (0.0, 0.0);
+  for (size_t i = 0; i < n; ++i)
+    {
+      normV += std::norm (v[i]);
+      normA += std::norm (a[i]);
+      product += std::conj (a[i]) * v[i];
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (normV, 1.0, 1e-9, "The eigenvector should have unit norm");
+  NS_TEST_ASSERT_MSG_EQ_TOL (std::abs (product) / std::sqrt (normA), 1.0, 1e-6,
+                             "The eigenvector should be aligned with the strongest direction");
+
+  OptimalCovMatrixBeamforming::ComplexMatrix zero (n, complexVector_t (n));
+  complexVector_t u = OptimalCovMatrixBeamforming::GetPrincipalEigenvector (zero, 100, 1e-9);
+  double normU = 0.0;
+  for (const auto &c : u)
+    {
+      normU += std::norm (c);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (normU, 1.0, 1e-9, "A null matrix should give a unit norm vector");
+}
+
+/**
+ * \ingroup test
+ * \brief A channel model that returns the channel matrix set by the test
+ */
+class NrTestFixedChannelModel : public MatrixBasedChannelModel
+{
+public:
+  /**
+   * \brief Get the type id
+   * \return the type id of the class
+   */
+  static TypeId GetTypeId (void)
+  {
+    static TypeId tid = TypeId ("ns3::NrTestFixedChannelModel")
+      .SetParent<MatrixBasedChannelModel> ()
+      .SetGroupName ("nr")
+      .AddConstructor<NrTestFixedChannelModel> ()
+    ;
+    return tid;
+  }
+
+  virtual Ptr<const ChannelMatrix> GetChannel ([[maybe_unused]] Ptr<const MobilityModel> aMob,
+                                               [[maybe_unused]] Ptr<const MobilityModel> bMob,
+                                               [[maybe_unused]] Ptr<const PhasedArrayModel> aAntenna,
+                                               [[maybe_unused]] Ptr<const PhasedArrayModel> bAntenna) override
+  {
+    return m_matrix;
+  }
+
+  Ptr<ChannelMatrix> m_matrix; //!< The channel matrix returned for any link
+};
+
+/**
+ * \ingroup test
+ * \brief Compare the vectors of OptimalCovMatrixBeamforming with an
+ * exhaustive search of the gain of the link
+ *
+ * The search goes through a grid of the unit vectors of the UE (2 elements,
+ * up to a common phase); for each of them, the best gNB vector is the
+ * normalized conjugate of the effective channel, whose norm is the gain.
+ */
+class NrOptimalCovBeamformingSearchTestCase : public TestCase
+{
+public:
+  NrOptimalCovBeamformingSearchTestCase () : TestCase ("Beamforming vectors of OptimalCovMatrixBeamforming against an exhaustive search")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Set the single-cluster channel matrix of the link
+   * \param gnbIsS true if the gNB is the s-node of the matrix
+   * \param seed the seed of the deterministic channel coefficients
+   * \param generatedTime the generation time of the matrix
+   */
+  void SetChannel (bool gnbIsS, double seed, Time generatedTime);
+  /**
+   * \brief Get the gain of the link with a pair of beamforming vectors
+   * \param bfPair the vectors of the gNB and the UE
+   * \return |w_u^T H w_s|
+   */
+  double GetGain (const BeamformingVectorPair &bfPair) const;
+  /**
+   * \brief Search the best gain of the link
+   * \return the best gain found
+   */
+  double SearchBestGain () const;
+  /**
+   * \brief Get the vectors of the link, and check that they are optimal
+   * \param bf the algorithm
+   * \return the vectors
+   */
+  BeamformingVectorPair CheckOptimal (Ptr<OptimalCovMatrixBeamforming> bf);
+
+  Ptr<NrTestFixedChannelModel> m_channelModel; //!< The channel model
+  Ptr<NrSpectrumPhy> m_gnbPhy;                 //!< The spectrum phy of the gNB
+  Ptr<NrSpectrumPhy> m_uePhy;                  //!< The spectrum phy of the UE
+  Ptr<UniformPlanarArray> m_gnbArray;          //!< The antenna of the gNB (1x3)
+  Ptr<UniformPlanarArray> m_ueArray;           //!< The antenna of the UE (1x2)
+  bool m_gnbIsS {true};                        //!< The gNB is the s-node of the matrix
+};
+
+void
+NrOptimalCovBeamformingSearchTestCase::SetChannel (bool gnbIsS, double seed, Time generatedTime)
+{
+  m_gnbIsS = gnbIsS;
+  size_t sSize = gnbIsS ? m_gnbArray->GetNumberOfElements () : m_ueArray->GetNumberOfElements ();
+  size_t uSize = gnbIsS ? m_ueArray->GetNumberOfElements () : m_gnbArray->GetNumberOfElements ();
+
+  Ptr<MatrixBasedChannelModel::ChannelMatrix> matrix = Create<MatrixBasedChannelModel::ChannelMatrix> ();
+  matrix->m_channel.assign (uSize, MatrixBasedChannelModel::Complex2DVector (sSize, complexVector_t (1)));
+  for (size_t u = 0; u < uSize; ++u)
+    {
+      for (size_t s = 0; s < sSize; ++s)
+        {
+          matrix->m_channel[u][s][0] = std::polar (1.0 + 0.5 * std::sin (seed + 3.0 * u + s),
+                                                   0.7 * seed * (u + 1) * (s + 2));
+        }
+    }
+  matrix->m_generatedTime = generatedTime;
+  matrix->m_antennaPair = gnbIsS ? std::make_pair (m_gnbArray->GetId (), m_ueArray->GetId ())
+                                 : std::make_pair (m_ueArray->GetId (), m_gnbArray->GetId ());
+  m_channelModel->m_matrix = matrix;
+}
+
+double
+NrOptimalCovBeamformingSearchTestCase::GetGain (const BeamformingVectorPair &bfPair) const
+{
+  const auto &h = m_channelModel->m_matrix->m_channel;
+  const complexVector_t &sW = m_gnbIsS ? bfPair.first.first : bfPair.second.first;
+  const complexVector_t &uW = m_gnbIsS ? bfPair.second.first : bfPair.first.first;
+  std::complex<double> gain (0.0, 0.0);
+  for (size_t u = 0; u < h.size (); ++u)
+    {
+      for (size_t s = 0; s < h[u].size (); ++s)
+        {
+          gain += uW[u] * h[u][s][0] * sW[s];
+        }
+    }
+  return std::abs (gain);
+}
+
+double
+NrOptimalCovBeamformingSearchTestCase::SearchBestGain () const
+{
+  const auto &h = m_channelModel->m_matrix->m_channel;
+  const uint32_t thetaSteps = 90;
+  const uint32_t phiSteps = 180;
+  double best = 0.0;
+  for (uint32_t t = 0; t <= thetaSteps; ++t)
+    {
+      double theta = M_PI / 2 * t / thetaSteps;
+      for (uint32_t p = 0; p < phiSteps; ++p)
+        {
+          complexVector_t ueW {std::cos (theta), std::polar (std::sin (theta), 2 * M_PI * p / phiSteps)};
+          // Effective channel seen by the gNB with this UE vector
+          double norm = 0.0;
+          if (m_gnbIsS)
+            {
+              for (size_t s = 0; s < h[0].size (); ++s)
+                {
+                  std::complex<double> a (0.0, 0.0);
+                  for (size_t u = 0; u < h.size (); ++u)
+                    {
+                      a += ueW[u] * h[u][s][0];
+                    }
+                  norm += std::norm (a);
+                }
+            }
+          else
+            {
+              for (size_t u = 0; u < h.size (); ++u)
+                {
+                  std::complex<double> b (0.0, 0.0);
+                  for (size_t s = 0; s < h[u].size (); ++s)
+                    {
+                      b += h[u][s][0] * ueW[s];
+                    }
+                  norm += std::norm (b);
+                }
+            }
+          best = std::max (best, std::sqrt (norm));
+        }
+    }
+  return best;
+}
+
+BeamformingVectorPair
+NrOptimalCovBeamformingSearchTestCase::CheckOptimal (Ptr<OptimalCovMatrixBeamforming> bf)
+{
+  BeamformingVectorPair bfPair = bf->GetBeamformingVectors (m_gnbPhy, m_uePhy);
+  NS_TEST_EXPECT_MSG_EQ (bfPair.first.first.size (), m_gnbArray->GetNumberOfElements (),
+                         "The gNB vector should have an element for each gNB antenna");
+  NS_TEST_EXPECT_MSG_EQ (bfPair.second.first.size (), m_ueArray->GetNumberOfElements (),
+                         "The UE vector should have an element for each UE antenna");
+  if (bfPair.first.first.size () != m_gnbArray->GetNumberOfElements ()
+      || bfPair.second.first.size () != m_ueArray->GetNumberOfElements ())
+    {
+      return bfPair;
+    }
+
+  for (const auto &w : {bfPair.first.first, bfPair.second.first})
+    {
+      double norm = 0.0;
+      for (const auto &c : w)
+        {
+          norm += std::norm (c);
+        }
+      NS_TEST_EXPECT_MSG_EQ_TOL (norm, 1.0, 1e-9, "The beamforming vectors should have unit norm");
+    }
+
+  double gain = GetGain (bfPair);
+  double best = SearchBestGain ();
+  NS_TEST_EXPECT_MSG_GT_OR_EQ (gain, best * (1.0 - 1e-6),
+                               "The vectors should be at least as good as the exhaustive search");
+  NS_TEST_EXPECT_MSG_LT_OR_EQ (gain, best * (1.0 + 1e-2),
+                               "The exhaustive search should get close to the optimum");
+  return bfPair;
+}
+
+void
+NrOptimalCovBeamformingSearchTestCase::DoRun ()
+{
+  m_gnbArray = CreateObject<UniformPlanarArray> ();
+  m_gnbArray->SetAttribute ("NumColumns", UintegerValue (3));
+  m_gnbArray->SetAttribute ("NumRows", UintegerValue (1));
+  m_ueArray = CreateObject<UniformPlanarArray> ();
+  m_ueArray->SetAttribute ("NumColumns", UintegerValue (2));
+  m_ueArray->SetAttribute ("NumRows", UintegerValue (1));
+
+  m_channelModel = CreateObject<NrTestFixedChannelModel> ();
+  Ptr<ThreeGppSpectrumPropagationLossModel> splm = CreateObject<ThreeGppSpectrumPropagationLossModel> ();
+  splm->SetChannelModel (m_channelModel);
+  Ptr<MultiModelSpectrumChannel> channel = CreateObject<MultiModelSpectrumChannel> ();
+  channel->AddPhasedArraySpectrumPropagationLossModel (splm);
+
+  std::vector<Ptr<NrSpectrumPhy>> phys;
+  for (const auto &array : {m_gnbArray, m_ueArray})
+    {
+      Ptr<Node> node = CreateObject<Node> ();
+      Ptr<ConstantPositionMobilityModel> mob = CreateObject<ConstantPositionMobilityModel> ();
+      node->AggregateObject (mob);
+      Ptr<NrSpectrumPhy> phy = CreateObject<NrSpectrumPhy> ();
+      phy->SetAntenna (array);
+      phy->SetMobility (mob);
+      phy->SetChannel (channel);
+      phys.push_back (phy);
+    }
+  m_gnbPhy = phys.at (0);
+  m_uePhy = phys.at (1);
+
+  Ptr<OptimalCovMatrixBeamforming> bf = CreateObject<OptimalCovMatrixBeamforming> ();
+
+  // The gNB is the s-node
+  SetChannel (true, 1.0, MilliSeconds (0));
+  BeamformingVectorPair first = CheckOptimal (bf);
+
+  // A different channel with the same generation time: the cached vectors
+  SetChannel (true, 2.0, MilliSeconds (0));
+  BeamformingVectorPair cached = bf->GetBeamformingVectors (m_gnbPhy, m_uePhy);
+  NS_TEST_ASSERT_MSG_EQ ((cached.first.first == first.first.first && cached.second.first == first.second.first),
+                         true, "The vectors of a channel not updated should come from the cache");
+
+  // The same channel, generated later: the vectors are refreshed
+  SetChannel (true, 2.0, MilliSeconds (10));
+  BeamformingVectorPair refreshed = CheckOptimal (bf);
+  NS_TEST_ASSERT_MSG_EQ ((refreshed.first.first == first.first.first), false,
+                         "The vectors should be refreshed when the channel changes");
+
+  // The UE is the s-node: the vectors are swapped back to the gNB and the UE
+  SetChannel (false, 3.0, MilliSeconds (20));
+  CheckOptimal (bf);
+
+  m_gnbPhy->Dispose ();
+  m_uePhy->Dispose ();
+  m_gnbPhy = nullptr;
+  m_uePhy = nullptr;
+  m_channelModel = nullptr;
+  Simulator::Destroy ();
+}
+
+/**
+ * \ingroup test
+ * \brief The test suite of OptimalCovMatrixBeamforming
+ */
+class NrOptimalCovBeamformingTestSuite : public TestSuite
+{
+public:
+  NrOptimalCovBeamformingTestSuite () : TestSuite ("nr-test-optimal-cov-beamforming", UNIT)
+  {
+    AddTestCase (new NrOptimalCovBeamformingTestCase, TestCase::QUICK);
+    AddTestCase (new NrOptimalCovBeamformingSearchTestCase, TestCase::QUICK);
+  }
+};
+
+static NrOptimalCovBeamformingTestSuite nrOptimalCovBeamformingTestSuite; //!< Optimal covariance beamforming test suite
+
+} // namespace ns3
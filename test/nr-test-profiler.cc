@@ -0,0 +1,116 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/boolean.h>
+#include <ns3/nr-profiler.h>
+
+/**
+ * \file nr-test-profiler.cc
+ * \ingroup test
+ *
+ * \brief Check the samples, the histograms and the trace of NrProfiler.
+ */
+namespace ns3 {
+
+class NrProfilerTestCase : public TestCase
+{
+public:
+  NrProfilerTestCase () : TestCase ("Samples and histograms of NrProfiler")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  /**
+   * \brief Count the samples fired by the trace
+   * \param probe the probe
+   * \param value the value of the sample
+   */
+  void Sample (uint8_t probe, uint64_t value);
+
+  uint32_t m_tracedSamples {0}; //!< Samples fired by the trace
+};
+
+void
+NrProfilerTestCase::Sample ([[maybe_unused]] uint8_t probe, [[maybe_unused]] uint64_t value)
+{
+  m_tracedSamples++;
+}
+
+void
+NrProfilerTestCase::DoRun ()
+{
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::GetBin (0), 0, "0 should be in the bin 0");
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::GetBin (1), 1, "1 should be in the bin 1");
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::GetBin (3), 2, "3 should be in the bin 2");
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::GetBin (4), 3, "4 should be in the bin 3");
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::GetBin (UINT64_MAX), 64, "The maximum should be in the last bin");
+
+  Ptr<NrProfiler> profiler = CreateObject<NrProfiler> ();
+  profiler->TraceConnectWithoutContext ("Sample", MakeCallback (&NrProfilerTestCase::Sample, this));
+
+  for (uint64_t v : {0, 5, 6, 7, 1000})
+    {
+      profiler->AddSample (NrProfiler::MAC_SCHED_DL_UES, v);
+    }
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetNumSamples (NrProfiler::MAC_SCHED_DL_UES), 5, "Wrong number of samples");
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetTotal (NrProfiler::MAC_SCHED_DL_UES), 1018, "Wrong sum of the samples");
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetBinCount (NrProfiler::MAC_SCHED_DL_UES, 0), 1, "Wrong count of the bin of 0");
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetBinCount (NrProfiler::MAC_SCHED_DL_UES, 3), 3, "Wrong count of the bin [4, 8)");
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetBinCount (NrProfiler::MAC_SCHED_DL_UES, 10), 1, "Wrong count of the bin [512, 1024)");
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetNumSamples (NrProfiler::MAC_SCHED_UL_UES), 0, "Other probes should be empty");
+  NS_TEST_ASSERT_MSG_EQ (m_tracedSamples, 5, "Every sample should be traced");
+
+  std::ostringstream summary;
+  profiler->PrintSummary (summary);
+  NS_TEST_ASSERT_MSG_NE (summary.str ().find ("MacSchedDlUes\t5\t1018"), std::string::npos,
+                         "The summary should report the probe");
+  NS_TEST_ASSERT_MSG_EQ (summary.str ().find ("MacSchedUlUes"), std::string::npos,
+                         "The summary should skip the empty probes");
+
+  profiler->Reset ();
+  NS_TEST_ASSERT_MSG_EQ (profiler->GetNumSamples (NrProfiler::MAC_SCHED_DL_UES), 0, "Reset should remove the samples");
+
+  {
+    NrProfiler::Scope scope (NrProfiler::MAC_SCHED_DL);
+  }
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::Get ()->GetNumSamples (NrProfiler::MAC_SCHED_DL), 1,
+                         "A scope should record one sample in the profiler of the module");
+  NS_TEST_ASSERT_MSG_GT (NrProfiler::MeasureOverhead (1000), 0.0, "The overhead should be measured");
+
+  NrProfiler::Get ()->SetAttribute ("PrintSummary", BooleanValue (false));
+  Simulator::Destroy ();
+  NrProfiler::Get ()->SetAttribute ("PrintSummary", BooleanValue (true));
+  NS_TEST_ASSERT_MSG_EQ (NrProfiler::Get ()->GetNumSamples (NrProfiler::MAC_SCHED_DL), 0,
+                         "The samples should be reset at the end of the simulation");
+  Simulator::Destroy ();
+}
+
+class NrProfilerTestSuite : public TestSuite
+{
+public:
+  NrProfilerTestSuite () : TestSuite ("nr-test-profiler", UNIT)
+  {
+    AddTestCase (new NrProfilerTestCase, TestCase::QUICK);
+  }
+};
+
+static NrProfilerTestSuite nrProfilerTestSuite; //!< NR profiler test suite
+
+} // namespace ns3
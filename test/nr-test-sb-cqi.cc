@@ -0,0 +1,404 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-amc.h>
+#include <ns3/nr-control-messages.h>
+#include <ns3/nr-spectrum-value-helper.h>
+#include <ns3/nr-mac-scheduler-ofdma-sb-pf.h>
+#include <ns3/nr-mac-scheduler-ue-info-pf.h>
+
+#include <algorithm>
+
+/**
+ * \file nr-test-sb-cqi.cc
+ * \ingroup test
+ *
+ * \brief Check the sub-band CQI: the UE must report a higher CQI for the
+ * sub-bands with a higher SINR, and the differential encoding of the
+ * NrDlCqiMessage must preserve the offsets that it can represent, and
+ * quantize the others. NrMacSchedulerOfdmaSbPF must give to each UE the RBGs
+ * of its best sub-bands, without starving a UE with a lower average
+ * throughput.
+ */
+namespace ns3 {
+
+class NrSbCqiFeedbackTestCase : public TestCase
+{
+public:
+  NrSbCqiFeedbackTestCase () : TestCase ("Sub-band CQI from a frequency-selective SINR")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrSbCqiFeedbackTestCase::DoRun ()
+{
+  const uint32_t rbNum = 48;
+  const uint16_t rbPerSb = 8;
+  Ptr<const SpectrumModel> sm = NrSpectrumValueHelper::GetSpectrumModel (rbNum, 3.5e9, 30000);
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+
+  // Linear SINR: low in the first half of the band, high in the second one
+  SpectrumValue sinr (sm);
+  for (uint32_t rb = 0; rb < rbNum; ++rb)
+    {
+      sinr[rb] = rb < rbNum / 2 ? 1.0 : 100.0;
+    }
+
+  std::vector<uint8_t> sbCqi = amc->CreateCqiFeedbackSbTdma (sinr, rbPerSb);
+  NS_TEST_ASSERT_MSG_EQ (sbCqi.size (), rbNum / rbPerSb, "Wrong number of sub-bands");
+  for (uint32_t sb = 0; sb < sbCqi.size (); ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (sbCqi.at (sb), sbCqi.at (sb < sbCqi.size () / 2 ? 0 : sbCqi.size () - 1),
+                             "Sub-bands with the same SINR should have the same CQI");
+    }
+  NS_TEST_ASSERT_MSG_GT (sbCqi.back (), sbCqi.front (),
+                         "The sub-bands with higher SINR should have a higher CQI");
+
+  // A sub-band without signal takes the wideband CQI
+  for (uint32_t rb = 0; rb < rbPerSb; ++rb)
+    {
+      sinr[rb] = 0.0;
+    }
+  uint8_t mcs;
+  uint8_t wbCqi = amc->CreateCqiFeedbackWbTdma (sinr, mcs);
+  sbCqi = amc->CreateCqiFeedbackSbTdma (sinr, rbPerSb);
+  NS_TEST_ASSERT_MSG_EQ (sbCqi.front (), wbCqi, "An unmeasured sub-band should take the wideband CQI");
+
+  // The last sub-band can be smaller than the others
+  sbCqi = amc->CreateCqiFeedbackSbTdma (sinr, 10);
+  NS_TEST_ASSERT_MSG_EQ (sbCqi.size (), 5, "Wrong number of sub-bands with a partial sub-band");
+}
+
+class NrSbCqiEncodingTestCase : public TestCase
+{
+public:
+  NrSbCqiEncodingTestCase () : TestCase ("Differential encoding of the sub-band CQI")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrSbCqiEncodingTestCase::DoRun ()
+{
+  // Offsets that can be represented exactly: 0, +1, +2, -1
+  const uint8_t wbCqi = 7;
+  std::vector<uint8_t> exact = {7, 8, 9, 6, 7};
+  std::vector<uint8_t> encoded = NrDlCqiMessage::EncodeSbCqi (wbCqi, exact);
+  NS_TEST_ASSERT_MSG_EQ (encoded.size (), 2, "Four sub-bands should be packed in one byte");
+  std::vector<uint8_t> decoded = NrDlCqiMessage::DecodeSbCqi (wbCqi, encoded, exact.size ());
+  NS_TEST_ASSERT_MSG_EQ (decoded.size (), exact.size (), "Wrong number of decoded sub-bands");
+  for (uint32_t sb = 0; sb < exact.size (); ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+decoded.at (sb), +exact.at (sb), "The offset should be preserved");
+    }
+
+  // Larger offsets are quantized to +2 or -1
+  std::vector<uint8_t> large = {15, 1};
+  decoded = NrDlCqiMessage::DecodeSbCqi (wbCqi, NrDlCqiMessage::EncodeSbCqi (wbCqi, large), large.size ());
+  NS_TEST_ASSERT_MSG_EQ (+decoded.at (0), wbCqi + 2, "A large positive offset should be +2");
+  NS_TEST_ASSERT_MSG_EQ (+decoded.at (1), wbCqi - 1, "A negative offset should be -1");
+
+  // Through the message
+  DlCqiInfo info;
+  info.m_rnti = 1;
+  info.m_cqiType = DlCqiInfo::SB;
+  info.m_wbCqi = {wbCqi, 0};
+  info.m_sbCqi = {exact, {}};
+  info.m_rbPerSb = 4;
+  Ptr<NrDlCqiMessage> msg = Create<NrDlCqiMessage> ();
+  msg->SetDlCqi (info);
+  DlCqiInfo received = msg->GetDlCqi ();
+  NS_TEST_ASSERT_MSG_EQ (received.m_sbCqi.size (), 2, "Wrong number of streams");
+  NS_TEST_ASSERT_MSG_EQ (received.m_sbCqi.at (1).size (), 0, "An unmeasured stream should stay empty");
+  NS_TEST_ASSERT_MSG_EQ (received.m_rbPerSb, 4, "Wrong sub-band size");
+  for (uint32_t sb = 0; sb < exact.size (); ++sb)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+received.m_sbCqi.at (0).at (sb), +exact.at (sb), "Wrong CQI through the message");
+    }
+}
+
+/**
+ * \ingroup test
+ * \brief Scheduler SAP user that only provides the RBG size
+ */
+class NrSbPfTestSchedSapUser : public NrMacSchedSapUser
+{
+public:
+  virtual void SchedConfigInd ([[maybe_unused]] const struct SchedConfigIndParameters& params) override
+  {
+  }
+
+  virtual Ptr<const SpectrumModel> GetSpectrumModel () const override
+  {
+    return nullptr;
+  }
+
+  virtual uint32_t GetNumRbPerRbg () const override
+  {
+    return 1;
+  }
+
+  virtual uint8_t GetNumHarqProcess () const override
+  {
+    return 20;
+  }
+
+  virtual uint16_t GetBwpId () const override
+  {
+    return 0;
+  }
+
+  virtual uint16_t GetCellId () const override
+  {
+    return 0;
+  }
+
+  virtual uint32_t GetSymbolsPerSlot () const override
+  {
+    return 14;
+  }
+
+  virtual Time GetSlotPeriod () const override
+  {
+    return MilliSeconds (1);
+  }
+};
+
+/**
+ * \ingroup test
+ * \brief Configuration SAP user that ignores the confirmations
+ */
+class NrSbPfTestCschedSapUser : public NrMacCschedSapUser
+{
+public:
+  virtual void CschedCellConfigCnf ([[maybe_unused]] const struct CschedCellConfigCnfParameters& params) override
+  {
+  }
+
+  virtual void CschedUeConfigCnf ([[maybe_unused]] const struct CschedUeConfigCnfParameters& params) override
+  {
+  }
+
+  virtual void CschedLcConfigCnf ([[maybe_unused]] const struct CschedLcConfigCnfParameters& params) override
+  {
+  }
+
+  virtual void CschedLcReleaseCnf ([[maybe_unused]] const struct CschedLcReleaseCnfParameters& params) override
+  {
+  }
+
+  virtual void CschedUeReleaseCnf ([[maybe_unused]] const struct CschedUeReleaseCnfParameters& params) override
+  {
+  }
+
+  virtual void CschedUeConfigUpdateInd ([[maybe_unused]] const struct CschedUeConfigUpdateIndParameters& params) override
+  {
+  }
+
+  virtual void CschedCellConfigUpdateInd ([[maybe_unused]] const struct CschedCellConfigUpdateIndParameters& params) override
+  {
+  }
+};
+
+/**
+ * \ingroup test
+ * \brief Give access to the DL RBG assignment of NrMacSchedulerOfdmaSbPF
+ */
+class NrTestSbPfScheduler : public NrMacSchedulerOfdmaSbPF
+{
+public:
+  using NrMacSchedulerOfdmaSbPF::AssignDLRBG;
+  using NrMacSchedulerOfdmaSbPF::CreateDlDci;
+};
+
+/**
+ * \ingroup test
+ * \brief Two UEs with complementary sub-band CQIs in the same beam
+ */
+class NrSbPfSchedulerTestCase : public TestCase
+{
+public:
+  NrSbPfSchedulerTestCase () : TestCase ("Sub-band PF assignment of two UEs with complementary sub-band CQIs")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /**
+   * \brief Create a UE that reports a sub-band CQI
+   * \param rnti the RNTI
+   * \param sbCqi the CQI of each sub-band
+   * \param avgTput the (last) average DL throughput
+   * \param amc the DL AMC
+   * \return the UE
+   */
+  std::shared_ptr<NrMacSchedulerUeInfoPF> CreateUe (uint16_t rnti, const std::vector<uint8_t> &sbCqi,
+                                                    double avgTput, const Ptr<NrAmc> &amc) const;
+
+  /**
+   * \brief Run the DL RBG assignment for the UEs
+   * \param sched the scheduler
+   * \param ues the UEs
+   * \return the DCI of each UE (nullptr if the UE did not get any RBG)
+   */
+  std::vector<std::shared_ptr<DciInfoElementTdma>> Assign (const Ptr<NrTestSbPfScheduler> &sched,
+                                                           const std::vector<std::shared_ptr<NrMacSchedulerUeInfoPF>> &ues) const;
+
+  /**
+   * \brief Get the RBG mask of a DCI
+   * \param dci the DCI
+   * \return the RBG mask, all zeros if there is no DCI
+   */
+  static std::vector<uint8_t> GetRbgMask (const std::shared_ptr<DciInfoElementTdma> &dci);
+
+  static constexpr uint32_t RB_NUM = 16;    //!< Bandwidth, in RBs (one RB per RBG)
+  static constexpr uint16_t RB_PER_SB = 4;  //!< Sub-band size, in RBs
+  static constexpr uint32_t SYM_AVAIL = 12; //!< Symbols available for the DL data
+};
+
+std::shared_ptr<NrMacSchedulerUeInfoPF>
+NrSbPfSchedulerTestCase::CreateUe (uint16_t rnti, const std::vector<uint8_t> &sbCqi,
+                                   double avgTput, const Ptr<NrAmc> &amc) const
+{
+  auto ue = std::make_shared<NrMacSchedulerUeInfoPF> (1.0, rnti, BeamConfId (BeamId (8, 120.0), BeamId::GetEmptyBeamId ()),
+                                                      [] () { return 1; });
+  uint8_t wbCqi = 8;
+  ue->m_dlCqi.m_cqiType = NrMacSchedulerUeInfo::DlCqiInfo::SB;
+  ue->m_dlCqi.m_ri = 1;
+  ue->m_dlCqi.m_wbCqi = {wbCqi};
+  ue->m_dlCqi.m_sbCqi = {sbCqi};
+  ue->m_dlCqi.m_rbPerSb = RB_PER_SB;
+  ue->m_dlMcs = {amc->GetMcsFromCqi (wbCqi)};
+  ue->m_dlTbSize = {0};
+  ue->m_avgTputDl = avgTput;
+  ue->m_lastAvgTputDl = avgTput;
+  return ue;
+}
+
+std::vector<std::shared_ptr<DciInfoElementTdma>>
+NrSbPfSchedulerTestCase::Assign (const Ptr<NrTestSbPfScheduler> &sched,
+                                 const std::vector<std::shared_ptr<NrMacSchedulerUeInfoPF>> &ues) const
+{
+  NrMacSchedulerNs3::ActiveUeMap activeDl;
+  for (const auto &ue : ues)
+    {
+      activeDl[ue->m_beamConfId].emplace_back (ue, 1000000);
+    }
+
+  // As NrMacSchedulerNs3, create a DCI only for the UEs that got RBGs
+  NrMacSchedulerNs3::BeamSymbolMap symPerBeam = sched->AssignDLRBG (SYM_AVAIL, activeDl);
+  std::vector<std::shared_ptr<DciInfoElementTdma>> dcis;
+  for (const auto &ue : ues)
+    {
+      NrMacSchedulerNs3::PointInFTPlane spoint (0, 0);
+      dcis.push_back (ue->m_dlRBG == 0 ? nullptr
+                      : sched->CreateDlDci (&spoint, ue, symPerBeam.at (ue->m_beamConfId)));
+    }
+  return dcis;
+}
+
+std::vector<uint8_t>
+NrSbPfSchedulerTestCase::GetRbgMask (const std::shared_ptr<DciInfoElementTdma> &dci)
+{
+  return dci == nullptr ? std::vector<uint8_t> (RB_NUM, 0) : dci->m_rbgBitmask;
+}
+
+void
+NrSbPfSchedulerTestCase::DoRun ()
+{
+  NrSbPfTestSchedSapUser schedSapUser;
+  NrSbPfTestCschedSapUser cschedSapUser;
+  Ptr<NrAmc> amc = CreateObject<NrAmc> ();
+
+  Ptr<NrTestSbPfScheduler> sched = CreateObject<NrTestSbPfScheduler> ();
+  sched->SetMacSchedSapUser (&schedSapUser);
+  sched->SetMacCschedSapUser (&cschedSapUser);
+  sched->InstallDlAmc (amc);
+  NrMacCschedSapProvider::CschedCellConfigReqParameters cellConfig;
+  cellConfig.m_dlBandwidth = RB_NUM;
+  cellConfig.m_ulBandwidth = RB_NUM;
+  sched->DoCschedCellConfigReq (cellConfig);
+
+  // UE 1 is good in the first half of the band, UE 2 in the second one
+  std::vector<uint8_t> lowFirst = {15, 15, 3, 3};
+  std::vector<uint8_t> lowSecond = {3, 3, 15, 15};
+  NS_ASSERT (lowFirst.size () == RB_NUM / RB_PER_SB);
+  NS_TEST_ASSERT_MSG_EQ (+std::min (amc->GetMcsFromCqi (15), static_cast<uint8_t> (sched->GetMaxDlMcs ())),
+                         +sched->GetMaxDlMcs (), "CQI 15 should map to the maximum MCS");
+
+  // Same average throughput: each UE gets the RBGs of its best sub-bands
+  auto ue1 = CreateUe (1, lowFirst, 100.0, amc);
+  auto ue2 = CreateUe (2, lowSecond, 100.0, amc);
+  auto dcis = Assign (sched, {ue1, ue2});
+  NS_TEST_ASSERT_MSG_NE (dcis.at (0), nullptr, "UE 1 should get a DCI");
+  NS_TEST_ASSERT_MSG_NE (dcis.at (1), nullptr, "UE 2 should get a DCI");
+  for (uint32_t rbg = 0; rbg < RB_NUM; ++rbg)
+    {
+      bool firstHalf = rbg < RB_NUM / 2;
+      NS_TEST_ASSERT_MSG_EQ (+dcis.at (0)->m_rbgBitmask.at (rbg), firstHalf ? 1 : 0, "Wrong RBG " << rbg << " of UE 1");
+      NS_TEST_ASSERT_MSG_EQ (+dcis.at (1)->m_rbgBitmask.at (rbg), firstHalf ? 0 : 1, "Wrong RBG " << rbg << " of UE 2");
+    }
+  for (const auto &dci : dcis)
+    {
+      NS_TEST_ASSERT_MSG_EQ (+dci->m_mcs.at (0), +sched->GetMaxDlMcs (),
+                             "UE " << dci->m_rnti << " should use the MCS of its best sub-bands");
+    }
+  NS_TEST_ASSERT_MSG_EQ (ue1->m_dlRBG, ue2->m_dlRBG, "With the same average throughput, the UEs should share the band");
+  NS_TEST_ASSERT_MSG_GT (dcis.at (0)->m_tbSize.at (0), 0, "UE 1 should get a TB");
+  NS_TEST_ASSERT_MSG_EQ (dcis.at (0)->m_tbSize.at (0), dcis.at (1)->m_tbSize.at (0), "The TBs of the UEs should be equal");
+
+  // PF fairness: a UE served much less than the other one gets also the
+  // RBGs of the sub-bands where the other UE is better
+  ue1 = CreateUe (1, lowFirst, 1.0, amc);
+  ue2 = CreateUe (2, lowSecond, 1000.0, amc);
+  dcis = Assign (sched, {ue1, ue2});
+  std::vector<uint8_t> mask1 = GetRbgMask (dcis.at (0));
+  std::vector<uint8_t> mask2 = GetRbgMask (dcis.at (1));
+  uint32_t ue1Rbgs = 0;
+  for (uint32_t rbg = 0; rbg < RB_NUM; ++rbg)
+    {
+      NS_TEST_ASSERT_MSG_EQ (mask1.at (rbg) + mask2.at (rbg), 1, "RBG " << rbg << " should be assigned once");
+      ue1Rbgs += mask1.at (rbg);
+      if (rbg < RB_NUM / 2)
+        {
+          NS_TEST_ASSERT_MSG_EQ (+mask1.at (rbg), 1, "UE 1 should keep RBG " << rbg << " of its best sub-bands");
+        }
+    }
+  NS_TEST_ASSERT_MSG_GT (ue1Rbgs, RB_NUM / 2, "The UE with the lower average throughput should get more RBGs");
+}
+
+class NrSbCqiTestSuite : public TestSuite
+{
+public:
+  NrSbCqiTestSuite () : TestSuite ("nr-test-sb-cqi", UNIT)
+  {
+    AddTestCase (new NrSbCqiFeedbackTestCase (), QUICK);
+    AddTestCase (new NrSbCqiEncodingTestCase (), QUICK);
+    AddTestCase (new NrSbPfSchedulerTestCase (), QUICK);
+  }
+};
+
+static NrSbCqiTestSuite nrSbCqiTestSuite; //!< Sub-band CQI test suite
+
+}  // namespace ns3
@@ -0,0 +1,95 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-sl-candidate-resource-set.h>
+
+/**
+ * \file nr-test-sl-candidate-resource-set.cc
+ * \ingroup test
+ *
+ * \brief Check the bitmaps of NrSlCandidateResourceSet: the exclusion of
+ * slots and ranges of slots across the words of the bitmap, the count and
+ * the rank/select of the candidates, and the sub-channel occupancy.
+ */
+namespace ns3 {
+
+class NrSlCandidateResourceSetTestCase : public TestCase
+{
+public:
+  NrSlCandidateResourceSetTestCase () : TestCase ("SL candidate resource set bitmaps")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrSlCandidateResourceSetTestCase::DoRun ()
+{
+  // A window spanning three words, the last one partial
+  const uint32_t numSlots = 150;
+  NrSlCandidateResourceSet set (numSlots, 10);
+  NS_TEST_ASSERT_MSG_EQ (set.GetNumCandidates (), numSlots, "All the slots should be candidates");
+
+  set.Exclude (0);
+  set.ExcludeRange (60, 70);
+  set.Exclude (149);
+  NS_TEST_ASSERT_MSG_EQ (set.GetNumCandidates (), numSlots - 13, "Wrong number of candidates after the exclusion");
+  NS_TEST_ASSERT_MSG_EQ (set.IsCandidate (59), true, "Slot before the range should be a candidate");
+  NS_TEST_ASSERT_MSG_EQ (set.IsCandidate (64), false, "Slot in the range should be excluded");
+  NS_TEST_ASSERT_MSG_EQ (set.IsCandidate (71), true, "Slot after the range should be a candidate");
+
+  // Select must agree with the list of candidates
+  std::vector<uint32_t> candidates = set.GetCandidates ();
+  NS_TEST_ASSERT_MSG_EQ (candidates.size (), set.GetNumCandidates (), "Wrong size of the candidate list");
+  for (uint32_t rank = 0; rank < candidates.size (); ++rank)
+    {
+      NS_TEST_ASSERT_MSG_EQ (set.Select (rank), candidates.at (rank), "Wrong slot of rank " << rank);
+    }
+  NS_TEST_ASSERT_MSG_EQ (set.Select (0), 1, "Wrong first candidate");
+  NS_TEST_ASSERT_MSG_EQ (set.Select (59), 71, "Wrong candidate after the excluded range");
+
+  set.SetAllCandidates ();
+  NS_TEST_ASSERT_MSG_EQ (set.GetNumCandidates (), numSlots, "Reset should restore all the candidates");
+
+  // Sub-channel occupancy
+  set.Occupy (5, 0, 4);
+  NS_TEST_ASSERT_MSG_EQ (set.IsFullyOccupied (5), false, "Slot should have free sub-channels");
+  set.Occupy (5, 3, 7);
+  NS_TEST_ASSERT_MSG_EQ (set.IsFullyOccupied (5), true, "All the sub-channels should be occupied");
+  NS_TEST_ASSERT_MSG_EQ (set.GetOccupiedSubCh (5).size (), 10, "Wrong number of occupied sub-channels");
+  set.Occupy (6, 8, 2);
+  std::set<uint8_t> occupied = set.GetOccupiedSubCh (6);
+  NS_TEST_ASSERT_MSG_EQ (occupied.size (), 2, "Wrong number of occupied sub-channels");
+  NS_TEST_ASSERT_MSG_EQ (+*occupied.begin (), 8, "Wrong first occupied sub-channel");
+  NS_TEST_ASSERT_MSG_EQ (NrSlCandidateResourceSet::GetSubChMask (2, 3), 0x1c, "Wrong sub-channel mask");
+}
+
+class NrSlCandidateResourceSetTestSuite : public TestSuite
+{
+public:
+  NrSlCandidateResourceSetTestSuite () : TestSuite ("nr-test-sl-candidate-resource-set", UNIT)
+  {
+    AddTestCase (new NrSlCandidateResourceSetTestCase (), QUICK);
+  }
+};
+
+static NrSlCandidateResourceSetTestSuite nrSlCandidateResourceSetTestSuite; //!< NR SL candidate resource set test suite
+
+}  // namespace ns3
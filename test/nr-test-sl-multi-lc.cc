@@ -0,0 +1,98 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-sl-ue-mac-scheduler-multi-lc.h>
+
+/**
+ * \file nr-test-sl-multi-lc.cc
+ * \ingroup test
+ *
+ * \brief Check how NrSlUeMacSchedulerMultiLc distributes the bytes of a TB
+ * among the LCs of a destination: by priority, then by PQI, sharing the
+ * bytes equally among the LCs with the same priority.
+ */
+namespace ns3 {
+
+class NrSlMultiLcTestCase : public TestCase
+{
+public:
+  NrSlMultiLcTestCase () : TestCase ("Distribution of the TB bytes among the SL LCs")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  NrSlUeMacSchedulerMultiLc::LcBytes CreateLc (uint8_t lcId, uint8_t priority, uint8_t pqi,
+                                               uint32_t bufferSize) const;
+};
+
+NrSlUeMacSchedulerMultiLc::LcBytes
+NrSlMultiLcTestCase::CreateLc (uint8_t lcId, uint8_t priority, uint8_t pqi, uint32_t bufferSize) const
+{
+  NrSlUeMacSchedulerMultiLc::LcBytes lc;
+  lc.lcId = lcId;
+  lc.priority = priority;
+  lc.pqi = pqi;
+  lc.bufferSize = bufferSize;
+  return lc;
+}
+
+void
+NrSlMultiLcTestCase::DoRun ()
+{
+  // The highest priority LC is served first
+  std::vector<NrSlUeMacSchedulerMultiLc::LcBytes> lcs = {CreateLc (4, 3, 21, 100),
+                                                         CreateLc (5, 1, 23, 80)};
+  NrSlUeMacSchedulerMultiLc::DistributeTbBytes (120, lcs);
+  NS_TEST_ASSERT_MSG_EQ (+lcs.at (0).lcId, 5, "The LC with the lowest priority value should be first");
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (0).assignedBytes, 80, "The highest priority LC should be fully served");
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (1).assignedBytes, 40, "The other LC should get the remaining bytes");
+
+  // Equal priority: equal share, and the bytes not needed by a LC go to the others
+  lcs = {CreateLc (4, 2, 21, 30), CreateLc (5, 2, 21, 200), CreateLc (6, 2, 21, 200)};
+  NrSlUeMacSchedulerMultiLc::DistributeTbBytes (150, lcs);
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (0).assignedBytes, 30, "The LC with the smallest buffer should be fully served");
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (1).assignedBytes, 60, "The bytes should be shared equally");
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (2).assignedBytes, 60, "The bytes should be shared equally");
+
+  // The PQI breaks the ties in the ordering
+  lcs = {CreateLc (4, 2, 23, 10), CreateLc (5, 2, 21, 10)};
+  NrSlUeMacSchedulerMultiLc::DistributeTbBytes (5, lcs);
+  NS_TEST_ASSERT_MSG_EQ (+lcs.at (0).lcId, 5, "The LC with the lowest PQI should be first");
+  uint32_t total = lcs.at (0).assignedBytes + lcs.at (1).assignedBytes;
+  NS_TEST_ASSERT_MSG_EQ (total, 5, "All the bytes of the TB should be assigned");
+
+  // A TB larger than the buffers: the extra bytes go to the first LC
+  lcs = {CreateLc (4, 1, 21, 10), CreateLc (5, 2, 21, 10)};
+  NrSlUeMacSchedulerMultiLc::DistributeTbBytes (50, lcs);
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (0).assignedBytes, 40, "The extra bytes should go to the highest priority LC");
+  NS_TEST_ASSERT_MSG_EQ (lcs.at (1).assignedBytes, 10, "The other LC should be fully served");
+}
+
+class NrSlMultiLcTestSuite : public TestSuite
+{
+public:
+  NrSlMultiLcTestSuite () : TestSuite ("nr-test-sl-multi-lc", UNIT)
+  {
+    AddTestCase (new NrSlMultiLcTestCase (), QUICK);
+  }
+};
+
+static NrSlMultiLcTestSuite nrSlMultiLcTestSuite; //!< NR SL multi-LC scheduler test suite
+
+}  // namespace ns3
@@ -0,0 +1,209 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/packet.h>
+#include <ns3/nr-sl-phy-mac-common.h>
+#include <ns3/nr-sl-ue-mac-harq.h>
+
+/**
+ * \file nr-test-sl-psfch.cc
+ * \ingroup test
+ *
+ * \brief Check the PSFCH slot mapping of NrSlPsfchConfig, and how the
+ * NrSlUeMacHarq stores the HARQ feedback received over the PSFCH: the
+ * feedback of an outdated transmission is ignored, and for groupcast a
+ * single NACK wins over the ACKs, a TB is acknowledged only when all the
+ * members sent an ACK, and a silent member is a NACK once the PSFCH
+ * occasion has passed.
+ */
+namespace ns3 {
+
+class NrSlPsfchConfigTestCase : public TestCase
+{
+public:
+  NrSlPsfchConfigTestCase () : TestCase ("PSFCH slot mapping")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrSlPsfchConfigTestCase::DoRun ()
+{
+  NrSlPsfchConfig disabled;
+  NS_TEST_ASSERT_MSG_EQ (disabled.IsEnabled (), false, "PSFCH should be disabled by default");
+  NS_TEST_ASSERT_MSG_EQ (disabled.IsPsfchSlot (0), false, "No PSFCH slot without PSFCH resources");
+  NS_TEST_ASSERT_MSG_EQ (disabled.GetMinReTxGap (), 0, "No gap without PSFCH resources");
+
+  NrSlPsfchConfig config;
+  config.period = 4;
+  config.minTimeGap = 2;
+  NS_TEST_ASSERT_MSG_EQ (config.IsEnabled (), true, "PSFCH should be enabled");
+  for (uint64_t slot = 0; slot < 16; ++slot)
+    {
+      NS_TEST_ASSERT_MSG_EQ (config.IsPsfchSlot (slot), slot % 4 == 0, "Wrong PSFCH slot " << slot);
+    }
+  NS_TEST_ASSERT_MSG_EQ (config.GetMinReTxGap (), 6, "Wrong minimum gap between two transmissions");
+  NS_TEST_ASSERT_MSG_EQ (NrSlPsfchConfig::GetPsfchSymStart (14), 11, "Wrong PSFCH starting symbol");
+}
+
+class NrSlHarqFeedbackTestCase : public TestCase
+{
+public:
+  NrSlHarqFeedbackTestCase () : TestCase ("Storing the PSFCH HARQ feedback")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  NrSlInfoListElement_s CreateFeedback (uint32_t dstL2Id, uint8_t harqId, const SfnSf &sfn,
+                                        NrSlInfoListElement_s::HarqStatus_e status) const;
+};
+
+NrSlInfoListElement_s
+NrSlHarqFeedbackTestCase::CreateFeedback (uint32_t dstL2Id, uint8_t harqId, const SfnSf &sfn,
+                                          NrSlInfoListElement_s::HarqStatus_e status) const
+{
+  NrSlInfoListElement_s feedback;
+  feedback.dstL2Id = dstL2Id;
+  feedback.harqProcessId = harqId;
+  feedback.psschSfn = sfn;
+  feedback.m_harqStatus = status;
+  return feedback;
+}
+
+void
+NrSlHarqFeedbackTestCase::DoRun ()
+{
+  const uint32_t dstL2Id = 255;
+  Ptr<NrSlUeMacHarq> harq = CreateObject<NrSlUeMacHarq> ();
+  harq->InitHarqBuffer (4);
+  uint8_t harqId = harq->AssignNrSlHarqProcessId (0, dstL2Id);
+  harq->AddPacket (dstL2Id, 4, harqId, Create<Packet> (100));
+
+  SfnSf firstTx (0, 0, 0, 0);
+  SfnSf reTx (0, 6, 0, 0);
+  harq->RecordNrSlTx (dstL2Id, harqId, firstTx);
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false, "No feedback received yet");
+
+  // Groupcast: one member NACKs, another one ACKs
+  harq->StoreNrSlHarqFeedback (CreateFeedback (dstL2Id, harqId, firstTx, NrSlInfoListElement_s::NACK));
+  harq->StoreNrSlHarqFeedback (CreateFeedback (dstL2Id, harqId, firstTx, NrSlInfoListElement_s::ACK));
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false, "A NACK should win over an ACK");
+
+  // Retransmission: the feedback of the first transmission is outdated
+  harq->RecordNrSlTx (dstL2Id, harqId, reTx);
+  harq->StoreNrSlHarqFeedback (CreateFeedback (dstL2Id, harqId, firstTx, NrSlInfoListElement_s::ACK));
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false, "An outdated feedback should be ignored");
+  harq->StoreNrSlHarqFeedback (CreateFeedback (dstL2Id + 1, harqId, reTx, NrSlInfoListElement_s::ACK));
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false, "The feedback of another destination should be ignored");
+  harq->StoreNrSlHarqFeedback (CreateFeedback (dstL2Id, harqId, reTx, NrSlInfoListElement_s::ACK));
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), true, "The TB should be acknowledged");
+
+  // Releasing the process resets the feedback
+  harq->RecvNrSlHarqFeedback (dstL2Id, harqId);
+  harqId = harq->AssignNrSlHarqProcessId (harqId, dstL2Id);
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false, "A new TB should not be acknowledged");
+}
+
+/**
+ * \ingroup test
+ * \brief Groupcast HARQ feedback with a member that does not answer
+ */
+class NrSlGroupcastHarqFeedbackTestCase : public TestCase
+{
+public:
+  NrSlGroupcastHarqFeedbackTestCase () : TestCase ("Groupcast HARQ feedback with a silent member")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrSlGroupcastHarqFeedbackTestCase::DoRun ()
+{
+  const uint32_t dstL2Id = 255;
+  const uint64_t psfchSlot = 4;
+  Ptr<NrSlUeMacHarq> harq = CreateObject<NrSlUeMacHarq> ();
+  harq->InitHarqBuffer (4);
+  uint8_t harqId = harq->AssignNrSlHarqProcessId (0, dstL2Id);
+  harq->AddPacket (dstL2Id, 4, harqId, Create<Packet> (100));
+
+  auto createFeedback = [&] (const SfnSf &sfn, uint16_t rxRnti)
+    {
+      NrSlInfoListElement_s feedback;
+      feedback.dstL2Id = dstL2Id;
+      feedback.harqProcessId = harqId;
+      feedback.psschSfn = sfn;
+      feedback.m_harqStatus = NrSlInfoListElement_s::ACK;
+      feedback.rxRnti = rxRnti;
+      return feedback;
+    };
+
+  // A group of three receivers: the third one stays silent
+  SfnSf firstTx (0, 0, 0, 0);
+  harq->RecordNrSlTx (dstL2Id, harqId, firstTx, 3, psfchSlot);
+  harq->StoreNrSlHarqFeedback (createFeedback (firstTx, 1));
+  harq->StoreNrSlHarqFeedback (createFeedback (firstTx, 2));
+  harq->StoreNrSlHarqFeedback (createFeedback (firstTx, 2));
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false,
+                         "Two ACKs out of three members should not acknowledge the TB");
+  NS_TEST_ASSERT_MSG_EQ (harq->GetNrSlHarqStatus (dstL2Id, harqId, psfchSlot), NrSlInfoListElement_s::INVALID,
+                         "The feedback of the third member may still arrive");
+  NS_TEST_ASSERT_MSG_EQ (harq->GetNrSlHarqStatus (dstL2Id, harqId, psfchSlot + 1), NrSlInfoListElement_s::NACK,
+                         "A member silent in the PSFCH occasion should be a NACK");
+
+  // The retransmission is acknowledged by all the members
+  SfnSf reTx (0, 6, 0, 0);
+  harq->RecordNrSlTx (dstL2Id, harqId, reTx, 3, psfchSlot + 60);
+  for (uint16_t rxRnti = 1; rxRnti <= 3; ++rxRnti)
+    {
+      harq->StoreNrSlHarqFeedback (createFeedback (reTx, rxRnti));
+    }
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), true,
+                         "The TB should be acknowledged by all the members");
+  NS_TEST_ASSERT_MSG_EQ (harq->GetNrSlHarqStatus (dstL2Id, harqId, psfchSlot + 61), NrSlInfoListElement_s::ACK,
+                         "The TB should be acknowledged after the PSFCH occasion");
+
+  // With an unknown group size, the TB is never acknowledged
+  SfnSf lastTx (0, 9, 0, 0);
+  harq->RecordNrSlTx (dstL2Id, harqId, lastTx, 0, psfchSlot + 120);
+  for (uint16_t rxRnti = 1; rxRnti <= 3; ++rxRnti)
+    {
+      harq->StoreNrSlHarqFeedback (createFeedback (lastTx, rxRnti));
+    }
+  NS_TEST_ASSERT_MSG_EQ (harq->IsNrSlTbAcked (dstL2Id, harqId), false,
+                         "A TB to a group of unknown size should not be acknowledged");
+}
+
+class NrSlPsfchTestSuite : public TestSuite
+{
+public:
+  NrSlPsfchTestSuite () : TestSuite ("nr-test-sl-psfch", UNIT)
+  {
+    AddTestCase (new NrSlPsfchConfigTestCase (), QUICK);
+    AddTestCase (new NrSlHarqFeedbackTestCase (), QUICK);
+    AddTestCase (new NrSlGroupcastHarqFeedbackTestCase (), QUICK);
+  }
+};
+
+static NrSlPsfchTestSuite nrSlPsfchTestSuite; //!< NR SL PSFCH test suite
+
+}  // namespace ns3
@@ -0,0 +1,133 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-slot-ring.h>
+#include <ns3/sfnsf.h>
+
+#include <map>
+#include <vector>
+
+/**
+ * \file nr-test-slot-ring.cc
+ * \ingroup test
+ *
+ * \brief Check that NrSlotRing stores the slots as a map would, also when
+ * the slots stored do not fit the capacity reserved, and that the order of
+ * the slots is the order of SfnSf.
+ */
+namespace ns3 {
+
+class NrSlotRingTestCase : public TestCase
+{
+public:
+  NrSlotRingTestCase () : TestCase ("Slot ring compared with a map")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+};
+
+void
+NrSlotRingTestCase::DoRun ()
+{
+  NrSlotRing<uint32_t> ring;
+  uint32_t value = 0;
+
+  NS_TEST_ASSERT_MSG_EQ (ring.IsEmpty (), true, "A new ring should be empty");
+  NS_TEST_ASSERT_MSG_EQ ((ring.Find (0) == nullptr), true, "A new ring has no slots");
+  NS_TEST_ASSERT_MSG_EQ (ring.Pop (0, value), false, "A new ring has no slots");
+
+  ring.Reserve (5);
+  NS_TEST_ASSERT_MSG_EQ (ring.GetCapacity (), static_cast<size_t> (8), "The capacity should be the next power of two");
+
+  // Window of 5 slots, sliding one slot at a time: the capacity does not change
+  std::map<uint64_t, uint32_t> reference;
+  for (uint64_t slot = 0; slot < 100; ++slot)
+    {
+      ring.Insert (slot + 4, static_cast<uint32_t> (slot));
+      reference[slot + 4] = static_cast<uint32_t> (slot);
+      if (ring.Pop (slot, value))
+        {
+          NS_TEST_ASSERT_MSG_EQ (value, reference.at (slot), "Wrong value of slot " << slot);
+          reference.erase (slot);
+        }
+      NS_TEST_ASSERT_MSG_EQ (ring.GetSize (), reference.size (), "Wrong size at slot " << slot);
+    }
+  NS_TEST_ASSERT_MSG_EQ (ring.GetCapacity (), static_cast<size_t> (8), "The window should fit the capacity reserved");
+  NS_TEST_ASSERT_MSG_EQ (ring.GetFirstSlot (), reference.begin ()->first, "Wrong first slot");
+
+  // Slots that collide in the ring: the capacity grows, and nothing is lost
+  for (uint64_t slot : {200, 208, 216, 1024, 1032})
+    {
+      ring.Insert (slot, static_cast<uint32_t> (slot * 2));
+      reference[slot] = static_cast<uint32_t> (slot * 2);
+    }
+  NS_TEST_ASSERT_MSG_EQ ((ring.GetCapacity () > 8), true, "The capacity should grow with the collisions");
+  for (const auto & v : reference)
+    {
+      NS_TEST_ASSERT_MSG_EQ ((ring.Find (v.first) != nullptr), true, "Slot " << v.first << " lost");
+      NS_TEST_ASSERT_MSG_EQ (*ring.Find (v.first), v.second, "Wrong value of slot " << v.first);
+    }
+  NS_TEST_ASSERT_MSG_EQ ((ring.Find (201) == nullptr), true, "Slot 201 was never stored");
+
+  std::vector<uint64_t> visited;
+  ring.ForEachInOrder ([&visited] (uint64_t slot, uint32_t &) { visited.push_back (slot); });
+  NS_TEST_ASSERT_MSG_EQ (visited.size (), reference.size (), "Wrong number of slots visited");
+  auto it = reference.begin ();
+  for (uint32_t i = 0; i < visited.size (); ++i, ++it)
+    {
+      NS_TEST_ASSERT_MSG_EQ (visited.at (i), it->first, "Slots not visited in order");
+    }
+
+  ring.Clear ();
+  NS_TEST_ASSERT_MSG_EQ (ring.IsEmpty (), true, "The ring should be empty after Clear");
+  NS_TEST_ASSERT_MSG_EQ ((ring.Find (200) == nullptr), true, "The ring should be empty after Clear");
+
+  // The order of the normalized slots is the order of SfnSf, across frames
+  SfnSf sfn (1023, 9, 0, 1);
+  std::vector<SfnSf> slots;
+  for (uint32_t i = 0; i < 6; ++i)
+    {
+      slots.push_back (sfn);
+      sfn.Add (1);
+    }
+  for (auto s = slots.rbegin (); s != slots.rend (); ++s)
+    {
+      ring.Insert (s->Normalize (), 0);
+    }
+  visited.clear ();
+  ring.ForEachInOrder ([&visited] (uint64_t slot, uint32_t &) { visited.push_back (slot); });
+  for (uint32_t i = 0; i < slots.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (visited.at (i), slots.at (i).Normalize (), "Slots not visited in SfnSf order");
+    }
+}
+
+class NrSlotRingTestSuite : public TestSuite
+{
+public:
+  NrSlotRingTestSuite () : TestSuite ("nr-test-slot-ring", UNIT)
+  {
+    AddTestCase (new NrSlotRingTestCase, TestCase::QUICK);
+  }
+};
+
+static NrSlotRingTestSuite nrSlotRingTestSuite; //!< Slot ring test suite
+
+} // namespace ns3
@@ -0,0 +1,143 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-spatial-index.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/double.h>
+#include <limits>
+
+/**
+ * \file nr-test-spatial-index.cc
+ * \ingroup test
+ *
+ * \brief Check that the spatial index used to attach the UEs to the closest
+ * gNB returns the same gNB as a linear scan, for random, aligned and
+ * overlapping gNB positions, with UEs inside and outside the gNB area, and
+ * with any number of threads.
+ */
+namespace ns3 {
+
+class NrSpatialIndexTestCase : public TestCase
+{
+public:
+  /**
+   * \brief Layout of the indexed points
+   */
+  enum Layout
+  {
+    RANDOM,      //!< Random positions in a square
+    ALIGNED,     //!< Random positions along a line
+    OVERLAPPING  //!< Random positions, with many duplicates
+  };
+
+  NrSpatialIndexTestCase (const std::string &name, Layout layout, uint32_t numPoints)
+    : TestCase (name),
+      m_layout (layout),
+      m_numPoints (numPoints)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  static uint32_t LinearScan (const std::vector<Vector> &points, const Vector &position);
+
+  Layout m_layout;      //!< Layout of the indexed points
+  uint32_t m_numPoints; //!< Number of indexed points
+};
+
+uint32_t
+NrSpatialIndexTestCase::LinearScan (const std::vector<Vector> &points, const Vector &position)
+{
+  uint32_t closest = 0;
+  double minDistance = std::numeric_limits<double>::infinity ();
+  for (uint32_t i = 0; i < points.size (); ++i)
+    {
+      double distance = CalculateDistance (position, points[i]);
+      if (distance < minDistance)
+        {
+          minDistance = distance;
+          closest = i;
+        }
+    }
+  return closest;
+}
+
+void
+NrSpatialIndexTestCase::DoRun ()
+{
+  Ptr<UniformRandomVariable> uniform = CreateObject<UniformRandomVariable> ();
+  uniform->SetStream (1);
+  uniform->SetAttribute ("Min", DoubleValue (-1000.0));
+  uniform->SetAttribute ("Max", DoubleValue (1000.0));
+
+  std::vector<Vector> points;
+  for (uint32_t i = 0; i < m_numPoints; ++i)
+    {
+      if (m_layout == OVERLAPPING && i % 2 == 1)
+        {
+          points.push_back (points.back ());
+        }
+      else if (m_layout == ALIGNED)
+        {
+          points.push_back (Vector (uniform->GetValue (), 20.0, 25.0));
+        }
+      else
+        {
+          points.push_back (Vector (uniform->GetValue (), uniform->GetValue (), 25.0));
+        }
+    }
+
+  // Queries cover an area larger than the indexed one
+  std::vector<Vector> positions;
+  for (uint32_t i = 0; i < 5000; ++i)
+    {
+      positions.push_back (Vector (1.5 * uniform->GetValue (), 1.5 * uniform->GetValue (), 1.5));
+    }
+
+  NrSpatialIndex index (points);
+  for (const auto &position : positions)
+    {
+      NS_TEST_ASSERT_MSG_EQ (index.FindClosest (position), LinearScan (points, position),
+                             "The index and the linear scan disagree on the closest point");
+    }
+
+  std::vector<uint32_t> single = index.FindClosest (positions, 1);
+  std::vector<uint32_t> multi = index.FindClosest (positions, 4);
+  NS_TEST_ASSERT_MSG_EQ (single.size (), positions.size (), "Wrong number of results");
+  for (uint32_t i = 0; i < positions.size (); ++i)
+    {
+      NS_TEST_ASSERT_MSG_EQ (single.at (i), multi.at (i),
+                             "The result should not depend on the number of threads");
+    }
+}
+
+class NrSpatialIndexTestSuite : public TestSuite
+{
+public:
+  NrSpatialIndexTestSuite () : TestSuite ("nr-test-spatial-index", UNIT)
+  {
+    AddTestCase (new NrSpatialIndexTestCase ("Single point", NrSpatialIndexTestCase::RANDOM, 1), QUICK);
+    AddTestCase (new NrSpatialIndexTestCase ("Random points", NrSpatialIndexTestCase::RANDOM, 300), QUICK);
+    AddTestCase (new NrSpatialIndexTestCase ("Aligned points", NrSpatialIndexTestCase::ALIGNED, 50), QUICK);
+    AddTestCase (new NrSpatialIndexTestCase ("Overlapping points", NrSpatialIndexTestCase::OVERLAPPING, 100), QUICK);
+  }
+};
+
+static NrSpatialIndexTestSuite nrSpatialIndexTestSuite; //!< Spatial index test suite
+
+}  // namespace ns3
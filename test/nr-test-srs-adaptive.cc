@@ -0,0 +1,214 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/uinteger.h>
+#include <ns3/nr-mac-scheduler-srs-adaptive.h>
+
+/**
+ * \file nr-test-srs-adaptive.cc
+ * \ingroup test
+ *
+ * \brief Check that NrMacSchedulerSrsAdaptive adapts the SRS periodicity of
+ * each UE to its channel and speed, and that two UEs never send the SRS in the
+ * same slot.
+ */
+namespace ns3 {
+
+class NrSrsAdaptiveTestCase : public TestCase
+{
+public:
+  NrSrsAdaptiveTestCase () : TestCase ("Periodicity and offsets of NrMacSchedulerSrsAdaptive")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  typedef std::unordered_map<uint16_t, std::shared_ptr<NrMacSchedulerUeInfo> > UeMap; //!< UE map of the scheduler
+
+  /**
+   * \brief Add a UE to the map and to the SRS algorithm
+   * \param srs the SRS algorithm
+   * \param ueMap the UE map
+   * \param rnti the RNTI of the UE
+   * \return the UE
+   */
+  std::shared_ptr<NrMacSchedulerUeInfo> AddUe (const Ptr<NrMacSchedulerSrsAdaptive> &srs, UeMap *ueMap,
+                                               uint16_t rnti);
+  /**
+   * \brief Check that at most one UE sends the SRS in each slot
+   * \param ueMap the UE map
+   * \param maxPeriodicity the longest periodicity
+   */
+  void CheckNoCollision (const UeMap &ueMap, uint32_t maxPeriodicity);
+};
+
+std::shared_ptr<NrMacSchedulerUeInfo>
+NrSrsAdaptiveTestCase::AddUe (const Ptr<NrMacSchedulerSrsAdaptive> &srs, UeMap *ueMap, uint16_t rnti)
+{
+  auto ue = std::make_shared<NrMacSchedulerUeInfo> (rnti, BeamConfId (), [] () { return 1; });
+  ueMap->emplace (rnti, ue);
+  NrMacSchedulerSrs::SrsPeriodicityAndOffset ret = srs->AddUe ();
+  if (ret.m_isValid)
+    {
+      ue->m_srsPeriodicity = ret.m_periodicity;
+      ue->m_srsOffset = ret.m_offset;
+    }
+  else
+    {
+      bool increased = srs->IncreasePeriodicity (ueMap);
+      NS_TEST_EXPECT_MSG_EQ (increased, true, "The periodicity should be increased for RNTI " << rnti);
+    }
+  return ue;
+}
+
+void
+NrSrsAdaptiveTestCase::CheckNoCollision (const UeMap &ueMap, uint32_t maxPeriodicity)
+{
+  for (uint32_t slot = 0; slot < maxPeriodicity; ++slot)
+    {
+      uint32_t numUes = 0;
+      for (const auto &ue : ueMap)
+        {
+          NS_TEST_ASSERT_MSG_NE (ue.second->m_srsPeriodicity, 0, "RNTI " << ue.first << " without SRS");
+          if (slot % ue.second->m_srsPeriodicity == ue.second->m_srsOffset)
+            {
+              numUes++;
+            }
+        }
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (numUes, 1, "More than one UE sends the SRS in slot " << slot);
+    }
+}
+
+void
+NrSrsAdaptiveTestCase::DoRun ()
+{
+  const Time slotPeriod = MicroSeconds (250);
+
+  // Default chain: 10, 20, 40, 80, 160, 320
+  Ptr<NrMacSchedulerSrsAdaptive> srs = CreateObject<NrMacSchedulerSrsAdaptive> ();
+  UeMap ueMap;
+  for (uint16_t rnti = 1; rnti <= 20; ++rnti)
+    {
+      auto ue = AddUe (srs, &ueMap, rnti);
+      NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, 80, "New UEs should start with periodicity 80");
+    }
+  NS_TEST_ASSERT_MSG_EQ (srs->GetPeriodicities ().size (), 6, "Wrong chain of periodicities");
+  CheckNoCollision (ueMap, 320);
+
+  // Nothing changes before MinReports SRS
+  auto ue = ueMap.at (1);
+  ue->m_srsReports = 3;
+  ue->m_srsSinrVar = 0.0;
+  NS_TEST_ASSERT_MSG_EQ (srs->SrsReported (ue, -1.0, slotPeriod, 1.0), false, "Too few SRS to decide");
+
+  // A stable channel doubles the periodicity, up to the longest one
+  for (uint32_t expected : {160, 320, 320})
+    {
+      ue->m_srsReports = 4;
+      srs->SrsReported (ue, -1.0, slotPeriod, 1.0);
+      NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, expected, "A static UE should sound less often");
+    }
+
+  // A varying channel halves it
+  ue = ueMap.at (2);
+  ue->m_srsSinrVar = 16.0;
+  ue->m_srsReports = 4;
+  NS_TEST_ASSERT_MSG_EQ (srs->SrsReported (ue, -1.0, slotPeriod, 1.0), true, "The periodicity should change");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, 40, "A varying channel should be sounded more often");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsReports, 0, "The SRS count should restart");
+
+  // Between the thresholds, only the speed matters: at 60 m/s, the UE
+  // travels 1 m in 66 slots of 0.25 ms
+  ue = ueMap.at (3);
+  ue->m_srsSinrVar = 4.0;
+  ue->m_srsReports = 4;
+  NS_TEST_ASSERT_MSG_EQ (srs->SrsReported (ue, -1.0, slotPeriod, 1.0), false, "The periodicity should not change");
+  srs->SrsReported (ue, 60.0, slotPeriod, 1.0);
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, 40, "A fast UE should be sounded more often");
+  ue->m_srsSinrVar = 0.0;
+  ue->m_srsReports = 4;
+  srs->SrsReported (ue, 60.0, slotPeriod, 1.0);
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, 40, "The speed should cap the periodicity");
+
+  // With half of the slots able to carry the SRS, the UE travels 1 m in 33
+  // periods of the SRS
+  ue->m_srsReports = 4;
+  NS_TEST_ASSERT_MSG_EQ (srs->SrsReported (ue, 60.0, slotPeriod, 0.5), true, "The periodicity should change");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, 20, "The cap should count only the SRS slots");
+
+  // Make every UE as frequent as possible, then check the offsets
+  for (auto &it : ueMap)
+    {
+      for (uint32_t i = 0; i < 5; ++i)
+        {
+          it.second->m_srsSinrVar = 16.0;
+          it.second->m_srsReports = 4;
+          srs->SrsReported (it.second, -1.0, slotPeriod, 1.0);
+        }
+    }
+  CheckNoCollision (ueMap, 320);
+
+  // Removing all the UEs merges back the offsets
+  for (const auto &it : ueMap)
+    {
+      srs->RemoveUe (it.second->m_srsOffset, it.second->m_srsPeriodicity);
+    }
+  NS_TEST_ASSERT_MSG_EQ (srs->GetNumFreeOffsets (10), 10, "All the offsets should be merged back");
+  NS_TEST_ASSERT_MSG_EQ (srs->GetNumFreeOffsets (320), 0, "All the offsets should be merged back");
+
+  // When full, the periodicity of the most frequent UE is increased
+  srs = CreateObject<NrMacSchedulerSrsAdaptive> ();
+  srs->SetAttribute ("MaxPeriodicity", UintegerValue (20));
+  srs->SetAttribute ("StartingPeriodicity", UintegerValue (10));
+  ueMap.clear ();
+  for (uint16_t rnti = 1; rnti <= 15; ++rnti)
+    {
+      AddUe (srs, &ueMap, rnti);
+    }
+  CheckNoCollision (ueMap, 20);
+  NS_TEST_ASSERT_MSG_EQ (ueMap.at (1)->m_srsPeriodicity, 20, "The lowest RNTI should be increased first");
+  NS_TEST_ASSERT_MSG_EQ (ueMap.at (15)->m_srsPeriodicity, 20, "The last UE should get the longest periodicity");
+  NS_TEST_ASSERT_MSG_EQ (srs->GetNumFreeOffsets (20), 0, "All the offsets should be taken");
+
+  // A UE that cannot be sounded more often keeps its slots
+  ue = ueMap.at (15);
+  uint32_t offset = ue->m_srsOffset;
+  ue->m_srsSinrVar = 16.0;
+  ue->m_srsReports = 4;
+  NS_TEST_ASSERT_MSG_EQ (srs->SrsReported (ue, -1.0, slotPeriod, 1.0), false, "There is no room to move");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsPeriodicity, 20, "The periodicity should not change");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsOffset, offset, "The offset should not change");
+  NS_TEST_ASSERT_MSG_EQ (ue->m_srsReports, 4, "The SRS count should not restart");
+  NS_TEST_ASSERT_MSG_EQ (srs->GetNumFreeOffsets (20), 0, "The offset should be taken back");
+  NS_TEST_ASSERT_MSG_EQ (srs->GetNumFreeOffsets (10), 0, "The offset should be taken back");
+  CheckNoCollision (ueMap, 20);
+}
+
+class NrSrsAdaptiveTestSuite : public TestSuite
+{
+public:
+  NrSrsAdaptiveTestSuite () : TestSuite ("nr-test-srs-adaptive", UNIT)
+  {
+    AddTestCase (new NrSrsAdaptiveTestCase, TestCase::QUICK);
+  }
+};
+
+static NrSrsAdaptiveTestSuite nrSrsAdaptiveTestSuite; //!< NR adaptive SRS test suite
+
+} // namespace ns3
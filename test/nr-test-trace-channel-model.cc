@@ -0,0 +1,166 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/nr-trace-channel-model.h>
+#include <ns3/node.h>
+#include <ns3/constant-position-mobility-model.h>
+#include <ns3/uniform-planar-array.h>
+#include <ns3/string.h>
+#include <ns3/boolean.h>
+#include <ns3/uinteger.h>
+#include <ns3/simulator.h>
+#include <cmath>
+
+/**
+ * \file nr-test-trace-channel-model.cc
+ * \ingroup test
+ *
+ * \brief Unit-testing for the trace-driven channel model. The test converts
+ * the bundled ray-tracing trace into the binary format, and checks the
+ * snapshots read back from the memory-mapped file, the conversion over a
+ * mapped file, the interpolation between two snapshots, and the size and
+ * power of the channel matrix.
+ */
+namespace ns3 {
+
+class NrTraceChannelModelTestCase : public TestCase
+{
+public:
+  NrTraceChannelModelTestCase (const std::string &name)
+    : TestCase (name)
+  {}
+
+private:
+  virtual void DoRun (void) override;
+  void CheckChannel (Ptr<NrTraceChannelModel> model);
+};
+
+void
+NrTraceChannelModelTestCase::DoRun ()
+{
+  std::string traceFile = std::string (NS_TEST_SOURCEDIR) + "/../model/Raytracing/Quadriga1.txt";
+  std::string binaryFile = CreateTempDirFilename ("quadriga1.bin");
+
+  uint32_t converted = NrTraceChannelModel::ConvertTrace (traceFile, binaryFile);
+  NS_TEST_ASSERT_MSG_EQ (converted, 1501, "Wrong number of converted snapshots");
+
+  Ptr<NrTraceChannelModel> model = CreateObject<NrTraceChannelModel> ();
+  model->SetAttribute ("TraceFile", StringValue (traceFile));
+  model->SetAttribute ("BinaryFile", StringValue (binaryFile));
+  model->SetAttribute ("SnapshotPeriod", TimeValue (MilliSeconds (1)));
+
+  NS_TEST_ASSERT_MSG_EQ (model->GetNumSnapshots (), 1501, "Wrong number of mapped snapshots");
+
+  std::vector<NrTraceChannelModel::TracePath> snapshot = model->GetSnapshot (1);
+  NS_TEST_ASSERT_MSG_EQ (snapshot.size (), 5, "Wrong number of paths");
+  NS_TEST_ASSERT_MSG_EQ_TOL (snapshot.at (1).m_delay, 794.736e-9, 1e-12, "Wrong delay");
+  NS_TEST_ASSERT_MSG_EQ_TOL (10 * std::log10 (snapshot.at (1).m_powerLinear), -108.044, 1e-3, "Wrong power");
+  NS_TEST_ASSERT_MSG_EQ_TOL (snapshot.at (3).m_aodAzimuth, -44.9999, 1e-3, "Wrong azimuth of departure");
+  NS_TEST_ASSERT_MSG_EQ_TOL (snapshot.at (4).m_aoaAzimuth, -101.902, 1e-3, "Wrong azimuth of arrival");
+
+  // Snapshots wrap around the end of the trace
+  NS_TEST_ASSERT_MSG_EQ_TOL (model->GetSnapshot (1502).at (1).m_delay, 794.736e-9, 1e-12, "Wrong wrap around");
+
+  // Half-way between snapshot 0 and 1
+  std::vector<NrTraceChannelModel::TracePath> first = model->GetSnapshot (0);
+  std::vector<NrTraceChannelModel::TracePath> half = model->GetPathsAt (MicroSeconds (500));
+  NS_TEST_ASSERT_MSG_EQ (half.size (), 5, "Wrong number of interpolated paths");
+  for (uint32_t p = 0; p < half.size (); ++p)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (half.at (p).m_delay, (first.at (p).m_delay + snapshot.at (p).m_delay) / 2, 1e-12,
+                                 "Wrong interpolated delay");
+      NS_TEST_ASSERT_MSG_EQ_TOL (half.at (p).m_powerLinear, (first.at (p).m_powerLinear + snapshot.at (p).m_powerLinear) / 2,
+                                 1e-16, "Wrong interpolated power");
+      // The phase moves along the shortest arc, also across +-pi
+      double arc = std::abs (std::remainder (snapshot.at (p).m_phase - first.at (p).m_phase, 2 * M_PI));
+      NS_TEST_ASSERT_MSG_LT_OR_EQ (std::abs (std::remainder (half.at (p).m_phase - first.at (p).m_phase, 2 * M_PI)),
+                                   arc / 2 + 1e-9, "Wrong interpolated phase");
+    }
+
+  // Converting again while the trace is mapped replaces the file, and
+  // leaves the mapped one untouched
+  NS_TEST_ASSERT_MSG_EQ (NrTraceChannelModel::ConvertTrace (traceFile, binaryFile), 1501,
+                         "Wrong number of snapshots converted again");
+  NS_TEST_ASSERT_MSG_EQ_TOL (model->GetSnapshot (1).at (1).m_delay, 794.736e-9, 1e-12,
+                             "The mapped trace should still be readable");
+
+  model->SetAttribute ("Interpolate", BooleanValue (false));
+  NS_TEST_ASSERT_MSG_EQ_TOL (model->GetPathsAt (MicroSeconds (500)).at (0).m_delay, first.at (0).m_delay, 1e-12,
+                             "Without interpolation, the first snapshot should be used");
+
+  model->SetAttribute ("Interpolate", BooleanValue (true));
+  CheckChannel (model);
+}
+
+void
+NrTraceChannelModelTestCase::CheckChannel (Ptr<NrTraceChannelModel> model)
+{
+  Ptr<Node> txNode = CreateObject<Node> ();
+  Ptr<Node> rxNode = CreateObject<Node> ();
+  Ptr<ConstantPositionMobilityModel> txMob = CreateObject<ConstantPositionMobilityModel> ();
+  Ptr<ConstantPositionMobilityModel> rxMob = CreateObject<ConstantPositionMobilityModel> ();
+  txMob->SetPosition (Vector (0, 0, 10));
+  rxMob->SetPosition (Vector (100, 0, 1.5));
+  txNode->AggregateObject (txMob);
+  rxNode->AggregateObject (rxMob);
+
+  Ptr<UniformPlanarArray> txAntenna = CreateObject<UniformPlanarArray> ();
+  txAntenna->SetAttribute ("NumColumns", UintegerValue (4));
+  txAntenna->SetAttribute ("NumRows", UintegerValue (2));
+  Ptr<UniformPlanarArray> rxAntenna = CreateObject<UniformPlanarArray> ();
+  rxAntenna->SetAttribute ("NumColumns", UintegerValue (2));
+  rxAntenna->SetAttribute ("NumRows", UintegerValue (1));
+
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> channel = model->GetChannel (txMob, rxMob, txAntenna, rxAntenna);
+
+  NS_TEST_ASSERT_MSG_EQ (channel->m_channel.size (), 2, "Wrong number of u-node elements");
+  NS_TEST_ASSERT_MSG_EQ (channel->m_channel.at (0).size (), 8, "Wrong number of s-node elements");
+  NS_TEST_ASSERT_MSG_EQ (channel->m_channel.at (0).at (0).size (), 5, "Wrong number of paths");
+  NS_TEST_ASSERT_MSG_EQ (channel->m_delay.size (), 5, "Wrong number of delays");
+  NS_TEST_ASSERT_MSG_EQ (channel->m_angle.size (), 4, "Wrong number of angle directions");
+
+  // Isotropic elements and normalized power: each element pair has unitary power
+  double power = 0.0;
+  for (const auto & h : channel->m_channel.at (1).at (5))
+    {
+      power += std::norm (h);
+    }
+  NS_TEST_ASSERT_MSG_EQ_TOL (power, 1.0, 1e-6, "The channel power should be normalized");
+
+  // Same link, any direction: the cached matrix is returned
+  Ptr<const MatrixBasedChannelModel::ChannelMatrix> reverse = model->GetChannel (rxMob, txMob, rxAntenna, txAntenna);
+  NS_TEST_ASSERT_MSG_EQ (reverse, channel, "The channel of the link should be cached");
+  NS_TEST_ASSERT_MSG_EQ (reverse->IsReverse (rxAntenna->GetId (), txAntenna->GetId ()), true,
+                         "The channel should be seen as reverse");
+
+  Simulator::Destroy ();
+}
+
+class NrTraceChannelModelTestSuite : public TestSuite
+{
+public:
+  NrTraceChannelModelTestSuite () : TestSuite ("nr-test-trace-channel-model", UNIT)
+  {
+    AddTestCase (new NrTraceChannelModelTestCase ("Trace channel model with Quadriga1"), QUICK);
+  }
+};
+
+static NrTraceChannelModelTestSuite nrTraceChannelModelTestSuite; //!< Trace channel model test suite
+
+}  // namespace ns3
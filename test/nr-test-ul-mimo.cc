@@ -0,0 +1,356 @@
+/* -*-  Mode: C++; c-file-style: "gnu"; indent-tabs-mode:nil; -*- */
+/*
+ *   Copyright (c) 2022 Centre Tecnologic de Telecomunicacions de Catalunya (CTTC)
+ *
+ *   This program is free software; you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License version 2 as
+ *   published by the Free Software Foundation;
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program; if not, write to the Free Software
+ *   Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+#include <ns3/test.h>
+#include <ns3/simulator.h>
+#include <ns3/nr-module.h>
+#include <ns3/internet-module.h>
+#include <ns3/applications-module.h>
+#include <ns3/point-to-point-helper.h>
+#include <ns3/mobility-module.h>
+#include <ns3/antenna-module.h>
+
+#include <cmath>
+#include <map>
+#include <tuple>
+#include <vector>
+
+/**
+ * \file nr-test-ul-mimo.cc
+ * \ingroup test
+ *
+ * \brief UL MIMO with rank 2: one UE with two streams sends UL traffic to a
+ * gNB with two streams. The scheduler (UlSrsReported) should select rank 2,
+ * the UE MAC (ProcessUlDci) should fill a TB per stream, the gNB PHY
+ * (ReportUlHarqFeedback) should merge the per-stream feedback, and the
+ * HARQ scheduler (ScheduleUlHarq) should retransmit only the NACKed streams.
+ */
+namespace ns3 {
+
+/**
+ * \ingroup test
+ * \brief Run a UL rank-2 scenario and check, stream by stream, the UL DCIs
+ * against the receptions at the gNB
+ */
+class NrUlMimoTestCase : public TestCase
+{
+public:
+  NrUlMimoTestCase () : TestCase ("UL rank 2: independent scheduling, feedback and retransmission per stream")
+  {}
+
+private:
+  virtual void DoRun (void) override;
+
+  /// Frame, subframe, slot, starting symbol, RNTI and stream of a UL TB
+  typedef std::tuple<uint32_t, uint8_t, uint16_t, uint8_t, uint16_t, uint8_t> TbKey;
+
+  /**
+   * \brief UL TB as granted by the scheduler
+   */
+  struct UlGrant
+  {
+    uint8_t m_harqId {UINT8_MAX}; //!< HARQ process
+    uint8_t m_ndi {UINT8_MAX};    //!< NDI of the stream
+    uint8_t m_rv {UINT8_MAX};     //!< RV of the stream
+    uint32_t m_tbSize {0};        //!< TB size of the stream
+  };
+
+  /**
+   * \brief UL DCI of a HARQ process, with the grant and reception of each stream
+   */
+  struct UlDci
+  {
+    std::vector<UlGrant> m_grants;   //!< Grant per stream
+    std::vector<int> m_rxCorrupt;    //!< Reception per stream: -1 not received, 0 ok, 1 corrupted
+  };
+
+  /**
+   * \brief Store the UL DCI of a stream
+   * \param info the UL scheduling info of the stream
+   */
+  void UlScheduling (NrSchedulingCallbackInfo info);
+  /**
+   * \brief Store the outcome of the reception of a stream
+   * \param params the reception parameters
+   */
+  void RxPacketTraceEnb (RxPacketTraceParams params);
+
+  std::map<TbKey, std::pair<uint8_t, std::size_t>> m_tbToDci; //!< TB to (HARQ process, DCI index)
+  std::map<std::pair<uint16_t, uint8_t>, std::vector<UlDci>> m_dcis; //!< DCIs in time order, per (RNTI, HARQ process)
+};
+
+void
+NrUlMimoTestCase::UlScheduling (NrSchedulingCallbackInfo info)
+{
+  // The trace is fired once per stream, stream 0 first
+  auto process = std::make_pair (info.m_rnti, info.m_harqId);
+  auto & dcis = m_dcis[process];
+  if (info.m_streamId == 0)
+    {
+      dcis.emplace_back ();
+    }
+  NS_ASSERT (! dcis.empty ());
+  UlDci & dci = dcis.back ();
+  if (dci.m_grants.size () <= info.m_streamId)
+    {
+      dci.m_grants.resize (info.m_streamId + 1);
+      dci.m_rxCorrupt.resize (info.m_streamId + 1, -1);
+    }
+  dci.m_grants.at (info.m_streamId) = {info.m_harqId, info.m_ndi, info.m_rv, info.m_tbSize};
+
+  if (info.m_tbSize > 0)
+    {
+      TbKey key (info.m_frameNum, info.m_subframeNum, info.m_slotNum, info.m_symStart,
+                 info.m_rnti, info.m_streamId);
+      m_tbToDci[key] = std::make_pair (info.m_harqId, dcis.size () - 1);
+    }
+}
+
+void
+NrUlMimoTestCase::RxPacketTraceEnb (RxPacketTraceParams params)
+{
+  TbKey key (params.m_frameNum, params.m_subframeNum, params.m_slotNum, params.m_symStart,
+             params.m_rnti, params.m_streamId);
+  auto it = m_tbToDci.find (key);
+  NS_TEST_ASSERT_MSG_EQ ((it != m_tbToDci.end ()), true,
+                         "Received a TB of stream " << +params.m_streamId << " that was not scheduled");
+  UlDci & dci = m_dcis.at (std::make_pair (params.m_rnti, it->second.first)).at (it->second.second);
+  NS_TEST_ASSERT_MSG_EQ (dci.m_grants.at (params.m_streamId).m_rv, params.m_rv,
+                         "The RV of the reception does not match the UL DCI");
+  dci.m_rxCorrupt.at (params.m_streamId) = params.m_corrupt ? 1 : 0;
+}
+
+void
+NrUlMimoTestCase::DoRun ()
+{
+  Config::SetDefault ("ns3::LteRlcUm::MaxTxBufferSize", UintegerValue (999999999));
+  Config::SetDefault ("ns3::EpsBearer::Release", UintegerValue (15));
+  // Maximum power and a fixed high MCS, so that some TBs get corrupted
+  Config::SetDefault ("ns3::NrUePhy::EnableUplinkPowerControl", BooleanValue (false));
+  Config::SetDefault ("ns3::NrAmc::ErrorModelType", TypeIdValue (NrEesmCcT1::GetTypeId ()));
+  Config::SetDefault ("ns3::ThreeGppChannelModel::UpdatePeriod", TimeValue (MilliSeconds (0)));
+
+  NodeContainer gnbNodes;
+  NodeContainer ueNodes;
+  gnbNodes.Create (1);
+  ueNodes.Create (1);
+
+  Ptr<ListPositionAllocator> positionAlloc = CreateObject<ListPositionAllocator> ();
+  positionAlloc->Add (Vector (0.0, 0.0, 10.0));
+  positionAlloc->Add (Vector (0.0, 60.0, 1.5));
+  MobilityHelper mobility;
+  mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+  mobility.SetPositionAllocator (positionAlloc);
+  mobility.Install (gnbNodes);
+  mobility.Install (ueNodes);
+
+  Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper> ();
+  Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject<IdealBeamformingHelper> ();
+  idealBeamformingHelper->SetAttribute ("BeamformingMethod", TypeIdValue (CellScanBeamforming::GetTypeId ()));
+  idealBeamformingHelper->SetBeamformingAlgorithmAttribute ("BeamSearchAngleStep", DoubleValue (10.0));
+
+  Ptr<NrHelper> nrHelper = CreateObject<NrHelper> ();
+  nrHelper->SetBeamformingHelper (idealBeamformingHelper);
+  nrHelper->SetEpcHelper (epcHelper);
+
+  nrHelper->SetUeAntennaAttribute ("NumRows", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("NumColumns", UintegerValue (2));
+  nrHelper->SetUeAntennaAttribute ("AntennaElement", PointerValue (CreateObject<IsotropicAntennaModel> ()));
+  nrHelper->SetGnbAntennaAttribute ("NumRows", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("NumColumns", UintegerValue (4));
+  nrHelper->SetGnbAntennaAttribute ("AntennaElement", PointerValue (CreateObject<ThreeGppAntennaModel> ()));
+
+  nrHelper->SetUePhyAttribute ("TxPower", DoubleValue (23.0));
+  nrHelper->SetGnbPhyAttribute ("TxPower", DoubleValue (30.0));
+  nrHelper->SetGnbPhyAttribute ("Numerology", UintegerValue (1));
+
+  // Rank 2 whenever both streams are above -100 dB, i.e., always
+  nrHelper->SetSchedulerTypeId (NrMacSchedulerTdmaRR::GetTypeId ());
+  nrHelper->SetSchedulerAttribute ("UlMaxRank", UintegerValue (2));
+  nrHelper->SetSchedulerAttribute ("UlRankSinrThreshold", DoubleValue (-100.0));
+  nrHelper->SetSchedulerAttribute ("FixedMcsUl", BooleanValue (true));
+  nrHelper->SetSchedulerAttribute ("StartingMcsUl", UintegerValue (28));
+  nrHelper->SetSchedulerAttribute ("EnableHarqReTx", BooleanValue (true));
+  nrHelper->SetUeMacAttribute ("UlMaxRank", UintegerValue (2));
+
+  CcBwpCreator ccBwpCreator;
+  CcBwpCreator::SimpleOperationBandConf bandConf (28e9, 20e6, 1, BandwidthPartInfo::UMi_StreetCanyon_LoS);
+  OperationBandInfo band = ccBwpCreator.CreateOperationBandContiguousCc (bandConf);
+  nrHelper->SetPathlossAttribute ("ShadowingEnabled", BooleanValue (false));
+  nrHelper->InitializeOperationBand (&band);
+  BandwidthPartInfoPtrVector allBwps = CcBwpCreator::GetAllBwps ({band});
+
+  // Two streams at both sides, one per sub-array polarization
+  NetDeviceContainer gnbNetDevs = nrHelper->InstallGnbDevice (gnbNodes, allBwps, 2);
+  NetDeviceContainer ueNetDevs = nrHelper->InstallUeDevice (ueNodes, allBwps, 2);
+
+  int64_t randomStream = 1;
+  randomStream += nrHelper->AssignStreams (gnbNetDevs, randomStream);
+  randomStream += nrHelper->AssignStreams (ueNetDevs, randomStream);
+
+  ObjectVectorValue gnbSpectrumPhys;
+  nrHelper->GetGnbPhy (gnbNetDevs.Get (0), 0)->GetAttribute ("NrSpectrumPhyList", gnbSpectrumPhys);
+  ObjectVectorValue ueSpectrumPhys;
+  nrHelper->GetUePhy (ueNetDevs.Get (0), 0)->GetAttribute ("NrSpectrumPhyList", ueSpectrumPhys);
+  NS_TEST_ASSERT_MSG_EQ (gnbSpectrumPhys.GetN (), 2, "The gNB should have two streams");
+  NS_TEST_ASSERT_MSG_EQ (ueSpectrumPhys.GetN (), 2, "The UE should have two streams");
+  for (uint32_t i = 0; i < 2; ++i)
+    {
+      DoubleValue polSlantAngle (i == 0 ? 0.0 : M_PI / 2);
+      gnbSpectrumPhys.Get (i)->GetObject<NrSpectrumPhy> ()->GetAntenna ()->GetObject<UniformPlanarArray> ()->SetAttribute ("PolSlantAngle", polSlantAngle);
+      ueSpectrumPhys.Get (i)->GetObject<NrSpectrumPhy> ()->GetAntenna ()->GetObject<UniformPlanarArray> ()->SetAttribute ("PolSlantAngle", polSlantAngle);
+      gnbSpectrumPhys.Get (i)->GetObject<NrSpectrumPhy> ()->TraceConnectWithoutContext ("RxPacketTraceEnb",
+                                                                                        MakeCallback (&NrUlMimoTestCase::RxPacketTraceEnb, this));
+    }
+  nrHelper->GetGnbMac (gnbNetDevs.Get (0), 0)->TraceConnectWithoutContext ("UlScheduling",
+                                                                          MakeCallback (&NrUlMimoTestCase::UlScheduling, this));
+
+  DynamicCast<NrGnbNetDevice> (gnbNetDevs.Get (0))->UpdateConfig ();
+  DynamicCast<NrUeNetDevice> (ueNetDevs.Get (0))->UpdateConfig ();
+
+  Ptr<Node> pgw = epcHelper->GetPgwNode ();
+  NodeContainer remoteHostContainer;
+  remoteHostContainer.Create (1);
+  Ptr<Node> remoteHost = remoteHostContainer.Get (0);
+  InternetStackHelper internet;
+  internet.Install (remoteHostContainer);
+  PointToPointHelper p2ph;
+  p2ph.SetDeviceAttribute ("DataRate", DataRateValue (DataRate ("100Gb/s")));
+  p2ph.SetDeviceAttribute ("Mtu", UintegerValue (2500));
+  p2ph.SetChannelAttribute ("Delay", TimeValue (Seconds (0.000)));
+  NetDeviceContainer internetDevices = p2ph.Install (pgw, remoteHost);
+  Ipv4AddressHelper ipv4h;
+  ipv4h.SetBase ("1.0.0.0", "255.0.0.0");
+  Ipv4InterfaceContainer internetIpIfaces = ipv4h.Assign (internetDevices);
+  Ipv4Address remoteHostAddr = internetIpIfaces.GetAddress (1);
+  Ipv4StaticRoutingHelper ipv4RoutingHelper;
+  Ptr<Ipv4StaticRouting> remoteHostStaticRouting = ipv4RoutingHelper.GetStaticRouting (remoteHost->GetObject<Ipv4> ());
+  remoteHostStaticRouting->AddNetworkRouteTo (Ipv4Address ("7.0.0.0"), Ipv4Mask ("255.0.0.0"), 1);
+
+  internet.Install (ueNodes);
+  epcHelper->AssignUeIpv4Address (ueNetDevs);
+  Ptr<Ipv4StaticRouting> ueStaticRouting = ipv4RoutingHelper.GetStaticRouting (ueNodes.Get (0)->GetObject<Ipv4> ());
+  ueStaticRouting->SetDefaultRoute (epcHelper->GetUeDefaultGatewayAddress (), 1);
+  nrHelper->AttachToClosestEnb (ueNetDevs, gnbNetDevs);
+
+  // Saturating UL traffic, so that the UE has data for both streams
+  uint16_t ulPort = 2000;
+  UdpServerHelper ulPacketSinkHelper (ulPort);
+  ApplicationContainer serverApps = ulPacketSinkHelper.Install (remoteHost);
+  UdpClientHelper ulClient (remoteHostAddr, ulPort);
+  ulClient.SetAttribute ("MaxPackets", UintegerValue (0xFFFFFFFF));
+  ulClient.SetAttribute ("PacketSize", UintegerValue (1000));
+  ulClient.SetAttribute ("Interval", TimeValue (MicroSeconds (50)));
+  ApplicationContainer clientApps = ulClient.Install (ueNodes.Get (0));
+
+  Ptr<EpcTft> tft = Create<EpcTft> ();
+  EpcTft::PacketFilter ulpf;
+  ulpf.remotePortStart = ulPort;
+  ulpf.remotePortEnd = ulPort;
+  ulpf.direction = EpcTft::UPLINK;
+  tft->Add (ulpf);
+  nrHelper->ActivateDedicatedEpsBearer (ueNetDevs.Get (0), EpsBearer (EpsBearer::NGBR_LOW_LAT_EMBB), tft);
+
+  serverApps.Start (MilliSeconds (400));
+  clientApps.Start (MilliSeconds (400));
+  clientApps.Stop (MilliSeconds (800));
+
+  Simulator::Stop (MilliSeconds (900));
+  Simulator::Run ();
+
+  uint32_t rank2NewData = 0;
+  std::vector<uint32_t> receivedOk (2, 0);
+  uint32_t independentRetx = 0;
+  for (const auto & process : m_dcis)
+    {
+      const auto & dcis = process.second;
+      for (std::size_t i = 0; i < dcis.size (); ++i)
+        {
+          const UlDci & dci = dcis.at (i);
+          if (dci.m_grants.size () == 2
+              && dci.m_grants.at (0).m_tbSize > 0 && dci.m_grants.at (0).m_ndi == 1
+              && dci.m_grants.at (1).m_tbSize > 0 && dci.m_grants.at (1).m_ndi == 1)
+            {
+              rank2NewData++;
+            }
+
+          // The last DCIs of the simulation may not have a reception nor a next DCI
+          if (i + 1 == dcis.size ())
+            {
+              continue;
+            }
+          const UlDci & next = dcis.at (i + 1);
+          bool oneOk = false;
+          bool oneCorrupt = false;
+          for (uint8_t s = 0; s < dci.m_grants.size (); ++s)
+            {
+              const UlGrant & grant = dci.m_grants.at (s);
+              if (grant.m_tbSize == 0 || dci.m_rxCorrupt.at (s) < 0)
+                {
+                  continue;
+                }
+              bool nextIsRetx = next.m_grants.size () > s
+                && next.m_grants.at (s).m_tbSize > 0 && next.m_grants.at (s).m_ndi == 0;
+              if (dci.m_rxCorrupt.at (s) == 0)
+                {
+                  receivedOk.at (s)++;
+                  oneOk = true;
+                  NS_TEST_ASSERT_MSG_EQ (nextIsRetx, false,
+                                         "Stream " << +s << " of HARQ process " << +grant.m_harqId <<
+                                         " was received, but it was retransmitted");
+                }
+              else if (grant.m_rv < 3)
+                {
+                  oneCorrupt = true;
+                  NS_TEST_ASSERT_MSG_EQ (nextIsRetx, true,
+                                         "Stream " << +s << " of HARQ process " << +grant.m_harqId <<
+                                         " was corrupted, but it was not retransmitted");
+                  NS_TEST_ASSERT_MSG_EQ (+next.m_grants.at (s).m_rv, grant.m_rv + 1,
+                                         "Wrong RV in the retransmission of stream " << +s);
+                  NS_TEST_ASSERT_MSG_EQ (next.m_grants.at (s).m_tbSize, grant.m_tbSize,
+                                         "The retransmission of stream " << +s << " should keep the TB size");
+                }
+            }
+          if (oneOk && oneCorrupt)
+            {
+              independentRetx++;
+            }
+        }
+    }
+
+  NS_TEST_ASSERT_MSG_GT (rank2NewData, 0, "No UL DCI carried new data on both streams");
+  NS_TEST_ASSERT_MSG_GT (receivedOk.at (0), 0, "No TB of stream 0 was received");
+  NS_TEST_ASSERT_MSG_GT (receivedOk.at (1), 0, "No TB of stream 1 was received");
+  NS_TEST_ASSERT_MSG_GT (independentRetx, 0,
+                         "No HARQ process had a stream retransmitted while the other was received");
+
+  Simulator::Destroy ();
+}
+
+class NrUlMimoTestSuite : public TestSuite
+{
+public:
+  NrUlMimoTestSuite () : TestSuite ("nr-test-ul-mimo", SYSTEM)
+  {
+    AddTestCase (new NrUlMimoTestCase, TestCase::EXTENSIVE);
+  }
+};
+
+static NrUlMimoTestSuite nrUlMimoTestSuite; //!< UL MIMO test suite
+
+} // namespace ns3
@@ -71,8 +71,9 @@ public:
    * \param name the test case name
    * \param closedLoop - whether open or closed loop mode will be activated, if true closed loop will be used, if false open loop
    * \param accumulatedMode - if closed loop is activated then this variable defines whether absolute or accumulation mode is being used
+   * \param gnbTpc - if true, the gNB derives the TPC commands from the PUSCH SINR, and the test checks that the SINR reaches the target
    */
-  NrUplinkPowerControlTestCase (std::string name, bool closedLoop, bool accumulatedMode);
+  NrUplinkPowerControlTestCase (std::string name, bool closedLoop, bool accumulatedMode, bool gnbTpc = false);
   /**
    * \brief Destructor
    */
@@ -101,6 +102,11 @@ public:
    * \param txPower the transmit power in dBm
    */
   void PucchTxPowerTrace (uint16_t cellId, uint16_t rnti, double txPower);
+  /**
+   * PUSCH reception trace function
+   * \param params the parameters of the received TB
+   */
+  void UlRxTrace (RxPacketTraceParams params);
 
 protected:
   virtual void DoRun (void);
@@ -114,6 +120,9 @@ protected:
   bool m_accumulatedMode {true};        //!< if closed loop is configured, this would indicate the type of a TPC mode to be used for the closed loop power control.
   bool m_puschTxPowerTraceFired {true}; //!< flag to indicate if the trace, which calls the test function got executed
   bool m_pucchTxPowerTraceFired {true}; //!< Flag to indicate if the trace, which calls the test function got executed
+  bool m_gnbTpc {false};                //!< indicates whether the gNB closes the loop with the PUSCH SINR
+  double m_tpcTargetSinr {10.0};        //!< target PUSCH SINR in dB of the gNB TPC
+  double m_lastUlSinr {0.0};            //!< SINR in dB of the last PUSCH received by the gNB
 };
 
 
@@ -126,6 +135,7 @@ NrUplinkPowerControlTestSuite::NrUplinkPowerControlTestSuite ()
   AddTestCase (new NrUplinkPowerControlTestCase ("OpenLoopPowerControlTest", false, false), TestCase::QUICK);
   AddTestCase (new NrUplinkPowerControlTestCase ("ClosedLoopPowerControlAbsoluteModeTest", true, false), TestCase::QUICK);
   AddTestCase (new NrUplinkPowerControlTestCase ("ClosedLoopPowerControlAccumulatedModeTest", true, true), TestCase::QUICK);
+  AddTestCase (new NrUplinkPowerControlTestCase ("ClosedLoopPowerControlGnbTpcTest", true, true, true), TestCase::QUICK);
 }
 
 static NrUplinkPowerControlTestSuite lteUplinkPowerControlTestSuite;
@@ -144,12 +154,19 @@ PucchTxPowerReport (NrUplinkPowerControlTestCase *testcase,
   testcase->PucchTxPowerTrace (cellId, rnti, txPower);
 }
 
-NrUplinkPowerControlTestCase::NrUplinkPowerControlTestCase (std::string name, bool closedLoop, bool accumulatedMode)
+void
+UlRxReport (NrUplinkPowerControlTestCase *testcase, RxPacketTraceParams params)
+{
+  testcase->UlRxTrace (params);
+}
+
+NrUplinkPowerControlTestCase::NrUplinkPowerControlTestCase (std::string name, bool closedLoop, bool accumulatedMode, bool gnbTpc)
   : TestCase (name)
 {
   NS_LOG_INFO ("Creating NrUplinkPowerControlTestCase");
   m_closedLoop = closedLoop;
   m_accumulatedMode = accumulatedMode; // if closed loop is configured, this would indicate the type of a TPC mode to be used for the closed loop power control.
+  m_gnbTpc = gnbTpc;
 }
 
 NrUplinkPowerControlTestCase::~NrUplinkPowerControlTestCase ()
@@ -191,6 +208,11 @@ NrUplinkPowerControlTestCase::PuschTxPowerTrace (uint16_t cellId, uint16_t rnti,
         }
     }
 
+  if (m_gnbTpc)
+    {
+      return; // the power depends on the TPC commands, the SINR is checked instead
+    }
+
   // we allow some tollerance because of layer 3 filtering
   NS_TEST_ASSERT_MSG_EQ_TOL (txPower, m_expectedPuschTxPower, 1 + abs (m_expectedPuschTxPower * 0.1), "Wrong Pusch Tx Power");
 }
@@ -213,11 +235,24 @@ NrUplinkPowerControlTestCase::PucchTxPowerTrace (uint16_t cellId, uint16_t rnti,
         }
     }
 
+  if (m_gnbTpc)
+    {
+      return;
+    }
+
   // we allow some tollerance because of layer 3 filtering
   NS_TEST_ASSERT_MSG_EQ_TOL (txPower, m_expectedPucchTxPower, 1 + abs (m_expectedPucchTxPower * 0.1), "Wrong Pucch Tx Power");
 
 }
 
+void
+NrUplinkPowerControlTestCase::UlRxTrace (RxPacketTraceParams params)
+{
+  NS_LOG_FUNCTION (this);
+  m_lastUlSinr = 10 * log10 (params.m_sinr);
+  NS_LOG_DEBUG ("PUSCH received from RNTI: " << params.m_rnti << " SINR: " << m_lastUlSinr);
+}
+
 void
 NrUplinkPowerControlTestCase::DoRun (void)
 {
@@ -246,6 +281,8 @@ NrUplinkPowerControlTestCase::DoRun (void)
   Config::SetDefault ("ns3::NrUePowerControl::PoNominalPucch", IntegerValue (-80));
   Config::SetDefault ("ns3::NrUePowerControl::PsrsOffset", IntegerValue (9));
   Config::SetDefault ("ns3::ThreeGppPropagationLossModel::ShadowingEnabled", BooleanValue (false));
+  Config::SetDefault ("ns3::NrMacSchedulerNs3::ClosedLoopTpc", BooleanValue (m_gnbTpc));
+  Config::SetDefault ("ns3::NrMacSchedulerNs3::TpcTargetSinr", DoubleValue (m_tpcTargetSinr));
 
   Ptr<NrPointToPointEpcHelper> epcHelper = CreateObject<NrPointToPointEpcHelper> ();
   Ptr<IdealBeamformingHelper> idealBeamformingHelper = CreateObject <IdealBeamformingHelper> ();
@@ -311,6 +348,8 @@ NrUplinkPowerControlTestCase::DoRun (void)
                                        MakeBoundCallback (&PuschTxPowerReport, this));
   m_ueUpc->TraceConnectWithoutContext ("ReportPucchTxPower",
                                        MakeBoundCallback (&PucchTxPowerReport, this));
+  nrHelper->GetGnbPhy (gnbDevs.Get (0), 0)->GetSpectrumPhy ()->TraceConnectWithoutContext ("RxPacketTraceEnb",
+                                                                                          MakeBoundCallback (&UlRxReport, this));
 
 
   Ptr<const NrSpectrumPhy> txSpectrumPhy = nrHelper->GetGnbPhy (gnbDevs.Get (0), 0)->GetSpectrumPhy ();
@@ -453,7 +492,17 @@ NrUplinkPowerControlTestCase::DoRun (void)
    */
 
   //Changing UE position
-  if (!m_closedLoop)
+  if (m_gnbTpc)
+    {
+      /**
+       * At 100 meters the open loop power gives a PUSCH SINR well above the
+       * target: the gNB has to send negative TPC commands until the SINR
+       * is within the 1 dB dead zone of the target.
+       */
+      Simulator::Schedule (MilliSeconds (0),
+                           &NrUplinkPowerControlTestCase::MoveUe, this, 100, 0, 0 );
+    }
+  else if (!m_closedLoop)
     {
       Simulator::Schedule (MilliSeconds (0),
                            &NrUplinkPowerControlTestCase::MoveUe, this, 10, -21, -11 );
@@ -539,5 +588,10 @@ NrUplinkPowerControlTestCase::DoRun (void)
   Simulator::Stop (simTime);
   Simulator::Run ();
 
+  if (m_gnbTpc)
+    {
+      NS_TEST_ASSERT_MSG_EQ_TOL (m_lastUlSinr, m_tpcTargetSinr, 2.0, "The PUSCH SINR did not converge to the TPC target");
+    }
+
   Simulator::Destroy ();
 }